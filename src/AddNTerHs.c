@@ -3,12 +3,12 @@
 
    \file       AddNTerHs.c
    
-   \version    V1.11
-   \date       23.06.15
+   \version    V1.14
+   \date       18.10.26
    \brief      Routines to add N-terminal hydrogens and C-terminal
                oxygens.
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1994-2014
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1994-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -68,6 +68,9 @@
 -  V1.9  17.02.15 Handles element and segid  By: ACRM
 -  V1.10 05.03.15 Replaced blFindEndPDB() with blFindNextResidue()
 -  V1.11 23.06.15 Added CLEAR_PDB() calls
+-  V1.12 18.10.26 Sets name codes on new and renamed atoms
+-  V1.13 18.10.26 doAddCharmmNTer() also calls CLEAR_PDB()
+-  V1.14 18.10.26 blAddNTerHs() detaches any indexes of the list
 
 *************************************************************************/
 /* Doxygen
@@ -119,12 +122,16 @@ static int doAddCharmmNTer(PDB **ppdb, PDB *nter);
 -  04.02.14 Use CHAINMATCH By: CTP
 -  07.07.14 Use bl prefix for functions By: CTP
 -  23.06.15 Added CLEAR_PDB() calls  By: ACRM
+-  18.10.26 Detaches any indexes of the list
 */
 int blAddNTerHs(PDB **ppdb, BOOL Charmm)
 {
    PDB  *p;
    char chain[8] = "-";
    int  nhyd  = 0;
+
+   /* Atoms are added and removed, so indexes of the list are freed     */
+   blDetachPDBIndexes(*ppdb);
    
    for(p = *ppdb; p!=NULL; NEXT(p))
    {
@@ -210,6 +217,7 @@ static PDB *KillNTerH(PDB *pdb)
 -  06.02.03 Handles atnam_raw
 -  03.06.05 Handles altpos
 -  17.02.15 Handles element and segid
+-  18.10.26 Sets name codes
 */
 static int doAddGromosNTer(PDB **ppdb, PDB *nter)
 {
@@ -275,6 +283,10 @@ static int doAddGromosNTer(PDB **ppdb, PDB *nter)
       strcpy(H3->atnam_raw, " H3 ");
       H3->altpos = ' ';                   /* 03.06.05                   */
 
+      blSetPDBNameCodes(H1);              /* 18.10.26                   */
+      blSetPDBNameCodes(H2);
+      blSetPDBNameCodes(H3);
+
       /* Correctly link the new start into the whole linked list        */
       if(prev != NULL)
          prev->next = H1;
@@ -303,6 +315,8 @@ static int doAddGromosNTer(PDB **ppdb, PDB *nter)
 -  06.02.03 Handles atnam_raw
 -  03.06.05 Handles altpos
 -  17.02.15 Handles element, segid and formal charge
+-  18.10.26 Sets name codes
+-  18.10.26 Added CLEAR_PDB() calls
 */
 static int doAddCharmmNTer(PDB **ppdb, PDB *nter)
 {
@@ -324,6 +338,10 @@ static int doAddCharmmNTer(PDB **ppdb, PDB *nter)
       INIT(H3, PDB);
       if(H1==NULL || H2==NULL || H3==NULL) return(0);
       
+      CLEAR_PDB(H1);   /* 18.10.26                                      */
+      CLEAR_PDB(H2);
+      CLEAR_PDB(H3);
+
       /* Initialise the hydrogens with the res info, etc.               */
       H1->atnum  = 9998;
       H1->resnum = 9999;
@@ -386,6 +404,11 @@ static int doAddCharmmNTer(PDB **ppdb, PDB *nter)
       strcpy(nter->atnam, "NT  ");
       strcpy(nter->atnam_raw, " NT ");
 
+      blSetPDBNameCodes(H1);              /* 18.10.26                   */
+      blSetPDBNameCodes(H2);
+      blSetPDBNameCodes(H3);
+      blSetPDBNameCodes(nter);
+
       /* Correctly link the new start into the whole linked list        */
       if(prev != NULL)
          prev->next = H1;
@@ -3,11 +3,11 @@
 
    \file       AppendPDB.c
    
-   \version    V1.11
-   \date       08.10.99
+   \version    V1.14
+   \date       18.10.26
    \brief      PDB linked list manipulation
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-6
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -57,6 +57,10 @@
 -  V1.8  10.01.96 Added ExtractZonePDB()
 -  V1.9  14.03.96 Added FindAtomInRes()
 -  V1.10 08.10.99 Initialised some variables
+-  V1.12 18.10.26 blAppendPDB() uses and updates gPDBAtomIndex
+-  V1.13 18.10.26 blAppendPDB() updates the indexes attached to first
+-  V1.14 18.10.26 blAppendPDB() uses the atom index attached to first
+                  rather than gPDBAtomIndex
 
 *************************************************************************/
 /* Doxygen
@@ -102,22 +106,38 @@
    Appends list second onto first. Returns start of new list (useful if 
    first was NULL).
 
+   If an atom index is attached to first, it is used to find the end
+   of first. The indexes attached to first are updated (see
+   blAppendToPDBIndexes()).
+
 -  13.05.92 Original
 -  09.07.93 Changed to use LAST()
 -  07.07.14 Use bl prefix for functions By: CTP
+-  18.10.26 Uses and updates gPDBAtomIndex
+-  18.10.26 Updates the indexes attached to first
+-  18.10.26 Uses the atom index attached to first
 */
 PDB *blAppendPDB(PDB *first,
                  PDB *second)
 {
-   PDB *p;
+   PDB          *p;
+   PDBATOMINDEX *index;
 
    if(first == NULL)
       return(second);
    
-   p = first;
-   LAST(p);
+   if((index = blGetPDBAtomIndex(first)) != NULL)
+   {
+      p = blGetPDBAtomByPosition(index, index->natoms - 1);
+   }
+   else
+   {
+      p = first;
+      LAST(p);
+   }
 
    p->next = second;
+   blAppendToPDBIndexes(p, second);
    return(first);
 }
 
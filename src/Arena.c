@@ -0,0 +1,300 @@
+/************************************************************************/
+/**
+
+   \file       Arena.c
+
+   \version    V1.0
+   \date       18.10.26
+   \brief      Arena allocator for structures that are freed together
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   An arena hands out memory from a small number of large blocks. There
+   is no way to free a single allocation; everything allocated from an
+   arena is released at once by blFreeArena().
+
+   This suits the linked lists built by the PDB readers, where every
+   atom would otherwise be a separate malloc() and a separate free().
+   Items allocated one after another from an arena are contiguous in
+   memory so walking such a list in order also walks memory in order.
+
+   Blocks start at the requested size and double in size up to
+   ARENA_MAXBLOCK, so the number of blocks grows only with the
+   logarithm of the amount of memory allocated.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+\code
+   ARENA *arena;
+   PDB   *p;
+   arena = blCreateArena(0);
+   INITARENA(p, PDB, arena);
+   ...
+   blFreeArena(arena);
+\endcode
+
+   Memory allocated from an arena must never be passed to free(), so
+   lists built with INITARENA() and ALLOCNEXTARENA() must not be freed
+   with FREELIST().
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  18.10.26 Original
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    General Programming
+   #SUBGROUP Memory management
+   #FUNCTION  blCreateArena()
+   Creates an arena from which memory can be allocated
+
+   #FUNCTION  blArenaAlloc()
+   Allocates memory from an arena
+
+   #FUNCTION  blArenaStrdup()
+   Copies a string into memory allocated from an arena
+
+   #FUNCTION  blFreeArena()
+   Frees an arena and everything allocated from it
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdlib.h>
+#include <string.h>
+#include "SysDefs.h"
+#include "macros.h"
+#include "general.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define ARENA_BLOCKSIZE  65536              /* Default first block      */
+#define ARENA_MAXBLOCK   (16*1024*1024)     /* Blocks stop growing here */
+
+/* The strictest alignment needed by anything we store                  */
+typedef union
+{
+   double d;
+   long   l;
+   void   *p;
+}  ARENAALIGN;
+
+#define ARENA_ALIGN(n) ((((n) + sizeof(ARENAALIGN) - 1) /              \
+                         sizeof(ARENAALIGN)) * sizeof(ARENAALIGN))
+
+typedef struct _arenablock
+{
+   struct _arenablock *next;
+   size_t             size,        /* Bytes available for allocation    */
+                      used;        /* Bytes allocated so far            */
+}  ARENABLOCK;
+
+/* The allocations start after the (aligned) block header               */
+#define BLOCKDATA(b) ((char *)(b) + ARENA_ALIGN(sizeof(ARENABLOCK)))
+
+struct _arena
+{
+   ARENABLOCK *blocks;             /* Current block first               */
+   size_t     nextSize;            /* Size for the next block           */
+};
+
+/************************************************************************/
+/* Prototypes
+*/
+static ARENABLOCK *NewArenaBlock(size_t size);
+
+
+/************************************************************************/
+/*>ARENA *blCreateArena(int blockSize)
+   -----------------------------------
+*//**
+
+   \param[in]     blockSize  Size in bytes of the first block. 0 for
+                             the default (64KB)
+   \return                   The arena. NULL if no memory
+
+   Creates an empty arena. No block is allocated until memory is first
+   requested. If the approximate amount of memory needed is known,
+   giving it as blockSize means everything will come from one block.
+
+-  18.10.26 Original
+*/
+ARENA *blCreateArena(int blockSize)
+{
+   ARENA *arena;
+
+   if((arena = (ARENA *)malloc(sizeof(ARENA)))==NULL)
+      return(NULL);
+
+   arena->blocks   = NULL;
+   arena->nextSize = (blockSize > 0) ? (size_t)blockSize :
+                                       ARENA_BLOCKSIZE;
+   return(arena);
+}
+
+
+/************************************************************************/
+/*>APTR blArenaAlloc(ARENA *arena, int size)
+   -----------------------------------------
+*//**
+
+   \param[in,out] *arena   The arena
+   \param[in]     size     Number of bytes required
+   \return                 Pointer to the memory. NULL if no memory
+
+   Allocates memory from an arena. The memory is suitably aligned for
+   any of the structures used by the library and is not cleared. It
+   is freed only when the whole arena is freed with blFreeArena().
+
+-  18.10.26 Original
+*/
+APTR blArenaAlloc(ARENA *arena, int size)
+{
+   ARENABLOCK *block = arena->blocks;
+   size_t     need   = ARENA_ALIGN((size_t)size);
+   char       *mem;
+
+   /* Start a new block if this one is full                             */
+   if((block == NULL) || (block->used + need > block->size))
+   {
+      if((block = NewArenaBlock(MAX(need, arena->nextSize)))==NULL)
+         return(NULL);
+
+      /* A request bigger than the next block gets a block of its own
+         behind the current one so the space left there isn't lost
+      */
+      if((need > arena->nextSize) && (arena->blocks != NULL))
+      {
+         block->next         = arena->blocks->next;
+         arena->blocks->next = block;
+      }
+      else
+      {
+         block->next   = arena->blocks;
+         arena->blocks = block;
+
+         if(arena->nextSize < ARENA_MAXBLOCK)
+            arena->nextSize = MIN(2 * arena->nextSize, ARENA_MAXBLOCK);
+      }
+   }
+
+   mem          = BLOCKDATA(block) + block->used;
+   block->used += need;
+
+   return((APTR)mem);
+}
+
+
+/************************************************************************/
+/*>char *blArenaStrdup(ARENA *arena, char *string)
+   -----------------------------------------------
+*//**
+
+   \param[in,out] *arena   The arena
+   \param[in]     *string  String to copy
+   \return                 Copy of the string. NULL if no memory
+
+   Copies a string into memory allocated from an arena
+
+-  18.10.26 Original
+*/
+char *blArenaStrdup(ARENA *arena, char *string)
+{
+   char *copy;
+   int  len = strlen(string) + 1;
+
+   if((copy = (char *)blArenaAlloc(arena, len))!=NULL)
+      memcpy(copy, string, len);
+
+   return(copy);
+}
+
+
+/************************************************************************/
+/*>void blFreeArena(ARENA *arena)
+   ------------------------------
+*//**
+
+   \param[in]     *arena   The arena (may be NULL)
+
+   Frees an arena and everything that was allocated from it.
+
+-  18.10.26 Original
+*/
+void blFreeArena(ARENA *arena)
+{
+   ARENABLOCK *block,
+              *next;
+
+   if(arena == NULL)
+      return;
+
+   for(block=arena->blocks; block!=NULL; block=next)
+   {
+      next = block->next;
+      free(block);
+   }
+   free(arena);
+}
+
+
+/************************************************************************/
+/*>static ARENABLOCK *NewArenaBlock(size_t size)
+   ---------------------------------------------
+*//**
+
+   \param[in]     size     Bytes available for allocation
+   \return                 The new block. NULL if no memory
+
+   Allocates a block for an arena
+
+-  18.10.26 Original
+*/
+static ARENABLOCK *NewArenaBlock(size_t size)
+{
+   ARENABLOCK *block;
+
+   if((block = (ARENABLOCK *)malloc(ARENA_ALIGN(sizeof(ARENABLOCK)) +
+                                    size))==NULL)
+      return(NULL);
+
+   block->next = NULL;
+   block->size = size;
+   block->used = 0;
+
+   return(block);
+}
@@ -3,12 +3,12 @@
 
    \file       BuildAtomNeighbourPDBList.c
    
-   \version    V1.4
-   \date       19.08.14
+   \version    V1.5
+   \date       18.10.26
    \brief      Build a new PDB linked list containing atos within a given
                distance of a specified residue
    
-   \copyright  (c) Dr. Andrew C. R. Martin, UCL, 1996-2014
+   \copyright  (c) Dr. Andrew C. R. Martin, UCL, 1996-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -54,6 +54,8 @@
 -  V1.3  07.07.14 Use bl prefix for functions By: CTP
 -  V1.4  19.08.14 Renamed blBuildAtomNeighbourPDBListAsCopy to 
                   blBuildAtomNeighbourPDBListAsCopy() By: CTP
+-  V1.5  18.10.26 Uses a PDBGRID to find the neighbours and only copies
+                  the atoms that are kept
 
 *************************************************************************/
 /* Doxygen
@@ -109,67 +111,92 @@
 -  07.07.14 Use bl prefix for functions By: CTP
 -  19.08.14 Renamed function to blBuildAtomNeighbourPDBListAsCopy() 
             By: CTP
+-  18.10.26 Uses a PDBGRID to find the atoms in range of each atom of
+            the residue rather than checking every atom, and copies
+            only those atoms rather than the whole list. CONECTs to
+            atoms which are not kept are set to NULL. Atoms with
+            missing coordinates are never neighbours
 */
 PDB *blBuildAtomNeighbourPDBListAsCopy(PDB *pdb, PDB *pRes, 
                                        REAL NeighbDist)
 {
-   PDB  *pdbN  = NULL,
-        *prev  = NULL,
-        *p, *q,
-        *pNext = NULL;
-   REAL DCutSq = NeighbDist * NeighbDist;
-   
-   /* First, simply duplicate the PDB linked list                       */
-   if(!(pdbN = blDupePDB(pdb)))
+   PDBGRID *grid;
+   PDB     *pdbN  = NULL,
+           *p, 
+           *q     = NULL,
+           *pNext = NULL;
+   VEC3F   centre;
+   char    *inRange;
+   int     *found,
+           nfound,
+           i;
+
+   /* Build a grid of the whole structure                               */
+   if((grid = blBuildPDBGrid(pdb, NeighbDist))==NULL)
       return(NULL);
 
-   /* We'll use the Occ column as a flag                                */
-   for(p=pdbN; p!=NULL; NEXT(p))
-      p->occ = 0.0;
-   
+   inRange = (char *)calloc(grid->natoms + 1, sizeof(char));
+   found   = (int *)malloc((grid->natoms + 1) * sizeof(int));
+   if((inRange == NULL) || (found == NULL))
+   {
+      FREE(inRange);
+      FREE(found);
+      blFreePDBGrid(grid);
+      return(NULL);
+   }
+
    /* Find the atom after the residue in which we are interested        */
    pNext = blFindNextResidue(pRes);
 
-   /* Look at each atom in our residue in turn flagging atoms in the
-      duplicate list which are in range
+   /* Look at each atom in our residue in turn flagging atoms which are
+      in range
    */
    for(p=pRes; p!=pNext; NEXT(p))
    {
-      for(q=pdbN; q!=NULL; NEXT(q))
-      {
-         if(DISTSQ(p,q) <= DCutSq)
-            q->occ = (REAL)1.0;
-      }
+      centre.x = p->x;
+      centre.y = p->y;
+      centre.z = p->z;
+      nfound   = blFindAtomsInRangePDBGrid(grid, centre, NeighbDist, 
+                                           found);
+      for(i=0; i<nfound; i++)
+         inRange[found[i]] = 1;
    }
-   
-   /* Now run through the linked list removing any items which do not
-      have the Occ flag set
+
+   /* Copy the flagged atoms in list order. The occ column is set to 1.0
+      as it was used as the flag by earlier versions
    */
-   for(p=pdbN, prev=NULL; p!=NULL;)
+   for(i=0; i<grid->natoms; i++)
    {
-      if(p->occ < (REAL)0.5)
+      if(inRange[i])
       {
-         if(prev==NULL)
+         if(pdbN == NULL)
          {
-            pdbN = p->next;
-            free(p);
-            p=pdbN;
-            continue;
+            INIT(pdbN, PDB);
+            q = pdbN;
          }
          else
          {
-            prev->next = p->next;
-            free(p);
-            p=prev->next;   /* 17.11.05              Fixed from p->next */
-            continue;
+            ALLOCNEXT(q, PDB);
+         }
+         if(q == NULL)
+         {
+            FREELIST(pdbN, PDB);
+            break;
          }
+
+         blCopyPDB(q, grid->atoms[i]);
+         q->occ = (REAL)1.0;
       }
-      prev = p;
-      NEXT(p);
    }
 
+   free(inRange);
+   free(found);
+   blFreePDBGrid(grid);
+
+   /* Copy CONECT data                                                  */
+   if((pdbN != NULL) && !blCopyConects(pdbN, pdb))
+      FREELIST(pdbN, PDB);
+
    /* Return the reduced list                                           */
    return(pdbN);
 }
-
-
@@ -3,11 +3,11 @@
 
    \file       BuildConect.c
    
-   \version    V1.5
-   \date       03.10.16
+   \version    V1.9
+   \date       18.10.26
    \brief      Build connectivity information in PDB linked list
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2002-2016
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2002-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -36,6 +36,13 @@
    Description:
    ============
 
+   blBuildConectData() finds bonds from the covalent radii of the
+   atoms. Only atoms closer than twice the largest radius plus the
+   tolerance can be bonded, so the atoms are sorted into a PDBGRID
+   with cells of that size and only atoms in neighbouring cells are
+   compared. The bonds are then added in the order in which the
+   original residue-by-residue search found them, so the CONECT data
+   are the same.
 
 **************************************************************************
 
@@ -54,6 +61,12 @@
                   blAreResiduePointersBonded()
 -  V1.4  22.07.15 Added blIsConnected()
 -  V1.5  03.10.16 Added <stdlib.h>
+-  V1.6  18.10.26 blBuildConectData() uses name codes
+-  V1.7  18.10.26 blBuildConectData() uses a PDBGRID to find the atoms
+                  close enough to be bonded
+-  V1.8  18.10.26 Atom names are compared as strings again since the
+                  name codes may be out of date
+-  V1.9  18.10.26 Atom names are compared using name codes again
 
 *************************************************************************/
 /* Doxygen
@@ -107,6 +120,7 @@
 */
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include "macros.h"
 #include "pdb.h"
 
@@ -118,6 +132,38 @@ struct _covalentradii
    char element[8];
    REAL radius;
 };
+
+/* Flags for each atom used by blBuildConectData()                      */
+#define CONECT_HET  0x01
+#define CONECT_C    0x02
+#define CONECT_N    0x04
+
+#define MISSING(p) (((p)->x >= (REAL)9999.0) ||                         \
+                    ((p)->y >= (REAL)9999.0) ||                         \
+                    ((p)->z >= (REAL)9999.0))
+#define PAIRSTEP   1024       /* Initial size of the list of bonds      */
+
+/* A bond found by blBuildConectData(). inter is 1 if the atoms are in
+   different residues
+*/
+typedef struct
+{
+   int res, inter, i, j;
+}  BONDPAIR;
+
+/* Data about the atoms passed to TestPair()                            */
+typedef struct
+{
+   PDB      **atoms;
+   REAL     *radius,
+            tol;
+   int      *res,
+            npairs,
+            maxpairs;
+   char     *flags;
+   BONDPAIR *pairs;
+   BOOL     ok;
+}  CONECTDATA;
    
 /************************************************************************/
 /* Globals
@@ -154,6 +200,10 @@ static struct _covalentradii covalentRadii[] =
 /* Prototypes
 */
 static REAL findCovalentRadius(char *element);
+static BOOL BuildConectDataAllPairs(PDB *pdb, REAL tol);
+static BOOL FindBondPairs(PDBGRID *grid, CONECTDATA *data);
+static BOOL TestPair(int i, int j, REAL distsq, APTR user);
+static int  CompareBondPairs(const void *a, const void *b);
 
 
 /************************************************************************/
@@ -243,12 +293,293 @@ BOOL blAddOneDirectionConect(PDB *p, PDB *q)
    connections for an atom. If this happens, MAXCONECT needs to be 
    increased in pdb.h
 
+   Atoms within a residue are only bonded if one is a HETATM. Atoms in
+   different residues are bonded unless they are the backbone C and N
+   of a peptide bond, which are not included unless one is a HETATM.
+
 -  19.02.15  Original   By: ACRM
 -  26.02.15  Added tol paramater
 -  12.05.15  Conects are built involving backbone C and N if either atom
              is a HETATM
+-  18.10.26  Uses name codes to test atom names and record types
+-  18.10.26  Finds the atoms close enough to be bonded with a PDBGRID.
+             The radius of each atom is only looked up once. Falls back
+             to comparing every pair of atoms if there is no memory
+-  18.10.26  Compares atom names as strings
+-  18.10.26  Uses name codes again
 */
 BOOL blBuildConectData(PDB *pdb, REAL tol)
+{
+   CONECTDATA data;
+   PDBGRID    *grid = NULL;
+   PDB        *p,
+              *res,
+              *nextRes;
+   char       *lastElement = NULL;
+   REAL       radius       = (REAL)1.0,
+              minRadius    = (REAL)0.0,
+              maxRadius    = (REAL)0.0,
+              maxBond;
+   int        natoms       = 0,
+              nres,
+              i;
+   BOOL       retval       = TRUE;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+      natoms++;
+   if(natoms == 0)
+      return(TRUE);
+
+   data.tol      = tol;
+   data.npairs   = 0;
+   data.maxpairs = 0;
+   data.pairs    = NULL;
+   data.ok       = TRUE;
+   data.radius   = (REAL *)malloc(natoms * sizeof(REAL));
+   data.res      = (int *)malloc(natoms * sizeof(int));
+   data.flags    = (char *)malloc(natoms * sizeof(char));
+
+   if((data.radius == NULL) || (data.res == NULL) || (data.flags == NULL))
+   {
+      FREE(data.radius);
+      FREE(data.res);
+      FREE(data.flags);
+      return(BuildConectDataAllPairs(pdb, tol));
+   }
+
+   /* Find the residue, flags and covalent radius of each atom. Atoms
+      of the same element are usually together, so the last radius is
+      reused while the element is the same
+   */
+   for(res=pdb, nres=0, i=0; res!=NULL; res=nextRes, nres++)
+   {
+      nextRes = blFindNextResidue(res);
+      for(p=res; p!=nextRes; NEXT(p), i++)
+      {
+         if((lastElement == NULL) || strcmp(p->element, lastElement))
+         {
+            radius      = findCovalentRadius(p->element);
+            lastElement = p->element;
+         }
+         data.radius[i] = radius;
+         data.res[i]    = nres;
+         data.flags[i]  = 0;
+         if(ISHETATM(p))
+            data.flags[i] |= CONECT_HET;
+         if(PDBNAMEMATCH(p->atnam_code, p->atnam, PDBNAME_C, "C   ", 4))
+            data.flags[i] |= CONECT_C;
+         if(PDBNAMEMATCH(p->atnam_code, p->atnam, PDBNAME_N, "N   ", 4))
+            data.flags[i] |= CONECT_N;
+
+         if((i == 0) || (radius < minRadius))
+            minRadius = radius;
+         if((i == 0) || (radius > maxRadius))
+            maxRadius = radius;
+      }
+   }
+
+   /* No pair of atoms can be bonded if they are further apart than this.
+      blIsBonded() squares the bond length, so a large negative tolerance
+      is allowed for. A little is added so rounding cannot lose a bond
+   */
+   maxBond = MAX(ABS(2.0 * maxRadius + tol), ABS(2.0 * minRadius + tol));
+   maxBond += (REAL)0.01;
+
+   /* Sort the atoms into cells of that size                            */
+   if((grid = blBuildPDBGrid(pdb, maxBond)) != NULL)
+   {
+      data.atoms = grid->atoms;
+      if(FindBondPairs(grid, &data))
+      {
+         /* Sort the bonds into the order that they would be found by
+            working through the residues
+         */
+         if(data.npairs)
+            qsort(data.pairs, data.npairs, sizeof(BONDPAIR),
+                  CompareBondPairs);
+
+         for(p=pdb; p!=NULL; NEXT(p))
+            p->nConect = 0;
+         for(i=0; i<data.npairs; i++)
+         {
+            if(!blAddConect(grid->atoms[data.pairs[i].i],
+                            grid->atoms[data.pairs[i].j]))
+               retval = FALSE;
+         }
+      }
+      else
+      {
+         retval = BuildConectDataAllPairs(pdb, tol);
+      }
+      blFreePDBGrid(grid);
+   }
+   else
+   {
+      retval = BuildConectDataAllPairs(pdb, tol);
+   }
+
+   FREE(data.pairs);
+   free(data.radius);
+   free(data.res);
+   free(data.flags);
+
+   return(retval);
+}
+
+
+/************************************************************************/
+/*>static BOOL FindBondPairs(PDBGRID *grid, CONECTDATA *data)
+   ----------------------------------------------------------
+*//**
+   \param[in]       *grid  Grid of the atoms with cells at least the
+                           longest possible bond length
+   \param[in,out]   *data  Data about the atoms. The bonds are added
+                           to data->pairs
+   \return                 Success. FALSE if no memory
+
+   Finds all the pairs of atoms that are bonded. Atoms with missing
+   coordinates are not in the grid, so are compared with every atom
+   as they were before the grid was used.
+
+-  18.10.26  Original
+*/
+static BOOL FindBondPairs(PDBGRID *grid, CONECTDATA *data)
+{
+   int i, j;
+
+   blForEachPairPDBGrid(grid, grid->cellSize, TestPair, (APTR)data);
+
+   for(i=0; (i<grid->natoms) && data->ok; i++)
+   {
+      if(MISSING(grid->atoms[i]))
+      {
+         for(j=0; (j<grid->natoms) && data->ok; j++)
+         {
+            /* Pairs of missing atoms are only tested once              */
+            if((j != i) && 
+               ((j > i) || !MISSING(grid->atoms[j])))
+               TestPair(MIN(i, j), MAX(i, j), (REAL)0.0, (APTR)data);
+         }
+      }
+   }
+
+   return(data->ok);
+}
+
+
+/************************************************************************/
+/*>static BOOL TestPair(int i, int j, REAL distsq, APTR user)
+   ----------------------------------------------------------
+*//**
+   \param[in]       i      Position of the first atom
+   \param[in]       j      Position of the second atom (after i)
+   \param[in]       distsq Squared distance between them (unused)
+   \param[in,out]   user   CONECTDATA for the atoms
+   \return                 FALSE if no memory to store a bond
+
+   Called by blForEachPairPDBGrid() for each pair of atoms which might
+   be bonded. If they are, they are added to the list of bonds. The
+   bond length is calculated exactly as it is in blIsBonded().
+
+-  18.10.26  Original
+*/
+static BOOL TestPair(int i, int j, REAL distsq, APTR user)
+{
+   CONECTDATA *data = (CONECTDATA *)user;
+   REAL       bondDist;
+   int        inter;
+   
+   inter = (data->res[i] != data->res[j]) ? 1 : 0;
+
+   /* Within a residue only HETATMs are bonded. Between residues, the
+      peptide bond is only bonded if there is a HETATM
+   */
+   if(!((data->flags[i] | data->flags[j]) & CONECT_HET))
+   {
+      if(!inter)
+         return(TRUE);
+      if((data->flags[i] & CONECT_C) && (data->flags[j] & CONECT_N))
+         return(TRUE);
+   }
+
+   bondDist = (data->radius[i] + data->radius[j] + data->tol);
+   if(DISTSQ(data->atoms[i], data->atoms[j]) > bondDist*bondDist)
+      return(TRUE);
+
+   if(data->npairs == data->maxpairs)
+   {
+      BONDPAIR *pairs;
+      int      maxpairs = (data->maxpairs) ? 2 * data->maxpairs : PAIRSTEP;
+
+      if((pairs = (BONDPAIR *)realloc(data->pairs,
+                                      maxpairs * sizeof(BONDPAIR)))
+         == NULL)
+      {
+         data->ok = FALSE;
+         return(FALSE);
+      }
+      data->pairs    = pairs;
+      data->maxpairs = maxpairs;
+   }
+
+   data->pairs[data->npairs].res   = data->res[i];
+   data->pairs[data->npairs].inter = inter;
+   data->pairs[data->npairs].i     = i;
+   data->pairs[data->npairs].j     = j;
+   data->npairs++;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static int CompareBondPairs(const void *a, const void *b)
+   ---------------------------------------------------------
+*//**
+   \param[in]       *a     First BONDPAIR
+   \param[in]       *b     Second BONDPAIR
+   \return                 Sort order for qsort()
+
+   Sorts bonds by residue of the first atom, bonds within the residue
+   before those to later residues, then by the positions of the atoms.
+   This is the order in which BuildConectDataAllPairs() finds them.
+
+-  18.10.26  Original
+*/
+static int CompareBondPairs(const void *a, const void *b)
+{
+   const BONDPAIR *p = (const BONDPAIR *)a,
+                  *q = (const BONDPAIR *)b;
+
+   if(p->res   != q->res)   return((p->res   < q->res)   ? -1 : 1);
+   if(p->inter != q->inter) return((p->inter < q->inter) ? -1 : 1);
+   if(p->i     != q->i)     return((p->i     < q->i)     ? -1 : 1);
+   if(p->j     != q->j)     return((p->j     < q->j)     ? -1 : 1);
+   return(0);
+}
+
+
+/************************************************************************/
+/*>static BOOL BuildConectDataAllPairs(PDB *pdb, REAL tol)
+   -------------------------------------------------------
+*//**
+   \param[in,out]   *pdb   PDB linked list
+   \param[in]       tol    Tolerence for distance between atoms
+   \return                 Were all CONECTs added OK
+
+   Rebuilds the CONECT data by comparing every pair of atoms. Used by
+   blBuildConectData() if there is no memory for a grid.
+
+-  19.02.15  Original   By: ACRM
+-  26.02.15  Added tol paramater
+-  12.05.15  Conects are built involving backbone C and N if either atom
+             is a HETATM
+-  18.10.26  Uses name codes to test atom names and record types
+-  18.10.26  Moved from blBuildConectData()
+-  18.10.26  Compares atom names as strings
+-  18.10.26  Uses name codes again
+*/
+static BOOL BuildConectDataAllPairs(PDB *pdb, REAL tol)
 {
    PDB  *p, 
         *q,
@@ -271,8 +602,7 @@ BOOL blBuildConectData(PDB *pdb, REAL tol)
       {
          for(q=p->next; q!=nextRes; NEXT(q))
          {
-            if(!strncmp(p->record_type, "HETATM", 6) ||
-               !strncmp(q->record_type, "HETATM", 6))
+            if(ISHETATM(p) || ISHETATM(q))
             {
                if(blIsBonded(p, q, tol))
                {
@@ -290,10 +620,11 @@ BOOL blBuildConectData(PDB *pdb, REAL tol)
       {
          for(q=nextRes; q!=NULL; NEXT(q))
          {
-            if(strncmp(p->atnam, "C   ", 4) ||
-               strncmp(q->atnam, "N   ", 4) ||
-               !strncmp(p->record_type, "HETATM", 6) ||
-               !strncmp(q->record_type, "HETATM", 6))
+            if(!PDBNAMEMATCH(p->atnam_code, p->atnam,
+                             PDBNAME_C, "C   ", 4) ||
+               !PDBNAMEMATCH(q->atnam_code, q->atnam,
+                             PDBNAME_N, "N   ", 4) ||
+               ISHETATM(p) || ISHETATM(q))
             {
                if(blIsBonded(p, q, tol))
                {
@@ -0,0 +1,578 @@
+/************************************************************************/
+/**
+
+   \file       CompactPDB.c
+
+   \version    V1.1
+   \date       18.10.26
+   \brief      Compact representation of a PDB linked list
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Each PDB record takes around 250 bytes, most of which is spent on
+   double precision values, CONECT pointers that are almost always
+   unused and fixed length name strings that are the same for many
+   atoms. A COMPACTPDB holds the same atoms as an array of COMPACTATOM
+   records which take around a fifth of the space:
+
+   - coordinates, occupancy and B-value are floats
+   - names (record type, atom name, residue name, chain, etc.) are
+     stored once in a table and each atom holds an index into it
+   - CONECTs are held in a separate array of atom index pairs, so atoms
+     without CONECTs take no space for them
+
+   The access, radius and partial_charge values and the extras and
+   atomInfo pointers are not kept; they are 0 or NULL when the atoms
+   are expanded back into a PDB linked list.
+
+   The names table may hold at most COMPACT_MAXNAMES different strings.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+\code
+   COMPACTPDB *cpdb;
+   cpdb = blCompactPDB(pdb);
+   FREELIST(pdb, PDB);
+   ...
+   pdb = blExpandCompactPDB(cpdb, &natoms);
+   blFreeCompactPDB(cpdb);
+\endcode
+
+   blGetCompactAtom() fills a single PDB record from a COMPACTATOM, so
+   atoms may be examined one at a time without expanding them all.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  18.10.26 Original
+-  V1.1  18.10.26 blGetCompactAtom() sets the name codes
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP Manipulating the PDB linked list
+   #FUNCTION  blCompactPDB()
+   Makes a compact copy of a PDB linked list
+
+   #FUNCTION  blExpandCompactPDB()
+   Makes a PDB linked list from a compact copy
+
+   #FUNCTION  blGetCompactAtom()
+   Fills in a PDB record from one atom of a compact copy
+
+   #FUNCTION  blFreeCompactPDB()
+   Frees a compact copy of a PDB linked list
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdlib.h>
+#include <string.h>
+
+#include "SysDefs.h"
+#include "pdb.h"
+#include "hash.h"
+#include "macros.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define NAMES_HASHSIZE 1009          /* Must be a prime number          */
+#define NAMES_CHUNK    64            /* Names table grows by this much  */
+
+/* Pairs an atom with its index while CONECTs are being converted       */
+typedef struct
+{
+   PDB *pdb;
+   int index;
+}  ATOMINDEX;
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL InternNames(COMPACTPDB *cpdb, HASHTABLE *hash, PDB *p,
+                        COMPACTATOM *c);
+static int InternName(COMPACTPDB *cpdb, HASHTABLE *hash, char *name);
+static BOOL CompactConects(COMPACTPDB *cpdb, PDB *pdb);
+static int CompareAtomIndex(const void *a, const void *b);
+static int FindAtomIndex(ATOMINDEX *lookup, int natoms, PDB *p);
+
+
+/************************************************************************/
+/*>COMPACTPDB *blCompactPDB(PDB *pdb)
+   ----------------------------------
+*//**
+
+   \param[in]     *pdb     PDB linked list
+   \return                 Compact copy. NULL if no memory or too many
+                           different names
+
+   Makes a compact copy of a PDB linked list. The linked list is not
+   changed. Free with blFreeCompactPDB().
+
+-  18.10.26 Original
+*/
+COMPACTPDB *blCompactPDB(PDB *pdb)
+{
+   COMPACTPDB  *cpdb;
+   COMPACTATOM *c;
+   HASHTABLE   *hash;
+   PDB         *p;
+   BOOL        ok        = TRUE,
+               hasConect = FALSE;
+   int         natoms    = 0;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      natoms++;
+      if(p->nConect)
+         hasConect = TRUE;
+   }
+
+   if((cpdb = (COMPACTPDB *)malloc(sizeof(COMPACTPDB)))==NULL)
+      return(NULL);
+   cpdb->natoms   = natoms;
+   cpdb->nconects = 0;
+   cpdb->nnames   = 0;
+   cpdb->names    = NULL;
+   cpdb->conects  = NULL;
+   cpdb->atoms    = (COMPACTATOM *)malloc((natoms + 1) *
+                                          sizeof(COMPACTATOM));
+
+   if((cpdb->atoms == NULL) ||
+      ((hash = blInitializeHash(NAMES_HASHSIZE))==NULL))
+   {
+      blFreeCompactPDB(cpdb);
+      return(NULL);
+   }
+
+   for(p=pdb, c=cpdb->atoms; p!=NULL; NEXT(p), c++)
+   {
+      c->x             = (float)p->x;
+      c->y             = (float)p->y;
+      c->z             = (float)p->z;
+      c->occ           = (float)p->occ;
+      c->bval          = (float)p->bval;
+      c->atnum         = p->atnum;
+      c->resnum        = p->resnum;
+      c->entity_id     = p->entity_id;
+      c->formal_charge = (signed char)p->formal_charge;
+      c->atomtype      = (char)p->atomtype;
+      c->altpos        = p->altpos;
+      c->secstr        = p->secstr;
+
+      if(!(ok = InternNames(cpdb, hash, p, c)))
+         break;
+   }
+   blFreeHash(hash);
+
+   if(ok && hasConect)
+      ok = CompactConects(cpdb, pdb);
+
+   if(!ok)
+   {
+      blFreeCompactPDB(cpdb);
+      return(NULL);
+   }
+
+   return(cpdb);
+}
+
+
+/************************************************************************/
+/*>PDB *blGetCompactAtom(COMPACTPDB *cpdb, int atom, PDB *pdb)
+   -----------------------------------------------------------
+*//**
+
+   \param[in]     *cpdb    Compact copy of a PDB linked list
+   \param[in]     atom     Index of the atom
+   \param[out]    *pdb     PDB record to fill in
+   \return                 pdb
+
+   Fills in a PDB record from one atom of a COMPACTPDB. The next and
+   CONECT pointers are set to NULL and nConect to 0; the CONECTs are
+   filled in by blExpandCompactPDB().
+
+-  18.10.26 Original
+-  18.10.26 Sets the name codes
+*/
+PDB *blGetCompactAtom(COMPACTPDB *cpdb, int atom, PDB *pdb)
+{
+   COMPACTATOM *c = cpdb->atoms + atom;
+   int         i;
+
+   CLEAR_PDB(pdb);
+
+   pdb->x             = (REAL)c->x;
+   pdb->y             = (REAL)c->y;
+   pdb->z             = (REAL)c->z;
+   pdb->occ           = (REAL)c->occ;
+   pdb->bval          = (REAL)c->bval;
+   pdb->atnum         = c->atnum;
+   pdb->resnum        = c->resnum;
+   pdb->entity_id     = c->entity_id;
+   pdb->formal_charge = (int)c->formal_charge;
+   pdb->atomtype      = (int)c->atomtype;
+   pdb->altpos        = c->altpos;
+   pdb->secstr        = c->secstr;
+
+   strcpy(pdb->record_type, cpdb->names[c->record_type]);
+   strcpy(pdb->atnam,       cpdb->names[c->atnam]);
+   strcpy(pdb->atnam_raw,   cpdb->names[c->atnam_raw]);
+   strcpy(pdb->resnam,      cpdb->names[c->resnam]);
+   strcpy(pdb->insert,      cpdb->names[c->insert]);
+   strcpy(pdb->chain,       cpdb->names[c->chain]);
+   strcpy(pdb->element,     cpdb->names[c->element]);
+   strcpy(pdb->segid,       cpdb->names[c->segid]);
+
+   for(i=0; i<MAXCONECT; i++)
+      pdb->conect[i] = NULL;
+
+   blSetPDBNameCodes(pdb);
+   return(pdb);
+}
+
+
+/************************************************************************/
+/*>PDB *blExpandCompactPDB(COMPACTPDB *cpdb, int *natoms)
+   ------------------------------------------------------
+*//**
+
+   \param[in]     *cpdb    Compact copy of a PDB linked list
+   \param[out]    *natoms  Number of atoms in the linked list
+   \return                 PDB linked list. NULL if no memory
+
+   Makes a PDB linked list from a COMPACTPDB, including the CONECTs.
+   The COMPACTPDB is not changed.
+
+-  18.10.26 Original
+*/
+PDB *blExpandCompactPDB(COMPACTPDB *cpdb, int *natoms)
+{
+   PDB  *pdb = NULL,
+        *p   = NULL,
+        **atoms = NULL;
+   int  i;
+
+   *natoms = 0;
+
+   /* Only need to look atoms up by index if there are CONECTs          */
+   if(cpdb->nconects)
+   {
+      if((atoms = (PDB **)malloc((cpdb->natoms + 1) * sizeof(PDB *)))
+         ==NULL)
+         return(NULL);
+   }
+
+   for(i=0; i<cpdb->natoms; i++)
+   {
+      if(pdb == NULL)
+      {
+         INIT(pdb, PDB);
+         p = pdb;
+      }
+      else
+      {
+         ALLOCNEXT(p, PDB);
+      }
+
+      if(p == NULL)
+      {
+         FREELIST(pdb, PDB);
+         FREE(atoms);
+         return(NULL);
+      }
+
+      blGetCompactAtom(cpdb, i, p);
+      if(atoms != NULL)
+         atoms[i] = p;
+   }
+
+   /* The CONECTs are sorted by atom so are added in the original order */
+   for(i=0; i<cpdb->nconects; i++)
+   {
+      p = atoms[cpdb->conects[i].atom];
+      p->conect[p->nConect++] = atoms[cpdb->conects[i].partner];
+   }
+
+   FREE(atoms);
+   *natoms = cpdb->natoms;
+   return(pdb);
+}
+
+
+/************************************************************************/
+/*>void blFreeCompactPDB(COMPACTPDB *cpdb)
+   ---------------------------------------
+*//**
+
+   \param[in]     *cpdb    Compact copy of a PDB linked list (may be
+                           NULL)
+
+   Frees a COMPACTPDB
+
+-  18.10.26 Original
+*/
+void blFreeCompactPDB(COMPACTPDB *cpdb)
+{
+   int i;
+
+   if(cpdb == NULL)
+      return;
+
+   if(cpdb->names != NULL)
+   {
+      for(i=0; i<cpdb->nnames; i++)
+      {
+         FREE(cpdb->names[i]);
+      }
+      free(cpdb->names);
+   }
+   FREE(cpdb->atoms);
+   FREE(cpdb->conects);
+   free(cpdb);
+}
+
+
+/************************************************************************/
+/*>static BOOL InternNames(COMPACTPDB *cpdb, HASHTABLE *hash, PDB *p,
+                           COMPACTATOM *c)
+   ------------------------------------------------------------------
+*//**
+
+   \param[in,out] *cpdb    Compact copy of a PDB linked list
+   \param[in,out] *hash    Hash of names already in the table
+   \param[in]     *p       PDB record
+   \param[out]    *c       Compact atom in which to set the name indexes
+   \return                 Success
+
+   Sets the indexes of all the names of an atom, adding the names to the
+   names table as needed
+
+-  18.10.26 Original
+*/
+static BOOL InternNames(COMPACTPDB *cpdb, HASHTABLE *hash, PDB *p,
+                        COMPACTATOM *c)
+{
+   char           *names[8];
+   unsigned short *codes[8];
+   int            i,
+                  index;
+
+   names[0] = p->record_type;   codes[0] = &(c->record_type);
+   names[1] = p->atnam;         codes[1] = &(c->atnam);
+   names[2] = p->atnam_raw;     codes[2] = &(c->atnam_raw);
+   names[3] = p->resnam;        codes[3] = &(c->resnam);
+   names[4] = p->insert;        codes[4] = &(c->insert);
+   names[5] = p->chain;         codes[5] = &(c->chain);
+   names[6] = p->element;       codes[6] = &(c->element);
+   names[7] = p->segid;         codes[7] = &(c->segid);
+
+   for(i=0; i<8; i++)
+   {
+      if((index = InternName(cpdb, hash, names[i])) < 0)
+         return(FALSE);
+      *(codes[i]) = (unsigned short)index;
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static int InternName(COMPACTPDB *cpdb, HASHTABLE *hash, char *name)
+   --------------------------------------------------------------------
+*//**
+
+   \param[in,out] *cpdb    Compact copy of a PDB linked list
+   \param[in,out] *hash    Hash of names already in the table
+   \param[in]     *name    Name to look up or add
+   \return                 Index of the name in the table. -1 if no
+                           memory or the table is full
+
+   Finds a name in the names table, adding it if it isn't there
+
+-  18.10.26 Original
+*/
+static int InternName(COMPACTPDB *cpdb, HASHTABLE *hash, char *name)
+{
+   char **names;
+   int  index;
+
+   if(blHashKeyDefined(hash, name))
+      return(blGetHashValueInt(hash, name));
+
+   if(cpdb->nnames >= COMPACT_MAXNAMES)
+      return(-1);
+
+   /* Grow the table if needed                                          */
+   if((cpdb->nnames % NAMES_CHUNK) == 0)
+   {
+      if((names = (char **)realloc(cpdb->names,
+                                   (cpdb->nnames + NAMES_CHUNK) *
+                                   sizeof(char *)))==NULL)
+         return(-1);
+      cpdb->names = names;
+   }
+
+   index = cpdb->nnames;
+   if((cpdb->names[index] = blStrdup(name))==NULL)
+      return(-1);
+   cpdb->nnames++;
+
+   if(!blSetHashValueInt(hash, name, index))
+      return(-1);
+
+   return(index);
+}
+
+
+/************************************************************************/
+/*>static BOOL CompactConects(COMPACTPDB *cpdb, PDB *pdb)
+   ------------------------------------------------------
+*//**
+
+   \param[in,out] *cpdb    Compact copy of a PDB linked list
+   \param[in]     *pdb     The PDB linked list
+   \return                 Success
+
+   Stores the CONECTs of the linked list as pairs of atom indexes. The
+   pairs are in order of atom and, within each atom, in the order of
+   its CONECTs. CONECTs to atoms not in the list are dropped.
+
+-  18.10.26 Original
+*/
+static BOOL CompactConects(COMPACTPDB *cpdb, PDB *pdb)
+{
+   ATOMINDEX *lookup;
+   PDB       *p;
+   int       i, j,
+             partner,
+             nconects = 0;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+      nconects += p->nConect;
+
+   /* Sort the atoms by address so CONECT pointers can be found        */
+   if((lookup = (ATOMINDEX *)malloc((cpdb->natoms + 1) *
+                                    sizeof(ATOMINDEX)))==NULL)
+      return(FALSE);
+   if((cpdb->conects = (COMPACTCONECT *)malloc((nconects + 1) *
+                                               sizeof(COMPACTCONECT)))
+      ==NULL)
+   {
+      free(lookup);
+      return(FALSE);
+   }
+
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      lookup[i].pdb   = p;
+      lookup[i].index = i;
+   }
+   qsort(lookup, cpdb->natoms, sizeof(ATOMINDEX), CompareAtomIndex);
+
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      for(j=0; j<p->nConect; j++)
+      {
+         partner = FindAtomIndex(lookup, cpdb->natoms, p->conect[j]);
+         if(partner >= 0)
+         {
+            cpdb->conects[cpdb->nconects].atom    = i;
+            cpdb->conects[cpdb->nconects].partner = partner;
+            cpdb->nconects++;
+         }
+      }
+   }
+
+   free(lookup);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static int CompareAtomIndex(const void *a, const void *b)
+   ---------------------------------------------------------
+*//**
+
+   \param[in]     *a       First ATOMINDEX
+   \param[in]     *b       Second ATOMINDEX
+   \return                 -1, 0 or 1 as for strcmp()
+
+   qsort() comparison of ATOMINDEX by atom address
+
+-  18.10.26 Original
+*/
+static int CompareAtomIndex(const void *a, const void *b)
+{
+   PDB *pa = ((ATOMINDEX *)a)->pdb,
+       *pb = ((ATOMINDEX *)b)->pdb;
+
+   if(pa < pb) return(-1);
+   if(pa > pb) return(1);
+   return(0);
+}
+
+
+/************************************************************************/
+/*>static int FindAtomIndex(ATOMINDEX *lookup, int natoms, PDB *p)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]     *lookup  ATOMINDEX array sorted by CompareAtomIndex()
+   \param[in]     natoms   Number of items in lookup
+   \param[in]     *p       Atom to find
+   \return                 Index of the atom. -1 if not found
+
+   Binary search for an atom's index
+
+-  18.10.26 Original
+*/
+static int FindAtomIndex(ATOMINDEX *lookup, int natoms, PDB *p)
+{
+   ATOMINDEX key,
+             *found;
+
+   key.pdb = p;
+   found   = (ATOMINDEX *)bsearch(&key, lookup, natoms,
+                                  sizeof(ATOMINDEX), CompareAtomIndex);
+
+   return((found != NULL) ? found->index : -1);
+}
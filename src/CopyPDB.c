@@ -3,11 +3,11 @@
 
    \file       CopyPDB.c
    
-   \version    V1.11
-   \date       07.07.14
+   \version    V1.12
+   \date       18.10.26
    \brief      PDB linked list manipulation
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-6
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -58,6 +58,7 @@
 -  V1.9  14.03.96 Added FindAtomInRes()
 -  V1.10 08.10.99 Initialised some variables
 -  V1.11 07.07.14 Use bl prefix for functions By: CTP
+-  V1.12 18.10.26 blCopyPDB() does not copy the list's indexes
 
 *************************************************************************/
 /* Doxygen
@@ -99,16 +100,19 @@
    \param[in]     *in     Input PDB record pointer
    \param[out]    *out    Output PDB record pointer
 
-   Copy a PDB record, except that the ->next is set to NULL;
+   Copy a PDB record, except that the ->next and ->indexes are set to
+   NULL;
 
 -  12.05.92 Original    By: ACRM
 -  17.07.01 Now uses the generic *out=*in
 -  07.07.14 Use bl prefix for functions By: CTP
+-  18.10.26 Sets ->indexes to NULL
 */
 void blCopyPDB(PDB *out,
                PDB *in)
 {
    *out = *in;
-   out->next   = NULL;
+   out->next    = NULL;
+   out->indexes = NULL;
 }
 
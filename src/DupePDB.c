@@ -3,11 +3,11 @@
 
    \file       DupePDB.c
    
-   \version    V1.12
-   \date       19.04.15
+   \version    V1.13
+   \date       18.10.26
    \brief      PDB linked list manipulation
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -59,6 +59,7 @@
 -  V1.10 08.10.99 Initialised some variables
 -  V1.11 07.07.14 Use bl prefix for functions By: CTP
 -  V1.12 19.04.15 Added call to blCopyConect()   By: ACRM
+-  V1.13 18.10.26 Added blDupePDBArena()
 
 *************************************************************************/
 /* Doxygen
@@ -68,6 +69,9 @@
    #FUNCTION  blDupePDB()
    Duplicates a PDB linked list. CONECT data are updated to point within
    the new list.
+
+   #FUNCTION  blDupePDBArena()
+   As blDupePDB() but can allocate the new list from an arena.
 */
 /************************************************************************/
 /* Includes
@@ -109,8 +113,33 @@
 -  08.10.99 Initialise q to NULL
 -  07.07.14 Use bl prefix for functions By: CTP
 -  19.04.15 Added call to blCopyConect()   By: ACRM
+-  18.10.26 Now a wrapper to blDupePDBArena()
 */
 PDB *blDupePDB(PDB *in)
+{
+   return(blDupePDBArena(in, NULL));
+}
+
+
+/************************************************************************/
+/*>PDB *blDupePDBArena(PDB *in, ARENA *arena)
+   ------------------------------------------
+*//**
+
+   \param[in]     *in     Input PDB linked list
+   \param[in,out] *arena  Arena from which to allocate the new list.
+                          NULL to use malloc()
+   \return                Duplicated PDB linked list
+                          (NULL on allocation failure)
+
+   As blDupePDB(), but if an arena is given the new list is allocated 
+   from it, with the atoms contiguous in memory and in list order. The 
+   list is then freed with the arena rather than with FREELIST(). On 
+   failure, anything already allocated from the arena is left there.
+
+-  18.10.26 Original
+*/
+PDB *blDupePDBArena(PDB *in, ARENA *arena)
 {
    PDB *out = NULL,
        *p, *q = NULL;
@@ -119,16 +148,16 @@ PDB *blDupePDB(PDB *in)
    {
       if(out==NULL)
       {
-         INIT(out, PDB);
+         INITARENA(out, PDB, arena);
          q=out;
       }
       else
       {
-         ALLOCNEXT(q, PDB);
+         ALLOCNEXTARENA(q, PDB, arena);
       }
       if(q==NULL)
       {
-         FREELIST(out, PDB);
+         if(arena == NULL) FREELIST(out, PDB);
          return(NULL);
       }
       
@@ -137,11 +166,9 @@ PDB *blDupePDB(PDB *in)
    
    if(!blCopyConects(out, in))
    {
-      FREELIST(out, PDB);
+      if(arena == NULL) FREELIST(out, PDB);
       return(NULL);
    }
 
    return(out);
 }
-
-
@@ -3,11 +3,11 @@
 
    \file       ExtractZonePDB.c
    
-   \version    V1.19
-   \date       17.02.16
+   \version    V1.21
+   \date       18.10.26
    \brief      PDB linked list manipulation
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-2016
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -67,6 +67,8 @@
                   blExtractNotZonePDBAsCopy() By: ACRM
 -  V1.18 08.12.15 Modified blExtractZoneAsCopy() to check for exact 
                   match first
+-  V1.20 18.10.26 Added blExtractZonePDBAsView()
+-  V1.21 18.10.26 A zone which ends before it starts is not found
 
 *************************************************************************/
 /* Doxygen
@@ -78,6 +80,10 @@
    forming a new linked list. Uses separate chain, residue number and 
    insert rather than residue specifications.
 
+   #FUNCTION  blExtractZonePDBAsView()
+   As blExtractZonePDBAsCopy() but makes a selection of the atoms in
+   the zone rather than copying them.
+
    #FUNCTION  blExtractZoneSpecPDBAsCopy()
    Reduces a PDB linked list to those residues within a specified zone
    forming a new linked list. Uses residue specifications ([c]nnn[i])
@@ -116,6 +122,10 @@
 /************************************************************************/
 /* Prototypes
 */
+static BOOL FindZone(PDB *pdb, 
+                     char *chain1, int resnum1, char *insert1, 
+                     char *chain2, int resnum2, char *insert2,
+                     PDB **pStart, PDB **pPrev, PDB **pLast);
 
 /************************************************************************/
 /*>PDB *blExtractZonePDBAsCopy(PDB *inpdb, char *chain1, int resnum1, 
@@ -152,6 +162,9 @@
             uses the insert code for something different! By: ACRM
 -  17.02.16 Added fix on check for exact match - prev wasn't being set
             correctly if the match was to the first residue in the file
+-  18.10.26 Finding the zone moved to FindZone()
+-  18.10.26 Returns NULL if the zone ends before it starts rather than
+            a list that has been freed
 
 ***    TODO - This doesn't deal with CONECT information properly!      ***
 */
@@ -159,7 +172,7 @@ PDB *blExtractZonePDBAsCopy(PDB *inpdb,
                             char *chain1, int resnum1, char *insert1, 
                             char *chain2, int resnum2, char *insert2)
 {
-   PDB *pdb, *p, 
+   PDB *pdb, 
        *start = NULL, 
        *last  = NULL, 
        *prev  = NULL;
@@ -168,96 +181,8 @@ PDB *blExtractZonePDBAsCopy(PDB *inpdb,
    if((pdb = blDupePDB(inpdb))==NULL)
       return(NULL);
 
-   /* Try to find the exact residue specification, setting start to the
-      start of that residue and prev to the last atom of the previous
-      residue
-   */
-   if((start=blFindResidue(pdb, chain1, resnum1, insert1))!=NULL)
-   {
-      /* Find the previous atom                                         */
-      if(start==pdb)
-      {
-         prev=NULL;
-      }
-      else
-      {
-         for(prev=pdb; prev->next!=start; NEXT(prev)) ;
-      }
-      
-   }
-   else
-   {
-      /* We didn't find an exact match so find the residue that would
-         follow that residue specification.
-         Again prev will point to the last atom before the first atom in
-         the zone and start will point to the first atom in the zone
-      */
-      for(p=pdb; p!=NULL; NEXT(p))
-      {
-         if(CHAINMATCH(p->chain,chain1) &&
-            ((p->resnum > resnum1) ||
-             ((p->resnum == resnum1) &&
-              (p->insert[0] >= insert1[0]))))
-         {
-            start = p;
-            break;
-         }
-         prev = p;
-      }
-   }
-
-   /* If we didn't find anything then exit                              */
-   if(start==NULL)
-   {
-      FREELIST(pdb, PDB);
-      return(NULL);
-   }
-
-
-   /* See if we have an exact match to the residue requested
-      last will be the last atom in that residue
-   */
-   if((last=blFindResidue(pdb, chain2, resnum2, insert2))!=NULL)
-   {
-      PDB *nextres = blFindNextResidue(last);
-
-      /* Step to the end of this residue                                */
-      for(; last->next!=nextres; NEXT(last)) ;
-   }
-   else
-   {
-      /* There was no exact match so find the one after that residue
-         specification. 
-         Again, last will point to the last atom in the zone
-
-         29.10.10 Also breaks out if chain1 and chain2 are the same but
-         we've now come to a different chain. This fixes a bug where
-         the code wouldn't break out if resnum2 was the last residue in
-         a chain By: ACRM
-      */
-      for(p=start; p!=NULL; NEXT(p))
-      {
-         if(CHAINMATCH(p->chain,chain2) && /* If same chain and...      */
-            ((p->resnum > resnum2) ||      /* Residue number exceeded or*/
-             ((p->resnum == resnum2) &&    /* Resnum same and...        */
-              (p->insert[0] > insert2[0]))))  /* insert exceeded        */
-         {
-            break;
-         }
-         /* Both zone ends are in the same chain so, if we got here we have 
-            found the right chain. If the current chain is now different 
-            from chain2, then we've gone off the end of the chain
-         */
-         if( CHAINMATCH(chain1,chain2) &&
-             !CHAINMATCH(p->chain,chain2))
-         {
-            break;
-         }
-         last = p;
-      }
-   }
-
-   if(last==NULL)
+   if(!FindZone(pdb, chain1, resnum1, insert1, chain2, resnum2, insert2,
+                &start, &prev, &last))
    {
       FREELIST(pdb, PDB);
       return(NULL);
@@ -433,3 +358,204 @@ PDB *blExtractNotZoneSpecPDBAsCopy(PDB *pdb, char *firstRes,
 }
 
 
+/************************************************************************/
+/*>PDBSELECTION *blExtractZonePDBAsView(PDB *inpdb, char *chain1,
+                                        int resnum1, char *insert1,
+                                        char *chain2, int resnum2,
+                                        char *insert2)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]     *inpdb   Input PDB linked list
+   \param[in]     *chain1  Start residue chain name
+   \param[in]     resnum1  Start residue number
+   \param[in]     *insert1 Start residue insert code
+   \param[in]     *chain2  End residue chain name
+   \param[in]     resnum2  End residue number
+   \param[in]     *insert2 End residue insert code
+   \return                 Selection of the atoms in the zone. NULL if
+                           the zone was not found, ends before it
+                           starts or no memory
+
+   As blExtractZonePDBAsCopy(), but the atoms are not copied. Instead
+   the selection points to the atoms of the zone in the input list.
+   Free with blFreePDBSelection().
+
+-  18.10.26 Original
+-  18.10.26 Returns NULL if the zone ends before it starts
+*/
+PDBSELECTION *blExtractZonePDBAsView(PDB *inpdb, 
+                                     char *chain1, int resnum1,
+                                     char *insert1, 
+                                     char *chain2, int resnum2,
+                                     char *insert2)
+{
+   PDBSELECTION *view;
+   PDB          *start,
+                *prev,
+                *last,
+                *p;
+
+   if(!FindZone(inpdb, chain1, resnum1, insert1, chain2, resnum2, insert2,
+                &start, &prev, &last))
+      return(NULL);
+
+   if((view = blAllocPDBSelection(inpdb))==NULL)
+      return(NULL);
+
+   for(p=start; p!=last->next; NEXT(p))
+   {
+      if(!blAddAtomToPDBSelection(view, p))
+      {
+         blFreePDBSelection(view);
+         return(NULL);
+      }
+   }
+
+   return(view);
+}
+
+
+/************************************************************************/
+/*>static BOOL FindZone(PDB *pdb, 
+                        char *chain1, int resnum1, char *insert1, 
+                        char *chain2, int resnum2, char *insert2,
+                        PDB **pStart, PDB **pPrev, PDB **pLast)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]     *pdb     PDB linked list
+   \param[in]     *chain1  Start residue chain name
+   \param[in]     resnum1  Start residue number
+   \param[in]     *insert1 Start residue insert code
+   \param[in]     *chain2  End residue chain name
+   \param[in]     resnum2  End residue number
+   \param[in]     *insert2 End residue insert code
+   \param[out]    **pStart First atom in the zone
+   \param[out]    **pPrev  Atom before the zone (NULL if the zone
+                           starts the list)
+   \param[out]    **pLast  Last atom in the zone
+   \return                 Was the zone found? FALSE if the end of the
+                           zone comes before its start
+
+   Finds the atoms of a zone for blExtractZonePDBAsCopy() and
+   blExtractZonePDBAsView(). The linked list is not changed.
+
+-  18.10.26 Original, taken from blExtractZonePDBAsCopy()
+-  18.10.26 Fails if the zone ends before it starts
+*/
+static BOOL FindZone(PDB *pdb, 
+                     char *chain1, int resnum1, char *insert1, 
+                     char *chain2, int resnum2, char *insert2,
+                     PDB **pStart, PDB **pPrev, PDB **pLast)
+{
+   PDB *p, 
+       *start = NULL, 
+       *last  = NULL, 
+       *prev  = NULL;
+
+   /* Try to find the exact residue specification, setting start to the
+      start of that residue and prev to the last atom of the previous
+      residue
+   */
+   if((start=blFindResidue(pdb, chain1, resnum1, insert1))!=NULL)
+   {
+      /* Find the previous atom                                         */
+      if(start==pdb)
+      {
+         prev=NULL;
+      }
+      else
+      {
+         for(prev=pdb; prev->next!=start; NEXT(prev)) ;
+      }
+      
+   }
+   else
+   {
+      /* We didn't find an exact match so find the residue that would
+         follow that residue specification.
+         Again prev will point to the last atom before the first atom in
+         the zone and start will point to the first atom in the zone
+      */
+      for(p=pdb; p!=NULL; NEXT(p))
+      {
+         if(CHAINMATCH(p->chain,chain1) &&
+            ((p->resnum > resnum1) ||
+             ((p->resnum == resnum1) &&
+              (p->insert[0] >= insert1[0]))))
+         {
+            start = p;
+            break;
+         }
+         prev = p;
+      }
+   }
+
+   /* If we didn't find anything then exit                              */
+   if(start==NULL)
+   {
+      return(FALSE);
+   }
+
+
+   /* See if we have an exact match to the residue requested
+      last will be the last atom in that residue
+   */
+   if((last=blFindResidue(pdb, chain2, resnum2, insert2))!=NULL)
+   {
+      PDB *nextres = blFindNextResidue(last);
+
+      /* Step to the end of this residue                                */
+      for(; last->next!=nextres; NEXT(last)) ;
+   }
+   else
+   {
+      /* There was no exact match so find the one after that residue
+         specification. 
+         Again, last will point to the last atom in the zone
+
+         29.10.10 Also breaks out if chain1 and chain2 are the same but
+         we've now come to a different chain. This fixes a bug where
+         the code wouldn't break out if resnum2 was the last residue in
+         a chain By: ACRM
+      */
+      for(p=start; p!=NULL; NEXT(p))
+      {
+         if(CHAINMATCH(p->chain,chain2) && /* If same chain and...      */
+            ((p->resnum > resnum2) ||      /* Residue number exceeded or*/
+             ((p->resnum == resnum2) &&    /* Resnum same and...        */
+              (p->insert[0] > insert2[0]))))  /* insert exceeded        */
+         {
+            break;
+         }
+         /* Both zone ends are in the same chain so, if we got here we have 
+            found the right chain. If the current chain is now different 
+            from chain2, then we've gone off the end of the chain
+         */
+         if( CHAINMATCH(chain1,chain2) &&
+             !CHAINMATCH(p->chain,chain2))
+         {
+            break;
+         }
+         last = p;
+      }
+   }
+
+   if(last==NULL)
+   {
+      return(FALSE);
+   }
+
+   /* If the zone ends before it starts, there is nothing in it         */
+   for(p=start; (p!=NULL) && (p!=last); NEXT(p)) ;
+   if(p==NULL)
+   {
+      return(FALSE);
+   }
+
+   *pStart = start;
+   *pPrev  = prev;
+   *pLast  = last;
+   return(TRUE);
+}
@@ -3,8 +3,8 @@
 
    \file       FindNextChainPDB.c
    
-   \version    V1.12
-   \date       07.07.14
+   \version    V1.13
+   \date       18.10.26
    \brief      PDB linked list manipulation
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-2014
@@ -59,6 +59,7 @@
 -  V1.10 08.10.99 Initialised some variables
 -  V1.11 04.02.14 Use CHAINMATCH By: CTP
 -  V1.12 07.07.14 Use bl prefix for functions By: CTP
+-  V1.13 18.10.26 blFindNextChainPDB() detaches any indexes of the list
 *************************************************************************/
 /* Doxygen
    -------
@@ -108,10 +109,13 @@
 -  23.05.94 Original    By: ACRM
 -  04.02.14 Use CHAINMATCH By: CTP
 -  07.07.14 Use bl prefix for functions By: CTP
+-  18.10.26 Detaches any indexes of the list
 */
 PDB *blFindNextChainPDB(PDB *pdb)
 {
    PDB  *p, *ret = NULL;
+
+   blDetachPDBIndexes(pdb);
    
    for(p=pdb; p!=NULL; NEXT(p))
    {
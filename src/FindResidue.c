@@ -3,11 +3,11 @@
 
    \file       FindResidue.c
    
-   \version    V1.11
-   \date       07.07.14
+   \version    V1.14
+   \date       18.10.26
    \brief      Parse a residue specification
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2014
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -63,6 +63,9 @@
 -  V1.9  25.02.14 Added error message for FindResidue(). By: CTP
 -  V1.10 07.05.14 Moved FindResidue() to deprecated.h. By: CTP
 -  V1.11 07.07.14 Use bl prefix for functions By: CTP
+-  V1.12 18.10.26 blFindResidue() uses gPDBResidueIndex if set
+-  V1.13 18.10.26 Uses the residue index attached to the list instead
+-  V1.14 18.10.26 Checks the residue found from the index
 
 
 *************************************************************************/
@@ -110,13 +113,31 @@
    Finds a pointer to the start of a residue in a PDB linked list.
    Uses string for chain and insert.
 
+   If a residue index is attached to this linked list (see
+   blAttachResidueIndex()), it is used rather than searching the list.
+   If the residue found from the index no longer has the identifier
+   that was looked up, the residue IDs have been changed since the
+   index was built, so the index is detached and the list is searched.
+
 -  24.02.14 Original   By: CTP
 -  07.07.14 Renamed to blFindResidue()
             Use bl prefix for functions By: CTP
+-  18.10.26 Uses gPDBResidueIndex if set
+-  18.10.26 Uses the residue index attached to the list instead
+-  18.10.26 Checks the residue found from the index
 */
 PDB *blFindResidue(PDB *pdb, char *chain, int resnum, char *insert)
 {
-   PDB *p;
+   PDB          *p;
+   RESIDUEINDEX *index;
+
+   if((index = blGetResidueIndex(pdb)) != NULL)
+   {
+      p = blFindResidueInIndex(index, chain, resnum, insert, NULL);
+      if((p == NULL) || RESIDIS(p, chain, resnum, insert))
+         return(p);
+      blDetachPDBIndexes(pdb);
+   }
 
    for(p=pdb; p!=NULL; NEXT(p))
    {
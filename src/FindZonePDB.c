@@ -3,11 +3,11 @@
 
    \file       FindZonePDB.c
    
-   \version    V1.6
-   \date       07.05.14
+   \version    V1.9
+   \date       18.10.26
    \brief      Routines for handling zones in PDB linked lists
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2014
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -52,6 +52,9 @@
 -  V1.3  19.09.96 Added InPDBZoneSpec()
 -  V1.5  20.03.14 Added blFindZonePDB() and deprecated InPDBZone() By: CTP
 -  V1.6  07.05.14 Moved FindZonePDB() to deprecated.h By: CTP
+-  V1.7  18.10.26 blFindZonePDB() uses gPDBResidueIndex if set
+-  V1.8  18.10.26 Uses the residue index attached to the list instead
+-  V1.9  18.10.26 Checks the residues found from the index
 
 *************************************************************************/
 
@@ -97,10 +100,19 @@
    Finds pointers to the start and end of a zone in a PDB linked list. The
    end is the atom *after* the specified zone
 
+   If a residue index is attached to this linked list (see
+   blAttachResidueIndex()), it is used to find a zone in a named chain
+   given by residue numbers. If the residues found from the index no
+   longer have the identifiers that were looked up, the index is
+   detached and the list is searched.
+
 -  20.03.14 Function based on FindZonePDB() but takes string for chain 
             label and insert instead of single char. 
             Function finds end of chain properly if stop set to -999.
             By: CTP
+-  18.10.26 Uses gPDBResidueIndex if set
+-  18.10.26 Uses the residue index attached to the list instead
+-  18.10.26 Checks the residues found from the index
 */
 BOOL blFindZonePDB(PDB   *pdb,
                    int   start,
@@ -118,6 +130,7 @@ BOOL blFindZonePDB(PDB   *pdb,
    BOOL  InStop     = FALSE,
          FoundChain = FALSE;
    char  insert[8];
+   RESIDUEINDEX *index;
    
    /* To start, we don't know where either are                          */
    *pdb_start = NULL;
@@ -158,6 +171,25 @@ BOOL blFindZonePDB(PDB   *pdb,
       }
    }
    
+   /* If we have an index of this list, look up both ends directly      */
+   if((mode == ZONE_MODE_RESNUM) && (start != (-999)) && 
+      (stop != (-999)) && !CHAINMATCH(chain," ") &&
+      ((index = blGetResidueIndex(pdb)) != NULL))
+   {
+      *pdb_start = blFindResidueInIndex(index, chain, start, startinsert,
+                                        NULL);
+      p = blFindResidueInIndex(index, chain, stop, stopinsert, pdb_stop);
+      if(((*pdb_start == NULL) ||
+          RESIDIS(*pdb_start, chain, start, startinsert)) &&
+         ((p == NULL) || RESIDIS(p, chain, stop, stopinsert)))
+         return((*pdb_start==NULL)?FALSE:TRUE);
+
+      /* The residue IDs have changed since the index was built         */
+      blDetachPDBIndexes(pdb);
+      *pdb_start = NULL;
+      *pdb_stop  = NULL;
+   }
+
    /* Handle one end of a zone being set to -999                        */
    if(start == -999) *pdb_start = pdb;
    if(stop  == -999) *pdb_stop  = NULL;
@@ -3,12 +3,12 @@
 
    \file       FitCaPDB.c
    
-   \version    V1.6
-   \date       19.08.14
+   \version    V1.7
+   \date       18.10.26
    \brief      Fit two PDB linked lists. Also a weighted fit and support
                routines
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2009
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -60,6 +60,7 @@
    - V1.5 07.07.14 Use bl prefix for functions By: CTP
    - V1.6 19.08.14 Fixed calls to renamed function:
                    blSelectAtomsPDBAsCopy() By: CTP
+   - V1.7 18.10.26 Uses a selection of the CA atoms rather than copies
 
 *************************************************************************/
 /* Doxygen
@@ -113,85 +114,78 @@
 -  28.01.09 Initialize RetVal to TRUE!
 -  07.07.14 Use bl prefix for functions By: CTP
 -  19.08.14 Added AsCopy suffix to calls to blSelectAtomsPDB() By: CTP
+-  18.10.26 Uses blSelectAtomsPDBAsView() rather than copying the atoms
 */
 BOOL blFitCaPDB(PDB *ref_pdb, PDB *fit_pdb, REAL rm[3][3])
 {
-   REAL  RotMat[3][3];
-   COOR  *ref_coor   = NULL,
-         *fit_coor   = NULL;
-   VEC3F ref_ca_CofG,
-         fit_ca_CofG,
-         tvect;
-   int   NCoor       = 0,
-         i, j,
-         natoms;
-   BOOL  RetVal = TRUE;
-   PDB   *ref_ca_pdb = NULL,
-         *fit_ca_pdb = NULL;
-   char  *sel[2];
-
-   /* First extract only the CA atoms                                   */
+   REAL         RotMat[3][3];
+   COOR         *ref_coor = NULL,
+                *fit_coor = NULL;
+   VEC3F        ref_ca_CofG,
+                fit_ca_CofG,
+                tvect;
+   int          NCoor     = 0,
+                i, j;
+   BOOL         RetVal    = TRUE;
+   PDBSELECTION *ref_ca   = NULL,
+                *fit_ca   = NULL;
+   char         *sel[1];
+
+   /* First select only the CA atoms                                    */
    SELECT(sel[0], "CA  ");
    if(sel[0]==NULL)
       return(FALSE);
-   if( (ref_ca_pdb = blSelectAtomsPDBAsCopy(ref_pdb, 1, sel, &natoms))
-       == NULL )
-      RetVal = FALSE;
-   if( (fit_ca_pdb = blSelectAtomsPDBAsCopy(fit_pdb, 1, sel, &natoms))
-       == NULL )
-      RetVal = FALSE;
+   ref_ca = blSelectAtomsPDBAsView(ref_pdb, 1, sel);
+   fit_ca = blSelectAtomsPDBAsView(fit_pdb, 1, sel);
    free(sel[0]);
-   
-   /* If we succeeded in building our CA PDB linked lists...            */
-   if(RetVal)
+
+   /* Check we have the selections and that the numbers match. Can't
+      fit with fewer than 3 coordinates
+   */
+   if((ref_ca == NULL) || (fit_ca == NULL) ||
+      (fit_ca->natoms != ref_ca->natoms) || (ref_ca->natoms < 3))
    {
-      /* Get the CofG of the CA structures and the original mobile      */
-      blGetCofGPDB(ref_ca_pdb, &ref_ca_CofG);
-      blGetCofGPDB(fit_ca_pdb, &fit_ca_CofG);
-      
-      /* Move them both to the origin                                   */
-      blOriginPDB(ref_ca_pdb);
-      blOriginPDB(fit_ca_pdb);
+      RetVal = FALSE;
+   }
+   else
+   {
+      /* Get the CofG of the CA atoms                                   */
+      blGetCofGPDBSelection(ref_ca, &ref_ca_CofG);
+      blGetCofGPDBSelection(fit_ca, &fit_ca_CofG);
       
-      /* Create coordinate arrays, checking numbers match               */
-      NCoor = blGetPDBCoor(ref_ca_pdb, &ref_coor);
-      if(blGetPDBCoor(fit_ca_pdb, &fit_coor) != NCoor)
+      /* Create coordinate arrays moved to the origin                   */
+      NCoor = blGetPDBSelectionCoor(ref_ca, &ref_ca_CofG, &ref_coor);
+      if((NCoor == 0) ||
+         (blGetPDBSelectionCoor(fit_ca, &fit_ca_CofG, &fit_coor)
+          != NCoor))
       {
          RetVal = FALSE;
       }
       else
       {
-         /* Can't fit with fewer than 3 coordinates                     */
-         if(NCoor < 3)
+         /* Everything OK, go ahead with the fitting                    */
+         if(!blMatfit(ref_coor,fit_coor,RotMat,NCoor,NULL,FALSE))
          {
             RetVal = FALSE;
          }
          else
          {
-            /* Everything OK, go ahead with the fitting                 */
-            if(!blMatfit(ref_coor,fit_coor,RotMat,NCoor,NULL,FALSE))
-            {
-               RetVal = FALSE;
-            }
-            else
-            {
-               /* Apply the operations to the true coordinates          */
-               tvect.x = (-fit_ca_CofG.x);
-               tvect.y = (-fit_ca_CofG.y);
-               tvect.z = (-fit_ca_CofG.z);
-               blTranslatePDB(fit_pdb, tvect);
-               blApplyMatrixPDB(fit_pdb, RotMat);
-               blTranslatePDB(fit_pdb, ref_ca_CofG);
-            }
+            /* Apply the operations to the true coordinates             */
+            tvect.x = (-fit_ca_CofG.x);
+            tvect.y = (-fit_ca_CofG.y);
+            tvect.z = (-fit_ca_CofG.z);
+            blTranslatePDB(fit_pdb, tvect);
+            blApplyMatrixPDB(fit_pdb, RotMat);
+            blTranslatePDB(fit_pdb, ref_ca_CofG);
          }
       }
    }
    
-   /* Free the coordinate arrays and CA PDB linked lists                */
-   if(ref_coor)   free(ref_coor);
-   if(fit_coor)   free(fit_coor);
-   if(ref_ca_pdb) FREELIST(ref_ca_pdb, PDB);
-   if(fit_ca_pdb) FREELIST(fit_ca_pdb, PDB);
+   /* Free the coordinate arrays and CA selections                      */
+   if(ref_coor) free(ref_coor);
+   if(fit_coor) free(fit_coor);
+   blFreePDBSelection(ref_ca);
+   blFreePDBSelection(fit_ca);
          
    /* Fill in the rotation matrix for output, if required               */
    if(RetVal && (rm!=NULL))
@@ -203,4 +197,3 @@ BOOL blFitCaPDB(PDB *ref_pdb, PDB *fit_pdb, REAL rm[3][3])
 
    return(RetVal);
 }
-
@@ -3,12 +3,12 @@
 
    \file       FitNCaCPDB.c
    
-   \version    V1.5
-   \date       19.08.14
+   \version    V1.6
+   \date       18.10.26
    \brief      Fit two PDB linked lists. Also a weighted fit and support
                routines
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-6
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -58,6 +58,8 @@
 -  V1.4  07.07.14 Use bl prefix for functions By: CTP
 -  V1.5  19.08.14 Added AsCopy suffix to calls to blSelectAtomsPDB() 
                   By: CTP
+-  V1.6  18.10.26 Uses a selection of the backbone atoms rather than
+                  copies
 
 *************************************************************************/
 /* Doxygen
@@ -111,89 +113,83 @@
 -  07.07.14 Use bl prefix for functions By: CTP
 -  19.08.14 Added AsCopy suffix to calls to blSelectAtomsPDB() By: CTP
 -  03.11.17 Initialize RetVal! By: ACRM
+-  18.10.26 Uses blSelectAtomsPDBAsView() rather than copying the
+            atoms. No longer tests the unused sel[3]
 */
 BOOL blFitNCaCPDB(PDB *ref_pdb, PDB *fit_pdb, REAL rm[3][3])
 {
-   REAL  RotMat[3][3];
-   COOR  *ref_coor   = NULL,
-         *fit_coor   = NULL;
-   VEC3F ref_bb_CofG,
-         fit_bb_CofG,
-         tvect;
-   int   NCoor       = 0,
-         i, j,
-         natoms;
-   BOOL  RetVal = TRUE;
-   PDB   *ref_bb_pdb = NULL,
-         *fit_bb_pdb = NULL;
-   char  *sel[4];
-
-   /* First extract only the backbone (BB) atoms                         */
+   REAL         RotMat[3][3];
+   COOR         *ref_coor = NULL,
+                *fit_coor = NULL;
+   VEC3F        ref_bb_CofG,
+                fit_bb_CofG,
+                tvect;
+   int          NCoor     = 0,
+                i, j;
+   BOOL         RetVal    = TRUE;
+   PDBSELECTION *ref_bb   = NULL,
+                *fit_bb   = NULL;
+   char         *sel[3];
+
+   /* First select only the backbone (BB) atoms                         */
    SELECT(sel[0], "N   ");
    SELECT(sel[1], "CA  ");
    SELECT(sel[2], "C   ");
-   if((sel[0]==NULL)||(sel[1]==NULL)||(sel[2]==NULL)||(sel[3]==NULL))
+   if((sel[0]==NULL)||(sel[1]==NULL)||(sel[2]==NULL))
       return(FALSE);
-   if( (ref_bb_pdb = blSelectAtomsPDBAsCopy(ref_pdb, 3, sel, &natoms))
-       == NULL )
-      RetVal = FALSE;
-   if( (fit_bb_pdb = blSelectAtomsPDBAsCopy(fit_pdb, 3, sel, &natoms))
-       == NULL )
-      RetVal = FALSE;
+   ref_bb = blSelectAtomsPDBAsView(ref_pdb, 3, sel);
+   fit_bb = blSelectAtomsPDBAsView(fit_pdb, 3, sel);
    free(sel[0]);
    free(sel[1]);
    free(sel[2]);
-   
-   /* If we succeeded in building our BB PDB linked lists...            */
-   if(RetVal)
+
+   /* Check we have the selections and that the numbers match. Can't
+      fit with fewer than 3 coordinates
+   */
+   if((ref_bb == NULL) || (fit_bb == NULL) ||
+      (fit_bb->natoms != ref_bb->natoms) || (ref_bb->natoms < 3))
    {
-      /* Get the CofG of the BB structures and the original mobile      */
-      blGetCofGPDB(ref_bb_pdb, &ref_bb_CofG);
-      blGetCofGPDB(fit_bb_pdb, &fit_bb_CofG);
-      
-      /* Move them both to the origin                                   */
-      blOriginPDB(ref_bb_pdb);
-      blOriginPDB(fit_bb_pdb);
+      RetVal = FALSE;
+   }
+   else
+   {
+      /* Get the CofG of the BB atoms                                   */
+      blGetCofGPDBSelection(ref_bb, &ref_bb_CofG);
+      blGetCofGPDBSelection(fit_bb, &fit_bb_CofG);
       
-      /* Create coordinate arrays, checking numbers match               */
-      NCoor = blGetPDBCoor(ref_bb_pdb, &ref_coor);
-      if(blGetPDBCoor(fit_bb_pdb, &fit_coor) != NCoor)
+      /* Create coordinate arrays moved to the origin                   */
+      NCoor = blGetPDBSelectionCoor(ref_bb, &ref_bb_CofG, &ref_coor);
+      if((NCoor == 0) ||
+         (blGetPDBSelectionCoor(fit_bb, &fit_bb_CofG, &fit_coor)
+          != NCoor))
       {
          RetVal = FALSE;
       }
       else
       {
-         /* Can't fit with fewer than 3 coordinates                     */
-         if(NCoor < 3)
+         /* Everything OK, go ahead with the fitting                    */
+         if(!blMatfit(ref_coor,fit_coor,RotMat,NCoor,NULL,FALSE))
          {
             RetVal = FALSE;
          }
          else
          {
-            /* Everything OK, go ahead with the fitting                 */
-            if(!blMatfit(ref_coor,fit_coor,RotMat,NCoor,NULL,FALSE))
-            {
-               RetVal = FALSE;
-            }
-            else
-            {
-               /* Apply the operations to the true coordinates          */
-               tvect.x = (-fit_bb_CofG.x);
-               tvect.y = (-fit_bb_CofG.y);
-               tvect.z = (-fit_bb_CofG.z);
-               blTranslatePDB(fit_pdb, tvect);
-               blApplyMatrixPDB(fit_pdb, RotMat);
-               blTranslatePDB(fit_pdb, ref_bb_CofG);
-            }
+            /* Apply the operations to the true coordinates             */
+            tvect.x = (-fit_bb_CofG.x);
+            tvect.y = (-fit_bb_CofG.y);
+            tvect.z = (-fit_bb_CofG.z);
+            blTranslatePDB(fit_pdb, tvect);
+            blApplyMatrixPDB(fit_pdb, RotMat);
+            blTranslatePDB(fit_pdb, ref_bb_CofG);
          }
       }
    }
    
-   /* Free the coordinate arrays and BB PDB linked lists                */
-   if(ref_coor)   free(ref_coor);
-   if(fit_coor)   free(fit_coor);
-   if(ref_bb_pdb) FREELIST(ref_bb_pdb, PDB);
-   if(fit_bb_pdb) FREELIST(fit_bb_pdb, PDB);
+   /* Free the coordinate arrays and BB selections                      */
+   if(ref_coor) free(ref_coor);
+   if(fit_coor) free(fit_coor);
+   blFreePDBSelection(ref_bb);
+   blFreePDBSelection(fit_bb);
          
    /* Fill in the rotation matrix for output, if required               */
    if(RetVal && (rm!=NULL))
@@ -205,4 +201,3 @@ BOOL blFitNCaCPDB(PDB *ref_pdb, PDB *fit_pdb, REAL rm[3][3])
 
    return(RetVal);
 }
-
@@ -3,11 +3,11 @@
 
    \file       FixCterPDB.c
    
-   \version    V1.10
-   \date       05.03.15
+   \version    V1.12
+   \date       18.10.26
    \brief      Routine to add C-terminal oxygens.
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1994-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1994-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -66,6 +66,8 @@
 -  V1.9  25.02.15 Ensures terminal oxygens are only added to amino acids 
                   not HETATM groups
 -  V1.10 05.03.15 Replaced blFindEndPDB() with blFindNextResidue()
+-  V1.11 18.10.26 Sets name codes on new and renamed atoms
+-  V1.12 18.10.26 Detaches any indexes of the list
 
 *************************************************************************/
 /* Doxygen
@@ -134,6 +136,8 @@ static BOOL SetCterStyle(PDB *start, PDB *end, int style);
 -  25.02.15 Ensures terminal oxygens are only added to amino acids not
             HETATM groups
 -  05.03.15 Replaced blFindEndPDB() with blFindNextResidue()
+-  18.10.26 Sets name codes of the new oxygen
+-  18.10.26 Detaches any indexes of the list
 */
 BOOL blFixCterPDB(PDB *pdb, int style)
 {
@@ -145,6 +149,9 @@ BOOL blFixCterPDB(PDB *pdb, int style)
          *O1   = NULL,
          *O2   = NULL;
       
+   /* Atoms are added and renamed, so indexes of the list are freed     */
+   blDetachPDBIndexes(pdb);
+
    /* Remove CTERs - we'll add them back later if required              */
    StandardiseCTers(pdb);   
    
@@ -201,6 +208,7 @@ BOOL blFixCterPDB(PDB *pdb, int style)
             strcpy(O2->atnam,"OXT ");
             strcpy(O2->atnam_raw," OXT");
             O2->altpos = ' ';         /* 03.06.05                       */
+            blSetPDBNameCodes(O2);    /* 18.10.26                       */
             
             if(CA==NULL || C==NULL || O1==NULL ||
                ((CA->x == (REAL)9999.0) && 
@@ -267,6 +275,7 @@ BOOL blFixCterPDB(PDB *pdb, int style)
 -  04.02.14 Use CHAINMATCH By: CTP
 -  07.07.14 Use bl prefix for functions By: CTP
 -  05.03.15 Replaced blFindEndPDB() with blFindNextResidue()
+-  18.10.26 Sets name codes of renamed atoms
 */
 static void StandardiseCTers(PDB *pdb)
 {
@@ -308,6 +317,7 @@ static void StandardiseCTers(PDB *pdb)
             strcpy(O1->atnam,"O   ");
             strcpy(O1->atnam_raw," O  ");
             O1->altpos = ' ';         /* 03.06.05                       */
+            blSetPDBNameCodes(O1);    /* 18.10.26                       */
          }
          
          if(O2 != NULL)
@@ -315,6 +325,7 @@ static void StandardiseCTers(PDB *pdb)
             strcpy(O2->atnam,"OXT ");
             strcpy(O2->atnam_raw," OXT");
             O2->altpos = ' ';         /* 03.06.05                       */
+            blSetPDBNameCodes(O2);    /* 18.10.26                       */
          }
          
       }
@@ -331,6 +342,7 @@ static void StandardiseCTers(PDB *pdb)
                strcpy(p->resnam, prev->resnam);
                strcpy(p->insert, prev->insert);
                p->resnum = prev->resnum;
+               blSetPDBNameCodes(p);  /* 18.10.26                       */
             }
          }
       }
@@ -358,6 +370,7 @@ static void StandardiseCTers(PDB *pdb)
 -  24.08.94 Original    By: ACRM
 -  06.02.03 Handles atnam_raw
 -  03.06.05 Handles altpos
+-  18.10.26 Sets name codes of renamed atoms
 */
 static BOOL SetCterStyle(PDB *start, PDB *end, int style)
 {
@@ -430,5 +443,9 @@ static BOOL SetCterStyle(PDB *start, PDB *end, int style)
       O2->resnum = start->resnum + 1;
    }
 
+   /* Update the name codes of the renamed atoms        18.10.26        */
+   for(p=start; p!=end; NEXT(p))
+      blSetPDBNameCodes(p);
+
    return(TRUE);
 }
@@ -3,11 +3,11 @@
 
    \file       GetCrystPDB.c
    
-   \version    V1.1
-   \date       07.07.14
+   \version    V1.2
+   \date       18.10.26
    \brief      
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2014
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -48,6 +48,7 @@
    =================
 -  V1.0R 12.10.05 Original
 -  V1.1  07.07.14 Use bl prefix for functions By: CTP
+-  V1.2  18.10.26 blGetCrystWholePDB() uses blGetHeaderSpanWholePDB()
 
 *************************************************************************/
 /* Doxygen
@@ -289,6 +290,7 @@ int blGetCrystPDB(FILE *fp, VEC3F *UnitCell, VEC3F *CellAngles,
    the current file pointer at the first ATOM or HETATM record).
 
 -  16.03.15 Original based on blGetCrystPDB()    By: ACRM
+-  18.10.26 Only visits the CRYST1, ORIGX and SCALE records
 */
 int blGetCrystWholePDB(WHOLEPDB *wpdb, VEC3F *UnitCell, VEC3F *CellAngles,
                        char *spacegroup,
@@ -297,7 +299,11 @@ int blGetCrystWholePDB(WHOLEPDB *wpdb, VEC3F *UnitCell, VEC3F *CellAngles,
    int        i, j,
               record,
               retval = 0x0000;
-   STRINGLIST *s        = NULL;
+   STRINGLIST *s        = NULL,
+              *first    = NULL,
+              *stop     = NULL;
+   static char *types[] = {"CRYST1", "ORIGX1", "ORIGX2", "ORIGX3",
+                           "SCALE1", "SCALE2", "SCALE3", NULL};
 
    /* Initialise matrices and cell dimensions                           */
    UnitCell->x   = UnitCell->y   = UnitCell->z   = (REAL)1.0;
@@ -313,8 +319,9 @@ int blGetCrystWholePDB(WHOLEPDB *wpdb, VEC3F *UnitCell, VEC3F *CellAngles,
    }
    strcpy(spacegroup,"P");
 
-   /* Run through the headers                                           */
-   for(s=wpdb->header; s!=NULL; NEXT(s))
+   /* Run through the crystal headers                                   */
+   first = blGetHeaderSpanWholePDB(wpdb, types, &stop);
+   for(s=first; s!=stop; NEXT(s))
    {
       char *buffer;
       
@@ -3,11 +3,11 @@
 
    \file       GetPDBByN.c
    
-   \version    V1.11
-   \date       07.07.14
+   \version    V1.13
+   \date       18.10.26
    \brief      
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-2014
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -58,6 +58,8 @@
 -  V1.9  14.03.96 Added FindAtomInRes()
 -  V1.10 08.10.99 Initialised some variables
 -  V1.11 07.07.14 Use bl prefix for functions By: CTP
+-  V1.12 18.10.26 blGetPDBByN() uses gPDBAtomIndex
+-  V1.13 18.10.26 Uses the atom index attached to the list instead
 
 *************************************************************************/
 /* Doxygen
@@ -98,17 +100,27 @@
    Gets a pointer to a pdb item by taking a PDB linked list and an 
    integer.
    The pointer returned is the n'th item in the list
+
+   If an atom index is attached to this list (see
+   blAttachPDBAtomIndex()), it is used rather than stepping along the
+   list.
    
 -  13.05.92 Original
 -  07.07.14 Use bl prefix for functions By: CTP
+-  18.10.26 Uses gPDBAtomIndex if set for this list
+-  18.10.26 Uses the atom index attached to the list instead
 
 */
 PDB *blGetPDBByN(PDB *pdb,
                int n)
 {
-   PDB *p;
-   int i;
+   PDB          *p;
+   PDBATOMINDEX *index;
+   int          i;
    
+   if((n > 0) && ((index = blGetPDBAtomIndex(pdb)) != NULL))
+      return(blGetPDBAtomByPosition(index, n));
+
    for(i=0, p=pdb; p && i<n ; NEXT(p), i++) ;
 
    return(p);
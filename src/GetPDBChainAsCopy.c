@@ -3,11 +3,11 @@
 
    \file       GetPDBChainAsCopy.c
    
-   \version    V1.1
-   \date       19.04.15
+   \version    V1.3
+   \date       18.10.26
    \brief      
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2015-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -48,6 +48,8 @@
    =================
 -  V1.0  26.03.16 Original By: ACRM
 -  V1.1  19.04.15 Added call to blCopyConect()
+-  V1.2  18.10.26 Added blGetPDBChainAsCopyArena()
+-  V1.3  18.10.26 Added blGetPDBChainAsView()
 
 *************************************************************************/
 /* Doxygen
@@ -57,6 +59,14 @@
    #FUNCTION  blGetPDBChainAsCopy()
    Extracts a specified chain from a PDB linked list allocating a new
    list containing only that chain. The original list is unchanged.
+
+   #FUNCTION  blGetPDBChainAsCopyArena()
+   Extracts a specified chain as blGetPDBChainAsCopy() but can allocate
+   the new list from an arena.
+
+   #FUNCTION  blGetPDBChainAsView()
+   Makes a selection of the atoms of a specified chain without copying
+   them.
 */
 /************************************************************************/
 /* Includes
@@ -91,8 +101,34 @@
 
 -  26.03.15 Original   By: ACRM
 -  19.04.15 Added call to blCopyConect()
+-  18.10.26 Now a wrapper to blGetPDBChainAsCopyArena()
 */
 PDB *blGetPDBChainAsCopy(PDB *pdbin, char *chain)
+{
+   return(blGetPDBChainAsCopyArena(pdbin, chain, NULL));
+}
+
+
+/************************************************************************/
+/*>PDB *blGetPDBChainAsCopyArena(PDB *pdbin, char *chain, ARENA *arena)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]    *pdbin     PDB linked list
+   \param[in]    *chain     Chain label
+   \param[in,out] *arena   Arena from which to allocate the new list.
+                            NULL to use malloc()
+   \return                  PDB linked list for requested chain
+
+   As blGetPDBChainAsCopy(), but if an arena is given the new list is
+   allocated from it, with the atoms contiguous in memory and in list
+   order. The list is then freed with the arena rather than with
+   FREELIST(). On failure, anything already allocated from the arena is
+   left there.
+
+-  18.10.26 Original
+*/
+PDB *blGetPDBChainAsCopyArena(PDB *pdbin, char *chain, ARENA *arena)
 {
    PDB *pdbout  = NULL,
        *p,
@@ -106,18 +142,18 @@ PDB *blGetPDBChainAsCopy(PDB *pdbin, char *chain)
          /* Allocate a new entry                                        */
          if(pdbout==NULL)
          {
-            INIT(pdbout, PDB);
+            INITARENA(pdbout, PDB, arena);
             q = pdbout;
          }
          else
          {
-            ALLOCNEXT(q, PDB);
+            ALLOCNEXTARENA(q, PDB, arena);
          }
          
          /* If failed, free anything allocated and return               */
          if(q==NULL)
          {
-            FREELIST(pdbout,PDB);
+            if(arena == NULL) FREELIST(pdbout, PDB);
             return(NULL);
          }
         
@@ -129,7 +165,7 @@ PDB *blGetPDBChainAsCopy(PDB *pdbin, char *chain)
    /* Copy CONECT data                                                  */
    if(!blCopyConects(pdbout, pdbin))
    {
-      FREELIST(pdbout, PDB);
+      if(arena == NULL) FREELIST(pdbout, PDB);
       return(NULL);
    }
 
@@ -138,3 +174,38 @@ PDB *blGetPDBChainAsCopy(PDB *pdbin, char *chain)
 }
 
 
+/************************************************************************/
+/*>PDBSELECTION *blGetPDBChainAsView(PDB *pdbin, char *chain)
+   -----------------------------------------------------------
+*//**
+
+   \param[in]     *pdbin      PDB linked list
+   \param[in]     *chain      Chain label
+   \return                    Selection of the atoms. NULL if no memory
+
+   As blGetPDBChainAsCopy(), but the atoms are not copied. Instead the
+   selection points to them in the input list. If no atoms are
+   selected, the selection is empty. Free with blFreePDBSelection().
+
+-  18.10.26 Original
+*/
+PDBSELECTION *blGetPDBChainAsView(PDB *pdbin, char *chain)
+{
+   PDBSELECTION *view;
+   PDB          *p;
+
+   if((view = blAllocPDBSelection(pdbin))==NULL)
+      return(NULL);
+
+   for(p=pdbin; p!=NULL; NEXT(p))
+   {
+      if(CHAINMATCH(p->chain, chain) &&
+         !blAddAtomToPDBSelection(view, p))
+      {
+         blFreePDBSelection(view);
+         return(NULL);
+      }
+   }
+
+   return(view);
+}
@@ -3,11 +3,11 @@
 
    \file       GlyCB.c
    
-   \version    V1.1
-   \date       07.07.14
+   \version    V1.3
+   \date       18.10.26
    \brief      Add C-beta atoms to glycines as pseudo-atoms for use
                in orientating residues
-   \copyright  (c) Dr. Andrew C. R. Martin, UCL, 2006-2014
+   \copyright  (c) Dr. Andrew C. R. Martin, UCL, 2006-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -50,6 +50,8 @@
    =================
 -  04.01.06 V1.0   Original  By: ACRM
 -  07.07.14 V1.1   Use bl prefix for functions By: CTP
+-  18.10.26 V1.2   Sets name codes of the CB
+-  18.10.26 V1.3   Detaches any indexes of the list
 
 *************************************************************************/
 /* Doxygen
@@ -108,6 +110,8 @@
 
 -  04.01.06 Original   By: ACRM
 -  07.07.14 Use bl prefix for functions By: CTP
+-  18.10.26 Sets name codes of the CB
+-  18.10.26 Detaches any indexes of the list
 */
 BOOL blAddCBtoGly(PDB *pdb)
 {
@@ -131,6 +135,8 @@ BOOL blAddCBtoGly(PDB *pdb)
    
    if(strncmp(pdb->resnam, "GLY", 3))
       return(FALSE);
+
+   blDetachPDBIndexes(pdb);
    
    if((n  = blFindAtomInRes(pdb, "N"))==NULL)
       return(FALSE);
@@ -206,6 +212,7 @@ BOOL blAddCBtoGly(PDB *pdb)
    /* Change it to a CB                                                 */
    strcpy(cb->atnam, "CB  ");
    strcpy(cb->atnam_raw, " CB ");
+   blSetPDBNameCodes(cb);
    /* And set the coordinates                                           */
    cb->x = xnew1;
    cb->y = ynew1;
@@ -267,11 +274,14 @@ BOOL blAddCBtoAllGly(PDB *pdb)
 
 -  04.01.06 Original   By: ACRM
 -  07.07.14 Use bl prefix for functions By: CTP
+-  18.10.26 Detaches any indexes of the list
 */
 PDB *blStripGlyCB(PDB *pdb)
 {
    PDB *p,
        *prev = NULL;
+
+   blDetachPDBIndexes(pdb);
    
    for(p=pdb; p!=NULL; )
    {
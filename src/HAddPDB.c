@@ -3,11 +3,11 @@
 
    \file       HAddPDB.c
    
-   \version    V2.22
-   \date       23.06.15
+   \version    V2.26
+   \date       18.10.26
    \brief      Add hydrogens to a PDB linked list
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1990-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1990-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -134,6 +134,12 @@
 -  V2.21 23.02.15 Uses new blRenumAtomsPDB()
 -  V2.22 23.06.15 Various calls to CLEAR_PDB() to fix problems with
                   uninitialized CONECT data
+-  V2.23 18.10.26 Sets name codes on the new hydrogens and uses them to
+                  skip HETATM and NTER records
+-  V2.24 18.10.26 NTER records are found from the residue name again
+                  since the name code may be out of date
+-  V2.25 18.10.26 blHAddPDB() detaches any indexes of the list
+-  V2.26 18.10.26 NTER records are found using the name code again
 
 *************************************************************************/
 /* Doxygen
@@ -246,6 +252,7 @@ static PDB  *StripDummyH(PDB *pdb, int *nhyd);
 -  07.07.14 Use bl prefix for functions By: CTP
 -  23.02.15 Uses blRenumAtomsPDB()  By: ACRM
 -  20.03.15 Returns -1 on error since zero hydrogens may be valid
+-  18.10.26 Detaches any indexes of the list
 */
 int blHAddPDB(FILE *fp, PDB  *pdb)
 {
@@ -261,6 +268,9 @@ int blHAddPDB(FILE *fp, PDB  *pdb)
          return(-1);
    }
 
+   /* Hydrogens are inserted, so indexes of the list are freed          */
+   blDetachPDBIndexes(pdb);
+
    /* Generate the hydrogens                                            */
    if((nhydrogens=GenH(pdb,&err_flag))<=0)
       return(nhydrogens);
@@ -367,6 +377,9 @@ int blReadPGP(FILE *fp)
 -  18.03.15 Changed to use MAXATINRES and MAXBUFF  By: ACRM
 -  20.03.15 Now returns -1 on error since zero added hydrogens might
             not be an error.
+-  18.10.26 Uses name codes to skip HETATM and NTER records
+-  18.10.26 Compares the residue name with NTER as a string
+-  18.10.26 Uses the name code to find NTER records again
 */
 static int GenH(PDB *pdb, BOOL *err_flag)
 {
@@ -400,7 +413,7 @@ static int GenH(PDB *pdb, BOOL *err_flag)
    /* For each atom in the PDB file                                     */
    for(p=pdb;p;)
    {
-      if(!strncmp(p->record_type,"HETATM",6))      /* 24.05.99          */
+      if(ISHETATM(p))                              /* 18.10.26          */
       {
          NEXT(p);
          continue;
@@ -408,7 +421,7 @@ static int GenH(PDB *pdb, BOOL *err_flag)
       
 
       /* Don't do anything with NTER residues except reset firstres     */
-      if(!strncmp(p->resnam,"NTER",4))
+      if(PDBNAMEMATCH(p->resnam_code, p->resnam, PDBNAME_NTER, "NTER", 4))
       {
          firstres = TRUE;
          NEXT(p);
@@ -1193,6 +1206,7 @@ required by PGP parameter for %3s %5d%c\n",sGRName,sNo,sIns);
 -  17.02.15 Added copying of segid and setting of formal_charge
 -  18.03.15 Changed to use MAXATINRES  By: ACRM
 -  23.06.15 Various calls to CLEAR_PDB()
+-  18.10.26 Sets name codes of the new atoms
 */
 static BOOL AddH(PDB *hlist, PDB **position, int HType)
 {
@@ -1248,6 +1262,7 @@ static BOOL AddH(PDB *hlist, PDB **position, int HType)
          strcpy(p->element,q->element);           /* 13.02.15           */
          strcpy(p->segid,  s->segid);             /* 17.02.15           */
          p->formal_charge=0;
+         blSetPDBNameCodes(p);                    /* 18.10.26           */
 
          if((HType==2)||(HType==3))
          {
@@ -1283,6 +1298,7 @@ static BOOL AddH(PDB *hlist, PDB **position, int HType)
             strcpy(p->element,q->element);         /* 13.02.15          */
             strcpy(p->segid,  s->segid);           /* 17.02.15          */
             p->formal_charge=0;
+            blSetPDBNameCodes(p);                  /* 18.10.26          */
          }
          if(HType==3)
          {
@@ -1318,6 +1334,7 @@ static BOOL AddH(PDB *hlist, PDB **position, int HType)
             strcpy(p->element,q->element);         /* 13.02.15          */
             strcpy(p->segid,  s->segid);           /* 17.02.15          */
             p->formal_charge=0;
+            blSetPDBNameCodes(p);                  /* 18.10.26          */
          }
       }   /* End of matches                                             */
    }  /* End of main list                                               */
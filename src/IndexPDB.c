@@ -3,11 +3,11 @@
 
    \file       IndexPDB.c
    
-   \version    V2.2
-   \date       19.04.15
+   \version    V2.4
+   \date       18.10.26
    \brief      Create an array of pointers into a PDB linked list
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -66,6 +66,9 @@
                   has changed!! NOT BACKWARDLY COMPATIBLE!
 -  V2.1  07.07.14 Use bl prefix for functions By: CTP
 -  V2.2  19.04.15 Added blIndexAtomNumbersPDB()  By: ACRM
+-  V2.3  18.10.26 Both routines use gPDBAtomIndex  By: ACRM
+-  V2.4  18.10.26 Both routines use the atom index attached to the list
+                  instead
 
 *************************************************************************/
 /* Doxygen
@@ -89,6 +92,7 @@
 */
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "MathType.h"
 #include "SysDefs.h"
@@ -109,16 +113,36 @@
    to allow array style access to items in the linked list:
    e.g. (indx[23])->x will give the x coordinate of the 23rd item
 
+   If an atom index is attached to this list (see
+   blAttachPDBAtomIndex()), the array is copied from it rather than
+   stepping through the list.
+
 -  19.07.90 Original
 -  01.06.92 ANSIed and documented.
 -  24.02.94 Re-written. Now allocates and returns the index.
 -  07.07.14 Use bl prefix for functions By: CTP
+-  18.10.26 Uses gPDBAtomIndex if set for this list
+-  18.10.26 Uses the atom index attached to the list instead
 */
 PDB **blIndexPDB(PDB *pdb, int *natom)
 {
-   PDB *p,
-       **indx;
-   int i=0;
+   PDB          *p,
+                **indx;
+   PDBATOMINDEX *atomIndex;
+   int          i=0;
+
+   if((atomIndex = blGetPDBAtomIndex(pdb)) != NULL)
+   {
+      *natom = atomIndex->natoms;
+      if((indx = (PDB **)malloc((*natom + 1) * sizeof(PDB *)))==NULL)
+         return(NULL);
+
+      for(i=0; i<*natom; i++)
+         indx[i] = blGetPDBAtomByPosition(atomIndex, i);
+      indx[i] = NULL;
+
+      return(indx);
+   }
 
    /* Count the number of entries                                       */
    for(p=pdb, i=0; p!=NULL; NEXT(p)) i++;
@@ -151,14 +175,42 @@ PDB **blIndexPDB(PDB *pdb, int *natom)
    number:
    e.g. (indx[23])->x will give the x coordinate of atom number 23
 
+   If an atom index is attached to this list (see
+   blAttachPDBAtomIndex()), the array is copied from it rather than
+   stepping through the list.
+
 -  19.04.15 Original   By: ACRM
+-  18.10.26 Uses gPDBAtomIndex if set for this list
+-  18.10.26 Uses the atom index attached to the list instead
 */
 PDB **blIndexAtomNumbersPDB(PDB *pdb, int *indexSize)
 {
-   PDB *p,
-       **index = NULL;
-   int maxAtnum = 0;
+   PDB          *p,
+                **index = NULL;
+   PDBATOMINDEX *atomIndex;
+   int          maxAtnum = 0;
    
+   if((atomIndex = blGetPDBAtomIndex(pdb)) != NULL)
+   {
+      for(maxAtnum = atomIndex->atnumSize - 1; maxAtnum > 0;
+          maxAtnum--)
+      {
+         if(atomIndex->byAtnum[maxAtnum] != NULL)
+            break;
+      }
+      if(maxAtnum < 0)
+         maxAtnum = 0;
+
+      *indexSize = maxAtnum + 1;
+      if((index=(PDB **)calloc((*indexSize), sizeof(PDB *)))!=NULL)
+      {
+         if(atomIndex->atnumSize > 0)
+            memcpy(index, atomIndex->byAtnum,
+                   (*indexSize) * sizeof(PDB *));
+      }
+      return(index);
+   }
+
    for(p=pdb; p!=NULL; NEXT(p))
    {
       if(p->atnum > maxAtnum)
@@ -3,11 +3,11 @@
 
    \file       KillPDB.c
    
-   \version    V1.12
-   \date       30.09.17
+   \version    V1.15
+   \date       18.10.26
    \brief      
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-2017
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -59,6 +59,11 @@
 -  V1.10 08.10.99 Initialised some variables
 -  V1.11 07.07.14 Use bl prefix for functions By: CTP
 -  V1.12 30.09.17 Added vlDeleteResiduePDB() By: ACRM
+-  V1.13 18.10.26 Uses and updates gPDBAtomIndex
+-  V1.14 18.10.26 Updates the indexes attached to the list
+-  V1.15 18.10.26 Uses the atom index attached to the list rather than
+                  gPDBAtomIndex. blDeleteAtomRangePDB() deletes nothing
+                  if start and stop are the same
 
 *************************************************************************/
 /* Doxygen
@@ -117,24 +122,43 @@
    returning the new start of the list (in case the first atom has been 
    deleted)
 
+   If an atom index is attached to this list, it is used to find the
+   atom before start.
+
 -  17.03.15  Original  By: ACRM
+-  18.10.26  Uses and updates gPDBAtomIndex
+-  18.10.26  Uses the atom index attached to the list. Deletes nothing
+             if start and stop are the same
 */
 PDB *blDeleteAtomRangePDB(PDB *pdb, PDB *start, PDB *stop)
 {
-   PDB  *p,
-        *prev = NULL;
-   BOOL found = FALSE;
+   PDB          *p,
+                *prev = NULL;
+   PDBATOMINDEX *index;
+   BOOL         found = FALSE;
+
+   if(start == stop)
+      return(pdb);
  
-   /* Find the atom previous to start                                   */
-   for(p=pdb; p!=NULL; NEXT(p))
+   if(((index = blGetPDBAtomIndex(pdb)) != NULL) && (start != NULL) &&
+      (start->indexes == pdb->indexes))
    {
-      if(p==start)
+      found = blGetPDBAtomBefore(index, start, &prev);
+   }
+
+   if(!found)
+   {
+      /* Find the atom previous to start                                */
+      for(p=pdb; p!=NULL; NEXT(p))
       {
-         found = TRUE;
-         break;
+         if(p==start)
+         {
+            found = TRUE;
+            break;
+         }
+         
+         prev = p;
       }
-      
-      prev = p;
    }
    if(!found)
       return(pdb);
@@ -168,13 +192,27 @@ PDB *blDeleteAtomRangePDB(PDB *pdb, PDB *start, PDB *stop)
    Returns NULL of all atoms have been deleted. Returns the input
    pdb linked list unmodified if the atom isn't found.
 
+   If an atom index is attached to this list, it is used to find the
+   atom before the one being deleted.
+
 -  17.03.15  Original   By: ACRM
+-  18.10.26  Uses and updates gPDBAtomIndex
+-  18.10.26  Uses the atom index attached to the list
 */
 PDB *blDeleteAtomPDB(PDB *pdb, PDB *atom)
 {
-   PDB *p, 
-       *next,
-       *prev=NULL;
+   PDB          *p,
+                *next,
+                *prev=NULL;
+   PDBATOMINDEX *index;
+
+   if(((index = blGetPDBAtomIndex(pdb)) != NULL) && (atom != NULL) &&
+      (atom->indexes == pdb->indexes) &&
+      blGetPDBAtomBefore(index, atom, &prev))
+   {
+      next = blKillPDB(atom, prev);
+      return((prev==NULL) ? next : pdb);
+   }
 
    for(p=pdb; p!=NULL; NEXT(p))
    {
@@ -206,16 +244,25 @@ PDB *blDeleteAtomPDB(PDB *pdb, PDB *atom)
    next item in the list, so will be NULL when the last item in the list
    is killed.
 
+   The indexes attached to the list are updated (see
+   blRemoveFromPDBIndexes()). Nothing is done for an item which has
+   none.
+
 -  12.05.92 Original
 -  11.03.94 Now handles prev==NULL to delete first item in a list
 -  07.07.14 Use bl prefix for functions By: CTP
 -  16.03.15 Checks and removes any CONECT data  By: ACRM
+-  18.10.26 Updates gPDBAtomIndex. Work moved to KillAtom()
+-  18.10.26 Updates the indexes attached to the list
+-  18.10.26 Work moved back from KillAtom(). No longer uses
+            gPDBAtomIndex
 */
 PDB *blKillPDB(PDB *pdb,              /* Pointer to record to kill      */
                PDB *prev)             /* Pointer to previous record     */
 {
    PDB *next;
 
+   blRemoveFromPDBIndexes(pdb, prev);
    next = pdb->next;
 
    blDeleteAtomConects(pdb);
@@ -240,18 +287,33 @@ PDB *blKillPDB(PDB *pdb,              /* Pointer to record to kill      */
    Returns the next item in the list, so will be NULL when the last 
    residue has been deleted.
 
+   If an atom index is attached to this list, it is used to find the
+   atom before the residue. The indexes attached to the list are
+   updated.
+
 -  30.09.17 Original
+-  18.10.26 Uses and updates gPDBAtomIndex
+-  18.10.26 Updates the indexes attached to the list
+-  18.10.26 Uses the atom index attached to the list
 */
 PDB *blDeleteResiduePDB(PDB **pPDB, PDB *res)
 {
-   PDB *prevAtom,
-       *nextRes, 
-       *p;
+   PDB          *prevAtom,
+                *nextRes,
+                *p,
+                *next;
+   PDBATOMINDEX *index;
    
    if(*pPDB == NULL)  return(NULL);
 
    /* Find the previous atom                                            */
-   if(res == *pPDB)
+   if(((index = blGetPDBAtomIndex(*pPDB)) != NULL) &&
+      (res->indexes == (*pPDB)->indexes) &&
+      blGetPDBAtomBefore(index, res, &prevAtom))
+   {
+      ;                    /* Found using the index                     */
+   }
+   else if(res == *pPDB)
    {
       prevAtom = NULL;
    }
@@ -275,12 +337,14 @@ PDB *blDeleteResiduePDB(PDB **pPDB, PDB *res)
       prevAtom->next = nextRes;
    }
    
-   for(p=res; p!=nextRes; NEXT(p))
+   /* 18.10.26 No longer uses p after it has been freed                */
+   for(p=res; p!=nextRes; p=next)
    {
+      next = p->next;
+      blRemoveFromPDBIndexes(p, prevAtom);
       blDeleteAtomConects(p);
       free(p);
    }
    
    return(nextRes);
 }
-
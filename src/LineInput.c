@@ -0,0 +1,1100 @@
+/************************************************************************/
+/**
+
+   \file       LineInput.c
+
+   \version    V1.3
+   \date       18.10.26
+   \brief      Read an open file a line at a time, memory mapping it
+               where possible to avoid copying the data and
+               decompressing gzip or compress data in process
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Provides line-at-a-time reading from an open FILE pointer with the
+   same chunking behaviour as fgets(). If the stream is a regular file,
+   the remainder of the file is memory mapped and the lines returned
+   point directly into the mapping so no data are copied. Otherwise
+   (pipes, terminals, or if NOMMAP is defined) the data are read in
+   large blocks into an internal buffer.
+
+   If the data start with a gzip signature (and ZLIB_SUPPORT is
+   defined) or a Unix compress signature, they are decompressed in
+   process as they are read, so no external gunzip process or
+   temporary file is needed. Concatenated gzip members are handled as
+   gunzip does.
+
+   Lines returned are NOT terminated, so the length returned by 
+   blGetLineInput() must always be used. They remain valid only until
+   the next call.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+\code
+   LINEINPUT *li;
+   char      *line;
+   int       len;
+
+   if((li = blOpenLineInput(fp, 160))!=NULL)
+   {
+      while((line = blGetLineInput(li, &len))!=NULL)
+      {
+         if(LINEINPUTMATCH(line, len, "ATOM  ", 6))
+            ...
+      }
+      blCloseLineInput(li);
+   }
+\endcode
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  18.10.26 Original
+-  V1.1  18.10.26 Added in-process decompression of gzip (zlib) and
+                  compress (LZW) data. Non-mapped input is read in
+                  blocks. Added blPeekLineInput() and
+                  blGetBlockLineInput()
+-  V1.2  18.10.26 Added blTellLineInput()
+-  V1.3  18.10.26 Added blResizeLineInput()
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    General Programming
+   #SUBGROUP File IO
+   #FUNCTION  blOpenLineInput()
+   Prepares an open file for line-at-a-time reading, memory mapping it
+   if possible.
+
+   #FUNCTION  blGetLineInput()
+   Gets the next line (like fgets()) returning a pointer to it and its
+   length rather than copying it.
+
+   #FUNCTION  blPeekLineInput()
+   Looks at the data coming up without consuming them.
+
+   #FUNCTION  blGetBlockLineInput()
+   Gets the next block of data ignoring line breaks.
+
+   #FUNCTION  blTellLineInput()
+   Gives the file offset of the next line, like ftell().
+
+   #FUNCTION  blResizeLineInput()
+   Changes the line chunk size after the input has been opened.
+
+   #FUNCTION  blCloseLineInput()
+   Finishes reading, leaving the file positioned after the last line
+   read.
+*/
+/************************************************************************/
+/* Includes
+*/
+#if !defined(_POSIX_C_SOURCE) || (_POSIX_C_SOURCE < 200112L)
+#  undef  _POSIX_C_SOURCE
+#  define _POSIX_C_SOURCE 200112L  /* For fileno() and mmap()          */
+#endif
+#include "port.h"    /* Required before stdio.h                         */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(MS_WINDOWS) && !defined(NOMMAP)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+#ifdef ZLIB_SUPPORT
+#include <zlib.h>
+#endif
+
+#include "macros.h"
+#include "LineInput.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define BLOCKSIZE   65536   /* Size of blocks read with fread()         */
+#define DECODESIZE  262144  /* Size of the decompressed data buffer     */
+#define LZW_MAXBITS 16      /* Largest code size for compress           */
+#define LZW_INITBITS 9      /* Initial code size for compress           */
+#define LZW_CLEAR   256     /* Clear code in block mode                 */
+#define LZW_TABSIZE (1L<<LZW_MAXBITS)
+
+typedef struct
+{
+   unsigned char  *in,       /* Compressed data: mapping or inBuff      */
+                  *inBuff,   /* Buffer for compressed data (not mapped) */
+                  *lzwSuffix,
+                  *lzwStack;
+   unsigned short *lzwPrefix;
+   size_t         inPos,     /* Read position in compressed data        */
+                  inEnd,     /* End of compressed data                  */
+                  inSize;    /* Size of inBuff                          */
+   unsigned long  bitBuff;   /* Bits read but not yet used (LZW)        */
+   long           maxCode,
+                  maxMaxCode,
+                  freeEnt,
+                  oldCode;
+   int            bitCount,
+                  nBits,
+                  maxBits,
+                  nCodes,    /* Codes read at the current code size     */
+                  finChar;
+   BOOL           inEOF,
+                  blockMode;
+#ifdef ZLIB_SUPPORT
+   z_stream       zs;
+   BOOL           zsInit;
+#endif
+}  DECODER;
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL MapLineInput(LINEINPUT *li);
+static int  DataFormat(unsigned char *sig, size_t nsig);
+static BOOL StartDecoder(LINEINPUT *li);
+static void FreeDecoder(DECODER *dec);
+static void FillLineInput(LINEINPUT *li);
+static BOOL FillCompressed(LINEINPUT *li, DECODER *dec, size_t want);
+static BOOL StartUncompress(LINEINPUT *li, DECODER *dec);
+static void Uncompress(LINEINPUT *li, DECODER *dec);
+static BOOL GetLZWCode(LINEINPUT *li, DECODER *dec, long *code);
+static BOOL SkipLZWPadding(LINEINPUT *li, DECODER *dec);
+#ifdef ZLIB_SUPPORT
+static void Inflate(LINEINPUT *li, DECODER *dec);
+#endif
+
+/************************************************************************/
+/*>LINEINPUT *blOpenLineInput(FILE *fp, int maxlen)
+   ------------------------------------------------
+*//**
+
+   \param[in]     *fp       Open file pointer
+   \param[in]     maxlen    Maximum chunk size as used for fgets().
+                            Lines longer than maxlen-1 characters are
+                            returned in pieces exactly as fgets() would.
+   \return                  Line input structure (NULL if no memory)
+
+   Prepares an open file for reading with blGetLineInput(). Reading
+   starts from the current position in the file. If the file is a
+   regular file it is memory mapped; otherwise it is read in blocks.
+   gzip or compress data are recognized from their signatures and
+   decompressed as they are read.
+
+-  18.10.26 Original
+-  18.10.26 Reads blocks rather than using fgets(). Recognizes
+            compressed data
+*/
+LINEINPUT *blOpenLineInput(FILE *fp, int maxlen)
+{
+   LINEINPUT     *li;
+   unsigned char *sig;
+   size_t        nsig;
+
+   if((fp == NULL) || (maxlen < 2))
+      return(NULL);
+
+   if((li = (LINEINPUT *)malloc(sizeof(LINEINPUT)))==NULL)
+      return(NULL);
+
+   li->fp       = fp;
+   li->map      = NULL;
+   li->data     = NULL;
+   li->decoder  = NULL;
+   li->mapSize  = 0;
+   li->dataSize = 0;
+   li->dataEnd  = 0;
+   li->pos      = 0;
+   li->offset   = 0;
+   li->maxlen   = maxlen;
+   li->format   = LINEINPUT_PLAIN;
+   li->eof      = FALSE;
+
+   if(MapLineInput(li))
+   {
+      li->data     = li->map;
+      li->dataSize = li->dataEnd = li->mapSize;
+      li->eof      = TRUE;
+   }
+   else
+   {
+      li->offset   = ftell(fp);
+      li->dataSize = BLOCKSIZE + maxlen;
+      if((li->data = (char *)malloc(li->dataSize * sizeof(char)))==NULL)
+      {
+         free(li);
+         return(NULL);
+      }
+      FillLineInput(li);
+   }
+
+   /* See whether the data are compressed                               */
+   sig  = (unsigned char *)(li->data + li->pos);
+   nsig = li->dataEnd - li->pos;
+   if((li->format = DataFormat(sig, nsig)) != LINEINPUT_PLAIN)
+   {
+      if(!StartDecoder(li))
+      {
+         blCloseLineInput(li);
+         return(NULL);
+      }
+   }
+
+   return(li);
+}
+
+
+/************************************************************************/
+/*>char *blGetLineInput(LINEINPUT *li, int *length)
+   ------------------------------------------------
+*//**
+
+   \param[in]     *li       Line input structure
+   \param[out]    *length   Number of characters in the line (including
+                            the \\n if present)
+   \return                  Pointer to the start of the line. NULL at
+                            end of file
+
+   Gets the next line from the file. The line is broken at exactly the
+   points that fgets() would break it given a buffer of li->maxlen
+   characters. The line is NOT terminated and the pointer is valid only
+   until the next call.
+
+-  18.10.26 Original
+-  18.10.26 Same code for mapped and buffered data
+*/
+char *blGetLineInput(LINEINPUT *li, int *length)
+{
+   char   *line,
+          *eol = NULL;
+   size_t avail,
+          limit = (size_t)(li->maxlen - 1);
+
+   avail = li->dataEnd - li->pos;
+   for(;;)
+   {
+      if(avail > limit)
+         avail = limit;
+      if(((eol = (char *)memchr(li->data + li->pos, '\n', avail))!=NULL) ||
+         (avail == limit) || li->eof)
+         break;
+      FillLineInput(li);
+      avail = li->dataEnd - li->pos;
+   }
+
+   if(avail == 0)
+      return(NULL);
+
+   line = li->data + li->pos;
+   if(eol != NULL)
+      avail = (size_t)(eol - line) + 1;
+
+   li->pos += avail;
+   *length  = (int)avail;
+   return(line);
+}
+
+
+/************************************************************************/
+/*>char *blPeekLineInput(LINEINPUT *li, int nchar, int *length)
+   ------------------------------------------------------------
+*//**
+
+   \param[in]     *li       Line input structure
+   \param[in]     nchar     Number of characters wanted
+   \param[out]    *length   Number of characters available (less than
+                            nchar only at end of file)
+   \return                  Pointer to the upcoming data
+
+   Looks ahead at the data without consuming them; used to check the
+   file format. The data are not terminated. nchar may not be more than
+   half the size of the internal buffer (32K characters).
+
+-  18.10.26 Original
+*/
+char *blPeekLineInput(LINEINPUT *li, int nchar, int *length)
+{
+   size_t want = (size_t)nchar;
+
+   if(want > li->dataSize / 2)
+      want = li->dataSize / 2;
+
+   while(((li->dataEnd - li->pos) < want) && !li->eof)
+      FillLineInput(li);
+
+   *length = (int)MIN(want, li->dataEnd - li->pos);
+   return(li->data + li->pos);
+}
+
+
+/************************************************************************/
+/*>char *blGetBlockLineInput(LINEINPUT *li, int maxlen, int *length)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]     *li       Line input structure
+   \param[in]     maxlen    Maximum number of characters wanted
+   \param[out]    *length   Number of characters returned
+   \return                  Pointer to the data. NULL at end of file
+
+   Gets the next block of up to maxlen characters without regard to 
+   line breaks; the equivalent of fread(). The data are not terminated
+   and the pointer is valid only until the next call.
+
+-  18.10.26 Original
+*/
+char *blGetBlockLineInput(LINEINPUT *li, int maxlen, int *length)
+{
+   char   *block;
+   size_t avail;
+
+   while((li->pos == li->dataEnd) && !li->eof)
+      FillLineInput(li);
+
+   if((avail = li->dataEnd - li->pos) == 0)
+      return(NULL);
+   if(avail > (size_t)maxlen)
+      avail = (size_t)maxlen;
+
+   block    = li->data + li->pos;
+   li->pos += avail;
+   *length  = (int)avail;
+   return(block);
+}
+
+
+/************************************************************************/
+/*>long blTellLineInput(LINEINPUT *li)
+   -----------------------------------
+*//**
+
+   \param[in]     *li       Line input structure
+   \return                  File offset of the next line to be read.
+                            -1 if not known
+
+   The equivalent of ftell(). The offset can be given to fseek() before 
+   opening a new line input to restart reading from the same line. It
+   is not known for compressed data or for streams where ftell() fails
+   (such as pipes).
+
+-  18.10.26 Original
+*/
+long blTellLineInput(LINEINPUT *li)
+{
+   if(li->offset < 0)
+      return(-1L);
+   return(li->offset + (long)li->pos);
+}
+
+
+/************************************************************************/
+/*>BOOL blResizeLineInput(LINEINPUT *li, int maxlen)
+   -------------------------------------------------
+*//**
+
+   \param[in,out] *li       Line input structure
+   \param[in]     maxlen    New maximum chunk size as used for fgets()
+   \return                  Success? The input is unchanged on failure
+
+   Changes the size at which lines are broken by blGetLineInput(). This
+   allows a reader which has looked at the data to find out the file
+   format to switch to the longer lines that format allows without
+   losing the data already read. The buffer is enlarged if needed.
+
+-  18.10.26 Original
+*/
+BOOL blResizeLineInput(LINEINPUT *li, int maxlen)
+{
+   char   *data;
+   size_t size;
+
+   if(maxlen < 2)
+      return(FALSE);
+
+   /* A mapping holds the whole file so only a buffer needs to grow     */
+   if((maxlen > li->maxlen) && (li->data != li->map))
+   {
+      size = li->dataSize + (size_t)(maxlen - li->maxlen);
+      if((data = (char *)realloc(li->data, size * sizeof(char)))==NULL)
+         return(FALSE);
+      li->data     = data;
+      li->dataSize = size;
+   }
+
+   li->maxlen = maxlen;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void blCloseLineInput(LINEINPUT *li)
+   ------------------------------------
+*//**
+
+   \param[in]     *li       Line input structure
+
+   Frees the line input structure, removing any memory mapping. A mapped
+   file is left positioned after the last data returned (with the end of
+   file flag set if everything was read) so the caller sees the same
+   state as if fgets() had been used. For other streams, data read
+   ahead are returned to the stream if it is seekable; otherwise they
+   are lost. For compressed data the file is left after the compressed
+   data consumed.
+
+-  18.10.26 Original
+-  18.10.26 Handles decompression and buffered reading
+*/
+void blCloseLineInput(LINEINPUT *li)
+{
+   DECODER *dec;
+
+   if(li == NULL)
+      return;
+
+   dec = (DECODER *)li->decoder;
+
+#if !defined(MS_WINDOWS) && !defined(NOMMAP)
+   if(li->map != NULL)
+   {
+      size_t pos;
+      int    ch;
+
+      pos = (dec == NULL) ? li->pos : dec->inPos;
+      munmap(li->map, li->mapSize);
+      fseek(li->fp, (long)pos, SEEK_SET);
+
+      /* Set the EOF flag if we have consumed everything                */
+      if(pos >= li->mapSize)
+      {
+         if((ch = getc(li->fp)) != EOF)
+            ungetc(ch, li->fp);
+      }
+      if(li->data == li->map)
+         li->data = NULL;
+   }
+#endif
+
+   /* Give back any data we read ahead                                  */
+   if((li->map == NULL) && (dec == NULL) && (li->dataEnd > li->pos))
+      fseek(li->fp, -(long)(li->dataEnd - li->pos), SEEK_CUR);
+
+   FreeDecoder(dec);
+   FREE(li->data);
+   free(li);
+}
+
+
+/************************************************************************/
+/*>static BOOL MapLineInput(LINEINPUT *li)
+   ---------------------------------------
+*//**
+
+   \param[in,out] *li       Line input structure
+   \return                  Was the file mapped?
+
+   Attempts to memory map the file. Only regular files with data left to
+   read are mapped. The whole file is mapped (offsets must be page
+   aligned) and reading starts from the current stream position which
+   allows for any characters pushed back with ungetc().
+
+-  18.10.26 Original
+*/
+static BOOL MapLineInput(LINEINPUT *li)
+{
+#if !defined(MS_WINDOWS) && !defined(NOMMAP)
+   struct stat statBuff;
+   long        offset;
+   void        *map;
+   int         fd;
+
+   fd = fileno(li->fp);
+   if((fd < 0) || (fstat(fd, &statBuff) != 0) ||
+      !S_ISREG(statBuff.st_mode) || (statBuff.st_size <= 0))
+      return(FALSE);
+
+   /* Check the size fits in memory addressing                          */
+   if((off_t)((size_t)statBuff.st_size) != statBuff.st_size)
+      return(FALSE);
+
+   if(((offset = ftell(li->fp)) < 0) ||
+      ((off_t)offset >= statBuff.st_size))
+      return(FALSE);
+
+   map = mmap(NULL, (size_t)statBuff.st_size, PROT_READ, MAP_PRIVATE,
+              fd, 0);
+   if(map == MAP_FAILED)
+      return(FALSE);
+
+   posix_madvise(map, (size_t)statBuff.st_size, POSIX_MADV_SEQUENTIAL);
+
+   li->map     = (char *)map;
+   li->mapSize = (size_t)statBuff.st_size;
+   li->pos     = (size_t)offset;
+   return(TRUE);
+#else
+   return(FALSE);
+#endif
+}
+
+
+/************************************************************************/
+/*>static int DataFormat(unsigned char *sig, size_t nsig)
+   ------------------------------------------------------
+*//**
+
+   \param[in]     *sig      Start of the data
+   \param[in]     nsig      Number of bytes available
+   \return                  LINEINPUT_PLAIN, LINEINPUT_GZIP or
+                            LINEINPUT_COMPRESS
+
+   Identifies compressed data from the signature. gzip data are only 
+   recognized if we have zlib.
+
+-  18.10.26 Original
+*/
+static int DataFormat(unsigned char *sig, size_t nsig)
+{
+   if((nsig >= 3) && (sig[0] == 0x1F))
+   {
+#ifdef ZLIB_SUPPORT
+      if((sig[1] == 0x8B) && (sig[2] == 0x08))
+         return(LINEINPUT_GZIP);
+#endif
+      if(sig[1] == 0x9D)
+         return(LINEINPUT_COMPRESS);
+   }
+   return(LINEINPUT_PLAIN);
+}
+
+
+/************************************************************************/
+/*>static BOOL StartDecoder(LINEINPUT *li)
+   ---------------------------------------
+*//**
+
+   \param[in,out] *li       Line input structure
+   \return                  Success (FALSE if no memory)
+
+   Sets up decompression. The data seen so far (the mapping or the first
+   block read) become the compressed input and a new buffer is
+   allocated for the decompressed data.
+
+-  18.10.26 Original
+*/
+static BOOL StartDecoder(LINEINPUT *li)
+{
+   DECODER *dec;
+
+   if((dec = (DECODER *)malloc(sizeof(DECODER)))==NULL)
+      return(FALSE);
+   
+   dec->inBuff    = NULL;
+   dec->lzwPrefix = NULL;
+   dec->lzwSuffix = NULL;
+   dec->lzwStack  = NULL;
+   dec->inEOF     = FALSE;
+#ifdef ZLIB_SUPPORT
+   dec->zsInit    = FALSE;
+#endif
+
+   if(li->map != NULL)
+   {
+      dec->in     = (unsigned char *)li->map;
+      dec->inSize = li->mapSize;
+      dec->inEOF  = TRUE;
+   }
+   else
+   {
+      dec->in     = dec->inBuff = (unsigned char *)li->data;
+      dec->inSize = li->dataSize;
+   }
+   dec->inPos     = li->pos;
+   dec->inEnd     = li->dataEnd;
+   li->decoder    = (APTR)dec;
+
+   /* New buffer for the decompressed data                              */
+   li->dataSize   = DECODESIZE + li->maxlen;
+   li->dataEnd    = 0;
+   li->pos        = 0;
+   li->offset     = -1;    /* Decompressed data have no file offset     */
+   li->eof        = FALSE;
+   if((li->data = (char *)malloc(li->dataSize * sizeof(char)))==NULL)
+      return(FALSE);
+
+#ifdef ZLIB_SUPPORT
+   if(li->format == LINEINPUT_GZIP)
+   {
+      dec->zs.zalloc   = Z_NULL;
+      dec->zs.zfree    = Z_NULL;
+      dec->zs.opaque   = Z_NULL;
+      dec->zs.next_in  = Z_NULL;
+      dec->zs.avail_in = 0;
+      if(inflateInit2(&(dec->zs), 16 + MAX_WBITS) != Z_OK)
+         return(FALSE);
+      dec->zsInit = TRUE;
+      return(TRUE);
+   }
+#endif
+
+   return(StartUncompress(li, dec));
+}
+
+
+/************************************************************************/
+/*>static void FreeDecoder(DECODER *dec)
+   -------------------------------------
+*//**
+
+   \param[in]     *dec      Decompression state
+
+   Frees the decompression state.
+
+-  18.10.26 Original
+*/
+static void FreeDecoder(DECODER *dec)
+{
+   if(dec == NULL)
+      return;
+
+#ifdef ZLIB_SUPPORT
+   if(dec->zsInit)
+      inflateEnd(&(dec->zs));
+#endif
+   FREE(dec->inBuff);
+   FREE(dec->lzwPrefix);
+   FREE(dec->lzwSuffix);
+   FREE(dec->lzwStack);
+   free(dec);
+}
+
+
+/************************************************************************/
+/*>static void FillLineInput(LINEINPUT *li)
+   ----------------------------------------
+*//**
+
+   \param[in,out] *li       Line input structure
+
+   Adds more data to the buffer, first moving any unread data to the
+   start. Either some data are added or the eof flag is set.
+
+-  18.10.26 Original
+*/
+static void FillLineInput(LINEINPUT *li)
+{
+   size_t nread;
+
+   if(li->eof)
+      return;
+
+   if(li->pos)
+   {
+      memmove(li->data, li->data + li->pos, li->dataEnd - li->pos);
+      if(li->offset >= 0)
+         li->offset += (long)li->pos;
+      li->dataEnd -= li->pos;
+      li->pos      = 0;
+   }
+
+   switch(li->format)
+   {
+   case LINEINPUT_PLAIN:
+      nread = fread(li->data + li->dataEnd, 1, li->dataSize - li->dataEnd,
+                    li->fp);
+      li->dataEnd += nread;
+      if(nread == 0)
+         li->eof = TRUE;
+      break;
+#ifdef ZLIB_SUPPORT
+   case LINEINPUT_GZIP:
+      Inflate(li, (DECODER *)li->decoder);
+      break;
+#endif
+   case LINEINPUT_COMPRESS:
+      Uncompress(li, (DECODER *)li->decoder);
+      break;
+   default:
+      li->eof = TRUE;
+      break;
+   }
+}
+
+
+/************************************************************************/
+/*>static BOOL FillCompressed(LINEINPUT *li, DECODER *dec, size_t want)
+   --------------------------------------------------------------------
+*//**
+
+   \param[in]     *li       Line input structure
+   \param[in,out] *dec      Decompression state
+   \param[in]     want      Number of compressed bytes wanted
+   \return                  Are at least want bytes now available?
+
+   Reads more compressed data if fewer than want bytes are waiting.
+   Nothing is read when the file is mapped since all the data are 
+   already there.
+
+-  18.10.26 Original
+*/
+static BOOL FillCompressed(LINEINPUT *li, DECODER *dec, size_t want)
+{
+   size_t nread;
+
+   while(((dec->inEnd - dec->inPos) < want) && !dec->inEOF)
+   {
+      if(dec->inPos)
+      {
+         memmove(dec->inBuff, dec->inBuff + dec->inPos, 
+                 dec->inEnd - dec->inPos);
+         dec->inEnd -= dec->inPos;
+         dec->inPos  = 0;
+      }
+      nread = fread(dec->inBuff + dec->inEnd, 1, 
+                    dec->inSize - dec->inEnd, li->fp);
+      dec->inEnd += nread;
+      if(nread == 0)
+         dec->inEOF = TRUE;
+   }
+   return((dec->inEnd - dec->inPos) >= want);
+}
+
+
+#ifdef ZLIB_SUPPORT
+/************************************************************************/
+/*>static void Inflate(LINEINPUT *li, DECODER *dec)
+   ------------------------------------------------
+*//**
+
+   \param[in,out] *li       Line input structure
+   \param[in,out] *dec      Decompression state
+
+   Decompresses gzip data into the free space at the end of the data
+   buffer. A further gzip member following the end of one is also 
+   decompressed; anything else after the end is ignored as gunzip does.
+   Corrupt or truncated data simply end the input.
+
+-  18.10.26 Original
+*/
+static void Inflate(LINEINPUT *li, DECODER *dec)
+{
+   size_t start = li->dataEnd,
+          nin;
+   int    ret;
+
+   while((li->dataEnd == start) && !li->eof)
+   {
+      if(!FillCompressed(li, dec, 1))
+      {
+         li->eof = TRUE;
+         break;
+      }
+
+      /* avail_in is only an unsigned int                               */
+      nin = MIN(dec->inEnd - dec->inPos, (size_t)1073741824L);
+      dec->zs.next_in   = (Bytef *)(dec->in + dec->inPos);
+      dec->zs.avail_in  = (uInt)nin;
+      dec->zs.next_out  = (Bytef *)(li->data + li->dataEnd);
+      dec->zs.avail_out = (uInt)(li->dataSize - li->dataEnd);
+
+      ret = inflate(&(dec->zs), Z_NO_FLUSH);
+
+      dec->inPos  += nin - dec->zs.avail_in;
+      li->dataEnd  = li->dataSize - dec->zs.avail_out;
+
+      if(ret == Z_STREAM_END)
+      {
+         /* Carry on if another gzip member follows                     */
+         if(FillCompressed(li, dec, 2) &&
+            (dec->in[dec->inPos]   == 0x1F) &&
+            (dec->in[dec->inPos+1] == 0x8B))
+         {
+            inflateReset(&(dec->zs));
+         }
+         else
+         {
+            li->eof = TRUE;
+         }
+      }
+      else if(ret != Z_OK)
+      {
+         li->eof = TRUE;
+      }
+   }
+}
+#endif
+
+
+/************************************************************************/
+/*>static BOOL StartUncompress(LINEINPUT *li, DECODER *dec)
+   --------------------------------------------------------
+*//**
+
+   \param[in]     *li       Line input structure
+   \param[in,out] *dec      Decompression state
+   \return                  Success (FALSE if no memory)
+
+   Reads the 3-byte compress header and allocates the LZW tables. An
+   invalid header gives no data rather than an error.
+
+-  18.10.26 Original
+*/
+static BOOL StartUncompress(LINEINPUT *li, DECODER *dec)
+{
+   int i;
+
+   if(((dec->lzwPrefix = (unsigned short *)
+        malloc(LZW_TABSIZE * sizeof(unsigned short)))==NULL) ||
+      ((dec->lzwSuffix = (unsigned char *)
+        malloc(LZW_TABSIZE * sizeof(unsigned char)))==NULL)  ||
+      ((dec->lzwStack  = (unsigned char *)
+        malloc((LZW_TABSIZE + 1) * sizeof(unsigned char)))==NULL))
+      return(FALSE);
+
+   for(i=0; i<256; i++)
+   {
+      dec->lzwPrefix[i] = 0;
+      dec->lzwSuffix[i] = (unsigned char)i;
+   }
+
+   if(!FillCompressed(li, dec, 3))
+   {
+      li->eof = TRUE;
+      return(TRUE);
+   }
+
+   dec->maxBits    = dec->in[dec->inPos+2] & 0x1F;
+   dec->blockMode  = (dec->in[dec->inPos+2] & 0x80) ? TRUE : FALSE;
+   dec->inPos     += 3;
+   if((dec->maxBits < LZW_INITBITS) || (dec->maxBits > LZW_MAXBITS))
+   {
+      li->eof = TRUE;
+      return(TRUE);
+   }
+
+   dec->maxMaxCode = 1L << dec->maxBits;
+   dec->nBits      = LZW_INITBITS;
+   dec->maxCode    = (1L << dec->nBits) - 1;
+   dec->freeEnt    = dec->blockMode ? (LZW_CLEAR + 1) : 256;
+   dec->oldCode    = -1;
+   dec->finChar    = 0;
+   dec->nCodes     = 0;
+   dec->bitBuff    = 0;
+   dec->bitCount   = 0;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void Uncompress(LINEINPUT *li, DECODER *dec)
+   ---------------------------------------------------
+*//**
+
+   \param[in,out] *li       Line input structure
+   \param[in,out] *dec      Decompression state
+
+   Decodes LZW (Unix compress) data into the free space at the end of
+   the data buffer. Decoding stops while there is still room for the
+   longest possible string. Corrupt or truncated data simply end the 
+   input.
+
+-  18.10.26 Original
+*/
+static void Uncompress(LINEINPUT *li, DECODER *dec)
+{
+   unsigned char *stackEnd = dec->lzwStack + LZW_TABSIZE + 1,
+                 *sp;
+   long          code,
+                 inCode;
+   size_t        start = li->dataEnd;
+
+   while(!li->eof && 
+         ((li->dataSize - li->dataEnd) > (size_t)(LZW_TABSIZE + 1)))
+   {
+      /* Move to the next code size. The codes at the old size are
+         padded to a whole group of 8
+      */
+      if(dec->freeEnt > dec->maxCode)
+      {
+         if(!SkipLZWPadding(li, dec))
+            break;
+         dec->nBits++;
+         dec->maxCode = (dec->nBits == dec->maxBits) ? 
+            dec->maxMaxCode : ((1L << dec->nBits) - 1);
+      }
+
+      if(!GetLZWCode(li, dec, &code))
+      {
+         li->eof = TRUE;
+         break;
+      }
+
+      if(dec->oldCode == -1)
+      {
+         if(code >= 256)
+         {
+            li->eof = TRUE;
+            break;
+         }
+         dec->oldCode = code;
+         dec->finChar = (int)code;
+         li->data[li->dataEnd++] = (char)code;
+         continue;
+      }
+
+      if((code == LZW_CLEAR) && dec->blockMode)
+      {
+         dec->freeEnt = LZW_CLEAR;
+         if(!SkipLZWPadding(li, dec))
+            break;
+         dec->nBits   = LZW_INITBITS;
+         dec->maxCode = (1L << dec->nBits) - 1;
+         continue;
+      }
+
+      /* Unpack the string for this code backwards onto the stack       */
+      inCode = code;
+      sp     = stackEnd;
+      if(code >= dec->freeEnt)
+      {
+         if(code > dec->freeEnt)
+         {
+            li->eof = TRUE;
+            break;
+         }
+         *--sp = (unsigned char)dec->finChar;
+         code  = dec->oldCode;
+      }
+      while((code >= 256) && (sp > dec->lzwStack))
+      {
+         *--sp = dec->lzwSuffix[code];
+         code  = dec->lzwPrefix[code];
+      }
+      if(sp == dec->lzwStack)
+      {
+         li->eof = TRUE;
+         break;
+      }
+      *--sp = dec->lzwSuffix[code];
+      dec->finChar = *sp;
+
+      memcpy(li->data + li->dataEnd, sp, (size_t)(stackEnd - sp));
+      li->dataEnd += (size_t)(stackEnd - sp);
+
+      if(dec->freeEnt < dec->maxMaxCode)
+      {
+         dec->lzwPrefix[dec->freeEnt] = (unsigned short)dec->oldCode;
+         dec->lzwSuffix[dec->freeEnt] = (unsigned char)dec->finChar;
+         dec->freeEnt++;
+      }
+      dec->oldCode = inCode;
+   }
+
+   /* Must make progress or finish                                      */
+   if(li->dataEnd == start)
+      li->eof = TRUE;
+}
+
+
+/************************************************************************/
+/*>static BOOL GetLZWCode(LINEINPUT *li, DECODER *dec, long *code)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]     *li       Line input structure
+   \param[in,out] *dec      Decompression state
+   \param[out]    *code     The next code
+   \return                  Was a complete code read?
+
+   Reads the next nBits-bit code (least significant bit first).
+
+-  18.10.26 Original
+*/
+static BOOL GetLZWCode(LINEINPUT *li, DECODER *dec, long *code)
+{
+   while(dec->bitCount < dec->nBits)
+   {
+      if(!FillCompressed(li, dec, 1))
+         return(FALSE);
+      dec->bitBuff  |= (unsigned long)dec->in[dec->inPos++] << 
+                       dec->bitCount;
+      dec->bitCount += 8;
+   }
+
+   *code          = (long)(dec->bitBuff & ((1UL << dec->nBits) - 1));
+   dec->bitBuff >>= dec->nBits;
+   dec->bitCount -= dec->nBits;
+   dec->nCodes++;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL SkipLZWPadding(LINEINPUT *li, DECODER *dec)
+   -------------------------------------------------------
+*//**
+
+   \param[in]     *li       Line input structure
+   \param[in,out] *dec      Decompression state
+   \return                  FALSE if the data ended
+
+   compress writes codes in groups of 8 (so a group is a whole number
+   of bytes) and pads the last group at one code size before changing
+   size or clearing the table. This skips that padding.
+
+-  18.10.26 Original
+*/
+static BOOL SkipLZWPadding(LINEINPUT *li, DECODER *dec)
+{
+   long code;
+
+   while(dec->nCodes % 8)
+   {
+      if(!GetLZWCode(li, dec, &code))
+      {
+         li->eof = TRUE;
+         return(FALSE);
+      }
+   }
+   dec->nCodes = 0;
+   return(TRUE);
+}
+
@@ -0,0 +1,108 @@
+/************************************************************************/
+/**
+
+   \file       LineInput.h
+
+   \version    V1.3
+   \date       18.10.26
+   \brief      Header file for LineInput.c
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+
+-  V1.0  18.10.26 Original
+-  V1.1  18.10.26 Added in-process decompression of gzip and compress
+                  data, blPeekLineInput() and blGetBlockLineInput()
+-  V1.2  18.10.26 Added offset and blTellLineInput()
+-  V1.3  18.10.26 Added blResizeLineInput()
+
+*************************************************************************/
+#ifndef _LINEINPUT_H
+#define _LINEINPUT_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stddef.h>
+#include "SysDefs.h"
+
+/************************************************************************/
+/* Defines
+*/
+#define LINEINPUT_PLAIN    0  /* Data are read as they are             */
+#define LINEINPUT_GZIP     1  /* gzip data decompressed with zlib      */
+#define LINEINPUT_COMPRESS 2  /* Unix compress (LZW) data              */
+
+typedef struct
+{
+   FILE   *fp;         /* The stream being read                         */
+   char   *map,        /* Memory mapped file or NULL if using stdio     */
+          *data;       /* Data returned: the mapping or a buffer        */
+   APTR   decoder;     /* Decompression state, NULL for plain data      */
+   size_t mapSize,     /* Size of the mapping                           */
+          dataSize,    /* Allocated size of the data buffer             */
+          dataEnd,     /* End of the valid data                         */
+          pos;         /* Current offset into the data                  */
+   long   offset;      /* File offset of data[0]; -1 if not known       */
+   int    maxlen,      /* Line chunk size as for fgets()                */
+          format;      /* LINEINPUT_PLAIN, _GZIP or _COMPRESS           */
+   BOOL   eof;         /* No more data can be added to the buffer       */
+}  LINEINPUT;
+
+/* Tests whether a line returned by blGetLineInput() starts with a given
+   string. The length check is needed as mapped lines are not
+   terminated
+*/
+#define LINEINPUTMATCH(line, len, str, n) \
+   (((len) >= (n)) && !strncmp((line), (str), (n)))
+
+/************************************************************************/
+/* Prototypes
+*/
+LINEINPUT *blOpenLineInput(FILE *fp, int maxlen);
+char *blGetLineInput(LINEINPUT *li, int *length);
+char *blPeekLineInput(LINEINPUT *li, int nchar, int *length);
+char *blGetBlockLineInput(LINEINPUT *li, int maxlen, int *length);
+long blTellLineInput(LINEINPUT *li);
+BOOL blResizeLineInput(LINEINPUT *li, int maxlen);
+void blCloseLineInput(LINEINPUT *li);
+
+#endif
@@ -3,11 +3,11 @@
 
    \file       MovePDB.c
    
-   \version    V1.3
-   \date       07.07.14
+   \version    V1.6
+   \date       18.10.26
    \brief      
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2014
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -50,6 +50,10 @@
 -  V1.2  27.02.98 Removed unreachable break from switch()
 -  V1.2a 06.01.11 Corrected description
 -  V1.3  07.07.14 Use bl prefix for functions By: CTP
+-  V1.4  18.10.26 Uses and updates gPDBAtomIndex
+-  V1.5  18.10.26 Updates the indexes attached to the lists
+-  V1.6  18.10.26 Uses the atom indexes attached to the lists rather
+                  than gPDBAtomIndex
 
 *************************************************************************/
 /* Doxygen
@@ -93,19 +97,33 @@
    point to the start of the 2 lists. If the to list hasn't been started,
    to should be NULL. Returns TRUE if moved, FALSE otherwise.
 
+   If an atom index is attached to either list, it is used to find the
+   record before move or the end of the to list. The indexes attached
+   to the lists are updated.
+
 -  13.05.92 Original
 -  19.06.92 Changed p=*to, etc. for crappy compilers
 -  07.07.14 Use bl prefix for functions By: CTP
+-  18.10.26 Uses and updates gPDBAtomIndex
+-  18.10.26 Updates the indexes attached to the lists
+-  18.10.26 Uses the atom indexes attached to the lists
 */
 BOOL blMovePDB(PDB *move, PDB **from, PDB **to)
 {
-   PDB *p;
-   BOOL ret = FALSE;
+   PDB          *p;
+   PDBATOMINDEX *index;
+   BOOL         ret = FALSE;
    
    if(move != NULL && *from != NULL)
    {
       /* Find the item before move in the *from list                    */
-      if(move == (*from))           /* Start of list                    */
+      if(((index = blGetPDBAtomIndex(*from)) != NULL) &&
+         (move->indexes == (*from)->indexes) &&
+         blGetPDBAtomBefore(index, move, &p))
+      {
+         ;                          /* Found using the index            */
+      }
+      else if(move == (*from))      /* Start of list                    */
       {
          p = NULL;
       }
@@ -116,6 +134,7 @@ BOOL blMovePDB(PDB *move, PDB **from, PDB **to)
       }
       
       /* Unlink move from *from                                         */
+      blRemoveFromPDBIndexes(move, p);
       if(p)          /* We're moving something in the middle of the list*/
       {
          /* Unlink move                                                 */
@@ -129,12 +148,20 @@ BOOL blMovePDB(PDB *move, PDB **from, PDB **to)
 
       /* Add move onto the end of *to                                   */
       move->next = NULL;
-      if(*to)
+      if((*to != NULL) && ((index = blGetPDBAtomIndex(*to)) != NULL))
+      {
+         /* Use the index to find the end of *to and add move to it     */
+         p = blGetPDBAtomByPosition(index, index->natoms - 1);
+         p->next = move;
+         blAppendToPDBIndexes(p, move);
+      }
+      else if(*to)
       {
          /* Move p to end of *to list                                   */
          for(p=(*to); p->next; NEXT(p)) ;
          /* Link in move                                                */
          p->next = move;
+         blAppendToPDBIndexes(p, move);
       }
       else
       {
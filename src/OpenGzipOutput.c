@@ -0,0 +1,183 @@
+/************************************************************************/
+/**
+
+   \file       OpenGzipOutput.c
+   
+   \version    V1.0
+   \date       18.10.26
+   \brief      Open a file for writing with gzip compression done in
+               process
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Provides a normal FILE pointer which compresses everything written
+   to it with zlib, so output can be gzipped without a pipe to gzip.
+   Requires ZLIB_SUPPORT and the GNU C library (for fopencookie()).
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  18.10.26 Original
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    General Programming
+   #SUBGROUP File IO
+   #FUNCTION  blOpenGzipOutput()
+   Opens a file for writing with gzip compression.
+*/
+/************************************************************************/
+/* Includes
+*/
+#ifdef ZLIB_SUPPORT
+#  ifndef _GNU_SOURCE
+#     define _GNU_SOURCE  /* For fopencookie()                           */
+#  endif
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef ZLIB_SUPPORT
+#include <zlib.h>
+#endif
+
+#include "general.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#if defined(ZLIB_SUPPORT) && defined(__GLIBC__)
+#  define GZIP_OUTPUT
+#endif
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+#ifdef GZIP_OUTPUT
+static ssize_t WriteGzip(void *cookie, const char *buffer, size_t size);
+static int CloseGzip(void *cookie);
+#endif
+
+/************************************************************************/
+/*>FILE *blOpenGzipOutput(char *filename)
+   --------------------------------------
+*//**
+
+   \param[in]     *filename  File to be written
+   \return                   A file pointer (NULL on error or if not
+                             supported)
+
+   Opens a file for writing. Everything written is gzip compressed in
+   process. Close with fclose() or blCloseOrPipe().
+
+-  18.10.26 Original
+*/
+FILE *blOpenGzipOutput(char *filename)
+{
+#ifdef GZIP_OUTPUT
+   cookie_io_functions_t gzFunctions;
+   gzFile                gz;
+   FILE                  *fp;
+
+   if((gz = gzopen(filename, "wb"))==NULL)
+      return(NULL);
+
+   gzFunctions.read  = NULL;
+   gzFunctions.write = WriteGzip;
+   gzFunctions.seek  = NULL;
+   gzFunctions.close = CloseGzip;
+
+   if((fp = fopencookie((void *)gz, "w", gzFunctions))==NULL)
+      gzclose(gz);
+
+   return(fp);
+#else
+   return(NULL);
+#endif
+}
+
+
+#ifdef GZIP_OUTPUT
+/************************************************************************/
+/*>static ssize_t WriteGzip(void *cookie, const char *buffer, size_t size)
+   -----------------------------------------------------------------------
+*//**
+
+   \param[in]     *cookie    The gzFile
+   \param[in]     *buffer    Data to write
+   \param[in]     size       Number of bytes to write
+   \return                   Number of bytes written (-1 on error)
+
+   Write function for fopencookie()
+
+-  18.10.26 Original
+*/
+static ssize_t WriteGzip(void *cookie, const char *buffer, size_t size)
+{
+   int nwritten;
+
+   if(size == 0)
+      return(0);
+   if((nwritten = gzwrite((gzFile)cookie, buffer, (unsigned)size)) <= 0)
+      return(-1);
+   return((ssize_t)nwritten);
+}
+
+
+/************************************************************************/
+/*>static int CloseGzip(void *cookie)
+   ----------------------------------
+*//**
+
+   \param[in]     *cookie    The gzFile
+   \return                   0 on success, EOF on error
+
+   Close function for fopencookie()
+
+-  18.10.26 Original
+*/
+static int CloseGzip(void *cookie)
+{
+   return((gzclose((gzFile)cookie) == Z_OK) ? 0 : EOF);
+}
+#endif
+
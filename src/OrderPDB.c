@@ -3,11 +3,11 @@
 
    \file       OrderPDB.c
    
-   \version    V1.6
-   \date       05.03.15
+   \version    V1.8
+   \date       18.10.26
    \brief      Functions to modify atom order in PDB linked list
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -54,6 +54,8 @@
 -  V1.5  23.02.15 Modified for new blRenumAtomsPDB() which takes an 
                   offset   By: ACRM
 -  V1.6  05.03.15 Replaced blFindEndPDB() with blFindNextResidue()
+-  V1.7  18.10.26 Sets name codes of padding atoms
+-  V1.8  18.10.26 Routines which reorder the list detach any indexes
 
 *************************************************************************/
 /* Doxygen
@@ -165,6 +167,7 @@ static char sAtoms[MAXSTDAA][MAXATINRES+1][8] =
 -  07.07.14 Use bl prefix for functions By: CTP
 -  23.02.15 Modified for new blRenumAtomsPDB() which takes an offset
 -  05.03.15 Replaced blFindEndPDB() with blFindNextResidue()
+-  18.10.26 Detaches any indexes of the list
 */
 PDB *blFixOrderPDB(PDB *pdb, BOOL Pad, BOOL Renum)
 {
@@ -173,6 +176,8 @@ PDB *blFixOrderPDB(PDB *pdb, BOOL Pad, BOOL Renum)
          *p       = NULL,
          *ret     = NULL,
          *current = NULL;
+
+   blDetachPDBIndexes(pdb);
    
    for(start=pdb; start!=NULL; start=end)
    {
@@ -224,6 +229,8 @@ PDB *blFixOrderPDB(PDB *pdb, BOOL Pad, BOOL Renum)
             the case when partial occupancy atoms are named as "N  A",
             "N  B", etc.
 -  07.07.14 Use bl prefix for functions By: CTP
+-  18.10.26 Sets name codes of padding atoms
+-  18.10.26 Detaches any indexes of the list
 */
 PDB *blShuffleResPDB(PDB *start, PDB *end, BOOL Pad)
 {
@@ -234,6 +241,8 @@ PDB *blShuffleResPDB(PDB *start, PDB *end, BOOL Pad)
          *p       = NULL,
          *extra   = NULL;
    BOOL  found    = FALSE;
+
+   blDetachPDBIndexes(start);
          
    /* Search for atom table for this amino acid                         */
    for(i=0; i<MAXSTDAA; i++)
@@ -282,6 +291,7 @@ PDB *blShuffleResPDB(PDB *start, PDB *end, BOOL Pad)
    
                   /* Set required atom name and NULL coordinates        */
                   strcpy(extra->atnam,atnam);
+                  blSetPDBNameCodes(extra);        /* 18.10.26          */
                   extra->x    = (REAL)9999.0;
                   extra->y    = (REAL)9999.0;
                   extra->z    = (REAL)9999.0;
@@ -385,6 +395,7 @@ BOOL blGetAtomTypes(char *resnam, char **AtomTypes)
             a different chain was of the same type, it ended up changing
             that instead!
 -  07.07.14 Use bl prefix for functions By: CTP
+-  18.10.26 Detaches any indexes of the list
 */
 PDB *blShuffleBB(PDB *pdb)
 {
@@ -397,6 +408,8 @@ PDB *blShuffleBB(PDB *pdb)
          *p,
          *next = NULL;
 
+   blDetachPDBIndexes(pdb);
+
    next = blFindNextResidue(pdb);
           
    for(p=pdb; p!=next; NEXT(p))
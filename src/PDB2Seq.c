@@ -3,12 +3,12 @@
 
    \file       PDB2Seq.c
    
-   \version    V1.15
-   \date       01.12.15
+   \version    V1.18
+   \date       18.10.26
    \brief      Conversion from PDB to sequence and other sequence
                related routines
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -68,6 +68,11 @@
 -  V1.13 04.02.14 Use CHAINMATCH By: CTP
 -  V1.14 07.07.14 Use bl prefix for functions By: CTP
 -  V1.15 01.12.15 Added blDoPDB2SeqByChain()  By: ACRM
+-  V1.16 18.10.26 Uses name codes to test record types and residue
+                  names and blThronePDB() to find 1-letter codes
+-  V1.17 18.10.26 Record types and residue names are compared as
+                  strings again since the name codes may be out of date
+-  V1.18 18.10.26 Uses name codes again
 
 *************************************************************************/
 /* Doxygen
@@ -96,6 +101,10 @@
 /************************************************************************/
 /* Defines and macros
 */
+#define ISNTER(p) PDBNAMEMATCH((p)->resnam_code, (p)->resnam,            \
+                               PDBNAME_NTER, "NTER", 4)
+#define ISCTER(p) PDBNAMEMATCH((p)->resnam_code, (p)->resnam,            \
+                               PDBNAME_CTER, "CTER", 4)
 
 /************************************************************************/
 /* Globals
@@ -142,6 +151,9 @@
             bug with CA-only chains where it was undercounting by 1
 -  04.02.14 Use CHAINMATCH By: CTP
 -  07.07.14 Use bl prefix for functions By: CTP
+-  18.10.26 Uses name codes and blThronePDB()
+-  18.10.26 Compares record types and residue names as strings
+-  18.10.26 Uses name codes again
 */
 char *blDoPDB2Seq(PDB *pdb, BOOL DoAsxGlx, BOOL ProtOnly, BOOL NoX)
 {
@@ -169,9 +181,7 @@ char *blDoPDB2Seq(PDB *pdb, BOOL DoAsxGlx, BOOL ProtOnly, BOOL NoX)
    {
       if(p->resnum != resnum || p->insert[0] != insert)
       {
-         if(strncmp(p->resnam,"NTER",4) && 
-            strncmp(p->resnam,"CTER",4) &&
-            !strncmp(p->record_type,"ATOM  ",6))   /* V1.7              */
+         if(!ISNTER(p) && !ISCTER(p) && ISATOMREC(p))   /* V1.7         */
             rescount++;
             
          resnum = p->resnum;
@@ -197,9 +207,7 @@ char *blDoPDB2Seq(PDB *pdb, BOOL DoAsxGlx, BOOL ProtOnly, BOOL NoX)
 
    /* Skip an NTER residue                                              */
    /* 24.01.96 Added NULL check; occurs when no ATOM records present    */
-   while(p!=NULL && 
-         (!strncmp(p->resnam,"NTER",4) || 
-          strncmp(p->record_type,"ATOM  ",6))) 
+   while(p!=NULL && (ISNTER(p) || !ISATOMREC(p)))
       NEXT(p);
    if(p==NULL)
    {
@@ -207,7 +215,7 @@ char *blDoPDB2Seq(PDB *pdb, BOOL DoAsxGlx, BOOL ProtOnly, BOOL NoX)
       return(sequence);
    }
    
-   sequence[0] = ((DoAsxGlx)?blThronex(p->resnam):blThrone(p->resnam));
+   sequence[0] = blThronePDB(p, DoAsxGlx);
    if((!ProtOnly) || (!gBioplibSeqNucleicAcid))
       rescount = 1;
    else
@@ -225,7 +233,7 @@ char *blDoPDB2Seq(PDB *pdb, BOOL DoAsxGlx, BOOL ProtOnly, BOOL NoX)
 
    for(p=p->next; p!=NULL; NEXT(p))
    {
-      if(!strncmp(p->record_type,"ATOM  ",6))    /* V1.7                */
+      if(ISATOMREC(p))                           /* V1.7                */
       {
          if(p->resnum != resnum || p->insert[0] != insert)
          {
@@ -239,11 +247,9 @@ char *blDoPDB2Seq(PDB *pdb, BOOL DoAsxGlx, BOOL ProtOnly, BOOL NoX)
             /* 06.02.03 Fixed bug - was incrementing recount even when
                it was NTER/CTER
             */
-            if(strncmp(p->resnam,"NTER",4) && strncmp(p->resnam,"CTER",4))
+            if(!ISNTER(p) && !ISCTER(p))
             {
-               sequence[rescount] = ((DoAsxGlx) ? 
-                                     blThronex(p->resnam):
-                                     blThrone(p->resnam));
+               sequence[rescount] = blThronePDB(p, DoAsxGlx);
                if((!ProtOnly) || (!gBioplibSeqNucleicAcid))
                   rescount++;
 
@@ -290,6 +296,9 @@ char *blDoPDB2Seq(PDB *pdb, BOOL DoAsxGlx, BOOL ProtOnly, BOOL NoX)
    X handle Asx/Glx as B/Z rather than as X
    
 -  30.11.15 Original based on blDoPDB2Seq()    By: ACRM
+-  18.10.26 Uses name codes and blThronePDB()
+-  18.10.26 Compares record types and residue names as strings
+-  18.10.26 Uses name codes again
 */
 HASHTABLE *blDoPDB2SeqByChain(PDB *pdb, BOOL DoAsxGlx, BOOL ProtOnly, 
                               BOOL NoX)
@@ -326,7 +335,7 @@ HASHTABLE *blDoPDB2SeqByChain(PDB *pdb, BOOL DoAsxGlx, BOOL ProtOnly,
    for(p=pdb; p!=NULL; NEXT(p))
    {
       /* Only interested in ATOM records                                */
-      if(!strncmp(p->record_type, "ATOM  ", 6))
+      if(ISATOMREC(p))
       {
          /* If chain has changed                                        */
          if(!CHAINMATCH(p->chain, lastchain))
@@ -347,11 +356,9 @@ HASHTABLE *blDoPDB2SeqByChain(PDB *pdb, BOOL DoAsxGlx, BOOL ProtOnly,
             !INSERTMATCH(p->insert, lastinsert) ||
             !CHAINMATCH(p->chain, lastchain))
          {
-            if(strncmp(p->resnam,"NTER",4) && 
-               strncmp(p->resnam,"CTER",4))
+            if(!ISNTER(p) && !ISCTER(p))
             {
-               sequence[nres]=((DoAsxGlx) ? blThronex((p)->resnam) :
-                               blThrone((p)->resnam));
+               sequence[nres] = blThronePDB(p, DoAsxGlx);
 
                /* Increments count if it's not protein only or it's not 
                   a nucleic acid AND we aren't skipping Xs or it's not 
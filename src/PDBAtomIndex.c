@@ -0,0 +1,600 @@
+/************************************************************************/
+/**
+
+   \file       PDBAtomIndex.c
+
+   \version    V1.1
+   \date       18.10.26
+   \brief      Index of the atoms in a PDB linked list by position and
+               atom number
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   blGetPDBByN() steps along the linked list to the atom it is asked
+   for, while blIndexPDB() and blIndexAtomNumbersPDB() step through the
+   whole list each time they are called. A PDBATOMINDEX is built once
+   for a linked list and finds an atom from its position in the list
+   or its atom number without searching.
+
+   If the index is attached to the linked list with
+   blAttachPDBAtomIndex() (see PDBIndexes.c), it is used by
+   blGetPDBByN(), blIndexPDB() and blIndexAtomNumbersPDB() whenever
+   they are given that list. It is also kept up to date when atoms are
+   removed from the list with blDeleteAtomPDB(), blDeleteAtomRangePDB(),
+   blDeleteResiduePDB(), blKillPDB() or blMovePDB(), when atoms are
+   added to the end of it with blMovePDB() or blAppendPDB(), and when
+   the atoms are renumbered with blRenumAtomsPDB(). The first atom of
+   the list may change in these cases and the index follows it. Other
+   changes to the list (e.g. inserting atoms in the middle) require the
+   index to be detached and rebuilt. If memory runs out while an index
+   is being updated, index->pdb is set to NULL and it is no longer
+   used.
+
+   Removed atoms are marked in the position array and the array is
+   closed up when a position is next looked up, so a run of deletions
+   costs no more than a single pass through the array. The position of
+   an atom is found from its atom number, so removing an atom does not
+   search the array unless atom numbers are repeated.
+
+   Atom numbers are expected to be unique; if they are not, the last
+   atom with a given number is indexed, as in blIndexAtomNumbersPDB().
+
+**************************************************************************
+
+   Usage:
+   ======
+
+\code
+   blAttachPDBAtomIndex(pdb);
+   ...
+   p = blGetPDBByN(pdb, 1000);
+   pdb = blDeleteAtomPDB(pdb, p);
+   ...
+   blDetachPDBIndexes(pdb);
+\endcode
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  18.10.26 Original
+-  V1.1  18.10.26 Added blGetPDBAtomBefore(). Atoms are found from their
+                  atom numbers. No longer uses gPDBAtomIndex
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP Searching the PDB linked list
+   #FUNCTION  blBuildPDBAtomIndex()
+   Builds an index of the atoms in a PDB linked list by position and
+   atom number
+
+   #FUNCTION  blGetPDBAtomByPosition()
+   Gets an atom from its position in the list using an index
+
+   #FUNCTION  blGetPDBAtomByNumber()
+   Gets an atom from its atom number using an index
+
+   #FUNCTION  blAppendToPDBAtomIndex()
+   Adds atoms appended to a PDB linked list to its index
+
+   #FUNCTION  blRemoveFromPDBAtomIndex()
+   Removes an atom which is being unlinked from a PDB linked list from
+   its index
+
+   #FUNCTION  blGetPDBAtomBefore()
+   Gets the atom before an atom in the list using an index
+
+   #FUNCTION  blUpdatePDBAtomIndexNumbers()
+   Updates the atom number index after the atoms have been renumbered
+
+   #FUNCTION  blFreePDBAtomIndex()
+   Frees an atom index
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdlib.h>
+#include <string.h>
+
+#include "SysDefs.h"
+#include "pdb.h"
+#include "macros.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define ATOMINDEXSTEP 1024        /* Minimum growth of the arrays       */
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+static void CompactPositions(PDBATOMINDEX *index);
+static BOOL GrowAtnumIndex(PDBATOMINDEX *index, int atnum);
+static int  FindPosition(PDBATOMINDEX *index, PDB *atom);
+static PDB  *FindBefore(PDBATOMINDEX *index, int pos);
+
+
+/************************************************************************/
+/*>PDBATOMINDEX *blBuildPDBAtomIndex(PDB *pdb)
+   -------------------------------------------
+*//**
+
+   \param[in]     *pdb     PDB linked list
+   \return                 The index. NULL if no memory
+
+   Builds an index of the atoms in a PDB linked list by position and
+   atom number. Free with blFreePDBAtomIndex().
+
+-  18.10.26 Original
+-  18.10.26 Initialises slots
+*/
+PDBATOMINDEX *blBuildPDBAtomIndex(PDB *pdb)
+{
+   PDBATOMINDEX *index;
+
+   if((index = (PDBATOMINDEX *)malloc(sizeof(PDBATOMINDEX)))==NULL)
+      return(NULL);
+
+   index->pdb       = pdb;
+   index->atoms     = NULL;
+   index->byAtnum   = NULL;
+   index->slots     = NULL;
+   index->natoms    = 0;
+   index->nslots    = 0;
+   index->maxslots  = 0;
+   index->atnumSize = 0;
+   index->hint      = 0;
+
+   if(!blAppendToPDBAtomIndex(index, pdb))
+   {
+      blFreePDBAtomIndex(index);
+      return(NULL);
+   }
+
+   return(index);
+}
+
+
+/************************************************************************/
+/*>PDB *blGetPDBAtomByPosition(PDBATOMINDEX *index, int n)
+   -------------------------------------------------------
+*//**
+
+   \param[in,out] *index   Atom index
+   \param[in]     n        Position in the list (from 0)
+   \return                 The atom. NULL if n is out of range
+
+   Gets an atom from its position in the linked list. If atoms have
+   been removed since the last call, the position array is closed up
+   first.
+
+-  18.10.26 Original
+*/
+PDB *blGetPDBAtomByPosition(PDBATOMINDEX *index, int n)
+{
+   if((n < 0) || (n >= index->natoms))
+      return(NULL);
+
+   if(index->nslots != index->natoms)
+      CompactPositions(index);
+
+   return(index->atoms[n]);
+}
+
+
+/************************************************************************/
+/*>PDB *blGetPDBAtomByNumber(PDBATOMINDEX *index, int atnum)
+   ---------------------------------------------------------
+*//**
+
+   \param[in]     *index   Atom index
+   \param[in]     atnum    Atom number
+   \return                 The atom. NULL if there is no atom with this
+                           number
+
+   Gets an atom from its atom number
+
+-  18.10.26 Original
+*/
+PDB *blGetPDBAtomByNumber(PDBATOMINDEX *index, int atnum)
+{
+   if((atnum < 0) || (atnum >= index->atnumSize))
+      return(NULL);
+
+   return(index->byAtnum[atnum]);
+}
+
+
+/************************************************************************/
+/*>BOOL blAppendToPDBAtomIndex(PDBATOMINDEX *index, PDB *first)
+   ------------------------------------------------------------
+*//**
+
+   \param[in,out] *index   Atom index
+   \param[in]     *first   First of the atoms appended to the list
+   \return                 Success? FALSE if memory ran out
+
+   Adds atoms which have been linked onto the end of the indexed list
+   to the index. first and all the atoms following it are added. If
+   the indexed list was empty, first becomes its first atom.
+
+   If memory runs out, the index is no longer associated with any list
+   (index->pdb is set to NULL) so it will not be used.
+
+-  18.10.26 Original
+-  18.10.26 Records the slot of each atom number
+*/
+BOOL blAppendToPDBAtomIndex(PDBATOMINDEX *index, PDB *first)
+{
+   PDB *p,
+       **atoms;
+   int nnew = 0,
+       size;
+
+   for(p=first; p!=NULL; NEXT(p))
+      nnew++;
+
+   if(index->nslots + nnew > index->maxslots)
+   {
+      size = index->nslots + nnew;
+      if(size < index->maxslots + ATOMINDEXSTEP)
+         size = index->maxslots + ATOMINDEXSTEP;
+      if((atoms = (PDB **)realloc(index->atoms, size * sizeof(PDB *)))
+         ==NULL)
+      {
+         index->pdb = NULL;
+         return(FALSE);
+      }
+      index->atoms    = atoms;
+      index->maxslots = size;
+   }
+
+   if(index->natoms == 0)
+      index->pdb = first;
+
+   for(p=first; p!=NULL; NEXT(p))
+   {
+      if(p->atnum >= 0)
+      {
+         if((p->atnum >= index->atnumSize) &&
+            !GrowAtnumIndex(index, p->atnum))
+         {
+            index->pdb = NULL;
+            return(FALSE);
+         }
+         index->byAtnum[p->atnum] = p;
+         index->slots[p->atnum]   = index->nslots;
+      }
+
+      index->atoms[index->nslots++] = p;
+      index->natoms++;
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL blRemoveFromPDBAtomIndex(PDBATOMINDEX *index, PDB *atom,
+                                 PDB **prev)
+   -------------------------------------------------------------
+*//**
+
+   \param[in,out] *index   Atom index
+   \param[in]     *atom    Atom being removed from the indexed list
+   \param[out]    **prev   The atom before it in the list (NULL if it
+                           is the first). May be NULL if not needed
+   \return                 Was the atom in the index?
+
+   Removes an atom from the index. This must be called while the atom
+   is still linked into the list. If it is the first atom, the index
+   is moved on to the next one.
+
+-  18.10.26 Original
+-  18.10.26 Finding the atom before moved to FindBefore()
+*/
+BOOL blRemoveFromPDBAtomIndex(PDBATOMINDEX *index, PDB *atom, PDB **prev)
+{
+   int pos;
+
+   if(prev != NULL)
+      *prev = NULL;
+
+   if((pos = FindPosition(index, atom)) < 0)
+      return(FALSE);
+
+   if(prev != NULL)
+      *prev = FindBefore(index, pos);
+
+   index->atoms[pos] = NULL;
+   index->natoms--;
+   index->hint = pos;
+
+   if((atom->atnum >= 0) && (atom->atnum < index->atnumSize) &&
+      (index->byAtnum[atom->atnum] == atom))
+      index->byAtnum[atom->atnum] = NULL;
+
+   if(index->pdb == atom)
+      index->pdb = atom->next;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL blGetPDBAtomBefore(PDBATOMINDEX *index, PDB *atom, PDB **prev)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in,out] *index   Atom index
+   \param[in]     *atom    An atom in the indexed list
+   \param[out]    **prev   The atom before it in the list (NULL if it
+                           is the first)
+   \return                 Was the atom in the index?
+
+   Finds the atom before an atom in the list without stepping along the
+   list. The atom is left in the index, and is found at once if it is
+   then removed.
+
+-  18.10.26 Original
+*/
+BOOL blGetPDBAtomBefore(PDBATOMINDEX *index, PDB *atom, PDB **prev)
+{
+   int pos;
+
+   *prev = NULL;
+
+   if((pos = FindPosition(index, atom)) < 0)
+      return(FALSE);
+
+   *prev       = FindBefore(index, pos);
+   index->hint = pos;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL blUpdatePDBAtomIndexNumbers(PDBATOMINDEX *index)
+   -----------------------------------------------------
+*//**
+
+   \param[in,out] *index   Atom index
+   \return                 Success? FALSE if memory ran out
+
+   Rebuilds the atom number part of the index after the atoms in the
+   list have been renumbered. If memory runs out, the index is no
+   longer associated with any list (index->pdb is set to NULL) so it
+   will not be used.
+
+-  18.10.26 Original
+-  18.10.26 Records the slot of each atom number
+*/
+BOOL blUpdatePDBAtomIndexNumbers(PDBATOMINDEX *index)
+{
+   PDB *p;
+   int i;
+
+   if(index->atnumSize > 0)
+      memset(index->byAtnum, 0, index->atnumSize * sizeof(PDB *));
+
+   for(i=0; i<index->nslots; i++)
+   {
+      if(((p = index->atoms[i]) != NULL) && (p->atnum >= 0))
+      {
+         if((p->atnum >= index->atnumSize) &&
+            !GrowAtnumIndex(index, p->atnum))
+         {
+            index->pdb = NULL;
+            return(FALSE);
+         }
+         index->byAtnum[p->atnum] = p;
+         index->slots[p->atnum]   = i;
+      }
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void blFreePDBAtomIndex(PDBATOMINDEX *index)
+   --------------------------------------------
+*//**
+
+   \param[in]     *index   Atom index (may be NULL)
+
+   Frees an atom index. An index attached to a list is freed with
+   blDetachPDBIndexes() instead.
+
+-  18.10.26 Original
+-  18.10.26 No longer clears gPDBAtomIndex. Frees slots
+*/
+void blFreePDBAtomIndex(PDBATOMINDEX *index)
+{
+   if(index == NULL)
+      return;
+
+   FREE(index->atoms);
+   FREE(index->byAtnum);
+   FREE(index->slots);
+   free(index);
+}
+
+
+/************************************************************************/
+/*>static void CompactPositions(PDBATOMINDEX *index)
+   -------------------------------------------------
+*//**
+
+   \param[in,out] *index   Atom index
+
+   Closes up the gaps left in the position array by removed atoms
+
+-  18.10.26 Original
+-  18.10.26 Updates the slots of the atoms that move
+*/
+static void CompactPositions(PDBATOMINDEX *index)
+{
+   PDB *p;
+   int i,
+       j;
+
+   for(i=0, j=0; i<index->nslots; i++)
+   {
+      if((p = index->atoms[i]) != NULL)
+      {
+         if((p->atnum >= 0) && (p->atnum < index->atnumSize) &&
+            (index->byAtnum[p->atnum] == p))
+            index->slots[p->atnum] = j;
+         index->atoms[j++] = p;
+      }
+   }
+
+   index->nslots = j;
+   index->hint   = 0;
+}
+
+
+/************************************************************************/
+/*>static BOOL GrowAtnumIndex(PDBATOMINDEX *index, int atnum)
+   ----------------------------------------------------------
+*//**
+
+   \param[in,out] *index   Atom index
+   \param[in]     atnum    Atom number which must fit in the index
+   \return                 Success?
+
+   Enlarges the atom number and slot arrays so that atnum can be
+   stored
+
+-  18.10.26 Original
+-  18.10.26 Also enlarges the slot array
+*/
+static BOOL GrowAtnumIndex(PDBATOMINDEX *index, int atnum)
+{
+   PDB **byAtnum;
+   int *slots,
+       size = atnum + 1;
+
+   if(size < index->atnumSize + ATOMINDEXSTEP)
+      size = index->atnumSize + ATOMINDEXSTEP;
+
+   if((byAtnum = (PDB **)realloc(index->byAtnum, size * sizeof(PDB *)))
+      ==NULL)
+      return(FALSE);
+   index->byAtnum = byAtnum;
+
+   if((slots = (int *)realloc(index->slots, size * sizeof(int)))==NULL)
+      return(FALSE);
+   index->slots = slots;
+
+   memset(byAtnum + index->atnumSize, 0,
+          (size - index->atnumSize) * sizeof(PDB *));
+   index->atnumSize = size;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static int FindPosition(PDBATOMINDEX *index, PDB *atom)
+   -------------------------------------------------------
+*//**
+
+   \param[in]     *index   Atom index
+   \param[in]     *atom    An atom
+   \return                 Its slot in the position array. -1 if it is
+                           not in the index
+
+   Finds the slot holding an atom. If it is the atom indexed by its
+   atom number, the slot is known. Otherwise the search starts from
+   the last atom removed, so removing atoms in list order does not
+   search the array from the start each time.
+
+-  18.10.26 Original
+-  18.10.26 Looks the atom up by its atom number first
+*/
+static int FindPosition(PDBATOMINDEX *index, PDB *atom)
+{
+   int i;
+
+   if((atom->atnum >= 0) && (atom->atnum < index->atnumSize) &&
+      (index->byAtnum[atom->atnum] == atom))
+      return(index->slots[atom->atnum]);
+
+   for(i=index->hint; i<index->nslots; i++)
+   {
+      if(index->atoms[i] == atom)
+         return(i);
+   }
+   for(i=0; (i<index->hint) && (i<index->nslots); i++)
+   {
+      if(index->atoms[i] == atom)
+         return(i);
+   }
+
+   return(-1);
+}
+
+
+/************************************************************************/
+/*>static PDB *FindBefore(PDBATOMINDEX *index, int pos)
+   ----------------------------------------------------
+*//**
+
+   \param[in]     *index   Atom index
+   \param[in]     pos      Slot holding an atom
+   \return                 The atom before it in the list. NULL if it is
+                           the first
+
+   Finds the atom before the one in a given slot, skipping the slots of
+   removed atoms
+
+-  18.10.26 Split from blRemoveFromPDBAtomIndex()
+*/
+static PDB *FindBefore(PDBATOMINDEX *index, int pos)
+{
+   int i;
+
+   for(i=pos-1; i>=0; i--)
+   {
+      if(index->atoms[i] != NULL)
+         return(index->atoms[i]);
+   }
+
+   return(NULL);
+}
@@ -0,0 +1,510 @@
+/************************************************************************/
+/**
+
+   \file       PDBBatch.c
+
+   \version    V1.2
+   \date       18.10.26
+   \brief      Read a list of PDB files in parallel
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Reads a list of files as blReadWholePDB() would, using a pool of
+   worker threads. Each file is read with blDoReadPDBState() so the
+   threads do not share the global flags set by blDoReadPDB(); the
+   flags for each file are returned with its WHOLEPDB.
+
+   The results are returned one at a time by blGetPDBBatch(), either in
+   the order of the list or in the order in which they are finished.
+   At most maxInFlight files are being read or waiting to be collected
+   at any time, so memory use is bounded however long the list.
+
+   If NOTHREADS or MS_WINDOWS is defined, no threads are started and
+   each file is read when it is requested. Otherwise code must be
+   linked with -lpthread.
+
+   Without ZLIB_SUPPORT, gzipped files are uncompressed through a
+   temporary file named from the process ID, so they should not be
+   read with more than one thread.
+
+   With XML_SUPPORT, blOpenPDBBatch() initialises the XML parser but
+   the library never cleans it up, since another batch or another
+   thread may still be parsing. A program which has finished with all
+   XML parsing may call xmlCleanupParser() itself before exiting.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+\code
+   if((batch = blOpenPDBBatch(filenames, nfiles, 8, 32, FALSE))!=NULL)
+   {
+      while(blGetPDBBatch(batch, &wpdb, &i, &state))
+      {
+         if(wpdb == NULL)
+            fprintf(stderr, "Unable to read %s\n", filenames[i]);
+         else
+         {
+            ... use wpdb (state.partialOcc etc. give the flags) ...
+            blFreeWholePDB(wpdb);
+         }
+      }
+      blClosePDBBatch(batch);
+   }
+\endcode
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  18.10.26 Original
+-  V1.1  18.10.26 Builds the name code table before starting threads
+-  V1.2  18.10.26 blClosePDBBatch() no longer calls xmlCleanupParser()
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP File IO
+   #FUNCTION  blOpenPDBBatch()
+   Starts reading a list of PDB files with a pool of threads.
+
+   #FUNCTION  blGetPDBBatch()
+   Gets the next WHOLEPDB from a batch.
+
+   #FUNCTION  blClosePDBBatch()
+   Stops the threads and frees a batch.
+*/
+/************************************************************************/
+/* Includes
+*/
+#if defined(MS_WINDOWS) && !defined(NOTHREADS)
+#  define NOTHREADS
+#endif
+
+#ifndef NOTHREADS
+#  if !defined(_POSIX_C_SOURCE) || (_POSIX_C_SOURCE < 200112L)
+#     undef  _POSIX_C_SOURCE
+#     define _POSIX_C_SOURCE 200112L  /* For pthreads                    */
+#  endif
+#endif
+#include "port.h"    /* Required before stdio.h                         */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef NOTHREADS
+#include <pthread.h>
+#endif
+
+#ifdef XML_SUPPORT
+#include <libxml/parser.h>
+#endif
+
+#include "SysDefs.h"
+#include "pdb.h"
+#include "macros.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+typedef struct             /* Result for one file                       */
+{
+   WHOLEPDB     *wpdb;
+   PDBREADSTATE state;
+   BOOL         done;      /* Has been read                             */
+}  PDBBATCHRESULT;
+
+struct _pdbbatch
+{
+   char           **filenames;
+   PDBBATCHRESULT *results;
+   int            *finished,   /* Indices of files in order of reading  */
+                  nfiles,
+                  nextFile,    /* Next file to be started               */
+                  nextOut,     /* Next file to return if inOrder        */
+                  nFinished,   /* Number of entries in finished         */
+                  nReturned,   /* Number of files returned              */
+                  inFlight,    /* Files started but not returned        */
+                  maxInFlight,
+                  nthreads;
+   BOOL           inOrder,
+                  closing;     /* Workers are to stop                   */
+#ifndef NOTHREADS
+   pthread_t      *threads;
+   pthread_mutex_t lock;
+   pthread_cond_t canStart,    /* inFlight has dropped or closing       */
+                  haveResult;  /* A file has been read                  */
+#endif
+};
+
+/************************************************************************/
+/* Prototypes
+*/
+static void ReadBatchFile(char *filename, PDBBATCHRESULT *result);
+#ifndef NOTHREADS
+static void *BatchWorker(void *arg);
+#endif
+
+
+/************************************************************************/
+/*>PDBBATCH *blOpenPDBBatch(char **filenames, int nfiles, int nthreads,
+                            int maxInFlight, BOOL inOrder)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     **filenames   Files to read. The array must not be
+                                freed until blClosePDBBatch() is called
+   \param[in]     nfiles        Number of files
+   \param[in]     nthreads      Number of threads to read the files
+   \param[in]     maxInFlight   Largest number of files being read or
+                                waiting to be collected at once (at
+                                least nthreads)
+   \param[in]     inOrder       Return the files in the order of the
+                                list rather than as they are finished
+   \return                      The batch. NULL if memory allocation
+                                or starting the threads failed
+
+   Starts reading a list of files with a pool of threads. Each file is
+   read as by blReadWholePDB(). The results are collected with
+   blGetPDBBatch().
+
+   With XML_SUPPORT, the XML parser is initialised here so PDBML files
+   can be read by several threads. It is not cleaned up by
+   blClosePDBBatch(), since other batches or threads may still be
+   parsing; the application may call xmlCleanupParser() once it has
+   finished with all XML parsing.
+
+-  18.10.26 Original
+-  18.10.26 Builds the name code table before starting threads
+-  18.10.26 The XML parser is no longer cleaned up by blClosePDBBatch()
+*/
+PDBBATCH *blOpenPDBBatch(char **filenames, int nfiles, int nthreads,
+                         int maxInFlight, BOOL inOrder)
+{
+   PDBBATCH *batch;
+   int      i;
+
+   if((filenames == NULL) || (nfiles < 0))
+      return(NULL);
+   if(nthreads < 1)
+      nthreads = 1;
+   if(nthreads > nfiles)
+      nthreads = MAX(nfiles, 1);
+   if(maxInFlight < nthreads)
+      maxInFlight = nthreads;
+
+   if((batch = (PDBBATCH *)malloc(sizeof(PDBBATCH)))==NULL)
+      return(NULL);
+
+   batch->filenames   = filenames;
+   batch->nfiles      = nfiles;
+   batch->nextFile    = 0;
+   batch->nextOut     = 0;
+   batch->nFinished   = 0;
+   batch->nReturned   = 0;
+   batch->inFlight    = 0;
+   batch->maxInFlight = maxInFlight;
+   batch->nthreads    = nthreads;
+   batch->inOrder     = inOrder;
+   batch->closing     = FALSE;
+
+   batch->results  = (PDBBATCHRESULT *)malloc(MAX(nfiles, 1) *
+                                              sizeof(PDBBATCHRESULT));
+   batch->finished = (int *)malloc(MAX(nfiles, 1) * sizeof(int));
+   if((batch->results == NULL) || (batch->finished == NULL))
+   {
+      FREE(batch->results);
+      FREE(batch->finished);
+      free(batch);
+      return(NULL);
+   }
+
+   for(i=0; i<nfiles; i++)
+   {
+      batch->results[i].wpdb = NULL;
+      batch->results[i].done = FALSE;
+   }
+
+#ifdef XML_SUPPORT
+   xmlInitParser();
+#endif
+
+   /* The name code table must be built before any thread uses it      */
+   blInitPDBNameCodes();
+
+#ifndef NOTHREADS
+   if((batch->threads = (pthread_t *)malloc(nthreads * sizeof(pthread_t)))
+      ==NULL)
+   {
+      free(batch->results);
+      free(batch->finished);
+      free(batch);
+      return(NULL);
+   }
+   pthread_mutex_init(&(batch->lock), NULL);
+   pthread_cond_init(&(batch->canStart), NULL);
+   pthread_cond_init(&(batch->haveResult), NULL);
+
+   for(i=0; i<nthreads; i++)
+   {
+      if(pthread_create(&(batch->threads[i]), NULL, BatchWorker,
+                        (void *)batch))
+      {
+         /* Stop the threads that were started                          */
+         batch->nthreads = i;
+         blClosePDBBatch(batch);
+         return(NULL);
+      }
+   }
+#endif
+
+   return(batch);
+}
+
+
+/************************************************************************/
+/*>BOOL blGetPDBBatch(PDBBATCH *batch, WHOLEPDB **wpdb, int *index,
+                      PDBREADSTATE *state)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in]     *batch    Batch from blOpenPDBBatch()
+   \param[out]    **wpdb    The WHOLEPDB read from the file. NULL if
+                            the file could not be opened or read
+   \param[out]    *index    Position of the file in the list
+   \param[out]    *state    Flags for the file as set in gPDBPartialOcc,
+                            gPDBMultiNMR, gPDBXML and gPDBModelNotFound
+                            by blReadWholePDB(). May be NULL
+   \return                  FALSE when all files have been returned
+
+   Waits for the next file to be read and returns it. The WHOLEPDB
+   belongs to the caller and is freed with blFreeWholePDB(). Collecting
+   a file allows another to be started.
+
+-  18.10.26 Original
+*/
+BOOL blGetPDBBatch(PDBBATCH *batch, WHOLEPDB **wpdb, int *index,
+                   PDBREADSTATE *state)
+{
+   PDBBATCHRESULT *result;
+   int            i;
+
+   *wpdb = NULL;
+
+#ifdef NOTHREADS
+   if(batch->nReturned == batch->nfiles)
+      return(FALSE);
+
+   i = batch->nReturned;
+   ReadBatchFile(batch->filenames[i], &(batch->results[i]));
+#else
+   pthread_mutex_lock(&(batch->lock));
+   if(batch->nReturned == batch->nfiles)
+   {
+      pthread_mutex_unlock(&(batch->lock));
+      return(FALSE);
+   }
+
+   if(batch->inOrder)
+   {
+      i = batch->nextOut++;
+      while(!batch->results[i].done)
+         pthread_cond_wait(&(batch->haveResult), &(batch->lock));
+   }
+   else
+   {
+      while(batch->nReturned == batch->nFinished)
+         pthread_cond_wait(&(batch->haveResult), &(batch->lock));
+      i = batch->finished[batch->nReturned];
+   }
+#endif
+
+   result       = &(batch->results[i]);
+   *wpdb        = result->wpdb;
+   result->wpdb = NULL;
+   *index       = i;
+   if(state != NULL)
+      *state = result->state;
+
+   (batch->nReturned)++;
+
+#ifndef NOTHREADS
+   (batch->inFlight)--;
+   pthread_cond_signal(&(batch->canStart));
+   pthread_mutex_unlock(&(batch->lock));
+#endif
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void blClosePDBBatch(PDBBATCH *batch)
+   -------------------------------------
+*//**
+
+   \param[in]     *batch    Batch from blOpenPDBBatch()
+
+   Stops the threads, which finish any file they are reading, and frees
+   the batch including any files which were not collected. May be
+   called before all files have been collected. The XML parser is
+   left for the application to clean up (see blOpenPDBBatch()).
+
+-  18.10.26 Original
+-  18.10.26 No longer calls xmlCleanupParser()
+*/
+void blClosePDBBatch(PDBBATCH *batch)
+{
+   int i;
+
+   if(batch == NULL)
+      return;
+
+#ifndef NOTHREADS
+   pthread_mutex_lock(&(batch->lock));
+   batch->closing = TRUE;
+   pthread_cond_broadcast(&(batch->canStart));
+   pthread_mutex_unlock(&(batch->lock));
+
+   for(i=0; i<batch->nthreads; i++)
+      pthread_join(batch->threads[i], NULL);
+
+   pthread_cond_destroy(&(batch->canStart));
+   pthread_cond_destroy(&(batch->haveResult));
+   pthread_mutex_destroy(&(batch->lock));
+   free(batch->threads);
+#endif
+
+   for(i=0; i<batch->nfiles; i++)
+   {
+      if(batch->results[i].wpdb != NULL)
+         blFreeWholePDB(batch->results[i].wpdb);
+   }
+
+   free(batch->results);
+   free(batch->finished);
+   free(batch);
+}
+
+
+/************************************************************************/
+/*>static void ReadBatchFile(char *filename, PDBBATCHRESULT *result)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]     *filename The file to read
+   \param[out]    *result   The WHOLEPDB and flags
+
+   Reads a file as blReadWholePDB() does but without setting the global
+   flags. result->wpdb is NULL if the file could not be read.
+
+-  18.10.26 Original
+*/
+static void ReadBatchFile(char *filename, PDBBATCHRESULT *result)
+{
+   FILE *fp;
+
+   result->wpdb                = NULL;
+   result->state.partialOcc    = FALSE;
+   result->state.xml           = FALSE;
+   result->state.modelNotFound = TRUE;
+   result->state.multiNMR      = 0;
+
+   if((fp = fopen(filename, "r"))==NULL)
+      return;
+
+   if((result->wpdb = blDoReadPDBState(fp, TRUE, 1, 1, TRUE,
+                                       &(result->state)))!=NULL)
+   {
+      if(result->wpdb->natoms < 0)
+      {
+         blFreeWholePDB(result->wpdb);
+         result->wpdb = NULL;
+      }
+      else
+      {
+         result->wpdb->pdb = blRemoveAlternates(result->wpdb->pdb);
+      }
+   }
+   fclose(fp);
+}
+
+
+#ifndef NOTHREADS
+/************************************************************************/
+/*>static void *BatchWorker(void *arg)
+   -----------------------------------
+*//**
+
+   \param[in]     *arg      The PDBBATCH
+   \return                  NULL
+
+   Thread which reads files from the batch until there are none left
+   or the batch is closed. A file is only started while fewer than
+   maxInFlight are being read or waiting to be collected.
+
+-  18.10.26 Original
+*/
+static void *BatchWorker(void *arg)
+{
+   PDBBATCH       *batch = (PDBBATCH *)arg;
+   PDBBATCHRESULT result;
+   int            i;
+
+   pthread_mutex_lock(&(batch->lock));
+   for(;;)
+   {
+      while(!batch->closing &&
+            (batch->nextFile < batch->nfiles) &&
+            (batch->inFlight >= batch->maxInFlight))
+         pthread_cond_wait(&(batch->canStart), &(batch->lock));
+
+      if(batch->closing || (batch->nextFile >= batch->nfiles))
+         break;
+
+      i = batch->nextFile++;
+      (batch->inFlight)++;
+      pthread_mutex_unlock(&(batch->lock));
+
+      ReadBatchFile(batch->filenames[i], &result);
+
+      pthread_mutex_lock(&(batch->lock));
+      result.done       = TRUE;
+      batch->results[i] = result;
+      batch->finished[(batch->nFinished)++] = i;
+      pthread_cond_broadcast(&(batch->haveResult));
+   }
+   pthread_mutex_unlock(&(batch->lock));
+
+   return(NULL);
+}
+#endif
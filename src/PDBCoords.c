@@ -0,0 +1,488 @@
+/************************************************************************/
+/**
+
+   \file       PDBCoords.c
+
+   \version    V1.0
+   \date       18.10.26
+   \brief      Coordinates of a PDB linked list held as arrays
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Routines such as blGetCofGPDB(), blApplyMatrixPDB() and
+   blCalcRMSPDB() step through the PDB linked list, reading a whole PDB
+   record from memory for the sake of three coordinates. Where the same
+   atoms are used many times (e.g. fitting or repeated transformations)
+   it is much faster to work on a PDBCOORDS which holds the x, y and z
+   coordinates in three arrays.
+
+   blAllocPDBCoords() makes a PDBCOORDS from a PDB linked list and
+   remembers the atom that each coordinate came from. The routines here
+   then work on the arrays with simple loops that the compiler can
+   vectorize. blPutPDBCoords() copies the coordinates back into the
+   linked list and blGetPDBCoords() refreshes them from the list if the
+   list has been changed.
+
+   The arrays are of type REAL so they are single precision if the
+   library is built with REAL as float.
+
+   As for the linked list routines, atoms with a coordinate of 9999.0 or
+   more are treated as missing and are not used or moved.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+\code
+   PDBCOORDS *coords;
+   coords = blAllocPDBCoords(pdb);
+   blGetCofGPDBCoords(coords, &CofG);
+   ...
+   blApplyMatrixPDBCoords(coords, matrix);
+   blPutPDBCoords(coords);
+   blFreePDBCoords(coords);
+\endcode
+
+   The atoms must not be freed while the PDBCOORDS is in use.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  18.10.26 Original
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP Calculations
+   #FUNCTION  blAllocPDBCoords()
+   Makes a PDBCOORDS holding the coordinates of a PDB linked list
+
+   #FUNCTION  blFreePDBCoords()
+   Frees a PDBCOORDS
+
+   #FUNCTION  blGetPDBCoords()
+   Copies the coordinates from the PDB linked list into a PDBCOORDS
+
+   #FUNCTION  blPutPDBCoords()
+   Copies the coordinates from a PDBCOORDS back into the PDB linked list
+
+   #FUNCTION  blGetCofGPDBCoords()
+   Finds the centre of geometry of a PDBCOORDS
+
+   #FUNCTION  blTranslatePDBCoords()
+   Translates the coordinates in a PDBCOORDS
+
+   #FUNCTION  blApplyMatrixPDBCoords()
+   Applies a rotation matrix to the coordinates in a PDBCOORDS
+
+   #FUNCTION  blRotatePDBCoords()
+   Rotates the coordinates in a PDBCOORDS about their centre of geometry
+
+   #FUNCTION  blCalcRMSPDBCoords()
+   Calculates the RMS deviation between two PDBCOORDS
+
+   #FUNCTION  blFindAtomsInRangePDBCoords()
+   Finds the atoms in a PDBCOORDS within a distance of a point
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdlib.h>
+#include <math.h>
+
+#include "MathType.h"
+#include "SysDefs.h"
+#include "pdb.h"
+#include "macros.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define NULLCOORD ((REAL)9999.0)
+
+/* 1 if the coordinates of atom i are present, 0 if missing. This is
+   written with & rather than && so there are no branches in the loops
+*/
+#define PRESENT(c, i) (((c)->x[i] < NULLCOORD) &                        \
+                       ((c)->y[i] < NULLCOORD) &                        \
+                       ((c)->z[i] < NULLCOORD))
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+
+
+/************************************************************************/
+/*>PDBCOORDS *blAllocPDBCoords(PDB *pdb)
+   -------------------------------------
+*//**
+
+   \param[in]     *pdb     PDB linked list
+   \return                 PDBCOORDS holding the coordinates. NULL if
+                           no memory
+
+   Allocates a PDBCOORDS and copies the coordinates of the atoms in a
+   PDB linked list into it. Free with blFreePDBCoords().
+
+-  18.10.26 Original
+*/
+PDBCOORDS *blAllocPDBCoords(PDB *pdb)
+{
+   PDBCOORDS *coords;
+   PDB       *p;
+   int       natoms = 0,
+             i;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+      natoms++;
+
+   if((coords = (PDBCOORDS *)malloc(sizeof(PDBCOORDS)))==NULL)
+      return(NULL);
+
+   /* One block for the three arrays                                    */
+   coords->natoms = natoms;
+   coords->x      = (REAL *)malloc((3 * natoms + 1) * sizeof(REAL));
+   coords->atoms  = (PDB **)malloc((natoms + 1) * sizeof(PDB *));
+   if((coords->x == NULL) || (coords->atoms == NULL))
+   {
+      blFreePDBCoords(coords);
+      return(NULL);
+   }
+   coords->y = coords->x + natoms;
+   coords->z = coords->y + natoms;
+
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+      coords->atoms[i] = p;
+
+   blGetPDBCoords(coords);
+   return(coords);
+}
+
+
+/************************************************************************/
+/*>void blFreePDBCoords(PDBCOORDS *coords)
+   ---------------------------------------
+*//**
+
+   \param[in]     *coords  PDBCOORDS to free (may be NULL)
+
+   Frees a PDBCOORDS. The PDB linked list is not changed.
+
+-  18.10.26 Original
+*/
+void blFreePDBCoords(PDBCOORDS *coords)
+{
+   if(coords != NULL)
+   {
+      FREE(coords->x);
+      FREE(coords->atoms);
+      free(coords);
+   }
+}
+
+
+/************************************************************************/
+/*>void blGetPDBCoords(PDBCOORDS *coords)
+   --------------------------------------
+*//**
+
+   \param[in,out] *coords  PDBCOORDS
+
+   Copies the coordinates from the atoms into the arrays of a
+   PDBCOORDS. Used to bring the arrays up to date after the linked
+   list has been changed.
+
+-  18.10.26 Original
+*/
+void blGetPDBCoords(PDBCOORDS *coords)
+{
+   int i;
+
+   for(i=0; i<coords->natoms; i++)
+   {
+      coords->x[i] = coords->atoms[i]->x;
+      coords->y[i] = coords->atoms[i]->y;
+      coords->z[i] = coords->atoms[i]->z;
+   }
+}
+
+
+/************************************************************************/
+/*>void blPutPDBCoords(PDBCOORDS *coords)
+   --------------------------------------
+*//**
+
+   \param[in]     *coords  PDBCOORDS
+
+   Copies the coordinates from the arrays of a PDBCOORDS back into the
+   atoms of the PDB linked list.
+
+-  18.10.26 Original
+*/
+void blPutPDBCoords(PDBCOORDS *coords)
+{
+   int i;
+
+   for(i=0; i<coords->natoms; i++)
+   {
+      coords->atoms[i]->x = coords->x[i];
+      coords->atoms[i]->y = coords->y[i];
+      coords->atoms[i]->z = coords->z[i];
+   }
+}
+
+
+/************************************************************************/
+/*>int blGetCofGPDBCoords(PDBCOORDS *coords, VEC3F *cg)
+   ----------------------------------------------------
+*//**
+
+   \param[in]     *coords  PDBCOORDS
+   \param[out]    *cg      Centre of geometry
+   \return                 Number of atoms used
+
+   Finds the centre of geometry of the coordinates, ignoring missing
+   coordinates. If there are no atoms, cg is set to the origin.
+
+-  18.10.26 Original
+*/
+int blGetCofGPDBCoords(PDBCOORDS *coords, VEC3F *cg)
+{
+   REAL sx = (REAL)0.0,
+        sy = (REAL)0.0,
+        sz = (REAL)0.0;
+   int  i,
+        n  = 0,
+        present;
+
+   for(i=0; i<coords->natoms; i++)
+   {
+      present = PRESENT(coords, i);
+      sx += present ? coords->x[i] : (REAL)0.0;
+      sy += present ? coords->y[i] : (REAL)0.0;
+      sz += present ? coords->z[i] : (REAL)0.0;
+      n  += present;
+   }
+
+   cg->x = (n) ? sx / n : (REAL)0.0;
+   cg->y = (n) ? sy / n : (REAL)0.0;
+   cg->z = (n) ? sz / n : (REAL)0.0;
+
+   return(n);
+}
+
+
+/************************************************************************/
+/*>void blTranslatePDBCoords(PDBCOORDS *coords, VEC3F tvect)
+   ---------------------------------------------------------
+*//**
+
+   \param[in,out] *coords  PDBCOORDS
+   \param[in]     tvect    Translation vector
+
+   Adds a vector to the coordinates, leaving missing coordinates
+   unchanged.
+
+-  18.10.26 Original
+*/
+void blTranslatePDBCoords(PDBCOORDS *coords, VEC3F tvect)
+{
+   REAL *x = coords->x,
+        *y = coords->y,
+        *z = coords->z;
+   int  i,
+        present;
+
+   for(i=0; i<coords->natoms; i++)
+   {
+      present = PRESENT(coords, i);
+      x[i] += present ? tvect.x : (REAL)0.0;
+      y[i] += present ? tvect.y : (REAL)0.0;
+      z[i] += present ? tvect.z : (REAL)0.0;
+   }
+}
+
+
+/************************************************************************/
+/*>void blApplyMatrixPDBCoords(PDBCOORDS *coords, REAL matrix[3][3])
+   -----------------------------------------------------------------
+*//**
+
+   \param[in,out] *coords  PDBCOORDS
+   \param[in]     matrix   Rotation matrix
+
+   Applies a rotation matrix to the coordinates, as blApplyMatrixPDB()
+   does for a linked list. Missing coordinates are unchanged.
+
+-  18.10.26 Original
+*/
+void blApplyMatrixPDBCoords(PDBCOORDS *coords, REAL matrix[3][3])
+{
+   REAL *x   = coords->x,
+        *y   = coords->y,
+        *z   = coords->z,
+        m00  = matrix[0][0], m01 = matrix[0][1], m02 = matrix[0][2],
+        m10  = matrix[1][0], m11 = matrix[1][1], m12 = matrix[1][2],
+        m20  = matrix[2][0], m21 = matrix[2][1], m22 = matrix[2][2],
+        nx, ny, nz;
+   int  i,
+        present;
+
+   for(i=0; i<coords->natoms; i++)
+   {
+      present = PRESENT(coords, i);
+      nx = x[i] * m00 + y[i] * m10 + z[i] * m20;
+      ny = x[i] * m01 + y[i] * m11 + z[i] * m21;
+      nz = x[i] * m02 + y[i] * m12 + z[i] * m22;
+      x[i] = present ? nx : x[i];
+      y[i] = present ? ny : y[i];
+      z[i] = present ? nz : z[i];
+   }
+}
+
+
+/************************************************************************/
+/*>void blRotatePDBCoords(PDBCOORDS *coords, REAL matrix[3][3])
+   ------------------------------------------------------------
+*//**
+
+   \param[in,out] *coords  PDBCOORDS
+   \param[in]     matrix   Rotation matrix
+
+   Rotates the coordinates about their centre of geometry, as
+   blRotatePDB() does for a linked list.
+
+-  18.10.26 Original
+*/
+void blRotatePDBCoords(PDBCOORDS *coords, REAL matrix[3][3])
+{
+   VEC3F CofG,
+         origin;
+
+   blGetCofGPDBCoords(coords, &CofG);
+   origin.x = -CofG.x;
+   origin.y = -CofG.y;
+   origin.z = -CofG.z;
+
+   blTranslatePDBCoords(coords, origin);
+   blApplyMatrixPDBCoords(coords, matrix);
+   blTranslatePDBCoords(coords, CofG);
+}
+
+
+/************************************************************************/
+/*>REAL blCalcRMSPDBCoords(PDBCOORDS *coords1, PDBCOORDS *coords2)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]     *coords1 First PDBCOORDS
+   \param[in]     *coords2 Second PDBCOORDS
+   \return                 RMS deviation
+
+   Calculates the RMS deviation between equivalent atoms, as
+   blCalcRMSPDB() does for two linked lists. If one has more atoms than
+   the other, the extra atoms are ignored.
+
+-  18.10.26 Original
+*/
+REAL blCalcRMSPDBCoords(PDBCOORDS *coords1, PDBCOORDS *coords2)
+{
+   REAL *x1 = coords1->x, *y1 = coords1->y, *z1 = coords1->z,
+        *x2 = coords2->x, *y2 = coords2->y, *z2 = coords2->z,
+        dx, dy, dz,
+        sumsq = (REAL)0.0;
+   int  i,
+        n = MIN(coords1->natoms, coords2->natoms);
+
+   for(i=0; i<n; i++)
+   {
+      dx     = x1[i] - x2[i];
+      dy     = y1[i] - y2[i];
+      dz     = z1[i] - z2[i];
+      sumsq += dx*dx + dy*dy + dz*dz;
+   }
+
+   return((REAL)((n) ? sqrt((double)(sumsq / (REAL)n)) : 0.0));
+}
+
+
+/************************************************************************/
+/*>int blFindAtomsInRangePDBCoords(PDBCOORDS *coords, VEC3F centre,
+                                   REAL dist, int *indices)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in]     *coords  PDBCOORDS
+   \param[in]     centre   Point
+   \param[in]     dist     Distance from the point
+   \param[out]    *indices Indices of the atoms within dist of the
+                           point. May be NULL if only the number is
+                           wanted. Must be big enough for all the atoms
+   \return                 Number of atoms within dist of the point
+
+   Finds the atoms within a given distance of a point. The atom for
+   each index is coords->atoms[indices[i]]. Missing coordinates are
+   never in range.
+
+-  18.10.26 Original
+*/
+int blFindAtomsInRangePDBCoords(PDBCOORDS *coords, VEC3F centre,
+                                REAL dist, int *indices)
+{
+   REAL *x = coords->x,
+        *y = coords->y,
+        *z = coords->z,
+        distsq = dist * dist,
+        dx, dy, dz;
+   int  i,
+        n = 0;
+
+   for(i=0; i<coords->natoms; i++)
+   {
+      dx = x[i] - centre.x;
+      dy = y[i] - centre.y;
+      dz = z[i] - centre.z;
+      if(((dx*dx + dy*dy + dz*dz) <= distsq) && PRESENT(coords, i))
+      {
+         if(indices != NULL)
+            indices[n] = i;
+         n++;
+      }
+   }
+
+   return(n);
+}
@@ -0,0 +1,624 @@
+/************************************************************************/
+/**
+
+   \file       PDBEnsemble.c
+
+   \version    V1.0
+   \date       18.10.26
+   \brief      Read all models of a multi-model PDB file in one pass and
+               index model positions for random access
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Reading each model of an NMR ensemble or trajectory with
+   blDoReadPDB() scans the whole file every time. blReadPDBEnsemble()
+   reads every model in a single pass, keeping one linked list of atoms
+   (the topology, which all models must share) and an array of
+   coordinates for each model.
+
+   blIndexPDBModels() records the file offset of each model so that a
+   single model can be read with blReadPDBModelIndexed() by seeking to
+   it rather than rescanning the file.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+\code
+   PDBENSEMBLE *ens;
+   int         model;
+
+   if((ens = blReadPDBEnsemble(fp, TRUE, 1))!=NULL)
+   {
+      for(model=1; model<=ens->nmodels; model++)
+      {
+         blSetPDBEnsembleModel(ens, model);
+         ... ens->pdb now has the coordinates of this model ...
+      }
+      blFreePDBEnsemble(ens);
+   }
+\endcode
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  18.10.26 Original
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP File IO
+   #FUNCTION  blReadPDBEnsemble()
+   Reads all models from a PDB file in one pass as a shared topology
+   with coordinates for each model.
+
+   #FUNCTION  blSetPDBEnsembleModel()
+   Copies the coordinates of a model into the topology linked list.
+
+   #FUNCTION  blFreePDBEnsemble()
+   Frees a PDBENSEMBLE structure.
+
+   #FUNCTION  blIndexPDBModels()
+   Records the file offset of each model in a PDB file.
+
+   #FUNCTION  blReadPDBModelIndexed()
+   Reads one model from a PDB file using a model index.
+
+   #FUNCTION  blFreePDBModelIndex()
+   Frees a PDBMODELINDEX structure.
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "MathType.h"
+#include "SysDefs.h"
+#include "pdb.h"
+#include "macros.h"
+#include "LineInput.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF     160      /* Line chunk size as used by ReadPDB.c    */
+#define COORDCHUNK  3072     /* Initial size of the coordinate array    */
+#define MODELCHUNK  64       /* Initial size of the model offset array  */
+
+typedef struct
+{
+   PDBENSEMBLE *ens;
+   PDB         *p;           /* Last topology atom (first model) or the
+                                next one to be matched (later models)   */
+   size_t      nalloc;       /* Number of REALs allocated for coords    */
+   int         natoms;       /* Atoms read for the current model        */
+   BOOL        error;
+}  ENSEMBLEREAD;
+
+typedef struct
+{
+   PDB  *pdb,
+        *p;
+   int  natoms;
+   BOOL error;
+}  MODELREAD;
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL EnsembleModel(int model, APTR user);
+static BOOL EnsembleAtom(PDB *p, APTR user);
+static BOOL EndEnsembleModel(ENSEMBLEREAD *state);
+static BOOL StopAtNextModel(int model, APTR user);
+static BOOL StoreModelAtom(PDB *p, APTR user);
+
+/************************************************************************/
+/*>PDBENSEMBLE *blReadPDBEnsemble(FILE *fp, BOOL AllAtoms, int OccRank)
+   --------------------------------------------------------------------
+*//**
+
+   \param[in]     *fp        A pointer to type FILE in which the
+                             .PDB file is stored.
+   \param[in]     AllAtoms   TRUE:  ATOM & HETATM records
+                             FALSE: ATOM records only
+   \param[in]     OccRank    Occupancy ranking (as for
+                             blReadPDBOccRank())
+   \return                   The ensemble. NULL if the file could not
+                             be read, memory ran out, or the models do
+                             not all contain the same atoms
+
+   Reads every model of a PDB file in a single pass. The atoms of the
+   first model are kept in ens->pdb (which therefore holds the
+   coordinates of model 1) and the coordinates of all models are stored
+   in ens->coords. The x,y,z coordinates of atom i (counting from 0) in
+   model m (counting from 1) are at ens->coords[3*((m-1)*natoms+i)].
+   A file without MODEL records gives an ensemble of one model.
+
+   Each model must contain the same atoms in the same order.
+
+-  18.10.26 Original
+*/
+PDBENSEMBLE *blReadPDBEnsemble(FILE *fp, BOOL AllAtoms, int OccRank)
+{
+   ENSEMBLEREAD state;
+   PDBSTREAM    callbacks;
+   PDBENSEMBLE  *ens;
+
+   if((ens = (PDBENSEMBLE *)malloc(sizeof(PDBENSEMBLE)))==NULL)
+      return(NULL);
+   ens->pdb     = NULL;
+   ens->coords  = NULL;
+   ens->natoms  = 0;
+   ens->nmodels = 0;
+
+   state.ens    = ens;
+   state.p      = NULL;
+   state.nalloc = 0;
+   state.natoms = 0;
+   state.error  = FALSE;
+
+   callbacks.model    = EnsembleModel;
+   callbacks.residue  = NULL;
+   callbacks.atom     = EnsembleAtom;
+   callbacks.AllAtoms = AllAtoms;
+   callbacks.OccRank  = OccRank;
+
+   if((blStreamPDB(fp, &callbacks, (APTR)&state) < 0) || state.error ||
+      !EndEnsembleModel(&state))
+   {
+      blFreePDBEnsemble(ens);
+      return(NULL);
+   }
+
+   return(ens);
+}
+
+/************************************************************************/
+/*>BOOL blSetPDBEnsembleModel(PDBENSEMBLE *ens, int model)
+   -------------------------------------------------------
+*//**
+
+   \param[in,out] *ens       The ensemble
+   \param[in]     model      Model number (from 1)
+   \return                   FALSE if the model does not exist
+
+   Copies the coordinates of a model into the atoms of ens->pdb so that
+   the normal PDB routines can be used on it.
+
+-  18.10.26 Original
+*/
+BOOL blSetPDBEnsembleModel(PDBENSEMBLE *ens, int model)
+{
+   PDB  *p;
+   REAL *c;
+
+   if((model < 1) || (model > ens->nmodels))
+      return(FALSE);
+
+   c = ens->coords + (size_t)3 * (size_t)(model-1) * (size_t)ens->natoms;
+   for(p=ens->pdb; p!=NULL; NEXT(p))
+   {
+      p->x = *(c++);
+      p->y = *(c++);
+      p->z = *(c++);
+   }
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>void blFreePDBEnsemble(PDBENSEMBLE *ens)
+   ----------------------------------------
+*//**
+
+   \param[in]     *ens       The ensemble
+
+   Frees the topology and coordinates of an ensemble.
+
+-  18.10.26 Original
+*/
+void blFreePDBEnsemble(PDBENSEMBLE *ens)
+{
+   if(ens != NULL)
+   {
+      if(ens->pdb != NULL)
+         FREELIST(ens->pdb, PDB);
+      FREE(ens->coords);
+      free(ens);
+   }
+}
+
+/************************************************************************/
+/*>PDBMODELINDEX *blIndexPDBModels(FILE *fp)
+   -----------------------------------------
+*//**
+
+   \param[in]     *fp        A pointer to type FILE in which the
+                             .PDB file is stored. Must be seekable and
+                             uncompressed.
+   \return                   The index. NULL if the file is not
+                             seekable or memory ran out
+
+   Scans a PDB file from the current position recording the offset of
+   each MODEL record. If there are no MODEL records, the file is indexed
+   as a single model starting at the current position. The file is
+   returned to the position at which it started.
+
+-  18.10.26 Original
+*/
+PDBMODELINDEX *blIndexPDBModels(FILE *fp)
+{
+   PDBMODELINDEX *index;
+   LINEINPUT     *li;
+   char          *line;
+   long          start,
+                 offset,
+                 *newOffset;
+   int           len,
+                 nalloc = MODELCHUNK;
+
+   if((start = ftell(fp)) < 0)
+      return(NULL);
+
+   if((index = (PDBMODELINDEX *)malloc(sizeof(PDBMODELINDEX)))==NULL)
+      return(NULL);
+   index->nmodels = 0;
+   if((index->offset = (long *)malloc(nalloc * sizeof(long)))==NULL)
+   {
+      free(index);
+      return(NULL);
+   }
+
+   if((li = blOpenLineInput(fp, MAXBUFF-1))==NULL)
+   {
+      blFreePDBModelIndex(index);
+      return(NULL);
+   }
+
+   for(;;)
+   {
+      if((offset = blTellLineInput(li)) < 0)
+      {
+         /* Compressed data can't be indexed                            */
+         blCloseLineInput(li);
+         blFreePDBModelIndex(index);
+         fseek(fp, start, SEEK_SET);
+         return(NULL);
+      }
+
+      if((line = blGetLineInput(li, &len))==NULL)
+         break;
+
+      if(LINEINPUTMATCH(line, len, "MODEL ", 6))
+      {
+         if(index->nmodels == nalloc)
+         {
+            nalloc *= 2;
+            if((newOffset = (long *)realloc(index->offset,
+                                            nalloc * sizeof(long)))==NULL)
+            {
+               blCloseLineInput(li);
+               blFreePDBModelIndex(index);
+               fseek(fp, start, SEEK_SET);
+               return(NULL);
+            }
+            index->offset = newOffset;
+         }
+         index->offset[(index->nmodels)++] = offset;
+      }
+   }
+   blCloseLineInput(li);
+
+   if(index->nmodels == 0)
+   {
+      index->offset[0] = start;
+      index->nmodels   = 1;
+   }
+
+   fseek(fp, start, SEEK_SET);
+   return(index);
+}
+
+/************************************************************************/
+/*>PDB *blReadPDBModelIndexed(FILE *fp, PDBMODELINDEX *index, int model,
+                              BOOL AllAtoms, int OccRank, int *natoms)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     *fp        A pointer to type FILE in which the
+                             .PDB file is stored (as indexed)
+   \param[in]     *index     Index from blIndexPDBModels()
+   \param[in]     model      Model number (from 1)
+   \param[in]     AllAtoms   TRUE:  ATOM & HETATM records
+                             FALSE: ATOM records only
+   \param[in]     OccRank    Occupancy ranking (as for
+                             blReadPDBOccRank())
+   \param[out]    *natoms    Number of atoms read. -1 if error
+   \return                   Linked list of the atoms in the model
+
+   Reads one model by seeking straight to it. Reading stops at the next
+   MODEL record so only the model itself is read. Unlike blReadPDB(),
+   blRemoveAlternates() is not applied.
+
+-  18.10.26 Original
+*/
+PDB *blReadPDBModelIndexed(FILE *fp, PDBMODELINDEX *index, int model,
+                           BOOL AllAtoms, int OccRank, int *natoms)
+{
+   MODELREAD state;
+   PDBSTREAM callbacks;
+
+   *natoms = (-1);
+   if((model < 1) || (model > index->nmodels) ||
+      (fseek(fp, index->offset[model-1], SEEK_SET) != 0))
+      return(NULL);
+
+   state.pdb    = NULL;
+   state.p      = NULL;
+   state.natoms = 0;
+   state.error  = FALSE;
+
+   callbacks.model    = StopAtNextModel;
+   callbacks.residue  = NULL;
+   callbacks.atom     = StoreModelAtom;
+   callbacks.AllAtoms = AllAtoms;
+   callbacks.OccRank  = OccRank;
+
+   if((blStreamPDB(fp, &callbacks, (APTR)&state) < 0) || state.error)
+   {
+      if(state.pdb != NULL)
+         FREELIST(state.pdb, PDB);
+      return(NULL);
+   }
+
+   *natoms = state.natoms;
+   return(state.pdb);
+}
+
+/************************************************************************/
+/*>void blFreePDBModelIndex(PDBMODELINDEX *index)
+   ----------------------------------------------
+*//**
+
+   \param[in]     *index     Index from blIndexPDBModels()
+
+   Frees a model index.
+
+-  18.10.26 Original
+*/
+void blFreePDBModelIndex(PDBMODELINDEX *index)
+{
+   if(index != NULL)
+   {
+      FREE(index->offset);
+      free(index);
+   }
+}
+
+/************************************************************************/
+/*>static BOOL EnsembleModel(int model, APTR user)
+   -----------------------------------------------
+*//**
+
+   \param[in]     model      Model number
+   \param[in,out] user       The ENSEMBLEREAD state
+   \return                   FALSE to stop reading on error
+
+   blStreamPDB() callback at the start of each model. Checks that the
+   previous model was complete and starts matching the topology again.
+
+-  18.10.26 Original
+*/
+static BOOL EnsembleModel(int model, APTR user)
+{
+   ENSEMBLEREAD *state = (ENSEMBLEREAD *)user;
+
+   if(!EndEnsembleModel(state))
+      return(FALSE);
+
+   (state->ens->nmodels)++;
+   state->natoms = 0;
+   if(state->ens->nmodels > 1)
+      state->p = state->ens->pdb;
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static BOOL EnsembleAtom(PDB *p, APTR user)
+   -------------------------------------------
+*//**
+
+   \param[in]     *p         Atom from blStreamPDB()
+   \param[in,out] user       The ENSEMBLEREAD state
+   \return                   FALSE to stop reading on error
+
+   blStreamPDB() callback for each atom. Atoms of the first model are
+   added to the topology; atoms of later models must match it. The
+   coordinates are appended to the coordinate array.
+
+-  18.10.26 Original
+*/
+static BOOL EnsembleAtom(PDB *p, APTR user)
+{
+   ENSEMBLEREAD *state = (ENSEMBLEREAD *)user;
+   PDBENSEMBLE  *ens   = state->ens;
+   REAL         *c;
+   size_t       need;
+
+   if(ens->nmodels == 1)
+   {
+      if(ens->pdb == NULL)
+      {
+         INIT(ens->pdb, PDB);
+         state->p = ens->pdb;
+      }
+      else
+      {
+         ALLOCNEXT(state->p, PDB);
+      }
+      if(state->p == NULL)
+      {
+         state->error = TRUE;
+         return(FALSE);
+      }
+      *(state->p)       = *p;
+      state->p->next    = NULL;
+      (ens->natoms)++;
+   }
+   else
+   {
+      if((state->p == NULL) ||
+         (state->p->resnum != p->resnum) ||
+         strcmp(state->p->atnam, p->atnam) ||
+         !PDBCHAINMATCH(state->p, p) ||
+         !INSERTMATCH(state->p->insert, p->insert))
+      {
+         state->error = TRUE;
+         return(FALSE);
+      }
+      NEXT(state->p);
+   }
+
+   /* Make space for the coordinates                                    */
+   need = (size_t)3 * ((size_t)(ens->nmodels-1) * (size_t)ens->natoms +
+                       (size_t)state->natoms + 1);
+   if(need > state->nalloc)
+   {
+      size_t nalloc = (state->nalloc == 0) ? COORDCHUNK : 2*state->nalloc;
+
+      if(nalloc < need)
+         nalloc = need;
+      if((c = (REAL *)realloc(ens->coords, nalloc * sizeof(REAL)))==NULL)
+      {
+         state->error = TRUE;
+         return(FALSE);
+      }
+      ens->coords   = c;
+      state->nalloc = nalloc;
+   }
+
+   c = ens->coords + need - 3;
+   c[0] = p->x;
+   c[1] = p->y;
+   c[2] = p->z;
+   (state->natoms)++;
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static BOOL EndEnsembleModel(ENSEMBLEREAD *state)
+   -------------------------------------------------
+*//**
+
+   \param[in,out] *state     The ENSEMBLEREAD state
+   \return                   Did the model just read contain all the
+                             topology atoms?
+
+   Checks that the model just read was complete.
+
+-  18.10.26 Original
+*/
+static BOOL EndEnsembleModel(ENSEMBLEREAD *state)
+{
+   if((state->ens->nmodels > 1) && (state->natoms != state->ens->natoms))
+   {
+      state->error = TRUE;
+      return(FALSE);
+   }
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static BOOL StopAtNextModel(int model, APTR user)
+   -------------------------------------------------
+*//**
+
+   \param[in]     model      Model number
+   \param[in]     user       Unused
+   \return                   FALSE after the first model
+
+   blStreamPDB() callback for blReadPDBModelIndexed(). Reading starts at
+   the required model so we stop when the next one starts.
+
+-  18.10.26 Original
+*/
+static BOOL StopAtNextModel(int model, APTR user)
+{
+   return((BOOL)(model == 1));
+}
+
+/************************************************************************/
+/*>static BOOL StoreModelAtom(PDB *p, APTR user)
+   ---------------------------------------------
+*//**
+
+   \param[in]     *p         Atom from blStreamPDB()
+   \param[in,out] user       The MODELREAD state
+   \return                   FALSE if memory ran out
+
+   blStreamPDB() callback adding a copy of each atom to a linked list.
+
+-  18.10.26 Original
+*/
+static BOOL StoreModelAtom(PDB *p, APTR user)
+{
+   MODELREAD *state = (MODELREAD *)user;
+
+   if(state->pdb == NULL)
+   {
+      INIT(state->pdb, PDB);
+      state->p = state->pdb;
+   }
+   else
+   {
+      ALLOCNEXT(state->p, PDB);
+   }
+   if(state->p == NULL)
+   {
+      state->error = TRUE;
+      return(FALSE);
+   }
+
+   *(state->p)    = *p;
+   state->p->next = NULL;
+   (state->natoms)++;
+
+   return(TRUE);
+}
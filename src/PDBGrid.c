@@ -0,0 +1,621 @@
+/************************************************************************/
+/**
+
+   \file       PDBGrid.c
+
+   \version    V1.0
+   \date       18.10.26
+   \brief      Uniform grid (cell list) of the atoms in a PDB linked
+               list for neighbour searches
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Finding the atoms near a point by checking every atom takes time
+   proportional to the size of the structure, so finding the neighbours
+   of every atom takes time proportional to its square.
+
+   A PDBGRID divides the box around a structure into cubic cells and
+   sorts the atoms by cell. It is built in a single pass over the atoms.
+   A search then only looks at the cells which overlap the region of
+   interest. blFindAtomsInRangePDBGrid() finds the atoms within a
+   distance of a point, blFindNearestAtomsPDBGrid() finds the k atoms
+   nearest a point and blForEachPairPDBGrid() calls a function for
+   every pair of atoms within a distance of each other.
+
+   Searches work for any distance, but are fastest when the cell size
+   is close to the distance used. The coordinates are copied into the
+   grid (in cell order) so the grid must be rebuilt if atoms are moved,
+   added or removed.
+
+   Atoms are identified by their position in the linked list (the
+   first atom is 0) and grid->atoms[i] is the atom at position i. As
+   for the PDBCOORDS routines, atoms with a coordinate of 9999.0 or more
+   are treated as missing and are never found.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+\code
+   PDBGRID *grid;
+   int     *found;
+   grid  = blBuildPDBGrid(pdb, (REAL)4.0);
+   found = (int *)malloc(grid->natoms * sizeof(int));
+   n     = blFindAtomsInRangePDBGrid(grid, centre, (REAL)4.0, found);
+   for(i=0; i<n; i++)
+      p = grid->atoms[found[i]];
+   ...
+   blFreePDBGrid(grid);
+\endcode
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  18.10.26 Original
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP Searching the PDB linked list
+   #FUNCTION  blBuildPDBGrid()
+   Builds a uniform grid of the atoms in a PDB linked list
+
+   #FUNCTION  blFreePDBGrid()
+   Frees a grid
+
+   #FUNCTION  blFindAtomsInRangePDBGrid()
+   Finds the atoms within a distance of a point
+
+   #FUNCTION  blFindNearestAtomsPDBGrid()
+   Finds the atoms nearest to a point
+
+   #FUNCTION  blForEachPairPDBGrid()
+   Calls a function for each pair of atoms within a distance of each
+   other
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdlib.h>
+#include <math.h>
+
+#include "MathType.h"
+#include "SysDefs.h"
+#include "pdb.h"
+#include "macros.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define NULLCOORD       ((REAL)9999.0)
+#define DEFAULTCELLSIZE ((REAL)4.0)
+#define MAXCELLSPERATOM 8     /* The cell size is increased if the grid
+                                 would have more cells than this per
+                                 atom                                   */
+
+#define PRESENT(p) (((p)->x < NULLCOORD) &&                             \
+                    ((p)->y < NULLCOORD) &&                             \
+                    ((p)->z < NULLCOORD))
+
+/* Cell index along one axis of a coordinate, limited to the grid      */
+#define CELLOF(v, lo, size, n)                                          \
+   (((v) <= (lo)) ? 0 :                                                 \
+    ((((v) - (lo)) / (size)) >= (REAL)(n)) ? (n) - 1 :                  \
+    (int)(((v) - (lo)) / (size)))
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+static void CellRange(PDBGRID *grid, VEC3F centre, REAL dist,
+                      int *lo, int *hi);
+static void InsertNearest(int k, int *nfound, int *indices,
+                          REAL *distsq, int atom, REAL dsq);
+
+
+/************************************************************************/
+/*>PDBGRID *blBuildPDBGrid(PDB *pdb, REAL cellSize)
+   ------------------------------------------------
+*//**
+
+   \param[in]     *pdb      PDB linked list
+   \param[in]     cellSize  Length of the side of a cell. Use the
+                            distance for which searches will be made.
+                            0.0 for a default
+   \return                  The grid. NULL if no memory
+
+   Builds a uniform grid of the atoms in a PDB linked list. If the
+   atoms are very spread out, the cell size is increased to keep the
+   number of cells reasonable. Free with blFreePDBGrid().
+
+-  18.10.26 Original
+*/
+PDBGRID *blBuildPDBGrid(PDB *pdb, REAL cellSize)
+{
+   PDBGRID *grid;
+   PDB     *p;
+   VEC3F   max;
+   int     *cellOf = NULL,
+           natoms  = 0,
+           ngrid   = 0,
+           ncells,
+           i, c;
+
+   if(cellSize <= (REAL)0.0)
+      cellSize = DEFAULTCELLSIZE;
+   max.x = max.y = max.z = (REAL)0.0;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      natoms++;
+      if(PRESENT(p))
+      {
+         if(ngrid == 0)
+         {
+            max.x = p->x;
+            max.y = p->y;
+            max.z = p->z;
+         }
+         ngrid++;
+      }
+   }
+
+   if((grid = (PDBGRID *)malloc(sizeof(PDBGRID)))==NULL)
+      return(NULL);
+
+   grid->natoms    = natoms;
+   grid->atoms     = (PDB **)malloc((natoms + 1) * sizeof(PDB *));
+   grid->x         = (REAL *)malloc((3 * ngrid + 1) * sizeof(REAL));
+   grid->order     = (int *)malloc((ngrid + 1) * sizeof(int));
+   grid->cellStart = NULL;
+   cellOf          = (int *)malloc((natoms + 1) * sizeof(int));
+   if((grid->atoms == NULL) || (grid->x == NULL) ||
+      (grid->order == NULL) || (cellOf == NULL))
+   {
+      FREE(cellOf);
+      blFreePDBGrid(grid);
+      return(NULL);
+   }
+   grid->y = grid->x + ngrid;
+   grid->z = grid->y + ngrid;
+
+   /* Find the box around the atoms. max is the first atom with
+      coordinates (or the origin if there are none)
+   */
+   grid->min = max;
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      grid->atoms[i] = p;
+      if(PRESENT(p))
+      {
+         grid->min.x = MIN(grid->min.x, p->x);
+         grid->min.y = MIN(grid->min.y, p->y);
+         grid->min.z = MIN(grid->min.z, p->z);
+         max.x       = MAX(max.x, p->x);
+         max.y       = MAX(max.y, p->y);
+         max.z       = MAX(max.z, p->z);
+      }
+   }
+   /* Size the grid, making the cells bigger if there would be too
+      many of them
+   */
+   for(;;)
+   {
+      grid->nx = 1 + (int)((max.x - grid->min.x) / cellSize);
+      grid->ny = 1 + (int)((max.y - grid->min.y) / cellSize);
+      grid->nz = 1 + (int)((max.z - grid->min.z) / cellSize);
+      if((double)grid->nx * (double)grid->ny * (double)grid->nz <=
+         (double)MAXCELLSPERATOM * (double)(ngrid + 1))
+         break;
+      cellSize *= (REAL)2.0;
+   }
+   grid->cellSize = cellSize;
+   ncells         = grid->nx * grid->ny * grid->nz;
+
+   if((grid->cellStart = (int *)calloc(ncells + 1, sizeof(int)))==NULL)
+   {
+      free(cellOf);
+      blFreePDBGrid(grid);
+      return(NULL);
+   }
+
+   /* Count the atoms in each cell                                      */
+   for(i=0; i<natoms; i++)
+   {
+      p = grid->atoms[i];
+      if(PRESENT(p))
+      {
+         c = CELLOF(p->x, grid->min.x, cellSize, grid->nx) +
+             grid->nx *
+             (CELLOF(p->y, grid->min.y, cellSize, grid->ny) +
+              grid->ny *
+              CELLOF(p->z, grid->min.z, cellSize, grid->nz));
+         cellOf[i] = c;
+         grid->cellStart[c+1]++;
+      }
+      else
+      {
+         cellOf[i] = (-1);
+      }
+   }
+
+   /* Turn the counts into the start of each cell, then place the atoms.
+      cellStart[c] is used as the next free entry for cell c and ends up
+      at the start of cell c+1, so it is shifted back afterwards
+   */
+   for(c=0; c<ncells; c++)
+      grid->cellStart[c+1] += grid->cellStart[c];
+   for(c=ncells; c>0; c--)
+      grid->cellStart[c] = grid->cellStart[c-1];
+   for(i=0; i<natoms; i++)
+   {
+      if((c = cellOf[i]) >= 0)
+      {
+         int slot = grid->cellStart[c+1]++;
+         p = grid->atoms[i];
+         grid->x[slot]     = p->x;
+         grid->y[slot]     = p->y;
+         grid->z[slot]     = p->z;
+         grid->order[slot] = i;
+      }
+   }
+
+   free(cellOf);
+   return(grid);
+}
+
+
+/************************************************************************/
+/*>void blFreePDBGrid(PDBGRID *grid)
+   ---------------------------------
+*//**
+
+   \param[in]     *grid    Grid (may be NULL)
+
+   Frees a grid. The atoms are not freed.
+
+-  18.10.26 Original
+*/
+void blFreePDBGrid(PDBGRID *grid)
+{
+   if(grid == NULL)
+      return;
+
+   FREE(grid->atoms);
+   FREE(grid->x);
+   FREE(grid->order);
+   FREE(grid->cellStart);
+   free(grid);
+}
+
+
+/************************************************************************/
+/*>int blFindAtomsInRangePDBGrid(PDBGRID *grid, VEC3F centre, REAL dist,
+                                 int *indices)
+   ----------------------------------------------------------------------
+*//**
+
+   \param[in]     *grid    Grid
+   \param[in]     centre   Point
+   \param[in]     dist     Distance from the point
+   \param[out]    *indices Positions in the list of the atoms within
+                           dist of the point. May be NULL if only the
+                           number is wanted. Must be big enough for all
+                           the atoms
+   \return                 Number of atoms within dist of the point
+
+   Finds the atoms within a given distance of a point, as
+   blFindAtomsInRangePDBCoords() does. The atom for each index is
+   grid->atoms[indices[i]]. The atoms are not found in list order.
+
+-  18.10.26 Original
+*/
+int blFindAtomsInRangePDBGrid(PDBGRID *grid, VEC3F centre, REAL dist,
+                              int *indices)
+{
+   REAL distsq = dist * dist,
+        dx, dy, dz;
+   int  lo[3], hi[3],
+        iy, iz, c, i,
+        n = 0;
+
+   CellRange(grid, centre, dist, lo, hi);
+
+   for(iz=lo[2]; iz<=hi[2]; iz++)
+   {
+      for(iy=lo[1]; iy<=hi[1]; iy++)
+      {
+         c = lo[0] + grid->nx * (iy + grid->ny * iz);
+         for(i=grid->cellStart[c];
+             i<grid->cellStart[c + hi[0] - lo[0] + 1];
+             i++)
+         {
+            dx = grid->x[i] - centre.x;
+            dy = grid->y[i] - centre.y;
+            dz = grid->z[i] - centre.z;
+            if((dx*dx + dy*dy + dz*dz) <= distsq)
+            {
+               if(indices != NULL)
+                  indices[n] = grid->order[i];
+               n++;
+            }
+         }
+      }
+   }
+
+   return(n);
+}
+
+
+/************************************************************************/
+/*>int blFindNearestAtomsPDBGrid(PDBGRID *grid, VEC3F centre, int k,
+                                 int *indices, REAL *distsq)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]     *grid    Grid
+   \param[in]     centre   Point
+   \param[in]     k        Number of atoms wanted
+   \param[out]    *indices Positions in the list of the nearest atoms,
+                           nearest first (k entries)
+   \param[out]    *distsq  Squared distance of each atom from the point
+                           (k entries). May be NULL
+   \return                 Number of atoms found. Less than k only if
+                           the grid has fewer than k atoms
+
+   Finds the k atoms nearest to a point. The cells are searched in
+   shells of increasing size around the point until no unsearched cell
+   can hold an atom nearer than the k'th found.
+
+-  18.10.26 Original
+*/
+int blFindNearestAtomsPDBGrid(PDBGRID *grid, VEC3F centre, int k,
+                              int *indices, REAL *distsq)
+{
+   REAL *dsq,
+        dx, dy, dz, d;
+   int  c0[3], lo[3], hi[3],
+        nfound = 0,
+        maxshell,
+        shell, ix, iy, iz, c, i;
+
+   if(k <= 0)
+      return(0);
+
+   if((dsq = distsq) == NULL)
+   {
+      if((dsq = (REAL *)malloc(k * sizeof(REAL)))==NULL)
+         return(0);
+   }
+
+   c0[0]    = CELLOF(centre.x, grid->min.x, grid->cellSize, grid->nx);
+   c0[1]    = CELLOF(centre.y, grid->min.y, grid->cellSize, grid->ny);
+   c0[2]    = CELLOF(centre.z, grid->min.z, grid->cellSize, grid->nz);
+   maxshell = MAX(grid->nx, MAX(grid->ny, grid->nz));
+
+   for(shell=0; shell<maxshell; shell++)
+   {
+      /* Any atom in this shell is at least (shell-1) cells away, so
+         stop if we already have k atoms nearer than that
+      */
+      if((nfound == k) && (shell > 0))
+      {
+         d = (shell - 1) * grid->cellSize;
+         if(d * d > dsq[k-1])
+            break;
+      }
+
+      lo[0] = MAX(c0[0] - shell, 0);
+      lo[1] = MAX(c0[1] - shell, 0);
+      lo[2] = MAX(c0[2] - shell, 0);
+      hi[0] = MIN(c0[0] + shell, grid->nx - 1);
+      hi[1] = MIN(c0[1] + shell, grid->ny - 1);
+      hi[2] = MIN(c0[2] + shell, grid->nz - 1);
+
+      for(iz=lo[2]; iz<=hi[2]; iz++)
+      {
+         for(iy=lo[1]; iy<=hi[1]; iy++)
+         {
+            for(ix=lo[0]; ix<=hi[0]; ix++)
+            {
+               /* Only the cells on the surface of the shell            */
+               if((ABS(ix - c0[0]) != shell) &&
+                  (ABS(iy - c0[1]) != shell) &&
+                  (ABS(iz - c0[2]) != shell))
+                  continue;
+
+               c = ix + grid->nx * (iy + grid->ny * iz);
+               for(i=grid->cellStart[c]; i<grid->cellStart[c+1]; i++)
+               {
+                  dx = grid->x[i] - centre.x;
+                  dy = grid->y[i] - centre.y;
+                  dz = grid->z[i] - centre.z;
+                  InsertNearest(k, &nfound, indices, dsq,
+                                grid->order[i], dx*dx + dy*dy + dz*dz);
+               }
+            }
+         }
+      }
+   }
+
+   if(distsq == NULL)
+      free(dsq);
+
+   return(nfound);
+}
+
+
+/************************************************************************/
+/*>int blForEachPairPDBGrid(PDBGRID *grid, REAL dist,
+                            BOOL (*func)(int i, int j, REAL distsq,
+                                         APTR user),
+                            APTR user)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]     *grid    Grid
+   \param[in]     dist     Distance
+   \param[in]     *func    Function to call for each pair. Returns
+                           FALSE to stop
+   \param[in]     user     Passed to func
+   \return                 Number of pairs found
+
+   Calls a function for each pair of atoms which are within a given
+   distance of each other. The function is given the positions of the
+   atoms in the list (grid->atoms[i] and grid->atoms[j]). Each pair is
+   found once, with i less than j. The pairs are not found in any
+   particular order.
+
+-  18.10.26 Original
+*/
+int blForEachPairPDBGrid(PDBGRID *grid, REAL dist,
+                         BOOL (*func)(int i, int j, REAL distsq,
+                                      APTR user),
+                         APTR user)
+{
+   REAL  maxsq = dist * dist,
+         dx, dy, dz, dsq;
+   VEC3F centre;
+   int   lo[3], hi[3],
+         iy, iz, c, i, j, a, b,
+         npairs = 0;
+
+   for(i=0; i<grid->cellStart[grid->nx * grid->ny * grid->nz]; i++)
+   {
+      centre.x = grid->x[i];
+      centre.y = grid->y[i];
+      centre.z = grid->z[i];
+      CellRange(grid, centre, dist, lo, hi);
+
+      for(iz=lo[2]; iz<=hi[2]; iz++)
+      {
+         for(iy=lo[1]; iy<=hi[1]; iy++)
+         {
+            c = lo[0] + grid->nx * (iy + grid->ny * iz);
+            for(j=MAX(grid->cellStart[c], i+1);
+                j<grid->cellStart[c + hi[0] - lo[0] + 1];
+                j++)
+            {
+               dx  = grid->x[j] - centre.x;
+               dy  = grid->y[j] - centre.y;
+               dz  = grid->z[j] - centre.z;
+               dsq = dx*dx + dy*dy + dz*dz;
+               if(dsq <= maxsq)
+               {
+                  npairs++;
+                  a = MIN(grid->order[i], grid->order[j]);
+                  b = MAX(grid->order[i], grid->order[j]);
+                  if(!(*func)(a, b, dsq, user))
+                     return(npairs);
+               }
+            }
+         }
+      }
+   }
+
+   return(npairs);
+}
+
+
+/************************************************************************/
+/*>static void CellRange(PDBGRID *grid, VEC3F centre, REAL dist,
+                         int *lo, int *hi)
+   -------------------------------------------------------------
+*//**
+
+   \param[in]     *grid    Grid
+   \param[in]     centre   Point
+   \param[in]     dist     Distance from the point
+   \param[out]    *lo      First cell on each axis (3 entries)
+   \param[out]    *hi      Last cell on each axis (3 entries)
+
+   Finds the cells which overlap the cube of side 2*dist around a
+   point. Cells in a row along x are stored one after another, so the
+   atoms from lo[0] to hi[0] in a row are contiguous.
+
+-  18.10.26 Original
+*/
+static void CellRange(PDBGRID *grid, VEC3F centre, REAL dist,
+                      int *lo, int *hi)
+{
+   REAL size = grid->cellSize;
+
+   lo[0] = CELLOF(centre.x - dist, grid->min.x, size, grid->nx);
+   lo[1] = CELLOF(centre.y - dist, grid->min.y, size, grid->ny);
+   lo[2] = CELLOF(centre.z - dist, grid->min.z, size, grid->nz);
+   hi[0] = CELLOF(centre.x + dist, grid->min.x, size, grid->nx);
+   hi[1] = CELLOF(centre.y + dist, grid->min.y, size, grid->ny);
+   hi[2] = CELLOF(centre.z + dist, grid->min.z, size, grid->nz);
+}
+
+
+/************************************************************************/
+/*>static void InsertNearest(int k, int *nfound, int *indices,
+                             REAL *distsq, int atom, REAL dsq)
+   -----------------------------------------------------------
+*//**
+
+   \param[in]     k        Number of atoms wanted
+   \param[in,out] *nfound  Number of atoms in the list
+   \param[in,out] *indices Atoms found, nearest first
+   \param[in,out] *distsq  Squared distance of each atom
+   \param[in]     atom     Atom to consider
+   \param[in]     dsq      Its squared distance
+
+   Adds an atom to the sorted list of the nearest atoms if it is nearer
+   than the k'th
+
+-  18.10.26 Original
+*/
+static void InsertNearest(int k, int *nfound, int *indices,
+                          REAL *distsq, int atom, REAL dsq)
+{
+   int i;
+
+   if((*nfound == k) && (dsq >= distsq[k-1]))
+      return;
+
+   if(*nfound < k)
+      (*nfound)++;
+
+   for(i=(*nfound)-1; (i>0) && (distsq[i-1] > dsq); i--)
+   {
+      distsq[i]  = distsq[i-1];
+      indices[i] = indices[i-1];
+   }
+   distsq[i]  = dsq;
+   indices[i] = atom;
+}
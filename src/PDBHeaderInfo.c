@@ -3,12 +3,12 @@
 
    \file       PDBHeaderInfo.c
    
-   \version    V1.8
-   \date       03.10.16
+   \version    V1.9
+   \date       18.10.26
 
    \brief      Get misc header info from PDB header
    
-   \copyright  (c) Dr. Andrew C.R. Martin / UCL, 2015-2016
+   \copyright  (c) Dr. Andrew C.R. Martin / UCL, 2015-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -66,6 +66,9 @@
 -  V1.7  02.12.15 Sequences were not being terminated properly in
                   blGetSeqresByChainWholePDB()
 -  V1.8  03.10.16 Added <stdlib.h>
+-  V1.9  18.10.26 Header records are found with
+                  blGetHeaderRecordsWholePDB() rather than by scanning
+                  the whole header
 
 *************************************************************************/
 /* Doxygen
@@ -178,13 +181,16 @@ static BIOMOLECULE *doRemark350(WHOLEPDB *wpdb, BIOMOLECULE *biomolecule);
    Obtains information from the PDB HEADER record
 
 -  26.03.15  Original   By: ACRM
+-  18.10.26  Uses blGetHeaderRecordsWholePDB()
 */
 BOOL blGetHeaderWholePDB(WHOLEPDB *wpdb, 
                          char *header,  int maxheader,
                          char *date,    int maxdate,
                          char *pdbcode, int maxcode)
 {
-   STRINGLIST *s;
+   STRINGLIST *s,
+              *first,
+              *stop;
    int        i;
    BOOL       retval = FALSE;
 
@@ -193,7 +199,8 @@ BOOL blGetHeaderWholePDB(WHOLEPDB *wpdb,
    for(i=0; i<maxdate;   i++) date[i]    = '\0';
    for(i=0; i<maxcode;   i++) pdbcode[i] = '\0';
 
-   for(s=wpdb->header; s!=NULL; NEXT(s))
+   first = blGetHeaderRecordsWholePDB(wpdb, "HEADER", &stop);
+   for(s=first; s!=stop; NEXT(s))
    {
       if(!strncmp(s->string, "HEADER", 6))
       {
@@ -224,15 +231,19 @@ BOOL blGetHeaderWholePDB(WHOLEPDB *wpdb,
 -  11.05.15 Return NULL if TITLE line absent. By: CTP
 -  09.06.15 Add columns 11 to 80 to title string for both start and 
             continuation lines. By: CTP
+-  18.10.26 Uses blGetHeaderRecordsWholePDB()
 */
 char *blGetTitleWholePDB(WHOLEPDB *wpdb)
 {
    char       *title = NULL,
               *cleanTitle = NULL;
-   STRINGLIST *s;
+   STRINGLIST *s,
+              *first,
+              *stop;
    BOOL       inTitle = FALSE;
 
-   for(s=wpdb->header; s!=NULL; NEXT(s))
+   first = blGetHeaderRecordsWholePDB(wpdb, "TITLE", &stop);
+   for(s=first; s!=stop; NEXT(s))
    {
       if(!strncmp(s->string, "TITLE ", 6))
       {
@@ -264,27 +275,30 @@ char *blGetTitleWholePDB(WHOLEPDB *wpdb)
 }
 
 /************************************************************************/
-/*>static STRINGLIST *FindNextMolIDRecord(STRINGLIST *start, char *type)
+/*>static STRINGLIST *FindNextMolIDRecord(STRINGLIST *start, 
+                                           STRINGLIST *stop, char *type)
    ---------------------------------------------------------------------
 *//**
-   \param[in]   *start    Start of stringlist containing header
+   \param[in]   *start    Header line at which to start looking
+   \param[in]   *stop     Item after the last header line to search
    \param[in]   *type     Type of header record - COMPND or SOURCE
    \return                Pointer to start of the next molecule ID in
-                          the appropriate header records
+                          the appropriate header records. stop if there
+                          are no more.
 
    Find the next MOL_ID within the specified header record type (COMPND
    or SOURCE)
 
    28.04.15  Original   By: ACRM
+   18.10.26  Searches from start (rather than the line after it) up to
+             stop, which is returned if nothing is found
 */
-static STRINGLIST *FindNextMolIDRecord(STRINGLIST *start, char *type)
+static STRINGLIST *FindNextMolIDRecord(STRINGLIST *start, 
+                                       STRINGLIST *stop, char *type)
 {
    STRINGLIST *s;
    
-   if(start==NULL)
-      return(NULL);
-   
-   for(s=start->next; s!=NULL; NEXT(s))
+   for(s=start; s!=stop; NEXT(s))
    {
       if(!strncmp(s->string, type, 6))
       {
@@ -292,7 +306,7 @@ static STRINGLIST *FindNextMolIDRecord(STRINGLIST *start, char *type)
             return(s);
       }
    }
-   return(NULL);
+   return(stop);
 }
 
 
@@ -392,13 +406,16 @@ static BOOL ExtractField(STRINGLIST *molidStart, STRINGLIST *molidStop,
 -  04.06.15 Modified to use the ExtractField() routine instead of
             duplicating code here. Fixes a bug in dealing with compounds
             where the referenced chains span more than one line
+-  18.10.26 Uses blGetHeaderRecordsWholePDB()
 */
 BOOL blGetCompoundWholePDBChain(WHOLEPDB *wpdb, char *chain, 
                                 COMPND *compnd)
 {
    STRINGLIST *molidFirst,
               *molidStart,
-              *molidStop;
+              *molidStop,
+              *first,
+              *stop;
    int        molid;
 
    compnd->molid         = 0;
@@ -421,14 +438,15 @@ BOOL blGetCompoundWholePDBChain(WHOLEPDB *wpdb, char *chain,
       return(FALSE);
 #endif
    
-   molidFirst = FindNextMolIDRecord(wpdb->header, "COMPND");
+   first      = blGetHeaderRecordsWholePDB(wpdb, "COMPND", &stop);
+   molidFirst = FindNextMolIDRecord(first, stop, "COMPND");
 
-   for(molidStart=molidFirst; molidStart!=NULL; molidStart=molidStop)
+   for(molidStart=molidFirst; molidStart!=stop; molidStart=molidStop)
    {
       char buffer[MAXPDBANNOTATION];
       int  thisMolid = 0;
 
-      molidStop  = FindNextMolIDRecord(molidStart, "COMPND");
+      molidStop  = FindNextMolIDRecord(molidStart->next, stop, "COMPND");
 
       ExtractField(molidStart, molidStop,
                    buffer,             "COMPND", "MOL_ID:");
@@ -477,22 +495,26 @@ BOOL blGetCompoundWholePDBChain(WHOLEPDB *wpdb, char *chain,
 -  04.06.15  Modified to use the ExtractField() routine instead of
              duplicating code here. Fixes a bug in dealing with compounds
              where the referenced chains span more than one line
+-  18.10.26  Uses blGetHeaderRecordsWholePDB()
 */
 int blFindMolID(WHOLEPDB *wpdb, char *chain)
 {
    STRINGLIST *molidFirst,
               *molidStart,
-              *molidStop;
+              *molidStop,
+              *first,
+              *stop;
 
-   molidFirst = FindNextMolIDRecord(wpdb->header, "COMPND");
+   first      = blGetHeaderRecordsWholePDB(wpdb, "COMPND", &stop);
+   molidFirst = FindNextMolIDRecord(first, stop, "COMPND");
 
-   for(molidStart=molidFirst; molidStart!=NULL; molidStart=molidStop)
+   for(molidStart=molidFirst; molidStart!=stop; molidStart=molidStop)
    {
       char buffer[MAXPDBANNOTATION],
            *chp,
            word[MAXWORD];
       
-      molidStop  = FindNextMolIDRecord(molidStart, "COMPND");
+      molidStop  = FindNextMolIDRecord(molidStart->next, stop, "COMPND");
       ExtractField(molidStart, molidStop, buffer, "COMPND", "CHAIN:");
       
       /* Check the chains to see if our chain is there                  */
@@ -530,6 +552,7 @@ int blFindMolID(WHOLEPDB *wpdb, char *chain)
 
 -  26.03.15  Original   By: ACRM
 -  13.05.15  Fixes...
+-  18.10.26  Uses blGetHeaderRecordsWholePDB()
 */
 BOOL blGetSpeciesWholePDBChain(WHOLEPDB *wpdb, char *chain,
                                PDBSOURCE *source)
@@ -537,7 +560,9 @@ BOOL blGetSpeciesWholePDBChain(WHOLEPDB *wpdb, char *chain,
    STRINGLIST *s,
               *molidFirst = NULL,
               *molidStart = NULL,
-              *molidStop  = NULL;
+              *molidStop  = NULL,
+              *first      = NULL,
+              *stop       = NULL;
    int        molid    = 0;
 
    source->scientificName[0] = '\0';
@@ -548,11 +573,12 @@ BOOL blGetSpeciesWholePDBChain(WHOLEPDB *wpdb, char *chain,
    if((molid = blFindMolID(wpdb, chain)) == 0)
       return(FALSE);
    
-   molidFirst = FindNextMolIDRecord(wpdb->header, "SOURCE");
+   first      = blGetHeaderRecordsWholePDB(wpdb, "SOURCE", &stop);
+   molidFirst = FindNextMolIDRecord(first, stop, "SOURCE");
 
-   for(molidStart=molidFirst; molidStart!=NULL; molidStart=molidStop)
+   for(molidStart=molidFirst; molidStart!=stop; molidStart=molidStop)
    {
-      molidStop  = FindNextMolIDRecord(molidStart, "SOURCE");
+      molidStop  = FindNextMolIDRecord(molidStart->next, stop, "SOURCE");
       for(s=molidStart; s!=molidStop; NEXT(s))
       {
          char buffer[MAXPDBANNOTATION];
@@ -596,6 +622,7 @@ BOOL blGetSpeciesWholePDBChain(WHOLEPDB *wpdb, char *chain,
    MOL_ID isn't found
 
 -  13.05.15 Original based on blGetCompoundWholePDBChain().  By: CTP
+-  18.10.26 Uses blGetHeaderRecordsWholePDB()
 */
 BOOL blGetCompoundWholePDBMolID(WHOLEPDB *wpdb, int molid, 
                                  COMPND *compnd)
@@ -603,6 +630,8 @@ BOOL blGetCompoundWholePDBMolID(WHOLEPDB *wpdb, int molid,
    STRINGLIST *molidFirst,
               *molidStart,
               *molidStop,
+              *first,
+              *stop,
               *s;
 
    /* reset compnd                                                      */
@@ -617,12 +646,13 @@ BOOL blGetCompoundWholePDBMolID(WHOLEPDB *wpdb, int molid,
    compnd->other[0]      = '\0';
 
    /* find start of compnd records                                      */
-   molidFirst = FindNextMolIDRecord(wpdb->header, "COMPND");
+   first      = blGetHeaderRecordsWholePDB(wpdb, "COMPND", &stop);
+   molidFirst = FindNextMolIDRecord(first, stop, "COMPND");
 
    /* get compound record                                               */
-   for(molidStart=molidFirst; molidStart!=NULL; molidStart=molidStop)
+   for(molidStart=molidFirst; molidStart!=stop; molidStart=molidStop)
    {
-      molidStop  = FindNextMolIDRecord(molidStart, "COMPND");
+      molidStop  = FindNextMolIDRecord(molidStart->next, stop, "COMPND");
       for(s=molidStart; s!=molidStop; NEXT(s))
       {
          char buffer[MAXPDBANNOTATION];
@@ -675,6 +705,7 @@ BOOL blGetCompoundWholePDBMolID(WHOLEPDB *wpdb, int molid,
    found.
    
 -  12.05.15 Original based on blGetSpeciesWholePDBChain().  By: CTP
+-  18.10.26 Uses blGetHeaderRecordsWholePDB()
 */
 BOOL blGetSpeciesWholePDBMolID(WHOLEPDB *wpdb, int molid,
                                PDBSOURCE *source)
@@ -682,7 +713,9 @@ BOOL blGetSpeciesWholePDBMolID(WHOLEPDB *wpdb, int molid,
    STRINGLIST *s,
               *molidFirst = NULL,
               *molidStart = NULL,
-              *molidStop  = NULL;
+              *molidStop  = NULL,
+              *first      = NULL,
+              *stop       = NULL;
 
    /* reset source                                                      */
    source->scientificName[0] = '\0';
@@ -691,13 +724,14 @@ BOOL blGetSpeciesWholePDBMolID(WHOLEPDB *wpdb, int molid,
    source->taxid             = 0;
 
    /* find start of source records                                      */
-   molidFirst = FindNextMolIDRecord(wpdb->header, "SOURCE");
+   first      = blGetHeaderRecordsWholePDB(wpdb, "SOURCE", &stop);
+   molidFirst = FindNextMolIDRecord(first, stop, "SOURCE");
 
 
    /* get source record                                                 */
-   for(molidStart=molidFirst; molidStart!=NULL; molidStart=molidStop)
+   for(molidStart=molidFirst; molidStart!=stop; molidStart=molidStop)
    {
-      molidStop  = FindNextMolIDRecord(molidStart, "SOURCE");
+      molidStop  = FindNextMolIDRecord(molidStart->next, stop, "SOURCE");
       for(s=molidStart; s!=molidStop; NEXT(s))
       {
          char buffer[MAXPDBANNOTATION];
@@ -755,6 +789,7 @@ BOOL blGetSpeciesWholePDBMolID(WHOLEPDB *wpdb, int molid,
 -  11.06.15 Moved to bioplib - doNucleic is now a paramater instead of
             a global; chains is now an array of strings
 -  12.06.15 Frees memory and returns NULL if no SEQRES found
+-  18.10.26 Uses blGetHeaderRecordsWholePDB()
 */
 char *blGetSeqresAsStringWholePDB(WHOLEPDB *wpdb, char **chains, 
                                   MODRES *modres, BOOL doNucleic)
@@ -769,7 +804,9 @@ char *blGetSeqresAsStringWholePDB(WHOLEPDB *wpdb, char **chains,
                nres      = 0,
                ArraySize = ALLOCSIZE;
    BOOL        AddStar   = FALSE;
-   STRINGLIST  *s;
+   STRINGLIST  *s,
+               *first,
+               *stop;
    
    lastchain[0] = '\0';
 
@@ -779,7 +816,8 @@ char *blGetSeqresAsStringWholePDB(WHOLEPDB *wpdb, char **chains,
    }
    sequence[0] = '\0';
    
-   for(s=wpdb->header; s!=NULL; NEXT(s))
+   first = blGetHeaderRecordsWholePDB(wpdb, "SEQRES", &stop);
+   for(s=first; s!=stop; NEXT(s))
    {
       strncpy(buffer, s->string, MAXBUFF);
       TERMINATE(buffer);
@@ -878,16 +916,20 @@ char *blGetSeqresAsStringWholePDB(WHOLEPDB *wpdb, char **chains,
 
 -  07.03.07  Original   By: ACRM
 -  11.06.15  Moved to Bioplib
+-  18.10.26  Uses blGetHeaderRecordsWholePDB()
 */
 MODRES *blGetModresWholePDB(WHOLEPDB *wpdb)
 {
-   STRINGLIST *s;
+   STRINGLIST *s,
+              *first,
+              *stop;
    char *ch;
    MODRES *modres = NULL,
           *m = NULL;
    
    
-   for(s=wpdb->header; s!=NULL; NEXT(s))
+   first = blGetHeaderRecordsWholePDB(wpdb, "MODRES", &stop);
+   for(s=first; s!=stop; NEXT(s))
    {
       if(!strncmp(s->string, "MODRES", 6))
       {
@@ -968,14 +1010,18 @@ void blFindOriginalResType(char *modAA, char *stdAA, MODRES *modres)
    initial entry of the linked list.
 
 -  26.06.15  Original   By: ACRM
+-  18.10.26  Uses blGetHeaderRecordsWholePDB()
 */
 static BIOMOLECULE *doRemark300(WHOLEPDB *wpdb)
 {
    BIOMOLECULE *biomolecule = NULL;
-   STRINGLIST  *s;
+   STRINGLIST  *s,
+               *first,
+               *stop;
    int         SkipStandardRemark = 0;
    
-   for(s=wpdb->header; s!=NULL; NEXT(s))
+   first = blGetHeaderRecordsWholePDB(wpdb, "REMARK 300", &stop);
+   for(s=first; s!=stop; NEXT(s))
    {
       if(!strncmp(s->string, "REMARK 300", 10))
       {
@@ -1060,18 +1106,22 @@ static BIOMOLECULE *doRemark300(WHOLEPDB *wpdb)
    doRemark300() not by this routine).
 
 -  26.06.15  Original   By: ACRM
+-  18.10.26  Uses blGetHeaderRecordsWholePDB()
 */
 static BIOMOLECULE *doRemark350(WHOLEPDB *wpdb, BIOMOLECULE *biomolecule)
 {
    BIOMOLECULE *bm         = NULL;  /* The current biomolecule          */
    BIOMT       *biomt      = NULL;
    BOOL        firstRecord = TRUE;
-   STRINGLIST  *s;
+   STRINGLIST  *s,
+               *first,
+               *stop;
    
    if(biomolecule != NULL)
       bm=biomolecule;
    
-   for(s=wpdb->header; s!=NULL; NEXT(s))
+   first = blGetHeaderRecordsWholePDB(wpdb, "REMARK 350", &stop);
+   for(s=first; s!=stop; NEXT(s))
    {
       if(!strncmp(s->string, "REMARK 350", 10))
       {
@@ -1296,6 +1346,7 @@ void blFreeBiomolecule(BIOMOLECULE *biomolecule)
    results in a hash indexed by chain label.
 
 -  25.11.15 Original   by: ACRM
+-  18.10.26 Uses blGetHeaderRecordsWholePDB()
 */
 HASHTABLE *blGetSeqresByChainWholePDB(WHOLEPDB *wpdb, MODRES *modres,
                                       BOOL doNucleic)
@@ -1309,7 +1360,9 @@ HASHTABLE *blGetSeqresByChainWholePDB(WHOLEPDB *wpdb, MODRES *modres,
                nres        = 0,
                ArraySize   = ALLOCSIZE;
    BOOL        gotSequence = FALSE;
-   STRINGLIST  *s;
+   STRINGLIST  *s,
+               *first,
+               *stop;
    
    HASHTABLE   *hash;
 
@@ -1323,7 +1376,8 @@ HASHTABLE *blGetSeqresByChainWholePDB(WHOLEPDB *wpdb, MODRES *modres,
    lastchain[0] = '\0';
    sequence[0]  = '\0';
    
-   for(s=wpdb->header; s!=NULL; NEXT(s))
+   first = blGetHeaderRecordsWholePDB(wpdb, "SEQRES", &stop);
+   for(s=first; s!=stop; NEXT(s))
    {
       strncpy(buffer, s->string, MAXBUFF);
       TERMINATE(buffer);
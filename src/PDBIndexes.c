@@ -0,0 +1,455 @@
+/************************************************************************/
+/**
+
+   \file       PDBIndexes.c
+
+   \version    V1.3
+   \date       18.10.26
+   \brief      Indexes attached to a PDB linked list
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   An index of a linked list holds pointers to its atoms, so it must
+   not be used once atoms have been removed from the list. Indexes are
+   therefore attached to the list they describe. Each atom in the list
+   points to a PDBINDEXES structure which holds the indexes of the
+   list, so routines which remove atoms (blKillPDB(), blDeleteAtomPDB(),
+   blDeleteAtomRangePDB(), blDeleteResiduePDB() and blMovePDB()) can
+   update them without searching, and routines which look things up
+   can find an index from the start of the list.
+
+   blAttachResidueIndex() attaches a residue index (see ResidueIndex.c)
+   which is then used by blFindResidue() and blFindZonePDB(). It is
+   updated when atoms are removed and freed when atoms are added with
+   blAppendPDB() or blMovePDB(), after which the searches step through
+   the list again. blSetResnam() detaches the indexes, and the searches
+   check the residue they find, detaching the indexes if its
+   identifier has been changed since the index was built.
+
+   blAttachPDBAtomIndex() attaches an atom index (see PDBAtomIndex.c)
+   which is then used by blGetPDBByN(), blIndexPDB() and
+   blIndexAtomNumbersPDB(), and to find the atom before the one being
+   removed. It is updated when atoms are removed or added and when
+   they are renumbered with blRenumAtomsPDB().
+
+   Atoms must have their indexes field set to NULL when they are
+   created; CLEAR_PDB() and blCopyPDB() do this. If the list is changed
+   in any other way (e.g. it is sorted, or atoms are inserted in the
+   middle of it), the indexes must be detached first with
+   blDetachPDBIndexes(). Library routines which do this themselves
+   (blFixCterPDB(), blAddNTerHs(), blHAddPDB(), blAddCBtoGly(),
+   blStripGlyCB(), blFixOrderPDB(), blShuffleResPDB(), blShuffleBB(),
+   blSelectCaPDB(), blTermPDB(), blFindNextChainPDB(), blSetResnam()
+   and the sidechain replacement routines) detach the indexes. They
+   must also be detached before the list is freed with FREELIST().
+
+**************************************************************************
+
+   Usage:
+   ======
+
+\code
+   blAttachResidueIndex(pdb);
+   blAttachPDBAtomIndex(pdb);
+   ...
+   p = blFindResidue(pdb, "A", 23, " ");
+   blDeleteResiduePDB(&pdb, p);
+   p = blFindResidue(pdb, "A", 24, " ");
+   ...
+   blDetachPDBIndexes(pdb);
+   FREELIST(pdb, PDB);
+\endcode
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  18.10.26 Original
+-  V1.1  18.10.26 Added the atom index
+-  V1.2  18.10.26 Documented the checks of residues found from the
+                  residue index
+-  V1.3  18.10.26 Listed the routines which detach the indexes
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP Searching the PDB linked list
+   #FUNCTION  blAttachResidueIndex()
+   Builds a residue index and attaches it to a PDB linked list
+
+   #FUNCTION  blGetResidueIndex()
+   Gets the residue index attached to a PDB linked list
+
+   #FUNCTION  blAttachPDBAtomIndex()
+   Builds an atom index and attaches it to a PDB linked list
+
+   #FUNCTION  blGetPDBAtomIndex()
+   Gets the atom index attached to a PDB linked list
+
+   #FUNCTION  blDetachPDBIndexes()
+   Frees the indexes attached to a PDB linked list
+
+   #FUNCTION  blRemoveFromPDBIndexes()
+   Updates the indexes of a list for an atom which is being removed
+
+   #FUNCTION  blAppendToPDBIndexes()
+   Updates the indexes of a list for atoms which have been added to the
+   end of it
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdlib.h>
+
+#include "SysDefs.h"
+#include "pdb.h"
+#include "macros.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+static PDBINDEXES *GetIndexes(PDB *pdb);
+static void FreeIndexes(PDBINDEXES *indexes);
+
+
+/************************************************************************/
+/*>BOOL blAttachResidueIndex(PDB *pdb)
+   -----------------------------------
+*//**
+
+   \param[in,out] *pdb     PDB linked list
+   \return                 Success? FALSE if no memory
+
+   Builds a residue index of a linked list and attaches it to the list,
+   replacing any residue index already attached.
+
+-  18.10.26 Original
+*/
+BOOL blAttachResidueIndex(PDB *pdb)
+{
+   PDBINDEXES   *indexes;
+   RESIDUEINDEX *residues;
+
+   if(pdb == NULL)
+      return(FALSE);
+
+   if((residues = blBuildResidueIndex(pdb))==NULL)
+      return(FALSE);
+
+   if((indexes = GetIndexes(pdb))==NULL)
+   {
+      blFreeResidueIndex(residues);
+      return(FALSE);
+   }
+
+   blFreeResidueIndex(indexes->residues);
+   indexes->residues = residues;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>RESIDUEINDEX *blGetResidueIndex(PDB *pdb)
+   -----------------------------------------
+*//**
+
+   \param[in]     *pdb     Start of a PDB linked list
+   \return                 The residue index attached to the list. NULL
+                           if there is none or pdb is not the first
+                           atom of the list
+
+   Gets the residue index attached to a linked list. The index belongs
+   to the list and must not be freed.
+
+-  18.10.26 Original
+*/
+RESIDUEINDEX *blGetResidueIndex(PDB *pdb)
+{
+   if((pdb == NULL) || (pdb->indexes == NULL) ||
+      (pdb->indexes->pdb != pdb))
+      return(NULL);
+
+   return(pdb->indexes->residues);
+}
+
+
+/************************************************************************/
+/*>BOOL blAttachPDBAtomIndex(PDB *pdb)
+   -----------------------------------
+*//**
+
+   \param[in,out] *pdb     PDB linked list
+   \return                 Success? FALSE if no memory
+
+   Builds an atom index of a linked list and attaches it to the list,
+   replacing any atom index already attached.
+
+-  18.10.26 Original
+*/
+BOOL blAttachPDBAtomIndex(PDB *pdb)
+{
+   PDBINDEXES   *indexes;
+   PDBATOMINDEX *atoms;
+
+   if(pdb == NULL)
+      return(FALSE);
+
+   if((atoms = blBuildPDBAtomIndex(pdb))==NULL)
+      return(FALSE);
+
+   if((indexes = GetIndexes(pdb))==NULL)
+   {
+      blFreePDBAtomIndex(atoms);
+      return(FALSE);
+   }
+
+   blFreePDBAtomIndex(indexes->atoms);
+   indexes->atoms = atoms;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>PDBATOMINDEX *blGetPDBAtomIndex(PDB *pdb)
+   -----------------------------------------
+*//**
+
+   \param[in]     *pdb     Start of a PDB linked list
+   \return                 The atom index attached to the list. NULL if
+                           there is none, pdb is not the first atom of
+                           the list or the index could not be updated
+
+   Gets the atom index attached to a linked list. The index belongs to
+   the list and must not be freed.
+
+-  18.10.26 Original
+*/
+PDBATOMINDEX *blGetPDBAtomIndex(PDB *pdb)
+{
+   if((pdb == NULL) || (pdb->indexes == NULL) ||
+      (pdb->indexes->pdb != pdb) || (pdb->indexes->atoms == NULL) ||
+      (pdb->indexes->atoms->pdb != pdb))
+      return(NULL);
+
+   return(pdb->indexes->atoms);
+}
+
+
+/************************************************************************/
+/*>void blDetachPDBIndexes(PDB *pdb)
+   ---------------------------------
+*//**
+
+   \param[in,out] *pdb     PDB linked list
+
+   Frees any indexes attached to a linked list
+
+-  18.10.26 Original
+*/
+void blDetachPDBIndexes(PDB *pdb)
+{
+   PDBINDEXES *indexes;
+   PDB        *p;
+
+   if((pdb == NULL) || ((indexes = pdb->indexes)==NULL))
+      return;
+
+   for(p=indexes->pdb; p!=NULL; NEXT(p))
+   {
+      if(p->indexes == indexes)
+         p->indexes = NULL;
+   }
+   pdb->indexes = NULL;
+
+   FreeIndexes(indexes);
+}
+
+
+/************************************************************************/
+/*>void blRemoveFromPDBIndexes(PDB *atom, PDB *prev)
+   -------------------------------------------------
+*//**
+
+   \param[in,out] *atom    Atom being removed from its list
+   \param[in]     *prev    The atom before it in the list (NULL if it
+                           is the first)
+
+   Updates the indexes attached to the list for an atom which is being
+   removed from it. This must be called while the atom is still linked
+   to the atom after it. An index which cannot be updated is freed.
+   When the last atom is removed, the indexes are freed.
+
+-  18.10.26 Original
+-  18.10.26 Updates the atom index
+*/
+void blRemoveFromPDBIndexes(PDB *atom, PDB *prev)
+{
+   PDBINDEXES *indexes;
+
+   if((indexes = atom->indexes)==NULL)
+      return;
+
+   if((indexes->residues != NULL) &&
+      !blRemoveFromResidueIndex(indexes->residues, atom, prev))
+   {
+      blFreeResidueIndex(indexes->residues);
+      indexes->residues = NULL;
+   }
+
+   if((indexes->atoms != NULL) &&
+      !blRemoveFromPDBAtomIndex(indexes->atoms, atom, NULL))
+   {
+      blFreePDBAtomIndex(indexes->atoms);
+      indexes->atoms = NULL;
+   }
+
+   if(indexes->pdb == atom)
+      indexes->pdb = atom->next;
+   atom->indexes = NULL;
+
+   if(indexes->pdb == NULL)
+      FreeIndexes(indexes);
+}
+
+
+/************************************************************************/
+/*>void blAppendToPDBIndexes(PDB *last, PDB *first)
+   ------------------------------------------------
+*//**
+
+   \param[in]     *last    The atom which was at the end of the list
+   \param[in,out] *first   The first of the atoms linked on after it
+
+   Updates the indexes attached to the list for atoms which have been
+   linked onto the end of it. The atoms become part of the indexed
+   list and are added to the atom index, while the residue index is
+   freed. Any indexes attached to the atoms that were added are freed.
+
+-  18.10.26 Original
+-  18.10.26 Updates the atom index
+*/
+void blAppendToPDBIndexes(PDB *last, PDB *first)
+{
+   PDBINDEXES *indexes;
+   PDB        *p;
+
+   if(first == NULL)
+      return;
+
+   if((first->indexes != NULL) && (first->indexes->pdb == first))
+      blDetachPDBIndexes(first);
+
+   if((last == NULL) || ((indexes = last->indexes)==NULL))
+      return;
+
+   for(p=first; p!=NULL; NEXT(p))
+      p->indexes = indexes;
+
+   blFreeResidueIndex(indexes->residues);
+   indexes->residues = NULL;
+
+   if((indexes->atoms != NULL) &&
+      !blAppendToPDBAtomIndex(indexes->atoms, first))
+   {
+      blFreePDBAtomIndex(indexes->atoms);
+      indexes->atoms = NULL;
+   }
+}
+
+
+/************************************************************************/
+/*>static PDBINDEXES *GetIndexes(PDB *pdb)
+   ---------------------------------------
+*//**
+
+   \param[in,out] *pdb     Start of a PDB linked list
+   \return                 The indexes attached to the list. NULL if no
+                           memory
+
+   Gets the indexes attached to a linked list, attaching an empty set
+   if there are none. If pdb is part of a longer list which has
+   indexes, but is not its start, those indexes are freed.
+
+-  18.10.26 Original
+-  18.10.26 Initialises the atom index
+*/
+static PDBINDEXES *GetIndexes(PDB *pdb)
+{
+   PDBINDEXES *indexes;
+   PDB        *p;
+
+   if((pdb->indexes != NULL) && (pdb->indexes->pdb == pdb))
+      return(pdb->indexes);
+
+   blDetachPDBIndexes(pdb);
+
+   if((indexes = (PDBINDEXES *)malloc(sizeof(PDBINDEXES)))==NULL)
+      return(NULL);
+
+   indexes->pdb      = pdb;
+   indexes->residues = NULL;
+   indexes->atoms    = NULL;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+      p->indexes = indexes;
+
+   return(indexes);
+}
+
+
+/************************************************************************/
+/*>static void FreeIndexes(PDBINDEXES *indexes)
+   --------------------------------------------
+*//**
+
+   \param[in]     *indexes   Indexes of a list
+
+   Frees a set of indexes. The atoms must no longer point to them.
+
+-  18.10.26 Original
+-  18.10.26 Frees the atom index
+*/
+static void FreeIndexes(PDBINDEXES *indexes)
+{
+   blFreeResidueIndex(indexes->residues);
+   blFreePDBAtomIndex(indexes->atoms);
+   free(indexes);
+}
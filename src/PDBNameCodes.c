@@ -0,0 +1,356 @@
+/************************************************************************/
+/**
+
+   \file       PDBNameCodes.c
+
+   \version    V1.2
+   \date       18.10.26
+   \brief      Integer codes for common record, atom, residue and
+               element names
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Each PDB record carries small integer codes for its record type,
+   atom name, residue name and element (record_code, atnam_code,
+   resnam_code and element_code). The codes are set by the PDB readers
+   and by library routines that create or rename atoms, so routines
+   that test names in their inner loops can compare integers rather
+   than strings.
+
+   The codes come from a fixed table of the names found in almost all
+   files: the two coordinate record types, the standard amino acid and
+   nucleotide residue names, their heavy atom names and the common
+   element symbols. A name that is not in the table has the code
+   PDBNAME_UNKNOWN (0). The table is built once and is never changed
+   after that, so it may be read from several threads.
+   blInitPDBNameCodes() builds it and is called automatically when
+   the first code is looked up; a program which starts its own threads
+   should call it first.
+
+   Names are stored in the table exactly as they appear in the PDB
+   structure (e.g. "CA  ", "ALA ", "HETATM"). Each name is at most 4
+   characters (6 for record types), so two atoms have the same non-zero
+   code exactly when strncmp() over 4 (or 6) characters would find
+   their names the same. The PDBNAMEMATCH() macro uses the code when it
+   is set and falls back to strncmp() otherwise.
+
+   Once set, a code is trusted without looking at the name. Code which
+   changes the record type, atom name, residue name or element of an
+   atom (e.g. with strcpy()) must call blSetPDBNameCodes() afterwards;
+   the library routines which rename or create atoms do this. Atoms
+   created with CLEAR_PDB() have no codes and are compared by name
+   until blSetPDBNameCodes() is called.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+\code
+   if(ISHETATM(p)) ...
+   if(PDBNAMEMATCH(p->atnam_code, p->atnam, PDBNAME_CA, "CA  ", 4)) ...
+
+   strcpy(p->resnam, "GLY ");
+   blSetPDBNameCodes(p);
+\endcode
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  18.10.26 Original
+-  V1.1  18.10.26 Added blCheckPDBNameCode(). blThronePDB() checks the
+                  code against the residue name
+-  V1.2  18.10.26 The codes are trusted once set. Removed
+                  blCheckPDBNameCode()
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP Miscellaneous functions
+   #FUNCTION  blInitPDBNameCodes()
+   Builds the table of name codes
+
+   #FUNCTION  blGetPDBNameCode()
+   Gets the code for a name
+
+   #FUNCTION  blGetPDBNameFromCode()
+   Gets the name for a code
+
+   #FUNCTION  blSetPDBNameCodes()
+   Sets the name codes of a PDB record from its names
+
+   #FUNCTION  blThronePDB()
+   Converts the residue name of a PDB record to a 1-letter code
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <string.h>
+
+#include "SysDefs.h"
+#include "pdb.h"
+#include "seq.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define NAMEHASHSIZE 1024            /* Power of 2, > 2 * NUMNAMES      */
+
+/************************************************************************/
+/* Globals
+*/
+/* The first entries must match the PDBNAME_ codes in pdb.h. Names are
+   at most 4 characters except the record types
+*/
+static char *sNames[] =
+{
+   "",                                              /* PDBNAME_UNKNOWN  */
+   "ATOM  ", "HETATM",
+   "N   ", "CA  ", "C   ", "O   ", "CB  ", "OXT ",
+   "NTER", "CTER", "HOH ",
+   /* Amino acid residue names                                          */
+   "ALA ", "CYS ", "ASP ", "GLU ", "PHE ", "GLY ", "HIS ", "ILE ",
+   "LYS ", "LEU ", "MET ", "ASN ", "PRO ", "GLN ", "ARG ", "SER ",
+   "THR ", "VAL ", "TRP ", "TYR ", "PCA ", "ASX ", "GLX ", "PGA ",
+   "CGN ", "PYL ", "SEC ", "MSE ", "UNK ", "WAT ",
+   /* Nucleotide residue names                                          */
+   "  A ", "  T ", "  C ", "  G ", "  U ", "  I ",
+   " DA ", " DT ", " DC ", " DG ", " DI ",
+   /* Amino acid atom names                                             */
+   "CG  ", "CG1 ", "CG2 ", "CD  ", "CD1 ", "CD2 ", "CE  ", "CE1 ",
+   "CE2 ", "CE3 ", "CZ  ", "CZ2 ", "CZ3 ", "CH2 ", "ND1 ", "ND2 ",
+   "NE  ", "NE1 ", "NE2 ", "NH1 ", "NH2 ", "NZ  ", "OD1 ", "OD2 ",
+   "OE1 ", "OE2 ", "OG  ", "OG1 ", "OH  ", "SD  ", "SG  ", "SE  ",
+   "H   ", "HA  ", "NT  ",
+   /* Nucleotide atom names                                             */
+   "P   ", "OP1 ", "OP2 ", "OP3 ", "O1P ", "O2P ", "O5' ", "C5' ",
+   "C4' ", "O4' ", "C3' ", "O3' ", "C2' ", "O2' ", "C1' ", "N1  ",
+   "N2  ", "N3  ", "N4  ", "N6  ", "N7  ", "N9  ", "C2  ", "C4  ",
+   "C5  ", "C6  ", "C7  ", "C8  ", "O2  ", "O4  ", "O6  ",
+   /* Element symbols                                                   */
+   "H", "D", "HE", "LI", "BE", "B", "C", "N", "O", "F", "NE", "NA",
+   "MG", "AL", "SI", "P", "S", "CL", "AR", "K", "CA", "SC", "TI", "V",
+   "CR", "MN", "FE", "CO", "NI", "CU", "ZN", "GA", "GE", "AS", "SE",
+   "BR", "KR", "RB", "SR", "Y", "ZR", "MO", "RU", "RH", "PD", "AG",
+   "CD", "IN", "SN", "SB", "TE", "I", "XE", "CS", "BA", "LA", "SM",
+   "EU", "GD", "TB", "YB", "LU", "W", "RE", "OS", "IR", "PT", "AU",
+   "HG", "TL", "PB", "BI", "U"
+};
+#define NUMNAMES (int)(sizeof(sNames) / sizeof(char *))
+
+static short sHash[NAMEHASHSIZE];    /* Codes. 0 for an empty slot      */
+static char  sOneLetter[NUMNAMES],   /* blThrone() of each name, or 0   */
+             sOneLetterX[NUMNAMES];  /* blThronex() of each name, or 0  */
+static BOOL  sInitialised = FALSE;
+
+/************************************************************************/
+/* Prototypes
+*/
+static unsigned long HashName(char *name);
+
+
+/************************************************************************/
+/*>void blInitPDBNameCodes(void)
+   -----------------------------
+*//**
+
+   Builds the table of name codes. This is done automatically when the
+   first code is looked up but must be called before starting threads
+   which read PDB files.
+
+-  18.10.26 Original
+*/
+void blInitPDBNameCodes(void)
+{
+   unsigned long slot;
+   int           code;
+   BOOL          nucleic;
+
+   if(sInitialised)
+      return;
+
+   /* blThrone() sets this global, so keep its value                    */
+   nucleic = gBioplibSeqNucleicAcid;
+
+   for(code=1; code<NUMNAMES; code++)
+   {
+      slot = HashName(sNames[code]);
+      while(sHash[slot] != 0)
+         slot = (slot + 1) & (NAMEHASHSIZE - 1);
+      sHash[slot] = (short)code;
+
+      /* blThrone() looks at 3 characters, so shorter names are left
+         for blThronePDB() to pass to it
+      */
+      if(strlen(sNames[code]) >= 3)
+      {
+         sOneLetter[code]  = blThrone(sNames[code]);
+         sOneLetterX[code] = blThronex(sNames[code]);
+      }
+   }
+
+   gBioplibSeqNucleicAcid = nucleic;
+   sInitialised = TRUE;
+}
+
+
+/************************************************************************/
+/*>int blGetPDBNameCode(char *name)
+   --------------------------------
+*//**
+
+   \param[in]     *name    A record type, atom, residue or element name
+   \return                 Its code. PDBNAME_UNKNOWN if not in the table
+
+   Gets the code for a name. The name must match the table exactly,
+   including any padding.
+
+-  18.10.26 Original
+*/
+int blGetPDBNameCode(char *name)
+{
+   unsigned long slot;
+   int           code;
+
+   if(!sInitialised)
+      blInitPDBNameCodes();
+
+   for(slot = HashName(name);
+       (code = sHash[slot]) != 0;
+       slot = (slot + 1) & (NAMEHASHSIZE - 1))
+   {
+      if(!strcmp(sNames[code], name))
+         return(code);
+   }
+
+   return(PDBNAME_UNKNOWN);
+}
+
+
+/************************************************************************/
+/*>char *blGetPDBNameFromCode(int code)
+   ------------------------------------
+*//**
+
+   \param[in]     code     A name code
+   \return                 The name. An empty string for
+                           PDBNAME_UNKNOWN or an invalid code
+
+   Gets the name for a code
+
+-  18.10.26 Original
+*/
+char *blGetPDBNameFromCode(int code)
+{
+   if((code < 0) || (code >= NUMNAMES))
+      code = PDBNAME_UNKNOWN;
+   return(sNames[code]);
+}
+
+
+/************************************************************************/
+/*>void blSetPDBNameCodes(PDB *p)
+   ------------------------------
+*//**
+
+   \param[in,out] *p       PDB record
+
+   Sets the record type, atom name, residue name and element codes of a
+   PDB record from its names
+
+-  18.10.26 Original
+*/
+void blSetPDBNameCodes(PDB *p)
+{
+   p->record_code  = (short)blGetPDBNameCode(p->record_type);
+   p->atnam_code   = (short)blGetPDBNameCode(p->atnam);
+   p->resnam_code  = (short)blGetPDBNameCode(p->resnam);
+   p->element_code = (short)blGetPDBNameCode(p->element);
+}
+
+
+/************************************************************************/
+/*>char blThronePDB(PDB *p, BOOL DoAsxGlx)
+   ---------------------------------------
+*//**
+
+   \param[in]     *p        PDB record
+   \param[in]     DoAsxGlx  Use blThronex() rather than blThrone()
+   \return                  One letter code
+
+   As blThrone(p->resnam) (or blThronex(p->resnam)), but uses the
+   residue name code if it is set rather than searching the table of
+   residue names. gBioplibSeqNucleicAcid is set in the same way.
+
+-  18.10.26 Original
+-  18.10.26 Checks the code against the residue name
+-  18.10.26 Trusts the code again
+*/
+char blThronePDB(PDB *p, BOOL DoAsxGlx)
+{
+   int code = p->resnam_code;
+
+   if((code <= PDBNAME_UNKNOWN) || (code >= NUMNAMES) ||
+      !sInitialised || (sOneLetter[code] == '\0'))
+      return(DoAsxGlx ? blThronex(p->resnam) : blThrone(p->resnam));
+
+   gBioplibSeqNucleicAcid = ((p->resnam[0] == ' ') &&
+                             (p->resnam[1] == ' '));
+
+   return(DoAsxGlx ? sOneLetterX[code] : sOneLetter[code]);
+}
+
+
+/************************************************************************/
+/*>static unsigned long HashName(char *name)
+   -----------------------------------------
+*//**
+
+   \param[in]     *name    A name
+   \return                 Slot in sHash[]
+
+   FNV-1a hash of a name
+
+-  18.10.26 Original
+*/
+static unsigned long HashName(char *name)
+{
+   unsigned long h = 2166136261UL;
+
+   for(; *name; name++)
+   {
+      h ^= (unsigned char)*name;
+      h *= 16777619UL;
+   }
+
+   return(h & (NAMEHASHSIZE - 1));
+}
@@ -0,0 +1,336 @@
+/************************************************************************/
+/**
+
+   \file       PDBSelection.c
+
+   \version    V1.0
+   \date       18.10.26
+   \brief      Selections of atoms from a PDB linked list which do not
+               copy the atoms
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   The ...AsCopy() routines (blSelectAtomsPDBAsCopy(),
+   blGetPDBChainAsCopy(), etc.) make a new linked list holding copies
+   of the atoms they select. Where the subset is only to be read (e.g.
+   to find the centre of geometry of the CA atoms before fitting) the
+   copying is wasted.
+
+   A PDBSELECTION is an array of pointers to the selected atoms in the
+   original linked list. The matching ...AsView() routines build one
+   and the routines here find the centre of geometry, coordinates and
+   RMS deviation of the atoms in a selection. blWritePDBSelection()
+   writes them out.
+
+   Changes made through a selection (e.g. to coordinates) are changes
+   to the atoms of the original list. The atoms must not be freed while
+   the selection is in use.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+\code
+   PDBSELECTION *sel;
+   sel = blSelectAtomsPDBAsView(pdb, 1, names);
+   blGetCofGPDBSelection(sel, &CofG);
+   ...
+   blFreePDBSelection(sel);
+\endcode
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  18.10.26 Original
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP Manipulating the PDB linked list
+   #FUNCTION  blAllocPDBSelection()
+   Allocates an empty selection of atoms from a PDB linked list
+
+   #FUNCTION  blAddAtomToPDBSelection()
+   Adds an atom to a selection
+
+   #FUNCTION  blFreePDBSelection()
+   Frees a selection
+
+   #FUNCTION  blGetCofGPDBSelection()
+   Finds the centre of geometry of the atoms in a selection
+
+   #FUNCTION  blGetPDBSelectionCoor()
+   Gets an array of the coordinates of the atoms in a selection
+
+   #FUNCTION  blCalcRMSPDBSelection()
+   Calculates the RMS deviation between the atoms of two selections
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdlib.h>
+#include <math.h>
+
+#include "MathType.h"
+#include "SysDefs.h"
+#include "pdb.h"
+#include "macros.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define SELECTIONSTEP 64      /* Initial size of a selection            */
+
+/* As blGetCofGPDB(), atoms are used unless all coordinates are 9999.0  */
+#define PRESENT(p) (((p)->x < (REAL)9999.0) ||                          \
+                    ((p)->y < (REAL)9999.0) ||                          \
+                    ((p)->z < (REAL)9999.0))
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+
+
+/************************************************************************/
+/*>PDBSELECTION *blAllocPDBSelection(PDB *pdb)
+   -------------------------------------------
+*//**
+
+   \param[in]     *pdb     PDB linked list from which atoms will be
+                           selected
+   \return                 Empty selection. NULL if no memory
+
+   Allocates an empty selection. Atoms are added with
+   blAddAtomToPDBSelection(). Free with blFreePDBSelection().
+
+-  18.10.26 Original
+*/
+PDBSELECTION *blAllocPDBSelection(PDB *pdb)
+{
+   PDBSELECTION *sel;
+
+   if((sel = (PDBSELECTION *)malloc(sizeof(PDBSELECTION)))==NULL)
+      return(NULL);
+
+   sel->pdb      = pdb;
+   sel->atoms    = NULL;
+   sel->natoms   = 0;
+   sel->maxatoms = 0;
+
+   return(sel);
+}
+
+
+/************************************************************************/
+/*>BOOL blAddAtomToPDBSelection(PDBSELECTION *sel, PDB *atom)
+   ----------------------------------------------------------
+*//**
+
+   \param[in,out] *sel     Selection
+   \param[in]     *atom    Atom to add
+   \return                 Success. The selection is unchanged if
+                           there is no memory
+
+   Adds an atom to the end of a selection
+
+-  18.10.26 Original
+*/
+BOOL blAddAtomToPDBSelection(PDBSELECTION *sel, PDB *atom)
+{
+   if(sel->natoms == sel->maxatoms)
+   {
+      PDB **atoms;
+      int maxatoms = (sel->maxatoms) ? 2 * sel->maxatoms : SELECTIONSTEP;
+
+      if((atoms = (PDB **)realloc(sel->atoms, maxatoms * sizeof(PDB *)))
+         == NULL)
+         return(FALSE);
+
+      sel->atoms    = atoms;
+      sel->maxatoms = maxatoms;
+   }
+
+   sel->atoms[sel->natoms++] = atom;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void blFreePDBSelection(PDBSELECTION *sel)
+   ------------------------------------------
+*//**
+
+   \param[in]     *sel     Selection (may be NULL)
+
+   Frees a selection. The atoms themselves are not freed.
+
+-  18.10.26 Original
+*/
+void blFreePDBSelection(PDBSELECTION *sel)
+{
+   if(sel == NULL)
+      return;
+
+   FREE(sel->atoms);
+   free(sel);
+}
+
+
+/************************************************************************/
+/*>int blGetCofGPDBSelection(PDBSELECTION *sel, VEC3F *cg)
+   -------------------------------------------------------
+*//**
+
+   \param[in]     *sel     Selection
+   \param[out]    *cg      Centre of geometry
+   \return                 Number of atoms used
+
+   Finds the centre of geometry of the atoms in a selection in the same
+   way as blGetCofGPDB(). If there are no atoms, cg is set to the
+   origin.
+
+-  18.10.26 Original
+*/
+int blGetCofGPDBSelection(PDBSELECTION *sel, VEC3F *cg)
+{
+   PDB *p;
+   int i,
+       natom = 0;
+
+   cg->x = 0.0;
+   cg->y = 0.0;
+   cg->z = 0.0;
+
+   for(i=0; i<sel->natoms; i++)
+   {
+      p = sel->atoms[i];
+      if(PRESENT(p))
+      {
+         cg->x += p->x;
+         cg->y += p->y;
+         cg->z += p->z;
+         natom++;
+      }
+   }
+
+   if(natom)
+   {
+      cg->x /= natom;
+      cg->y /= natom;
+      cg->z /= natom;
+   }
+
+   return(natom);
+}
+
+
+/************************************************************************/
+/*>int blGetPDBSelectionCoor(PDBSELECTION *sel, VEC3F *origin,
+                             COOR **coor)
+   -----------------------------------------------------------
+*//**
+
+   \param[in]     *sel     Selection
+   \param[in]     *origin  Point to subtract from the coordinates. NULL
+                           to copy them unchanged
+   \param[out]    **coor   Allocated array of coordinates
+   \return                 Number of coordinates. 0 if no memory or no
+                           atoms
+
+   As blGetPDBCoor(), gets an array of the coordinates of the atoms in
+   a selection which may be passed to blMatfit(). If an origin is given
+   it is subtracted from each atom that is not missing, giving the
+   coordinates that blOriginPDB() would leave in a copy of the atoms.
+
+-  18.10.26 Original
+*/
+int blGetPDBSelectionCoor(PDBSELECTION *sel, VEC3F *origin, COOR **coor)
+{
+   PDB *p;
+   int i;
+
+   if(sel->natoms == 0)
+      return(0);
+
+   if((*coor = (COOR *)malloc(sel->natoms * sizeof(COOR)))==NULL)
+      return(0);
+
+   for(i=0; i<sel->natoms; i++)
+   {
+      p = sel->atoms[i];
+      (*coor)[i].x = p->x;
+      (*coor)[i].y = p->y;
+      (*coor)[i].z = p->z;
+
+      if((origin != NULL) && PRESENT(p))
+      {
+         (*coor)[i].x -= origin->x;
+         (*coor)[i].y -= origin->y;
+         (*coor)[i].z -= origin->z;
+      }
+   }
+
+   return(sel->natoms);
+}
+
+
+/************************************************************************/
+/*>REAL blCalcRMSPDBSelection(PDBSELECTION *sel1, PDBSELECTION *sel2)
+   ------------------------------------------------------------------
+*//**
+
+   \param[in]     *sel1    First selection
+   \param[in]     *sel2    Second selection
+   \return                 RMS deviation
+
+   Calculates the RMS deviation between equivalent atoms of two
+   selections, as blCalcRMSPDB() does for two linked lists. If one has
+   more atoms than the other, the extra atoms are ignored.
+
+-  18.10.26 Original
+*/
+REAL blCalcRMSPDBSelection(PDBSELECTION *sel1, PDBSELECTION *sel2)
+{
+   REAL dist = (REAL)0.0;
+   int  i,
+        n    = MIN(sel1->natoms, sel2->natoms);
+
+   for(i=0; i<n; i++)
+      dist += DISTSQ(sel1->atoms[i], sel2->atoms[i]);
+
+   return((REAL)((n) ? sqrt((double)(dist / (REAL)n)) : 0.0));
+}
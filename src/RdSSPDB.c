@@ -3,12 +3,12 @@
 
    \file       RdSSPDB.c
    
-   \version    V1.2
-   \date       26.02.15
+   \version    V1.3
+   \date       18.10.26
    \brief      Read disulphide information from header records of a PDB
                file
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -52,6 +52,8 @@
    V1.0   14.10.93 Original   By: ACRM
    V1.1   07.07.14 Use bl prefix for functions By: CTP
    V1.2   26.02.15 Added blReadDisulphidesWholePDB()
+   V1.3   18.10.26 blReadDisulphidesWholePDB() only visits the SSBOND
+                   records
 
 *************************************************************************/
 /* Doxygen
@@ -170,16 +172,20 @@ DISULPHIDE *blReadDisulphidesPDB(FILE *fp, BOOL *error)
    the error flag is set to TRUE
 
 -  26.02.15 Original based on blReadDisulphidesPDB()   By: ACRM
+-  18.10.26 Uses blGetHeaderRecordsWholePDB()
 */
 DISULPHIDE *blReadDisulphidesWholePDB(WHOLEPDB *wpdb, BOOL *error)
 {
    DISULPHIDE *dis = NULL,
               *p   = NULL;
-   STRINGLIST *s   = NULL;
+   STRINGLIST *s     = NULL,
+              *first = NULL,
+              *stop  = NULL;
 
    *error = FALSE;
 
-   for(s=wpdb->header; s!=NULL; NEXT(s))
+   first = blGetHeaderRecordsWholePDB(wpdb, "SSBOND", &stop);
+   for(s=first; s!=stop; NEXT(s))
    {
       /* Exit as soon as we reach an ATOM record                        */
       if(!strncmp(s->string,"SSBOND",6))
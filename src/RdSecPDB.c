@@ -3,12 +3,12 @@
 
    \file       RdSecPDB.c
    
-   \version    V1.5
-   \date       26.02.15
+   \version    V1.6
+   \date       18.10.26
    \brief      Read secondary structure information from the HELIX, TURN
                and SHEET records in a PDB file
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1990-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1990-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -73,6 +73,8 @@
 -  V1.3  18.08.98 Changed SEC to SECSTRUC 'cos of conflict in SunOS
 -  V1.4  07.07.14 Use bl prefix for functions By: CTP
 -  V1.5  26.02.15 Added blReadSecWholePDB()   By: ACRM
+-  V1.6  18.10.26 blReadSecWholePDB() only visits the HELIX, SHEET and
+                  TURN records
 
 *************************************************************************/
 /* Doxygen
@@ -252,6 +254,7 @@ SECSTRUC *blReadSecPDB(FILE *fp, int *nsec)
    in pdb.h
 
 -  26.02.15 Original based on blReadSecPDB()
+-  18.10.26 Uses blGetHeaderSpanWholePDB()
 */
 SECSTRUC *blReadSecWholePDB(WHOLEPDB *wpdb, int *nsec)
 {
@@ -266,11 +269,15 @@ SECSTRUC *blReadSecWholePDB(WHOLEPDB *wpdb, int *nsec)
    static char classtab[16] = "HHGGGHGGGH"; /* Class 0 shouldn't occur  */
    SECSTRUC    *p,
                *sec = NULL;
-   STRINGLIST  *s;
+   STRINGLIST  *s,
+               *first,
+               *stop;
+   static char *types[] = {"HELIX", "SHEET", "TURN", NULL};
    
    *nsec =  0;
 
-   for(s=wpdb->header; s!=NULL; NEXT(s))
+   first = blGetHeaderSpanWholePDB(wpdb, types, &stop);
+   for(s=first; s!=stop; NEXT(s))
    {
       /* Use this as a flag for having found some secondary structure   */
       type    = '\0';
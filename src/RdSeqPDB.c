@@ -3,11 +3,11 @@
 
    \file       RdSeqPDB.c
    
-   \version    V1.3
-   \date       26.02.15
+   \version    V1.4
+   \date       18.10.26
    \brief      Read sequence from SEQRES records in a PDB file
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1996-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1996-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -50,6 +50,8 @@
 -  V1.1  25.03.14 Added CHAINMATCH. By: CTP
 -  V1.2  07.07.14 Use bl prefix for functions By: CTP
 -  V1.3  26.02.15 Added blReadSeqresWholePDB()  By: ACRM
+-  V1.4  18.10.26 RdSeqResHeader() only visits the SEQRES records and
+                  appends them in constant time
 
 *************************************************************************/
 /* Doxygen
@@ -365,21 +367,23 @@ static STRINGLIST *RdSeqRes(FILE *fp)
    Used by ReadSeqresPDB() to read the SEQRES records into a linked list.
 
 -  26.02.15 Original based on RdSeqRes()   By: ACRM
+-  18.10.26 Uses blGetHeaderRecordsWholePDB() and blAppendString()
 */
 static STRINGLIST *RdSeqResHeader(WHOLEPDB *wpdb)
 {
    STRINGLIST *seqres = NULL,
+              *tail   = NULL,
+              *first,
+              *stop,
               *s;
    
-   for(s=wpdb->header; s!=NULL; NEXT(s))
+   first = blGetHeaderRecordsWholePDB(wpdb, "SEQRES", &stop);
+   for(s=first; s!=stop; NEXT(s))
    {
       if(!strncmp(s->string,"SEQRES",6))
       {
-         if((seqres = blStoreString(seqres, s->string)) == NULL)
-         {
-            FREELIST(seqres, STRINGLIST);
+         if((tail = blAppendString(&seqres, tail, s->string)) == NULL)
             return(NULL);
-         }
       }
    }
    
@@ -3,11 +3,11 @@
 
    \file       ReadCSSR.c
    
-   \version    V1.7
-   \date       15.08.14
+   \version    V1.8
+   \date       18.10.26
    \brief      Read a CSSR file
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1991-2014
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1991-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -144,6 +144,7 @@
 -  V1.5  30.05.02 Changed PDB field from 'junk' to 'record_type'
 -  V1.6  07.07.14 Use bl prefix for functions By: CTP
 -  V1.7  15.08.14 Updated blReadCSSRasPDB() to use CLEAR_PDB() By: CTP
+-  V1.8  18.10.26 blReadCSSRasPDB() sets name codes  By: ACRM
 
 *************************************************************************/
 /* Doxygen
@@ -364,6 +365,7 @@ CSSR *blReadCSSR(FILE  *fp,
 -  27.07.93 Changed I/O to double precision
 -  07.07.14 Use bl prefix for functions By: CTP
 -  15.08.14 Use CLEAR_PDB() By: CTP
+-  18.10.26 Sets name codes  By: ACRM
 */
 PDB *blReadCSSRasPDB(FILE  *fp,
                    int   *natom)
@@ -478,6 +480,7 @@ PDB *blReadCSSRasPDB(FILE  *fp,
       p->occ = 1.0;
       p->resnum = 1;
       p->next = NULL;
+      blSetPDBNameCodes(p);                            /* 18.10.26      */
       
       if(!nocharges)
          sscanf(buffer+73,"%lf",&p->bval);
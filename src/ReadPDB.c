@@ -3,11 +3,11 @@
 
    \file       ReadPDB.c
    
-   \version    V3.11
-   \date       01.07.15
+   \version    V3.22
+   \date       18.10.26
    \brief      Read coordinates from a PDB file 
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1988-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1988-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -68,6 +68,13 @@
    gPDBMultiNMR      - the PDB file contained multiple models
    gPDBXML           - the file was in PDBML (XML) format
    gPDBModelNotFound - the requested model was not found
+   blDoReadPDBState() returns the same flags in a PDBREADSTATE instead
+   and may be used by several threads at once.
+
+   blReadPDBOptions() and blDoReadPDBOptions() read only the atoms
+   passing a set of filters (chains, residue zone, atom names and record
+   types) and decode only the fields that are needed. Lines for other 
+   atoms are rejected from a few columns without being decoded.
    
 
 NOTE:  Although some of the fields are represented by a single character,
@@ -237,6 +244,35 @@ BUGS:  25.01.05 Note the multiple occupancy code won't work properly for
                   ParseTitlePDBML(), ParseCompndPDBML(), 
                   ParseSourcePDBML(), ParseResolPDBML(), 
                   ParseSeqresPDBML() and ParseModresPDBML().  By: CTP
+-  V3.12 18.10.26 blDoReadPDB() reads through blOpenLineInput() so
+                  regular files are memory mapped, and ATOM/HETATM
+                  records are decoded in place by ParseAtomRecord()
+                  rather than fsscanf()
+-  V3.13 18.10.26 With ZLIB_SUPPORT, gzip and compress'd files are 
+                  decompressed in process rather than with gunzip and
+                  a temporary file in /tmp. blDoReadPDBML() also reads
+                  compressed files
+-  V3.14 18.10.26 Added blStreamPDB()
+-  V3.15 18.10.26 PDBML is read with an xmlTextReader rather than by
+                  building the whole document. Only the header
+                  categories are kept as a tree
+-  V3.16 18.10.26 Added blDoReadMMCIF() and blReadWholeMMCIF() to read
+                  the atom_site loop of mmCIF files. blDoReadPDB()
+                  recognises mmCIF files and reads them in the same way
+-  V3.17 18.10.26 Added blDoReadPDBState(). The readers set flags in a
+                  PDBREADSTATE and only the public wrappers copy them
+                  to the globals so files can be read in parallel
+-  V3.18 18.10.26 The header and trailer are built with blAppendString()
+                  and the readers index the header record types with
+                  blIndexWholePDBHeader()
+-  V3.19 18.10.26 Added blReadPDBOptions() and blDoReadPDBOptions() which
+                  skip unwanted atoms before decoding them and decode
+                  only the fields requested
+-  V3.20 18.10.26 blDoReadPDBOptions() can allocate the atoms, header
+                  and trailer from an arena owned by the WHOLEPDB.
+                  Added blRemoveAlternatesArena()
+-  V3.21 18.10.26 Atoms are given their name codes as they are stored
+-  V3.22 18.10.26 blFreeWholePDB() frees any indexes attached to the atoms
 
 *************************************************************************/
 /* Doxygen
@@ -269,6 +305,25 @@ BUGS:  25.01.05 Note the multiple occupancy code won't work properly for
    A lower level routine giving full control over reading all or only
    ATOM records, occupancy rankings and model numbers.
 
+   #FUNCTION blDoReadPDBState()
+   As blDoReadPDB() but returns the flags normally set in globals so it
+   may be called from several threads at once.
+
+   #FUNCTION blInitPDBReadOptions()
+   Sets the options for blReadPDBOptions() to read as blReadPDB().
+
+   #FUNCTION blReadPDBOptions()
+   Reads only selected atoms and fields from a PDB file into a linked
+   list.
+
+   #FUNCTION blDoReadPDBOptions()
+   A lower level routine giving full control over which atoms and 
+   fields are read. May be called from several threads at once.
+
+   #FUNCTION blStreamPDB()
+   Reads a PDB file atom by atom, passing each atom to a callback rather
+   than building a linked list.
+
    #FUNCTION blDoReadPDBML() 
    A lower level routine giving full control over reading all or only
    ATOM records, occupancy rankings and model numbers from a PDBML XML
@@ -277,6 +332,11 @@ BUGS:  25.01.05 Note the multiple occupancy code won't work properly for
    #FUNCTION blCheckFileFormatPDBML() 
    A simple test to detect whether a file is a PDBML-formatted PDB file.
 
+   #FUNCTION blDoReadMMCIF()
+   A lower level routine giving full control over reading all or only
+   ATOM records, occupancy rankings and model numbers from an mmCIF
+   file.
+
    #KEYFUNCTION  blReadWholePDB()
    Reads a PDB file, storing the header and trailer information as
    well as the coordinate data. Can read gzipped files as well as
@@ -290,6 +350,10 @@ BUGS:  25.01.05 Note the multiple occupancy code won't work properly for
    well as the coordinate data. Only reads the ATOM record for 
    coordinates
 
+   #FUNCTION  blReadWholeMMCIF()
+   Reads an mmCIF file into a WHOLEPDB structure, making basic header
+   records.
+
    #SUBGROUP Atom names and elements
    #FUNCTION blFixAtomName()
    Fixes an atom name by removing leading spaces, or moving a leading
@@ -299,6 +363,9 @@ BUGS:  25.01.05 Note the multiple occupancy code won't work properly for
    #FUNCTION blRemoveAlternates()
    Removes alternate occupancy atoms. This may be useful after
    blReadPDBAll()
+
+   #FUNCTION blRemoveAlternatesArena()
+   As blRemoveAlternates() for a list allocated from an arena
 */
 
 /************************************************************************/
@@ -321,6 +388,7 @@ BUGS:  25.01.05 Note the multiple occupancy code won't work properly for
 #ifdef XML_SUPPORT /* Required to read PDBML files                      */
 #include <libxml/parser.h>
 #include <libxml/tree.h>
+#include <libxml/xmlreader.h>
 #endif
 
 #include "SysDefs.h"
@@ -329,6 +397,7 @@ BUGS:  25.01.05 Note the multiple occupancy code won't work properly for
 #include "macros.h"
 #include "fsscanf.h"
 #include "general.h"
+#include "LineInput.h"
 
 #define MAXPARTIAL 8
 #define SMALL      0.000001
@@ -336,10 +405,57 @@ BUGS:  25.01.05 Note the multiple occupancy code won't work properly for
 #define XML_SAMPLE 256
 #define MAXBUFF    160
 
+/* Number of characters of a field that lie before the end of line    */
+#define FIELDLEN(eol, start, width)                                     \
+   (((eol) <= (start)) ? 0 :                                            \
+    ((((eol) - (start)) < (width)) ? ((eol) - (start)) : (width)))
+
 #define LOCATION_HEADER      0
 #define LOCATION_COORDINATES 1
 #define LOCATION_TRAILER     2
 
+#define MMCIF_MAXLINE 2050   /* CIF lines are at most 2048 characters   */
+
+/* atom_site items read from mmCIF files (see sAtomSiteItemsMMCIF)      */
+#define ATOMSITE_GROUP       0
+#define ATOMSITE_ID          1
+#define ATOMSITE_TYPE        2
+#define ATOMSITE_LABEL_ATOM  3
+#define ATOMSITE_AUTH_ATOM   4
+#define ATOMSITE_ALT         5
+#define ATOMSITE_LABEL_COMP  6
+#define ATOMSITE_AUTH_COMP   7
+#define ATOMSITE_LABEL_ASYM  8
+#define ATOMSITE_AUTH_ASYM   9
+#define ATOMSITE_ENTITY     10
+#define ATOMSITE_LABEL_SEQ  11
+#define ATOMSITE_AUTH_SEQ   12
+#define ATOMSITE_INSERT     13
+#define ATOMSITE_X          14
+#define ATOMSITE_Y          15
+#define ATOMSITE_Z          16
+#define ATOMSITE_OCC        17
+#define ATOMSITE_BVAL       18
+#define ATOMSITE_CHARGE     19
+#define ATOMSITE_MODEL      20
+
+/* mmCIF items used for the header (see sHeaderItemsMMCIF)              */
+#define HEADERITEM_ENTRY       0
+#define HEADERITEM_KEYWORDS    1
+#define HEADERITEM_DATE        2
+#define HEADERITEM_DEPOSITED   3
+#define HEADERITEM_TITLE       4
+#define HEADERITEM_CELL_A      5   /* Followed by b, c, alpha, beta, 
+                                      gamma                             */
+#define HEADERITEM_SPACEGROUP 11
+#define HEADERITEM_Z          12
+#define MMCIF_NHEADER         13
+
+/* Is an mmCIF token the null value ? or . (which must not be quoted)  */
+#define NULLTOKEN(ct)                                                   \
+   (!(ct)->quoted && ((ct)->tokenLen == 1) &&                           \
+    (((ct)->token[0] == '?') || ((ct)->token[0] == '.')))
+
 #ifdef XML_SUPPORT
 #define APPEND_STRINGLIST(x, y)                 \
    if(((y)!=NULL) && ((x)!=NULL)) {             \
@@ -348,17 +464,164 @@ BUGS:  25.01.05 Note the multiple occupancy code won't work properly for
    }
 #endif
 
+/************************************************************************/
+/* Type definitions
+*/
+typedef struct             /* Tokeniser for mmCIF files                 */
+{
+   LINEINPUT *li;
+   char      *line,        /* Line being read (not terminated)          */
+             *token,       /* Last token found (not terminated)         */
+             *text;        /* Buffer for multi-line text fields         */
+   int       len,          /* Length of the line                        */
+             pos,          /* Offset of the next token in the line      */
+             tokenLen,     /* Length of the token                       */
+             textSize;     /* Allocated size of text                    */
+   BOOL      quoted,       /* Token was quoted or a text field          */
+             pushed;       /* Return the same token again               */
+}  MMCIFTOKENS;
+
+typedef struct             /* State while reading an mmCIF file         */
+{
+   WHOLEPDB *wpdb;
+   PDB      *end,          /* Last atom in the linked list              */
+            atom,          /* Atom being read                           */
+            multi[MAXPARTIAL]; /* Temporary storage for partial occ     */
+   char     *header[MMCIF_NHEADER], /* Values kept for the header       */
+            CurAtom[8],
+            CurIns;
+   int      *items,        /* Item for each column of the current loop  */
+            maxItems,      /* Allocated size of items                   */
+            CurRes,
+            NPartial,
+            model,         /* Model number of the atom being read       */
+            CurModel,      /* Model number of the previous atom         */
+            ModelCount,    /* Number of models seen                     */
+            OccRank,
+            ModelNum;
+   BOOL     AllAtoms,
+            DoWhole,
+            authSeq;       /* auth_seq_id read for this atom            */
+   PDBREADSTATE *state;    /* Flags returned to the caller              */
+}  MMCIFREAD;
+
+typedef struct             /* Filters from PDBREADOPTIONS               */
+{
+   PDBREADOPTIONS *options;
+   char           zoneChain[8],
+                  zoneInsert1[8],
+                  zoneInsert2[8];
+   int            zoneRes1,
+                  zoneRes2;
+   BOOL           zone,    /* A residue zone was given                  */
+                  active;  /* Atoms must be tested against the filters  */
+}  ATOMFILTER;
+
+/************************************************************************/
+/* Globals
+*/
+static char *sAtomSiteItemsMMCIF[] = {"group_PDB",
+                                      "id",
+                                      "type_symbol",
+                                      "label_atom_id",
+                                      "auth_atom_id",
+                                      "label_alt_id",
+                                      "label_comp_id",
+                                      "auth_comp_id",
+                                      "label_asym_id",
+                                      "auth_asym_id",
+                                      "label_entity_id",
+                                      "label_seq_id",
+                                      "auth_seq_id",
+                                      "pdbx_PDB_ins_code",
+                                      "Cartn_x",
+                                      "Cartn_y",
+                                      "Cartn_z",
+                                      "occupancy",
+                                      "B_iso_or_equiv",
+                                      "pdbx_formal_charge",
+                                      "pdbx_PDB_model_num",
+                                      NULL};
+static char *sHeaderItemsMMCIF[] = 
+   {"_entry.id",
+    "_struct_keywords.pdbx_keywords",
+    "_database_PDB_rev.date_original",
+    "_pdbx_database_status.recvd_initial_deposition_date",
+    "_struct.title",
+    "_cell.length_a",
+    "_cell.length_b",
+    "_cell.length_c",
+    "_cell.angle_alpha",
+    "_cell.angle_beta",
+    "_cell.angle_gamma",
+    "_symmetry.space_group_name_H-M",
+    "_cell.Z_PDB",
+    NULL};
+
 /************************************************************************/
 /* Prototypes
 */
 static BOOL StoreOccRankAtom(int OccRank, PDB multi[MAXPARTIAL], 
                                int NPartial, PDB **ppdb, PDB **pp, 
-                               int *natom);
+                               int *natom, ARENA *arena);
+static void SelectOccRankAtom(int OccRank, PDB multi[MAXPARTIAL], 
+                              int NPartial, PDB *p);
+static BOOL DecodeAtomRecord(char *line, int len, int records, 
+                             int fields, PDB *p);
+static BOOL NewPartialGroup(PDB *p, int NPartial, char *CurAtom,
+                            int *CurRes, char *CurIns);
+static BOOL StreamAtom(PDBSTREAM *callbacks, APTR user, PDB *p, 
+                       PDB *last, int *natoms);
+static BOOL ParseAtomRecord(char *line, int len, int fields,
+                            char *record_type, int *atnum, char *atnam,
+                            char *resnam, char *chain, int *resnum,
+                            char *insert, double *x, double *y, 
+                            double *z, double *occ, double *bval,
+                            char *segid, char *element, char *charge);
+static void GetStringField(char *field, int nchar, int width, 
+                           char *value);
+static void GetIntField(char *field, int nchar, int *value);
+static void GetRealField(char *field, int nchar, double *value);
 static void ProcessElementField(char *element, char *element_field);
 static void ProcessChargeField(int *charge, char *charge_field);
 static void StoreConectRecords(WHOLEPDB *wpdb, char *buffer);
-#ifdef XML_SUPPORT
+static BOOL InitAtomFilter(ATOMFILTER *filter, PDBREADOPTIONS *options);
+static BOOL AtomLineWanted(char *line, int len, ATOMFILTER *filter);
+static BOOL AtomWanted(PDB *p, ATOMFILTER *filter);
+static void FilterAtoms(WHOLEPDB *wpdb, ATOMFILTER *filter);
+static BOOL MoveWholePDBToArena(WHOLEPDB *wpdb, ARENA *arena);
+#if !defined(SINGLE_CHAR_FILECHECK) && !defined(MS_WINDOWS)
+static BOOL CheckSamplePDBML(char *buffer);
+#endif
+static BOOL CheckLineInputPDBML(LINEINPUT *li);
+static BOOL CheckLineInputMMCIF(LINEINPUT *li);
+static WHOLEPDB *DoReadMMCIF(LINEINPUT *li, BOOL AllAtoms, int OccRank,
+                             int ModelNum, BOOL DoWhole,
+                             PDBREADSTATE *state);
+static void SetReadPDBGlobals(PDBREADSTATE *state);
+static BOOL GetTokenMMCIF(MMCIFTOKENS *ct);
+static BOOL GetTextFieldMMCIF(MMCIFTOKENS *ct);
+static int FindItemMMCIF(char *token, int len, char **items);
+static BOOL ReadLoopMMCIF(MMCIFTOKENS *ct, MMCIFREAD *rd);
+static void StartAtomMMCIF(MMCIFREAD *rd);
+static void SetAtomItemMMCIF(MMCIFREAD *rd, int item, MMCIFTOKENS *ct);
+static void CopyTokenMMCIF(char *field, MMCIFTOKENS *ct);
+static BOOL StoreAtomMMCIF(MMCIFREAD *rd);
+static BOOL StoreHeaderItemMMCIF(MMCIFREAD *rd, int item,
+                                 MMCIFTOKENS *ct);
+static BOOL BuildHeaderMMCIF(MMCIFREAD *rd);
+static void PadAtomSiteLabels(PDB *p);
 static BOOL SetPDBDateField(char *pdb_date, char *pdbml_date);
+static STRINGLIST *TitleStringlist(char *titlestring);
+#ifdef XML_SUPPORT
+static WHOLEPDB *DoReadPDBML(LINEINPUT *li, BOOL AllAtoms, int OccRank,
+                             int ModelNum, BOOL DoWhole,
+                             PDBREADSTATE *state);
+static int ReadPDBMLInput(void *context, char *buffer, int len);
+static BOOL IsHeaderCategoryPDBML(char *name);
+static void FinishReadPDBML(xmlTextReaderPtr reader, xmlDoc *header);
+static BOOL ParseAtomSitePDBML(xmlNode *atom_node, PDB *curr_pdb,
+                               int *model_number);
 static void ParseHeaderRecordsPDBML(WHOLEPDB *wpdb, xmlDoc *document);
 static STRINGLIST *ParseHeaderPDBML(xmlDoc *document);
 static STRINGLIST *ParseTitlePDBML(xmlDoc *document);
@@ -368,7 +631,6 @@ static STRINGLIST *ParseResolPDBML(xmlDoc *document);
 static STRINGLIST *ParseSeqresPDBML(xmlDoc *document);
 static STRINGLIST *ParseModresPDBML(xmlDoc *document);
 static int ParseConectPDBML(xmlDoc *document, PDB *pdb);
-static STRINGLIST *TitleStringlist(char *titlestring);
 static STRINGLIST *CompndStringlist(STRINGLIST *stringlist, 
                                       int *lines_stored, COMPND *compnd);
 static STRINGLIST *SourceStringlist(STRINGLIST *stringlist, 
@@ -603,6 +865,106 @@ PDB *blReadPDBAtomsOccRank(FILE *fp, int *natom, int OccRank)
    return(pdb);
 }
 
+/************************************************************************/
+/*>void blInitPDBReadOptions(PDBREADOPTIONS *options)
+   --------------------------------------------------
+*//**
+
+   \param[out]    *options  Options for blReadPDBOptions()
+
+   Sets the options to read all fields of the highest occupancy ATOM 
+   and HETATM records from the first model, as done by blReadPDB(),
+   allocating with malloc().
+
+-  18.10.26 Original
+-  18.10.26 Sets the arena
+*/
+void blInitPDBReadOptions(PDBREADOPTIONS *options)
+{
+   options->chains   = NULL;
+   options->atnams   = NULL;
+   options->firstRes = NULL;
+   options->lastRes  = NULL;
+   options->nchains  = 0;
+   options->natnams  = 0;
+   options->records  = PDBRECORD_ATOM | PDBRECORD_HETATM;
+   options->fields   = PDBFIELD_ALL;
+   options->OccRank  = 1;
+   options->ModelNum = 1;
+   options->arena    = NULL;
+}
+
+/************************************************************************/
+/*>PDB *blReadPDBOptions(FILE *fp, PDBREADOPTIONS *options, int *natom)
+   --------------------------------------------------------------------
+*//**
+
+   \param[in]     *fp       A pointer to type FILE in which the
+                            .PDB file is stored.
+   \param[in]     *options  The atoms and fields to read
+   \param[out]    *natom    Number of atoms read. -1 if error.
+   \return                  A pointer to the first allocated item of
+                            the PDB linked list
+
+   Reads the atoms passing the filters in options into a PDB linked 
+   list, decoding only the fields requested. This avoids reading the 
+   whole file and then making a copy of the atoms required. For 
+   example, to read the coordinates of the CA atoms in chain A:
+
+\code
+   PDBREADOPTIONS options;
+   char           *chains[] = {"A"},
+                  *atnams[] = {"CA"};
+   blInitPDBReadOptions(&options);
+   options.chains  = chains;
+   options.nchains = 1;
+   options.atnams  = atnams;
+   options.natnams = 1;
+   options.fields  = PDBFIELD_COORDS;
+   pdb = blReadPDBOptions(fp, &options, &natoms);
+\endcode
+
+   Alternate atoms are removed with blRemoveAlternates() unless 
+   options->OccRank is 0. The global flags are set as by blDoReadPDB().
+
+   If options->arena is set, the atoms are allocated from it and are 
+   freed with blFreeArena() rather than FREELIST().
+
+-  18.10.26 Original
+-  18.10.26 Added arena allocation
+*/
+PDB *blReadPDBOptions(FILE *fp, PDBREADOPTIONS *options, int *natom)
+{
+   PDB          *pdb = NULL;
+   WHOLEPDB     *wpdb;
+   PDBREADSTATE state;
+
+   *natom=(-1);
+
+   wpdb = blDoReadPDBOptions(fp, options, FALSE, &state);
+   SetReadPDBGlobals(&state);
+
+#ifdef XML_SUPPORT
+   /* Free the globals set by the XML parser                            */
+   if(state.xml)
+      xmlCleanupParser();
+#endif
+
+   if(wpdb != NULL)
+   {
+      blFreeStringList(wpdb->header);
+      blFreeStringList(wpdb->trailer);
+      *natom = wpdb->natoms;
+      pdb = wpdb->pdb;
+      free(wpdb);
+
+      if(options->OccRank != 0)
+         pdb = blRemoveAlternatesArena(pdb, options->arena);
+   }
+   
+   return(pdb);
+}
+
 /************************************************************************/
 /*>WHOLEPDB *blDoReadPDB(FILE *fpin, BOOL AllAtoms, int OccRank,
                          int ModelNum, BOOL DoWhole)
@@ -700,6 +1062,16 @@ PDB *blReadPDBAtomsOccRank(FILE *fp, int *natom, int OccRank)
 -  28.04.15 V3.5  Removed rewind. Call to blDoReadPDBML() returns WHOLEPDB
                   instead of PDB.  By: CTP
 -  21.07.15       Changed atomType to atomInfo   By: ACRM
+-  18.10.26 V3.12 Reads lines with blGetLineInput() which memory maps
+                  regular files. Coordinate records are decoded in place
+                  with ParseAtomRecord() instead of fsscanf()
+-  18.10.26 V3.13 gzip and compress'd files are decompressed in process
+                  by blOpenLineInput() when ZLIB_SUPPORT is defined
+                  rather than through gunzip and a temporary file. The
+                  PDBML check and reader work on the decompressed data
+-  18.10.26 V3.16 mmCIF files are passed to the mmCIF reader
+-  18.10.26 V3.17 Work moved to blDoReadPDBState(). The flags it returns
+                  are copied to the globals
 
    We need to deal with freeing wpdb if we are returning null.
    Also need to deal with some sort of error code
@@ -710,40 +1082,151 @@ WHOLEPDB *blDoReadPDB(FILE *fpin,
                       int  ModelNum,
                       BOOL DoWhole)
 {
-   char     record_type[8],
-            atnambuff[8],
-            *atnam,
-            atnam_raw[8],
-            resnam[8],
-            chain[4],
-            insert[4],
-            segid[8],
-            buffer[160],
+   PDBREADSTATE state;
+   WHOLEPDB     *wpdb;
+
+   wpdb = blDoReadPDBState(fpin, AllAtoms, OccRank, ModelNum, DoWhole,
+                           &state);
+   SetReadPDBGlobals(&state);
+
+#ifdef XML_SUPPORT
+   /* Free the globals set by the XML parser                            */
+   if(state.xml)
+      xmlCleanupParser();
+#endif
+
+   return(wpdb);
+}
+
+
+/************************************************************************/
+/*>WHOLEPDB *blDoReadPDBState(FILE *fpin, BOOL AllAtoms, int OccRank,
+                              int ModelNum, BOOL DoWhole,
+                              PDBREADSTATE *state)
+   ------------------------------------------------------------------
+*//**
+
+   \param[in]     *fpin    A pointer to type FILE in which the
+                           .PDB file is stored.
+   \param[in]     AllAtoms TRUE:  ATOM & HETATM records
+                           FALSE: ATOM records only
+   \param[in]     OccRank  Occupancy ranking
+   \param[in]     ModelNum NMR Model number (0 = all)
+   \param[in]     DoWhole  Read the whole PDB file rather than just 
+                           the ATOM/HETATM records.
+   \param[out]    *state   Flags describing the file which blDoReadPDB()
+                           sets in gPDBPartialOcc, gPDBMultiNMR, gPDBXML
+                           and gPDBModelNotFound
+   \return                 A pointer to a malloc'd WHOLEPDB structure
+
+   Does the work for blDoReadPDB(). No global variables are changed, so
+   different files may be read by several threads at once. With 
+   XML_SUPPORT, xmlInitParser() must be called before the threads are
+   started and xmlCleanupParser() is not called after reading PDBML; 
+   call it once all reading is finished. Without ZLIB_SUPPORT, 
+   gzipped files go through a temporary file named from the process 
+   ID, so they may not be read by more than one thread at a time.
+
+-  18.10.26 Split from blDoReadPDB()
+-  18.10.26 Appends header and trailer lines in constant time and
+            indexes the header
+-  18.10.26 Work moved to blDoReadPDBOptions()
+*/
+WHOLEPDB *blDoReadPDBState(FILE *fpin,
+                           BOOL AllAtoms,
+                           int  OccRank,
+                           int  ModelNum,
+                           BOOL DoWhole,
+                           PDBREADSTATE *state)
+{
+   PDBREADOPTIONS options;
+
+   blInitPDBReadOptions(&options);
+   options.records  = AllAtoms ? (PDBRECORD_ATOM | PDBRECORD_HETATM) :
+                                 PDBRECORD_ATOM;
+   options.OccRank  = OccRank;
+   options.ModelNum = ModelNum;
+
+   return(blDoReadPDBOptions(fpin, &options, DoWhole, state));
+}
+
+
+/************************************************************************/
+/*>WHOLEPDB *blDoReadPDBOptions(FILE *fpin, PDBREADOPTIONS *options,
+                                BOOL DoWhole, PDBREADSTATE *state)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]     *fpin    A pointer to type FILE in which the
+                           .PDB file is stored.
+   \param[in]     *options The atoms and fields to read
+   \param[in]     DoWhole  Read the whole PDB file rather than just 
+                           the ATOM/HETATM records.
+   \param[out]    *state   Flags describing the file as for 
+                           blDoReadPDBState()
+   \return                 A pointer to a malloc'd WHOLEPDB structure.
+                           NULL if the residue zone is not valid
+
+   Does the work for blDoReadPDBState() and blReadPDBOptions(). As for
+   blDoReadPDBState(), no global variables are changed.
+
+   If any filters are set, each coordinate line is first checked from
+   the columns the filters need; lines for other atoms are skipped 
+   without being decoded. (A blank numeric field in a line that is read
+   therefore takes its value from the last line that was decoded rather
+   than the last line in the file.) Alternate positions are chosen from
+   the atoms that pass the filters. Only the fields in options->fields 
+   are decoded.
+
+   For PDBML and mmCIF files, the atoms are read as normal and those 
+   not passing the filters are then removed. All the fields are read.
+
+   If options->arena is set, the atoms, header and trailer are 
+   allocated from it, the atoms being contiguous in memory in the order
+   they are read, and wpdb->arena is set. The arena then belongs to the
+   WHOLEPDB, so blFreeWholePDB() frees everything with a few calls to 
+   free(). Nothing in the lists may be freed individually (e.g. with 
+   FREELIST() or blKillPDB()); use blRemoveAlternatesArena() rather 
+   than blRemoveAlternates(). If NULL is returned, the arena still 
+   belongs to the caller. For PDBML and mmCIF files, the data are read
+   as normal and then copied into the arena.
+
+-  18.10.26 Split from blDoReadPDBState()
+-  18.10.26 Added arena allocation
+-  18.10.26 Sets name codes
+*/
+WHOLEPDB *blDoReadPDBOptions(FILE *fpin,
+                             PDBREADOPTIONS *options,
+                             BOOL DoWhole,
+                             PDBREADSTATE *state)
+{
+   char     buffer[MAXBUFF],
+            *line,
             CurAtom[8],
             cmd[80],
-            CurIns = ' ',
-            altpos,
-            element_buff[4] = "",
-            charge_buff[4]  = "",
-            element[4]      = "";
-   int      atnum,
-            resnum,
-            CurRes = 0,
+            CurIns = ' ';
+   int      CurRes = 0,
             NPartial,
             ModelCount = 0,
-            charge = 0,
+            len,
             inLocation = LOCATION_HEADER;
    FILE     *fp = fpin;
-   double   x,y,z,
-            occ,
-            bval;
+   LINEINPUT *li;
    PDB      *p = NULL,
+            atom,                /* The record being decoded            */
             multi[MAXPARTIAL];   /* Temporary storage for partial occ   */
    WHOLEPDB *wpdb = NULL;
-   BOOL     pdbml_format;
+   STRINGLIST *headerTail  = NULL,
+              *trailerTail = NULL;
+   BOOL     pdbml_format,
+            AllAtoms = ((options->records & PDBRECORD_HETATM) != 0);
+   int      OccRank  = options->OccRank,
+            ModelNum = options->ModelNum;
+   ARENA    *arena   = options->arena;
+   ATOMFILTER filter;
    
 
-#if defined(GUNZIP_SUPPORT) && !defined(MS_WINDOWS)
+#if defined(GUNZIP_SUPPORT) && !defined(MS_WINDOWS) && !defined(ZLIB_SUPPORT)
    int      signature[3],
             ch;
    BOOL     gzipped_file = FALSE;
@@ -758,18 +1241,32 @@ WHOLEPDB *blDoReadPDB(FILE *fpin,
    wpdb->pdb         = NULL;
    wpdb->header      = NULL;
    wpdb->trailer     = NULL;
+   wpdb->headerIndex = NULL;
+   wpdb->arena       = NULL;
    
    wpdb->natoms      = 0;
    CurAtom[0]        = '\0';
    NPartial          = 0;
-   gPDBPartialOcc    = FALSE;
-   gPDBMultiNMR      = 0;
+   CLEAR_PDB((&atom));
    cmd[0]            = '\0';
-   gPDBXML           = FALSE;
-   gPDBModelNotFound = TRUE;  /* Assume we haven't found the model      */
+   state->partialOcc    = FALSE;
+   state->multiNMR      = 0;
+   state->xml           = FALSE;
+   state->modelNotFound = TRUE; /* Assume we haven't found the model    */
+
+   /* Parse the residue zone                                            */
+   if(!InitAtomFilter(&filter, options))
+   {
+      free(wpdb);
+      return(NULL);
+   }
 
-#if defined(GUNZIP_SUPPORT) && !defined(MS_WINDOWS)
-   /* See whether this is a gzipped file                                */
+#if defined(GUNZIP_SUPPORT) && !defined(MS_WINDOWS) && !defined(ZLIB_SUPPORT)
+   /* Without zlib, gzipped files are sent through gunzip into a 
+      temporary file. With zlib, blOpenLineInput() decompresses them
+      (and compress'd files) in process.
+      See whether this is a gzipped file                                
+   */
 #  ifndef SINGLE_CHAR_FILECHECK
    /* Default three character filetype check                            */
    for(i=0; i<3; i++)
@@ -818,8 +1315,18 @@ WHOLEPDB *blDoReadPDB(FILE *fpin,
 #endif   
 
 
+   /* Memory map the file if we can; lines are then decoded in place.
+      Compressed data are decompressed as they are read
+   */
+   if((li = blOpenLineInput(fp, MAXBUFF-1))==NULL)
+   {
+      free(wpdb);
+      if(cmd[0]) unlink(cmd);
+      return(NULL);
+   }
+
    /* Check file format                                                 */
-   pdbml_format = blCheckFileFormatPDBML(fp);
+   pdbml_format = CheckLineInputPDBML(li);
    
    /* If it's PDBML then call the appropriate parser                    */
    if(pdbml_format)
@@ -827,28 +1334,60 @@ WHOLEPDB *blDoReadPDB(FILE *fpin,
 #ifdef XML_SUPPORT
       /* Parse PDBML-formatted PDB file                                 */
       blFreeWholePDB(wpdb);   /* free wpdb                              */
-      wpdb = blDoReadPDBML(fp,AllAtoms,OccRank,ModelNum,DoWhole);
+      wpdb = DoReadPDBML(li,AllAtoms,OccRank,ModelNum,DoWhole,state);
+      blCloseLineInput(li);
       if(cmd[0]) unlink(cmd); /* delete tmp file                        */
+      if((wpdb != NULL) && filter.active)
+         FilterAtoms(wpdb, &filter);
+      if((wpdb != NULL) && (arena != NULL) && 
+         !MoveWholePDBToArena(wpdb, arena))
+      {
+         blFreeWholePDB(wpdb);
+         return(NULL);
+      }
+      if((wpdb != NULL) && DoWhole)
+         blIndexWholePDBHeader(wpdb);
       return(wpdb);           /* return PDB list                        */
 #else
       /* PDBML format not supported.                                    */
+      blCloseLineInput(li);
       if(cmd[0]) unlink(cmd); /* delete tmp file                        */
       wpdb->natoms = (-1);    /* Indicate error                         */
       return(NULL);           /* return NULL list                       */
 #endif
    }
 
+   /* mmCIF files have their own reader which carries on from here      */
+   if(CheckLineInputMMCIF(li))
+   {
+      blFreeWholePDB(wpdb);
+      wpdb = DoReadMMCIF(li,AllAtoms,OccRank,ModelNum,DoWhole,state);
+      blCloseLineInput(li);
+      if(cmd[0]) unlink(cmd); /* delete tmp file                        */
+      if((wpdb != NULL) && filter.active)
+         FilterAtoms(wpdb, &filter);
+      if((wpdb != NULL) && (arena != NULL) && 
+         !MoveWholePDBToArena(wpdb, arena))
+      {
+         blFreeWholePDB(wpdb);
+         return(NULL);
+      }
+      if((wpdb != NULL) && DoWhole)
+         blIndexWholePDBHeader(wpdb);
+      return(wpdb);
+   }
+
    inLocation = LOCATION_HEADER;
-   
-   while(fgets(buffer,159,fp))
+
+   while((line = blGetLineInput(li, &len))!=NULL)
    {
       /*** Deal with counting model numbers                           ***/
       if(ModelNum != 0)          /* We are interested in model numbers  */
       {
-         if(!strncmp(buffer,"MODEL ",6))
+         if(LINEINPUTMATCH(line, len, "MODEL ", 6))
          {
             ModelCount++;
-            gPDBMultiNMR++;
+            (state->multiNMR)++;
          }
 
          /* See if we are in the right model                            */
@@ -857,24 +1396,24 @@ WHOLEPDB *blDoReadPDB(FILE *fpin,
             if((ModelCount != ModelNum) && (ModelCount != 0))
                continue;
             else
-               gPDBModelNotFound = FALSE;
+               state->modelNotFound = FALSE;
          }
       }
       else
       {
-         gPDBModelNotFound = FALSE;
+         state->modelNotFound = FALSE;
       }
       
 
-      if(!strncmp(buffer, "ATOM  ", 6) ||
-         !strncmp(buffer, "HETATM", 6) ||
-         !strncmp(buffer, "MODEL ", 6))
+      if(LINEINPUTMATCH(line, len, "ATOM  ", 6) ||
+         LINEINPUTMATCH(line, len, "HETATM", 6) ||
+         LINEINPUTMATCH(line, len, "MODEL ", 6))
       {
          inLocation = LOCATION_COORDINATES;
       }
-      else if(!strncmp(buffer, "CONECT", 6) ||
-              !strncmp(buffer, "MASTER", 6) ||
-              !strncmp(buffer, "END   ", 6))
+      else if(LINEINPUTMATCH(line, len, "CONECT", 6) ||
+              LINEINPUTMATCH(line, len, "MASTER", 6) ||
+              LINEINPUTMATCH(line, len, "END   ", 6))
       {
          inLocation = LOCATION_TRAILER;
       }
@@ -884,8 +1423,15 @@ WHOLEPDB *blDoReadPDB(FILE *fpin,
       {
          if(DoWhole)
          {
-            if((wpdb->header = blStoreString(wpdb->header, buffer))==NULL)
+            memcpy(buffer, line, len);
+            buffer[len] = '\0';
+            if((headerTail = blAppendStringArena(&(wpdb->header), 
+                                                 headerTail, buffer,
+                                                 arena))==NULL)
+            {
+               blCloseLineInput(li);
                return(NULL);
+            }
          }
          continue;
       }
@@ -893,7 +1439,10 @@ WHOLEPDB *blDoReadPDB(FILE *fpin,
       {
          if(DoWhole)
          {
-            wpdb->trailer = blStoreString(wpdb->trailer, buffer);
+            memcpy(buffer, line, len);
+            buffer[len] = '\0';
+            trailerTail = blAppendStringArena(&(wpdb->trailer), 
+                                              trailerTail, buffer, arena);
             if(!strncmp(buffer, "CONECT", 6))
                StoreConectRecords(wpdb, buffer);
          }
@@ -901,213 +1450,127 @@ WHOLEPDB *blDoReadPDB(FILE *fpin,
          continue;
       }
 
-      /* Read a record                                                  */
-      if(fsscanf(buffer,
-            "%6s%5d%1x%5s%4s%1s%4d%1s%3x%8lf%8lf%8lf%6lf%6lf%6x%4s%2s%2s",
-                 record_type,&atnum,atnambuff,resnam,chain,&resnum,insert,
-                 &x,&y,&z,&occ,&bval,segid,element_buff,charge_buff) 
-         != EOF)
-      {
-         if((!strncmp(record_type,"ATOM  ",6)) || 
-            (!strncmp(record_type,"HETATM",6) && AllAtoms))
-         {
-            /* Copy the raw atom name                                   */
-            /* 03.06.05 Note: this reads the alternate atom position as 
-               well as the atom name - changes in FixAtomName() now strip
-               that
-               We now copy only the first 4 characters into atnam_raw and
-               put the 5th character into altpos
-            */
-            strncpy(atnam_raw, atnambuff, 4);
-            atnam_raw[4] = '\0';
-            altpos = atnambuff[4];
+      /* Skip atoms that aren't wanted without decoding them            */
+      if(filter.active && !AtomLineWanted(line, len, &filter))
+         continue;
 
-            /* Fix the atom name accounting for start in column 13 or 14*/
-            atnam = blFixAtomName(atnambuff, occ);
+      /* Read a record, decoding the columns directly from the line     */
+      if(DecodeAtomRecord(line, len, options->records, options->fields,
+                          &atom))
+      {
+         /* Check for full occupancy. If occupancy is 0.0 assume that it
+            is actually fully occupied; the column just hasn't been
+            filled in correctly
             
-            /* Set element and charge                                   */
-            ProcessElementField(element, element_buff);
-            ProcessChargeField(&charge, charge_buff);
+            04.10.94 Read all atoms if OccRank is 0
+
+            14.10.05 Now takes an atom as full occupancy:
+                        if occ==1.0
+                        if occ==0.0 and altpos==' '
+                        if OccRank==0
+                     This fixes problems where a lower (partial)
+                     occupancy has erroneously been set to zero
+            21.12.11 Now only worries about partial occupancy if altpos
+                     is a space. The first line of the if() statement
+                     here would assume single occupancy if altpos was
+                     a space and occupancy was zero:
+                     if(((altpos == ' ') && (occ < (double)SMALL)) ||
+                     - it now assumes single occupancy if altpos is a
+                     space regardless of the actual occupancy. This
+                     deals with cases like 1ap2 ZN A112 and 1ces ZN
+                     A238 where these HETATMs are single occupancy
+                     but with occupancy < 1.0
+         */
+         if((atom.altpos == ' ') ||
+            (atom.occ > (REAL)0.999) || 
+            (OccRank == 0))
+         {
+            /* Trim the atom name to 4 characters                       */
+            atom.atnam[4] = '\0';
+            blSetPDBNameCodes(&atom);
             
-            /* Set element from atom name if not in input file          */
-            if(strlen(element) == 0)
-            {
-               blSetElementSymbolFromAtomName(element, atnam_raw);
-            }
-
-            /* Check for full occupancy. If occupancy is 0.0 assume that 
-               it is actually fully occupied; the column just hasn't been
-               filled in correctly
-               
-               04.10.94 Read all atoms if OccRank is 0
-
-               14.10.05 Now takes an atom as full occupancy:
-                           if occ==1.0
-                           if occ==0.0 and altpos==' '
-                           if OccRank==0
-                        This fixes problems where a lower (partial)
-                        occupancy has erroneously been set to zero
-               21.12.11 Now only worries about partial occupancy if altpos
-                        is a space. The first line of the if() statement
-                        here would assume single occupancy if altpos was
-                        a space and occupancy was zero:
-                        if(((altpos == ' ') && (occ < (double)SMALL)) ||
-                        - it now assumes single occupancy if altpos is a
-                        space regardless of the actual occupancy. This
-                        deals with cases like 1ap2 ZN A112 and 1ces ZN
-                        A238 where these HETATMs are single occupancy
-                        but with occupancy < 1.0
-            */
-            if((altpos == ' ') ||
-               (occ > (double)0.999) || 
-               (OccRank == 0))
+            if(NPartial != 0)
             {
-               /* Trim the atom name to 4 characters                    */
-               atnam[4] = '\0';
-               
-               if(NPartial != 0)
-               {
-                  if(!StoreOccRankAtom(OccRank,multi,NPartial,
-                                         &wpdb->pdb,&p,&(wpdb->natoms)))
-                  {
-                     if(wpdb->pdb != NULL) FREELIST(wpdb->pdb, PDB);
-                     wpdb->natoms = (-1);
-                     if(cmd[0]) unlink(cmd);
-                     return(NULL);
-                  }
-                  
-                  /* Set partial occupancy counter to 0                 */
-                  NPartial = 0;
-               }
-               
-               /* Allocate space in the linked list                     */
-               if(wpdb->pdb == NULL)
-               {
-                  INIT(wpdb->pdb, PDB);
-                  p = wpdb->pdb;
-               }
-               else
-               {
-                  ALLOCNEXT(p, PDB);
-               }
-               
-               /* Failed to allocate space; free up list so far & return*/
-               if(p==NULL)
+               if(!StoreOccRankAtom(OccRank,multi,NPartial,
+                                      &wpdb->pdb,&p,&(wpdb->natoms),
+                                      arena))
                {
-                  if(wpdb->pdb != NULL) FREELIST(wpdb->pdb, PDB);
+                  if(arena == NULL) FREELIST(wpdb->pdb, PDB);
                   wpdb->natoms = (-1);
+                  blCloseLineInput(li);
                   if(cmd[0]) unlink(cmd);
                   return(NULL);
                }
                
-               /* Increment the number of atoms                         */
-               (wpdb->natoms)++;
-               
-               /* Store the information read                            */
-               CLEAR_PDB(p);
-               p->atnum  = atnum;
-               p->resnum = resnum;
-               p->x      = (REAL)x;
-               p->y      = (REAL)y;
-               p->z      = (REAL)z;
-               p->occ    = (REAL)occ;
-               p->bval   = (REAL)bval;
-               p->altpos = altpos;    /* 03.06.05 Added this one        */
-               p->formal_charge  = charge;
-               p->partial_charge = (REAL)charge;
-               p->access = 0.0;
-               p->radius = 0.0;
-               p->next   = NULL;
-               strcpy(p->record_type, record_type);
-               strcpy(p->atnam,       atnam);
-               strcpy(p->atnam_raw,   atnam_raw);
-               strcpy(p->resnam,      resnam);
-               strcpy(p->chain,       chain);
-               strcpy(p->insert,      insert);
-               strcpy(p->element,     element);
-               strcpy(p->segid,       segid);
+               /* Set partial occupancy counter to 0                    */
+               NPartial = 0;
             }
-            else   /* Partial occupancy                                 */
+            
+            /* Allocate space in the linked list                        */
+            if(wpdb->pdb == NULL)
             {
-               /* Set flag to say we've got a partial occupancy atom    */
-               gPDBPartialOcc = TRUE;
-               
-               /* First in a group, store atom name                     */
-               if(NPartial == 0)
-               {
-                  CurIns = insert[0];
-                  CurRes = resnum;
-                  strncpy(CurAtom,atnam,8);
-               }
-               
-               if(strncmp(CurAtom,atnam,strlen(CurAtom)-1) || 
-                  resnum != CurRes || 
-                  CurIns != insert[0])
+               INITARENA(wpdb->pdb, PDB, arena);
+               p = wpdb->pdb;
+            }
+            else
+            {
+               ALLOCNEXTARENA(p, PDB, arena);
+            }
+            
+            /* Failed to allocate space; free up list so far & return   */
+            if(p==NULL)
+            {
+               if(arena == NULL) FREELIST(wpdb->pdb, PDB);
+               wpdb->natoms = (-1);
+               blCloseLineInput(li);
+               if(cmd[0]) unlink(cmd);
+               return(NULL);
+            }
+            
+            /* Increment the number of atoms and store the atom         */
+            (wpdb->natoms)++;
+            *p = atom;
+         }
+         else   /* Partial occupancy                                    */
+         {
+            /* Set flag to say we've got a partial occupancy atom       */
+            state->partialOcc = TRUE;
+            
+            if(NewPartialGroup(&atom, NPartial, CurAtom, &CurRes, 
+                               &CurIns))
+            {
+               /* Atom name has changed 
+                  Select and store the OccRank highest occupancy atom
+               */
+               if(!StoreOccRankAtom(OccRank,multi,NPartial,
+                                      &wpdb->pdb,&p,&wpdb->natoms,arena))
                {
-                  /* Atom name has changed 
-                     Select and store the OccRank highest occupancy atom
-                  */
-                  if(!StoreOccRankAtom(OccRank,multi,NPartial,
-                                         &wpdb->pdb,&p,&wpdb->natoms))
-                  {
-                     if(wpdb->pdb != NULL) FREELIST(wpdb->pdb, PDB);
-                     wpdb->natoms = (-1);
-                     if(cmd[0]) unlink(cmd);
-                     return(NULL);
-                  }
-                  
-                  /* Reset the partial atom counter                     */
-                  NPartial = 0;
-                  strncpy(CurAtom,atnam,8);
-                  CurRes = resnum;
-                  CurIns = insert[0];
+                  if(arena == NULL) FREELIST(wpdb->pdb, PDB);
+                  wpdb->natoms = (-1);
+                  blCloseLineInput(li);
+                  if(cmd[0]) unlink(cmd);
+                  return(NULL);
                }
                
-               if(NPartial < MAXPARTIAL)
-               {
-                  /* Store the partial atom data                        */
-                  CLEAR_PDB((multi + NPartial));
-                  multi[NPartial].atnum  = atnum;
-                  multi[NPartial].resnum = resnum;
-                  multi[NPartial].x      = (REAL)x;
-                  multi[NPartial].y      = (REAL)y;
-                  multi[NPartial].z      = (REAL)z;
-                  multi[NPartial].occ    = (REAL)occ;
-                  multi[NPartial].bval   = (REAL)bval;
-                  multi[NPartial].formal_charge = charge;
-                  multi[NPartial].partial_charge = (REAL)charge;
-                  multi[NPartial].access = 0.0;
-                  multi[NPartial].radius = 0.0;
-                  multi[NPartial].atomInfo = NULL;
-                  multi[NPartial].next   = NULL;
-                  strcpy(multi[NPartial].record_type, record_type);
-                  strcpy(multi[NPartial].atnam,       atnam);
-                  /* 27.04.05 - added this line                         */
-                  strcpy(multi[NPartial].atnam_raw,   atnam_raw);
-                  strcpy(multi[NPartial].resnam,      resnam);
-                  strcpy(multi[NPartial].chain,       chain);
-                  strcpy(multi[NPartial].insert,      insert);
-                  strcpy(multi[NPartial].element,     element);
-                  /* 03.06.05 - added this line                         */
-                  multi[NPartial].altpos = altpos;
-                  /* 17.02.15 - added this line                         */
-                  strcpy(multi[NPartial].segid,       segid);
-
-                  NPartial++;
-               }
+               /* Reset the partial atom counter                        */
+               NPartial = 0;
             }
+            
+            /* Store the partial atom data                              */
+            if(NPartial < MAXPARTIAL)
+               multi[NPartial++] = atom;
          }
-         charge_buff[0] = '\0';
-         charge = 0;
       }
    }
 
+   blCloseLineInput(li);
+
    if(NPartial != 0)
    {
       if(!StoreOccRankAtom(OccRank,multi,NPartial,&wpdb->pdb,&p,
-                             &wpdb->natoms))
+                             &wpdb->natoms,arena))
       {
-         if(wpdb->pdb != NULL) FREELIST(wpdb->pdb, PDB);
+         if(arena == NULL) FREELIST(wpdb->pdb, PDB);
          wpdb->natoms = (-1);
          if(cmd[0]) unlink(cmd);
          return(NULL);
@@ -1116,64 +1579,347 @@ WHOLEPDB *blDoReadPDB(FILE *fpin,
 
    if(cmd[0]) unlink(cmd);
 
+   /* The WHOLEPDB now owns the arena                                   */
+   wpdb->arena = arena;
+
+   /* Index the header records                                          */
+   if(DoWhole)
+      blIndexWholePDBHeader(wpdb);
+
    /* Return pointer to start of linked list                            */
    return(wpdb);
 }
 
 /************************************************************************/
-/*>static BOOL StoreOccRankAtom(int OccRank, PDB multi[MAXPARTIAL], 
-                                  int NPartial, PDB **ppdb, PDB **pp, 
-                                  int *natom)
-   ------------------------------------------------------------------
+/*>static void SetReadPDBGlobals(PDBREADSTATE *state)
+   --------------------------------------------------
 *//**
 
-   \param[in]     OccRank    Occupancy ranking required (>=1)
-   \param[in]     multi[]    Array of PDB records for alternative atom
-                             positions
-   \param[in]     NPartial   Number of items in multi array
-   \param[in,out] **ppdb     Start of PDB linked list (or NULL)
-   \param[in,out] **pp       Current position in PDB linked list (or NULL)
-   \param[in,out] *natom     Number of atoms read
-   \return                   Memory allocation success
+   \param[in]     *state    Flags returned by a reader
 
-   Takes an array of PDB records which represent alternative atom 
-   positions for an atom. Select the OccRank'th highest occupancy and
-   add this one into the PDB linked list.
+   Copies the flags returned by the readers to the global variables set
+   by blDoReadPDB(), blDoReadPDBML() and blDoReadMMCIF().
 
-   To be called by doReadPDB().
+-  18.10.26 Original
+*/
+static void SetReadPDBGlobals(PDBREADSTATE *state)
+{
+   gPDBPartialOcc    = state->partialOcc;
+   gPDBMultiNMR      = state->multiNMR;
+   gPDBXML           = state->xml;
+   gPDBModelNotFound = state->modelNotFound;
+}
 
--  17.03.94 Original    By: ACRM
--  08.10.99 Initialise IMaxOcc and MaxOcc
--  27.04.05 Added atnam_raw
--  03.06.05 Added altpos
--  14.10.05 Modified the flag value from 0.0 to -1.0 so that erroneous
-            lower occupancies of 0.0 are read properly and written back
-            with their occupancy (0.0) rather than the next higher
-            occupancy. Handles residues like 1zeh/B16
--  04.08.14 Read charge and element. By: CTP
--  16.08.14 Read formal charge and set partial charge. By: CTP
--  17.02.15 Added segid support   By: ACRM
--  23.06.15 Clears the new PDB items 
--  21.07.15 Changed .atomType to .atomInfo
+
+/************************************************************************/
+/*>int blStreamPDB(FILE *fp, PDBSTREAM *callbacks, APTR user)
+   ----------------------------------------------------------
+*//**
+
+   \param[in]     *fp        A pointer to type FILE in which the
+                             .PDB file is stored.
+   \param[in]     *callbacks Callback functions and reading options
+   \param[in]     user       Data passed through to the callbacks
+   \return                   Number of atoms passed to the callbacks.
+                             -1 if the file could not be read
+
+   Reads a PDB file without building a linked list. Each atom is decoded
+   into a PDB record on the stack and handed to callbacks->atom() so 
+   memory use does not depend on the size of the file. 
+   callbacks->residue() is called with the first atom of each residue
+   before callbacks->atom() is called with the same atom, and 
+   callbacks->model() is called at the start of each model (with 1
+   before the first atom if there are no MODEL records). Any of the
+   callbacks may be NULL. The PDB record is only valid during the
+   callback; it must be copied if it is to be kept. If a callback 
+   returns FALSE, reading stops and the number of atoms seen so far is 
+   returned.
+
+   callbacks->AllAtoms and callbacks->OccRank have the same meanings as
+   in blDoReadPDB(). All models are read. Since atoms are not stored, 
+   alternative positions which are not grouped together in the file
+   cannot be resolved as blRemoveAlternates() does for blReadPDB(). The
+   global flags set by blDoReadPDB() are not changed, and PDBML and
+   mmCIF files are not supported.
+
+-  18.10.26 Original
+-  18.10.26 Returns -1 for mmCIF files
+-  18.10.26 Sets name codes
 */
-static BOOL StoreOccRankAtom(int OccRank, PDB multi[MAXPARTIAL], 
-                               int NPartial, PDB **ppdb, PDB **pp, 
-                               int *natom)
+int blStreamPDB(FILE *fp, PDBSTREAM *callbacks, APTR user)
 {
-   int  i,
-        j,
-        IMaxOcc = 0;
-   REAL MaxOcc  = (REAL)0.0,
-        LastOcc = (REAL)0.0;
-   
-   if(OccRank < 1) OccRank = 1;
-   
-   for(i=0; i<OccRank; i++)
+   char      *line,
+             CurAtom[8],
+             CurIns    = ' ';
+   int       CurRes    = 0,
+             NPartial  = 0,
+             ModelNum  = 0,
+             natoms    = 0,
+             OccRank   = callbacks->OccRank,
+             len;
+   LINEINPUT *li;
+   PDB       atom,               /* The record being decoded            */
+             selected,           /* Atom chosen from partial occupancy  */
+             last,               /* Previous atom delivered             */
+             multi[MAXPARTIAL];  /* Temporary storage for partial occ   */
+   BOOL      ok       = TRUE,
+             inCoords = FALSE;
+
+   CurAtom[0] = '\0';
+   CLEAR_PDB((&atom));
+   CLEAR_PDB((&last));
+   last.record_type[0] = '\0';   /* Flags no previous atom              */
+
+   if((li = blOpenLineInput(fp, MAXBUFF-1))==NULL)
+      return(-1);
+
+   if(CheckLineInputPDBML(li) || CheckLineInputMMCIF(li))
    {
-      MaxOcc  = (REAL)0.0;
-      IMaxOcc = 0;
-      
-      for(j=0; j<NPartial; j++)
+      blCloseLineInput(li);
+      return(-1);
+   }
+
+   while(ok && ((line = blGetLineInput(li, &len))!=NULL))
+   {
+      if(LINEINPUTMATCH(line, len, "MODEL ", 6))
+      {
+         /* Finish the partial occupancy group from the last model      */
+         if(NPartial != 0)
+         {
+            SelectOccRankAtom(OccRank, multi, NPartial, &selected);
+            NPartial = 0;
+            if(!StreamAtom(callbacks, user, &selected, &last, &natoms))
+               break;
+         }
+         
+         ModelNum++;
+         inCoords = TRUE;
+         last.record_type[0] = '\0';
+         if((callbacks->model != NULL) && 
+            !(*callbacks->model)(ModelNum, user))
+            break;
+         continue;
+      }
+
+      /* As in blDoReadPDB(), every line in the coordinate section is 
+         decoded so that undecodable fields carry over identically
+      */
+      if(LINEINPUTMATCH(line, len, "ATOM  ", 6) ||
+         LINEINPUTMATCH(line, len, "HETATM", 6))
+      {
+         inCoords = TRUE;
+      }
+      else if(LINEINPUTMATCH(line, len, "CONECT", 6) ||
+              LINEINPUTMATCH(line, len, "MASTER", 6) ||
+              LINEINPUTMATCH(line, len, "END   ", 6))
+      {
+         inCoords = FALSE;
+      }
+
+      if(!inCoords ||
+         !DecodeAtomRecord(line, len, 
+                           (callbacks->AllAtoms ?
+                            (PDBRECORD_ATOM | PDBRECORD_HETATM) :
+                            PDBRECORD_ATOM),
+                           PDBFIELD_ALL, &atom))
+         continue;
+
+      /* Atoms before any MODEL record are in model 1                   */
+      if(ModelNum == 0)
+      {
+         ModelNum = 1;
+         if((callbacks->model != NULL) && 
+            !(*callbacks->model)(ModelNum, user))
+            break;
+      }
+
+      /* Full occupancy is tested as in blDoReadPDB()                   */
+      if((atom.altpos == ' ') ||
+         (atom.occ > (REAL)0.999) || 
+         (OccRank == 0))
+      {
+         /* Trim the atom name to 4 characters                          */
+         atom.atnam[4] = '\0';
+         blSetPDBNameCodes(&atom);
+         
+         if(NPartial != 0)
+         {
+            SelectOccRankAtom(OccRank, multi, NPartial, &selected);
+            NPartial = 0;
+            if(!StreamAtom(callbacks, user, &selected, &last, &natoms))
+               break;
+         }
+         ok = StreamAtom(callbacks, user, &atom, &last, &natoms);
+      }
+      else   /* Partial occupancy                                       */
+      {
+         if(NewPartialGroup(&atom, NPartial, CurAtom, &CurRes, &CurIns))
+         {
+            SelectOccRankAtom(OccRank, multi, NPartial, &selected);
+            NPartial = 0;
+            ok = StreamAtom(callbacks, user, &selected, &last, &natoms);
+         }
+         
+         if(NPartial < MAXPARTIAL)
+            multi[NPartial++] = atom;
+      }
+   }
+
+   if(ok && (NPartial != 0))
+   {
+      SelectOccRankAtom(OccRank, multi, NPartial, &selected);
+      StreamAtom(callbacks, user, &selected, &last, &natoms);
+   }
+
+   blCloseLineInput(li);
+   
+   return(natoms);
+}
+
+/************************************************************************/
+/*>static BOOL StreamAtom(PDBSTREAM *callbacks, APTR user, PDB *p, 
+                          PDB *last, int *natoms)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in]     *callbacks Callback functions
+   \param[in]     user       Data passed through to the callbacks
+   \param[in]     *p         The atom
+   \param[in,out] *last      The previous atom. An empty record_type
+                             indicates that there was none
+   \param[in,out] *natoms    Number of atoms passed to callbacks
+   \return                   FALSE if a callback asked to stop
+
+   Passes an atom to the callbacks for blStreamPDB(), calling the
+   residue callback first if the atom starts a new residue.
+
+-  18.10.26 Original
+*/
+static BOOL StreamAtom(PDBSTREAM *callbacks, APTR user, PDB *p, 
+                       PDB *last, int *natoms)
+{
+   BOOL newRes;
+   
+   newRes = ((last->record_type[0] == '\0') || 
+             (last->resnum != p->resnum)    ||
+             !PDBCHAINMATCH(last, p)        ||
+             !INSERTMATCH(last->insert, p->insert));
+   *last  = *p;
+   (*natoms)++;
+
+   if(newRes && (callbacks->residue != NULL) &&
+      !(*callbacks->residue)(p, user))
+      return(FALSE);
+
+   if((callbacks->atom != NULL) && !(*callbacks->atom)(p, user))
+      return(FALSE);
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static BOOL StoreOccRankAtom(int OccRank, PDB multi[MAXPARTIAL], 
+                                  int NPartial, PDB **ppdb, PDB **pp, 
+                                  int *natom, ARENA *arena)
+   ------------------------------------------------------------------
+*//**
+
+   \param[in]     OccRank    Occupancy ranking required (>=1)
+   \param[in]     multi[]    Array of PDB records for alternative atom
+                             positions
+   \param[in]     NPartial   Number of items in multi array
+   \param[in,out] **ppdb     Start of PDB linked list (or NULL)
+   \param[in,out] **pp       Current position in PDB linked list (or NULL)
+   \param[in,out] *natom     Number of atoms read
+   \param[in,out] *arena     Arena for the new atom (NULL = malloc())
+   \return                   Memory allocation success
+
+   Takes an array of PDB records which represent alternative atom 
+   positions for an atom. Select the OccRank'th highest occupancy and
+   add this one into the PDB linked list.
+
+   To be called by doReadPDB().
+
+-  17.03.94 Original    By: ACRM
+-  08.10.99 Initialise IMaxOcc and MaxOcc
+-  27.04.05 Added atnam_raw
+-  03.06.05 Added altpos
+-  14.10.05 Modified the flag value from 0.0 to -1.0 so that erroneous
+            lower occupancies of 0.0 are read properly and written back
+            with their occupancy (0.0) rather than the next higher
+            occupancy. Handles residues like 1zeh/B16
+-  04.08.14 Read charge and element. By: CTP
+-  16.08.14 Read formal charge and set partial charge. By: CTP
+-  17.02.15 Added segid support   By: ACRM
+-  23.06.15 Clears the new PDB items 
+-  21.07.15 Changed .atomType to .atomInfo
+-  18.10.26 Selection done by SelectOccRankAtom()
+-  18.10.26 Added arena parameter
+*/
+static BOOL StoreOccRankAtom(int OccRank, PDB multi[MAXPARTIAL], 
+                               int NPartial, PDB **ppdb, PDB **pp, 
+                               int *natom, ARENA *arena)
+{
+   /* Allocate space in the linked list                                 */
+   if(*ppdb == NULL)
+   {
+      INITARENA((*ppdb), PDB, arena);
+      *pp = *ppdb;
+   }
+   else
+   {
+      ALLOCNEXTARENA(*pp, PDB, arena);
+   }
+            
+   /* Failed to allocate space; error return.                           */
+   if(*pp==NULL)
+      return(FALSE);
+               
+   /* Increment the number of atoms                                     */
+   (*natom)++;
+
+   SelectOccRankAtom(OccRank, multi, NPartial, *pp);
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static void SelectOccRankAtom(int OccRank, PDB multi[MAXPARTIAL], 
+                                 int NPartial, PDB *p)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in]     OccRank    Occupancy ranking required (>=1)
+   \param[in,out] multi[]    Array of PDB records for alternative atom
+                             positions (occupancies are destroyed)
+   \param[in]     NPartial   Number of items in multi array
+   \param[out]    *p         The selected atom
+
+   Selects the OccRank'th highest occupancy from the alternative atom
+   positions and copies it into p with the alternate letter removed from
+   the atom name.
+
+-  18.10.26 Split from StoreOccRankAtom() so atoms can be selected
+            without adding them to a list
+-  18.10.26 Sets the name codes
+*/
+static void SelectOccRankAtom(int OccRank, PDB multi[MAXPARTIAL], 
+                              int NPartial, PDB *p)
+{
+   int  i,
+        j,
+        IMaxOcc = 0;
+   REAL MaxOcc  = (REAL)0.0,
+        LastOcc = (REAL)0.0;
+   
+   if(OccRank < 1) OccRank = 1;
+   
+   for(i=0; i<OccRank; i++)
+   {
+      MaxOcc  = (REAL)0.0;
+      IMaxOcc = 0;
+      
+      for(j=0; j<NPartial; j++)
       {
          if(multi[j].occ >= MaxOcc)
          {
@@ -1200,166 +1946,579 @@ static BOOL StoreOccRankAtom(int OccRank, PDB multi[MAXPARTIAL],
    if(MaxOcc < (REAL)0.0)
       MaxOcc = LastOcc;
 
-   /* Store this atom
-      Allocate space in the linked list
-   */
-   if(*ppdb == NULL)
-   {
-      INIT((*ppdb), PDB);
-      *pp = *ppdb;
-   }
-   else
-   {
-      ALLOCNEXT(*pp, PDB);
-   }
-            
-   /* Failed to allocate space; error return.                           */
-   if(*pp==NULL)
-      return(FALSE);
-               
-   /* Increment the number of atoms                                     */
-   (*natom)++;
-               
-   CLEAR_PDB((*pp));   /* 23.06.15                                      */
+   CLEAR_PDB(p);   /* 23.06.15                                          */
 
    /* Store the information read                                        */
-   (*pp)->atnum  = multi[IMaxOcc].atnum;
-   (*pp)->resnum = multi[IMaxOcc].resnum;
-   (*pp)->x      = multi[IMaxOcc].x;
-   (*pp)->y      = multi[IMaxOcc].y;
-   (*pp)->z      = multi[IMaxOcc].z;
-   (*pp)->occ    = MaxOcc;
-   (*pp)->bval   = multi[IMaxOcc].bval;
-   (*pp)->formal_charge = multi[IMaxOcc].formal_charge;
-   (*pp)->partial_charge = multi[IMaxOcc].partial_charge;
-   (*pp)->access = multi[IMaxOcc].access;
-   (*pp)->radius = multi[IMaxOcc].radius;
-   (*pp)->atomInfo = NULL;
-   (*pp)->next   = NULL;
+   p->atnum  = multi[IMaxOcc].atnum;
+   p->resnum = multi[IMaxOcc].resnum;
+   p->x      = multi[IMaxOcc].x;
+   p->y      = multi[IMaxOcc].y;
+   p->z      = multi[IMaxOcc].z;
+   p->occ    = MaxOcc;
+   p->bval   = multi[IMaxOcc].bval;
+   p->formal_charge = multi[IMaxOcc].formal_charge;
+   p->partial_charge = multi[IMaxOcc].partial_charge;
+   p->access = multi[IMaxOcc].access;
+   p->radius = multi[IMaxOcc].radius;
+   p->atomInfo = NULL;
+   p->next   = NULL;
    /* 03.06.05 Added this line                                          */
-   (*pp)->altpos = multi[IMaxOcc].altpos;
-   strcpy((*pp)->record_type, multi[IMaxOcc].record_type);
-   strcpy((*pp)->atnam,       multi[IMaxOcc].atnam);
+   p->altpos = multi[IMaxOcc].altpos;
+   strcpy(p->record_type, multi[IMaxOcc].record_type);
+   strcpy(p->atnam,       multi[IMaxOcc].atnam);
    /* 27.04.05 Added this line                                          */
-   strcpy((*pp)->atnam_raw,   multi[IMaxOcc].atnam_raw);
-   strcpy((*pp)->resnam,      multi[IMaxOcc].resnam);
-   strcpy((*pp)->chain,       multi[IMaxOcc].chain);
-   strcpy((*pp)->insert,      multi[IMaxOcc].insert);
-   strcpy((*pp)->element,     multi[IMaxOcc].element);
+   strcpy(p->atnam_raw,   multi[IMaxOcc].atnam_raw);
+   strcpy(p->resnam,      multi[IMaxOcc].resnam);
+   strcpy(p->chain,       multi[IMaxOcc].chain);
+   strcpy(p->insert,      multi[IMaxOcc].insert);
+   strcpy(p->element,     multi[IMaxOcc].element);
    /* 17.02.15 Added this line                                          */
-   strcpy((*pp)->segid,       multi[IMaxOcc].segid);
+   strcpy(p->segid,       multi[IMaxOcc].segid);
 
    /* Patch the atom name to remove the alternate letter                */
-   if(strlen((*pp)->atnam) > 4)
-      ((*pp)->atnam)[4] = '\0';
+   if(strlen(p->atnam) > 4)
+      (p->atnam)[4] = '\0';
    else
-      ((*pp)->atnam)[3] = ' ';
+      (p->atnam)[3] = ' ';
 
-   return(TRUE);
+   blSetPDBNameCodes(p);
 }
 
 /************************************************************************/
-/*>char *blFixAtomName(char *name, REAL occup)
-   -------------------------------------------
+/*>static BOOL DecodeAtomRecord(char *line, int len, int records,
+                                int fields, PDB *p)
+   ----------------------------------------------------------------
 *//**
 
-   \param[in]     *name     Atom name read from file
-   \param[in]     occup     Occupancy to allow fixing of partial occupancy
-                            atom names
-   \return                  Fixed atom name (pointer into name)
-
-   Fixes an atom name by removing leading spaces, or moving a leading
-   digit to the end of the string. Used by doReadPDB()
-
--  06.04.94 Original    By: ACRM
--  01.03.01 No longer static
--  03.06.05 The name passed in has always contained the column which is
-            officially the alternate atom position indicator, but is 
-            used by some programs as part of the atom name. Thus the
-            properly constructed variable coming into the routine should
-            be something like '1HG1 ' or '1HG1A' for an alternate atom
-            position. However some programs use ' HG11'. Therefore we
-            now check for a character in the last position and replace
-            it with a space if there is a space in the preceeding
-            position (e.g. ' CA A' -> ' CA  ') or if there is a 
-            character in the first position (e.g. '1HG1A' -> '1HG1 ')
-            or if the occupancy is not zero/one
-            NOTE!!! To support this, the routine now has a second 
-            parameter: REAL occup
--  07.07.14 Renamed to blFixAtomName() By: CTP
+   \param[in]     *line      Line from the file (need not be terminated)
+   \param[in]     len        Number of characters in the line
+   \param[in]     records    PDBRECORD_ flags for the records wanted
+   \param[in]     fields     PDBFIELD_ flags for the fields to decode
+   \param[in,out] *p         The atom. Numeric fields which cannot be
+                             decoded keep their previous values, so the
+                             same record should be passed for each line
+   \return                   Is this an atom we want?
+
+   Decodes an ATOM/HETATM line into a PDB record (with next set to NULL)
+   fixing the atom name and setting the alternate position, element and
+   charge. The atom name is not trimmed to 4 characters as the 5th
+   is needed to group partial occupancies. Fields not in fields are
+   left as set by CLEAR_PDB().
+
+-  18.10.26 Split from blDoReadPDB()
+-  18.10.26 Takes the records and fields wanted rather than AllAtoms
 */
-char *blFixAtomName(char *name, REAL occup)
+static BOOL DecodeAtomRecord(char *line, int len, int records, 
+                             int fields, PDB *p)
 {
-   char *newname;
-   int  len;
+   char   record_type[8],
+          atnambuff[8],
+          *atnam,
+          atnam_raw[8],
+          resnam[8],
+          chain[4],
+          insert[4],
+          segid[8],
+          altpos,
+          element_buff[4],
+          charge_buff[4],
+          element[4]   = "";
+   int    atnum        = p->atnum,
+          resnum       = p->resnum,
+          charge       = 0;
+   double x            = (double)p->x,
+          y            = (double)p->y,
+          z            = (double)p->z,
+          occ          = (double)p->occ,
+          bval         = (double)p->bval;
+   BOOL   gotLine,
+          wanted;
+
+   gotLine = ParseAtomRecord(line, len, fields, record_type, &atnum,
+                             atnambuff, resnam, chain, &resnum, insert,
+                             &x, &y, &z, &occ, &bval, segid,
+                             element_buff, charge_buff);
+   wanted  = ((!strncmp(record_type,"ATOM  ",6) && 
+               (records & PDBRECORD_ATOM)) || 
+              (!strncmp(record_type,"HETATM",6) &&
+               (records & PDBRECORD_HETATM)));
+
+   CLEAR_PDB(p);
+   p->atnum  = atnum;
+   p->resnum = resnum;
+   p->x      = (REAL)x;
+   p->y      = (REAL)y;
+   p->z      = (REAL)z;
+   p->occ    = (REAL)occ;
+   p->bval   = (REAL)bval;
+
+   if(!gotLine || !wanted)
+      return(FALSE);
 
-   /* Default behaviour, just return the input string                   */
-   newname = name;
+   /* Copy the raw atom name                                            */
+   /* 03.06.05 Note: this reads the alternate atom position as well as
+      the atom name - changes in FixAtomName() now strip that
+      We now copy only the first 4 characters into atnam_raw and put
+      the 5th character into altpos
+   */
+   strncpy(atnam_raw, atnambuff, 4);
+   atnam_raw[4] = '\0';
+   altpos = atnambuff[4];
 
-   if(name[0] == ' ')       /* Name starts in column 14                 */
+   /* Fix the atom name accounting for start in column 13 or 14         */
+   atnam = blFixAtomName(atnambuff, occ);
+            
+   if(fields & PDBFIELD_ELEMENT)
    {
-      /* remove leading spaces                                          */
-      KILLLEADSPACES(newname,name);
-      /* 03.06.05 If the last-but-one position is a space, force the last
-         position (the alternate atom indicator) to be a space
-      */
-      if(newname[2] == ' ')
+      /* Set element and charge                                         */
+      ProcessElementField(element, element_buff);
+      ProcessChargeField(&charge, charge_buff);
+            
+      /* Set element from atom name if not in input file                */
+      if(strlen(element) == 0)
       {
-         newname[3] = ' ';
+         blSetElementSymbolFromAtomName(element, atnam_raw);
       }
+
+      p->formal_charge  = charge;
+      p->partial_charge = (REAL)charge;
+      strcpy(p->element, element);
    }
-   else                     /* Name starts in column 13                 */
+
+   p->altpos = altpos;    /* 03.06.05 Added this one                    */
+   strcpy(p->record_type, record_type);
+   strcpy(p->atnam,       atnam);
+   strcpy(p->atnam_raw,   atnam_raw);
+   strcpy(p->chain,       chain);
+   strcpy(p->insert,      insert);
+   if(fields & PDBFIELD_RESNAM)
+      strcpy(p->resnam,   resnam);
+   if(fields & PDBFIELD_SEGID)
+      strcpy(p->segid,    segid);
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static BOOL NewPartialGroup(PDB *p, int NPartial, char *CurAtom,
+                               int *CurRes, char *CurIns)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in]     *p         A partial occupancy atom
+   \param[in]     NPartial   Number of atoms in the current group
+   \param[in,out] *CurAtom   Atom name for the current group
+   \param[in,out] *CurRes    Residue number for the current group
+   \param[in,out] *CurIns    Insert code for the current group
+   \return                   Does this atom start a new group (so the
+                             current one must be stored first)?
+
+   Partial occupancy atoms are collected in groups of alternative 
+   positions for the same atom. This checks whether an atom belongs to
+   the current group, recording the group's identity if it is the
+   first.
+
+-  18.10.26 Split from blDoReadPDB()
+*/
+static BOOL NewPartialGroup(PDB *p, int NPartial, char *CurAtom,
+                            int *CurRes, char *CurIns)
+{
+   /* First in a group, store atom name                                 */
+   if(NPartial == 0)
    {
-      /* 03.06.05 The last character is the alternate atom indicator, 
-         so force it to be a space
-      */
-      name[4] = ' ';
-      
-      /* If the first character is a digit, move it to the end          */
-      if(isdigit(name[0]))
-      {
-         if((len = blChindex(name,' ')) == (-1))
-         {
-            /* We didn't find a space in the name, so add the character
-               onto the end of the string and re-terminate
-            */
-            len         = strlen(name);
-            newname     = name+1;
-            name[len]   = name[0];
-            name[len+1] = '\0';
-         }
-         else
-         {
-            /* We did find a space in the name, so put the first
-               character there
-            */
-            newname     = name+1;
-            name[len]   = name[0];
-         }
-      }
+      *CurIns = p->insert[0];
+      *CurRes = p->resnum;
+      strncpy(CurAtom,p->atnam,8);
    }
-   return(newname);
+               
+   if(strncmp(CurAtom,p->atnam,strlen(CurAtom)-1) || 
+      p->resnum != *CurRes || 
+      *CurIns != p->insert[0])
+   {
+      strncpy(CurAtom,p->atnam,8);
+      *CurRes = p->resnum;
+      *CurIns = p->insert[0];
+      return(TRUE);
+   }
+
+   return(FALSE);
 }
 
 /************************************************************************/
-/*>PDB *blRemoveAlternates(PDB *pdb)
-   ---------------------------------
+/*>static BOOL InitAtomFilter(ATOMFILTER *filter, PDBREADOPTIONS *options)
+   -----------------------------------------------------------------------
 *//**
 
-   \param[in,out] *pdb       PDB 
-   \return                   Ammended linked list (in case start has
-                             changed)
-
-   Remove alternate atoms - we keep only the highest occupancy or the 
-   first if there are more than one the same.
+   \param[out]    *filter    The filter
+   \param[in]     *options   Options for reading the file
+   \return                   FALSE if the residue zone is not valid
 
--  25.01.05 Original based on code written for Inpharmatica   By: ACRM
--  04.02.14 Use CHAINMATCH macro. By: CTP
--  07.07.14 Renamed to blRemoveAlternates() Use blWritePDBRecord()
-            Use bl prefix for functions By: CTP
+   Sets up a filter from the read options, parsing the residue zone. 
+   The filter is only active if a test is needed beyond the ATOM/HETATM
+   check done when decoding the line.
 
+-  18.10.26 Original
 */
-PDB *blRemoveAlternates(PDB *pdb)
+static BOOL InitAtomFilter(ATOMFILTER *filter, PDBREADOPTIONS *options)
+{
+   char chain2[8];
+
+   filter->options = options;
+   filter->zone    = (options->firstRes != NULL);
+   filter->active  = ((options->nchains > 0)  ||
+                      (options->natnams > 0)  ||
+                      filter->zone            ||
+                      !(options->records & PDBRECORD_ATOM));
+
+   if(filter->zone)
+   {
+      if(!blParseResSpec(options->firstRes, filter->zoneChain, 
+                         &(filter->zoneRes1), filter->zoneInsert1))
+         return(FALSE);
+      if(!blParseResSpec(((options->lastRes != NULL) ? 
+                          options->lastRes : options->firstRes),
+                         chain2, &(filter->zoneRes2), 
+                         filter->zoneInsert2))
+         return(FALSE);
+
+      /* As for blInPDBZoneSpec(), a zone must be within a chain        */
+      if(!CHAINMATCH(filter->zoneChain, chain2))
+         return(FALSE);
+   }
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static BOOL AtomLineWanted(char *line, int len, ATOMFILTER *filter)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]     *line      Line from the file (need not be terminated)
+   \param[in]     len        Number of characters in the line
+   \param[in]     *filter    The filter
+   \return                   Is this an atom that passes the filter?
+
+   Tests an ATOM/HETATM line against the filter, decoding only the
+   columns that the filter needs.
+
+-  18.10.26 Original
+*/
+static BOOL AtomLineWanted(char *line, int len, ATOMFILTER *filter)
+{
+   PDB  atom;
+   char atnambuff[8];
+   int  eol;
+
+   if(len > 80) len = 80;
+   for(eol=0; (eol < len) && line[eol] && (line[eol] != '\n'); eol++);
+
+   GetStringField(line, FIELDLEN(eol, 0, 6), 6, atom.record_type);
+   if(strncmp(atom.record_type, "ATOM  ", 6) &&
+      strncmp(atom.record_type, "HETATM", 6))
+      return(FALSE);
+
+   if((filter->options->nchains > 0) || filter->zone)
+      GetStringField(line+21, FIELDLEN(eol, 21, 1), 1, atom.chain);
+   if(filter->zone)
+   {
+      atom.resnum = 0;
+      GetIntField(line+22,    FIELDLEN(eol, 22, 4),    &(atom.resnum));
+      GetStringField(line+26, FIELDLEN(eol, 26, 1), 1, atom.insert);
+   }
+   if(filter->options->natnams > 0)
+   {
+      GetStringField(line+12, FIELDLEN(eol, 12, 5), 5, atnambuff);
+      strncpy(atom.atnam, blFixAtomName(atnambuff, (REAL)0.0), 4);
+      atom.atnam[4] = '\0';
+   }
+
+   return(AtomWanted(&atom, filter));
+}
+
+/************************************************************************/
+/*>static BOOL AtomWanted(PDB *p, ATOMFILTER *filter)
+   --------------------------------------------------
+*//**
+
+   \param[in]     *p         The atom
+   \param[in]     *filter    The filter
+   \return                   Does the atom pass the filter?
+
+   Tests an atom against the record types, chains, residue zone and 
+   atom names in the filter. Only the fields needed by the filter are
+   used.
+
+-  18.10.26 Original
+*/
+static BOOL AtomWanted(PDB *p, ATOMFILTER *filter)
+{
+   PDBREADOPTIONS *options = filter->options;
+   int            i;
+
+   if(!strncmp(p->record_type, "ATOM  ", 6))
+   {
+      if(!(options->records & PDBRECORD_ATOM))
+         return(FALSE);
+   }
+   else if(!strncmp(p->record_type, "HETATM", 6))
+   {
+      if(!(options->records & PDBRECORD_HETATM))
+         return(FALSE);
+   }
+   else
+   {
+      return(FALSE);
+   }
+
+   if(options->nchains > 0)
+   {
+      for(i=0; i<options->nchains; i++)
+      {
+         if(CHAINMATCH(p->chain, options->chains[i]))
+            break;
+      }
+      if(i == options->nchains)
+         return(FALSE);
+   }
+
+   if(filter->zone &&
+      !blInPDBZone(p, filter->zoneChain, 
+                   filter->zoneRes1, filter->zoneInsert1,
+                   filter->zoneRes2, filter->zoneInsert2))
+      return(FALSE);
+
+   if(options->natnams > 0)
+   {
+      for(i=0; i<options->natnams; i++)
+      {
+         if(blAtomNameMatch(p->atnam, options->atnams[i], NULL))
+            break;
+      }
+      if(i == options->natnams)
+         return(FALSE);
+   }
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static void FilterAtoms(WHOLEPDB *wpdb, ATOMFILTER *filter)
+   -----------------------------------------------------------
+*//**
+
+   \param[in,out] *wpdb      WHOLEPDB structure
+   \param[in]     *filter    The filter
+
+   Removes the atoms that do not pass the filter (and their CONECTs)
+   from a file that has already been read. Used for PDBML and mmCIF 
+   files where the filter can't be applied as the lines are read.
+
+-  18.10.26 Original
+*/
+static void FilterAtoms(WHOLEPDB *wpdb, ATOMFILTER *filter)
+{
+   PDB *p,
+       *prev = NULL;
+
+   p = wpdb->pdb;
+   while(p != NULL)
+   {
+      if(AtomWanted(p, filter))
+      {
+         prev = p;
+         NEXT(p);
+      }
+      else
+      {
+         p = blKillPDB(p, prev);
+         if(prev == NULL)
+            wpdb->pdb = p;
+         (wpdb->natoms)--;
+      }
+   }
+}
+
+/************************************************************************/
+/*>static BOOL MoveWholePDBToArena(WHOLEPDB *wpdb, ARENA *arena)
+   -------------------------------------------------------------
+*//**
+
+   \param[in,out] *wpdb     WHOLEPDB allocated with malloc()
+   \param[in,out] *arena    Arena
+   \return                  Success? FALSE if memory ran out
+
+   Replaces the atoms, header and trailer of a WHOLEPDB with copies 
+   allocated from an arena and frees the originals. The WHOLEPDB then
+   owns the arena. Used for the PDBML and mmCIF readers which build
+   their lists with malloc(). On failure the WHOLEPDB is unchanged.
+
+-  18.10.26 Original
+*/
+static BOOL MoveWholePDBToArena(WHOLEPDB *wpdb, ARENA *arena)
+{
+   PDB        *pdb     = NULL;
+   STRINGLIST *header  = NULL,
+              *trailer = NULL,
+              *tail,
+              *s;
+
+   if((wpdb->pdb != NULL) &&
+      ((pdb = blDupePDBArena(wpdb->pdb, arena))==NULL))
+      return(FALSE);
+
+   for(s=wpdb->header, tail=NULL; s!=NULL; NEXT(s))
+   {
+      if((s->string != NULL) && (s->string[0] != '\0') &&
+         ((tail = blAppendStringArena(&header, tail, s->string,
+                                      arena))==NULL))
+         return(FALSE);
+   }
+   for(s=wpdb->trailer, tail=NULL; s!=NULL; NEXT(s))
+   {
+      if((s->string != NULL) && (s->string[0] != '\0') &&
+         ((tail = blAppendStringArena(&trailer, tail, s->string,
+                                      arena))==NULL))
+         return(FALSE);
+   }
+
+   blFreeWholePDBHeaderIndex(wpdb);
+   blFreeStringList(wpdb->header);
+   blFreeStringList(wpdb->trailer);
+   FREELIST(wpdb->pdb, PDB);
+
+   wpdb->pdb     = pdb;
+   wpdb->header  = header;
+   wpdb->trailer = trailer;
+   wpdb->arena   = arena;
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>char *blFixAtomName(char *name, REAL occup)
+   -------------------------------------------
+*//**
+
+   \param[in]     *name     Atom name read from file
+   \param[in]     occup     Occupancy to allow fixing of partial occupancy
+                            atom names
+   \return                  Fixed atom name (pointer into name)
+
+   Fixes an atom name by removing leading spaces, or moving a leading
+   digit to the end of the string. Used by doReadPDB()
+
+-  06.04.94 Original    By: ACRM
+-  01.03.01 No longer static
+-  03.06.05 The name passed in has always contained the column which is
+            officially the alternate atom position indicator, but is 
+            used by some programs as part of the atom name. Thus the
+            properly constructed variable coming into the routine should
+            be something like '1HG1 ' or '1HG1A' for an alternate atom
+            position. However some programs use ' HG11'. Therefore we
+            now check for a character in the last position and replace
+            it with a space if there is a space in the preceeding
+            position (e.g. ' CA A' -> ' CA  ') or if there is a 
+            character in the first position (e.g. '1HG1A' -> '1HG1 ')
+            or if the occupancy is not zero/one
+            NOTE!!! To support this, the routine now has a second 
+            parameter: REAL occup
+-  07.07.14 Renamed to blFixAtomName() By: CTP
+*/
+char *blFixAtomName(char *name, REAL occup)
+{
+   char *newname;
+   int  len;
+
+   /* Default behaviour, just return the input string                   */
+   newname = name;
+
+   if(name[0] == ' ')       /* Name starts in column 14                 */
+   {
+      /* remove leading spaces                                          */
+      KILLLEADSPACES(newname,name);
+      /* 03.06.05 If the last-but-one position is a space, force the last
+         position (the alternate atom indicator) to be a space
+      */
+      if(newname[2] == ' ')
+      {
+         newname[3] = ' ';
+      }
+   }
+   else                     /* Name starts in column 13                 */
+   {
+      /* 03.06.05 The last character is the alternate atom indicator, 
+         so force it to be a space
+      */
+      name[4] = ' ';
+      
+      /* If the first character is a digit, move it to the end          */
+      if(isdigit(name[0]))
+      {
+         if((len = blChindex(name,' ')) == (-1))
+         {
+            /* We didn't find a space in the name, so add the character
+               onto the end of the string and re-terminate
+            */
+            len         = strlen(name);
+            newname     = name+1;
+            name[len]   = name[0];
+            name[len+1] = '\0';
+         }
+         else
+         {
+            /* We did find a space in the name, so put the first
+               character there
+            */
+            newname     = name+1;
+            name[len]   = name[0];
+         }
+      }
+   }
+   return(newname);
+}
+
+/************************************************************************/
+/*>PDB *blRemoveAlternates(PDB *pdb)
+   ---------------------------------
+*//**
+
+   \param[in,out] *pdb       PDB 
+   \return                   Ammended linked list (in case start has
+                             changed)
+
+   Remove alternate atoms - we keep only the highest occupancy or the 
+   first if there are more than one the same.
+
+-  25.01.05 Original based on code written for Inpharmatica   By: ACRM
+-  04.02.14 Use CHAINMATCH macro. By: CTP
+-  07.07.14 Renamed to blRemoveAlternates() Use blWritePDBRecord()
+            Use bl prefix for functions By: CTP
+-  18.10.26 Now a wrapper to blRemoveAlternatesArena()
+*/
+PDB *blRemoveAlternates(PDB *pdb)
+{
+   return(blRemoveAlternatesArena(pdb, NULL));
+}
+
+/************************************************************************/
+/*>PDB *blRemoveAlternatesArena(PDB *pdb, ARENA *arena)
+   ----------------------------------------------------
+*//**
+
+   \param[in,out] *pdb       PDB 
+   \param[in]     *arena     Arena from which the list was allocated.
+                             NULL if allocated with malloc()
+   \return                   Ammended linked list (in case start has
+                             changed)
+
+   As blRemoveAlternates(), but if the list was allocated from an arena 
+   the unwanted atoms are unlinked but not freed. Their memory is 
+   released with the arena.
+
+-  18.10.26 Original
+*/
+PDB *blRemoveAlternatesArena(PDB *pdb, ARENA *arena)
 {
    PDB   *p, 
          *q, 
@@ -1546,7 +2705,8 @@ pointer\n");
                      FINDPREV(a_prev, pdb, alts[i]);
                      if(a_prev != NULL)
                         a_prev->next = alts[i]->next;
-                     free(alts[i]);
+                     if(arena == NULL)
+                        free(alts[i]);
                      
                   }  /* Not the highest, so we delete it                */
                }  /* Stepping through the alternates                    */
@@ -1620,6 +2780,13 @@ pointer\n");
             flag - fixes bug where auth_seq_id = 0.  By: CTP
 -  01.07.15 Replaced ParseHeaderPDBML() with ParseHeaderRecordsPDBML()
             By: CTP
+-  18.10.26 Work moved to DoReadPDBML() which reads through 
+            blOpenLineInput() so gzip'd PDBML can be read
+-  18.10.26 DoReadPDBML() streams the file so the atom sites are never
+            all held as an XML tree
+-  18.10.26 Sets the globals from the flags returned by DoReadPDBML()
+            and cleans up the XML parser here
+-  18.10.26 Indexes the header
 */
 WHOLEPDB *blDoReadPDBML(FILE *fpin,
                         BOOL AllAtoms,
@@ -1634,31 +2801,92 @@ WHOLEPDB *blDoReadPDBML(FILE *fpin,
 
 #else
 
-   /* Parse PDBML-formatted file.                                       */
-   xmlParserCtxtPtr ctxt;
-   xmlDoc  *document;
-   xmlNode *root_node  = NULL, 
-           *sites_node = NULL, 
-           *atom_node  = NULL, 
-           *n          = NULL;
-   int     size_t;
-   char    xml_buffer[XML_BUFFER];
-   xmlChar *content;
-   double  content_lf;
+   LINEINPUT    *li;
+   WHOLEPDB     *wpdb;
+   PDBREADSTATE state;
 
-   WHOLEPDB *wpdb = NULL;
+   if((li = blOpenLineInput(fpin, XML_BUFFER))==NULL)
+      return(NULL);
+
+   /* gPDBModelNotFound is not set by the PDBML reader                  */
+   state.modelNotFound = gPDBModelNotFound;
+   wpdb = DoReadPDBML(li, AllAtoms, OccRank, ModelNum, DoWhole, &state);
+   blCloseLineInput(li);
+   if((wpdb != NULL) && DoWhole)
+      blIndexWholePDBHeader(wpdb);
+
+   SetReadPDBGlobals(&state);
+   xmlCleanupParser();
+
+   return(wpdb);
+
+#endif
+}
 
-   PDB     *curr_pdb = NULL,
-           *end_pdb  = NULL,
-           multi[MAXPARTIAL];
 
-   int     NPartial       =  0,
-           model_number   =  0,
-           natom          =  0;
-   char    store_atnam[8] = "",
-           pad_resnam[8]  = "";
+#ifdef XML_SUPPORT
+/************************************************************************/
+/*>static WHOLEPDB *DoReadPDBML(LINEINPUT *li, BOOL AllAtoms, 
+                                int OccRank, int ModelNum, BOOL DoWhole,
+                                PDBREADSTATE *state)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     *li      Line input structure for the PDBML data
+   \param[in]     AllAtoms TRUE:  ATOM & HETATM records
+                           FALSE: ATOM records only
+   \param[in]     OccRank  Occupancy ranking
+   \param[in]     ModelNum NMR Model number (0 = all)
+   \param[in]     DoWhole  Read the whole PDB file rather than just 
+                           the ATOM/HETATM records.
+   \param[out]    *state   Flags describing the file. modelNotFound is
+                           not changed
+   \return                 A pointer to a malloc'd WHOLEPDB structure.
 
-   BOOL    auth_seq_id_set = FALSE;
+   Does the work for blDoReadPDBML(). The data come through 
+   blGetBlockLineInput() so compressed files are handled and 
+   blDoReadPDB() can pass on data it has already examined.
+
+   The file is read with an xmlTextReader in a single pass. Each
+   atom_site element is expanded and converted to a PDB record on its
+   own, so memory use is that of the PDB list rather than of a document
+   tree many times the size of the file. The categories needed for the
+   header and CONECTs are copied to a small document which is parsed
+   after the atoms have been read.
+
+-  18.10.26 Split from blDoReadPDBML()
+-  18.10.26 Uses an xmlTextReader instead of building the document
+-  18.10.26 Sets flags in state rather than globals and leaves the XML
+            parser to be cleaned up by the caller
+*/
+static WHOLEPDB *DoReadPDBML(LINEINPUT *li,
+                             BOOL AllAtoms,
+                             int  OccRank,
+                             int  ModelNum,
+                             BOOL DoWhole,
+                             PDBREADSTATE *state)
+{
+   /* Parse PDBML-formatted file.                                       */
+   xmlTextReaderPtr reader;
+   xmlDoc   *header    = NULL;   /* Header categories kept for DoWhole  */
+   xmlNode  *atom_node = NULL,
+            *root_node = NULL,
+            *node      = NULL;
+   WHOLEPDB *wpdb      = NULL;
+   PDB      *curr_pdb  = NULL,
+            *end_pdb   = NULL,
+            multi[MAXPARTIAL];
+   int      NPartial       =  0,
+            model_number   =  0,
+            natom          =  0,
+            status,
+            depth;
+   char     store_atnam[8] = "",
+            *name;
+   BOOL     gotRoot        = FALSE,
+            gotSites       = FALSE,
+            inSites        = FALSE,
+            skipAtoms      = FALSE;
 
    /* Allocate wpdb                                                     */
    if((wpdb=(WHOLEPDB *)malloc(sizeof(WHOLEPDB)))==NULL)
@@ -1668,817 +2896,2205 @@ WHOLEPDB *blDoReadPDBML(FILE *fpin,
    wpdb->pdb         = NULL;
    wpdb->header      = NULL;
    wpdb->trailer     = NULL;
+   wpdb->headerIndex = NULL;
+   wpdb->arena       = NULL;
    wpdb->natoms      = 0;
 
    /* Reset flags                                                       */
-   gPDBXML        = TRUE;  /* global PDBML-fornmat flag                 */
-   gPDBPartialOcc = FALSE; /* global partial occupancy flag             */
-   gPDBMultiNMR   = FALSE; /* global multiple models flag               */
-
-
-   /* Generate Document From Filehandle                                 */
-   size_t = fread(xml_buffer, 1, XML_BUFFER, fpin);
-   ctxt = xmlCreatePushParserCtxt(NULL, NULL, xml_buffer, size_t, "file");
-   while ((size_t = fread(xml_buffer, 1, XML_BUFFER, fpin)) > 0) 
-   {
-      xmlParseChunk(ctxt, xml_buffer, size_t, 0);
-   }
-   xmlParseChunk(ctxt, xml_buffer, 0, 1);
-   document = ctxt->myDoc;
-   xmlFreeParserCtxt(ctxt);
-   
-   if(document == NULL)
+   state->xml        = TRUE;  /* PDBML-format flag                      */
+   state->partialOcc = FALSE; /* partial occupancy flag                 */
+   state->multiNMR   = FALSE; /* multiple models flag                   */
+
+   /* Stream the data rather than building the whole document. Each
+      atom_site is expanded on its own and freed when the reader moves
+      on. The header categories are small, but some of them refer to the
+      atoms, so they are copied to a separate document and parsed once
+      all the atoms have been read.
+   */
+   if((reader = xmlReaderForIO(ReadPDBMLInput, NULL, (void *)li, "file",
+                               NULL, 0))==NULL)
    {
-      /* Error: Failed to parse file                                    */
-      xmlFreeDoc(document); /* free document                            */
-      xmlCleanupParser();   /* clean up xml parser                      */
+      /* Error: Failed to create reader                                 */
       wpdb->natoms = -1;    /* indicate error                           */
       return(wpdb);         /* return wpdb                              */
    }
 
-   /* Parse Document Tree                                               */
-   root_node = xmlDocGetRootElement(document);   
-   if(root_node == NULL)
+   if(DoWhole)
    {
-      /* Error: Failed to set root node                                 */
-      xmlFreeDoc(document); /* free document                            */
-      xmlCleanupParser();   /* clean up xml parser                      */
-      wpdb->natoms = -1;    /* indicate error                           */
-      return(wpdb);         /* return wpdb                              */
-   }
-      
-   /* Parse Atom Coordinate Nodes                                       */
-   for(n=root_node->children; n!=NULL; NEXT(n))
+      if(((header    = xmlNewDoc((xmlChar *)"1.0"))==NULL) ||
+         ((root_node = xmlNewNode(NULL, (xmlChar *)"datablock"))==NULL))
+      {
+         FinishReadPDBML(reader, header);
+         wpdb->natoms = -1;    /* indicate error                        */
+         return(wpdb);         /* return wpdb                           */
+      }
+      xmlDocSetRootElement(header, root_node);
+   }
+
+   status = xmlTextReaderRead(reader);
+   while(status == 1)
    {
-      /* Find Atom Sites Node                                           */
-      if(!strcmp("atom_siteCategory", (char *)n->name))
+      depth = xmlTextReaderDepth(reader);
+      name  = (char *)xmlTextReaderConstLocalName(reader);
+
+      if(xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT)
       {
-         /* Found Atom Sites                                            */
-         sites_node = n;
+         /* End of the atom sites                                       */
+         if(inSites && (depth == 1))
+            inSites = FALSE;
+         status = xmlTextReaderRead(reader);
+         continue;
+      }
+
+      /* Root node                                                      */
+      if(depth == 0)
+      {
+         gotRoot = TRUE;
+         status  = xmlTextReaderRead(reader);
+         continue;
+      }
+
+      /* Categories                                                     */
+      if(depth == 1)
+      {
+         if(!gotSites && !strcmp("atom_siteCategory", name))
+         {
+            /* Found Atom Sites - step into them                        */
+            gotSites = TRUE;
+            inSites  = !xmlTextReaderIsEmptyElement(reader);
+            status   = xmlTextReaderRead(reader);
+            continue;
+         }
+
+         /* Keep a copy of categories needed for the header             */
+         if((header != NULL) && IsHeaderCategoryPDBML(name))
+         {
+            if((node = xmlTextReaderExpand(reader))!=NULL)
+               xmlAddChild(root_node, xmlDocCopyNode(node, header, 1));
+         }
+
+         /* Skip to the next category                                   */
+         status = xmlTextReaderNext(reader);
+         continue;
+      }
+
+      /* Skip anything other than wanted atom sites                     */
+      if(!inSites || (depth != 2) || skipAtoms ||
+         strcmp("atom_site", name))
+      {
+         status = xmlTextReaderNext(reader);
+         continue;
+      }
+
+      /* Expand the atom site                                           */
+      if((atom_node = xmlTextReaderExpand(reader))==NULL)
          break;
+
+      /* Current PDB                                                    */
+      INIT(curr_pdb,PDB);
+
+      if((curr_pdb == NULL) ||
+         !ParseAtomSitePDBML(atom_node, curr_pdb, &model_number))
+      {
+         /* Error: Failed to store atom in pdb list                     */
+         if(curr_pdb != NULL)
+            FREELIST(curr_pdb,PDB);
+         FREELIST(wpdb->pdb,PDB); /* free pdb list                      */
+         FinishReadPDBML(reader, header);
+         wpdb->natoms = -1;       /* indicate error                     */
+         return(wpdb);            /* return wpdb                        */
+      }
+
+      /* Move on so the atom site tree can be freed                     */
+      status = xmlTextReaderNext(reader);
+
+      /* Set multi-model flag                                           */
+      if(model_number > 1)
+      {
+         state->multiNMR = TRUE;
+      }
+
+      /* Filter: Model Number                                           */
+      if(model_number != ModelNum)
+      {
+         /* Free curr_pdb                                               */
+         FREELIST(curr_pdb,PDB);
+         curr_pdb = NULL;
+
+         if(model_number > ModelNum)
+         {
+            skipAtoms = TRUE;    /* skip rest of atoms                  */
+         }
+         continue;               /* filter                              */
+      }
+
+
+      /* Filter: All Atoms                                              */
+      if(!AllAtoms && strncmp(curr_pdb->record_type, "ATOM  ", 6))
+      {
+         /* Free curr_pdb and skip atom                                 */
+         FREELIST(curr_pdb,PDB);
+         curr_pdb = NULL;
+         continue;    /* filter                                         */
+      }
+
+
+      /* Add partial occ atom from temp storage to output PDB list      */
+      if((NPartial != 0) && strcmp(curr_pdb->atnam,store_atnam))
+      {
+         /* Store atom                                                  */
+         if(StoreOccRankAtom(OccRank,multi,NPartial,&wpdb->pdb,
+                               &end_pdb,&wpdb->natoms,NULL))
+         {
+            LAST(end_pdb);
+            NPartial = 0;
+         }
+         else
+         {
+            /* Error: Failed to store partial occ atom                  */
+            FREELIST(curr_pdb,PDB);  /* free curr_pdb                   */
+            FREELIST(wpdb->pdb,PDB); /* free pdb list                   */
+            FinishReadPDBML(reader, header);
+            wpdb->natoms = -1;       /* indicate error                  */
+            return(wpdb);            /* return wpdb                     */
+         }
+      }
+
+
+      /* Set atom number
+         Note: Cannot use atom site id for atom number so base atnum on
+               number of atoms stored
+
+         25.02.15 We will renumber afterwards
+      */
+      curr_pdb->atnum = natom + 1;
+
+
+      /* Add partial occupancy atom to temp storage                     */
+      if((curr_pdb->altpos != ' ') && (NPartial < MAXPARTIAL))
+      {
+         /* Copy the partial atom data to storage                       */
+         blCopyPDB(&multi[NPartial], curr_pdb);
+
+         /* Set partial occupancy flag                                  */
+         state->partialOcc = TRUE;
+
+         /* Store current atom name                                     */
+         /* 25.02.15 Changed to strncpy()  By: ACRM                     */
+         strncpy(store_atnam, curr_pdb->atnam, 8);
+         NPartial++;
+
+         /* Free curr_pdb and continue                                  */
+         FREELIST(curr_pdb,PDB);
+         curr_pdb = NULL;
+         continue;
+      }
+
+
+      /* Store Atom                                                     */
+      if(wpdb->pdb == NULL)
+      {
+         /* store first atom                                            */
+         wpdb->pdb    = curr_pdb;
+         end_pdb      = curr_pdb;
+         curr_pdb     = NULL;
+         wpdb->natoms = 1;
+      }
+      else
+      {
+         /* store subsequent atoms                                      */
+         end_pdb->next = curr_pdb;
+         end_pdb       = curr_pdb;
+         curr_pdb      = NULL;
+         wpdb->natoms += 1;
+      }
+   }
+
+
+   /* Store final atom (if partial occupancy)                           */
+   if(NPartial != 0)
+   {
+      if(!StoreOccRankAtom(OccRank,multi,NPartial,&wpdb->pdb,&end_pdb,
+                             &wpdb->natoms,NULL))
+      {
+         /* Error: Failed to store atom in pdb list                     */
+         FREELIST(wpdb->pdb,PDB); /* free pdb list                      */
+         FinishReadPDBML(reader, header);
+         wpdb->natoms = -1;       /* indicate error                     */
+         return(wpdb);            /* return wpdb                        */
+      }
+   }
+
+   /* Check atoms have been stored                                      */
+   if(!gotRoot || !gotSites || (wpdb->pdb == NULL) || (wpdb->natoms == 0))
+   {
+      /* Error: no root node, no atom sites or no atoms stored          */
+      FREELIST(wpdb->pdb,PDB); /* free pdb list                         */
+      FinishReadPDBML(reader, header);
+      wpdb->natoms = -1;       /* indicate error                        */
+      return(wpdb);            /* return wpdb                           */
+   }
+
+   /* 25.02.15 Renumber atoms since we don't use the atom site IDs      */
+   blRenumAtomsPDB(wpdb->pdb, 1);
+
+
+   /* Parse header data and CONECT nodes for whole pdb                  */
+   if(DoWhole)
+   {
+      /* Parse CONECT Nodes                                             */
+      ParseConectPDBML(header, wpdb->pdb);
+
+      /* Parse Header Data                                              */
+      ParseHeaderRecordsPDBML(wpdb, header);
+   }
+
+
+   /* Free reader and header document                                 */
+   FinishReadPDBML(reader, header);
+
+   /* Return WHOLEPDB                                                   */
+   return(wpdb);
+}
+
+
+/************************************************************************/
+/*>static int ReadPDBMLInput(void *context, char *buffer, int len)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]     *context   The LINEINPUT being read
+   \param[out]    *buffer    Buffer for the data
+   \param[in]     len        Size of the buffer
+   \return                   Number of bytes read (0 at end of file)
+
+   Input callback for the XML reader.
+
+-  18.10.26 Original
+*/
+static int ReadPDBMLInput(void *context, char *buffer, int len)
+{
+   char *data;
+   int  nread;
+
+   if((data = blGetBlockLineInput((LINEINPUT *)context, len, &nread))
+      == NULL)
+      return(0);
+   memcpy(buffer, data, (size_t)nread);
+   return(nread);
+}
+
+
+/************************************************************************/
+/*>static BOOL IsHeaderCategoryPDBML(char *name)
+   ---------------------------------------------
+*//**
+
+   \param[in]     *name      Category element name
+   \return                   Is this used for the header or CONECTs?
+
+   Identifies the categories used by ParseHeaderRecordsPDBML() and
+   ParseConectPDBML().
+
+-  18.10.26 Original
+*/
+static BOOL IsHeaderCategoryPDBML(char *name)
+{
+   static char *categories[] = {"struct_keywordsCategory",
+                                "database_PDB_revCategory",
+                                "entryCategory",
+                                "structCategory",
+                                "entityCategory",
+                                "entity_src_genCategory",
+                                "entity_src_natCategory",
+                                "refine_ls_shellCategory",
+                                "pdbx_poly_seq_schemeCategory",
+                                "pdbx_struct_mod_residueCategory",
+                                "struct_connCategory",
+                                NULL};
+   int i;
+
+   for(i=0; categories[i] != NULL; i++)
+   {
+      if(!strcmp(categories[i], name))
+         return(TRUE);
+   }
+   return(FALSE);
+}
+
+
+/************************************************************************/
+/*>static void FinishReadPDBML(xmlTextReaderPtr reader, xmlDoc *header)
+   --------------------------------------------------------------------
+*//**
+
+   \param[in]     reader     The XML reader
+   \param[in]     *header    Document of header categories (or NULL)
+
+   Frees the XML reader and the header document. The globals set by the
+   XML parser are freed by the caller since other threads may be using
+   them.
+
+-  18.10.26 Original
+-  18.10.26 No longer calls xmlCleanupParser()
+*/
+static void FinishReadPDBML(xmlTextReaderPtr reader, xmlDoc *header)
+{
+   xmlFreeTextReader(reader);
+   if(header != NULL)
+      xmlFreeDoc(header);
+}
+
+
+/************************************************************************/
+/*>static BOOL ParseAtomSitePDBML(xmlNode *atom_node, PDB *curr_pdb,
+                                  int *model_number)
+   ------------------------------------------------------------------
+*//**
+
+   \param[in]     *atom_node     An atom_site node
+   \param[out]    *curr_pdb      PDB record for the atom
+   \param[in,out] *model_number  Model number (unchanged if the atom
+                                 does not give one)
+   \return                       Success?
+
+   Fills in a PDB record from the children of an atom_site node.
+
+-  18.10.26 Split from DoReadPDBML() so that atoms can be parsed one at
+            a time as they are read
+-  18.10.26 Name padding moved to PadAtomSiteLabels()
+-  18.10.26 Sets name codes
+*/
+static BOOL ParseAtomSitePDBML(xmlNode *atom_node, PDB *curr_pdb,
+                               int *model_number)
+{
+   xmlNode *n;
+   xmlChar *content;
+   double  content_lf;
+   BOOL    auth_seq_id_set = FALSE;  /* author residue number set       */
+
+   /* Set default values                                                */
+   CLEAR_PDB(curr_pdb);
+   strcpy(curr_pdb->chain,   "");
+   strcpy(curr_pdb->atnam,   "");
+   strcpy(curr_pdb->resnam,  "");
+   strcpy(curr_pdb->insert, " ");
+   strcpy(curr_pdb->element, "");
+   strcpy(curr_pdb->segid,   "");
+
+   /* Scan atom node children                                           */
+   for(n=atom_node->children; n!=NULL; NEXT(n))
+   {
+      if(n->type != XML_ELEMENT_NODE){ continue; }
+      content = xmlNodeGetContent(n);
+      if(content == NULL)
+      {
+         /* Error: Failed to set node content                           */
+         return(FALSE);
+      }
+      
+      /* Set PDB values                                                 */
+      if(!strcmp((char *)n->name, "B_iso_or_equiv"))
+      {
+         sscanf((char *)content, "%lf", &content_lf);
+         curr_pdb->bval = (REAL)content_lf;
+      }
+      else if(!strcmp((char *)n->name, "Cartn_x"))
+      {
+         sscanf((char *)content, "%lf", &content_lf);
+         curr_pdb->x = (REAL)content_lf;
+      }
+      else if(!strcmp((char *)n->name, "Cartn_y"))
+      {
+         sscanf((char *)content,"%lf",&content_lf);
+         curr_pdb->y = (REAL)content_lf;
+      }
+      else if(!strcmp((char *)n->name, "Cartn_z"))
+      {
+         sscanf((char *)content, "%lf", &content_lf);
+         curr_pdb->z = (REAL)content_lf;
+      }
+      else if(!strcmp((char *)n->name, "auth_asym_id"))
+      {
+         strcpy(curr_pdb->chain, (char *)content);
+      }
+      else if(!strcmp((char *)n->name, "auth_atom_id"))
+      {
+         strcpy(curr_pdb->atnam, (char *)content);
+      }
+      else if(!strcmp((char *)n->name, "auth_comp_id"))
+      {
+         strcpy(curr_pdb->resnam, (char *)content);
+      }
+      else if(!strcmp((char *)n->name, "auth_seq_id"))
+      {
+         sscanf((char *)content, "%lf", &content_lf);
+         curr_pdb->resnum = (REAL)content_lf;
+         auth_seq_id_set = TRUE;
+      }
+      else if(!strcmp((char *)n->name, "pdbx_PDB_ins_code"))
+      {
+         /* set insertion code
+            25.02.15 Changed to strncpy()  By: ACRM
+         */
+         strncpy(curr_pdb->insert, (char *)content, 8);
+      }
+      else if(!strcmp((char *)n->name, "group_PDB"))
+      {
+         /* 25.02.15 Changed to strncpy()  By: ACRM                     */
+         strncpy(curr_pdb->record_type, (char *)content, 8);
+         PADMINTERM(curr_pdb->record_type, 6);
+      }
+      else if(!strcmp((char *)n->name, "occupancy"))
+      {
+         content_lf = (REAL)0.0;     /* 25.02.15                        */
+         sscanf((char *)content, "%lf", &content_lf);
+         curr_pdb->occ = (REAL)content_lf;
+      }
+      else if(!strcmp((char *)n->name, "label_alt_id"))
+      {
+         /* Use strlen as test for alt position                         */
+         curr_pdb->altpos = strlen((char *)content) ? content[0]:' ';
+      }
+      else if(!strcmp((char *)n->name, "pdbx_PDB_model_num"))
+      {
+         content_lf = (REAL)0.0;     /* 25.02.15                        */
+         sscanf((char *)content, "%lf", &content_lf);
+         *model_number = (int)content_lf;
+      }
+      else if(!strcmp((char *)n->name, "type_symbol"))
+      {
+         /* 25.02.15 Changed to strncpy()  By: ACRM                     */
+         strncpy(curr_pdb->element, (char *)content, 8);
+      }
+      else if(!strcmp((char *)n->name, "label_asym_id"))
+      {
+         if(strlen(curr_pdb->chain) == 0)
+         {
+            /* 25.02.15 Changed to strncpy()  By: ACRM                  */
+            strncpy(curr_pdb->chain, (char *)content, 8);
+         }
+      }
+      else if(!strcmp((char *)n->name, "label_atom_id"))
+      {
+         if(strlen(curr_pdb->atnam) == 0)
+         {
+            /* 25.02.15 Changed to strncpy()  By: ACRM                  */
+            strncpy(curr_pdb->atnam, (char *)content, 8);
+         }
+      }
+      else if(!strcmp((char *)n->name, "label_comp_id"))
+      {
+         if(strlen(curr_pdb->resnam) == 0)
+         {
+            /* 25.02.15 Changed to strncpy()  By: ACRM                  */
+            strncpy(curr_pdb->resnam, (char *)content, 8);
+         }
+      }
+      else if(!strcmp((char *)n->name, "label_entity_id"))
+      {
+         if((curr_pdb->entity_id == 0) && 
+            (strlen((char *)content) > 0))
+         {
+            content_lf = (REAL)0.0;
+            sscanf((char *)content, "%lf", &content_lf);
+            curr_pdb->entity_id = (REAL)content_lf;
+         }
+      }
+      else if(!strcmp((char *)n->name, "label_seq_id"))
+      {
+         if((auth_seq_id_set == FALSE) && 
+            (strlen((char *)content) > 0))
+         {
+            content_lf = (REAL)0.0;  /* 25.02.15                        */
+            sscanf((char *)content, "%lf", &content_lf);
+            curr_pdb->resnum = (REAL)content_lf;
+         }
+      }
+      else if(!strcmp((char *)n->name, "pdbx_formal_charge"))
+      {
+         content_lf = (REAL)0.0;     /* 25.02.15                        */
+         sscanf((char *)content, "%lf", &content_lf);
+         curr_pdb->formal_charge = (int)content_lf;
+         curr_pdb->partial_charge = (REAL)content_lf;
+      }
+      else if(!strcmp((char *)n->name, "seg_id"))  /* 17.02.15          */
+      {
+         if(strlen(curr_pdb->segid) == 0)
+         {
+            /* 25.02.15 Changed to strncpy()  By: ACRM                  */
+            strncpy(curr_pdb->segid, (char *)content, 8);
+         }
       }
+
+      xmlFree(content);           
    }
    
-   if(sites_node == NULL)
+   /* Set the raw atom name and pad the names                         */
+   PadAtomSiteLabels(curr_pdb);
+   blSetPDBNameCodes(curr_pdb);
+
+   return(TRUE);
+}
+
+#endif
+
+
+/************************************************************************/
+/*>BOOL blCheckFileFormatPDBML(FILE *fp)
+   -------------------------------------
+*//**
+
+   \param[in]     *fp      A pointer to type FILE.
+   \return                 File is in PDBML format?
+
+   Simple test to detect PDBML-formatted pdb file.
+   
+   Todo: Consider replacement with general function to detect file format
+         for uncompressed file returning file type (eg pdb/pdbml/unknown).
+   
+
+-  22.04.14 Original By: CTP
+-  07.07.14 Renamed to blCheckFileFormatPDBML() By: CTP
+-  29.08.14 Function re-written to take sample from the input stream then
+            reset the stream with ungetc. By: CTP
+-  31.08.14 Bugfix: Check for 'PDBx:datablock' tag skipped if blank line 
+            before xml tag. By: CTP
+-  09.09.14 Use rewind() for DOS instead of pushing sample back on stream 
+            with ungetc(). By: CTP
+-  29.09.14 Use single character check for pdbml files for Windows or 
+            systems where ungetc() fails after pushback of singe char. 
+            By: CTP
+-  18.10.26 Sample is checked by CheckSamplePDBML()
+
+*/
+BOOL blCheckFileFormatPDBML(FILE *fp)
+{
+#if !defined(SINGLE_CHAR_FILECHECK) && !defined(MS_WINDOWS)
+
+   /* Default Filetype Check                                            */
+   char buffer[XML_SAMPLE];
+   int  i, c;
+
+   /* store sample from stream                                          */
+   for(i = 0; i < (XML_SAMPLE - 1); i++)
+   {
+      c = fgetc(fp);
+      if(c == EOF || feof(fp)) break;
+      buffer[i] = (char)c;      
+   }
+   buffer[i] = '\0'; /* terminate string                                */
+
+   /* push sample back on input stream                                  */
+   for(i = strlen(buffer) - 1; i >= 0; i--)
+   {
+      ungetc(buffer[i], fp);
+   }
+
+   return(CheckSamplePDBML(buffer));
+
+#else
+
+   /* Single Character Filetype Check                                   */
+   int c;
+
+   /* get single char from input stream                                 */
+   c = fgetc(fp);
+   if(c == EOF || feof(fp)) return FALSE;
+
+   /* pushback character                                                */
+   ungetc(c, fp);
+
+   /* detect filetype                                                   */
+   return (((char)c == '<') ? TRUE:FALSE);
+
+#endif 
+}
+
+/************************************************************************/
+/*>static BOOL CheckSamplePDBML(char *buffer)
+   ------------------------------------------
+*//**
+
+   \param[in]     *buffer  Terminated sample from the start of the file
+   \return                 Sample is from a PDBML file?
+
+   Looks for the <?xml and <PDBx:datablock tags at the start of lines in
+   the sample.
+
+-  18.10.26 Split from blCheckFileFormatPDBML()
+*/
+#if !defined(SINGLE_CHAR_FILECHECK) && !defined(MS_WINDOWS)
+static BOOL CheckSamplePDBML(char *buffer)
+{
+   int  i;
+   BOOL found_xml  = FALSE,
+        found_pdbx = FALSE;
+
+   /* check first line                                                  */
+   if(!strncmp(buffer,"<?xml ",6)) found_xml  = TRUE;
+   
+   /* check remaining lines                                             */
+   for(i = 0; i < strlen(buffer); i++)
+   {
+      if(buffer[i] != '\n') continue;
+
+      if(!strncmp(&buffer[i+1],"<?xml ",6))            found_xml  = TRUE;
+      if(!strncmp(&buffer[i+1],"<PDBx:datablock ",16)) found_pdbx = TRUE;
+   }
+
+   return ((found_xml && found_pdbx) ? TRUE : FALSE);
+}
+#endif
+
+
+/************************************************************************/
+/*>static BOOL CheckLineInputPDBML(LINEINPUT *li)
+   ----------------------------------------------
+*//**
+
+   \param[in]     *li      Line input structure
+   \return                 File is in PDBML format?
+
+   As blCheckFileFormatPDBML(), but looks ahead in data being read with
+   blGetLineInput(), so it sees decompressed data and needs no 
+   ungetc().
+
+-  18.10.26 Original
+*/
+static BOOL CheckLineInputPDBML(LINEINPUT *li)
+{
+   char *sample;
+   int  len;
+#if !defined(SINGLE_CHAR_FILECHECK) && !defined(MS_WINDOWS)
+   char buffer[XML_SAMPLE];
+
+   sample = blPeekLineInput(li, XML_SAMPLE - 1, &len);
+   memcpy(buffer, sample, len);
+   buffer[len] = '\0';
+
+   return(CheckSamplePDBML(buffer));
+#else
+   sample = blPeekLineInput(li, 1, &len);
+   return(((len > 0) && (sample[0] == '<')) ? TRUE : FALSE);
+#endif
+}
+
+/************************************************************************/
+/*>static BOOL ParseAtomRecord(char *line, int len, int fields,
+                               char *record_type, int *atnum, 
+                               char *atnam, char *resnam, char *chain,
+                               int *resnum, char *insert, double *x,
+                               double *y, double *z, double *occ,
+                               double *bval, char *segid, char *element,
+                               char *charge)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     *line        Start of the ATOM/HETATM record (need not
+                               be terminated)
+   \param[in]     len          Number of characters available in line
+   \param[in]     fields       PDBFIELD_ flags for the optional fields
+                               to decode
+   \param[out]    *record_type Record type     (cols  1- 6)
+   \param[out]    *atnum       Atom number     (cols  7-11)
+   \param[out]    *atnam       Atom name       (cols 13-17)
+   \param[out]    *resnam      Residue name    (cols 18-21)
+   \param[out]    *chain       Chain label     (col  22)
+   \param[out]    *resnum      Residue number  (cols 23-26)
+   \param[out]    *insert      Insert code     (col  27)
+   \param[out]    *x           X coordinate    (cols 31-38)
+   \param[out]    *y           Y coordinate    (cols 39-46)
+   \param[out]    *z           Z coordinate    (cols 47-54)
+   \param[out]    *occ         Occupancy       (cols 55-60)
+   \param[out]    *bval        B-value         (cols 61-66)
+   \param[out]    *segid       Segment ID      (cols 73-76)
+   \param[out]    *element     Element field   (cols 77-78)
+   \param[out]    *charge      Charge field    (cols 79-80)
+   \return                     FALSE if the line was blank
+
+   Decodes the fixed columns of an ATOM/HETATM record in place without
+   interpreting a format string. The results are exactly those that
+   fsscanf() gives with the format
+   "%6s%5d%1x%5s%4s%1s%4d%1s%3x%8lf%8lf%8lf%6lf%6lf%6x%4s%2s%2s" - in
+   particular, the line ends at a \\n or \\0, short lines give
+   space-padded strings and blank numeric fields give zero.
+
+   Optional fields which are not in fields are not touched.
+
+-  18.10.26 Original
+-  18.10.26 Added fields
+*/
+static BOOL ParseAtomRecord(char *line, int len, int fields,
+                            char *record_type, int *atnum, char *atnam,
+                            char *resnam, char *chain, int *resnum,
+                            char *insert, double *x, double *y, 
+                            double *z, double *occ, double *bval,
+                            char *segid, char *element, char *charge)
+{
+   int eol;
+
+   /* Find the end of the data as fsscanf() would see it                */
+   if(len > 80) len = 80;
+   for(eol=0; (eol < len) && line[eol] && (line[eol] != '\n'); eol++);
+
+   GetStringField(line,    FIELDLEN(eol,  0, 6), 6, record_type);
+   GetStringField(line+12, FIELDLEN(eol, 12, 5), 5, atnam);
+   GetStringField(line+21, FIELDLEN(eol, 21, 1), 1, chain);
+   GetIntField(line+22,    FIELDLEN(eol, 22, 4),    resnum);
+   GetStringField(line+26, FIELDLEN(eol, 26, 1), 1, insert);
+   GetRealField(line+54,   FIELDLEN(eol, 54, 6),    occ);
+
+   if(fields & PDBFIELD_ATNUM)
+      GetIntField(line+6,     FIELDLEN(eol,  6, 5),    atnum);
+   if(fields & PDBFIELD_RESNAM)
+      GetStringField(line+17, FIELDLEN(eol, 17, 4), 4, resnam);
+   if(fields & PDBFIELD_COORDS)
+   {
+      GetRealField(line+30,   FIELDLEN(eol, 30, 8),    x);
+      GetRealField(line+38,   FIELDLEN(eol, 38, 8),    y);
+      GetRealField(line+46,   FIELDLEN(eol, 46, 8),    z);
+   }
+   if(fields & PDBFIELD_BVAL)
+      GetRealField(line+60,   FIELDLEN(eol, 60, 6),    bval);
+   if(fields & PDBFIELD_SEGID)
+      GetStringField(line+72, FIELDLEN(eol, 72, 4), 4, segid);
+   if(fields & PDBFIELD_ELEMENT)
+   {
+      GetStringField(line+76, FIELDLEN(eol, 76, 2), 2, element);
+      GetStringField(line+78, FIELDLEN(eol, 78, 2), 2, charge);
+   }
+
+   return(eol > 0);
+}
+
+/************************************************************************/
+/*>static void GetStringField(char *field, int nchar, int width, 
+                              char *value)
+   -------------------------------------------------------------
+*//**
+
+   \param[in]     *field    Start of the field
+   \param[in]     nchar     Number of characters available in the field
+   \param[in]     width     Field width
+   \param[out]    *value    Field contents padded with spaces to width
+                            and terminated
+
+   Extracts a fixed width string field as done by fsscanf() %s
+
+-  18.10.26 Original
+*/
+static void GetStringField(char *field, int nchar, int width, 
+                           char *value)
+{
+   int i;
+
+   for(i=0; i<nchar; i++)
+      value[i] = field[i];
+   for(; i<width; i++)
+      value[i] = ' ';
+   value[width] = '\0';
+}
+
+/************************************************************************/
+/*>static void GetIntField(char *field, int nchar, int *value)
+   -----------------------------------------------------------
+*//**
+
+   \param[in]     *field    Start of the field
+   \param[in]     nchar     Number of characters available in the field
+   \param[in,out] *value    Integer value
+
+   Decodes a fixed width integer field. Simple signed integers are
+   decoded directly; anything else is handed to sscanf() so the result
+   is always identical to fsscanf() %d, including leaving the value
+   untouched if the field is not a number and setting it to zero if 
+   the field is blank.
+
+-  18.10.26 Original
+*/
+static void GetIntField(char *field, int nchar, int *value)
+{
+   char *chp = field,
+        *end = field + nchar,
+        buffer[16];
+   int  sign = 1,
+        ndigits,
+        val  = 0;
+
+   while((chp < end) && isspace((unsigned char)*chp))
+      chp++;
+   if(chp == end)
+   {
+      *value = 0;
+      return;
+   }
+
+   if((*chp == '-') || (*chp == '+'))
+   {
+      if(*chp == '-') sign = -1;
+      chp++;
+   }
+
+   for(ndigits=0; (chp < end) && isdigit((unsigned char)*chp); 
+       chp++, ndigits++)
+      val = (10 * val) + (*chp - '0');
+
+   if((ndigits > 0) && (ndigits < 10))
+   {
+      *value = sign * val;
+      return;
+   }
+
+   /* Not a simple integer so do exactly what fsscanf() does            */
+   strncpy(buffer, field, nchar);
+   buffer[nchar] = '\0';
+   if(sscanf(buffer, "%d", value) == (-1))
+      *value = 0;
+}
+
+/************************************************************************/
+/*>static void GetRealField(char *field, int nchar, double *value)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]     *field    Start of the field
+   \param[in]     nchar     Number of characters available in the field
+   \param[in,out] *value    Floating point value
+
+   Decodes a fixed width floating point field. Plain decimal numbers
+   are decoded directly as an integer mantissa divided by a power of 
+   ten. Both of these are exactly representable and IEEE division is
+   correctly rounded, so the result is bit-identical to strtod().
+   Anything else (exponents, inf, nan, etc.) is handed to sscanf() so 
+   the result is always identical to fsscanf() %lf
+
+-  18.10.26 Original
+*/
+static void GetRealField(char *field, int nchar, double *value)
+{
+   static double powersOfTen[] = {1.0e0,  1.0e1,  1.0e2,  1.0e3,
+                                  1.0e4,  1.0e5,  1.0e6,  1.0e7,
+                                  1.0e8,  1.0e9,  1.0e10, 1.0e11,
+                                  1.0e12, 1.0e13, 1.0e14, 1.0e15};
+   char   *chp = field,
+          *end = field + nchar,
+          buffer[32];
+   BOOL   negative = FALSE;
+   int    ndigits  = 0,
+          nfrac    = 0;
+   double mantissa = 0.0;
+
+   while((chp < end) && isspace((unsigned char)*chp))
+      chp++;
+   if(chp == end)
+   {
+      *value = 0.0;
+      return;
+   }
+
+   if((*chp == '-') || (*chp == '+'))
+   {
+      if(*chp == '-') negative = TRUE;
+      chp++;
+   }
+
+   for(; (chp < end) && isdigit((unsigned char)*chp); chp++, ndigits++)
+      mantissa = (10.0 * mantissa) + (double)(*chp - '0');
+
+   if((chp < end) && (*chp == '.'))
+   {
+      for(chp++; (chp < end) && isdigit((unsigned char)*chp); 
+          chp++, nfrac++)
+         mantissa = (10.0 * mantissa) + (double)(*chp - '0');
+   }
+
+   if(((ndigits + nfrac) > 0) && ((ndigits + nfrac) < 16) &&
+      ((chp == end) || !isalpha((unsigned char)*chp)))
+   {
+      mantissa /= powersOfTen[nfrac];
+      *value = negative ? -mantissa : mantissa;
+      return;
+   }
+
+   /* Not a plain decimal so do exactly what fsscanf() does             */
+   strncpy(buffer, field, nchar);
+   buffer[nchar] = '\0';
+   if(sscanf(buffer, "%lf", value) == (-1))
+      *value = 0.0;
+}
+
+/************************************************************************/
+/*>static void ProcessElementField(char *element_field, char *element)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]  element_field   Columns 77 to 78 of the ATOM/HETATM record 
+                               of pdb file.
+   \param[out] element         Element symbol.
+   
+   Get element symbol for ATOM/HETATM record.
+   
+-  04.08.14 Original By: CTP
+   
+*/
+static void ProcessElementField(char *element, char *element_field)
+{
+   char element_sym[4] = "";
+   char *element_ptr   = NULL;
+
+   /* Get element                                                       */
+   if(strlen(element_field) >= 2)
+   {
+      strncpy(element_sym, element_field, 2);
+      element_sym[2] = '\0';
+      KILLLEADSPACES(element_ptr, element_sym);
+      strcpy(element,element_ptr);
+   }
+
+   return;
+}
+
+/************************************************************************/
+/*>static void ProcessChargeField(char *element_charge, int *charge)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]  element_charge  Columns 79 to 80 of the ATOM/HETATM record 
+                               of pdb file.
+   \param[out] charge          Charge on the atom.
+   
+   Get formal charge for ATOM/HETATM record.
+
+-  04.08.14 Original By: CTP
+   
+*/
+static void ProcessChargeField(int *charge, char *charge_field)
+{
+   /* Get charge magnitude                                              */
+   if(strlen(charge_field) >= 2 && isdigit(charge_field[0]))
+   {
+      *charge = charge_field[0] - '0';
+   }
+
+   /* Get charge sign                                                   */
+   if(strlen(charge_field) >= 2 && charge_field[1] == '-')
+   {
+      *charge = *charge * -1;
+   }
+
+   return;
+}
+
+/************************************************************************/
+/*>void blFreeWholePDB(WHOLEPDB *wpdb)
+   -----------------------------------
+*//**
+
+   \param[in]     *wpdb    WHOLEPDB structure to be freed
+
+   Frees the header, trailer and atom content from a WHOLEPDB structure.
+   If these were allocated from an arena, the arena is freed instead.
+   Any indexes attached to the atoms are freed.
+
+-  30.05.02  Original   By: ACRM
+-  07.07.14  Renamed to blFreeWholePDB() By: CTP
+-  18.10.26  Frees the header index
+-  18.10.26  Frees the arena if there is one
+-  18.10.26  Frees the indexes attached to the atoms
+*/
+void blFreeWholePDB(WHOLEPDB *wpdb)
+{
+   blFreeWholePDBHeaderIndex(wpdb);
+   blDetachPDBIndexes(wpdb->pdb);
+   if(wpdb->arena != NULL)
+   {
+      blFreeArena(wpdb->arena);
+      free(wpdb);
+      return;
+   }
+   blFreeStringList(wpdb->header);
+   blFreeStringList(wpdb->trailer);
+   FREELIST(wpdb->pdb, PDB);
+   free(wpdb);
+}
+
+
+/************************************************************************/
+/*>WHOLEPDB *blReadWholePDB(FILE *fpin)
+   ------------------------------------
+*//**
+
+   \param[in]     *fpin     File pointer
+   \return                  Whole PDB structure containing linked
+                            list to PDB coordinate data
+
+   Reads a PDB file, storing the header and trailer information as
+   well as the coordinate data. Can read gzipped files as well as
+   uncompressed files.
+
+   Coordinate data is accessed as linked list of type PDB as follows:
+   
+   WHOLEPDB *wpdb;
+   PDB      *p;
+   wpdb = ReadWholePDB(fp);
+   for(p=wpdb->pdb; p!=NULL; p=p->next)
+   {
+      ... Do something with p ...
+   }
+
+-  07.03.07 Made into a wrapper to doReadWholePDB()
+-  07.07.14 Use blDoReadWholePDB() Renamed to blReadWholePDB() By: CTP
+*/
+WHOLEPDB *blReadWholePDB(FILE *fpin)
+{
+   WHOLEPDB *wpdb;
+   wpdb = blDoReadPDB(fpin, TRUE, 1, 1, TRUE);
+   wpdb->pdb = blRemoveAlternates(wpdb->pdb);
+   return(wpdb);
+}
+
+/************************************************************************/
+/*>WHOLEPDB *blReadWholePDBAtoms(FILE *fpin)
+   -----------------------------------------
+*//**
+
+   \param[in]     *fpin     File pointer
+   \return                  Whole PDB structure containing linked
+                            list to PDB coordinate data
+
+   Reads a PDB file, storing the header and trailer information as
+   well as the coordinate data. Can read gzipped files as well as
+   uncompressed files.
+
+   Coordinate data is accessed as linked list of type PDB as follows:
+   
+   WHOLEPDB *wpdb;
+   PDB      *p;
+   wpdb = ReadWholePDB(fp);
+   for(p=wpdb->pdb; p!=NULL; p=p->next)
+   {
+      ... Do something with p ...
+   }
+
+-  07.03.07 Made into a wrapper to doReadWholePDB()
+-  07.07.14 Use blDoReadWholePDB() Renamed to blReadWholePDBAtoms() 
+            By: CTP
+*/
+WHOLEPDB *blReadWholePDBAtoms(FILE *fpin)
+{
+   WHOLEPDB *wpdb;
+   wpdb = blDoReadPDB(fpin, FALSE, 1, 1, TRUE);
+   wpdb->pdb = blRemoveAlternates(wpdb->pdb);
+   return(wpdb);
+}
+
+
+/************************************************************************/
+/*>static void StoreConectRecords(WHOLEPDB *wpdb, char *buffer)
+   ------------------------------------------------------------
+*//**
+   \param[in,out]    *wpdb      Whole PDB structure
+   \param[in]        *buffer    A line containing a CONECT record
+
+   Stores the connectivity data from a CONECT record into the PDB linked
+   list
+
+-  18.02.15  Original   By: ACRM
+-  05.03.15  Initialize all connected atoms to NULL and check for NULLs
+             when storing the CONECTs. This deals with cases where an
+             atom specified in a CONECT record has alternate occupancies
+             and an alternate position is removed. Previously this led
+             to core dumps. e.g. PDB code 3pnw
+*/
+static void StoreConectRecords(WHOLEPDB *wpdb, char *buffer)
+{
+   char record_type[8];
+   int  i, j,
+        nConect,
+        atoms[5];
+   PDB  *p,
+        *atomsP[5];
+   BOOL gotLink;
+
+   fsscanf(buffer,"%6s%5d%5d%5d%5d%5d", 
+           record_type,&atoms[0],&atoms[1],&atoms[2],&atoms[3],&atoms[4]);
+
+   /* Find the PDB pointers for the (up to) 5 CONECT atoms              */
+   nConect = 0;
+   for(i=0; i<5; i++)
    {
-      /* Error: Failed to find atom sites                               */
-      xmlFreeDoc(document); /* free document                            */
-      xmlCleanupParser();   /* clean up xml parser                      */
-      wpdb->natoms = -1;    /* indicate error                           */
-      return(wpdb);         /* return wpdb                              */
-   }
+      /* Have we run out of specified atoms?                            */
+      if(atoms[i] == 0)
+         break;
 
+      atomsP[i] = NULL;                                 /* 05.03.15     */
 
-   /* Scan through atom nodes and populate PDB list.                    */
-   for(atom_node = sites_node->children; atom_node; 
-       atom_node = atom_node->next)
-   {
-      if(!strcmp("atom_site", (char *)atom_node->name))
+      /* Look for this atom                                             */
+      for(p=wpdb->pdb; p!=NULL; NEXT(p))
       {
-         /* Current PDB                                                 */
-         INIT(curr_pdb,PDB);
-         
-         if(curr_pdb == NULL)
+         if(atoms[i] == p->atnum)
          {
-            /* Error: Failed to store atom in pdb list                  */
-            FREELIST(wpdb->pdb,PDB); /* free pdb list                   */
-            xmlFreeDoc(document);    /* free document                   */
-            xmlCleanupParser();      /* clean up xml parser             */
-            wpdb->natoms = -1;       /* indicate error                  */
-            return(wpdb);            /* return wpdb                     */
+            /* Found it so store and break out                          */
+            atomsP[i] = p;
+            nConect++;
+            break;
          }
+      }
+   }
 
-         /* Set default values                                          */
-         CLEAR_PDB(curr_pdb);
-         strcpy(curr_pdb->chain,   "");
-         strcpy(curr_pdb->atnam,   "");
-         strcpy(curr_pdb->resnam,  "");
-         strcpy(curr_pdb->insert, " ");
-         strcpy(curr_pdb->element, "");
-         strcpy(curr_pdb->segid,   "");
-         auth_seq_id_set = FALSE;          /* author residue number set */
-
-         /* Scan atom node children                                     */
-         for(n=atom_node->children; n!=NULL; NEXT(n))
+   /* Set the connections from atom 0                                   */
+   if(atomsP[0] != NULL)                                /* 05.03.15     */
+   {
+      for(i=1; i<nConect; i++)
+      {
+         /* Look to see if we have this conect stored already           */
+         gotLink = FALSE;
+         for(j=0; j<atomsP[0]->nConect; j++)
          {
-            if(n->type != XML_ELEMENT_NODE){ continue; }
-            content = xmlNodeGetContent(n);
-            if(content == NULL)
-            {
-               /* Error: Failed to set node content                     */
-               FREELIST(wpdb->pdb,PDB); /* free pdb list                */
-               xmlFreeDoc(document);    /* free document                */
-               xmlCleanupParser();      /* clean up xml parser          */
-               wpdb->natoms = -1;       /* indicate error               */
-               return(wpdb);            /* return wpdb                  */
-            }
-            
-            /* Set PDB values                                           */
-            if(!strcmp((char *)n->name, "B_iso_or_equiv"))
-            {
-               sscanf((char *)content, "%lf", &content_lf);
-               curr_pdb->bval = (REAL)content_lf;
-            }
-            else if(!strcmp((char *)n->name, "Cartn_x"))
-            {
-               sscanf((char *)content, "%lf", &content_lf);
-               curr_pdb->x = (REAL)content_lf;
-            }
-            else if(!strcmp((char *)n->name, "Cartn_y"))
-            {
-               sscanf((char *)content,"%lf",&content_lf);
-               curr_pdb->y = (REAL)content_lf;
-            }
-            else if(!strcmp((char *)n->name, "Cartn_z"))
-            {
-               sscanf((char *)content, "%lf", &content_lf);
-               curr_pdb->z = (REAL)content_lf;
-            }
-            else if(!strcmp((char *)n->name, "auth_asym_id"))
-            {
-               strcpy(curr_pdb->chain, (char *)content);
-            }
-            else if(!strcmp((char *)n->name, "auth_atom_id"))
-            {
-               strcpy(curr_pdb->atnam, (char *)content);
-            }
-            else if(!strcmp((char *)n->name, "auth_comp_id"))
-            {
-               strcpy(curr_pdb->resnam, (char *)content);
-            }
-            else if(!strcmp((char *)n->name, "auth_seq_id"))
-            {
-               sscanf((char *)content, "%lf", &content_lf);
-               curr_pdb->resnum = (REAL)content_lf;
-               auth_seq_id_set = TRUE;
-            }
-            else if(!strcmp((char *)n->name, "pdbx_PDB_ins_code"))
-            {
-               /* set insertion code
-                  25.02.15 Changed to strncpy()  By: ACRM
-               */
-               strncpy(curr_pdb->insert, (char *)content, 8);
-            }
-            else if(!strcmp((char *)n->name, "group_PDB"))
-            {
-               /* 25.02.15 Changed to strncpy()  By: ACRM               */
-               strncpy(curr_pdb->record_type, (char *)content, 8);
-               PADMINTERM(curr_pdb->record_type, 6);
-            }
-            else if(!strcmp((char *)n->name, "occupancy"))
-            {
-               content_lf = (REAL)0.0;     /* 25.02.15                  */
-               sscanf((char *)content, "%lf", &content_lf);
-               curr_pdb->occ = (REAL)content_lf;
-            }
-            else if(!strcmp((char *)n->name, "label_alt_id"))
-            {
-               /* Use strlen as test for alt position                   */
-               curr_pdb->altpos = strlen((char *)content) ? content[0]:' ';
-            }
-            else if(!strcmp((char *)n->name, "pdbx_PDB_model_num"))
-            {
-               content_lf = (REAL)0.0;     /* 25.02.15                  */
-               sscanf((char *)content, "%lf", &content_lf);
-               model_number = (int)content_lf;
-            }
-            else if(!strcmp((char *)n->name, "type_symbol"))
-            {
-               /* 25.02.15 Changed to strncpy()  By: ACRM               */
-               strncpy(curr_pdb->element, (char *)content, 8);
-            }
-            else if(!strcmp((char *)n->name, "label_asym_id"))
-            {
-               if(strlen(curr_pdb->chain) == 0)
-               {
-                  /* 25.02.15 Changed to strncpy()  By: ACRM            */
-                  strncpy(curr_pdb->chain, (char *)content, 8);
-               }
-            }
-            else if(!strcmp((char *)n->name, "label_atom_id"))
-            {
-               if(strlen(curr_pdb->atnam) == 0)
-               {
-                  /* 25.02.15 Changed to strncpy()  By: ACRM            */
-                  strncpy(curr_pdb->atnam, (char *)content, 8);
-               }
-            }
-            else if(!strcmp((char *)n->name, "label_comp_id"))
+            if(atomsP[i] != NULL)                       /* 05.03.15     */
             {
-               if(strlen(curr_pdb->resnam) == 0)
+               if(atomsP[0]->conect[j] == atomsP[i])
                {
-                  /* 25.02.15 Changed to strncpy()  By: ACRM            */
-                  strncpy(curr_pdb->resnam, (char *)content, 8);
+                  gotLink = TRUE;
+                  break;
                }
             }
-            else if(!strcmp((char *)n->name, "label_entity_id"))
+         }
+         
+         /* If not then store it                                        */
+         if(!gotLink && (atomsP[0]->nConect < MAXCONECT))
+         {
+            if(atomsP[i] != NULL)                       /* 05.03.15     */
             {
-               if((curr_pdb->entity_id == 0) && 
-                  (strlen((char *)content) > 0))
-               {
-                  content_lf = (REAL)0.0;
-                  sscanf((char *)content, "%lf", &content_lf);
-                  curr_pdb->entity_id = (REAL)content_lf;
-               }
+               atomsP[0]->conect[atomsP[0]->nConect] = atomsP[i];
+               (atomsP[0]->nConect)++;
             }
-            else if(!strcmp((char *)n->name, "label_seq_id"))
+         }
+      }
+
+      /* Set the connections in the other direction                     */
+      for(i=1; i<nConect; i++)
+      {
+         if(atomsP[i] != NULL)                          /* 05.03.15     */
+         {
+            /* Look to see if we have this conect stored already        */
+            gotLink = FALSE;
+            for(j=0; j<atomsP[i]->nConect; j++)
             {
-               if((auth_seq_id_set == FALSE) && 
-                  (strlen((char *)content) > 0))
+               if(atomsP[i]->conect[j] == atomsP[0])
                {
-                  content_lf = (REAL)0.0;  /* 25.02.15                  */
-                  sscanf((char *)content, "%lf", &content_lf);
-                  curr_pdb->resnum = (REAL)content_lf;
+                  gotLink = TRUE;
+                  break;
                }
             }
-            else if(!strcmp((char *)n->name, "pdbx_formal_charge"))
-            {
-               content_lf = (REAL)0.0;     /* 25.02.15                  */
-               sscanf((char *)content, "%lf", &content_lf);
-               curr_pdb->formal_charge = (int)content_lf;
-               curr_pdb->partial_charge = (REAL)content_lf;
-            }
-            else if(!strcmp((char *)n->name, "seg_id"))  /* 17.02.15    */
+            
+            /* If not then store it                                     */
+            if(!gotLink && (atomsP[i]->nConect < MAXCONECT))
             {
-               if(strlen(curr_pdb->segid) == 0)
-               {
-                  /* 25.02.15 Changed to strncpy()  By: ACRM            */
-                  strncpy(curr_pdb->segid, (char *)content, 8);
-               }
+               atomsP[i]->conect[atomsP[i]->nConect] = atomsP[0];
+               (atomsP[i]->nConect)++;
             }
-
-            xmlFree(content);           
          }
-         
-         /* Set raw atom name
-            Note: The text pdb format uses columns 13-16 to store the atom
-                  name. By convention, columns 13-14 contain the 
-                  right-justified element symbol for the atom.
-                  
-                  The raw atom name is equivalent to colums 13-16 of a
-                  pdb-formatted text file .                             
-         */
+      }
+   }
+}
 
-         if(strlen(curr_pdb->atnam) == 1)
-         {
-            /* copy 1-letter name atnam_raw                             */
-            strcpy((curr_pdb->atnam_raw), " ");
-            /* 25.02.15 Changed to strncpy()  By: ACRM                  */
-            strncpy((curr_pdb->atnam_raw)+1, curr_pdb->atnam, 7);
-         }
-         if(strlen(curr_pdb->atnam) == 4)
-         {
-            /* copy 4-letter name atnam_raw                             */
-            /* 25.02.15 Changed to strncpy()  By: ACRM                  */
-            strncpy(curr_pdb->atnam_raw, curr_pdb->atnam, 8);
-         }
-         else if(strlen(curr_pdb->element) == 1)
-         {
-            strcpy((curr_pdb->atnam_raw),               " ");
-            /* 25.02.15 Changed to strncpy()  By: ACRM                  */
-            strncpy((curr_pdb->atnam_raw)+1, curr_pdb->atnam, 7);
-         }
-         else
-         {
-            /* 25.02.15 Changed to strncpy()  By: ACRM                  */
-            strncpy(curr_pdb->atnam_raw, curr_pdb->atnam, 4);
-         }
-         
-         /* Pad atom names to 4 characters                              */
-         PADMINTERM(curr_pdb->atnam,     4);
-         PADMINTERM(curr_pdb->atnam_raw, 4);
-         
-         /* Pad Residue Name
-            Note: The text pdb format uses columns 18-20 to store the 
-                  residue name (right-justified).
-                  
-                  curr_pdb->resnam is is equivalent to colums 18-21 of a
-                  pdb-formatted text file.                              
-         */
-         sprintf(pad_resnam, "%3s", curr_pdb->resnam);
-         PADMINTERM(pad_resnam, 4);
-         /* 25.02.15 Changed to strncpy()  By: ACRM                     */
-         strncpy(curr_pdb->resnam, pad_resnam, 8);
-         
-         /* Set chain to " " if not already set                         */
-         if(strlen(curr_pdb->chain) == 0)
-         {
-            strcpy(curr_pdb->chain, " ");
-         }
+/************************************************************************/
+/*>WHOLEPDB *blDoReadMMCIF(FILE *fpin, BOOL AllAtoms, int OccRank,
+                           int ModelNum, BOOL DoWhole)
+   ---------------------------------------------------------------
+*//**
 
-         /* Pad the segment id                                          */
-         PADMINTERM(curr_pdb->segid, 4);
+   \param[in]     *fpin      A pointer to type FILE in which the
+                             mmCIF file is stored.
+   \param[in]     AllAtoms   TRUE:  ATOM & HETATM records
+                             FALSE: ATOM records only
+   \param[in]     OccRank    Occupancy ranking
+   \param[in]     ModelNum   NMR Model number (0 = all)
+   \param[in]     DoWhole    Read the whole PDB file rather than just
+                             the ATOM/HETATM records
+   \return                   A pointer to the malloc()'d WHOLEPDB
+                             structure. NULL on failure.
+
+   Reads the atom_site loop of an mmCIF file into a PDB linked list. The
+   parameters have the same meanings as for blDoReadPDB(), which calls
+   the same code when it finds an mmCIF file, so this need only be used
+   if the format is known. The file is memory mapped if possible and
+   may be gzipped if ZLIB_SUPPORT is defined.
+
+   The column names of the loop are matched once and each value is then
+   stored straight into the PDB record for its column without being
+   copied. Author (auth_) names and numbering are used in preference to
+   the label_ versions, as in the PDB format. If DoWhole is set,
+   HEADER, TITLE and CRYST1 records are made from the corresponding
+   mmCIF items; other header data are not read.
+
+-  18.10.26 Original
+-  18.10.26 Sets the globals from the flags returned by DoReadMMCIF()
+-  18.10.26 Indexes the header
+*/
+WHOLEPDB *blDoReadMMCIF(FILE *fpin,
+                        BOOL AllAtoms,
+                        int  OccRank,
+                        int  ModelNum,
+                        BOOL DoWhole)
+{
+   LINEINPUT    *li;
+   WHOLEPDB     *wpdb;
+   PDBREADSTATE state;
 
-         /* Set multi-model flag                                        */
-         if(model_number > 1)
-         {
-            gPDBMultiNMR = TRUE;
-         }
+   if((li = blOpenLineInput(fpin, MMCIF_MAXLINE))==NULL)
+      return(NULL);
 
-         /* Filter: Model Number                                        */
-         if(model_number != ModelNum)
-         {
-            /* Free curr_pdb                                            */
-            FREELIST(curr_pdb,PDB);
-            curr_pdb = NULL;
-            
-            if(model_number > ModelNum)
-            {
-               break;    /* skip rest of tree                           */
-            }
-            else
-            {
-               continue; /* filter                                      */
-            }
-         }
+   wpdb = DoReadMMCIF(li, AllAtoms, OccRank, ModelNum, DoWhole, &state);
+   blCloseLineInput(li);
+   if((wpdb != NULL) && DoWhole)
+      blIndexWholePDBHeader(wpdb);
+   SetReadPDBGlobals(&state);
 
+   return(wpdb);
+}
 
-         /* Filter: All Atoms                                           */
-         if(!AllAtoms && strncmp(curr_pdb->record_type, "ATOM  ", 6))
-         {
-            /* Free curr_pdb and skip atom                              */
-            FREELIST(curr_pdb,PDB);
-            curr_pdb = NULL;
-            continue;    /* filter                                      */
-         }
+
+/************************************************************************/
+/*>WHOLEPDB *blReadWholeMMCIF(FILE *fpin)
+   --------------------------------------
+*//**
+
+   \param[in]     *fpin      A pointer to type FILE in which the
+                             mmCIF file is stored.
+   \return                   A pointer to the malloc()'d WHOLEPDB
+                             structure. NULL on failure.
+
+   Reads an mmCIF file as blReadWholePDB() reads a PDB file: all atoms
+   of the first model are read keeping the highest occupancy alternate
+   positions, and the header records are made.
+
+-  18.10.26 Original
+*/
+WHOLEPDB *blReadWholeMMCIF(FILE *fpin)
+{
+   WHOLEPDB *wpdb;
+
+   if((wpdb = blDoReadMMCIF(fpin, TRUE, 1, 1, TRUE))!=NULL)
+      wpdb->pdb = blRemoveAlternates(wpdb->pdb);
+   return(wpdb);
+}
+
+
+/************************************************************************/
+/*>static WHOLEPDB *DoReadMMCIF(LINEINPUT *li, BOOL AllAtoms,
+                                int OccRank, int ModelNum, BOOL DoWhole,
+                                PDBREADSTATE *state)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     *li        Line input for the file
+   \param[in]     AllAtoms   TRUE:  ATOM & HETATM records
+                             FALSE: ATOM records only
+   \param[in]     OccRank    Occupancy ranking
+   \param[in]     ModelNum   NMR Model number (0 = all)
+   \param[in]     DoWhole    Make the header records
+   \param[out]    *state     Flags describing the file
+   \return                   A pointer to the malloc()'d WHOLEPDB
+                             structure. NULL on failure.
+
+   Does the work for blDoReadMMCIF(). Only the first data block is read.
+   The line length is increased to the maximum allowed in a CIF file so
+   this can carry on from the line input used by blDoReadPDB() to check
+   the file format.
+
+-  18.10.26 Original
+-  18.10.26 Sets flags in state rather than globals
+*/
+static WHOLEPDB *DoReadMMCIF(LINEINPUT *li, BOOL AllAtoms, int OccRank,
+                             int ModelNum, BOOL DoWhole,
+                             PDBREADSTATE *state)
+{
+   MMCIFTOKENS ct;
+   MMCIFREAD   rd;
+   int         i,
+               item;
+   BOOL        ok       = TRUE,
+               gotBlock = FALSE;
+
+   if(!blResizeLineInput(li, MMCIF_MAXLINE))
+      return(NULL);
+
+   if((rd.wpdb=(WHOLEPDB *)malloc(sizeof(WHOLEPDB)))==NULL)
+      return(NULL);
+
+   rd.wpdb->pdb         = NULL;
+   rd.wpdb->header      = NULL;
+   rd.wpdb->trailer     = NULL;
+   rd.wpdb->headerIndex = NULL;
+   rd.wpdb->arena       = NULL;
+   rd.wpdb->natoms      = 0;
+   rd.end           = NULL;
+   rd.items         = NULL;
+   rd.maxItems      = 0;
+   rd.CurAtom[0]    = '\0';
+   rd.CurIns        = ' ';
+   rd.CurRes        = 0;
+   rd.NPartial      = 0;
+   rd.model         = 1;
+   rd.CurModel      = 0;
+   rd.ModelCount    = 0;
+   rd.OccRank       = OccRank;
+   rd.ModelNum      = ModelNum;
+   rd.AllAtoms      = AllAtoms;
+   rd.DoWhole       = DoWhole;
+   rd.state         = state;
+   for(i=0; i<MMCIF_NHEADER; i++)
+      rd.header[i] = NULL;
+
+   ct.li       = li;
+   ct.line     = NULL;
+   ct.token    = NULL;
+   ct.text     = NULL;
+   ct.len      = 0;
+   ct.pos      = 0;
+   ct.tokenLen = 0;
+   ct.textSize = 0;
+   ct.quoted   = FALSE;
+   ct.pushed   = FALSE;
+
+   state->partialOcc    = FALSE;
+   state->multiNMR      = 0;
+   state->xml           = FALSE;
+   state->modelNotFound = TRUE;
+
+   while(ok && GetTokenMMCIF(&ct))
+   {
+      if(ct.quoted)
+         continue;
+
+      if(LINEINPUTMATCH(ct.token, ct.tokenLen, "data_", 5))
+      {
+         /* Stop at the start of a second data block                    */
+         if(gotBlock)
+            break;
+         gotBlock = TRUE;
+      }
+      else if(LINEINPUTMATCH(ct.token, ct.tokenLen, "loop_", 5))
+      {
+         ok = ReadLoopMMCIF(&ct, &rd);
+      }
+      else if(ct.token[0] == '_')
+      {
+         /* A single item followed by its value                         */
+         item = FindItemMMCIF(ct.token, ct.tokenLen, sHeaderItemsMMCIF);
+         if(!GetTokenMMCIF(&ct))
+            break;
+         if(item >= 0)
+            ok = StoreHeaderItemMMCIF(&rd, item, &ct);
+      }
+   }
+
+   /* Store the last partial occupancy atom                             */
+   if(ok && (rd.NPartial != 0))
+      ok = StoreOccRankAtom(OccRank, rd.multi, rd.NPartial,
+                            &(rd.wpdb->pdb), &(rd.end),
+                            &(rd.wpdb->natoms), NULL);
+
+   if(ok && DoWhole)
+      ok = BuildHeaderMMCIF(&rd);
+
+   if(rd.ModelCount > 1)
+      state->multiNMR = rd.ModelCount;
+
+   for(i=0; i<MMCIF_NHEADER; i++)
+   {
+      FREE(rd.header[i]);
+   }
+   FREE(rd.items);
+   FREE(ct.text);
+
+   if(!ok)
+   {
+      blFreeWholePDB(rd.wpdb);
+      return(NULL);
+   }
+
+   return(rd.wpdb);
+}
 
 
-         /* Add partial occ atom from temp storage to output PDB list   */
-         if((NPartial != 0) && strcmp(curr_pdb->atnam,store_atnam))
+/************************************************************************/
+/*>static BOOL GetTokenMMCIF(MMCIFTOKENS *ct)
+   ------------------------------------------
+*//**
+
+   \param[in,out] *ct       Tokeniser state
+   \return                  Was a token found? FALSE at end of file
+
+   Gets the next token from a CIF file, skipping white space and
+   comments. ct->token is set to point to the token in the line being
+   read (or into ct->text for a multi-line text field) and is not
+   terminated. Quotes are removed and ct->quoted is set so that quoted
+   values are not taken as keywords, data names or null values. If
+   ct->pushed is set, the last token is returned again.
+
+-  18.10.26 Original
+*/
+static BOOL GetTokenMMCIF(MMCIFTOKENS *ct)
+{
+   char quote;
+   int  start;
+
+   if(ct->pushed)
+   {
+      ct->pushed = FALSE;
+      return(TRUE);
+   }
+
+   for(;;)
+   {
+      if((ct->line == NULL) || (ct->pos >= ct->len))
+      {
+         if((ct->line = blGetLineInput(ct->li, &(ct->len)))==NULL)
+            return(FALSE);
+         ct->pos = 0;
+
+         /* A semicolon at the start of a line starts a text field      */
+         if(ct->line[0] == ';')
+            return(GetTextFieldMMCIF(ct));
+      }
+
+      while((ct->pos < ct->len) &&
+            isspace((unsigned char)ct->line[ct->pos]))
+         ct->pos++;
+      if(ct->pos == ct->len)
+         continue;
+
+      /* Comments run to the end of the line                            */
+      if(ct->line[ct->pos] == '#')
+      {
+         ct->pos = ct->len;
+         continue;
+      }
+
+      if((ct->line[ct->pos] == '\'') || (ct->line[ct->pos] == '"'))
+      {
+         /* A quote only closes the string if it is followed by white
+            space, so 'O5'' style names need no escapes
+         */
+         quote = ct->line[ct->pos++];
+         start = ct->pos;
+         while((ct->pos < ct->len) &&
+               !((ct->line[ct->pos] == quote) &&
+                 ((ct->pos + 1 == ct->len) ||
+                  isspace((unsigned char)ct->line[ct->pos + 1]))))
+            ct->pos++;
+
+         ct->token    = ct->line + start;
+         ct->tokenLen = ct->pos - start;
+         ct->quoted   = TRUE;
+
+         if(ct->pos < ct->len)
          {
-            /* Store atom                                               */
-            if(StoreOccRankAtom(OccRank,multi,NPartial,&wpdb->pdb,
-                                  &end_pdb,&wpdb->natoms))
-            {
-               LAST(end_pdb);
-               NPartial = 0;
-            }
-            else
-            {
-               /* Error: Failed to store partial occ atom               */
-               FREELIST(curr_pdb,PDB);  /* free curr_pdb                */
-               FREELIST(wpdb->pdb,PDB); /* free pdb list                */
-               xmlFreeDoc(document);    /* free document                */
-               xmlCleanupParser();      /* clean up xml parser          */
-               wpdb->natoms = -1;       /* indicate error               */
-               return(wpdb);            /* return wpdb                  */
-            }
+            ct->pos++;                     /* Skip the closing quote    */
+         }
+         else                              /* Unterminated              */
+         {
+            while((ct->tokenLen > 0) &&
+                  isspace((unsigned char)ct->token[ct->tokenLen-1]))
+               ct->tokenLen--;
          }
+         return(TRUE);
+      }
 
+      start = ct->pos;
+      while((ct->pos < ct->len) &&
+            !isspace((unsigned char)ct->line[ct->pos]))
+         ct->pos++;
 
-         /* Set atom number
-            Note: Cannot use atom site id for atom number so base atnum on
-                  number of atoms stored 
+      ct->token    = ct->line + start;
+      ct->tokenLen = ct->pos - start;
+      ct->quoted   = FALSE;
+      return(TRUE);
+   }
+}
 
-            25.02.15 We will renumber afterwards
-         */
-         /*curr_pdb->atnum = *natom + 1;*/
-         curr_pdb->atnum = natom + 1;
-         
-         
-         /* Add partial occupancy atom to temp storage                  */
-         if((curr_pdb->altpos != ' ') && (NPartial < MAXPARTIAL))
-         {
-            /* Copy the partial atom data to storage                    */
-            blCopyPDB(&multi[NPartial], curr_pdb);
 
-            /* Set global partial occupancy flag                        */
-            gPDBPartialOcc = TRUE;
-            
-            /* Store current atom name                                  */
-            /* 25.02.15 Changed to strncpy()  By: ACRM                  */
-            strncpy(store_atnam, curr_pdb->atnam, 8);
-            NPartial++;
+/************************************************************************/
+/*>static BOOL GetTextFieldMMCIF(MMCIFTOKENS *ct)
+   ----------------------------------------------
+*//**
 
-            /* Free curr_pdb and continue                               */
-            FREELIST(curr_pdb,PDB);
-            curr_pdb = NULL;
-            continue;
-         }
+   \param[in,out] *ct       Tokeniser state with the line starting the
+                            text field
+   \return                  Was the field stored?
 
-         
-         /* Store Atom                                                  */
-         if(wpdb->pdb == NULL)
-         {
-            /* store first atom                                         */
-            /*pdb        = curr_pdb;*/
-            wpdb->pdb    = curr_pdb;
-            end_pdb      = curr_pdb;
-            curr_pdb     = NULL;
-            wpdb->natoms = 1;
-         }
-         else
+   Reads a text field which runs from a semicolon at the start of a line
+   to the next line starting with a semicolon. Since it covers several
+   lines, it is copied into ct->text with the lines joined by spaces.
+
+-  18.10.26 Original
+*/
+static BOOL GetTextFieldMMCIF(MMCIFTOKENS *ct)
+{
+   char *chunk,
+        *text;
+   int  chunkLen,
+        nchar = 0;
+
+   chunk    = ct->line + 1;
+   chunkLen = ct->len  - 1;
+
+   for(;;)
+   {
+      while((chunkLen > 0) && isspace((unsigned char)chunk[chunkLen-1]))
+         chunkLen--;
+
+      if(chunkLen > 0)
+      {
+         if((nchar + chunkLen + 2) > ct->textSize)
          {
-            /* store subsequent atoms                                   */
-            end_pdb->next = curr_pdb;
-            end_pdb       = curr_pdb;
-            curr_pdb      = NULL;
-            wpdb->natoms += 1;
+            if((text = (char *)realloc(ct->text,
+                                       2 * (nchar + chunkLen + 2) *
+                                       sizeof(char)))==NULL)
+               return(FALSE);
+            ct->text     = text;
+            ct->textSize = 2 * (nchar + chunkLen + 2);
          }
+         if(nchar)
+            ct->text[nchar++] = ' ';
+         memcpy(ct->text + nchar, chunk, chunkLen);
+         nchar += chunkLen;
       }
-   }
-      
 
-   /* Store final atom (if partial occupancy)                           */
-   if(NPartial != 0)
-   {
-      if(!StoreOccRankAtom(OccRank,multi,NPartial,&wpdb->pdb,&end_pdb,
-                             &wpdb->natoms))
+      if((ct->line = blGetLineInput(ct->li, &(ct->len)))==NULL)
+         break;
+
+      /* Carry on reading tokens after the closing semicolon            */
+      if(ct->line[0] == ';')
       {
-         /* Error: Failed to store atom in pdb list                     */
-         FREELIST(wpdb->pdb,PDB); /* free pdb list                      */
-         xmlFreeDoc(document);    /* free document                      */
-         xmlCleanupParser();      /* clean up xml parser                */
-         wpdb->natoms = -1;       /* indicate error                     */
-         return(wpdb);            /* return wpdb                        */
+         ct->pos = 1;
+         break;
       }
-   }
-   
-   /* Check atoms have been stored                                      */
-   if(wpdb->pdb == NULL || wpdb->natoms == 0)
-   {
-      /* Error: pdb list empty or no atoms stored                       */
-      FREELIST(wpdb->pdb,PDB); /* free pdb list                         */
-      xmlFreeDoc(document);    /* free document                         */
-      xmlCleanupParser();      /* clean up xml parser                   */
-      wpdb->natoms = -1;       /* indicate error                        */
-      return(wpdb);            /* return wpdb                           */
+      chunk    = ct->line;
+      chunkLen = ct->len;
    }
 
-   /* 25.02.15 Renumber atoms since we don't use the atom site IDs      */
-   blRenumAtomsPDB(wpdb->pdb, 1);
+   ct->token    = (nchar ? ct->text : "");
+   ct->tokenLen = nchar;
+   ct->quoted   = TRUE;
+   return(TRUE);
+}
 
 
-   /* Parse header data and CONECT nodes for whole pdb                  */
-   if(DoWhole)
-   {
-      /* Parse CONECT Nodes                                             */
-      ParseConectPDBML(document, wpdb->pdb);
-   
-      /* Parse Header Data                                              */
-      ParseHeaderRecordsPDBML(wpdb, document);
-   }
+/************************************************************************/
+/*>static int FindItemMMCIF(char *token, int len, char **items)
+   ------------------------------------------------------------
+*//**
 
+   \param[in]     *token    Data name (need not be terminated)
+   \param[in]     len       Length of the data name
+   \param[in]     **items   NULL-terminated list of names
+   \return                  Offset of the name in items, -1 if not there
 
-   /* Free document and globals set by XML parser                       */
-   xmlFreeDoc(document);
-   xmlCleanupParser();
-      
-   /* Return WHOLEPDB                                                   */
-   return(wpdb);
+   Looks up a data name.
 
-#endif
+-  18.10.26 Original
+*/
+static int FindItemMMCIF(char *token, int len, char **items)
+{
+   int i;
+
+   for(i=0; items[i] != NULL; i++)
+   {
+      if(((int)strlen(items[i]) == len) && !strncmp(items[i], token, len))
+         return(i);
+   }
+   return(-1);
 }
 
 
 /************************************************************************/
-/*>BOOL blCheckFileFormatPDBML(FILE *fp)
-   -------------------------------------
+/*>static BOOL ReadLoopMMCIF(MMCIFTOKENS *ct, MMCIFREAD *rd)
+   ---------------------------------------------------------
 *//**
 
-   \param[in]     *fp      A pointer to type FILE.
-   \return                 File is in PDBML format?
-
-   Simple test to detect PDBML-formatted pdb file.
-   
-   Todo: Consider replacement with general function to detect file format
-         for uncompressed file returning file type (eg pdb/pdbml/unknown).
-   
+   \param[in,out] *ct       Tokeniser state following a loop_ keyword
+   \param[in,out] *rd       Reading state
+   \return                  Success? FALSE only if memory ran out
 
--  22.04.14 Original By: CTP
--  07.07.14 Renamed to blCheckFileFormatPDBML() By: CTP
--  29.08.14 Function re-written to take sample from the input stream then
-            reset the stream with ungetc. By: CTP
--  31.08.14 Bugfix: Check for 'PDBx:datablock' tag skipped if blank line 
-            before xml tag. By: CTP
--  09.09.14 Use rewind() for DOS instead of pushing sample back on stream 
-            with ungetc(). By: CTP
--  29.09.14 Use single character check for pdbml files for Windows or 
-            systems where ungetc() fails after pushback of singe char. 
-            By: CTP
+   Reads a loop. The column names are looked up once to find the item
+   for each column and the values are then handed out in turn. In the
+   atom_site loop every row is an atom; in other loops only the first
+   row is used, for items needed for the header.
 
+-  18.10.26 Original
 */
-BOOL blCheckFileFormatPDBML(FILE *fp)
+static BOOL ReadLoopMMCIF(MMCIFTOKENS *ct, MMCIFREAD *rd)
 {
-#if !defined(SINGLE_CHAR_FILECHECK) && !defined(MS_WINDOWS)
+   int  *items,
+        ncols = 0,
+        col   = 0;
+   BOOL atomSite = FALSE,
+        firstRow = TRUE;
+
+   /* Column names                                                      */
+   while(GetTokenMMCIF(ct))
+   {
+      if(ct->quoted || (ct->tokenLen == 0) || (ct->token[0] != '_'))
+      {
+         ct->pushed = TRUE;
+         break;
+      }
 
-   /* Default Filetype Check                                            */
-   char buffer[XML_SAMPLE];
-   int  i, c;
-   BOOL found_xml  = FALSE,
-        found_pdbx = FALSE;
+      if(ncols == rd->maxItems)
+      {
+         if((items = (int *)realloc(rd->items, (rd->maxItems + 32) *
+                                    sizeof(int)))==NULL)
+            return(FALSE);
+         rd->items     = items;
+         rd->maxItems += 32;
+      }
 
-   /* store sample from stream                                          */
-   for(i = 0; i < (XML_SAMPLE - 1); i++)
-   {
-      c = fgetc(fp);
-      if(c == EOF || feof(fp)) break;
-      buffer[i] = (char)c;      
+      if(LINEINPUTMATCH(ct->token, ct->tokenLen, "_atom_site.", 11))
+      {
+         atomSite = TRUE;
+         rd->items[ncols++] = FindItemMMCIF(ct->token + 11,
+                                            ct->tokenLen - 11,
+                                            sAtomSiteItemsMMCIF);
+      }
+      else
+      {
+         rd->items[ncols++] = FindItemMMCIF(ct->token, ct->tokenLen,
+                                            sHeaderItemsMMCIF);
+      }
    }
-   buffer[i] = '\0'; /* terminate string                                */
 
-   /* push sample back on input stream                                  */
-   for(i = strlen(buffer) - 1; i >= 0; i--)
-   {
-      ungetc(buffer[i], fp);
-   }
+   if(ncols == 0)
+      return(TRUE);
 
-   /* check first line                                                  */
-   if(!strncmp(buffer,"<?xml ",6)) found_xml  = TRUE;
-   
-   /* check remaining lines                                             */
-   for(i = 0; i < strlen(buffer); i++)
+   /* Values until the next keyword or data name                        */
+   while(GetTokenMMCIF(ct))
    {
-      if(buffer[i] != '\n') continue;
+      if(!ct->quoted &&
+         ((ct->token[0] == '_') ||
+          LINEINPUTMATCH(ct->token, ct->tokenLen, "loop_", 5) ||
+          LINEINPUTMATCH(ct->token, ct->tokenLen, "data_", 5)))
+      {
+         ct->pushed = TRUE;
+         break;
+      }
 
-      /*i++;*/
-      if(!strncmp(&buffer[i+1],"<?xml ",6))            found_xml  = TRUE;
-      if(!strncmp(&buffer[i+1],"<PDBx:datablock ",16)) found_pdbx = TRUE;
-   }
+      if(atomSite)
+      {
+         if(col == 0)
+            StartAtomMMCIF(rd);
+         if(rd->items[col] >= 0)
+            SetAtomItemMMCIF(rd, rd->items[col], ct);
+         if((col == ncols-1) && !StoreAtomMMCIF(rd))
+            return(FALSE);
+      }
+      else if(firstRow && (rd->items[col] >= 0))
+      {
+         if(!StoreHeaderItemMMCIF(rd, rd->items[col], ct))
+            return(FALSE);
+      }
 
-   return ((found_xml && found_pdbx) ? TRUE : FALSE);
+      if(++col == ncols)
+      {
+         col      = 0;
+         firstRow = FALSE;
+      }
+   }
 
-#else
+   return(TRUE);
+}
 
-   /* Single Character Filetype Check                                   */
-   int c;
 
-   /* get single char from input stream                                 */
-   c = fgetc(fp);
-   if(c == EOF || feof(fp)) return FALSE;
+/************************************************************************/
+/*>static void StartAtomMMCIF(MMCIFREAD *rd)
+   -----------------------------------------
+*//**
 
-   /* pushback character                                                */
-   ungetc(c, fp);
+   \param[in,out] *rd       Reading state
 
-   /* detect filetype                                                   */
-   return (((char)c == '<') ? TRUE:FALSE);
+   Sets the defaults for an atom before its values are read. As for
+   PDBML, the names are left empty so that auth_ values replace label_
+   values whichever comes first.
 
-#endif 
+-  18.10.26 Original
+*/
+static void StartAtomMMCIF(MMCIFREAD *rd)
+{
+   PDB *p = &(rd->atom);
+
+   CLEAR_PDB(p);
+   strcpy(p->chain,   "");
+   strcpy(p->atnam,   "");
+   strcpy(p->resnam,  "");
+   strcpy(p->element, "");
+   strcpy(p->segid,   "");
+   rd->model   = 1;
+   rd->authSeq = FALSE;
 }
 
+
 /************************************************************************/
-/*>static void ProcessElementField(char *element_field, char *element)
-   -------------------------------------------------------------------
+/*>static void SetAtomItemMMCIF(MMCIFREAD *rd, int item,
+                                MMCIFTOKENS *ct)
+   -------------------------------------------------------
 *//**
 
-   \param[in]  element_field   Columns 77 to 78 of the ATOM/HETATM record 
-                               of pdb file.
-   \param[out] element         Element symbol.
-   
-   Get element symbol for ATOM/HETATM record.
-   
--  04.08.14 Original By: CTP
-   
+   \param[in,out] *rd       Reading state
+   \param[in]     item      The atom_site item (ATOMSITE_ ...)
+   \param[in]     *ct       Tokeniser state holding the value
+
+   Stores an atom_site value directly from the token. Null values (?
+   and .) leave the defaults.
+
+-  18.10.26 Original
 */
-static void ProcessElementField(char *element, char *element_field)
+static void SetAtomItemMMCIF(MMCIFREAD *rd, int item, MMCIFTOKENS *ct)
 {
-   char element_sym[4] = "";
-   char *element_ptr   = NULL;
+   PDB    *p = &(rd->atom);
+   char   *token = ct->token;
+   int    len    = ct->tokenLen,
+          ivalue = 0;
+   double value  = 0.0;
 
-   /* Get element                                                       */
-   if(strlen(element_field) >= 2)
+   if(NULLTOKEN(ct))
+      return;
+
+   switch(item)
    {
-      strncpy(element_sym, element_field, 2);
-      element_sym[2] = '\0';
-      KILLLEADSPACES(element_ptr, element_sym);
-      strcpy(element,element_ptr);
+   case ATOMSITE_GROUP:
+      CopyTokenMMCIF(p->record_type, ct);
+      PADMINTERM(p->record_type, 6);
+      break;
+   case ATOMSITE_ID:
+      GetIntField(token, MIN(len, 15), &(p->atnum));
+      break;
+   case ATOMSITE_TYPE:
+      CopyTokenMMCIF(p->element, ct);
+      break;
+   case ATOMSITE_LABEL_ATOM:
+      if(p->atnam[0] == '\0')
+         CopyTokenMMCIF(p->atnam, ct);
+      break;
+   case ATOMSITE_AUTH_ATOM:
+      CopyTokenMMCIF(p->atnam, ct);
+      break;
+   case ATOMSITE_ALT:
+      if(len)
+         p->altpos = token[0];
+      break;
+   case ATOMSITE_LABEL_COMP:
+      if(p->resnam[0] == '\0')
+         CopyTokenMMCIF(p->resnam, ct);
+      break;
+   case ATOMSITE_AUTH_COMP:
+      CopyTokenMMCIF(p->resnam, ct);
+      break;
+   case ATOMSITE_LABEL_ASYM:
+      if(p->chain[0] == '\0')
+         CopyTokenMMCIF(p->chain, ct);
+      break;
+   case ATOMSITE_AUTH_ASYM:
+      CopyTokenMMCIF(p->chain, ct);
+      break;
+   case ATOMSITE_ENTITY:
+      GetIntField(token, MIN(len, 15), &(p->entity_id));
+      break;
+   case ATOMSITE_LABEL_SEQ:
+      if(!rd->authSeq)
+         GetIntField(token, MIN(len, 15), &(p->resnum));
+      break;
+   case ATOMSITE_AUTH_SEQ:
+      GetIntField(token, MIN(len, 15), &(p->resnum));
+      rd->authSeq = TRUE;
+      break;
+   case ATOMSITE_INSERT:
+      CopyTokenMMCIF(p->insert, ct);
+      break;
+   case ATOMSITE_X:
+      GetRealField(token, MIN(len, 31), &value);
+      p->x = (REAL)value;
+      break;
+   case ATOMSITE_Y:
+      GetRealField(token, MIN(len, 31), &value);
+      p->y = (REAL)value;
+      break;
+   case ATOMSITE_Z:
+      GetRealField(token, MIN(len, 31), &value);
+      p->z = (REAL)value;
+      break;
+   case ATOMSITE_OCC:
+      GetRealField(token, MIN(len, 31), &value);
+      p->occ = (REAL)value;
+      break;
+   case ATOMSITE_BVAL:
+      GetRealField(token, MIN(len, 31), &value);
+      p->bval = (REAL)value;
+      break;
+   case ATOMSITE_CHARGE:
+      GetIntField(token, MIN(len, 15), &ivalue);
+      p->formal_charge  = ivalue;
+      p->partial_charge = (REAL)ivalue;
+      break;
+   case ATOMSITE_MODEL:
+      GetIntField(token, MIN(len, 15), &(rd->model));
+      break;
+   default:
+      break;
    }
+}
 
-   return;
+
+/************************************************************************/
+/*>static void CopyTokenMMCIF(char *field, MMCIFTOKENS *ct)
+   --------------------------------------------------------
+*//**
+
+   \param[out]    *field    PDB string field (8 characters)
+   \param[in]     *ct       Tokeniser state holding the value
+
+   Copies a token into a string field of a PDB record, truncating it
+   if needed.
+
+-  18.10.26 Original
+*/
+static void CopyTokenMMCIF(char *field, MMCIFTOKENS *ct)
+{
+   int len = MIN(ct->tokenLen, 7);
+
+   memcpy(field, ct->token, len);
+   field[len] = '\0';
 }
 
+
 /************************************************************************/
-/*>static void ProcessChargeField(char *element_charge, int *charge)
-   -----------------------------------------------------------------
+/*>static BOOL StoreAtomMMCIF(MMCIFREAD *rd)
+   -----------------------------------------
 *//**
 
-   \param[in]  element_charge  Columns 79 to 80 of the ATOM/HETATM record 
-                               of pdb file.
-   \param[out] charge          Charge on the atom.
-   
-   Get formal charge for ATOM/HETATM record.
+   \param[in,out] *rd       Reading state
+   \return                  Success? FALSE only if memory ran out
 
--  04.08.14 Original By: CTP
-   
+   Finishes an atom once all the columns of a row have been read and
+   adds it to the linked list. Models are counted in the order in which
+   they appear and the model, ATOM/HETATM and occupancy selections are
+   made as in blDoReadPDB(). Alternate positions are grouped in the
+   same way by temporarily appending the alternate position to the atom
+   name, as it appears in a PDB file.
+
+-  18.10.26 Original
+-  18.10.26 Sets flags in rd->state rather than globals
+-  18.10.26 Sets name codes
 */
-static void ProcessChargeField(int *charge, char *charge_field)
+static BOOL StoreAtomMMCIF(MMCIFREAD *rd)
 {
-   /* Get charge magnitude                                              */
-   if(strlen(charge_field) >= 2 && isdigit(charge_field[0]))
+   PDB      *p    = &(rd->atom);
+   WHOLEPDB *wpdb = rd->wpdb;
+   int      len;
+
+   PadAtomSiteLabels(p);
+
+   if((rd->ModelCount == 0) || (rd->model != rd->CurModel))
    {
-      *charge = charge_field[0] - '0';
+      /* Alternates are not grouped across models                       */
+      if(rd->NPartial != 0)
+      {
+         if(!StoreOccRankAtom(rd->OccRank, rd->multi, rd->NPartial,
+                              &(wpdb->pdb), &(rd->end), &(wpdb->natoms),
+                              NULL))
+            return(FALSE);
+         rd->NPartial = 0;
+      }
+      rd->CurModel = rd->model;
+      rd->ModelCount++;
    }
 
-   /* Get charge sign                                                   */
-   if(strlen(charge_field) >= 2 && charge_field[1] == '-')
+   /* Filter on model and record type                                   */
+   if((rd->ModelNum != 0) && (rd->ModelCount != rd->ModelNum))
+      return(TRUE);
+   rd->state->modelNotFound = FALSE;
+
+   if(!rd->AllAtoms && strncmp(p->record_type, "ATOM  ", 6))
+      return(TRUE);
+
+   if((p->altpos == ' ') ||
+      (p->occ > (REAL)0.999) ||
+      (rd->OccRank == 0))
    {
-      *charge = *charge * -1;
+      if(rd->NPartial != 0)
+      {
+         if(!StoreOccRankAtom(rd->OccRank, rd->multi, rd->NPartial,
+                              &(wpdb->pdb), &(rd->end), &(wpdb->natoms),
+                              NULL))
+            return(FALSE);
+         rd->NPartial = 0;
+      }
+
+      if(wpdb->pdb == NULL)
+      {
+         INIT(wpdb->pdb, PDB);
+         rd->end = wpdb->pdb;
+      }
+      else
+      {
+         ALLOCNEXT(rd->end, PDB);
+      }
+      if(rd->end == NULL)
+         return(FALSE);
+
+      (wpdb->natoms)++;
+      *(rd->end) = *p;
+      rd->end->next = NULL;
+      blSetPDBNameCodes(rd->end);
    }
+   else   /* Partial occupancy                                          */
+   {
+      rd->state->partialOcc = TRUE;
 
-   return;
+      if((len = strlen(p->atnam)) < 7)
+      {
+         p->atnam[len]   = p->altpos;
+         p->atnam[len+1] = '\0';
+      }
+
+      if(NewPartialGroup(p, rd->NPartial, rd->CurAtom, &(rd->CurRes),
+                         &(rd->CurIns)))
+      {
+         if(!StoreOccRankAtom(rd->OccRank, rd->multi, rd->NPartial,
+                              &(wpdb->pdb), &(rd->end), &(wpdb->natoms),
+                              NULL))
+            return(FALSE);
+         rd->NPartial = 0;
+      }
+
+      if(rd->NPartial < MAXPARTIAL)
+         rd->multi[rd->NPartial++] = *p;
+   }
+
+   return(TRUE);
 }
 
+
 /************************************************************************/
-/*>void blFreeWholePDB(WHOLEPDB *wpdb)
-   -----------------------------------
+/*>static BOOL StoreHeaderItemMMCIF(MMCIFREAD *rd, int item,
+                                    MMCIFTOKENS *ct)
+   ---------------------------------------------------------
 *//**
 
-   \param[in]     *wpdb    WHOLEPDB structure to be freed
-
-   Frees the header, trailer and atom content from a WHOLEPDB structure
+   \param[in,out] *rd       Reading state
+   \param[in]     item      The header item (HEADERITEM_ ...)
+   \param[in]     *ct       Tokeniser state holding the value
+   \return                  Success? FALSE only if memory ran out
 
--  30.05.02  Original   By: ACRM
--  07.07.14  Renamed to blFreeWholePDB() By: CTP
-*/
-void blFreeWholePDB(WHOLEPDB *wpdb)
-{
-   blFreeStringList(wpdb->header);
-   blFreeStringList(wpdb->trailer);
-   FREELIST(wpdb->pdb, PDB);
-   free(wpdb);
+   Keeps a copy of the first value of an item used to make the header
+   records. Nothing is kept unless the whole file is being read.
+
+-  18.10.26 Original
+*/
+static BOOL StoreHeaderItemMMCIF(MMCIFREAD *rd, int item,
+                                 MMCIFTOKENS *ct)
+{
+   if(!rd->DoWhole || (rd->header[item] != NULL) || NULLTOKEN(ct))
+      return(TRUE);
+
+   if((rd->header[item] = (char *)malloc((ct->tokenLen + 1) *
+                                         sizeof(char)))==NULL)
+      return(FALSE);
+   memcpy(rd->header[item], ct->token, ct->tokenLen);
+   rd->header[item][ct->tokenLen] = '\0';
+   return(TRUE);
 }
 
 
 /************************************************************************/
-/*>WHOLEPDB *blReadWholePDB(FILE *fpin)
-   ------------------------------------
+/*>static BOOL BuildHeaderMMCIF(MMCIFREAD *rd)
+   -------------------------------------------
 *//**
 
-   \param[in]     *fpin     File pointer
-   \return                  Whole PDB structure containing linked
-                            list to PDB coordinate data
+   \param[in,out] *rd       Reading state
+   \return                  Success? FALSE only if memory ran out
 
-   Reads a PDB file, storing the header and trailer information as
-   well as the coordinate data. Can read gzipped files as well as
-   uncompressed files.
+   Makes HEADER, TITLE and CRYST1 records from the items kept while
+   reading. The HEADER line is laid out as for PDBML files.
 
-   Coordinate data is accessed as linked list of type PDB as follows:
-   
-   WHOLEPDB *wpdb;
-   PDB      *p;
-   wpdb = ReadWholePDB(fp);
-   for(p=wpdb->pdb; p!=NULL; p=p->next)
+-  18.10.26 Original
+*/
+static BOOL BuildHeaderMMCIF(MMCIFREAD *rd)
+{
+   STRINGLIST *title;
+   char       **header = rd->header,
+              line[MAXBUFF],
+              date_field[10] = "";
+   double     cell[6];
+   int        i;
+
+   /* HEADER                                                            */
+   if(header[HEADERITEM_DATE] != NULL)
+      SetPDBDateField(date_field, header[HEADERITEM_DATE]);
+   else if(header[HEADERITEM_DEPOSITED] != NULL)
+      SetPDBDateField(date_field, header[HEADERITEM_DEPOSITED]);
+
+   sprintf(line, "HEADER    %-40.40s%9s   %4.4s              \n",
+           ((header[HEADERITEM_KEYWORDS] != NULL) ?
+            header[HEADERITEM_KEYWORDS] : "Converted from mmCIF"),
+           date_field,
+           ((header[HEADERITEM_ENTRY] != NULL) ?
+            header[HEADERITEM_ENTRY] : ""));
+   if((rd->wpdb->header = blStoreString(NULL, line))==NULL)
+      return(FALSE);
+
+   /* TITLE                                                             */
+   if(header[HEADERITEM_TITLE] != NULL)
    {
-      ... Do something with p ...
+      if((title = TitleStringlist(header[HEADERITEM_TITLE]))==NULL)
+         return(FALSE);
+      rd->wpdb->header->next = title;
    }
 
--  07.03.07 Made into a wrapper to doReadWholePDB()
--  07.07.14 Use blDoReadWholePDB() Renamed to blReadWholePDB() By: CTP
-*/
-WHOLEPDB *blReadWholePDB(FILE *fpin)
-{
-   WHOLEPDB *wpdb;
-   wpdb = blDoReadPDB(fpin, TRUE, 1, 1, TRUE);
-   wpdb->pdb = blRemoveAlternates(wpdb->pdb);
-   return(wpdb);
+   /* CRYST1 is only made if the whole unit cell is given               */
+   for(i=0; i<6; i++)
+   {
+      if(header[HEADERITEM_CELL_A + i] == NULL)
+         return(TRUE);
+      cell[i] = 0.0;
+      sscanf(header[HEADERITEM_CELL_A + i], "%lf", &(cell[i]));
+   }
+   sprintf(line, "CRYST1%9.3f%9.3f%9.3f%7.2f%7.2f%7.2f %-11.11s%4.4s\n",
+           cell[0], cell[1], cell[2], cell[3], cell[4], cell[5],
+           ((header[HEADERITEM_SPACEGROUP] != NULL) ?
+            header[HEADERITEM_SPACEGROUP] : ""),
+           ((header[HEADERITEM_Z] != NULL) ? header[HEADERITEM_Z] : ""));
+   if(blStoreString(rd->wpdb->header, line)==NULL)
+      return(FALSE);
+
+   return(TRUE);
 }
 
+
 /************************************************************************/
-/*>WHOLEPDB *blReadWholePDBAtoms(FILE *fpin)
-   -----------------------------------------
+/*>static BOOL CheckLineInputMMCIF(LINEINPUT *li)
+   ----------------------------------------------
 *//**
 
-   \param[in]     *fpin     File pointer
-   \return                  Whole PDB structure containing linked
-                            list to PDB coordinate data
+   \param[in]     *li       Line input for the file
+   \return                   Is the file in mmCIF format?
 
-   Reads a PDB file, storing the header and trailer information as
-   well as the coordinate data. Can read gzipped files as well as
-   uncompressed files.
+   Looks ahead in the data to see whether the first thing other than
+   comments and white space is a data_ block header.
 
-   Coordinate data is accessed as linked list of type PDB as follows:
-   
-   WHOLEPDB *wpdb;
-   PDB      *p;
-   wpdb = ReadWholePDB(fp);
-   for(p=wpdb->pdb; p!=NULL; p=p->next)
+-  18.10.26 Original
+*/
+static BOOL CheckLineInputMMCIF(LINEINPUT *li)
+{
+   char *sample;
+   int  len,
+        i = 0;
+
+   sample = blPeekLineInput(li, XML_SAMPLE - 1, &len);
+
+   while(i < len)
    {
-      ... Do something with p ...
+      if(isspace((unsigned char)sample[i]))
+      {
+         i++;
+      }
+      else if(sample[i] == '#')
+      {
+         while((i < len) && (sample[i] != '\n'))
+            i++;
+      }
+      else
+      {
+         return(LINEINPUTMATCH(sample + i, len - i, "data_", 5) ?
+                TRUE : FALSE);
+      }
    }
 
--  07.03.07 Made into a wrapper to doReadWholePDB()
--  07.07.14 Use blDoReadWholePDB() Renamed to blReadWholePDBAtoms() 
-            By: CTP
-*/
-WHOLEPDB *blReadWholePDBAtoms(FILE *fpin)
-{
-   WHOLEPDB *wpdb;
-   wpdb = blDoReadPDB(fpin, FALSE, 1, 1, TRUE);
-   wpdb->pdb = blRemoveAlternates(wpdb->pdb);
-   return(wpdb);
+   return(FALSE);
 }
 
 
 /************************************************************************/
-/*>static void StoreConectRecords(WHOLEPDB *wpdb, char *buffer)
-   ------------------------------------------------------------
+/*>static void PadAtomSiteLabels(PDB *p)
+   -------------------------------------
 *//**
-   \param[in,out]    *wpdb      Whole PDB structure
-   \param[in]        *buffer    A line containing a CONECT record
 
-   Stores the connectivity data from a CONECT record into the PDB linked
-   list
+   \param[in,out] *p        Atom read from an atom_site
 
--  18.02.15  Original   By: ACRM
--  05.03.15  Initialize all connected atoms to NULL and check for NULLs
-             when storing the CONECTs. This deals with cases where an
-             atom specified in a CONECT record has alternate occupancies
-             and an alternate position is removed. Previously this led
-             to core dumps. e.g. PDB code 3pnw
+   Sets the raw atom name and pads the names of an atom read from PDBML
+   or mmCIF to the widths used for PDB files.
+
+-  18.10.26 Split from ParseAtomSitePDBML() so it can also be used for
+            mmCIF
 */
-static void StoreConectRecords(WHOLEPDB *wpdb, char *buffer)
+static void PadAtomSiteLabels(PDB *p)
 {
-   char record_type[8];
-   int  i, j,
-        nConect,
-        atoms[5];
-   PDB  *p,
-        *atomsP[5];
-   BOOL gotLink;
+   char pad_resnam[8] = "";
 
-   fsscanf(buffer,"%6s%5d%5d%5d%5d%5d", 
-           record_type,&atoms[0],&atoms[1],&atoms[2],&atoms[3],&atoms[4]);
+   /* Set raw atom name
+      Note: The text pdb format uses columns 13-16 to store the atom
+            name. By convention, columns 13-14 contain the
+            right-justified element symbol for the atom.
 
-   /* Find the PDB pointers for the (up to) 5 CONECT atoms              */
-   nConect = 0;
-   for(i=0; i<5; i++)
+            The raw atom name is equivalent to colums 13-16 of a
+            pdb-formatted text file .
+   */
+
+   if(strlen(p->atnam) == 1)
    {
-      /* Have we run out of specified atoms?                            */
-      if(atoms[i] == 0)
-         break;
+      /* copy 1-letter name atnam_raw                                   */
+      strcpy((p->atnam_raw), " ");
+      /* 25.02.15 Changed to strncpy()  By: ACRM                        */
+      strncpy((p->atnam_raw)+1, p->atnam, 7);
+   }
+   if(strlen(p->atnam) == 4)
+   {
+      /* copy 4-letter name atnam_raw                                   */
+      /* 25.02.15 Changed to strncpy()  By: ACRM                        */
+      strncpy(p->atnam_raw, p->atnam, 8);
+   }
+   else if(strlen(p->element) == 1)
+   {
+      strcpy((p->atnam_raw),               " ");
+      /* 25.02.15 Changed to strncpy()  By: ACRM                        */
+      strncpy((p->atnam_raw)+1, p->atnam, 7);
+   }
+   else
+   {
+      /* 25.02.15 Changed to strncpy()  By: ACRM                        */
+      strncpy(p->atnam_raw, p->atnam, 4);
+   }
 
-      atomsP[i] = NULL;                                 /* 05.03.15     */
+   /* Pad atom names to 4 characters                                    */
+   PADMINTERM(p->atnam,     4);
+   PADMINTERM(p->atnam_raw, 4);
 
-      /* Look for this atom                                             */
-      for(p=wpdb->pdb; p!=NULL; NEXT(p))
-      {
-         if(atoms[i] == p->atnum)
-         {
-            /* Found it so store and break out                          */
-            atomsP[i] = p;
-            nConect++;
-            break;
-         }
-      }
-   }
+   /* Pad Residue Name
+      Note: The text pdb format uses columns 18-20 to store the
+            residue name (right-justified).
 
-   /* Set the connections from atom 0                                   */
-   if(atomsP[0] != NULL)                                /* 05.03.15     */
-   {
-      for(i=1; i<nConect; i++)
-      {
-         /* Look to see if we have this conect stored already           */
-         gotLink = FALSE;
-         for(j=0; j<atomsP[0]->nConect; j++)
-         {
-            if(atomsP[i] != NULL)                       /* 05.03.15     */
-            {
-               if(atomsP[0]->conect[j] == atomsP[i])
-               {
-                  gotLink = TRUE;
-                  break;
-               }
-            }
-         }
-         
-         /* If not then store it                                        */
-         if(!gotLink && (atomsP[0]->nConect < MAXCONECT))
-         {
-            if(atomsP[i] != NULL)                       /* 05.03.15     */
-            {
-               atomsP[0]->conect[atomsP[0]->nConect] = atomsP[i];
-               (atomsP[0]->nConect)++;
-            }
-         }
-      }
+            p->resnam is is equivalent to colums 18-21 of a
+            pdb-formatted text file.
+   */
+   sprintf(pad_resnam, "%3s", p->resnam);
+   PADMINTERM(pad_resnam, 4);
+   /* 25.02.15 Changed to strncpy()  By: ACRM                           */
+   strncpy(p->resnam, pad_resnam, 8);
 
-      /* Set the connections in the other direction                     */
-      for(i=1; i<nConect; i++)
-      {
-         if(atomsP[i] != NULL)                          /* 05.03.15     */
-         {
-            /* Look to see if we have this conect stored already        */
-            gotLink = FALSE;
-            for(j=0; j<atomsP[i]->nConect; j++)
-            {
-               if(atomsP[i]->conect[j] == atomsP[0])
-               {
-                  gotLink = TRUE;
-                  break;
-               }
-            }
-            
-            /* If not then store it                                     */
-            if(!gotLink && (atomsP[i]->nConect < MAXCONECT))
-            {
-               atomsP[i]->conect[atomsP[i]->nConect] = atomsP[0];
-               (atomsP[i]->nConect)++;
-            }
-         }
-      }
+   /* Set chain to " " if not already set                               */
+   if(strlen(p->chain) == 0)
+   {
+      strcpy(p->chain, " ");
    }
+
+   /* Pad the segment id                                                */
+   PADMINTERM(p->segid, 4);
 }
 
+
 #ifdef XML_SUPPORT
 /************************************************************************/
 /*>static void ParseHeaderRecordsPDBML(WHOLEPDB *wpdb, xmlDoc *document)
@@ -3562,6 +6178,8 @@ static char **GetEntityChainLabels(int entity, PDB *pdb, int *nChains)
 }
 
 
+#endif /* XML_SUPPORT */
+
 /************************************************************************/
 /*>static BOOL SetPDBDateField(char *pdb_date, char *pdbml_date)
    -------------------------------------------------------------
@@ -3574,6 +6192,7 @@ static char **GetEntityChainLabels(int entity, PDB *pdb, int *nChains)
    Convert pdbml date format to pdb date format.
 
 -  10.09.14 Original. By: CTP
+-  18.10.26 No longer depends on XML_SUPPORT as it is used for mmCIF
 
 */
 static BOOL SetPDBDateField(char *pdb_date, char *pdbml_date)
@@ -3608,6 +6227,7 @@ static BOOL SetPDBDateField(char *pdb_date, char *pdbml_date)
 }
 
 
+#ifdef XML_SUPPORT
 /************************************************************************/
 /*>static int *ParseConectPDBML(xmlDoc *document, PDB *pdb)
    --------------------------------------------------------
@@ -3884,6 +6504,8 @@ static int ParseConectPDBML(xmlDoc *document, PDB *pdb)
 #endif
 }
 
+#endif /* XML_SUPPORT */
+
 /************************************************************************/
 /*>static STRINGLIST *DoStoreStringlist(STRINGLIST *stringlist, 
                                         char *record, int *lines_stored,
@@ -3906,6 +6528,7 @@ static int ParseConectPDBML(xmlDoc *document, PDB *pdb)
 
 -  13.05.15 Original. By: CTP
 -  25.06.15 Doesn't upcase CHAIN  By: ACRM
+-  18.10.26 No longer depends on XML_SUPPORT as it is used for mmCIF
 
 */
 static STRINGLIST *DoStoreStringlist(STRINGLIST *stringlist, 
@@ -3913,13 +6536,6 @@ static STRINGLIST *DoStoreStringlist(STRINGLIST *stringlist,
                                      char *token, char *content, 
                                      char *terminator)
 {
-#ifndef XML_SUPPORT
-
-   /* PDBML format not supported.                                       */
-   return(NULL);
-
-#else
-
    /* Store PDBML content as PDB-formated stringlist                    */
    char content_line[82]  =   "",
         content_field[71] =   "",
@@ -4009,8 +6625,6 @@ static STRINGLIST *DoStoreStringlist(STRINGLIST *stringlist,
 
    /* return stringlist                                                 */
    return stringlist;
-
-#endif
 }
 
 
@@ -4025,17 +6639,11 @@ static STRINGLIST *DoStoreStringlist(STRINGLIST *stringlist,
    Creates TITLE line.
 
 -  13.05.15 Original. By: CTP
+-  18.10.26 No longer depends on XML_SUPPORT as it is used for mmCIF
 
 */
 static STRINGLIST *TitleStringlist(char *titlestring)
 {
-#ifndef XML_SUPPORT
-
-   /* PDBML format not supported.                                       */
-   return(NULL);
-
-#else
-
    /* Store title as PDB-formatted stringlist                           */
    STRINGLIST *title_stringlist = NULL;
    int start_line = 0;
@@ -4044,11 +6652,10 @@ static STRINGLIST *TitleStringlist(char *titlestring)
                                         titlestring, "");
 
    return title_stringlist;
-
-#endif
 }
 
 
+#ifdef XML_SUPPORT
 /************************************************************************/
 /*>static STRINGLIST *CompndStringlist(STRINGLIST *stringlist, 
                                          int *lines_stored, 
@@ -4291,3 +6898,128 @@ static STRINGLIST *SeqresStringlist(int nchains, char **chains,
 
 
 #endif
+
+
+/************************************************************************/
+#ifdef BENCHMARK
+#include <time.h>
+/************************************************************************/
+/*>static int LegacyReadAtoms(FILE *fp)
+   ------------------------------------
+*//**
+
+   The pre-V3.12 coordinate parsing loop (fgets() followed by fsscanf()
+   for every ATOM/HETATM record) used as the reference for timing
+
+-  18.10.26 Original
+*/
+static int LegacyReadAtoms(FILE *fp)
+{
+   char   buffer[MAXBUFF], record_type[8], atnam[8], resnam[8], 
+          chain[4], insert[4], segid[8], element[4], charge[4];
+   int    atnum, resnum, natoms = 0;
+   double x, y, z, occ, bval;
+   PDB    *pdb = NULL, *p = NULL;
+
+   while(fgets(buffer, MAXBUFF-1, fp))
+   {
+      if(strncmp(buffer, "ATOM  ", 6) && strncmp(buffer, "HETATM", 6))
+         continue;
+      if(fsscanf(buffer,
+            "%6s%5d%1x%5s%4s%1s%4d%1s%3x%8lf%8lf%8lf%6lf%6lf%6x%4s%2s%2s",
+                 record_type,&atnum,atnam,resnam,chain,&resnum,insert,
+                 &x,&y,&z,&occ,&bval,segid,element,charge) != EOF)
+      {
+         if(pdb == NULL)
+         {
+            INIT(pdb, PDB);
+            p = pdb;
+         }
+         else
+         {
+            ALLOCNEXT(p, PDB);
+         }
+         if(p == NULL)
+            break;
+         CLEAR_PDB(p);
+         p->atnum = atnum;
+         p->x     = x;
+         strcpy(p->atnam, atnam);
+         natoms++;
+      }
+   }
+   FREELIST(pdb, PDB);
+   return(natoms);
+}
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*//**
+
+   Throughput comparison of the legacy fgets()/fsscanf() parsing loop
+   against blDoReadPDB() which memory maps the file and decodes records
+   in place. 
+   Usage: readpdbbench file.pdb [repeats]
+
+-  18.10.26 Original
+*/
+int main(int argc, char **argv)
+{
+   FILE     *fp;
+   WHOLEPDB *wpdb;
+   clock_t  start;
+   double   tLegacy = 0.0,
+            tNew    = 0.0,
+            mbytes;
+   long     fileSize;
+   int      i, 
+            nLegacy = 0,
+            nNew    = 0,
+            repeats = 5;
+
+   if(argc < 2)
+   {
+      fprintf(stderr,"Usage: readpdbbench file.pdb [repeats]\n");
+      return(1);
+   }
+   if(argc > 2)
+      repeats = atoi(argv[2]);
+
+   if((fp = fopen(argv[1], "r"))==NULL)
+   {
+      fprintf(stderr,"Unable to open %s\n", argv[1]);
+      return(1);
+   }
+   fseek(fp, 0, SEEK_END);
+   fileSize = ftell(fp);
+   mbytes   = (double)fileSize / (1024.0 * 1024.0);
+
+   for(i=0; i<repeats; i++)
+   {
+      rewind(fp);
+      start    = clock();
+      nLegacy  = LegacyReadAtoms(fp);
+      tLegacy += (double)(clock() - start) / CLOCKS_PER_SEC;
+
+      rewind(fp);
+      start    = clock();
+      if((wpdb = blDoReadPDB(fp, TRUE, 0, 0, TRUE))!=NULL)
+      {
+         nNew = wpdb->natoms;
+         blFreeWholePDB(wpdb);
+      }
+      tNew    += (double)(clock() - start) / CLOCKS_PER_SEC;
+   }
+   fclose(fp);
+
+   printf("File: %s (%.1f MB, %d repeats)\n", argv[1], mbytes, repeats);
+   printf("fgets()+fsscanf()  : %8d atoms %8.3fs %8.1f MB/s\n",
+          nLegacy, tLegacy/repeats, mbytes*repeats/tLegacy);
+   printf("blDoReadPDB() mmap : %8d atoms %8.3fs %8.1f MB/s\n",
+          nNew, tNew/repeats, mbytes*repeats/tNew);
+   printf("Speedup            : %8.2fx\n", tLegacy/tNew);
+
+   return(0);
+}
+#endif
@@ -3,11 +3,11 @@
 
    \file       RenumAtomsPDB.c
    
-   \version    V1.5
-   \date       29.04.15
+   \version    V1.7
+   \date       18.10.26
    \brief      
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -54,6 +54,8 @@
                   numbering
 -  V1.5  29.04.15 Increment atom number at start of HETATM records.
                   By: CTP
+-  V1.6  18.10.26 Updates gPDBAtomIndex  By: ACRM
+-  V1.7  18.10.26 Updates the atom index attached to the list instead
 *************************************************************************/
 /* Doxygen
    -------
@@ -89,19 +91,23 @@
    \param[in,out] *pdb   PDB linked list to renumber
    \param[in]     offset Number for the first atom
 
-   Renumber the atoms throughout a PDB linked list
+   Renumber the atoms throughout a PDB linked list. If an atom index is
+   attached to this list, its atom numbers are updated.
 
 -  01.08.93 Original
 -  07.07.14 Use bl prefix for functions By: CTP
 -  23.02.15 More intelligent version that allows for TER records which 
             are also numbered. Added offset parameter.
 -  29.04.15 Increment atom number at start of HETATM records.  By: CTP
+-  18.10.26 Updates gPDBAtomIndex  By: ACRM
+-  18.10.26 Updates the atom index attached to the list instead
 */
 void blRenumAtomsPDB(PDB *pdb, int offset)
 {
-   PDB *p, 
-       *prev = NULL;
-   int i;
+   PDB          *p,
+                *prev = NULL;
+   PDBATOMINDEX *index;
+   int          i;
 
    i=offset;
 
@@ -124,5 +130,8 @@ void blRenumAtomsPDB(PDB *pdb, int offset)
       p->atnum=i++;
       prev=p;
    }
+
+   if((index = blGetPDBAtomIndex(pdb)) != NULL)
+      blUpdatePDBAtomIndexNumbers(index);
 }
 
@@ -0,0 +1,384 @@
+/************************************************************************/
+/**
+
+   \file       ResidueIndex.c
+
+   \version    V1.1
+   \date       18.10.26
+   \brief      Hashed index of the residues in a PDB linked list
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   blFindResidue() and blFindZonePDB() search the linked list from the
+   start for every residue they look up, so looking up every residue
+   in a structure takes time proportional to the square of its size.
+
+   A RESIDUEINDEX is built once for a linked list and finds the first
+   atom of a residue, and the first atom of the residue that follows
+   it, from the chain label, residue number and insert code using a
+   hash table.
+
+   If the index is attached to the linked list with
+   blAttachResidueIndex() (see PDBIndexes.c), blFindResidue() (and so
+   blFindResidueSpec()) and blFindZonePDB() use it whenever they are
+   asked to search that list. An attached index is kept up to date
+   when atoms are removed from the list and is freed when atoms are
+   added to it.
+
+   An index which is not attached holds pointers into the linked list,
+   so it must be rebuilt if atoms are added to or removed from the
+   list. Where a residue appears more than once, the first occurrence
+   is indexed, as this is the one that a search of the list would find.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+\code
+   blAttachResidueIndex(pdb);
+   ...
+   p = blFindResidue(pdb, "A", 23, " ");
+   ...
+   blDetachPDBIndexes(pdb);
+\endcode
+
+   or, for an index which is not attached,
+
+\code
+   index = blBuildResidueIndex(pdb);
+   ...
+   p = blFindResidueInIndex(index, "A", 23, " ", NULL);
+   ...
+   blFreeResidueIndex(index);
+\endcode
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  18.10.26 Original
+-  V1.1  18.10.26 Added blRemoveFromResidueIndex(). No longer uses
+                  gPDBResidueIndex
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP Searching the PDB linked list
+   #FUNCTION  blBuildResidueIndex()
+   Builds a hashed index of the residues in a PDB linked list
+
+   #FUNCTION  blFindResidueInIndex()
+   Finds a residue, and the residue that follows it, using an index
+
+   #FUNCTION  blFreeResidueIndex()
+   Frees a residue index
+
+   #FUNCTION  blRemoveFromResidueIndex()
+   Updates a residue index for an atom being removed from its list
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SysDefs.h"
+#include "pdb.h"
+#include "hash.h"
+#include "macros.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXINDEXKEY 64
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL MakeResidueKey(char *key, char *chain, int resnum,
+                           char *insert);
+
+
+/************************************************************************/
+/*>RESIDUEINDEX *blBuildResidueIndex(PDB *pdb)
+   -------------------------------------------
+*//**
+
+   \param[in]     *pdb     PDB linked list
+   \return                 The index. NULL if no memory
+
+   Builds a hashed index of the residues in a PDB linked list. Free
+   with blFreeResidueIndex().
+
+-  18.10.26 Original
+-  18.10.26 Marks residues which appear more than once
+*/
+RESIDUEINDEX *blBuildResidueIndex(PDB *pdb)
+{
+   RESIDUEINDEX  *index;
+   RESINDEXENTRY *entry,
+                 *first;
+   PDB           *p,
+                 *prev;
+   char          key[MAXINDEXKEY];
+   int           nres = 0;
+
+   /* Count the residues                                                */
+   for(p=pdb, prev=NULL; p!=NULL; prev=p, NEXT(p))
+   {
+      if((prev == NULL) || !RESIDMATCH(p, prev))
+         nres++;
+   }
+
+   if((index = (RESIDUEINDEX *)malloc(sizeof(RESIDUEINDEX)))==NULL)
+      return(NULL);
+
+   index->pdb       = pdb;
+   index->nresidues = 0;
+   index->residues  = (RESINDEXENTRY *)malloc((nres + 1) *
+                                              sizeof(RESINDEXENTRY));
+   index->hash      = blInitializeHash((ULONG)(2 * nres));
+
+   if((index->residues == NULL) || (index->hash == NULL))
+   {
+      blFreeResidueIndex(index);
+      return(NULL);
+   }
+
+   /* Record the start of each residue and of the one after it          */
+   entry = NULL;
+   for(p=pdb, prev=NULL; p!=NULL; prev=p, NEXT(p))
+   {
+      if((prev == NULL) || !RESIDMATCH(p, prev))
+      {
+         if(entry != NULL)
+            entry->next = p;
+
+         entry           = index->residues + index->nresidues++;
+         entry->start    = p;
+         entry->next     = NULL;
+         entry->repeated = FALSE;
+
+         if(MakeResidueKey(key, p->chain, p->resnum, p->insert))
+         {
+            if((first = (RESINDEXENTRY *)
+                blGetHashValuePointer(index->hash, key)) != NULL)
+            {
+               first->repeated = TRUE;
+            }
+            else if(!blSetHashValuePointer(index->hash, key, (BPTR)entry))
+            {
+               blFreeResidueIndex(index);
+               return(NULL);
+            }
+         }
+      }
+   }
+
+   return(index);
+}
+
+
+/************************************************************************/
+/*>PDB *blFindResidueInIndex(RESIDUEINDEX *index, char *chain,
+                             int resnum, char *insert, PDB **nextres)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]     *index     Residue index
+   \param[in]     *chain     Chain label
+   \param[in]     resnum     Residue number
+   \param[in]     *insert    Insert code
+   \param[out]    **nextres  First atom of the following residue (NULL
+                             if this is the last residue). May be NULL
+                             if not needed
+   \return                   First atom of the residue. NULL if not
+                             found
+
+   Finds a residue using a residue index. Gives the same result as
+   blFindResidue() on the linked list from which the index was built.
+
+-  18.10.26 Original
+*/
+PDB *blFindResidueInIndex(RESIDUEINDEX *index, char *chain, int resnum,
+                          char *insert, PDB **nextres)
+{
+   RESINDEXENTRY *entry = NULL;
+   char          key[MAXINDEXKEY];
+
+   if(MakeResidueKey(key, chain, resnum, insert))
+      entry = (RESINDEXENTRY *)blGetHashValuePointer(index->hash, key);
+
+   if(nextres != NULL)
+      *nextres = (entry == NULL) ? NULL : entry->next;
+
+   return((entry == NULL) ? NULL : entry->start);
+}
+
+
+/************************************************************************/
+/*>void blFreeResidueIndex(RESIDUEINDEX *index)
+   --------------------------------------------
+*//**
+
+   \param[in]     *index   Residue index (may be NULL)
+
+   Frees a residue index. An index attached to a list is freed with
+   blDetachPDBIndexes() instead.
+
+-  18.10.26 Original
+-  18.10.26 No longer clears gPDBResidueIndex
+*/
+void blFreeResidueIndex(RESIDUEINDEX *index)
+{
+   if(index == NULL)
+      return;
+
+   if(index->hash != NULL)
+      blFreeHash(index->hash);
+   FREE(index->residues);
+   free(index);
+}
+
+
+/************************************************************************/
+/*>BOOL blRemoveFromResidueIndex(RESIDUEINDEX *index, PDB *atom,
+                                 PDB *prev)
+   -------------------------------------------------------------
+*//**
+
+   \param[in,out] *index   Residue index
+   \param[in]     *atom    Atom being removed from the indexed list
+   \param[in]     *prev    The atom before it in the list (NULL if it
+                           is the first)
+   \return                 Was the index updated? FALSE if it can no
+                           longer be used
+
+   Updates the index for an atom which is being removed from the list.
+   This must be called while the atom is still linked to the atom
+   after it. If the atom is the first of its residue, the residue now
+   starts at the next atom, or is removed from the index if that atom
+   is in another residue.
+
+   FALSE is returned, and the index must be freed, where a simple
+   update is not possible: the atom starts a residue which appears
+   more than once, or removing the residue brings together two parts
+   of another residue.
+
+-  18.10.26 Original
+*/
+BOOL blRemoveFromResidueIndex(RESIDUEINDEX *index, PDB *atom, PDB *prev)
+{
+   RESINDEXENTRY *entry,
+                 *preventry = NULL;
+   PDB           *next      = atom->next;
+   char          key[MAXINDEXKEY];
+
+   if(index->pdb == atom)
+      index->pdb = next;
+
+   /* Only the first atom of a residue is in the index                  */
+   if((prev != NULL) && RESIDMATCH(atom, prev))
+      return(TRUE);
+
+   if(!MakeResidueKey(key, atom->chain, atom->resnum, atom->insert) ||
+      ((entry = (RESINDEXENTRY *)blGetHashValuePointer(index->hash, key))
+       == NULL) ||
+      (entry->start != atom))
+      return(FALSE);
+
+   /* The residue before this one must point to it                      */
+   if(prev != NULL)
+   {
+      if(!MakeResidueKey(key, prev->chain, prev->resnum, prev->insert) ||
+         ((preventry = (RESINDEXENTRY *)
+           blGetHashValuePointer(index->hash, key)) == NULL) ||
+         (preventry->next != atom))
+         return(FALSE);
+   }
+
+   if((next != NULL) && RESIDMATCH(next, atom))
+   {
+      /* The residue now starts at the next atom                        */
+      entry->start = next;
+   }
+   else
+   {
+      /* The residue goes                                               */
+      if(entry->repeated ||
+         ((prev != NULL) && (next != NULL) && RESIDMATCH(prev, next)))
+         return(FALSE);
+
+      entry->start = NULL;
+      entry->next  = NULL;
+      MakeResidueKey(key, atom->chain, atom->resnum, atom->insert);
+      blDeleteHashKey(index->hash, key);
+   }
+
+   if(preventry != NULL)
+      preventry->next = next;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL MakeResidueKey(char *key, char *chain, int resnum,
+                              char *insert)
+   -------------------------------------------------------------
+*//**
+
+   \param[out]    *key     Hash key (MAXINDEXKEY characters)
+   \param[in]     *chain   Chain label
+   \param[in]     resnum   Residue number
+   \param[in]     *insert  Insert code
+   \return                 FALSE if the chain or insert is too long to
+                           be in a PDB record
+
+   Makes the hash key for a residue
+
+-  18.10.26 Original
+*/
+static BOOL MakeResidueKey(char *key, char *chain, int resnum,
+                           char *insert)
+{
+   if((strlen(chain) >= blMAXCHAINLABEL) || (strlen(insert) >= 8))
+      return(FALSE);
+
+   sprintf(key, "%s\t%d\t%s", chain, resnum, insert);
+   return(TRUE);
+}
@@ -3,11 +3,11 @@
 
    \file       ResolPDB.c
    
-   \version    V1.8
-   \date       07.07.14
+   \version    V1.10
+   \date       18.10.26
    \brief      Get resolution and R-factor information out of a PDB file
    
-   \copyright  (c) UCL / Dr. Andrew C.R. Martin, 1994-2014
+   \copyright  (c) UCL / Dr. Andrew C.R. Martin, 1994-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -70,6 +70,8 @@
 -  V1.9  02.03.15 Renamed blGetExptl() to blGetExptlPDB()
                   Moved ReadData() out from blGetExptlPDB()
                   Added blGetExptlWholePDB()
+-  V1.10 18.10.26 blGetExptlWholePDB() only visits the EXPDTA and REMARK
+                  records
 
 *************************************************************************/
 /* Doxygen
@@ -346,12 +348,16 @@ BOOL blGetExptlPDB(FILE *fp, REAL *resolution, REAL *RFactor, REAL *FreeR,
    set to zero.
 
 -  02.03.15 Original based on blGetExptlPDB()   By: ACRM
+-  18.10.26 Uses blGetHeaderSpanWholePDB()
 */
 BOOL blGetExptlWholePDB(WHOLEPDB *wpdb, REAL *resolution, REAL *RFactor,
                         REAL *FreeR, int *StrucType)
 {
    char buffer[MAXBUFF];
-   STRINGLIST *s;
+   STRINGLIST *s,
+              *first,
+              *stop;
+   static char *types[] = {"EXPDTA", "REMARK", NULL};
 
    /* Set some defaults                                                 */
    *resolution = (REAL)0.0;
@@ -360,7 +366,8 @@ BOOL blGetExptlWholePDB(WHOLEPDB *wpdb, REAL *resolution, REAL *RFactor,
    *StrucType  = STRUCTURE_TYPE_UNKNOWN;
    
    /* Get lines from the PDB file                                       */
-   for(s=wpdb->header; s!=NULL; NEXT(s))
+   first = blGetHeaderSpanWholePDB(wpdb, types, &stop);
+   for(s=first; s!=stop; NEXT(s))
    {
       strncpy(buffer, s->string, MAXBUFF);
       
@@ -3,11 +3,11 @@
 
    \file       SelAtPDB.c
    
-   \version    V1.11
-   \date       19.04.15
+   \version    V1.16
+   \date       18.10.26
    \brief      Select a subset of atom types from a PDB linked list
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1990-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1990-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -91,6 +91,12 @@
 -  V1.9  07.07.14 Use bl prefix for functions By: CTP
 -  V1.10 19.08.14 Renamed function to blSelectAtomsPDBAsCopy(). By: CTP
 -  V1.11 19.04.15 Added call to blCopyConect()   By: ACRM
+-  V1.12 18.10.26 Added blSelectAtomsPDBAsCopyArena()
+-  V1.13 18.10.26 Atom names are compared using name codes
+-  V1.14 18.10.26 Added blSelectAtomsPDBAsView()
+-  V1.15 18.10.26 The atom name code is checked against the name before
+                  it is compared
+-  V1.16 18.10.26 Atom name codes are compared directly again
 
 *************************************************************************/
 /* Doxygen
@@ -100,6 +106,14 @@
    #FUNCTION  blSelectAtomsPDBAsCopy()
    Take a PDB linked list and returns a list containing only those atom 
    types specified in the sel array.
+
+   #FUNCTION  blSelectAtomsPDBAsCopyArena()
+   As blSelectAtomsPDBAsCopy() but can allocate the new list from an
+   arena.
+
+   #FUNCTION  blSelectAtomsPDBAsView()
+   As blSelectAtomsPDBAsCopy() but makes a selection of the atoms
+   rather than copying them.
 */
 /************************************************************************/
 /* Includes
@@ -118,6 +132,7 @@
 /************************************************************************/
 /* Defines and macros
 */
+#define MAXSELCODE 32   /* Selected names for which codes are looked up */
 
 /************************************************************************/
 /* Globals
@@ -126,6 +141,8 @@
 /************************************************************************/
 /* Prototypes
 */
+static void GetSelectCodes(int nsel, char **sel, short *selcode);
+static BOOL AtomSelected(PDB *p, int nsel, char **sel, short *selcode);
 
 /************************************************************************/
 /*>PDB *blSelectAtomsPDBAsCopy(PDB *pdbin, int nsel, char **sel,
@@ -169,59 +186,85 @@
 -  04.02.09 Initialize q for fussy compliers
 -  07.07.14 Use bl prefix for functions By: CTP
 -  19.08.14 Renamed function to blSelectAtomsPDBAsCopy(). By: CTP
+-  18.10.26 Now a wrapper to blSelectAtomsPDBAsCopyArena()
 */
 PDB *blSelectAtomsPDBAsCopy(PDB *pdbin, int nsel, char **sel, int *natom)
+{
+   return(blSelectAtomsPDBAsCopyArena(pdbin, nsel, sel, natom, NULL));
+}
+
+
+/************************************************************************/
+/*>PDB *blSelectAtomsPDBAsCopyArena(PDB *pdbin, int nsel, char **sel,
+                                    int *natom, ARENA *arena)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]     *pdbin      Input list
+   \param[in]     nsel        Number of atom types to keep
+   \param[in]     **sel       List of atom types to keep
+   \param[out]    *natom      Number of atoms kept
+   \param[in,out] *arena      Arena from which to allocate the new 
+                              list. NULL to use malloc()
+   \return                    Output list
+
+   As blSelectAtomsPDBAsCopy(), but if an arena is given the new list is
+   allocated from it, with the atoms contiguous in memory and in list
+   order. The list is then freed with the arena rather than with
+   FREELIST(). On failure, anything already allocated from the arena is
+   left there.
+
+-  18.10.26 Original
+-  18.10.26 Compares name codes rather than names where both are set
+-  18.10.26 Matching moved to AtomSelected()
+*/
+PDB *blSelectAtomsPDBAsCopyArena(PDB *pdbin, int nsel, char **sel, 
+                                 int *natom, ARENA *arena)
 {
    PDB   *pdbout  = NULL,
          *p,
          *q = NULL;
-   int   i;
+   short selcode[MAXSELCODE];
     
    *natom = 0;
-   
+   GetSelectCodes(nsel, sel, selcode);
+
    /* Step through the input PDB linked list                            */
    for(p=pdbin; p!= NULL; NEXT(p))
    {
-      /* Step through the selection list                                */
-      for(i=0; i<nsel; i++)
+      if(AtomSelected(p, nsel, sel, selcode))
       {
-         /* See if there is a match                                     */
-         if(!strncmp(p->atnam,sel[i],4))
+         /* Alloacte a new entry                                        */
+         if(pdbout==NULL)
+         {
+            INITARENA(pdbout, PDB, arena);
+            q = pdbout;
+         }
+         else
+         {
+            ALLOCNEXTARENA(q, PDB, arena);
+         }
+         
+         /* If failed, free anything allocated and return               */
+         if(q==NULL)
          {
-            /* Alloacte a new entry                                     */
-            if(pdbout==NULL)
-            {
-               INIT(pdbout, PDB);
-               q = pdbout;
-            }
-            else
-            {
-               ALLOCNEXT(q, PDB);
-            }
-            
-            /* If failed, free anything allocated and return            */
-            if(q==NULL)
-            {
-               if(pdbout != NULL) FREELIST(pdbout,PDB);
-               *natom = 0;
-               return(NULL);
-            }
-            
-            /* Increment atom count                                     */
-            (*natom)++;
-            
-            /* Copy the record to the output list (sets ->next to NULL) */
-            blCopyPDB(q, p);
-            
-            break;
+            if(arena == NULL) FREELIST(pdbout, PDB);
+            *natom = 0;
+            return(NULL);
          }
+         
+         /* Increment atom count                                        */
+         (*natom)++;
+         
+         /* Copy the record to the output list (sets ->next to NULL)    */
+         blCopyPDB(q, p);
       }
    }
 
    /* Copy CONECT data                                                  */
    if(!blCopyConects(pdbout, pdbin))
    {
-      FREELIST(pdbout, PDB);
+      if(arena == NULL) FREELIST(pdbout, PDB);
       *natom = 0;
       return(NULL);
    }
@@ -230,3 +273,112 @@ PDB *blSelectAtomsPDBAsCopy(PDB *pdbin, int nsel, char **sel, int *natom)
    return(pdbout);
 }
 
+
+/************************************************************************/
+/*>PDBSELECTION *blSelectAtomsPDBAsView(PDB *pdbin, int nsel,
+                                        char **sel)
+   ----------------------------------------------------------
+*//**
+
+   \param[in]     *pdbin      Input list
+   \param[in]     nsel        Number of atom types to keep
+   \param[in]     **sel       List of atom types to keep
+   \return                    Selection of the atoms. NULL if no memory
+
+   As blSelectAtomsPDBAsCopy(), but the atoms are not copied. Instead
+   the selection points to them in the input list. If no atoms match,
+   the selection is empty. Free with blFreePDBSelection().
+
+-  18.10.26 Original
+*/
+PDBSELECTION *blSelectAtomsPDBAsView(PDB *pdbin, int nsel, char **sel)
+{
+   PDBSELECTION *view;
+   PDB          *p;
+   short        selcode[MAXSELCODE];
+
+   if((view = blAllocPDBSelection(pdbin))==NULL)
+      return(NULL);
+
+   GetSelectCodes(nsel, sel, selcode);
+
+   for(p=pdbin; p!=NULL; NEXT(p))
+   {
+      if(AtomSelected(p, nsel, sel, selcode) &&
+         !blAddAtomToPDBSelection(view, p))
+      {
+         blFreePDBSelection(view);
+         return(NULL);
+      }
+   }
+
+   return(view);
+}
+
+
+/************************************************************************/
+/*>static void GetSelectCodes(int nsel, char **sel, short *selcode)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in]     nsel        Number of atom types to keep
+   \param[in]     **sel       List of atom types to keep
+   \param[out]    *selcode    Name codes of the first MAXSELCODE types
+
+   Looks up the codes of the names to keep so that atoms with name
+   codes can be tested without comparing strings
+
+-  18.10.26 Original
+*/
+static void GetSelectCodes(int nsel, char **sel, short *selcode)
+{
+   int  i;
+   char name[5];
+
+   for(i=0; (i<nsel) && (i<MAXSELCODE); i++)
+   {
+      strncpy(name, sel[i], 4);
+      name[4] = '\0';
+      selcode[i] = (short)blGetPDBNameCode(name);
+   }
+}
+
+
+/************************************************************************/
+/*>static BOOL AtomSelected(PDB *p, int nsel, char **sel, short *selcode)
+   ----------------------------------------------------------------------
+*//**
+
+   \param[in]     *p          PDB record
+   \param[in]     nsel        Number of atom types to keep
+   \param[in]     **sel       List of atom types to keep
+   \param[in]     *selcode    Codes from GetSelectCodes()
+   \return                    Is the atom one of the types to keep?
+
+   Tests an atom against the selection list, comparing name codes
+   rather than names where both are set
+
+-  18.10.26 Original
+-  18.10.26 Checks the atom name code with blCheckPDBNameCode()
+-  18.10.26 Compares the atom name code directly again
+*/
+static BOOL AtomSelected(PDB *p, int nsel, char **sel, short *selcode)
+{
+   int i;
+
+   for(i=0; i<nsel; i++)
+   {
+      if((i < MAXSELCODE) && (selcode[i] != PDBNAME_UNKNOWN) &&
+         (p->atnam_code != PDBNAME_UNKNOWN))
+      {
+         if(p->atnam_code == selcode[i])
+            return(TRUE);
+      }
+      else if(!strncmp(p->atnam,sel[i],4))
+      {
+         return(TRUE);
+      }
+   }
+
+   return(FALSE);
+}
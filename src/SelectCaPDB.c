@@ -3,8 +3,8 @@
 
    \file       SelectCaPDB.c
    
-   \version    V1.8
-   \date       07.07.14
+   \version    V1.9
+   \date       18.10.26
    \brief      
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1990-2014
@@ -58,6 +58,7 @@
 -  V1.6  26.07.95 Removed unused variables
 -  V1.7  16.10.96 Added SelectCaPDB()
 -  V1.8  07.07.14 Use bl prefix for functions By: CTP
+-  V1.9  18.10.26 Detaches any indexes of the list
 
 *************************************************************************/
 /* Doxygen
@@ -120,11 +121,14 @@
 -  15.10.96 Original   By: ACRM
 -  11.01.02 Added check on pdb!=NULL in case there are no CAs (DNA etc)
 -  07.07.14 Use bl prefix for functions By: CTP
+-  18.10.26 Detaches any indexes of the list
 */
 PDB *blSelectCaPDB(PDB *pdb)
 {
    PDB *p, *prev;
 
+   blDetachPDBIndexes(pdb);
+
    /* Remove atoms up to the first CA                                   */
    while((pdb!=NULL) && strncmp(pdb->atnam,"CA  ",4))
    {
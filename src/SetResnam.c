@@ -3,12 +3,12 @@
 
    \file       SetResnam.c
    
-   \version    V1.3
-   \date       07.07.14
+   \version    V1.5
+   \date       18.10.26
    \brief      
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin, University of Reading, 
-               2002-2014
+               2002-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -50,6 +50,8 @@
 -  V1.1  01.03.94
 -  V1.2  27.02.98 Removed unreachable break from switch()
 -  V1.3  07.07.14 Use bl prefix for functions By: CTP
+-  V1.4  18.10.26 Sets name codes  By: ACRM
+-  V1.5  18.10.26 Detaches any indexes of the list
 
 *************************************************************************/
 /* Doxygen
@@ -94,9 +96,13 @@
    \param[in]     *chain      Chain label to set
 
    Change the residue name, number, insert and chain for an amino acid.
+   Any indexes attached to the list are detached since the residue
+   index would no longer be correct.
 
 -  12.05.92 Original
 -  07.07.14 Use bl prefix for functions By: CTP
+-  18.10.26 Sets name codes  By: ACRM
+-  18.10.26 Detaches any indexes of the list
 */
 void blSetResnam(PDB  *ResStart,
                  PDB  *NextRes,
@@ -106,6 +112,8 @@ void blSetResnam(PDB  *ResStart,
                  char *chain)
 {
    PDB *p;
+
+   blDetachPDBIndexes(ResStart);
    
    for(p=ResStart; p && p!=NextRes; NEXT(p))
    {
@@ -113,6 +121,7 @@ void blSetResnam(PDB  *ResStart,
       strcpy(p->insert, insert);
       strcpy(p->chain,  chain);
       p->resnum = resnum;
+      blSetPDBNameCodes(p);
    }
 }
 
@@ -3,11 +3,11 @@
 
    \file       StoreString.c
    
-   \version    V1.22
-   \date       07.07.14
+   \version    V1.24
+   \date       18.10.26
    \brief      
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1991-2014
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1991-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -72,6 +72,8 @@
 -  V1.20 18.09.96 Added padchar()
 -  V1.21 18.06.02 Added string.h
 -  V1.22 07.07.14 Use bl prefix for functions By: CTP
+-  V1.23 18.10.26 Added blAppendString()
+-  V1.24 18.10.26 Added blAppendStringArena()
 
 *************************************************************************/
 /* Doxygen
@@ -82,6 +84,13 @@
    Stores strings (of any length) in a linked list of type STRINGLIST.
    Return a pointer to the start of the linked list which is used on
    the first call to access the newly allocated memory.
+
+   #FUNCTION  blAppendString()
+   Appends a string to a STRINGLIST given a pointer to its last item
+   so that building a long list does not rescan it for every item.
+
+   #FUNCTION  blAppendStringArena()
+   As blAppendString() but can allocate from an arena.
 */
 /************************************************************************/
 /* Includes
@@ -183,3 +192,118 @@ STRINGLIST *blStoreString(STRINGLIST *StringList, char *string)
 }
 
 
+/************************************************************************/
+/*>STRINGLIST *blAppendString(STRINGLIST **pStringList, STRINGLIST *tail,
+                              char *string)
+   ----------------------------------------------------------------------
+*//**
+
+   \param[in,out] **pStringList  The linked list. Pointer to a NULL
+                                 pointer if nothing allocated yet
+   \param[in]     *tail          The last item in the list as returned
+                                 by the previous call. If NULL, the end
+                                 of the list is found
+   \param[in]     *string        The string to store
+   \return                       The new last item in the list. NULL if
+                                 unable to allocate.
+
+   As blStoreString(), but the caller keeps a pointer to the end of the
+   list and passes it back in, so each string is added in constant time
+   rather than walking the whole list. Empty strings are not stored.
+
+   If allocation fails, the whole list is freed, *pStringList is set to
+   NULL and the routine returns NULL.
+
+-  18.10.26 Original
+-  18.10.26 Now a wrapper to blAppendStringArena()
+*/
+STRINGLIST *blAppendString(STRINGLIST **pStringList, STRINGLIST *tail,
+                           char *string)
+{
+   return(blAppendStringArena(pStringList, tail, string, NULL));
+}
+
+
+/************************************************************************/
+/*>STRINGLIST *blAppendStringArena(STRINGLIST **pStringList, 
+                                   STRINGLIST *tail, char *string,
+                                   ARENA *arena)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in,out] **pStringList  The linked list. Pointer to a NULL
+                                 pointer if nothing allocated yet
+   \param[in]     *tail          The last item in the list as returned
+                                 by the previous call. If NULL, the end
+                                 of the list is found
+   \param[in]     *string        The string to store
+   \param[in,out] *arena         Arena from which to allocate the item
+                                 and the string. NULL to use malloc()
+   \return                       The new last item in the list. NULL if
+                                 unable to allocate.
+
+   As blAppendString(), but if an arena is given the list item and the
+   copy of the string are allocated from it. Such a list must not be
+   freed with blFreeStringList(); it goes when the arena is freed.
+
+   If allocation fails without an arena, the whole list is freed, 
+   *pStringList is set to NULL and the routine returns NULL. With an 
+   arena, the list is left alone and NULL is returned.
+
+-  18.10.26 Original
+*/
+STRINGLIST *blAppendStringArena(STRINGLIST **pStringList, 
+                                STRINGLIST *tail, char *string,
+                                ARENA *arena)
+{
+   STRINGLIST *p;
+
+   /* Find the end of the list if we weren't told                       */
+   if((tail == NULL) && (*pStringList != NULL))
+   {
+      tail = *pStringList;
+      LAST(tail);
+   }
+
+   if((string == NULL) || (string[0] == '\0'))
+      return(tail);
+
+   /* Add an item to the list                                           */
+   if(tail == NULL)
+   {
+      INITARENA((*pStringList), STRINGLIST, arena);
+      p = *pStringList;
+   }
+   else
+   {
+      p = tail;
+      ALLOCNEXTARENA(p, STRINGLIST, arena);
+   }
+
+   /* Allocate and copy the string                                      */
+   if(p != NULL)
+   {
+      if(arena != NULL)
+      {
+         if((p->string = blArenaStrdup(arena, string)) != NULL)
+            return(p);
+         return(NULL);
+      }
+
+      if((p->string = (char *)malloc((1+strlen(string))*sizeof(char)))
+         != NULL)
+      {
+         strcpy(p->string, string);
+         return(p);
+      }
+   }
+
+   /* No memory. The arena is freed by its owner                        */
+   if(arena != NULL)
+      return(NULL);
+
+   /* Otherwise free linked list and return                             */
+   blFreeStringList(*pStringList);
+   *pStringList = NULL;
+   return(NULL);
+}
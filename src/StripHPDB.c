@@ -3,12 +3,12 @@
 
    \file       StripHPDB.c
    
-   \version    V1.10
-   \date       19.04.15
+   \version    V1.12
+   \date       18.10.26
    \brief      
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin, University of Reading, 
-               2002-2015
+               2002-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -62,6 +62,8 @@
 -  V1.9  19.08.14 Renamed blStripHPDBAsCopy() to blStripHPDBAsCopy() 
                   By: CTP
 -  V1.10 19.04.15 Added call to blCopyConects()   By: ACRM
+-  V1.11 18.10.26 Added blStripHPDBAsCopyArena()
+-  V1.12 18.10.26 Added blStripHPDBAsView()
 
 *************************************************************************/
 /* Doxygen
@@ -70,6 +72,13 @@
    #SUBGROUP Modifying the structure
    #FUNCTION  blStripHPDBAsCopy()
    Take a PDB linked list and returns the PDB list minus hydrogens
+
+   #FUNCTION  blStripHPDBAsCopyArena()
+   As blStripHPDBAsCopy() but can allocate the new list from an arena.
+
+   #FUNCTION  blStripHPDBAsView()
+   As blStripHPDBAsCopy() but makes a selection of the atoms rather
+   than copying them.
 */
 /************************************************************************/
 /* Includes
@@ -111,8 +120,34 @@
 -  07.07.14 Use bl prefix for functions By: CTP
 -  19.08.14 Renamed function to blStripHPDBAsCopy() By: CTP
 -  19.04.15 Added call to blCopyConect()   By: ACRM
+-  18.10.26 Now a wrapper to blStripHPDBAsCopyArena()
 */
 PDB *blStripHPDBAsCopy(PDB *pdbin, int *natom)
+{
+   return(blStripHPDBAsCopyArena(pdbin, natom, NULL));
+}
+
+
+/************************************************************************/
+/*>PDB *blStripHPDBAsCopyArena(PDB *pdbin, int *natom, ARENA *arena)
+   ------------------------------------------------------------------
+*//**
+
+   \param[in]     *pdbin      Input list
+   \param[out]    *natom      Number of atoms kept
+   \param[in,out] *arena      Arena from which to allocate the new 
+                              list. NULL to use malloc()
+   \return                    Output list
+
+   As blStripHPDBAsCopy(), but if an arena is given the new list is
+   allocated from it, with the atoms contiguous in memory and in list
+   order. The list is then freed with the arena rather than with
+   FREELIST(). On failure, anything already allocated from the arena is
+   left there.
+
+-  18.10.26 Original
+*/
+PDB *blStripHPDBAsCopyArena(PDB *pdbin, int *natom, ARENA *arena)
 {
    PDB   *pdbout  = NULL,
          *p,
@@ -128,18 +163,18 @@ PDB *blStripHPDBAsCopy(PDB *pdbin, int *natom)
          /* Allocate a new entry                                        */
          if(pdbout==NULL)
          {
-            INIT(pdbout, PDB);
+            INITARENA(pdbout, PDB, arena);
             q = pdbout;
          }
          else
          {
-            ALLOCNEXT(q, PDB);
+            ALLOCNEXTARENA(q, PDB, arena);
          }
          
          /* If failed, free anything allocated and return               */
          if(q==NULL)
          {
-            if(pdbout != NULL) FREELIST(pdbout,PDB);
+            if(arena == NULL) FREELIST(pdbout, PDB);
             *natom = 0;
             return(NULL);
          }
@@ -155,7 +190,7 @@ PDB *blStripHPDBAsCopy(PDB *pdbin, int *natom)
    /* Copy CONECT data                                                  */
    if(!blCopyConects(pdbout, pdbin))
    {
-      FREELIST(pdbout, PDB);
+      if(arena == NULL) FREELIST(pdbout, PDB);
       *natom = 0;
       return(NULL);
    }
@@ -165,3 +200,37 @@ PDB *blStripHPDBAsCopy(PDB *pdbin, int *natom)
 }
 
 
+/************************************************************************/
+/*>PDBSELECTION *blStripHPDBAsView(PDB *pdbin)
+   --------------------------------------------
+*//**
+
+   \param[in]     *pdbin      Input list
+   \return                    Selection of the atoms. NULL if no memory
+
+   As blStripHPDBAsCopy(), but the atoms are not copied. Instead the
+   selection points to them in the input list. If no atoms are
+   selected, the selection is empty. Free with blFreePDBSelection().
+
+-  18.10.26 Original
+*/
+PDBSELECTION *blStripHPDBAsView(PDB *pdbin)
+{
+   PDBSELECTION *view;
+   PDB          *p;
+
+   if((view = blAllocPDBSelection(pdbin))==NULL)
+      return(NULL);
+
+   for(p=pdbin; p!=NULL; NEXT(p))
+   {
+      if((p->atnam[0] != 'H') &&
+         !blAddAtomToPDBSelection(view, p))
+      {
+         blFreePDBSelection(view);
+         return(NULL);
+      }
+   }
+
+   return(view);
+}
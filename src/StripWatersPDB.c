@@ -3,11 +3,11 @@
 
    \file       StripWatersPDB.c
    
-   \version    V1.3
-   \date       19.04.15
+   \version    V1.5
+   \date       18.10.26
    \brief      
    
-   \copyright  (c) Dr. Andrew C. R. Martin, UCL, 2008-2014
+   \copyright  (c) Dr. Andrew C. R. Martin, UCL, 2008-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -51,6 +51,8 @@
 -  V1.2  19.08.14 Renamed function blStripWatersPDB() to 
                   blStripWatersPDBAsCopy() By: CTP
 -  V1.3  19.04.15 Added call to blCopyConect()   By: ACRM
+-  V1.4  18.10.26 Added blStripWatersPDBAsCopyArena()
+-  V1.5  18.10.26 Added blStripWatersPDBAsView()
 
 *************************************************************************/
 /* Doxygen
@@ -59,6 +61,14 @@
    #SUBGROUP Modifying the structure
    #FUNCTION  blStripWatersPDBAsCopy()
    Take a PDB linked list and returns the PDB list minus waters
+
+   #FUNCTION  blStripWatersPDBAsCopyArena()
+   As blStripWatersPDBAsCopy() but can allocate the new list from an
+   arena.
+
+   #FUNCTION  blStripWatersPDBAsView()
+   As blStripWatersPDBAsCopy() but makes a selection of the atoms
+   rather than copying them.
 */
 /************************************************************************/
 /* Includes
@@ -95,8 +105,35 @@
 -  30.04.08 Original based on StripHPDB()   By: ACRM
 -  19.08.14 Renamed function to blStripWatersPDBAsCopy() By: CTP
 -  12.04.15 Added rebuild of CONECT data
+-  18.10.26 Now a wrapper to blStripWatersPDBAsCopyArena()
 */
 PDB *blStripWatersPDBAsCopy(PDB *pdbin, int *natom)
+{
+   return(blStripWatersPDBAsCopyArena(pdbin, natom, NULL));
+}
+
+
+/************************************************************************/
+/*>PDB *blStripWatersPDBAsCopyArena(PDB *pdbin, int *natom, 
+                                      ARENA *arena)
+   ----------------------------------------------------------
+*//**
+
+   \param[in]     *pdbin      Input list
+   \param[out]    *natom      Number of atoms kept
+   \param[in,out] *arena      Arena from which to allocate the new 
+                              list. NULL to use malloc()
+   \return                    Output list
+
+   As blStripWatersPDBAsCopy(), but if an arena is given the new list is
+   allocated from it, with the atoms contiguous in memory and in list
+   order. The list is then freed with the arena rather than with
+   FREELIST(). On failure, anything already allocated from the arena is
+   left there.
+
+-  18.10.26 Original
+*/
+PDB *blStripWatersPDBAsCopyArena(PDB *pdbin, int *natom, ARENA *arena)
 {
    PDB   *pdbout  = NULL,
          *p,
@@ -112,18 +149,18 @@ PDB *blStripWatersPDBAsCopy(PDB *pdbin, int *natom)
          /* Allocate a new entry                                        */
          if(pdbout==NULL)
          {
-            INIT(pdbout, PDB);
+            INITARENA(pdbout, PDB, arena);
             q = pdbout;
          }
          else
          {
-            ALLOCNEXT(q, PDB);
+            ALLOCNEXTARENA(q, PDB, arena);
          }
          
          /* If failed, free anything allocated and return               */
          if(q==NULL)
          {
-            if(pdbout != NULL) FREELIST(pdbout,PDB);
+            if(arena == NULL) FREELIST(pdbout, PDB);
             *natom = 0;
             return(NULL);
          }
@@ -139,7 +176,7 @@ PDB *blStripWatersPDBAsCopy(PDB *pdbin, int *natom)
    /* Copy CONECT data to new linked list                               */
    if(!blCopyConects(pdbout, pdbin))
    {
-      FREELIST(pdbout, PDB);
+      if(arena == NULL) FREELIST(pdbout, PDB);
       *natom = 0;
       return(NULL);
    }
@@ -147,3 +184,39 @@ PDB *blStripWatersPDBAsCopy(PDB *pdbin, int *natom)
    /* Return pointer to start of output list                            */
    return(pdbout);
 }
+
+
+/************************************************************************/
+/*>PDBSELECTION *blStripWatersPDBAsView(PDB *pdbin)
+   -------------------------------------------------
+*//**
+
+   \param[in]     *pdbin      Input list
+   \return                    Selection of the atoms. NULL if no memory
+
+   As blStripWatersPDBAsCopy(), but the atoms are not copied. Instead the
+   selection points to them in the input list. If no atoms are
+   selected, the selection is empty. Free with blFreePDBSelection().
+
+-  18.10.26 Original
+*/
+PDBSELECTION *blStripWatersPDBAsView(PDB *pdbin)
+{
+   PDBSELECTION *view;
+   PDB          *p;
+
+   if((view = blAllocPDBSelection(pdbin))==NULL)
+      return(NULL);
+
+   for(p=pdbin; p!=NULL; NEXT(p))
+   {
+      if(!ISWATER(p) &&
+         !blAddAtomToPDBSelection(view, p))
+      {
+         blFreePDBSelection(view);
+         return(NULL);
+      }
+   }
+
+   return(view);
+}
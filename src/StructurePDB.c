@@ -3,11 +3,11 @@
 
    \file       StructurePDB.c
    
-   \version    V1.3
-   \date       07.07.14
+   \version    V1.4
+   \date       18.10.26
    \brief      Build a structured PDB representation
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2009-14
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2009-26
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -50,6 +50,7 @@
 -  V1.1   19.05.10  PDBRESIDUE and PDBCHAIN are doubly linked lists
 -  V1.2   04.02.14  Use CHAINMATCH By: CTP
 -  V1.3   07.07.14  Use bl prefix for functions By: CTP
+-  V1.4   18.10.26  Chains and residues are allocated from an arena
 
 *************************************************************************/
 /* Doxygen
@@ -101,10 +102,15 @@
    Takes a PDB linked list and converts it into a hierarchical structure
    of chains, residues and atoms
 
+   The chains and residues are allocated from an arena owned by the
+   PDBSTRUCT so they are contiguous in memory and are freed in one go
+   by blFreePDBStructure(). They must not be freed individually.
+
 -  24.11.09  Original   By: ACRM
 -  19.05.10  Correctly do doubly linked lists
 -  02.06.10  Fixed some initializations!
 -  07.07.14 Use bl prefix for functions By: CTP
+-  18.10.26 Allocates the chains and residues from an arena
 */
 PDBSTRUCT *blAllocPDBStructure(PDB *pdb)
 {
@@ -121,6 +127,9 @@ PDBSTRUCT *blAllocPDBStructure(PDB *pdb)
    pdbstruct->pdb = pdb;
    pdbstruct->chains = NULL;
    pdbstruct->extras = NULL;             /* 02.06.10                    */
+
+   /* If the arena can't be created, malloc() is used instead           */
+   pdbstruct->arena  = blCreateArena(0);
    
    /* Build the chain list                                              */
    for(pdbc=pdb; pdbc!=NULL; pdbc=nextchain)
@@ -129,12 +138,12 @@ PDBSTRUCT *blAllocPDBStructure(PDB *pdb)
 
       if(pdbstruct->chains == NULL)
       {
-         INITPREV(pdbstruct->chains, PDBCHAIN);
+         INITPREVARENA(pdbstruct->chains, PDBCHAIN, pdbstruct->arena);
          chain = pdbstruct->chains;
       }
       else
       {
-         ALLOCNEXTPREV(chain, PDBCHAIN);
+         ALLOCNEXTPREVARENA(chain, PDBCHAIN, pdbstruct->arena);
       }
       if(chain == NULL)
       {
@@ -161,12 +170,13 @@ PDBSTRUCT *blAllocPDBStructure(PDB *pdb)
          
          if(chain->residues == NULL)
          {
-            INITPREV(chain->residues, PDBRESIDUE);
+            INITPREVARENA(chain->residues, PDBRESIDUE, 
+                          pdbstruct->arena);
             residue = chain->residues;
          }
          else
          {
-            ALLOCNEXTPREV(residue, PDBRESIDUE);
+            ALLOCNEXTPREVARENA(residue, PDBRESIDUE, pdbstruct->arena);
          }
          if(residue == NULL)
          {
@@ -215,6 +225,7 @@ PDBSTRUCT *blAllocPDBStructure(PDB *pdb)
 
 -  24.11.09  Original   By: ACRM
 -  07.07.14 Use bl prefix for functions By: CTP
+-  18.10.26 Frees the arena holding the chains and residues
 */
 void blFreePDBStructure(PDBSTRUCT *pdbstruct)
 {
@@ -222,6 +233,13 @@ void blFreePDBStructure(PDBSTRUCT *pdbstruct)
 
    if(pdbstruct == NULL)
       return;
+
+   if(pdbstruct->arena != NULL)
+   {
+      blFreeArena(pdbstruct->arena);
+      free(pdbstruct);
+      return;
+   }
    
    for(chain = pdbstruct->chains; chain!=NULL; NEXT(chain))
    {
@@ -3,8 +3,8 @@
 
    \file       TermPDB.c
    
-   \version    V1.12
-   \date       07.07.14
+   \version    V1.13
+   \date       18.10.26
    \brief      
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-2014
@@ -59,6 +59,7 @@
 -  V1.10 08.10.99 Initialised some variables
 -  V1.11 04.02.14 Use CHAINMATCH macro. By: CTP
 -  V1.12 07.07.14 Use bl prefix for functions By: CTP
+-  V1.13 18.10.26 Detaches any indexes of the list
 
 *************************************************************************/
 /* Doxygen
@@ -108,6 +109,7 @@
 -  26.09.95 Corrected update of resnum etc to use p-> not pdb-> (!!)
 -  04.02.14 Use CHAINMATCH macro. By: CTP
 -  07.07.14 Use bl prefix for functions By: CTP
+-  18.10.26 Detaches any indexes of the list
 */
 PDB *blTermPDB(PDB *pdb, int length)
 {
@@ -117,6 +119,8 @@ PDB *blTermPDB(PDB *pdb, int length)
         chain[8];
    PDB  *p,
         *prev = NULL;
+
+   blDetachPDBIndexes(pdb);
    
    resnum = pdb->resnum;
    insert = pdb->insert[0];
@@ -0,0 +1,723 @@
+/************************************************************************/
+/**
+
+   \file       WholePDBBinary.c
+
+   \version    V1.5
+   \date       18.10.26
+   \brief      Write and read a WHOLEPDB structure as a binary cache file
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Programs which read the same PDB files every time they are run spend
+   most of their start-up time parsing text. blWriteWholePDBBinary()
+   saves a WHOLEPDB as a binary file which blReadWholePDBBinary() turns
+   back into a WHOLEPDB with no text parsing at all.
+
+   The file starts with a fixed header giving a magic string, the
+   format version, a byte order marker and the size of an atom record,
+   followed by the counts of what follows:
+   - one fixed-size record for each atom in the order of the linked
+     list. Coordinates are always stored as doubles;
+   - the CONECT links of each atom in turn, as indices into the atom
+     records;
+   - the header and trailer lines, each as a length and the characters.
+
+   Files are only readable on machines with the same byte order and
+   structure layout; blReadWholePDBBinary() checks this and returns
+   NULL rather than misreading a file. They are read through
+   blOpenLineInput() so regular files are memory mapped and the records
+   are copied straight from the mapping. Compressed cache files are
+   also accepted.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+\code
+   if((wpdb = blReadWholePDBBinary(fpCache))==NULL)
+   {
+      wpdb = blReadWholePDB(fpPDB);
+      blWriteWholePDBBinary(fpCache, wpdb);
+   }
+\endcode
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  18.10.26 Original
+-  V1.1  18.10.26 blReadWholePDBBinary() indexes the header
+-  V1.2  18.10.26 blReadWholePDBBinary() initialises wpdb->arena
+-  V1.3  18.10.26 blReadWholePDBBinary() sets the name codes
+-  V1.4  18.10.26 blReadWholePDBBinary() clears the indexes field
+-  V1.5  18.10.26 blReadWholePDBBinary() terminates the names read and
+                  rejects atoms with too many CONECTs
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP File IO
+   #FUNCTION  blWriteWholePDBBinary()
+   Writes a WHOLEPDB structure as a binary cache file.
+
+   #FUNCTION  blReadWholePDBBinary()
+   Reads a binary cache file written by blWriteWholePDBBinary().
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "MathType.h"
+#include "SysDefs.h"
+#include "pdb.h"
+#include "macros.h"
+#include "general.h"
+#include "LineInput.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define BINPDB_MAGIC     "BLWHLPDB"  /* 8 characters, not terminated    */
+#define BINPDB_VERSION   1
+#define BINPDB_BYTEORDER 0x01020304
+#define MAXBUFF          160         /* Chunk size for blOpenLineInput()*/
+
+typedef struct             /* Start of the file                         */
+{
+   char magic[8];          /* BINPDB_MAGIC                              */
+   int  version,           /* BINPDB_VERSION                            */
+        byteOrder,         /* BINPDB_BYTEORDER as written               */
+        atomSize,          /* sizeof(BINPDBATOM)                        */
+        nrecords,          /* Number of atom records                    */
+        natoms,            /* natoms from the WHOLEPDB                  */
+        nheader,           /* Number of header lines                    */
+        ntrailer,          /* Number of trailer lines                   */
+        maxString;         /* Length of the longest line                */
+}  BINPDBHEADER;
+
+typedef struct             /* An atom. Pointers are not stored          */
+{
+   double x, y, z,
+          occ, bval,
+          access, radius,
+          partial_charge;
+   int    atnum,
+          resnum,
+          formal_charge,
+          nConect,
+          entity_id,
+          atomtype;
+   char   record_type[8],
+          atnam[8],
+          atnam_raw[8],
+          resnam[8],
+          insert[8],
+          chain[8],
+          element[8],
+          segid[8],
+          altpos,
+          secstr,
+          pad[6];          /* Keeps the record size a multiple of 8     */
+}  BINPDBATOM;
+
+typedef struct             /* Used to find the index of a CONECT atom   */
+{
+   PDB *p;
+   int index;
+}  BINPDBINDEX;
+
+/************************************************************************/
+/* Prototypes
+*/
+static BINPDBINDEX *IndexAtomPointers(PDB *pdb, int natoms);
+static int CompareAtomPointers(const void *a, const void *b);
+static int FindAtomIndex(BINPDBINDEX *index, int natoms, PDB *p);
+static void CopyLabelBinary(char *out, char *in);
+static BOOL WriteStringsBinary(FILE *fp, STRINGLIST *strings);
+static BOOL ReadBinaryBlock(LINEINPUT *li, char *buffer, int size);
+static BOOL ReadStringsBinary(LINEINPUT *li, int nstrings,
+                              char *buffer, int maxlen,
+                              STRINGLIST **strings);
+
+
+/************************************************************************/
+/*>BOOL blWriteWholePDBBinary(FILE *fp, WHOLEPDB *wpdb)
+   ----------------------------------------------------
+*//**
+
+   \param[in]     *fp       File opened for writing in binary mode
+   \param[in]     *wpdb     WHOLEPDB structure to write
+   \return                  Success?
+
+   Writes a WHOLEPDB structure as a binary file which can be read back
+   with blReadWholePDBBinary(). CONECT links to atoms which are not in
+   the linked list are not stored. The atoms' extras pointers are not
+   stored.
+
+-  18.10.26 Original
+*/
+BOOL blWriteWholePDBBinary(FILE *fp, WHOLEPDB *wpdb)
+{
+   BINPDBHEADER header;
+   BINPDBATOM   atom;
+   BINPDBINDEX  *index = NULL;
+   STRINGLIST   *s;
+   PDB          *p;
+   int          i,
+                len,
+                nconect = 0,
+                conect[MAXCONECT];
+
+   memset(&header, 0, sizeof(BINPDBHEADER));
+   memcpy(header.magic, BINPDB_MAGIC, 8);
+   header.version   = BINPDB_VERSION;
+   header.byteOrder = BINPDB_BYTEORDER;
+   header.atomSize  = sizeof(BINPDBATOM);
+   header.natoms    = wpdb->natoms;
+
+   for(p=wpdb->pdb; p!=NULL; NEXT(p))
+   {
+      header.nrecords++;
+      nconect += p->nConect;
+   }
+   for(s=wpdb->header; s!=NULL; NEXT(s))
+   {
+      header.nheader++;
+      if((s->string != NULL) &&
+         ((len = strlen(s->string)) > header.maxString))
+         header.maxString = len;
+   }
+   for(s=wpdb->trailer; s!=NULL; NEXT(s))
+   {
+      header.ntrailer++;
+      if((s->string != NULL) &&
+         ((len = strlen(s->string)) > header.maxString))
+         header.maxString = len;
+   }
+
+   /* CONECTs are stored as atom indices                                */
+   if((nconect != 0) &&
+      ((index = IndexAtomPointers(wpdb->pdb, header.nrecords))==NULL))
+      return(FALSE);
+
+   if(fwrite(&header, sizeof(BINPDBHEADER), 1, fp) != 1)
+   {
+      FREE(index);
+      return(FALSE);
+   }
+
+   /* Atom records. The record is cleared first so that the unused
+      bytes of the strings are always the same
+   */
+   for(p=wpdb->pdb; p!=NULL; NEXT(p))
+   {
+      memset(&atom, 0, sizeof(BINPDBATOM));
+      atom.x              = (double)p->x;
+      atom.y              = (double)p->y;
+      atom.z              = (double)p->z;
+      atom.occ            = (double)p->occ;
+      atom.bval           = (double)p->bval;
+      atom.access         = (double)p->access;
+      atom.radius         = (double)p->radius;
+      atom.partial_charge = (double)p->partial_charge;
+      atom.atnum          = p->atnum;
+      atom.resnum         = p->resnum;
+      atom.formal_charge  = p->formal_charge;
+      atom.nConect        = p->nConect;
+      atom.entity_id      = p->entity_id;
+      atom.atomtype       = p->atomtype;
+      atom.altpos         = p->altpos;
+      atom.secstr         = p->secstr;
+      CopyLabelBinary(atom.record_type, p->record_type);
+      CopyLabelBinary(atom.atnam,       p->atnam);
+      CopyLabelBinary(atom.atnam_raw,   p->atnam_raw);
+      CopyLabelBinary(atom.resnam,      p->resnam);
+      CopyLabelBinary(atom.insert,      p->insert);
+      CopyLabelBinary(atom.chain,       p->chain);
+      CopyLabelBinary(atom.element,     p->element);
+      CopyLabelBinary(atom.segid,       p->segid);
+
+      if(fwrite(&atom, sizeof(BINPDBATOM), 1, fp) != 1)
+      {
+         FREE(index);
+         return(FALSE);
+      }
+   }
+
+   /* CONECT indices                                                    */
+   if(index != NULL)
+   {
+      for(p=wpdb->pdb; p!=NULL; NEXT(p))
+      {
+         if(p->nConect == 0)
+            continue;
+
+         for(i=0; i<p->nConect; i++)
+            conect[i] = FindAtomIndex(index, header.nrecords,
+                                      p->conect[i]);
+         if(fwrite(conect, sizeof(int), p->nConect, fp) !=
+            (size_t)p->nConect)
+         {
+            FREE(index);
+            return(FALSE);
+         }
+      }
+      free(index);
+   }
+
+   /* Header and trailer lines                                          */
+   if(!WriteStringsBinary(fp, wpdb->header) ||
+      !WriteStringsBinary(fp, wpdb->trailer))
+      return(FALSE);
+
+   return(ferror(fp) ? FALSE : TRUE);
+}
+
+
+/************************************************************************/
+/*>WHOLEPDB *blReadWholePDBBinary(FILE *fp)
+   ----------------------------------------
+*//**
+
+   \param[in]     *fp       File opened for reading in binary mode
+   \return                  WHOLEPDB structure. NULL if the file could
+                            not be read or is not a binary file from
+                            blWriteWholePDBBinary() with the same
+                            format version and byte order, or is
+                            truncated or corrupt
+
+   Reads a file written by blWriteWholePDBBinary(). The result is the
+   same as a WHOLEPDB from blReadWholePDB() and is freed with
+   blFreeWholePDB().
+
+-  18.10.26 Original
+-  18.10.26 Indexes the header
+-  18.10.26 Initialises wpdb->arena
+-  18.10.26 Sets the name codes
+-  18.10.26 Clears the indexes field
+-  18.10.26 Terminates the names and rejects a CONECT count larger
+            than MAXCONECT
+*/
+WHOLEPDB *blReadWholePDBBinary(FILE *fp)
+{
+   LINEINPUT    *li;
+   BINPDBHEADER header;
+   BINPDBATOM   atom;
+   WHOLEPDB     *wpdb;
+   PDB          *p     = NULL,
+                **atoms = NULL;
+   char         *buffer = NULL;
+   int          i, j,
+                natoms = 0,
+                nConect,
+                conect[MAXCONECT];
+   BOOL         ok = TRUE;
+
+   if((li = blOpenLineInput(fp, MAXBUFF))==NULL)
+      return(NULL);
+
+   if(!ReadBinaryBlock(li, (char *)&header, sizeof(BINPDBHEADER)) ||
+      strncmp(header.magic, BINPDB_MAGIC, 8) ||
+      (header.version   != BINPDB_VERSION)   ||
+      (header.byteOrder != BINPDB_BYTEORDER) ||
+      (header.atomSize  != (int)sizeof(BINPDBATOM)) ||
+      (header.nrecords < 0) || (header.maxString < 0))
+   {
+      blCloseLineInput(li);
+      return(NULL);
+   }
+
+   if((wpdb=(WHOLEPDB *)malloc(sizeof(WHOLEPDB)))==NULL)
+   {
+      blCloseLineInput(li);
+      return(NULL);
+   }
+   wpdb->pdb         = NULL;
+   wpdb->header      = NULL;
+   wpdb->trailer     = NULL;
+   wpdb->headerIndex = NULL;
+   wpdb->arena       = NULL;
+   wpdb->natoms      = 0;
+
+   /* Array of the atoms for linking the CONECTs                        */
+   if((header.nrecords != 0) &&
+      ((atoms = (PDB **)malloc(header.nrecords * sizeof(PDB *)))==NULL))
+      ok = FALSE;
+
+   /* Atom records                                                      */
+   for(i=0; ok && (i<header.nrecords); i++)
+   {
+      if(!ReadBinaryBlock(li, (char *)&atom, sizeof(BINPDBATOM)))
+      {
+         ok = FALSE;
+         break;
+      }
+      if((atom.nConect < 0) || (atom.nConect > MAXCONECT))
+      {
+         ok = FALSE;
+         break;
+      }
+
+      if(wpdb->pdb == NULL)
+      {
+         INIT(wpdb->pdb, PDB);
+         p = wpdb->pdb;
+      }
+      else
+      {
+         ALLOCNEXT(p, PDB);
+      }
+      if(p == NULL)
+      {
+         ok = FALSE;
+         break;
+      }
+
+      p->x              = (REAL)atom.x;
+      p->y              = (REAL)atom.y;
+      p->z              = (REAL)atom.z;
+      p->occ            = (REAL)atom.occ;
+      p->bval           = (REAL)atom.bval;
+      p->access         = (REAL)atom.access;
+      p->radius         = (REAL)atom.radius;
+      p->partial_charge = (REAL)atom.partial_charge;
+      p->extras         = NULL;
+      p->atomInfo       = NULL;
+      p->next           = NULL;
+      p->indexes        = NULL;
+      p->atnum          = atom.atnum;
+      p->resnum         = atom.resnum;
+      p->formal_charge  = atom.formal_charge;
+      p->nConect        = atom.nConect;
+      p->entity_id      = atom.entity_id;
+      p->atomtype       = atom.atomtype;
+      p->altpos         = atom.altpos;
+      p->secstr         = atom.secstr;
+      memcpy(p->record_type, atom.record_type, 8);
+      memcpy(p->atnam,       atom.atnam,       8);
+      memcpy(p->atnam_raw,   atom.atnam_raw,   8);
+      memcpy(p->resnam,      atom.resnam,      8);
+      memcpy(p->insert,      atom.insert,      8);
+      memcpy(p->chain,       atom.chain,       8);
+      memcpy(p->element,     atom.element,     8);
+      memcpy(p->segid,       atom.segid,       8);
+
+      /* Terminate the names in case the file is corrupt                */
+      p->record_type[7] = '\0';
+      p->atnam[7]       = '\0';
+      p->atnam_raw[7]   = '\0';
+      p->resnam[7]      = '\0';
+      p->insert[7]      = '\0';
+      p->chain[7]       = '\0';
+      p->element[7]     = '\0';
+      p->segid[7]       = '\0';
+      blSetPDBNameCodes(p);
+
+      atoms[natoms++] = p;
+   }
+
+   /* Link the CONECTs. Links which were not stored are dropped         */
+   for(i=0; ok && (i<natoms); i++)
+   {
+      p = atoms[i];
+      if((nConect = p->nConect) == 0)
+         continue;
+
+      if(!ReadBinaryBlock(li, (char *)conect, nConect * sizeof(int)))
+      {
+         ok = FALSE;
+         break;
+      }
+
+      for(j=0, p->nConect=0; j<nConect; j++)
+      {
+         if((conect[j] >= 0) && (conect[j] < natoms))
+            p->conect[(p->nConect)++] = atoms[conect[j]];
+      }
+   }
+
+   FREE(atoms);
+   wpdb->natoms = header.natoms;
+
+   /* Header and trailer lines                                          */
+   if(ok &&
+      ((buffer = (char *)malloc((header.maxString + 1) * sizeof(char)))
+       ==NULL))
+      ok = FALSE;
+
+   if(ok)
+      ok = ReadStringsBinary(li, header.nheader, buffer,
+                             header.maxString, &(wpdb->header)) &&
+           ReadStringsBinary(li, header.ntrailer, buffer,
+                             header.maxString, &(wpdb->trailer));
+
+   FREE(buffer);
+   blCloseLineInput(li);
+
+   if(!ok)
+   {
+      blFreeWholePDB(wpdb);
+      return(NULL);
+   }
+
+   blIndexWholePDBHeader(wpdb);
+   return(wpdb);
+}
+
+
+/************************************************************************/
+/*>static BINPDBINDEX *IndexAtomPointers(PDB *pdb, int natoms)
+   -----------------------------------------------------------
+*//**
+
+   \param[in]     *pdb      PDB linked list
+   \param[in]     natoms    Number of atoms in the list
+   \return                  Atom pointers with their positions in the
+                            list, sorted by pointer (NULL if no memory)
+
+   Builds an index used by FindAtomIndex() to look up the position of
+   a CONECT atom in the list.
+
+-  18.10.26 Original
+*/
+static BINPDBINDEX *IndexAtomPointers(PDB *pdb, int natoms)
+{
+   BINPDBINDEX *index;
+   PDB         *p;
+   int         i;
+
+   if((index = (BINPDBINDEX *)malloc(natoms * sizeof(BINPDBINDEX)))
+      ==NULL)
+      return(NULL);
+
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      index[i].p     = p;
+      index[i].index = i;
+   }
+
+   qsort(index, natoms, sizeof(BINPDBINDEX), CompareAtomPointers);
+   return(index);
+}
+
+
+/************************************************************************/
+/*>static int CompareAtomPointers(const void *a, const void *b)
+   ------------------------------------------------------------
+*//**
+
+   \param[in]     *a        First BINPDBINDEX
+   \param[in]     *b        Second BINPDBINDEX
+   \return                  -1, 0 or 1 ordering the atom pointers
+
+   Comparison function for qsort() and bsearch()
+
+-  18.10.26 Original
+*/
+static int CompareAtomPointers(const void *a, const void *b)
+{
+   PDB *pa = ((BINPDBINDEX *)a)->p,
+       *pb = ((BINPDBINDEX *)b)->p;
+
+   if(pa < pb)
+      return(-1);
+   if(pa > pb)
+      return(1);
+   return(0);
+}
+
+
+/************************************************************************/
+/*>static int FindAtomIndex(BINPDBINDEX *index, int natoms, PDB *p)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]     *index    Index from IndexAtomPointers()
+   \param[in]     natoms    Number of atoms in the index
+   \param[in]     *p        Atom to find
+   \return                  Position of the atom in the list (-1 if
+                            it is not in the list)
+
+-  18.10.26 Original
+*/
+static int FindAtomIndex(BINPDBINDEX *index, int natoms, PDB *p)
+{
+   BINPDBINDEX key,
+               *found;
+
+   key.p = p;
+   if((found = (BINPDBINDEX *)bsearch(&key, index, natoms,
+                                      sizeof(BINPDBINDEX),
+                                      CompareAtomPointers))==NULL)
+      return(-1);
+   return(found->index);
+}
+
+
+/************************************************************************/
+/*>static void CopyLabelBinary(char *out, char *in)
+   ------------------------------------------------
+*//**
+
+   \param[out]    *out      Cleared 8-character field in an atom record
+   \param[in]     *in       String from a PDB structure
+
+   Copies up to 7 characters leaving the rest of the field cleared.
+
+-  18.10.26 Original
+*/
+static void CopyLabelBinary(char *out, char *in)
+{
+   int i;
+
+   for(i=0; (i<7) && (in[i] != '\0'); i++)
+      out[i] = in[i];
+}
+
+
+/************************************************************************/
+/*>static BOOL WriteStringsBinary(FILE *fp, STRINGLIST *strings)
+   -------------------------------------------------------------
+*//**
+
+   \param[in]     *fp       Output file
+   \param[in]     *strings  Linked list of strings
+   \return                  Success?
+
+   Writes each string as its length followed by the characters.
+
+-  18.10.26 Original
+*/
+static BOOL WriteStringsBinary(FILE *fp, STRINGLIST *strings)
+{
+   STRINGLIST *s;
+   int        len;
+
+   for(s=strings; s!=NULL; NEXT(s))
+   {
+      len = (s->string == NULL) ? 0 : strlen(s->string);
+      if(fwrite(&len, sizeof(int), 1, fp) != 1)
+         return(FALSE);
+      if((len != 0) &&
+         (fwrite(s->string, sizeof(char), len, fp) != (size_t)len))
+         return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL ReadBinaryBlock(LINEINPUT *li, char *buffer, int size)
+   ------------------------------------------------------------------
+*//**
+
+   \param[in]     *li       Input
+   \param[out]    *buffer   Buffer for the data
+   \param[in]     size      Number of bytes to read
+   \return                  Were all the bytes read?
+
+   Copies the next size bytes from the input. The data are copied since
+   a memory mapped file gives no guarantee of alignment.
+
+-  18.10.26 Original
+*/
+static BOOL ReadBinaryBlock(LINEINPUT *li, char *buffer, int size)
+{
+   char *data;
+   int  nread;
+
+   while(size > 0)
+   {
+      if((data = blGetBlockLineInput(li, size, &nread))
+         ==NULL)
+         return(FALSE);
+      memcpy(buffer, data, (size_t)nread);
+      buffer += nread;
+      size   -= nread;
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL ReadStringsBinary(LINEINPUT *li, int nstrings,
+                                 char *buffer, int maxlen,
+                                 STRINGLIST **strings)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]     *li       Input
+   \param[in]     nstrings  Number of strings to read
+   \param[in]     *buffer   Buffer for maxlen characters plus the
+                            terminator
+   \param[in]     maxlen    Length of the longest string
+   \param[out]    **strings Linked list of the strings
+   \return                  Success?
+
+   Reads strings written by WriteStringsBinary(). Each string is added
+   at the end of the list directly rather than by walking the list.
+
+-  18.10.26 Original
+*/
+static BOOL ReadStringsBinary(LINEINPUT *li, int nstrings,
+                              char *buffer, int maxlen,
+                              STRINGLIST **strings)
+{
+   STRINGLIST *tail = NULL,
+              *s;
+   int        i,
+              len;
+
+   for(i=0; i<nstrings; i++)
+   {
+      if(!ReadBinaryBlock(li, (char *)&len, sizeof(int)))
+         return(FALSE);
+      if((len < 0) || (len > maxlen))
+         return(FALSE);
+      if((len != 0) && !ReadBinaryBlock(li, buffer, len))
+         return(FALSE);
+      buffer[len] = '\0';
+
+      if((s = blStoreString(NULL, buffer))==NULL)
+         return(FALSE);
+      if(tail == NULL)
+         *strings = s;
+      else
+         tail->next = s;
+      tail = s;
+   }
+   return(TRUE);
+}
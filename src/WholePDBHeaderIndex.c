@@ -0,0 +1,435 @@
+/************************************************************************/
+/**
+
+   \file       WholePDBHeaderIndex.c
+
+   \version    V1.0
+   \date       18.10.26
+   \brief      Index of the header records in a WHOLEPDB structure
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   The header of a WHOLEPDB is a STRINGLIST holding one PDB record per
+   item. Routines that extract information from it used to walk the
+   whole list looking for the records they needed, which is slow for
+   entries with thousands of REMARK lines.
+
+   blIndexWholePDBHeader() walks the list once and stores, in a hash
+   keyed by record type, the first and last line of each type. REMARK
+   lines are indexed both as "REMARK" and by their number (e.g.
+   "REMARK 350"). The readers build the index as they finish reading a
+   file. blGetHeaderRecordsWholePDB() and blGetHeaderSpanWholePDB() then
+   return the part of the list holding the records of interest.
+
+   In a correctly formatted PDB file each record type forms a single
+   block. If not, the range returned runs from the first to the last
+   line of that type, so callers must still check the type of each
+   line.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+\code
+   STRINGLIST *s, *first, *stop;
+   first = blGetHeaderRecordsWholePDB(wpdb, "SEQRES", &stop);
+   for(s=first; s!=stop; NEXT(s))
+   {
+      if(!strncmp(s->string, "SEQRES", 6))
+         ...
+   }
+\endcode
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  18.10.26 Original
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP File IO
+   #FUNCTION  blIndexWholePDBHeader()
+   Builds (or rebuilds) the index of header records in a WHOLEPDB.
+
+   #FUNCTION  blFreeWholePDBHeaderIndex()
+   Frees the index of header records in a WHOLEPDB.
+
+   #FUNCTION  blGetHeaderRecordsWholePDB()
+   Finds the header lines of a given record type.
+
+   #FUNCTION  blGetHeaderSpanWholePDB()
+   Finds the header lines spanning a set of record types.
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SysDefs.h"
+#include "pdb.h"
+#include "macros.h"
+#include "general.h"
+#include "hash.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define HEADERINDEX_HASHSIZE 211  /* Prime; a header has ~50 types      */
+#define MAXRECORDKEY         11   /* "REMARK nnn" plus terminator       */
+
+typedef struct _headerrange
+{
+   struct _headerrange *next;
+   STRINGLIST          *first,     /* First line of this type           */
+                       *last;      /* Last line of this type            */
+   int                 firstLine,  /* Positions of these in the header  */
+                       lastLine;
+}  HEADERRANGE;
+
+struct _headerindex
+{
+   STRINGLIST  *header;            /* The header that was indexed       */
+   HASHTABLE   *hash;              /* Record type to HEADERRANGE        */
+   HEADERRANGE *ranges;            /* All ranges, for freeing           */
+};
+
+/************************************************************************/
+/* Prototypes
+*/
+static void RecordKey(char *key, char *record, int width);
+static BOOL AddToIndex(HEADERINDEX *index, char *key, STRINGLIST *s,
+                       int line);
+static void FreeHeaderIndex(HEADERINDEX *index);
+static HEADERRANGE *FindRange(WHOLEPDB *wpdb, char *type);
+
+
+/************************************************************************/
+/*>BOOL blIndexWholePDBHeader(WHOLEPDB *wpdb)
+   ------------------------------------------
+*//**
+
+   \param[in,out] *wpdb    WHOLEPDB structure
+   \return                 Success? FALSE if memory ran out
+
+   Builds the index of record types in wpdb->header, replacing any
+   existing index. The readers call this once the file has been read;
+   it must be called again if wpdb->header is changed.
+
+   If the index can't be built, the header accessors simply scan the
+   whole header.
+
+-  18.10.26 Original
+*/
+BOOL blIndexWholePDBHeader(WHOLEPDB *wpdb)
+{
+   HEADERINDEX *index;
+   STRINGLIST  *s;
+   char        key[MAXRECORDKEY];
+   int         line = 0;
+
+   blFreeWholePDBHeaderIndex(wpdb);
+
+   if((index = (HEADERINDEX *)malloc(sizeof(HEADERINDEX)))==NULL)
+      return(FALSE);
+   index->header = wpdb->header;
+   index->ranges = NULL;
+   if((index->hash = blInitializeHash(HEADERINDEX_HASHSIZE))==NULL)
+   {
+      free(index);
+      return(FALSE);
+   }
+
+   for(s=wpdb->header; s!=NULL; NEXT(s), line++)
+   {
+      if(s->string == NULL)
+         continue;
+
+      RecordKey(key, s->string, 6);
+      if(!AddToIndex(index, key, s, line))
+      {
+         FreeHeaderIndex(index);
+         return(FALSE);
+      }
+
+      /* REMARKs are also indexed by their number                       */
+      if(!strcmp(key, "REMARK"))
+      {
+         RecordKey(key, s->string, 10);
+         if(!AddToIndex(index, key, s, line))
+         {
+            FreeHeaderIndex(index);
+            return(FALSE);
+         }
+      }
+   }
+
+   wpdb->headerIndex = index;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void blFreeWholePDBHeaderIndex(WHOLEPDB *wpdb)
+   ----------------------------------------------
+*//**
+
+   \param[in,out] *wpdb    WHOLEPDB structure
+
+   Frees the index of header records (if any) and clears it from the
+   WHOLEPDB. Called by blFreeWholePDB()
+
+-  18.10.26 Original
+*/
+void blFreeWholePDBHeaderIndex(WHOLEPDB *wpdb)
+{
+   if(wpdb->headerIndex != NULL)
+   {
+      FreeHeaderIndex(wpdb->headerIndex);
+      wpdb->headerIndex = NULL;
+   }
+}
+
+
+/************************************************************************/
+/*>STRINGLIST *blGetHeaderRecordsWholePDB(WHOLEPDB *wpdb, char *type,
+                                          STRINGLIST **stop)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]     *wpdb    WHOLEPDB structure
+   \param[in]     *type    Record type (e.g. "SEQRES" or "REMARK 350").
+                           Trailing spaces are ignored
+   \param[out]    **stop   The item after the last line of this type
+   \return                 The first line of this type. NULL (and
+                           *stop set to NULL) if there are none
+
+   Finds the part of wpdb->header holding the records of a given type.
+   The lines are visited with
+   for(s=first; s!=stop; NEXT(s)).
+
+   The range may contain other record types if the header is not in
+   the standard order, so the type of each line must still be checked.
+   If the header has no index, one is built. If that fails, the whole
+   header is returned.
+
+-  18.10.26 Original
+*/
+STRINGLIST *blGetHeaderRecordsWholePDB(WHOLEPDB *wpdb, char *type,
+                                       STRINGLIST **stop)
+{
+   char *types[2];
+
+   types[0] = type;
+   types[1] = NULL;
+
+   return(blGetHeaderSpanWholePDB(wpdb, types, stop));
+}
+
+
+/************************************************************************/
+/*>STRINGLIST *blGetHeaderSpanWholePDB(WHOLEPDB *wpdb, char **types,
+                                       STRINGLIST **stop)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in]     *wpdb    WHOLEPDB structure
+   \param[in]     **types  NULL-terminated array of record types
+   \param[out]    **stop   The item after the last line of any of the
+                           types
+   \return                 The first line of any of the types. NULL (and
+                           *stop set to NULL) if there are none
+
+   As blGetHeaderRecordsWholePDB(), but returns the range from the first
+   to the last line of any of several record types. This is used where
+   the records must be processed in the order they appear in the file.
+
+-  18.10.26 Original
+*/
+STRINGLIST *blGetHeaderSpanWholePDB(WHOLEPDB *wpdb, char **types,
+                                    STRINGLIST **stop)
+{
+   HEADERRANGE *range,
+               *first = NULL,
+               *last  = NULL;
+   int         i;
+
+   *stop = NULL;
+   if(wpdb->header == NULL)
+      return(NULL);
+
+   /* Build the index if there isn't one or the header has been
+      replaced
+   */
+   if((wpdb->headerIndex == NULL) ||
+      (wpdb->headerIndex->header != wpdb->header))
+   {
+      if(!blIndexWholePDBHeader(wpdb))
+         return(wpdb->header);
+   }
+
+   for(i=0; types[i]!=NULL; i++)
+   {
+      if((range = FindRange(wpdb, types[i]))!=NULL)
+      {
+         if((first == NULL) || (range->firstLine < first->firstLine))
+            first = range;
+         if((last == NULL)  || (range->lastLine  > last->lastLine))
+            last  = range;
+      }
+   }
+
+   if(first == NULL)
+      return(NULL);
+
+   *stop = last->last->next;
+   return(first->first);
+}
+
+
+/************************************************************************/
+/*>static HEADERRANGE *FindRange(WHOLEPDB *wpdb, char *type)
+   ---------------------------------------------------------
+*//**
+
+   \param[in]     *wpdb    WHOLEPDB structure with an index
+   \param[in]     *type    Record type
+   \return                 Range for this type or NULL if not present
+
+   Looks up a record type in the index
+
+-  18.10.26 Original
+*/
+static HEADERRANGE *FindRange(WHOLEPDB *wpdb, char *type)
+{
+   char key[MAXRECORDKEY];
+
+   RecordKey(key, type, MAXRECORDKEY-1);
+   if(!blHashKeyDefined(wpdb->headerIndex->hash, key))
+      return(NULL);
+
+   return((HEADERRANGE *)blGetHashValuePointer(wpdb->headerIndex->hash,
+                                               key));
+}
+
+
+/************************************************************************/
+/*>static void RecordKey(char *key, char *record, int width)
+   ---------------------------------------------------------
+*//**
+
+   \param[out]    *key     The record type used as the hash key
+   \param[in]     *record  PDB record (or record type)
+   \param[in]     width    Number of characters to use
+
+   Copies up to width characters of a record as a key with trailing
+   spaces removed so "TITLE " and "TITLE" are the same
+
+-  18.10.26 Original
+*/
+static void RecordKey(char *key, char *record, int width)
+{
+   int i;
+
+   for(i=0; (i<width) && (record[i] != '\0') && (record[i] != '\n'); i++)
+      key[i] = record[i];
+   key[i] = '\0';
+   KILLTRAILSPACES(key);
+}
+
+
+/************************************************************************/
+/*>static BOOL AddToIndex(HEADERINDEX *index, char *key, STRINGLIST *s,
+                          int line)
+   --------------------------------------------------------------------
+*//**
+
+   \param[in,out] *index   The index being built
+   \param[in]     *key     Record type
+   \param[in]     *s       Header line of this type
+   \param[in]     line     Position of the line in the header
+   \return                 Success? FALSE if memory ran out
+
+   Extends the range for a record type to include this line, creating
+   the range if this is the first line of that type
+
+-  18.10.26 Original
+*/
+static BOOL AddToIndex(HEADERINDEX *index, char *key, STRINGLIST *s,
+                       int line)
+{
+   HEADERRANGE *range;
+
+   if(blHashKeyDefined(index->hash, key))
+   {
+      range = (HEADERRANGE *)blGetHashValuePointer(index->hash, key);
+   }
+   else
+   {
+      if((range = (HEADERRANGE *)malloc(sizeof(HEADERRANGE)))==NULL)
+         return(FALSE);
+      range->first     = s;
+      range->firstLine = line;
+      range->next      = index->ranges;
+      index->ranges    = range;
+
+      if(!blSetHashValuePointer(index->hash, key, (BPTR)range))
+         return(FALSE);
+   }
+
+   range->last     = s;
+   range->lastLine = line;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void FreeHeaderIndex(HEADERINDEX *index)
+   -----------------------------------------------
+*//**
+
+   \param[in]     *index   Index to free
+
+   Frees an index and its ranges
+
+-  18.10.26 Original
+*/
+static void FreeHeaderIndex(HEADERINDEX *index)
+{
+   blFreeHash(index->hash);
+   FREELIST(index->ranges, HEADERRANGE);
+   free(index);
+}
+
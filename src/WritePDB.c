@@ -3,11 +3,11 @@
 
    \file       WritePDB.c
    
-   \version    V1.29
-   \date       29.07.15
+   \version    V1.35
+   \date       18.10.26
    \brief      Write a PDB file from a linked list
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -112,6 +112,24 @@
 -  V1.29 29.07.15 Added output of PDBML seqres records from wpdb->header.
                   Added ReadSeqresChainLabelWholePDB() and 
                   ReadSeqresResidueListWholePDB().  By: CTP
+-  V1.30 18.10.26 ATOM/HETATM and TER records are formatted by
+                  FormatPDBRecord() and FormatTerCard() rather than
+                  fprintf(). blWritePDBAsPDBorGromos() collects them in
+                  a large buffer which is written in blocks. Added a
+                  benchmark (compile with -DBENCHMARK)
+-  V1.31 18.10.26 blDoWritePDBAsPDBML() streams the PDBML with an
+                  xmlTextWriter instead of building an xmlDoc. Added
+                  WritePDBMLAtomSite(), WritePDBMLConect(),
+                  WritePDBMLConectPartner(), StartPDBMLElement() and
+                  WritePDBMLElement()
+-  V1.32 18.10.26 blWritePDBAsPDBML() initialises the header index.
+                  ReadSeqresChainLabelWholePDB() and
+                  ReadSeqresResidueListWholePDB() use the index
+-  V1.33 18.10.26 blWritePDBAsPDBML() initialises wpdb.arena
+-  V1.34 18.10.26 Added blWritePDBSelection(). The test for a TER card
+                  is moved to NeedTerCard()
+-  V1.35 18.10.26 Includes libxml/parser.h. An error writing PDBML no
+                  longer cleans up the XML parser
 
 *************************************************************************/
 /* Doxygen
@@ -147,6 +165,9 @@
    Writes a PDB linked list to a file in PDB format or the modified
    GROMOS version
 
+   #FUNCTION blWritePDBSelection()
+   Writes the atoms of a selection to a file in PDB format
+
    #FUNCTION blWritePDBRecordAtnam()
    Writes a single PDB record in PDB format using atom data from the
    atnam field rather than the atnam_raw field
@@ -179,10 +200,10 @@
 #include <stdlib.h>
 
 #ifdef XML_SUPPORT /* Required to read PDBML files                      */
-#include <libxml/tree.h>
+#include <libxml/xmlwriter.h>
+#include <libxml/parser.h>
 #include <ctype.h>
-#define XMLDIE(x) do {if((x)!=NULL) { xmlFreeDoc((x));                   \
-                                      xmlCleanupParser(); }              \
+#define XMLDIE(x) do {if((x)!=NULL) xmlFreeTextWriter((x));              \
                       return(FALSE);} while(FALSE)
 #endif
 
@@ -192,6 +213,22 @@
 #include "hash.h"
 #include "fsscanf.h"
 
+/************************************************************************/
+/* Defines and macros
+*/
+#define OUTBUFFSIZE 262144  /* Buffer used by blWritePDBAsPDBorGromos() */
+#define MAXRECORD   2048    /* Longest record from FormatPDBRecord()    */
+#define FIXEDLIMIT  1.0e9   /* Largest scaled value for FormatFixed()   */
+#define FIXEDTIE    1.0e-6  /* Closest fraction to 0.5 which is rounded
+                               without sprintf()                        */
+
+typedef struct
+{
+   FILE *fp;
+   char *buffer;            /* NULL to write records directly           */
+   int  pos;                /* Number of characters in the buffer       */
+}  OUTBUFFER;
+
 /************************************************************************/
 /* Prototypes
 */
@@ -203,6 +240,27 @@ static HASHTABLE *blMapChainsToEntity(WHOLEPDB *wpdb);
 static char **ReadSeqresChainLabelWholePDB(WHOLEPDB *wpdb, int *nchains);
 static STRINGLIST **ReadSeqresResidueListWholePDB(WHOLEPDB *wpdb, 
                                                   int *nchains);
+static int FormatPDBRecord(char *out, PDB *pdb);
+static int FormatTerCard(char *out, PDB *p);
+static char *FormatString(char *out, char *string, int width,
+                          BOOL leftJustify);
+static char *FormatInt(char *out, int value, int width);
+static char *FormatFixed(char *out, REAL value, int width, int ndp);
+static void BufferPDBRecord(OUTBUFFER *ob, PDB *p);
+static void BufferTerCard(OUTBUFFER *ob, PDB *p);
+static void FlushOutBuffer(OUTBUFFER *ob);
+static BOOL NeedTerCard(PDB *pdb, PDB *prev, PDB *p);
+#ifdef XML_SUPPORT
+static BOOL WritePDBMLAtomSite(xmlTextWriterPtr writer, PDB *p,
+                               HASHTABLE *chain_to_entity);
+static BOOL WritePDBMLConect(xmlTextWriterPtr writer, PDB *p, PDB *q,
+                             int conect_id);
+static BOOL WritePDBMLConectPartner(xmlTextWriterPtr writer,
+                                    char *partner, PDB *p);
+static BOOL StartPDBMLElement(xmlTextWriterPtr writer, char *name);
+static BOOL WritePDBMLElement(xmlTextWriterPtr writer, char *name,
+                              char *content);
+#endif
 /************************************************************************/
 /*>int blWritePDB(FILE *fp, PDB *pdb)
    ----------------------------------
@@ -303,42 +361,32 @@ BOOL blFormatCheckWritePDB(PDB *pdb)
 -  23.02.15 Write correct format TER cards. Now returns int    By: ACRM
 -  24.02.15 Renamed to blWritePDBAsPDBorGromos() and added doGromos
             flag
-
+-  18.10.26 PDB format records are formatted into a large buffer which
+            is written in blocks. The output is unchanged
+-  18.10.26 Uses NeedTerCard()
 */
 int blWritePDBAsPDBorGromos(FILE *fp, PDB  *pdb, BOOL doGromos)
 {
-   PDB   *p,
-         *prev = NULL;
-   int   numTer = 0;
-   BOOL  doneTer = FALSE;
-
-    for(p=pdb; p!=NULL; NEXT(p))
+   PDB       *p,
+             *prev = NULL;
+   int       numTer = 0;
+   BOOL      doneTer = FALSE;
+   OUTBUFFER ob;
+
+   /* If the buffer can't be allocated, records are written directly    */
+   ob.fp     = fp;
+   ob.pos    = 0;
+   ob.buffer = NULL;
+   if(!doGromos)
+      ob.buffer = (char *)malloc(OUTBUFFSIZE * sizeof(char));
+
+   for(p=pdb; p!=NULL; NEXT(p))
    {
-      /* If previous was non-null and was an ATOM                       */
-      if((prev!=NULL) && !strncmp(prev->record_type, "ATOM  ", 6))
+      if(!doneTer && NeedTerCard(pdb, prev, p))
       {
-         /* If the chain has changed write a TER card                   */
-         if(!doneTer && !CHAINMATCH(p->chain, prev->chain))
-         {
-            blWriteTerCard(fp, prev);
-            numTer++;
-            doneTer = TRUE;
-         }
-         /* If we've moved into a HETATM, then see if this HETATOM group
-            is bonded to the previous residue. If it isn't, print a TER
-            card
-         */
-         if(!doneTer && !strncmp(p->record_type, "HETATM", 6))
-         {
-            PDB *prevStart = blFindResidue(pdb, prev->chain, prev->resnum,
-                                           prev->insert);
-            if(!blAreResiduePointersBonded(prevStart, p, (REAL)0.2))
-            {
-               blWriteTerCard(fp, prev);
-               numTer++;
-               doneTer = TRUE;
-            }
-         }
+         BufferTerCard(&ob, prev);
+         numTer++;
+         doneTer = TRUE;
       }
 
       if(doGromos)
@@ -348,7 +396,7 @@ int blWritePDBAsPDBorGromos(FILE *fp, PDB  *pdb, BOOL doGromos)
       }
       else
       {
-         blWritePDBRecord(fp,p);
+         BufferPDBRecord(&ob, p);
          doneTer = FALSE;
       }
       prev=p;
@@ -358,9 +406,75 @@ int blWritePDBAsPDBorGromos(FILE *fp, PDB  *pdb, BOOL doGromos)
       (prev!=NULL) && 
       !strncmp(prev->record_type, "ATOM  ", 6))
    {
-      blWriteTerCard(fp, prev);
+      BufferTerCard(&ob, prev);
+      numTer++;
+   }
+
+   FlushOutBuffer(&ob);
+   FREE(ob.buffer);
+
+   return(numTer);
+}
+
+
+/************************************************************************/
+/*>int blWritePDBSelection(FILE *fp, PDBSELECTION *sel)
+   ----------------------------------------------------
+*//**
+
+   \param[in]     *fp   PDB file pointer to be written
+   \param[in]     *sel  Selection of atoms to write
+   \return              Number of TER cards written (0=error)
+
+   Writes the atoms of a selection in PDB format, placing TER cards in
+   the same way as blWritePDBAsPDBorGromos(). Whether a HETATM is
+   bonded to the preceding residue is tested against the whole residue
+   in the linked list rather than just its selected atoms. The
+   selection is always written as PDB rather than PDBML. Returns 0 if
+   an atom has a chain label which is too long for PDB format.
+
+-  18.10.26 Original
+*/
+int blWritePDBSelection(FILE *fp, PDBSELECTION *sel)
+{
+   PDB       *p,
+             *prev = NULL;
+   int       numTer = 0,
+             i;
+   OUTBUFFER ob;
+
+   for(i=0; i<sel->natoms; i++)
+   {
+      if(strlen(sel->atoms[i]->chain) > 1)
+         return(0);
+   }
+
+   ob.fp     = fp;
+   ob.pos    = 0;
+   ob.buffer = (char *)malloc(OUTBUFFSIZE * sizeof(char));
+
+   for(i=0; i<sel->natoms; i++)
+   {
+      p = sel->atoms[i];
+      if(NeedTerCard(sel->pdb, prev, p))
+      {
+         BufferTerCard(&ob, prev);
+         numTer++;
+      }
+
+      BufferPDBRecord(&ob, p);
+      prev = p;
+   }
+
+   if((prev!=NULL) && !strncmp(prev->record_type, "ATOM  ", 6))
+   {
+      BufferTerCard(&ob, prev);
       numTer++;
    }
+
+   FlushOutBuffer(&ob);
+   FREE(ob.buffer);
+
    return(numTer);
 }
 
@@ -378,15 +492,14 @@ int blWritePDBAsPDBorGromos(FILE *fp, PDB  *pdb, BOOL doGromos)
 
 -  23.02.15  Original   By: ACRM
 -  02.03.15  Added space padding
+-  18.10.26  Uses FormatTerCard()
 */
 void blWriteTerCard(FILE *fp, PDB *p)
 {
+   char buffer[MAXRECORD];
+
    if(p!=NULL)
-   {
-      fprintf(fp,"TER   %5d      %-4s%1s%4d%1s%s\n",
-              p->atnum+1, p->resnam, p->chain, p->resnum, p->insert,
-              "                                                     ");
-   }
+      fwrite(buffer, sizeof(char), FormatTerCard(buffer, p), fp);
 }
 
 
@@ -411,38 +524,14 @@ void blWriteTerCard(FILE *fp, PDB *p)
 -  07.07.14 Renamed to blWritePDBRecord() By: CTP
 -  16.08.14 Write element and formal charge.  By: CTP
 -  17.02.15 Added segid support   By: ACRM
+-  18.10.26 Uses FormatPDBRecord() rather than fprintf()
 */
 void blWritePDBRecord(FILE *fp,
                       PDB  *pdb)
 {
-   char charge = ' ',
-        sign   = ' ';
+   char buffer[MAXRECORD];
 
-
-   if(pdb->formal_charge && ABS(pdb->formal_charge) <= 8)
-   {
-      charge = (char)('0' + ABS(pdb->formal_charge));
-      sign   = (char)(pdb->formal_charge > 0 ? '+' : '-');
-   }
-
-   fprintf(fp,"%-6s%5d %-4s%c%-4s%1s%4d%1s   %8.3f%8.3f%8.3f%6.2f%6.2f      %4s%2s%c%c\n",
-           pdb->record_type,
-           pdb->atnum,
-           pdb->atnam_raw,
-           pdb->altpos,
-           pdb->resnam,
-           pdb->chain,
-           pdb->resnum,
-           pdb->insert,
-           pdb->x,
-           pdb->y,
-           pdb->z,
-           pdb->occ,
-           pdb->bval,
-           pdb->segid,
-           pdb->element,
-           charge,
-           sign);
+   fwrite(buffer, sizeof(char), FormatPDBRecord(buffer, pdb), fp);
 }
 
 
@@ -500,6 +589,344 @@ void blWritePDBRecordAtnam(FILE *fp,
            sign);
 }
 
+/************************************************************************/
+/*>static int FormatPDBRecord(char *out, PDB *pdb)
+   -----------------------------------------------
+*//**
+
+   \param[out]    *out    Buffer of at least MAXRECORD characters
+   \param[in]     *pdb    PDB record to format
+   \return                Number of characters written (not terminated)
+
+   Formats an ATOM/HETATM record exactly as 
+   fprintf(fp,"%-6s%5d %-4s%c%-4s%1s%4d%1s   %8.3f%8.3f%8.3f%6.2f%6.2f
+   %4s%2s%c%c\n",...) would. The numbers are converted by FormatInt()
+   and FormatFixed() which avoid the cost of parsing the format string
+   and of the general floating point conversion.
+
+-  18.10.26 Original
+*/
+static int FormatPDBRecord(char *out, PDB *pdb)
+{
+   char *start = out,
+        charge = ' ',
+        sign   = ' ';
+
+   if(pdb->formal_charge && ABS(pdb->formal_charge) <= 8)
+   {
+      charge = (char)('0' + ABS(pdb->formal_charge));
+      sign   = (char)(pdb->formal_charge > 0 ? '+' : '-');
+   }
+
+   out    = FormatString(out, pdb->record_type, 6, TRUE);
+   out    = FormatInt(out, pdb->atnum, 5);
+   *out++ = ' ';
+   out    = FormatString(out, pdb->atnam_raw, 4, TRUE);
+   *out++ = pdb->altpos;
+   out    = FormatString(out, pdb->resnam, 4, TRUE);
+   out    = FormatString(out, pdb->chain, 1, FALSE);
+   out    = FormatInt(out, pdb->resnum, 4);
+   out    = FormatString(out, pdb->insert, 1, FALSE);
+   memcpy(out, "   ", 3);
+   out   += 3;
+   out    = FormatFixed(out, pdb->x, 8, 3);
+   out    = FormatFixed(out, pdb->y, 8, 3);
+   out    = FormatFixed(out, pdb->z, 8, 3);
+   out    = FormatFixed(out, pdb->occ, 6, 2);
+   out    = FormatFixed(out, pdb->bval, 6, 2);
+   memcpy(out, "      ", 6);
+   out   += 6;
+   out    = FormatString(out, pdb->segid, 4, FALSE);
+   out    = FormatString(out, pdb->element, 2, FALSE);
+   *out++ = charge;
+   *out++ = sign;
+   *out++ = '\n';
+
+   return((int)(out - start));
+}
+
+
+/************************************************************************/
+/*>static int FormatTerCard(char *out, PDB *p)
+   -------------------------------------------
+*//**
+
+   \param[out]    *out    Buffer of at least MAXRECORD characters
+   \param[in]     *p      Last atom before the TER card
+   \return                Number of characters written (not terminated)
+
+   Formats the TER card written by blWriteTerCard()
+
+-  18.10.26 Original
+*/
+static int FormatTerCard(char *out, PDB *p)
+{
+   char *start = out;
+
+   memcpy(out, "TER   ", 6);
+   out   += 6;
+   out    = FormatInt(out, p->atnum+1, 5);
+   memcpy(out, "      ", 6);
+   out   += 6;
+   out    = FormatString(out, p->resnam, 4, TRUE);
+   out    = FormatString(out, p->chain, 1, FALSE);
+   out    = FormatInt(out, p->resnum, 4);
+   out    = FormatString(out, p->insert, 1, FALSE);
+   memset(out, ' ', 53);
+   out   += 53;
+   *out++ = '\n';
+
+   return((int)(out - start));
+}
+
+
+/************************************************************************/
+/*>static char *FormatString(char *out, char *string, int width,
+                             BOOL leftJustify)
+   -------------------------------------------------------------
+*//**
+
+   \param[out]    *out        Output position
+   \param[in]     *string     String to write
+   \param[in]     width       Minimum field width
+   \param[in]     leftJustify Pad on the right rather than the left
+   \return                    Position after the field
+
+   Equivalent of %-<width>s or %<width>s. Strings longer than the width 
+   are written in full.
+
+-  18.10.26 Original
+*/
+static char *FormatString(char *out, char *string, int width,
+                          BOOL leftJustify)
+{
+   int len = strlen(string);
+
+   if(!leftJustify)
+   {
+      for(; width > len; width--)
+         *out++ = ' ';
+   }
+   memcpy(out, string, len);
+   out += len;
+   for(; width > len; width--)
+      *out++ = ' ';
+
+   return(out);
+}
+
+
+/************************************************************************/
+/*>static char *FormatInt(char *out, int value, int width)
+   -------------------------------------------------------
+*//**
+
+   \param[out]    *out     Output position
+   \param[in]     value    Value to write
+   \param[in]     width    Minimum field width
+   \return                 Position after the field
+
+   Equivalent of %<width>d
+
+-  18.10.26 Original
+*/
+static char *FormatInt(char *out, int value, int width)
+{
+   char          digits[16];
+   unsigned long u;
+   int           n = 0;
+
+   u = (value < 0) ? (0UL - (unsigned long)value) : (unsigned long)value;
+   do
+   {
+      digits[n++] = (char)('0' + (u % 10));
+      u /= 10;
+   }  while(u);
+   if(value < 0)
+      digits[n++] = '-';
+
+   for(; width > n; width--)
+      *out++ = ' ';
+   while(n)
+      *out++ = digits[--n];
+
+   return(out);
+}
+
+
+/************************************************************************/
+/*>static char *FormatFixed(char *out, REAL value, int width, int ndp)
+   -------------------------------------------------------------------
+*//**
+
+   \param[out]    *out     Output position
+   \param[in]     value    Value to write
+   \param[in]     width    Minimum field width
+   \param[in]     ndp      Number of decimal places (at most 3)
+   \return                 Position after the field
+
+   Equivalent of %<width>.<ndp>f. The value is scaled and rounded to an
+   integer. Where that could round differently from printf() - a value
+   within FIXEDTIE of half way between two outputs, zero (which may be
+   -0.0) or a very large value - sprintf() is used instead so the
+   output is always identical.
+
+-  18.10.26 Original
+*/
+static char *FormatFixed(char *out, REAL value, int width, int ndp)
+{
+   static double scale[] = {1.0, 10.0, 100.0, 1000.0};
+   char          digits[16];
+   double        scaled,
+                 whole,
+                 frac;
+   long          r;
+   int           n = 0;
+
+   scaled = (double)value * scale[ndp];
+   if(!(fabs(scaled) < FIXEDLIMIT) || (value == (REAL)0.0))
+      return(out + sprintf(out, "%*.*f", width, ndp, (double)value));
+
+   whole = floor(scaled);
+   frac  = scaled - whole;
+   if(fabs(frac - 0.5) < FIXEDTIE)
+      return(out + sprintf(out, "%*.*f", width, ndp, (double)value));
+
+   r = (long)whole + ((frac > 0.5) ? 1 : 0);
+   if(r < 0)
+      r = -r;
+
+   /* Digits in reverse order with at least one before the point       */
+   do
+   {
+      digits[n++] = (char)('0' + (r % 10));
+      r /= 10;
+      if(n == ndp)
+         digits[n++] = '.';
+   }  while(r || (n <= ndp+1));
+   if(value < (REAL)0.0)
+      digits[n++] = '-';
+
+   for(; width > n; width--)
+      *out++ = ' ';
+   while(n)
+      *out++ = digits[--n];
+
+   return(out);
+}
+
+
+/************************************************************************/
+/*>static void BufferPDBRecord(OUTBUFFER *ob, PDB *p)
+   --------------------------------------------------
+*//**
+
+   \param[in,out] *ob     Output buffer
+   \param[in]     *p      PDB record to write
+
+   Adds an ATOM/HETATM record to the buffer, writing the buffer out if
+   it is nearly full. Writes directly if there is no buffer.
+
+-  18.10.26 Original
+*/
+static void BufferPDBRecord(OUTBUFFER *ob, PDB *p)
+{
+   if(ob->buffer == NULL)
+   {
+      blWritePDBRecord(ob->fp, p);
+      return;
+   }
+   if(ob->pos > OUTBUFFSIZE - MAXRECORD)
+      FlushOutBuffer(ob);
+   ob->pos += FormatPDBRecord(ob->buffer + ob->pos, p);
+}
+
+
+/************************************************************************/
+/*>static void BufferTerCard(OUTBUFFER *ob, PDB *p)
+   ------------------------------------------------
+*//**
+
+   \param[in,out] *ob     Output buffer
+   \param[in]     *p      Last atom before the TER card
+
+   Adds a TER card to the buffer as BufferPDBRecord() does for atoms
+
+-  18.10.26 Original
+*/
+static void BufferTerCard(OUTBUFFER *ob, PDB *p)
+{
+   if(ob->buffer == NULL)
+   {
+      blWriteTerCard(ob->fp, p);
+      return;
+   }
+   if(ob->pos > OUTBUFFSIZE - MAXRECORD)
+      FlushOutBuffer(ob);
+   ob->pos += FormatTerCard(ob->buffer + ob->pos, p);
+}
+
+
+/************************************************************************/
+/*>static void FlushOutBuffer(OUTBUFFER *ob)
+   -----------------------------------------
+*//**
+
+   \param[in,out] *ob     Output buffer
+
+   Writes out and empties the buffer
+
+-  18.10.26 Original
+*/
+static void FlushOutBuffer(OUTBUFFER *ob)
+{
+   if((ob->buffer != NULL) && (ob->pos != 0))
+      fwrite(ob->buffer, sizeof(char), ob->pos, ob->fp);
+   ob->pos = 0;
+}
+
+
+/************************************************************************/
+/*>static BOOL NeedTerCard(PDB *pdb, PDB *prev, PDB *p)
+   ----------------------------------------------------
+*//**
+
+   \param[in]     *pdb    PDB linked list being written
+   \param[in]     *prev   Atom that was written last (may be NULL)
+   \param[in]     *p      Atom about to be written
+   \return                Should a TER card be written before p?
+
+   A TER card follows an ATOM if the chain changes or if the next atom
+   is a HETATM which is not bonded to the residue of the ATOM.
+
+-  18.10.26 Original, taken from blWritePDBAsPDBorGromos()
+*/
+static BOOL NeedTerCard(PDB *pdb, PDB *prev, PDB *p)
+{
+   /* If previous was non-null and was an ATOM                          */
+   if((prev!=NULL) && !strncmp(prev->record_type, "ATOM  ", 6))
+   {
+      /* If the chain has changed write a TER card                      */
+      if(!CHAINMATCH(p->chain, prev->chain))
+         return(TRUE);
+
+      /* If we've moved into a HETATM, then see if this HETATOM group
+         is bonded to the previous residue. If it isn't, print a TER
+         card
+      */
+      if(!strncmp(p->record_type, "HETATM", 6))
+      {
+         PDB *prevStart = blFindResidue(pdb, prev->chain, prev->resnum,
+                                        prev->insert);
+         if(!blAreResiduePointersBonded(prevStart, p, (REAL)0.2))
+            return(TRUE);
+      }
+   }
+
+   return(FALSE);
+}
+
+
 /************************************************************************/
 /*>BOOL blWritePDBAsPDBML(FILE *fp, PDB *pdb)
    ------------------------------------------
@@ -521,6 +948,8 @@ void blWritePDBRecordAtnam(FILE *fp,
 -  29.04.15 Updated to write CONECT records.  By: CTP
 -  11.05.15 Made function into wrapper for blDoWritePDBAsPDBML(). By: CTP
 -  10.07.15 Added return value for no XML_SUPPORT  By: ACRM
+-  18.10.26 Initialises wpdb.headerIndex
+-  18.10.26 Initialises wpdb.arena
 
 */
 BOOL blWritePDBAsPDBML(FILE *fp, PDB  *pdb)
@@ -534,10 +963,12 @@ BOOL blWritePDBAsPDBML(FILE *fp, PDB  *pdb)
 
    /* PDBML format supported.                                           */
    WHOLEPDB wpdb;
-   wpdb.header  = NULL;
-   wpdb.trailer = NULL;
-   wpdb.natoms  =    0;
-   wpdb.pdb     =  pdb;
+   wpdb.header      = NULL;
+   wpdb.trailer     = NULL;
+   wpdb.headerIndex = NULL;
+   wpdb.arena       = NULL;
+   wpdb.natoms      =    0;
+   wpdb.pdb         =  pdb;
    return(blDoWritePDBAsPDBML(fp, &wpdb, FALSE));
 
 #endif
@@ -550,12 +981,16 @@ BOOL blWritePDBAsPDBML(FILE *fp, PDB  *pdb)
 
    \param[in]     *fp      PDB file pointer to be written
    \param[in]     *wpdb    WHOLEPDB to write
-   \param[in]     doWhole  Write whole pdb including header and conect 
+   \param[in]     doWhole  Write whole pdb including header and conect
                            records or just coordinate records.
    \return                 Success
 
    Write a PDB linked list in PDBML format.
 
+   The XML is streamed to the file with an xmlTextWriter as the PDB
+   linked list is walked, so memory use does not depend on the size of
+   the structure.
+
 -  02.06.14 Original. By: CTP
 -  21.06.14 Renamed blWriteAsPDBML() and updated symbol handling. By: CTP
 -  17.07.14 Use blSetElementSymbolFromAtomName() By: CTP
@@ -567,13 +1002,17 @@ BOOL blWritePDBAsPDBML(FILE *fp, PDB  *pdb)
 -  11.05.15 Renamed from blWritePDBAsPDBML() to blDoWritePDBAsPDBML().
             Changed to a static function.
             blWritePDBAsPDBML() is now a wrapper for this function.
-            This function takes WHOLEPDB as input instead of PDB and 
+            This function takes WHOLEPDB as input instead of PDB and
             writes wpdb->header and wpdb->trailer info if doWhole param is
             TRUE.  By: CTP
 -  21.06.15 Write entity_id. Use COMPND record to set entity_id if not set
             in PDB. Set compound type to polymer. By:  CTP
 -  10.07.15 Added return value for no XML_SUPPORT  By: ACRM
 -  29.07.15 Added output of SEQRES records from wpdb->header.  By: CTP
+-  18.10.26 Streams the output with an xmlTextWriter rather than building
+            an xmlDoc. Atom sites and CONECTs are written by
+            WritePDBMLAtomSite() and WritePDBMLConect()
+-  18.10.26 XMLDIE() no longer calls xmlCleanupParser()
 */
 static BOOL blDoWritePDBAsPDBML(FILE *fp, WHOLEPDB  *wpdb, BOOL doWhole)
 {
@@ -582,22 +1021,15 @@ static BOOL blDoWritePDBAsPDBML(FILE *fp, WHOLEPDB  *wpdb, BOOL doWhole)
    /* PDBML format not supported.                                       */
    return(FALSE);                         /* 10.07.15                   */
 
-#else 
+#else
 
    /* PDBML format supported                                            */
-   PDB         *p,
-               *q;
-   xmlDocPtr   doc         = NULL;
-   xmlNodePtr  root_node   = NULL, 
-               sites_node  = NULL, 
-               atom_node   = NULL, 
-               node        = NULL;
-   xmlNsPtr    pdbx        = NULL,
-               xsi         = NULL;
-   char        buffer[16], 
-               *buffer_ptr;
-   int         conect_id   = 0,
-               i, j;
+   PDB                *p;
+   xmlOutputBufferPtr output      = NULL;
+   xmlTextWriterPtr   writer      = NULL;
+   char               buffer[16];
+   int                conect_id   = 0,
+                      i, j;
 
    char header[82]     =   "",
         date[82]       =   "",
@@ -608,42 +1040,47 @@ static BOOL blDoWritePDBAsPDBML(FILE *fp, WHOLEPDB  *wpdb, BOOL doWhole)
    COMPND    compound;
    PDBSOURCE species;
    int molid = 0;
+   BOOL       inCategory        = FALSE;
    HASHTABLE *chain_to_entity = NULL;
    int        seqres_nchains    =    0;
    char       **seqres_chain    = NULL;
    STRINGLIST **seqres_residues = NULL,
               *s = NULL;
 
+   /* Create a writer which streams to the file                         */
+   if((output = xmlOutputBufferCreateFile(fp, NULL))==NULL)
+      return(FALSE);
+   if((writer = xmlNewTextWriter(output))==NULL)
+   {
+      xmlOutputBufferClose(output);
+      return(FALSE);
+   }
+   if((xmlTextWriterSetIndent(writer, 1) < 0) ||
+      (xmlTextWriterSetIndentString(writer, (xmlChar *)"  ") < 0))
+      XMLDIE(writer);
+
    /* Create document                                                   */
-   if((doc = xmlNewDoc((xmlChar *)"1.0"))==NULL)
-      XMLDIE(doc);                         /* 25.02.15                  */
-   if((doc->encoding = xmlStrdup((xmlChar *) "UTF-8"))==NULL)
-      XMLDIE(doc);                         /* 25.02.15                  */
-   
+   if(xmlTextWriterStartDocument(writer, "1.0", "UTF-8", NULL) < 0)
+      XMLDIE(writer);
+
    /* Root node                                                         */
-   if((root_node=xmlNewNode(NULL, (xmlChar *)"datablock"))==NULL)
-      XMLDIE(doc);                         /* 25.02.15                  */
-   xmlDocSetRootElement(doc, root_node);
-   if((pdbx=xmlNewNs(root_node, (xmlChar *)"null", 
-                     (xmlChar *)"PDBx"))==NULL)
-      XMLDIE(doc);                         /* 25.02.15                  */
-   if((xsi =xmlNewNs(root_node, (xmlChar *)"null",
-                     (xmlChar *)"xsi"))==NULL)
-      XMLDIE(doc);                         /* 25.02.15                  */
-   xmlSetNs(root_node,pdbx);
-   
+   if((xmlTextWriterStartElementNS(writer, (xmlChar *)"PDBx",
+                                   (xmlChar *)"datablock", NULL) < 0) ||
+      (xmlTextWriterWriteAttribute(writer, (xmlChar *)"xmlns:PDBx",
+                                   (xmlChar *)"null") < 0) ||
+      (xmlTextWriterWriteAttribute(writer, (xmlChar *)"xmlns:xsi",
+                                   (xmlChar *)"null") < 0))
+      XMLDIE(writer);
+
    /* Write Coordinate Data                                             */
-   
+
    /* map chain to entity from compnd records                           */
    chain_to_entity = blMapChainsToEntity(wpdb);
 
    /* Atom_sites node                                                   */
-   if((sites_node = xmlNewChild(root_node, NULL, 
-                                (xmlChar *)"atom_siteCategory", 
-                                NULL))==NULL)
-      XMLDIE(doc);                         /* 25.02.15                  */
+   if(!StartPDBMLElement(writer, "atom_siteCategory"))
+      XMLDIE(writer);
 
-   
    /* Atom nodes                                                        */
    for(p=wpdb->pdb; p!=NULL; NEXT(p))
    {
@@ -653,766 +1090,777 @@ static BOOL blDoWritePDBAsPDBML(FILE *fp, WHOLEPDB  *wpdb, BOOL doWhole)
          continue;
       }
 
-      /* Add atom node                                                  */
-      if((atom_node = xmlNewChild(sites_node, NULL,
-                                  (xmlChar *)"atom_site", NULL))==NULL)
-         XMLDIE(doc);                      /* 25.02.15                  */
+      if(!WritePDBMLAtomSite(writer, p, chain_to_entity))
+         XMLDIE(writer);
+   }
 
-      sprintf(buffer, "%d", p->atnum);
-      xmlNewProp(atom_node, (xmlChar *)"id", (xmlChar *)buffer);
-      
-      /*** Add atom data nodes                                        ***/
-
-      /* B value                                                        */
-      sprintf(buffer,"%.2f", p->bval);
-      if((node = xmlNewChild(atom_node, NULL, 
-                             (xmlChar *)"B_iso_or_equiv",
-                             (xmlChar *)buffer))==NULL)
-         XMLDIE(doc);                      /* 25.02.15                  */
-
-      /* coordinates                                                    */
-      sprintf(buffer,"%.3f", p->x);
-      if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"Cartn_x",
-                             (xmlChar *)buffer))==NULL)
-         XMLDIE(doc);                      /* 25.02.15                  */
-
-      sprintf(buffer,"%.3f", p->y);
-      if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"Cartn_y",
-                             (xmlChar *)buffer))==NULL)
-         XMLDIE(doc);                      /* 25.02.15                  */
-
-
-      sprintf(buffer,"%.3f", p->z);
-      if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"Cartn_z",
-                             (xmlChar *)buffer))==NULL)
-         XMLDIE(doc);                      /* 25.02.15                  */
-
-      /* author atom site labels                                        */
-      if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"auth_asym_id",
-                             (xmlChar *)p->chain))==NULL)
-         XMLDIE(doc);                      /* 25.02.15                  */
-
-
-      strcpy(buffer,p->atnam);
-      KILLTRAILSPACES(buffer);
-      if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"auth_atom_id",
-                             (xmlChar *)buffer))==NULL)
-         XMLDIE(doc);                      /* 25.02.15                  */
-
-      strcpy(buffer,p->resnam);
-      KILLTRAILSPACES(buffer);
-      KILLLEADSPACES(buffer_ptr,buffer);
-      if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"auth_comp_id",
-                             (xmlChar *)buffer_ptr))==NULL)
-         XMLDIE(doc);                      /* 25.02.15                  */
+   if(xmlTextWriterEndElement(writer) < 0)
+      XMLDIE(writer);
 
-      
-      sprintf(buffer,"%d", p->resnum);
-      if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"auth_seq_id",
-                             (xmlChar *)buffer))==NULL)
-         XMLDIE(doc);                      /* 25.02.15                  */
+   /* Finished Coordinate Data                                          */
+   /* Clean up and return if doWhole == FALSE                           */
+   if(doWhole == FALSE)
+   {
+      /* Close the root node and flush the output                       */
+      if(xmlTextWriterEndDocument(writer) < 0)
+         XMLDIE(writer);
 
+      /* Free Memory                                                    */
+      xmlFreeTextWriter(writer);
+      xmlCleanupParser();
+      blFreeHash(chain_to_entity);
 
-      /* record type atom/hetatm                                        */
-      strcpy(buffer,p->record_type);
-      KILLTRAILSPACES(buffer);
-      if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"group_PDB",
-                             (xmlChar *)buffer))==NULL)
-         XMLDIE(doc);                      /* 25.02.15                  */
+      return(TRUE);
+   }
 
 
-      /* atom site labels                                               */
-      if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"label_alt_id",
-                             NULL))==NULL)
-         XMLDIE(doc);                      /* 25.02.15                  */
+   /*** Write Header and trailer data in PDBML-format                 ***/
 
-      if(p->altpos == ' ')
-      {
-         xmlNewNsProp(node, xsi, (xmlChar *)"nil", (xmlChar *)"true");
-      }
-      else
+   /* struct_conn node                                                  */
+   for(p=wpdb->pdb; p!=NULL; NEXT(p))
+   {
+      if(p->nConect)
       {
-         buffer[0] = p->altpos;
-         buffer[1] = '\0';
-         xmlNodeSetContent(node, (xmlChar *)buffer);
+         if(!StartPDBMLElement(writer, "struct_connCategory"))
+            XMLDIE(writer);
+         inCategory = TRUE;
+         break;
       }
-      
-      if((node = xmlNewChild(atom_node, NULL, 
-                             (xmlChar *)"label_asym_id",
-                             (xmlChar *)p->chain))==NULL)
-         XMLDIE(doc);                      /* 25.02.15                  */
-
-      strcpy(buffer,p->atnam);
-      KILLTRAILSPACES(buffer);
-      if((node = xmlNewChild(atom_node, NULL, 
-                             (xmlChar *)"label_atom_id",
-                             (xmlChar *)buffer))==NULL)
-         XMLDIE(doc);                      /* 25.02.15                  */
-
-      strcpy(buffer,p->resnam);
-      KILLTRAILSPACES(buffer);
-      KILLLEADSPACES(buffer_ptr,buffer);
-      if((node = xmlNewChild(atom_node, NULL, 
-                             (xmlChar *)"label_comp_id",
-                             (xmlChar *)buffer_ptr))==NULL)
-         XMLDIE(doc);                      /* 25.02.15                  */
-
-      /* Note: Entity ID is not set for PDB format.
-               If entity_id is not set in PDB list then set from COMPND
-               or default to 1.
-      */
-      if(p->entity_id)
+   }
+
+   /* Conect nodes                                                      */
+   for(p=wpdb->pdb; p!=NULL; NEXT(p))
+   {
+      /* skip TER                                                       */
+      if(!strncmp("TER",p->resnam,3))
       {
-         /* set from PDB list */
-         sprintf(buffer,"%d", p->entity_id);
+         continue;
       }
-      else if(chain_to_entity != NULL && 
-              blHashKeyDefined(chain_to_entity, p->chain))
+
+      /* Add conect nodes                                               */
+      for(i=0; i < p->nConect; i++)
       {
-         /* set from COMPND record */
-         sprintf(buffer,"%d", 
-                 blGetHashValueInt(chain_to_entity, p->chain));
+         conect_id++;
+         if(!WritePDBMLConect(writer, p, p->conect[i], conect_id))
+            XMLDIE(writer);
       }
-      else
+   }
+
+   if(inCategory)
+   {
+      if(xmlTextWriterEndElement(writer) < 0)
+         XMLDIE(writer);
+      inCategory = FALSE;
+   }
+
+   /* get header data                                                   */
+   blGetHeaderWholePDB(wpdb, header, 82, date, 82, pdbcode, 82);
+   KILLTRAILSPACES(pdbcode);
+
+   /* get title                                                         */
+   title = blGetTitleWholePDB(wpdb);
+
+   /* add date node                                                     */
+   if(blSetPDBMLDateField(pdbml_date, date))
+   {
+      if(!StartPDBMLElement(writer, "database_PDB_revCategory") ||
+         !StartPDBMLElement(writer, "database_PDB_rev"))
+         XMLDIE(writer);
+      if(xmlTextWriterWriteAttribute(writer, (xmlChar *)"num",
+                                     (xmlChar *)"1") < 0)
+         XMLDIE(writer);
+
+      if(!WritePDBMLElement(writer, "date",          pdbml_date) ||
+         !WritePDBMLElement(writer, "date_original", pdbml_date) ||
+         !WritePDBMLElement(writer, "mod_type",      "0"))
+         XMLDIE(writer);
+
+      if(strlen(pdbcode) == 4)
       {
-         /* default */
-         strcpy(buffer,"1");
+         if(!WritePDBMLElement(writer, "replaces", pdbcode))
+            XMLDIE(writer);
       }
-      if((node = xmlNewChild(atom_node, NULL,
-                             (xmlChar *)"label_entity_id",
-                             (xmlChar *)buffer))==NULL)
-         XMLDIE(doc);
-
-
-      sprintf(buffer,"%d", p->resnum);
-      if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"label_seq_id",
-                             (xmlChar *)buffer))==NULL)
-         XMLDIE(doc);                      /* 25.02.15                  */
-
-      /* occupancy                                                      */
-      sprintf(buffer,"%.2f", p->occ);
-      if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"occupancy",
-                             (xmlChar *)buffer))==NULL)
-         XMLDIE(doc);                      /* 25.02.15                  */
-                         
-      /* insertion code
-         Note: Insertion code node only included for residues with 
-               insertion codes 
-      */
-      if(strcmp(p->insert," "))
+
+      if((xmlTextWriterEndElement(writer) < 0) ||
+         (xmlTextWriterEndElement(writer) < 0))
+         XMLDIE(writer);
+   }
+
+   /* add compnd nodes                                                  */
+   for(i=1; blGetCompoundWholePDBMolID(wpdb, i, &compound); i++)
+   {
+      molid = i;
+
+      if(!inCategory)
       {
-         sprintf(buffer,"%s", p->insert);
-         if((node = xmlNewChild(atom_node, NULL, 
-                                (xmlChar *)"pdbx_PDB_ins_code",
-                                (xmlChar *)buffer))==NULL)
-            XMLDIE(doc);                   /* 25.02.15                  */
+         /* add COMPND node */
+         if(!StartPDBMLElement(writer, "entityCategory"))
+            XMLDIE(writer);
+         inCategory = TRUE;
       }
 
-      /* model number
-         Note: Model number is not stored in PDB data structure.
-               Value set to 1
-      */
-      if((node = xmlNewChild(atom_node, NULL,
-                             (xmlChar *)"pdbx_PDB_model_num",
-                             (xmlChar *)"1"))==NULL)
-         XMLDIE(doc);                      /* 25.02.15                  */
+      if(!StartPDBMLElement(writer, "entity"))
+         XMLDIE(writer);
 
-      /* formal charge
-         Note: Formal charge node not included for neutral atoms 
-      */
-      if(p->formal_charge != 0)
+      sprintf(buffer,"%d", i);
+      if(xmlTextWriterWriteAttribute(writer, (xmlChar *)"id",
+                                     (xmlChar *)buffer) < 0)
+         XMLDIE(writer);
+
+      if(strlen(compound.other))
       {
-         sprintf(buffer,"%d", p->formal_charge);
-         if((node = xmlNewChild(atom_node, NULL, 
-                                (xmlChar *)"pdbx_formal_charge",
-                                (xmlChar *)buffer))==NULL)
-            XMLDIE(doc);                   /* 25.02.15                  */
+         if(!WritePDBMLElement(writer, "details", compound.other))
+            XMLDIE(writer);
       }
 
-      /* atom symbol
-         Note: If the atomic symbol is not set in PDB data structure then
-               the value set is based on columns 13-14 of pdb-formated
-               text file.  
-      */
-      sprintf(buffer,"%s", p->element);
-      KILLLEADSPACES(buffer_ptr,buffer);
-      if(strlen(buffer_ptr))
+      if(strlen(compound.molecule))
       {
-         if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"type_symbol",
-                                (xmlChar *)buffer_ptr))==NULL)
-            XMLDIE(doc);                   /* 25.02.15                  */
+         if(!WritePDBMLElement(writer, "pdbx_description",
+                               compound.molecule))
+            XMLDIE(writer);
+      }
 
+      if(strlen(compound.ec))
+      {
+         if(!WritePDBMLElement(writer, "pdbx_ec", compound.ec))
+            XMLDIE(writer);
       }
-      else
+
+      if(strlen(compound.fragment))
       {
-         blSetElementSymbolFromAtomName(buffer,p->atnam_raw);
-         if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"type_symbol",
-                                (xmlChar *)buffer))==NULL)
-            XMLDIE(doc);                   /* 25.02.15                  */
+         if(!WritePDBMLElement(writer, "pdbx_fragment", compound.fragment))
+            XMLDIE(writer);
       }
 
-      /* Segment ID 
-         Note: Segment ID is not included if blank 
-      */
-      if(strncmp(p->segid, "    ", 4))
+      if(strlen(compound.mutation))
       {
-         if((node = xmlNewChild(atom_node, NULL, 
-                                (xmlChar *)"seg_id",
-                                (xmlChar *)p->segid))==NULL)
-            XMLDIE(doc);                   /* 25.02.15                  */
+         if(!WritePDBMLElement(writer, "pdbx_mutation", compound.mutation))
+            XMLDIE(writer);
       }
+
+      /* set type to polymer */
+      if(!WritePDBMLElement(writer, "type", "polymer"))
+         XMLDIE(writer);
+
+      if(xmlTextWriterEndElement(writer) < 0)
+         XMLDIE(writer);
    }
 
-   /* Finished Coordinate Data                                          */
-   /* Clean up and return if doWhole == FALSE                           */
-   if(doWhole == FALSE)
+   if(inCategory)
    {
-      /* Write to doc file pointer                                      */
-      xmlDocFormatDump(fp,doc,1);
+      if(xmlTextWriterEndElement(writer) < 0)
+         XMLDIE(writer);
+      inCategory = FALSE;
+   }
 
-      /* Free Memory                                                    */
-      xmlFreeDoc(doc);
-      xmlCleanupParser();
-      blFreeHash(chain_to_entity);
+   /* add source nodes                                                  */
+   j = 0;
+   for(i=1; i <= molid; i++)
+   {
+      if(blGetSpeciesWholePDBMolID(wpdb, i, &species))
+      {
+         if(!inCategory)
+         {
+            /* add SOURCE node */
+            if(!StartPDBMLElement(writer, "entity_src_genCategory"))
+               XMLDIE(writer);
+            inCategory = TRUE;
+         }
 
-      return(TRUE);
-   }
+         j++; /* pdbx_src_id */
 
+         if(!StartPDBMLElement(writer, "entity_src_gen"))
+            XMLDIE(writer);
 
-   /*** Write Header and trailer data in PDBML-format                 ***/
+         sprintf(buffer,"%d", i);
+         if(xmlTextWriterWriteAttribute(writer, (xmlChar *)"entity_id",
+                                        (xmlChar *)buffer) < 0)
+            XMLDIE(writer);
+         sprintf(buffer,"%d", j);
+         if(xmlTextWriterWriteAttribute(writer, (xmlChar *)"pdbx_src_id",
+                                        (xmlChar *)buffer) < 0)
+            XMLDIE(writer);
 
-   /* struct_conn node                                                  */
-   for(p=wpdb->pdb; p!=NULL; NEXT(p))
-   {
-      if(p->nConect)
-      {
-         if((sites_node = xmlNewChild(root_node, NULL, 
-                                      (xmlChar *)"struct_connCategory", 
-                                      NULL))==NULL)
-            XMLDIE(doc);
+         if(strlen(species.commonName))
+         {
+            if(!WritePDBMLElement(writer, "pdbx_gene_src_common_name",
+                                  species.commonName))
+               XMLDIE(writer);
+         }
 
-         break;
+         if(strlen(species.strain))
+         {
+            if(!WritePDBMLElement(writer, "pdbx_gene_src_strain",
+                                  species.strain))
+               XMLDIE(writer);
+         }
+
+         if(species.taxid != 0)
+         {
+            sprintf(buffer,"%d", species.taxid);
+            if(!WritePDBMLElement(writer,
+                                  "pdbx_gene_src_ncbi_taxonomy_id",
+                                  buffer))
+               XMLDIE(writer);
+         }
+
+         if(strlen(species.scientificName))
+         {
+            if(!WritePDBMLElement(writer, "pdbx_gene_src_scientific_name",
+                                  species.scientificName))
+               XMLDIE(writer);
+         }
+
+         if(xmlTextWriterEndElement(writer) < 0)
+            XMLDIE(writer);
       }
    }
-   
-   /* Conect nodes                                                      */
-   for(p=wpdb->pdb; p!=NULL; NEXT(p))
+
+   if(inCategory)
    {
-      /* skip TER                                                       */
-      if(!strncmp("TER",p->resnam,3))
-      {
-         continue;
-      }
+      if(xmlTextWriterEndElement(writer) < 0)
+         XMLDIE(writer);
+      inCategory = FALSE;
+   }
 
-      /* Add conect nodes                                               */
-      for(i=0; i < p->nConect; i++)
+
+   /* SEQRES nodes                                                      */
+   /* get seqres chain ids from wpdb->header                            */
+   seqres_chain = ReadSeqresChainLabelWholePDB(wpdb, &seqres_nchains);
+   if(seqres_chain)
+   {
+      /* get seqres residues from wpdb->header                          */
+      seqres_residues = ReadSeqresResidueListWholePDB(wpdb,
+                                                      &seqres_nchains);
+
+      if(seqres_residues)
       {
-         if((atom_node = xmlNewChild(sites_node, NULL,
-                                     (xmlChar *)"struct_conn", NULL))==NULL)
-            XMLDIE(doc);
-
-         /* set conect atoms */
-         q = p->conect[i];
-         conect_id++;         
-
-         /* conect id */
-         sprintf(buffer, "%s%d", "conect", conect_id);
-         xmlNewProp(atom_node, (xmlChar *)"id", (xmlChar *)buffer);
-
-         /* connection type */
-         sprintf(buffer, "%s", "covale"); /* set type to covale         */
-         if((node = xmlNewChild(atom_node, NULL,
-                                (xmlChar *)"conn_type_id",
-                                (xmlChar *)buffer))==NULL)
-            XMLDIE(doc);
-
-         /* bond length                                                 */
-         sprintf(buffer, "%.3f", DIST(p,q));
-         if((node = xmlNewChild(atom_node, NULL,
-                                (xmlChar *)"pdbx_dist_value",
-                                (xmlChar *)buffer))==NULL)
-            XMLDIE(doc);
-
-         /* atom one data                                                */
-         if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"ptnr1_auth_asym_id",
-                                (xmlChar *)p->chain))==NULL)
-            XMLDIE(doc);
-
-         strcpy(buffer,p->resnam);
-         KILLTRAILSPACES(buffer);
-         KILLLEADSPACES(buffer_ptr,buffer);
-         if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"ptnr1_auth_comp_id",
-                                (xmlChar *)buffer_ptr))==NULL)
-            XMLDIE(doc);
-
-         sprintf(buffer,"%d", p->resnum);
-         if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"ptnr1_auth_seq_id",
-                                (xmlChar *)buffer))==NULL)
-            XMLDIE(doc);
-
-         /* include alt_id if present                                   */
-         if(p->altpos != ' ')
-         {
-            if((node = xmlNewChild(atom_node, NULL,
-                                   (xmlChar *)"ptnr1_label_alt_id",
-                                   NULL))==NULL)
-               XMLDIE(doc);
+         /* add pdbx_poly_seq_schemeCategory node                       */
+         if(!StartPDBMLElement(writer, "pdbx_poly_seq_schemeCategory"))
+            XMLDIE(writer);
 
-            buffer[0] = p->altpos;
-            buffer[1] = '\0';
-            xmlNodeSetContent(node, (xmlChar *)buffer);
-         }
-         
-         if((node = xmlNewChild(atom_node, NULL, 
-                                (xmlChar *)"ptnr1_label_asym_id",
-                                (xmlChar *)p->chain))==NULL)
-            XMLDIE(doc);
-
-         strcpy(buffer,p->atnam);
-         KILLTRAILSPACES(buffer);
-         if((node = xmlNewChild(atom_node, NULL, 
-                                (xmlChar *)"ptnr1_label_atom_id",
-                                (xmlChar *)buffer))==NULL)
-            XMLDIE(doc);
-
-         strcpy(buffer,p->resnam);
-         KILLTRAILSPACES(buffer);
-         KILLLEADSPACES(buffer_ptr,buffer);
-         if((node = xmlNewChild(atom_node, NULL, 
-                                (xmlChar *)"ptnr1_label_comp_id",
-                                (xmlChar *)buffer_ptr))==NULL)
-            XMLDIE(doc);
-      
-         sprintf(buffer,"%d", p->resnum);
-         if((node = xmlNewChild(atom_node, NULL,
-                                (xmlChar *)"ptnr1_label_seq_id",
-                                (xmlChar *)buffer))==NULL)
-            XMLDIE(doc);
-                   
-         /* insertion code
-            Note: Insertion code node only included for residues with 
-                  insertion codes 
-         */
-         if(strcmp(p->insert," "))
+         /* cycle through chains                                        */
+         for(i=0;i<seqres_nchains;i++)
          {
-            sprintf(buffer,"%s", p->insert);
-            if((node = xmlNewChild(atom_node, NULL, 
-                                   (xmlChar *)"ptnr1_PDB_ins_code",
-                                   (xmlChar *)buffer))==NULL)
-               XMLDIE(doc);
+            int res    = 1,                 /* reset residue count      */
+                entity = 1;                 /* set entity_id to default */
+
+            /* set entity based on chain id                             */
+            if(chain_to_entity != NULL &&
+               blHashKeyDefined(chain_to_entity, seqres_chain[i]))
+            {
+               entity = blGetHashValueInt(chain_to_entity,
+                                          seqres_chain[i]);
+            }
+
+            /* cycle through residues                                   */
+            for(s=seqres_residues[i];s!=NULL;NEXT(s),res++)
+            {
+               /* add pdbx_poly_seq_scheme node                         */
+               if(!StartPDBMLElement(writer, "pdbx_poly_seq_scheme"))
+                  XMLDIE(writer);
+
+               /* add attributes                                        */
+               /* asym_id                                               */
+               if(xmlTextWriterWriteAttribute(writer,
+                                              (xmlChar *)"asym_id",
+                                              (xmlChar *)seqres_chain[i])
+                  < 0)
+                  XMLDIE(writer);
+               /* entity_id                                             */
+               sprintf(buffer, "%d", entity);
+               if(xmlTextWriterWriteAttribute(writer,
+                                              (xmlChar *)"entity_id",
+                                              (xmlChar *)buffer) < 0)
+                  XMLDIE(writer);
+               /* mon_id                                                */
+               if(xmlTextWriterWriteAttribute(writer,
+                                              (xmlChar *)"mon_id",
+                                              (xmlChar *)s->string) < 0)
+                  XMLDIE(writer);
+               /* seq_id                                                */
+               sprintf(buffer, "%d", res);
+               if(xmlTextWriterWriteAttribute(writer,
+                                              (xmlChar *)"seq_id",
+                                              (xmlChar *)buffer) < 0)
+                  XMLDIE(writer);
+
+               /* add subnodes                                          */
+               if(!WritePDBMLElement(writer, "auth_mon_id",   s->string) ||
+                  !WritePDBMLElement(writer, "ndb_seq_num",   buffer)    ||
+                  !WritePDBMLElement(writer, "pdb_mon_id",    s->string) ||
+                  !WritePDBMLElement(writer, "pdb_strand_id",
+                                     seqres_chain[i]))
+                  XMLDIE(writer);
+
+               if(xmlTextWriterEndElement(writer) < 0)
+                  XMLDIE(writer);
+            }
+
+            FREELIST(seqres_residues[i],STRINGLIST);   /* free residues */
+            free(seqres_chain[i]);                     /* free chain id */
          }
+         free(seqres_residues);                  /* free residues array */
 
+         if(xmlTextWriterEndElement(writer) < 0)
+            XMLDIE(writer);
+      }
+      free(seqres_chain);                        /* free chain id array */
+   }
 
-         /* atom two data                                               */
-         if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"ptnr2_auth_asym_id",
-                                (xmlChar *)q->chain))==NULL)
-            XMLDIE(doc);
 
-         strcpy(buffer,q->resnam);
-         KILLTRAILSPACES(buffer);
-         KILLLEADSPACES(buffer_ptr,buffer);
-         if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"ptnr2_auth_comp_id",
-                                (xmlChar *)buffer_ptr))==NULL)
-            XMLDIE(doc);
+   /* pdb entry */
+   if(strlen(pdbcode))
+   {
+      if(!StartPDBMLElement(writer, "entryCategory") ||
+         !StartPDBMLElement(writer, "entry"))
+         XMLDIE(writer);
+      if((xmlTextWriterWriteAttribute(writer, (xmlChar *)"id",
+                                      (xmlChar *)pdbcode) < 0) ||
+         (xmlTextWriterEndElement(writer) < 0) ||
+         (xmlTextWriterEndElement(writer) < 0))
+         XMLDIE(writer);
+   }
 
-         sprintf(buffer,"%d", q->resnum);
-         if((node = xmlNewChild(atom_node, NULL, (xmlChar *)"ptnr2_auth_seq_id",
-                                (xmlChar *)buffer))==NULL)
-            XMLDIE(doc);
+   /* title node */
+   if(title != NULL && strlen(pdbcode))
+   {
+      if(!StartPDBMLElement(writer, "structCategory") ||
+         !StartPDBMLElement(writer, "struct"))
+         XMLDIE(writer);
+      if(xmlTextWriterWriteAttribute(writer, (xmlChar *)"entry_id",
+                                     (xmlChar *)pdbcode) < 0)
+         XMLDIE(writer);
+      if(!WritePDBMLElement(writer, "title", title))
+         XMLDIE(writer);
+      if((xmlTextWriterEndElement(writer) < 0) ||
+         (xmlTextWriterEndElement(writer) < 0))
+         XMLDIE(writer);
+   }
+   if(title != NULL){ free(title); }
 
-         /* include alt_id if present                                   */
-         if(q->altpos != ' ')
-         {
-            if((node = xmlNewChild(atom_node, NULL,
-                                   (xmlChar *)"ptnr2_label_alt_id",
-                                   NULL))==NULL)
-               XMLDIE(doc);
+   /* header node */
+   if(strlen(header) && strlen(pdbcode))
+   {
+      if(!StartPDBMLElement(writer, "struct_keywordsCategory") ||
+         !StartPDBMLElement(writer, "struct_keywords"))
+         XMLDIE(writer);
+      if(xmlTextWriterWriteAttribute(writer, (xmlChar *)"entry_id",
+                                     (xmlChar *)pdbcode) < 0)
+         XMLDIE(writer);
+      if(!WritePDBMLElement(writer, "pdbx_keywords", header))
+         XMLDIE(writer);
+      if((xmlTextWriterEndElement(writer) < 0) ||
+         (xmlTextWriterEndElement(writer) < 0))
+         XMLDIE(writer);
+   }
 
-            buffer[0] = q->altpos;
-            buffer[1] = '\0';
-            xmlNodeSetContent(node, (xmlChar *)buffer);
-         }
 
-         if((node = xmlNewChild(atom_node, NULL, 
-                                (xmlChar *)"ptnr2_label_asym_id",
-                                (xmlChar *)q->chain))==NULL)
-            XMLDIE(doc);
-
-         strcpy(buffer,q->atnam);
-         KILLTRAILSPACES(buffer);
-         if((node = xmlNewChild(atom_node, NULL, 
-                                (xmlChar *)"ptnr2_label_atom_id",
-                                (xmlChar *)buffer))==NULL)
-            XMLDIE(doc);
-
-         strcpy(buffer,q->resnam);
-         KILLTRAILSPACES(buffer);
-         KILLLEADSPACES(buffer_ptr,buffer);
-         if((node = xmlNewChild(atom_node, NULL, 
-                                (xmlChar *)"ptnr2_label_comp_id",
-                                (xmlChar *)buffer_ptr))==NULL)
-            XMLDIE(doc);
-      
-         sprintf(buffer,"%d", q->resnum);
-         if((node = xmlNewChild(atom_node, NULL,
-                                (xmlChar *)"ptnr2_label_seq_id",
-                                (xmlChar *)buffer))==NULL)
-            XMLDIE(doc);
-
-                         
-         /* insertion code
-            Note: Insertion code node only included for residues with 
-                  insertion codes 
-         */
-         if(strcmp(q->insert," "))
-         {
-            sprintf(buffer,"%s", q->insert);
-            if((node = xmlNewChild(atom_node, NULL, 
-                                   (xmlChar *)"ptnr2_PDB_ins_code",
-                                   (xmlChar *)buffer))==NULL)
-               XMLDIE(doc);
-         }
-      }      
+   /* Close the root node and flush the output                          */
+   if(xmlTextWriterEndDocument(writer) < 0)
+      XMLDIE(writer);
+
+   /* Free Memory                                                       */
+   xmlFreeTextWriter(writer);
+   xmlCleanupParser();
+   blFreeHash(chain_to_entity);
+
+   return(TRUE);
+
+#endif
+}
+
+
+#ifdef XML_SUPPORT
+/************************************************************************/
+/*>static BOOL WritePDBMLAtomSite(xmlTextWriterPtr writer, PDB *p,
+                                  HASHTABLE *chain_to_entity)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]     writer           XML writer
+   \param[in]     *p               Atom to write
+   \param[in]     *chain_to_entity Hash of chain labels to entity IDs
+                                   from COMPND records (or NULL)
+   \return                         Success
+
+   Writes a complete PDBML atom_site element for one atom. Split out
+   of blDoWritePDBAsPDBML()
+
+-  18.10.26 Original
+*/
+static BOOL WritePDBMLAtomSite(xmlTextWriterPtr writer, PDB *p,
+                               HASHTABLE *chain_to_entity)
+{
+   char buffer[16],
+        *buffer_ptr;
+
+   /* Add atom node                                                     */
+   if(!StartPDBMLElement(writer, "atom_site"))
+      return(FALSE);
+
+   sprintf(buffer, "%d", p->atnum);
+   if(xmlTextWriterWriteAttribute(writer, (xmlChar *)"id",
+                                  (xmlChar *)buffer) < 0)
+      return(FALSE);
+
+   /*** Add atom data nodes                                           ***/
+
+   /* B value                                                           */
+   sprintf(buffer,"%.2f", p->bval);
+   if(!WritePDBMLElement(writer, "B_iso_or_equiv", buffer))
+      return(FALSE);
+
+   /* coordinates                                                       */
+   sprintf(buffer,"%.3f", p->x);
+   if(!WritePDBMLElement(writer, "Cartn_x", buffer))
+      return(FALSE);
+
+   sprintf(buffer,"%.3f", p->y);
+   if(!WritePDBMLElement(writer, "Cartn_y", buffer))
+      return(FALSE);
+
+   sprintf(buffer,"%.3f", p->z);
+   if(!WritePDBMLElement(writer, "Cartn_z", buffer))
+      return(FALSE);
+
+   /* author atom site labels                                           */
+   if(!WritePDBMLElement(writer, "auth_asym_id", p->chain))
+      return(FALSE);
+
+   strcpy(buffer,p->atnam);
+   KILLTRAILSPACES(buffer);
+   if(!WritePDBMLElement(writer, "auth_atom_id", buffer))
+      return(FALSE);
+
+   strcpy(buffer,p->resnam);
+   KILLTRAILSPACES(buffer);
+   KILLLEADSPACES(buffer_ptr,buffer);
+   if(!WritePDBMLElement(writer, "auth_comp_id", buffer_ptr))
+      return(FALSE);
+
+   sprintf(buffer,"%d", p->resnum);
+   if(!WritePDBMLElement(writer, "auth_seq_id", buffer))
+      return(FALSE);
+
+   /* record type atom/hetatm                                           */
+   strcpy(buffer,p->record_type);
+   KILLTRAILSPACES(buffer);
+   if(!WritePDBMLElement(writer, "group_PDB", buffer))
+      return(FALSE);
+
+   /* atom site labels                                                  */
+   if(p->altpos == ' ')
+   {
+      if(!StartPDBMLElement(writer, "label_alt_id"))
+         return(FALSE);
+      if(xmlTextWriterWriteAttributeNS(writer, (xmlChar *)"xsi",
+                                       (xmlChar *)"nil", NULL,
+                                       (xmlChar *)"true") < 0)
+         return(FALSE);
+      if(xmlTextWriterEndElement(writer) < 0)
+         return(FALSE);
+   }
+   else
+   {
+      buffer[0] = p->altpos;
+      buffer[1] = '\0';
+      if(!WritePDBMLElement(writer, "label_alt_id", buffer))
+         return(FALSE);
    }
 
-   /* get header data                                                   */
-   blGetHeaderWholePDB(wpdb, header, 82, date, 82, pdbcode, 82);
-   KILLTRAILSPACES(pdbcode);
-   
-   /* get title                                                         */
-   title = blGetTitleWholePDB(wpdb);
+   if(!WritePDBMLElement(writer, "label_asym_id", p->chain))
+      return(FALSE);
 
-   /* add date node                                                     */
-   if(blSetPDBMLDateField(pdbml_date, date))
+   strcpy(buffer,p->atnam);
+   KILLTRAILSPACES(buffer);
+   if(!WritePDBMLElement(writer, "label_atom_id", buffer))
+      return(FALSE);
+
+   strcpy(buffer,p->resnam);
+   KILLTRAILSPACES(buffer);
+   KILLLEADSPACES(buffer_ptr,buffer);
+   if(!WritePDBMLElement(writer, "label_comp_id", buffer_ptr))
+      return(FALSE);
+
+   /* Note: Entity ID is not set for PDB format.
+            If entity_id is not set in PDB list then set from COMPND
+            or default to 1.
+   */
+   if(p->entity_id)
    {
-      if((sites_node = xmlNewChild(root_node, NULL, 
-                                   (xmlChar *)"database_PDB_revCategory", 
-                                   NULL))==NULL)
-         XMLDIE(doc);
-            
-      if((atom_node = xmlNewChild(sites_node, NULL, 
-                                  (xmlChar *)"database_PDB_rev",
-                                  NULL))==NULL)
-         XMLDIE(doc);
-      xmlNewProp(atom_node, (xmlChar *)"num", (xmlChar *)"1");
-
-      if((node = xmlNewChild(atom_node, NULL, 
-                            (xmlChar *)"date",
-                            (xmlChar *)pdbml_date))==NULL)
-         XMLDIE(doc);
- 
-       if((node = xmlNewChild(atom_node, NULL, 
-                            (xmlChar *)"date_original",
-                            (xmlChar *)pdbml_date))==NULL)
-         XMLDIE(doc);
-
-       if((node = xmlNewChild(atom_node, NULL, 
-                            (xmlChar *)"mod_type",
-                            (xmlChar *)"0"))==NULL)
-         XMLDIE(doc);
-     
-      if(strlen(pdbcode) == 4)
-      {
-         if((node = xmlNewChild(atom_node, NULL, 
-                                (xmlChar *)"replaces",
-                                (xmlChar *)pdbcode))==NULL)
-            XMLDIE(doc);
-      }
+      /* set from PDB list */
+      sprintf(buffer,"%d", p->entity_id);
+   }
+   else if(chain_to_entity != NULL &&
+           blHashKeyDefined(chain_to_entity, p->chain))
+   {
+      /* set from COMPND record */
+      sprintf(buffer,"%d",
+              blGetHashValueInt(chain_to_entity, p->chain));
    }
+   else
+   {
+      /* default */
+      strcpy(buffer,"1");
+   }
+   if(!WritePDBMLElement(writer, "label_entity_id", buffer))
+      return(FALSE);
 
-   /* add compnd nodes                                                  */
-   sites_node = NULL;
-   for(i=1; blGetCompoundWholePDBMolID(wpdb, i, &compound); i++)
+   sprintf(buffer,"%d", p->resnum);
+   if(!WritePDBMLElement(writer, "label_seq_id", buffer))
+      return(FALSE);
+
+   /* occupancy                                                         */
+   sprintf(buffer,"%.2f", p->occ);
+   if(!WritePDBMLElement(writer, "occupancy", buffer))
+      return(FALSE);
+
+   /* insertion code
+      Note: Insertion code node only included for residues with
+            insertion codes
+   */
+   if(strcmp(p->insert," "))
    {
-      molid = i;
+      if(!WritePDBMLElement(writer, "pdbx_PDB_ins_code", p->insert))
+         return(FALSE);
+   }
 
-      if(sites_node == NULL)
-      {
-         /* add COMPND node */
-         if((sites_node = xmlNewChild(root_node, NULL, 
-                                      (xmlChar *)"entityCategory", 
-                                      NULL))==NULL)
-            XMLDIE(doc);
-      }
+   /* model number
+      Note: Model number is not stored in PDB data structure.
+            Value set to 1
+   */
+   if(!WritePDBMLElement(writer, "pdbx_PDB_model_num", "1"))
+      return(FALSE);
+
+   /* formal charge
+      Note: Formal charge node not included for neutral atoms
+   */
+   if(p->formal_charge != 0)
+   {
+      sprintf(buffer,"%d", p->formal_charge);
+      if(!WritePDBMLElement(writer, "pdbx_formal_charge", buffer))
+         return(FALSE);
+   }
+
+   /* atom symbol
+      Note: If the atomic symbol is not set in PDB data structure then
+            the value set is based on columns 13-14 of pdb-formated
+            text file.
+   */
+   sprintf(buffer,"%s", p->element);
+   KILLLEADSPACES(buffer_ptr,buffer);
+   if(strlen(buffer_ptr))
+   {
+      if(!WritePDBMLElement(writer, "type_symbol", buffer_ptr))
+         return(FALSE);
+   }
+   else
+   {
+      blSetElementSymbolFromAtomName(buffer,p->atnam_raw);
+      if(!WritePDBMLElement(writer, "type_symbol", buffer))
+         return(FALSE);
+   }
+
+   /* Segment ID
+      Note: Segment ID is not included if blank
+   */
+   if(strncmp(p->segid, "    ", 4))
+   {
+      if(!WritePDBMLElement(writer, "seg_id", p->segid))
+         return(FALSE);
+   }
 
-      if((atom_node = xmlNewChild(sites_node, NULL, 
-                                  (xmlChar *)"entity",
-                                  NULL))==NULL){ XMLDIE(doc); }
+   return(xmlTextWriterEndElement(writer) >= 0);
+}
 
-      sprintf(buffer,"%d", i);
-      xmlNewProp(atom_node, (xmlChar *)"id", (xmlChar *)buffer);
 
-      if(strlen(compound.other))
-      {
-         if((node = xmlNewChild(atom_node, NULL, 
-                                (xmlChar *)"details",
-                                (xmlChar *)compound.other))==NULL)
-         { XMLDIE(doc); }
-      }
+/************************************************************************/
+/*>static BOOL WritePDBMLConect(xmlTextWriterPtr writer, PDB *p, PDB *q,
+                                int conect_id)
+   ---------------------------------------------------------------------
+*//**
 
-      if(strlen(compound.molecule))
-      {
-         if((node = xmlNewChild(atom_node, NULL, 
-                                (xmlChar *)"pdbx_description",
-                                (xmlChar *)compound.molecule))==NULL)
-         { XMLDIE(doc); }
-      }
+   \param[in]     writer     XML writer
+   \param[in]     *p         First atom of the bond
+   \param[in]     *q         Second atom of the bond
+   \param[in]     conect_id  Number used for the struct_conn id
+   \return                   Success
 
-      if(strlen(compound.ec))
-      {
-         if((node = xmlNewChild(atom_node, NULL, 
-                                (xmlChar *)"pdbx_ec",
-                                (xmlChar *)compound.ec))==NULL)
-         { XMLDIE(doc); }
-      }
+   Writes a PDBML struct_conn element for a CONECT between two atoms.
+   Split out of blDoWritePDBAsPDBML()
 
-      if(strlen(compound.fragment))
-      {
-         if((node = xmlNewChild(atom_node, NULL, 
-                                (xmlChar *)"pdbx_fragment",
-                                (xmlChar *)compound.fragment))==NULL)
-         { XMLDIE(doc); }
-      }
+-  18.10.26 Original
+*/
+static BOOL WritePDBMLConect(xmlTextWriterPtr writer, PDB *p, PDB *q,
+                             int conect_id)
+{
+   char buffer[24];
 
-      if(strlen(compound.mutation))
-      {
-         if((node = xmlNewChild(atom_node, NULL, 
-                                (xmlChar *)"pdbx_mutation",
-                                (xmlChar *)compound.mutation))==NULL)
-         { XMLDIE(doc); }
-      }
+   if(!StartPDBMLElement(writer, "struct_conn"))
+      return(FALSE);
 
-      /* set type to polymer */
-      if((node = xmlNewChild(atom_node, NULL, 
-                             (xmlChar *)"type",
-                             (xmlChar *)"polymer"))==NULL)
-      { XMLDIE(doc); }
-   }
+   /* conect id                                                         */
+   sprintf(buffer, "%s%d", "conect", conect_id);
+   if(xmlTextWriterWriteAttribute(writer, (xmlChar *)"id",
+                                  (xmlChar *)buffer) < 0)
+      return(FALSE);
 
-   /* add source nodes                                                  */
-   sites_node = NULL;
-   j = 0;
-   for(i=1; i <= molid; i++)
-   {
-      if(blGetSpeciesWholePDBMolID(wpdb, i, &species))
-      {
-         if(sites_node == NULL)
-         {
-            /* add SOURCE node */
-            if((sites_node = xmlNewChild(root_node, NULL, 
-                                         (xmlChar *)"entity_src_genCategory", 
-                                         NULL))==NULL)
-               XMLDIE(doc);
-         }
+   /* connection type - set type to covale                              */
+   if(!WritePDBMLElement(writer, "conn_type_id", "covale"))
+      return(FALSE);
 
-         j++; /* pdbx_src_id */
-         
-         if((atom_node = xmlNewChild(sites_node, NULL, 
-                                  (xmlChar *)"entity_src_gen",
-                                  NULL))==NULL){ XMLDIE(doc); }
+   /* bond length                                                       */
+   sprintf(buffer, "%.3f", DIST(p,q));
+   if(!WritePDBMLElement(writer, "pdbx_dist_value", buffer))
+      return(FALSE);
 
-         sprintf(buffer,"%d", i);
-         xmlNewProp(atom_node,(xmlChar *)"entity_id",(xmlChar *)buffer);
-         sprintf(buffer,"%d", j);
-         xmlNewProp(atom_node,(xmlChar *)"pdbx_src_id",(xmlChar *)buffer);
+   /* atom one and atom two data                                        */
+   if(!WritePDBMLConectPartner(writer, "ptnr1", p) ||
+      !WritePDBMLConectPartner(writer, "ptnr2", q))
+      return(FALSE);
 
-         if(strlen(species.commonName))
-         {
-            if((node = xmlNewChild(atom_node, NULL, 
-                                   (xmlChar *)"pdbx_gene_src_common_name",
-                                   (xmlChar *)species.commonName))==NULL)
-            { XMLDIE(doc); }
-         }
+   return(xmlTextWriterEndElement(writer) >= 0);
+}
 
-         if(strlen(species.strain))
-         {
-            if((node = xmlNewChild(atom_node, NULL, 
-                                   (xmlChar *)"pdbx_gene_src_strain",
-                                   (xmlChar *)species.strain))==NULL)
-            { XMLDIE(doc); }
-         }
 
-         if(species.taxid != 0)
-         {
-            sprintf(buffer,"%d", species.taxid);
-            if((node = xmlNewChild(atom_node, NULL, 
-                                   (xmlChar *)"pdbx_gene_src_ncbi_taxonomy_id",
-                                   (xmlChar *)buffer))==NULL)
-            { XMLDIE(doc); }
-         }
+/************************************************************************/
+/*>static BOOL WritePDBMLConectPartner(xmlTextWriterPtr writer,
+                                       char *partner, PDB *p)
+   ------------------------------------------------------------
+*//**
 
-         if(strlen(species.scientificName))
-         {
-            if((node = xmlNewChild(atom_node, NULL, 
-                                   (xmlChar *)"pdbx_gene_src_scientific_name",
-                                   (xmlChar *)species.scientificName))==NULL)
-            { XMLDIE(doc); }
-         }
-      }
-   }
+   \param[in]     writer     XML writer
+   \param[in]     *partner   Element name prefix ("ptnr1" or "ptnr2")
+   \param[in]     *p         Atom to describe
+   \return                   Success
 
+   Writes the elements describing one atom of a struct_conn
 
-   /* SEQRES nodes                                                      */
-   /* get seqres chain ids from wpdb->header                            */
-   seqres_chain = ReadSeqresChainLabelWholePDB(wpdb, &seqres_nchains);
-   if(seqres_chain)
-   {
-      /* get seqres residues from wpdb->header                          */
-      seqres_residues = ReadSeqresResidueListWholePDB(wpdb,
-                                                      &seqres_nchains);
-   
-      if(seqres_residues)
-      {
-         /* add pdbx_poly_seq_schemeCategory node                       */
-         if((sites_node = xmlNewChild(root_node, NULL, 
-                           (xmlChar *)"pdbx_poly_seq_schemeCategory", 
-                           NULL))==NULL){ XMLDIE(doc); }
+-  18.10.26 Original
+*/
+static BOOL WritePDBMLConectPartner(xmlTextWriterPtr writer,
+                                    char *partner, PDB *p)
+{
+   char buffer[16],
+        name[40],
+        *buffer_ptr;
 
-         /* cycle through chains                                        */
-         for(i=0;i<seqres_nchains;i++)
-         {
-            int res    = 1,                 /* reset residue count      */
-                entity = 1;                 /* set entity_id to default */
+   sprintf(name, "%s_auth_asym_id", partner);
+   if(!WritePDBMLElement(writer, name, p->chain))
+      return(FALSE);
 
-            /* set entity based on chain id                             */
-            if(chain_to_entity != NULL && 
-               blHashKeyDefined(chain_to_entity, seqres_chain[i]))
-            {
-               entity = blGetHashValueInt(chain_to_entity, 
-                                          seqres_chain[i]);
-            }
+   strcpy(buffer,p->resnam);
+   KILLTRAILSPACES(buffer);
+   KILLLEADSPACES(buffer_ptr,buffer);
+   sprintf(name, "%s_auth_comp_id", partner);
+   if(!WritePDBMLElement(writer, name, buffer_ptr))
+      return(FALSE);
 
-             /* cycle through residues                                  */
-            for(s=seqres_residues[i];s!=NULL;NEXT(s),res++)
-            {
-              /* add pdbx_poly_seq_scheme node                          */
-              if((atom_node = xmlNewChild(sites_node, NULL,
-                              (xmlChar *)"pdbx_poly_seq_scheme", NULL))
-                                                                 == NULL)
-              { XMLDIE(doc); }
-              /* add attributes                                         */
-              /* asym_id                                                */
-              xmlNewProp(atom_node, (xmlChar *)"asym_id", 
-                         (xmlChar *)seqres_chain[i]);
-              /* entity_id                                              */
-              sprintf(buffer, "%d", entity);
-              xmlNewProp(atom_node, (xmlChar *)"entity_id", 
-                         (xmlChar *)buffer);
-              /* mon_id                                                 */
-              xmlNewProp(atom_node, (xmlChar *)"mon_id", 
-                         (xmlChar *)s->string);
-              /* seq_id                                                 */
-              sprintf(buffer, "%d", res);
-              xmlNewProp(atom_node, (xmlChar *)"seq_id", 
-                         (xmlChar *)buffer);
-
-              /* add subnodes                                           */
-              /* auth_mon_id                                            */
-              sprintf(buffer,"%d", res);
-              if((node = xmlNewChild(atom_node, NULL, 
-                                     (xmlChar *)"auth_mon_id",
-                                     (xmlChar *)s->string))==NULL)
-                 XMLDIE(doc);
-              /* ndb_seq_num                                            */
-              sprintf(buffer,"%d", res);
-              if((node = xmlNewChild(atom_node, NULL, 
-                                     (xmlChar *)"ndb_seq_num",
-                                     (xmlChar *)buffer))==NULL)
-                 XMLDIE(doc);
-              /* pdb_mon_id                                             */
-              sprintf(buffer,"%d", res);
-              if((node = xmlNewChild(atom_node, NULL, 
-                                     (xmlChar *)"pdb_mon_id",
-                                     (xmlChar *)s->string))==NULL)
-                 XMLDIE(doc);
-              /* pdb_strand_id                                          */
-              sprintf(buffer,"%d", res);
-              if((node = xmlNewChild(atom_node, NULL, 
-                                     (xmlChar *)"pdb_strand_id",
-                                     (xmlChar *)seqres_chain[i]))==NULL)
-                 XMLDIE(doc);
-            }
+   sprintf(buffer,"%d", p->resnum);
+   sprintf(name, "%s_auth_seq_id", partner);
+   if(!WritePDBMLElement(writer, name, buffer))
+      return(FALSE);
 
-            FREELIST(seqres_residues[i],STRINGLIST);   /* free residues */
-            free(seqres_chain[i]);                     /* free chain id */
-         }
-         free(seqres_residues);                  /* free residues array */
-      }
-      free(seqres_chain);                        /* free chain id array */
+   /* include alt_id if present                                         */
+   if(p->altpos != ' ')
+   {
+      buffer[0] = p->altpos;
+      buffer[1] = '\0';
+      sprintf(name, "%s_label_alt_id", partner);
+      if(!WritePDBMLElement(writer, name, buffer))
+         return(FALSE);
    }
 
+   sprintf(name, "%s_label_asym_id", partner);
+   if(!WritePDBMLElement(writer, name, p->chain))
+      return(FALSE);
 
-   /* pdb entry */
-   if(strlen(pdbcode))
+   strcpy(buffer,p->atnam);
+   KILLTRAILSPACES(buffer);
+   sprintf(name, "%s_label_atom_id", partner);
+   if(!WritePDBMLElement(writer, name, buffer))
+      return(FALSE);
+
+   strcpy(buffer,p->resnam);
+   KILLTRAILSPACES(buffer);
+   KILLLEADSPACES(buffer_ptr,buffer);
+   sprintf(name, "%s_label_comp_id", partner);
+   if(!WritePDBMLElement(writer, name, buffer_ptr))
+      return(FALSE);
+
+   sprintf(buffer,"%d", p->resnum);
+   sprintf(name, "%s_label_seq_id", partner);
+   if(!WritePDBMLElement(writer, name, buffer))
+      return(FALSE);
+
+   /* insertion code
+      Note: Insertion code node only included for residues with
+            insertion codes
+   */
+   if(strcmp(p->insert," "))
    {
-      if((sites_node = xmlNewChild(root_node, NULL, 
-                                   (xmlChar *)"entryCategory", 
-                                   NULL))==NULL)
-         XMLDIE(doc);
-            
-      if((atom_node = xmlNewChild(sites_node, NULL, 
-                                  (xmlChar *)"entry",
-                                  (xmlChar *)""))==NULL)
-         XMLDIE(doc);
-      xmlNewProp(atom_node, (xmlChar *)"id", (xmlChar *)pdbcode);
+      sprintf(name, "%s_PDB_ins_code", partner);
+      if(!WritePDBMLElement(writer, name, p->insert))
+         return(FALSE);
    }
 
-   /* title node */
-   if(title != NULL && strlen(pdbcode))
-   {
-      if((sites_node = xmlNewChild(root_node, NULL, 
-                                   (xmlChar *)"structCategory", 
-                                   NULL))==NULL)
-         XMLDIE(doc);
-            
-     if((atom_node = xmlNewChild(sites_node, NULL, 
-                                 (xmlChar *)"struct",
-                                 NULL))==NULL)
-        XMLDIE(doc);
-     xmlNewProp(atom_node, (xmlChar *)"entry_id", (xmlChar *)pdbcode);
-     
-     if((node = xmlNewChild(atom_node, NULL, 
-                                 (xmlChar *)"title",
-                                 (xmlChar *)title))==NULL)
-        XMLDIE(doc);
+   return(TRUE);
+}
 
-   }
-   if(title != NULL){ free(title); }
 
-   /* header node */
-   if(strlen(header) && strlen(pdbcode))
-   {
-      if((sites_node = xmlNewChild(root_node, NULL, 
-                                   (xmlChar *)"struct_keywordsCategory", 
-                                   NULL))==NULL)
-         XMLDIE(doc);
-            
-     if((atom_node = xmlNewChild(sites_node, NULL, 
-                                 (xmlChar *)"struct_keywords",
-                                 NULL))==NULL)
-        XMLDIE(doc);
-     xmlNewProp(atom_node, (xmlChar *)"entry_id", (xmlChar *)pdbcode);
-     
-     if((node = xmlNewChild(atom_node, NULL, 
-                                 (xmlChar *)"pdbx_keywords",
-                                 (xmlChar *)header))==NULL)
-        XMLDIE(doc);
+/************************************************************************/
+/*>static BOOL StartPDBMLElement(xmlTextWriterPtr writer, char *name)
+   ------------------------------------------------------------------
+*//**
 
-   }
+   \param[in]     writer     XML writer
+   \param[in]     *name      Element name without the PDBx: prefix
+   \return                   Success
+
+   Opens a PDBx: element. Attributes and child elements may then be
+   written and the element is closed with xmlTextWriterEndElement()
+
+-  18.10.26 Original
+*/
+static BOOL StartPDBMLElement(xmlTextWriterPtr writer, char *name)
+{
+   return(xmlTextWriterStartElementNS(writer, (xmlChar *)"PDBx",
+                                      (xmlChar *)name, NULL) >= 0);
+}
 
 
-   /* Write to doc file pointer                                         */
-   xmlDocFormatDump(fp,doc,1);
+/************************************************************************/
+/*>static BOOL WritePDBMLElement(xmlTextWriterPtr writer, char *name,
+                                 char *content)
+   ------------------------------------------------------------------
+*//**
 
-   /* Free Memory                                                       */
-   xmlFreeDoc(doc);
-   xmlCleanupParser();
-   blFreeHash(chain_to_entity);
+   \param[in]     writer     XML writer
+   \param[in]     *name      Element name without the PDBx: prefix
+   \param[in]     *content   Text content (NULL or blank for an empty
+                             element)
+   \return                   Success
 
-   return(TRUE);
+   Writes a complete PDBx: element containing just text
 
-#endif
+-  18.10.26 Original
+*/
+static BOOL WritePDBMLElement(xmlTextWriterPtr writer, char *name,
+                              char *content)
+{
+   if(!StartPDBMLElement(writer, name))
+      return(FALSE);
+
+   if((content != NULL) && (content[0] != '\0'))
+   {
+      if(xmlTextWriterWriteString(writer, (xmlChar *)content) < 0)
+         return(FALSE);
+   }
+
+   return(xmlTextWriterEndElement(writer) >= 0);
 }
+#endif
 
 
 /************************************************************************/
@@ -1991,10 +2439,14 @@ static HASHTABLE *blMapChainsToEntity(WHOLEPDB *wpdb)
    character arrays in which the chain label is stored.
 
 -  09.07.15 Original based on blReadSeqresResidueWholePDB()   By: CTP
+-  18.10.26 Uses blGetHeaderRecordsWholePDB() and blAppendString()
 */
 static char **ReadSeqresChainLabelWholePDB(WHOLEPDB *wpdb, int *nchains)
 {
    STRINGLIST *seqres = NULL, 
+              *tail   = NULL,
+              *first,
+              *stop,
               *s;
    char       currchain[2] = " ",
               chain[2]     = " ",
@@ -2005,15 +2457,13 @@ static char **ReadSeqresChainLabelWholePDB(WHOLEPDB *wpdb, int *nchains)
    *nchains = 0;
    
    /* First read the SEQRES records into a linked list                  */
-   for(s=wpdb->header; s!=NULL; NEXT(s))
+   first = blGetHeaderRecordsWholePDB(wpdb, "SEQRES", &stop);
+   for(s=first; s!=stop; NEXT(s))
    {
       if(!strncmp(s->string,"SEQRES",6))
       {
-         if((seqres = blStoreString(seqres, s->string)) == NULL)
-         {
-            FREELIST(seqres, STRINGLIST);
+         if((tail = blAppendString(&seqres, tail, s->string)) == NULL)
             return(NULL);
-         }
       }
    }
 
@@ -2094,11 +2544,15 @@ static char **ReadSeqresChainLabelWholePDB(WHOLEPDB *wpdb, int *nchains)
    cope with any size of sequence information from the PDB file.
 
 -  09.07.15 Original based on blReadSeqresResidueWholePDB()   By: CTP
+-  18.10.26 Uses blGetHeaderRecordsWholePDB() and blAppendString()
 */
 static STRINGLIST **ReadSeqresResidueListWholePDB(WHOLEPDB *wpdb, 
                                                   int *nchains)
 {
    STRINGLIST *seqres = NULL, 
+              *tail   = NULL,
+              *first,
+              *stop,
               *s,
               **residuelist = NULL;
    char       currchain[2] = " ",
@@ -2111,15 +2565,13 @@ static STRINGLIST **ReadSeqresResidueListWholePDB(WHOLEPDB *wpdb,
    
 
    /* First read the SEQRES records into a linked list                  */
-   for(s=wpdb->header; s!=NULL; NEXT(s))
+   first = blGetHeaderRecordsWholePDB(wpdb, "SEQRES", &stop);
+   for(s=first; s!=stop; NEXT(s))
    {
       if(!strncmp(s->string,"SEQRES",6))
       {
-         if((seqres = blStoreString(seqres, s->string)) == NULL)
-         {
-            FREELIST(seqres, STRINGLIST);
+         if((tail = blAppendString(&seqres, tail, s->string)) == NULL)
             return(NULL);
-         }
       }
    }
 
@@ -2188,3 +2640,214 @@ static STRINGLIST **ReadSeqresResidueListWholePDB(WHOLEPDB *wpdb,
    FREELIST(seqres, STRINGLIST);
    return(residuelist);
 }
+
+
+/************************************************************************/
+#ifdef BENCHMARK
+#include <time.h>
+/************************************************************************/
+/*>static void LegacyWritePDBRecord(FILE *fp, PDB *pdb)
+   ----------------------------------------------------
+*//**
+
+   The fprintf() version of blWritePDBRecord() for comparison
+
+-  18.10.26 Original
+*/
+static void LegacyWritePDBRecord(FILE *fp, PDB *pdb)
+{
+   char charge = ' ',
+        sign   = ' ';
+
+   if(pdb->formal_charge && ABS(pdb->formal_charge) <= 8)
+   {
+      charge = (char)('0' + ABS(pdb->formal_charge));
+      sign   = (char)(pdb->formal_charge > 0 ? '+' : '-');
+   }
+
+   fprintf(fp,"%-6s%5d %-4s%c%-4s%1s%4d%1s   %8.3f%8.3f%8.3f%6.2f%6.2f      %4s%2s%c%c\n",
+           pdb->record_type, pdb->atnum, pdb->atnam_raw, pdb->altpos,
+           pdb->resnam, pdb->chain, pdb->resnum, pdb->insert,
+           pdb->x, pdb->y, pdb->z, pdb->occ, pdb->bval,
+           pdb->segid, pdb->element, charge, sign);
+}
+
+/************************************************************************/
+/*>static void LegacyWriteTerCard(FILE *fp, PDB *p)
+   ------------------------------------------------
+*//**
+
+   The fprintf() version of blWriteTerCard() for comparison
+
+-  18.10.26 Original
+*/
+static void LegacyWriteTerCard(FILE *fp, PDB *p)
+{
+   fprintf(fp,"TER   %5d      %-4s%1s%4d%1s%s\n",
+           p->atnum+1, p->resnam, p->chain, p->resnum, p->insert,
+           "                                                     ");
+}
+
+/************************************************************************/
+/*>static int LegacyWritePDB(FILE *fp, PDB *pdb)
+   ---------------------------------------------
+*//**
+
+   blWritePDBAsPDBorGromos() as it was before records were formatted
+   into a buffer
+
+-  18.10.26 Original
+*/
+static int LegacyWritePDB(FILE *fp, PDB *pdb)
+{
+   PDB  *p,
+        *prev = NULL;
+   int  numTer = 0;
+   BOOL doneTer = FALSE;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      if((prev!=NULL) && !strncmp(prev->record_type, "ATOM  ", 6))
+      {
+         if(!doneTer && !CHAINMATCH(p->chain, prev->chain))
+         {
+            LegacyWriteTerCard(fp, prev);
+            numTer++;
+            doneTer = TRUE;
+         }
+         if(!doneTer && !strncmp(p->record_type, "HETATM", 6))
+         {
+            PDB *prevStart = blFindResidue(pdb, prev->chain, prev->resnum,
+                                           prev->insert);
+            if(!blAreResiduePointersBonded(prevStart, p, (REAL)0.2))
+            {
+               LegacyWriteTerCard(fp, prev);
+               numTer++;
+               doneTer = TRUE;
+            }
+         }
+      }
+      LegacyWritePDBRecord(fp,p);
+      doneTer = FALSE;
+      prev=p;
+   }
+
+   if((!doneTer) && (prev!=NULL) && !strncmp(prev->record_type, "ATOM  ", 6))
+   {
+      LegacyWriteTerCard(fp, prev);
+      numTer++;
+   }
+   return(numTer);
+}
+
+/************************************************************************/
+/*>static BOOL SameContents(FILE *fp1, FILE *fp2)
+   ----------------------------------------------
+*//**
+
+   Compares two files from the start
+
+-  18.10.26 Original
+*/
+static BOOL SameContents(FILE *fp1, FILE *fp2)
+{
+   int c1, c2;
+
+   rewind(fp1);
+   rewind(fp2);
+   do
+   {
+      c1 = getc(fp1);
+      c2 = getc(fp2);
+      if(c1 != c2)
+         return(FALSE);
+   }  while(c1 != EOF);
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*//**
+
+   Throughput comparison of writing a PDB linked list with fprintf() for
+   each record against blWritePDBAsPDBorGromos() which formats records
+   into a buffer. The outputs are checked to be identical. Time spent
+   finding TER cards is included in both.
+   Usage: writepdbbench file.pdb [repeats]
+
+-  18.10.26 Original
+*/
+int main(int argc, char **argv)
+{
+   FILE     *fp,
+            *fpLegacy,
+            *fpNew;
+   WHOLEPDB *wpdb;
+   clock_t  start;
+   double   tLegacy = 0.0,
+            tNew    = 0.0,
+            mbytes;
+   int      i, 
+            repeats = 5;
+
+   if(argc < 2)
+   {
+      fprintf(stderr,"Usage: writepdbbench file.pdb [repeats]\n");
+      return(1);
+   }
+   if(argc > 2)
+      repeats = atoi(argv[2]);
+
+   if((fp = fopen(argv[1], "r"))==NULL)
+   {
+      fprintf(stderr,"Unable to open %s\n", argv[1]);
+      return(1);
+   }
+   wpdb = blReadWholePDB(fp);
+   fclose(fp);
+   if((wpdb == NULL) || (wpdb->pdb == NULL))
+   {
+      fprintf(stderr,"No atoms read from %s\n", argv[1]);
+      return(1);
+   }
+
+   if(((fpLegacy = tmpfile())==NULL) || ((fpNew = tmpfile())==NULL))
+   {
+      fprintf(stderr,"Unable to open temporary files\n");
+      return(1);
+   }
+
+   for(i=0; i<repeats; i++)
+   {
+      rewind(fpLegacy);
+      start    = clock();
+      LegacyWritePDB(fpLegacy, wpdb->pdb);
+      fflush(fpLegacy);
+      tLegacy += (double)(clock() - start) / CLOCKS_PER_SEC;
+
+      rewind(fpNew);
+      start    = clock();
+      blWritePDBAsPDBorGromos(fpNew, wpdb->pdb, FALSE);
+      fflush(fpNew);
+      tNew    += (double)(clock() - start) / CLOCKS_PER_SEC;
+   }
+   mbytes = (double)ftell(fpNew) / (1024.0 * 1024.0);
+
+   printf("File: %s (%d atoms, %.1f MB written, %d repeats)\n", 
+          argv[1], wpdb->natoms, mbytes, repeats);
+   printf("fprintf()          : %8.3fs %8.1f MB/s\n",
+          tLegacy/repeats, mbytes*repeats/tLegacy);
+   printf("Buffered formatter : %8.3fs %8.1f MB/s\n",
+          tNew/repeats, mbytes*repeats/tNew);
+   printf("Speedup            : %8.2fx\n", tLegacy/tNew);
+   printf("Output identical   : %s\n", 
+          SameContents(fpLegacy, fpNew) ? "yes" : "NO");
+
+   fclose(fpLegacy);
+   fclose(fpNew);
+   blFreeWholePDB(wpdb);
+
+   return(0);
+}
+#endif
@@ -3,11 +3,11 @@
 
    \file       access.c
    
-   \version    V1.2
-   \date       17.06.15
+   \version    V1.7
+   \date       18.10.26
    \brief      Accessibility calculation code
    
-   \copyright  (c) UCL, Dr. Andrew C.R. Martin, 1999-2015
+   \copyright  (c) UCL, Dr. Andrew C.R. Martin, 1999-2026
    \author     Dr. Andrew C.R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -39,6 +39,43 @@
    Calculation of solvent accessibility by the method of Lee and Richards.
    Based loosely on PMCL code by Peter McLaughlin
 
+   Once the atoms have been sorted into cubes, the area of each atom is
+   calculated independently of the others. blCalcAccessThreaded()
+   shares the atoms between a pool of threads, each with its own
+   intersection and arc arrays, and gives exactly the same areas as
+   blCalcAccess(). If NOTHREADS or MS_WINDOWS is defined, the atoms are
+   always done in turn. Otherwise code must be linked with -lpthread.
+
+   blCalcAccessMethod() can instead use the method of Shrake and Rupley,
+   which is faster but less accurate. A fixed set of points is spread
+   over the sphere of each atom (on a golden-section spiral) and the
+   area is the fraction of points not inside a neighbouring sphere.
+   The neighbours come from the same cubes as the Lee and Richards
+   method. Their coordinates are copied into separate x, y and z
+   arrays and are tested against each point in blocks without
+   branches, so the compiler can vectorise the tests. Compile with
+   -DBENCHMARK for a program that compares the speed and results of
+   the two methods.
+
+   When only a few atoms of a structure change, as when a side chain is
+   replaced with blRepOneSChain() or rotated with blSetChi(), most of
+   the areas do not. An ACCESSCONTEXT keeps the atoms, their cubes and
+   their areas between calls. blUpdateAccessContext() is given the
+   range of the linked list that has changed (atoms may have moved,
+   been added or been removed). Only those atoms and the atoms which
+   touched them before or touch them now are recalculated. These are
+   found in the cubes around each changed atom, whose edge is
+   2*(rmax+probe). Atoms outside the range which have moved are found
+   by comparing their coordinates with the stored ones.
+
+   Each calculation needs arrays for the atoms, the cubes and the
+   neighbours and arcs of each thread. blCalcAccessWorkspace() takes
+   these from an ACCESSWORKSPACE, which keeps them between calls and
+   only ever makes them larger. Code which calculates the areas of
+   many structures (or of chains and interfaces one at a time) can use
+   one workspace for all of them and so allocate very little after the
+   first call. The other routines use a temporary workspace.
+
 **************************************************************************
 
    Usage:
@@ -58,6 +95,70 @@
       Does the accessibilty calculations. integrationAccuracy can be set
       to zero to use the default value
 
+\code
+   BOOL blCalcAccessThreaded(PDB *pdb, int natoms, 
+                             REAL integrationAccuracy, REAL probeRadius,
+                             BOOL doAccessibility, int nthreads)
+\endcode
+      As blCalcAccess(), but uses nthreads threads
+
+\code
+   BOOL blCalcAccessMethod(PDB *pdb, int natoms, int method,
+                           REAL integrationAccuracy, int nPoints,
+                           REAL probeRadius, BOOL doAccessibility,
+                           int nthreads)
+\endcode
+      As blCalcAccessThreaded(), but method may be ACCESS_LEE_RICHARDS
+      or ACCESS_SHRAKE_RUPLEY. nPoints is the number of points on each
+      sphere for ACCESS_SHRAKE_RUPLEY (0 for the default)
+
+\code
+   ACCESSCONTEXT *blInitAccessContext(PDB *pdb, int method,
+                                      REAL integrationAccuracy,
+                                      int nPoints, REAL probeRadius,
+                                      BOOL doAccessibility, int nthreads)
+\endcode
+      As blCalcAccessMethod(), but keeps the data needed to update the
+      areas after part of the structure has changed
+
+\code
+   BOOL blUpdateAccessContext(ACCESSCONTEXT *context, PDB *pdb,
+                              PDB *start, PDB *stop)
+\endcode
+      Updates the areas after the atoms from start up to (but not
+      including) stop have changed
+
+\code
+   void blFreeAccessContext(ACCESSCONTEXT *context)
+\endcode
+      Frees the context
+
+\code
+   BOOL blCalcAccessWorkspace(PDB *pdb, int natoms, int method,
+                              REAL integrationAccuracy, int nPoints,
+                              REAL probeRadius, BOOL doAccessibility,
+                              int nthreads, ACCESSWORKSPACE *workspace)
+\endcode
+      As blCalcAccessMethod(), but takes its arrays from a workspace
+      which may be used again
+
+\code
+   ACCESSWORKSPACE *blAllocAccessWorkspace(void)
+   void blFreeAccessWorkspace(ACCESSWORKSPACE *workspace)
+\endcode
+      Allocate and free a workspace
+
+   e.g.
+\code
+   context = blInitAccessContext(pdb, ACCESS_LEE_RICHARDS, 0.0, 0,
+                                 1.4, TRUE, 1);
+   ...
+   blSetChi(res, nextRes, chi, 0);
+   blUpdateAccessContext(context, pdb, res, nextRes);
+   ...
+   blFreeAccessContext(context);
+\endcode
+
 \code
    RESACCESS *blCalcResAccess(PDB *pdb, RESRAD *resrad)
 \endcode
@@ -70,6 +171,21 @@
 -  V1.0  21.04.99 Original   By: ACRM
 -  V1.1  17.07.14 Extracted from XMAS code
 -  V1.2  17.06.15 Added sidechain residues access
+-  V1.3  18.10.26 Added blCalcAccessThreaded(). doCalcAccess() uses
+                  separate intersection arrays for each thread and
+                  only clears the part of arci[] that has been used
+-  V1.4  18.10.26 Added blCalcAccessMethod() and the Shrake and Rupley
+                  method. Added a benchmark (compile with -DBENCHMARK)
+-  V1.5  18.10.26 Added ACCESSCONTEXT, blInitAccessContext(),
+                  blUpdateAccessContext() and blFreeAccessContext().
+                  The cubes are built by BuildAccessCubes() and the
+                  threads run by RunAccessJob()
+-  V1.6  18.10.26 Added ACCESSWORKSPACE, blCalcAccessWorkspace(),
+                  blAllocAccessWorkspace() and blFreeAccessWorkspace().
+                  doCalcAccess() and FillArrays() are replaced by
+                  blCalcAccessWorkspace(). Threads take their buffers
+                  from the workspace
+-  V1.7  18.10.26 Removed MAX_INTERSECT_EXP, which is no longer used
 
 *************************************************************************/
 /* Doxygen
@@ -85,6 +201,34 @@
    Allocates arrays and calls routines to populate them, do the access
    calculations and populate into the PDB linked list
 
+   #FUNCTION  blCalcAccessThreaded()
+   As blCalcAccess() but shares the atoms between several threads
+
+   #FUNCTION  blCalcAccessMethod()
+   As blCalcAccessThreaded() but the Shrake and Rupley method may be
+   used instead of Lee and Richards
+
+   #FUNCTION  blInitAccessContext()
+   Calculates accessibility and keeps the data needed to update it
+   after part of the structure has changed
+
+   #FUNCTION  blUpdateAccessContext()
+   Recalculates the areas of atoms affected by a change to part of the
+   structure
+
+   #FUNCTION  blFreeAccessContext()
+   Frees an ACCESSCONTEXT
+
+   #FUNCTION  blCalcAccessWorkspace()
+   As blCalcAccessMethod() but the arrays are kept in a workspace that
+   may be used for other calculations
+
+   #FUNCTION  blAllocAccessWorkspace()
+   Allocates an ACCESSWORKSPACE
+
+   #FUNCTION  blFreeAccessWorkspace()
+   Frees an ACCESSWORKSPACE
+
    #FUNCTION  blCalcResAccess()
    Calculates and populates the residue totals and relative values
    using standards stored in resrad
@@ -92,10 +236,26 @@
 /************************************************************************/
 /* Includes
 */
+#if defined(MS_WINDOWS) && !defined(NOTHREADS)
+#  define NOTHREADS
+#endif
+
+#ifndef NOTHREADS
+#  if !defined(_POSIX_C_SOURCE) || (_POSIX_C_SOURCE < 200112L)
+#     undef  _POSIX_C_SOURCE
+#     define _POSIX_C_SOURCE 200112L  /* For pthreads                    */
+#  endif
+#endif
+#include "port.h"    /* Required before stdio.h                         */
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 
+#ifndef NOTHREADS
+#include <pthread.h>
+#endif
+
 #include "macros.h"
 #include "SysDefs.h"
 #include "pdb.h"
@@ -108,76 +268,123 @@
 #define MAX_INTERSECT    10000 /* Initial max no. of intersections of 
                                   neighbouring spheres - expands as
                                   required                              */
-#define MAX_INTERSECT_EXP  100 /* Amount to expand intersect array by   */
 #define MAX_ATOM_IN_CUBE   100 /* Initial max no. of atoms in a cube -
                                   expands as required                   */
 
-#define FREE_ACCESS_STORAGE                                              \
-do {                                                                     \
-   if(cube)         free(cube);                                          \
-   if(radii)        free(radii);                                         \
-   if(radiiSquared) free(radiiSquared);                                  \
-   if(neighbours)   free(neighbours);                                    \
-   if(flag)         free(flag);                                          \
-   if(arci)         free(arci);                                          \
-   if(arcf)         free(arcf);                                          \
-   if(deltaX)       free(deltaX);                                        \
-   if(deltaY)       free(deltaY);                                        \
-   if(dist)         free(dist);                                          \
-   if(distSquared)  free(distSquared);                                   \
-   if(atomTable)    free(atomTable);                                     \
-   if(atomsInCube)  {                                                    \
-      for(i=0;i<=maxAtomInCube;i++)                                      \
-      {  if(atomsInCube[i]) free(atomsInCube[i]);                        \
-         else        break;                                              \
-      }                                                                  \
-      free(atomsInCube);                                                 \
-   }                                                                     \
-}  while(0);
-
-
-#define EXPAND_INTERSECT_ARRAYS                                          \
-do {  int newMaxIntersect = (maxIntersect+MAX_INTERSECT_EXP),            \
-          iexpand;                                                       \
-   neighbours = (int  *)realloc(neighbours,                              \
-                                (newMaxIntersect+1)*sizeof(int));        \
-   flag = (int  *)realloc(flag, (newMaxIntersect+1)*sizeof(int));        \
-   arci = (REAL *)realloc(arci, (newMaxIntersect+1)*sizeof(REAL));       \
-   arcf = (REAL *)realloc(arcf, (newMaxIntersect+1)*sizeof(REAL));       \
-   deltaX = (REAL *)realloc(deltaX, (newMaxIntersect+1)*sizeof(REAL));   \
-   deltaY = (REAL *)realloc(deltaY, (newMaxIntersect+1)*sizeof(REAL));   \
-   dist   = (REAL *)realloc(dist,   (newMaxIntersect+1)*sizeof(REAL));   \
-   distSquared = (REAL *)realloc(distSquared,                            \
-                                 (newMaxIntersect+1)*sizeof(REAL));      \
-   if(neighbours==NULL || flag==NULL   || arci==NULL || arcf==NULL ||    \
-      deltaX==NULL     || deltaY==NULL || dist==NULL ||                  \
-      distSquared==NULL)                                                 \
-   {  FREE_ACCESS_STORAGE;                                               \
-      return(FALSE);                                                     \
-   }                                                                     \
-   for(iexpand=maxIntersect+1; iexpand<=newMaxIntersect; iexpand++)      \
-   {  neighbours[iexpand]  = 0;                                          \
-      flag[iexpand]        = 0;                                          \
-      arci[iexpand]        = 0.0;                                        \
-      arcf[iexpand]        = 0.0;                                        \
-      deltaX[iexpand]      = 0.0;                                        \
-      deltaY[iexpand]      = 0.0;                                        \
-      dist[iexpand]        = 0.0;                                        \
-      distSquared[iexpand] = 0.0;                                        \
-   }                                                                     \
-   maxIntersect = newMaxIntersect;                                       \
-} while(0)
-   
+#define ACCESS_CHUNK        32 /* Atoms given to a thread at a time    */
+#define ACCESS_SR_BLOCK      8 /* Neighbours tested against a point
+                                  before checking for a hit             */
+
+/* The neighbour, intersection and arc arrays used by one thread.
+   deltaZ and neighbourRadSq are only used by Shrake and Rupley. Arrays
+   count from 1
+*/
+typedef struct
+{
+   REAL *arci, *arcf,
+        *deltaX, *deltaY, *deltaZ,
+        *dist, *distSquared,
+        *neighbourRadSq;
+   int  *neighbours,
+        *flag,
+        maxIntersect,
+        arciUsed;             /* Entries of arci[] that may be non-zero */
+}  ACCESSBUFFERS;
+
+/* The atoms sorted into cubes and the other data shared by the threads
+   of a calculation. Arrays count from 1
+*/
+typedef struct
+{
+   REAL *x, *y, *z,
+        *radii,
+        *radiiSquared,
+        *accessResults,
+        *pointX,              /* Points on a unit sphere (Shrake and    */
+        *pointY,              /* Rupley only). Count from 0             */
+        *pointZ,
+        integrationAccuracy,
+        probeRadius;
+   int  *cube,
+        *atomTable,
+        **atomsInCube,
+        *todo,                /* Atoms to calculate, or NULL for all    */
+        numAtoms,
+        nTodo,                /* Size of todo[], or numAtoms            */
+        method,
+        nPoints,
+        idim, jidim, kjidim,
+        nextAtom,             /* Next atom to be given to a thread      */
+        nextBuffers;          /* Next buffers to be given to a thread   */
+   ACCESSBUFFERS *buffers;    /* Buffers for each thread. From 0        */
+   BOOL access,
+        ok;                   /* Cleared if a thread runs out of memory */
+#ifndef NOTHREADS
+   pthread_mutex_t lock;
+#endif
+}  ACCESSJOB;
+
+/* Arrays kept between calculations. They are only ever made larger.
+   The atom and cube arrays count from 1
+*/
+struct _accessworkspace
+{
+   REAL          *x, *y, *z,
+                 *radii,
+                 *radiiSquared,
+                 *accessResults,
+                 *points;     /* nPoints points on a unit sphere        */
+   int           *cube,
+                 *atomTable,
+                 **atomsInCube,
+                 maxAtoms,    /* Atoms the atom arrays will hold        */
+                 maxCubes,    /* Cubes atomTable[] etc. will hold       */
+                 maxAtomInCube, /* Last row of atomsInCube[]            */
+                 nPoints,
+                 nBuffers;
+   ACCESSBUFFERS *buffers;    /* One for each thread. From 0            */
+};
+
+/* Kept by blInitAccessContext() for blUpdateAccessContext(). The atom
+   arrays in job belong to the context. The cubes are in the workspace
+*/
+struct _accesscontext
+{
+   ACCESSJOB       job;
+   ACCESSWORKSPACE *workspace;
+   PDB             **atoms;   /* The atoms in list order. From 1        */
+   int             nthreads;
+   BOOL            valid;     /* Cleared if an update failed            */
+};
+
 /************************************************************************/
 /* Prototypes
 */
 static void SortArcEndpoints(REAL *a, int n, int *flag);
-static BOOL doCalcAccess(int numAtoms, REAL integrationAccuracy, 
-                         REAL probeRadius, BOOL access,
-                         REAL *AtomRadius,
-                         REAL *x, REAL *y, REAL *z,
-                         REAL *accessResults);
-static void FillArrays(PDB *pdb, REAL *x, REAL *y, REAL *z, REAL *r);
+static BOOL GrowAccessAtoms(ACCESSWORKSPACE *workspace, int natoms);
+static BOOL SetAccessPoints(ACCESSWORKSPACE *workspace, int nPoints);
+static BOOL GrowAccessCubes(ACCESSWORKSPACE *workspace, int nCubes,
+                            int nRows);
+static void FreeAccessCubes(ACCESSWORKSPACE *workspace);
+static int  GetAccessBuffers(ACCESSWORKSPACE *workspace, int nBuffers);
+static BOOL BuildAccessCubes(ACCESSJOB *job, ACCESSWORKSPACE *workspace);
+static BOOL RunAccessJob(ACCESSJOB *job, ACCESSWORKSPACE *workspace,
+                         int nthreads);
+static void *AccessWorker(void *arg);
+static int  FindTouchingAtoms(ACCESSJOB *job, ACCESSBUFFERS *buffers,
+                              int keyAtom);
+static BOOL LoadContextAtoms(ACCESSJOB *job, PDB ***atoms, PDB *pdb);
+static void FreeContextAtoms(ACCESSJOB *job, PDB **atoms);
+static int  FindCubeNeighbours(ACCESSJOB *job, ACCESSBUFFERS *buffers,
+                               int keyAtom);
+static BOOL CalcAtomAccess(ACCESSJOB *job, ACCESSBUFFERS *buffers,
+                           int keyAtom);
+static BOOL CalcAtomAccessSR(ACCESSJOB *job, ACCESSBUFFERS *buffers,
+                             int keyAtom);
+static void SpherePoints(int nPoints, REAL *x, REAL *y, REAL *z);
+static BOOL AllocAccessBuffers(ACCESSBUFFERS *buffers);
+static BOOL ExpandAccessBuffers(ACCESSBUFFERS *buffers);
+static void FreeAccessBuffers(ACCESSBUFFERS *buffers);
 static RESRAD *GetResidueRadii(RESRAD *resrad, char *resnam);
 static RESRAD *ReadRadiusFile(FILE *fpRad);
 static REAL GetStandardAccess(char *resnam, RESRAD *resrad);
@@ -327,265 +534,903 @@ RESRAD *blSetAtomRadii(PDB *pdb, FILE *fpRad)
    calculations and populate into the PDB linked list
 
 -  22.04.99 Original   By: ACRM
+-  18.10.26 Calls blCalcAccessThreaded() with one thread
 */
 BOOL blCalcAccess(PDB *pdb, int natoms, 
                   REAL integrationAccuracy, REAL probeRadius,
                   BOOL doAccessibility)
 {
-   REAL *x = NULL, 
-        *y = NULL, 
-        *z = NULL, 
-        *radii = NULL, 
-        *accessArray = NULL;
-   BOOL retval = FALSE;
-
-   if(integrationAccuracy < VERY_SMALL)
-      integrationAccuracy = ACCESS_DEF_INTACC;
-   
-   /* Allocate arrays                                                   */
-   if((x=(REAL *)malloc(natoms * sizeof(REAL)))!=NULL)
-   {
-      if((y=(REAL *)malloc(natoms * sizeof(REAL)))!=NULL)
-      {
-         if((z=(REAL *)malloc(natoms * sizeof(REAL)))!=NULL)
-         {
-            if((radii=(REAL *)malloc(natoms * sizeof(REAL)))!=NULL)
-            {
-               if((accessArray=(REAL *)malloc(natoms * sizeof(REAL)))
-                  !=NULL)
-               {
-                  retval = TRUE;
-                  
-                  /* Populate arrays from PDB structure, do the 
-                     accessibility run and put the results back into the 
-                     PDB structure
-                  */
-                  FillArrays(pdb, x, y, z, radii);
-                  doCalcAccess(natoms, integrationAccuracy, probeRadius, 
-                               doAccessibility,
-                               radii, x, y, z,
-                               accessArray);
-                  SetPDBAccess(pdb, accessArray);
-               }
-            }
-         }
-      }
-   }
-   
-   /* Free the allocated memory                                         */
-   if(x!=NULL)           free(x);
-   if(y!=NULL)           free(y);
-   if(z!=NULL)           free(z);
-   if(radii!=NULL)       free(radii);
-   if(accessArray!=NULL) free(accessArray);
-   
-   return(retval);
+   return(blCalcAccessThreaded(pdb, natoms, integrationAccuracy,
+                               probeRadius, doAccessibility, 1));
 }
 
 
-
 /************************************************************************/
-/*>static void FillArrays(PDB *pdb, REAL *x, REAL *y, REAL *z, REAL *r)
-   --------------------------------------------------------------------
+/*>BOOL blCalcAccessThreaded(PDB *pdb, int natoms, 
+                             REAL integrationAccuracy, 
+                             REAL probeRadius,
+                             BOOL doAccessibility, int nthreads)
+   --------------------------------------------------------------
 *//**
-   \param[in]   *pdb      PDB linked list
-   \param[out]  *x        X coordinate array
-   \param[out]  *y        Y coordinate array
-   \param[out]  *z        Z coordinate array
-   \param[out]  *r        radius array
+   \param[in,out]    *pdb                  PDB linked list
+   \param[in]        natoms                Number of atoms
+   \param[in]        integrationAccuracy   Integration accuracy
+   \param[in]        probeRadius           Probe radius
+   \param[in]        doAccessibility       Accessibility or contact area
+   \param[in]        nthreads              Number of threads to use
+   \return                                 Success
 
-   Fills the coordinate and atom arrays from the PDB linked list
+   As blCalcAccess(), but the atoms are shared between nthreads
+   threads (including the calling thread). The areas are exactly the
+   same as those from blCalcAccess(). With NOTHREADS, nthreads is
+   ignored.
 
--  22.04.99 Original   By: ACRM
+-  18.10.26 Original
+-  18.10.26 Calls blCalcAccessMethod()
 */
-static void FillArrays(PDB *pdb, REAL *x, REAL *y, REAL *z, REAL *r)
+BOOL blCalcAccessThreaded(PDB *pdb, int natoms, 
+                          REAL integrationAccuracy, REAL probeRadius,
+                          BOOL doAccessibility, int nthreads)
 {
-   PDB *p;
-   int  count = 0;
-   
-
-   for(p=pdb; p!=NULL; NEXT(p))
-   {
-      x[count] = p->x;
-      y[count] = p->y;
-      z[count] = p->z;
-      r[count] = p->radius;
-      
-      count++;
-   }
+   return(blCalcAccessMethod(pdb, natoms, ACCESS_LEE_RICHARDS,
+                             integrationAccuracy, 0, probeRadius,
+                             doAccessibility, nthreads));
 }
 
 
 /************************************************************************/
-/*>static RESRAD *GetResidueRadii(RESRAD *resrad, char *resnam)
+/*>BOOL blCalcAccessMethod(PDB *pdb, int natoms, int method,
+                           REAL integrationAccuracy, int nPoints,
+                           REAL probeRadius, BOOL doAccessibility,
+                           int nthreads)
    --------------------------------------------------------------
 *//**
-   \param[in]   *resrad    Linked list of atom radii information
-   \param[in]   *resnam    Residue name we are looking for
-   \return                 Pointer to information on this residue
-                           (or NULL)
+   \param[in,out]    *pdb                  PDB linked list
+   \param[in]        natoms                Number of atoms
+   \param[in]        method                ACCESS_LEE_RICHARDS or
+                                           ACCESS_SHRAKE_RUPLEY
+   \param[in]        integrationAccuracy   Integration accuracy (Lee
+                                           and Richards). 0 for default
+   \param[in]        nPoints               Points on each sphere
+                                           (Shrake and Rupley). 0 for
+                                           default
+   \param[in]        probeRadius           Probe radius
+   \param[in]        doAccessibility       Accessibility or contact area
+   \param[in]        nthreads              Number of threads to use
+   \return                                 Success
 
-   Gets the radius information for the specified residue.
+   Calculates accessibility by the method of Lee and Richards (as
+   blCalcAccessThreaded()) or the method of Shrake and Rupley. For
+   Shrake and Rupley, the error in the area of an atom is roughly the
+   area of its sphere divided by nPoints.
 
--  22.04.99 Original   By: ACRM
+-  18.10.26 Original
+-  18.10.26 Calls blCalcAccessWorkspace()
 */
-static RESRAD *GetResidueRadii(RESRAD *resrad, char *resnam)
+BOOL blCalcAccessMethod(PDB *pdb, int natoms, int method,
+                        REAL integrationAccuracy, int nPoints,
+                        REAL probeRadius, BOOL doAccessibility,
+                        int nthreads)
 {
-   RESRAD *r;
-
-   /* Search through the residue types to find this residue             */
-   for(r=resrad; r!=NULL; NEXT(r))
-   {
-      if(!strncmp(r->resnam, resnam, 3))
-      {
-         return(r);
-         break;
-      }
-   }
-
-   return(NULL);
+   return(blCalcAccessWorkspace(pdb, natoms, method, integrationAccuracy,
+                                nPoints, probeRadius, doAccessibility,
+                                nthreads, NULL));
 }
 
+
 /************************************************************************/
-/*>static RESRAD *ReadRadiusFile(FILE *fpRad)
-   -----------------------------------------
+/*>BOOL blCalcAccessWorkspace(PDB *pdb, int natoms, int method,
+                              REAL integrationAccuracy, int nPoints,
+                              REAL probeRadius, BOOL doAccessibility,
+                              int nthreads, ACCESSWORKSPACE *workspace)
+   --------------------------------------------------------------------
 *//**
-   \param[in]   *fpRad    Atom radius file pointer
-   \return                Linked list of residue and atom radius
-                          information
+   \param[in,out]    *pdb                  PDB linked list
+   \param[in]        natoms                Number of atoms
+   \param[in]        method                ACCESS_LEE_RICHARDS or
+                                           ACCESS_SHRAKE_RUPLEY
+   \param[in]        integrationAccuracy   Integration accuracy (Lee
+                                           and Richards). 0 for default
+   \param[in]        nPoints               Points on each sphere
+                                           (Shrake and Rupley). 0 for
+                                           default
+   \param[in]        probeRadius           Probe radius
+   \param[in]        doAccessibility       Accessibility or contact area
+   \param[in]        nthreads              Number of threads to use
+   \param[in,out]    *workspace            Workspace from
+                                           blAllocAccessWorkspace(), or
+                                           NULL to use a temporary one
+   \return                                 Success
 
-   Reads the specified file into the linked list of atom radii for each
-   residue type. The file also contains standard residue accessibility.
+   As blCalcAccessMethod(), but the arrays are taken from a workspace
+   which is made larger as required and may be used again for other
+   calculations and structures. The areas are the same as those from
+   blCalcAccessMethod().
 
 -  22.04.99 Original   By: ACRM
--  16.06.99 Initialise atomIndex to 0 and r to NULL
--  16.07.14 Changed to passing in file pointer
--  17.06.15 Reads stdAccessSc
+-  18.10.26 Moved from blCalcAccess() and added nthreads. Returns
+            FALSE if doCalcAccess() fails
+-  18.10.26 Added method and nPoints
+-  18.10.26 Moved from blCalcAccessMethod() and added workspace. The
+            arrays are filled here rather than by FillArrays() and
+            doCalcAccess(). Only the atoms in the list are used if
+            natoms is larger
 */
-static RESRAD *ReadRadiusFile(FILE *fpRad)
+BOOL blCalcAccessWorkspace(PDB *pdb, int natoms, int method,
+                           REAL integrationAccuracy, int nPoints,
+                           REAL probeRadius, BOOL doAccessibility,
+                           int nthreads, ACCESSWORKSPACE *workspace)
 {
-   char   buffer[MAXBUFF],
-          *chp,
-          junk[8];
-   RESRAD *resrad = NULL, 
-          *r = NULL;
-   int    atomCount = 0,
-          atomIndex = 0;
+   ACCESSWORKSPACE *tmpWorkspace = NULL;
+   ACCESSJOB       job;
+   PDB             *p;
+   int             i;
+   BOOL            retval = FALSE;
 
-   while(fgets(buffer,MAXBUFF,fpRad))
-   {
-      if((chp=strchr(buffer,'#'))!=NULL)  /* Strip comments             */
-         *chp = '\0';
+   if(integrationAccuracy < VERY_SMALL)
+      integrationAccuracy = ACCESS_DEF_INTACC;
+   if(nPoints < 1)
+      nPoints = ACCESS_DEF_NPOINTS;
+   if((method != ACCESS_LEE_RICHARDS) && (method != ACCESS_SHRAKE_RUPLEY))
+      return(FALSE);
 
-      KILLLEADSPACES(chp, buffer);
-      if(!strlen(chp))                    /* Skip blank lines           */
-         continue;
+   if(workspace == NULL)
+   {
+      if((tmpWorkspace = blAllocAccessWorkspace())==NULL)
+         return(FALSE);
+      workspace = tmpWorkspace;
+   }
 
-      /* Beginning of a new residue                                     */
-      if(!atomCount)
+   if(GrowAccessAtoms(workspace, natoms) &&
+      ((method != ACCESS_SHRAKE_RUPLEY) ||
+       SetAccessPoints(workspace, nPoints)))
+   {
+      /* Populate arrays from PDB structure (counting from 1)           */
+      for(p=pdb, i=1; (p!=NULL) && (i<=natoms); NEXT(p), i++)
       {
-         if(resrad==NULL)
-         {
-            INIT(resrad, RESRAD);
-            r = resrad;
-         }
-         else
-         {
-            ALLOCNEXT(r, RESRAD);
-         }
-         if(r==NULL)
-         {
-            FREELIST(resrad, RESRAD);
-            return(NULL);
-         }
-         
-         sscanf(buffer,"%s %d %lf %lf", 
-                r->resnam, &(r->natoms), 
-                &(r->stdAccess), &(r->stdAccessSC));
-         atomCount = r->natoms;
-         atomIndex = 0;
+         workspace->x[i]             = p->x;
+         workspace->y[i]             = p->y;
+         workspace->z[i]             = p->z;
+         workspace->radii[i]         = p->radius + probeRadius;
+         workspace->radiiSquared[i]  = workspace->radii[i] *
+                                       workspace->radii[i];
+         workspace->accessResults[i] = 0.0;
       }
-      else
+
+      /* blReadPDB() may count atoms it then discards, so natoms can be
+         more than the list holds. The rest of the arrays would be left
+         over from an earlier call
+      */
+      natoms = i - 1;
+
+      job.x                   = workspace->x;
+      job.y                   = workspace->y;
+      job.z                   = workspace->z;
+      job.radii               = workspace->radii;
+      job.radiiSquared        = workspace->radiiSquared;
+      job.accessResults       = workspace->accessResults;
+      job.pointX              = workspace->points;
+      job.pointY              = workspace->points + workspace->nPoints;
+      job.pointZ              = workspace->points + 2*workspace->nPoints;
+      job.integrationAccuracy = integrationAccuracy;
+      job.probeRadius         = probeRadius;
+      job.cube                = workspace->cube;
+      job.todo                = NULL;
+      job.numAtoms            = natoms;
+      job.nTodo               = natoms;
+      job.method              = method;
+      job.nPoints             = nPoints;
+      job.access              = doAccessibility;
+
+      /* Sort the atoms into cubes, do the accessibility run and put
+         the results back into the PDB structure
+      */
+      if(BuildAccessCubes(&job, workspace) &&
+         RunAccessJob(&job, workspace, nthreads))
       {
-         strncpy(r->atnam[atomIndex],buffer,5);
-         r->atnam[atomIndex][5] = '\0';
-#ifdef NO_LEAD_SPACE
-         if(r->atnam[atomIndex][0] == ' ')
-         {
-            for(i=0; i<4; i++)
-               r->atnam[atomIndex][i] = r->atnam[atomIndex][i+1];
-         }
-#endif
-         /* Replace dots with spaces                                    */
-         DEDOTIFY(r->atnam[atomIndex]);
-         
-         sscanf(buffer,"%s %lf",junk,&(r->radius[atomIndex]));
-         atomIndex++;
-         atomCount--;
+         SetPDBAccess(pdb, workspace->accessResults+1);
+         retval = TRUE;
       }
    }
-   
-   return(resrad);
+
+   if(tmpWorkspace != NULL)
+      blFreeAccessWorkspace(tmpWorkspace);
+
+   return(retval);
 }
 
 
 /************************************************************************/
-/*>static REAL GetStandardAccess(char *resnam, RESRAD *resrad)
-   ------------------------------------------------------------
+/*>ACCESSWORKSPACE *blAllocAccessWorkspace(void)
+   ---------------------------------------------
 *//**
-   \param[in]   *resnam  Residue name
-   \param[in]   *resrad  Residue/atom radii and standard 
-                         accessibilities
-   \return               Standard accessibility for this residue
+   \return         Empty workspace. NULL if no memory
 
-   Gets the standard accessibility for the specified residue type
+   Allocates a workspace for blCalcAccessWorkspace(). Its arrays are
+   allocated when it is first used and are made larger when needed for
+   a larger structure, but never smaller, so a loop over many
+   structures or parts of a structure allocates little after the first
+   call. A workspace must only be used by one calculation at a time.
+   Free with blFreeAccessWorkspace().
 
--  22.04.99 Original   By: ACRM
+-  18.10.26 Original
 */
-static REAL GetStandardAccess(char *resnam, RESRAD *resrad)
+ACCESSWORKSPACE *blAllocAccessWorkspace(void)
 {
-   RESRAD *r;
-   
-   /* Search through the residue types to find this residue             */
-   for(r=resrad; r!=NULL; NEXT(r))
-   {
-      if(!strncmp(r->resnam, resnam, 3))
-      {
-         return(r->stdAccess);
-      }
-   }
+   ACCESSWORKSPACE *workspace;
 
-   return((REAL)0.0);
+   if((workspace = (ACCESSWORKSPACE *)malloc(sizeof(ACCESSWORKSPACE)))
+      ==NULL)
+      return(NULL);
+
+   workspace->x             = NULL;
+   workspace->y             = NULL;
+   workspace->z             = NULL;
+   workspace->radii         = NULL;
+   workspace->radiiSquared  = NULL;
+   workspace->accessResults = NULL;
+   workspace->points        = NULL;
+   workspace->cube          = NULL;
+   workspace->atomTable     = NULL;
+   workspace->atomsInCube   = NULL;
+   workspace->buffers       = NULL;
+   workspace->maxAtoms      = 0;
+   workspace->maxCubes      = 0;
+   workspace->maxAtomInCube = 0;
+   workspace->nPoints       = 0;
+   workspace->nBuffers      = 0;
+
+   return(workspace);
 }
 
+
 /************************************************************************/
-/*>static REAL GetStandardAccessSC(char *resnam, RESRAD *resrad)
-   --------------------------------------------------------------
+/*>void blFreeAccessWorkspace(ACCESSWORKSPACE *workspace)
+   ------------------------------------------------------
 *//**
-   \param[in]   *resnam  Residue name
-   \param[in]   *resrad  Residue/atom radii and standard 
-                         accessibilities
-   \return               Standard s/c accessibility for this residue
+   \param[in]     *workspace   Workspace (may be NULL)
 
-   Gets the standard sidechain accessibility for the specified residue
-   type
+   Frees a workspace and all its arrays
 
--  17.06.15 Original   By: ACRM
+-  18.10.26 Original
 */
-static REAL GetStandardAccessSC(char *resnam, RESRAD *resrad)
+void blFreeAccessWorkspace(ACCESSWORKSPACE *workspace)
 {
-   RESRAD *r;
-   
-   /* Search through the residue types to find this residue             */
-   for(r=resrad; r!=NULL; NEXT(r))
+   int i;
+
+   if(workspace == NULL)
+      return;
+
+   FREE(workspace->x);
+   FREE(workspace->y);
+   FREE(workspace->z);
+   FREE(workspace->radii);
+   FREE(workspace->radiiSquared);
+   FREE(workspace->accessResults);
+   FREE(workspace->points);
+   FREE(workspace->cube);
+   FreeAccessCubes(workspace);
+
+   for(i=0; i<workspace->nBuffers; i++)
+      FreeAccessBuffers(&(workspace->buffers[i]));
+   FREE(workspace->buffers);
+
+   free(workspace);
+}
+
+
+/************************************************************************/
+/*>ACCESSCONTEXT *blInitAccessContext(PDB *pdb, int method,
+                                      REAL integrationAccuracy,
+                                      int nPoints, REAL probeRadius,
+                                      BOOL doAccessibility, int nthreads)
+   ---------------------------------------------------------------------
+*//**
+   \param[in,out]    *pdb                  PDB linked list
+   \param[in]        method                ACCESS_LEE_RICHARDS or
+                                           ACCESS_SHRAKE_RUPLEY
+   \param[in]        integrationAccuracy   Integration accuracy (Lee
+                                           and Richards). 0 for default
+   \param[in]        nPoints               Points on each sphere
+                                           (Shrake and Rupley). 0 for
+                                           default
+   \param[in]        probeRadius           Probe radius
+   \param[in]        doAccessibility       Accessibility or contact area
+   \param[in]        nthreads              Number of threads to use
+   \return                                 Context for
+                                           blUpdateAccessContext(). NULL
+                                           on failure
+
+   Calculates the areas of the atoms as blCalcAccessMethod() does and
+   keeps the atoms, cubes and areas so that blUpdateAccessContext() can
+   recalculate only the areas that change when part of the structure
+   changes. Free with blFreeAccessContext().
+
+-  18.10.26 Original
+-  18.10.26 The cubes and points are kept in an ACCESSWORKSPACE
+*/
+ACCESSCONTEXT *blInitAccessContext(PDB *pdb, int method,
+                                   REAL integrationAccuracy, int nPoints,
+                                   REAL probeRadius, BOOL doAccessibility,
+                                   int nthreads)
+{
+   ACCESSCONTEXT *context;
+   ACCESSJOB     *job;
+
+   if(integrationAccuracy < VERY_SMALL)
+      integrationAccuracy = ACCESS_DEF_INTACC;
+   if(nPoints < 1)
+      nPoints = ACCESS_DEF_NPOINTS;
+   if((method != ACCESS_LEE_RICHARDS) && (method != ACCESS_SHRAKE_RUPLEY))
+      return(NULL);
+
+   if((context = (ACCESSCONTEXT *)malloc(sizeof(ACCESSCONTEXT)))==NULL)
+      return(NULL);
+
+   job                      = &(context->job);
+   job->x                   = NULL;
+   job->y                   = NULL;
+   job->z                   = NULL;
+   job->radii               = NULL;
+   job->radiiSquared        = NULL;
+   job->accessResults       = NULL;
+   job->cube                = NULL;
+   job->atomTable           = NULL;
+   job->atomsInCube         = NULL;
+   job->todo                = NULL;
+   job->integrationAccuracy = integrationAccuracy;
+   job->probeRadius         = probeRadius;
+   job->method              = method;
+   job->nPoints             = nPoints;
+   job->access              = doAccessibility;
+   context->atoms           = NULL;
+   context->nthreads        = nthreads;
+   context->valid           = FALSE;
+
+   /* The cubes, thread buffers and points on the unit sphere (for
+      Shrake and Rupley) are kept in a workspace
+   */
+   if(((context->workspace = blAllocAccessWorkspace())==NULL) ||
+      ((method == ACCESS_SHRAKE_RUPLEY) &&
+       !SetAccessPoints(context->workspace, nPoints)))
    {
-      if(!strncmp(r->resnam, resnam, 3))
+      blFreeAccessContext(context);
+      return(NULL);
+   }
+   job->pointX = context->workspace->points;
+   job->pointY = context->workspace->points + context->workspace->nPoints;
+   job->pointZ = context->workspace->points +
+                 2*context->workspace->nPoints;
+
+   /* Copy the atoms, sort them into cubes and find all the areas       */
+   if(LoadContextAtoms(job, &(context->atoms), pdb) &&
+      BuildAccessCubes(job, context->workspace))
+   {
+      job->nTodo = job->numAtoms;
+      if(RunAccessJob(job, context->workspace, nthreads))
       {
-         return(r->stdAccessSC);
+         SetPDBAccess(pdb, job->accessResults+1);
+         context->valid = TRUE;
+         return(context);
       }
    }
 
-   return((REAL)0.0);
+   blFreeAccessContext(context);
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>BOOL blUpdateAccessContext(ACCESSCONTEXT *context, PDB *pdb,
+                              PDB *start, PDB *stop)
+   -----------------------------------------------------------
+*//**
+   \param[in,out] *context   Context from blInitAccessContext()
+   \param[in,out] *pdb       PDB linked list
+   \param[in]     *start     First atom of the part that has changed.
+                             NULL for the start of the list
+   \param[in]     *stop      Atom after the part that has changed.
+                             NULL for the end of the list
+   \return                   Success. If FALSE, the areas in the list
+                             have not been updated
+
+   Updates the areas of the atoms after part of the linked list has
+   changed, for example with blSetChi() or blRepOneSChain(). Atoms from
+   start up to (but not including) stop may have moved, been added,
+   been removed or had their radius changed. The atoms outside that
+   range must be the same atoms, in the same order, as at the last
+   call; if they are not, all the areas are recalculated. Atoms outside
+   the range which have moved are found by comparing their coordinates
+   with the stored ones.
+
+   The areas are recalculated for the changed atoms and for the atoms
+   which touched a changed atom at the last call or touch one now.
+   These are found in the cubes around the changed atoms. Every area
+   in the list is set.
+
+-  18.10.26 Original
+-  18.10.26 The cubes and buffers are kept in the context's workspace
+*/
+BOOL blUpdateAccessContext(ACCESSCONTEXT *context, PDB *pdb,
+                           PDB *start, PDB *stop)
+{
+   ACCESSJOB       *job      = &(context->job),
+                   old;
+   ACCESSWORKSPACE *workspace = context->workspace;
+   ACCESSBUFFERS   *buffers   = NULL;
+   PDB             **oldAtoms = context->atoms,
+                   **atoms;
+   char            *mark      = NULL;   /* 2 if changed, 1 if touching*/
+   int             *todo      = NULL,
+                   nOld       = job->numAtoms,
+                   nNew, nPrefix, nSuffix, shift,
+                   i, j, o, n, nTouching;
+   BOOL            ok         = FALSE;
+
+   /* Copy the atoms into new arrays, keeping the old ones              */
+   old = *job;
+   if(!LoadContextAtoms(job, &(context->atoms), pdb))
+   {
+      *job           = old;
+      context->atoms = oldAtoms;
+      return(FALSE);
+   }
+   atoms = context->atoms;
+   nNew  = job->numAtoms;
+   shift = nNew - nOld;
+
+   /* Count the unchanged atoms before start and from stop onwards. If
+      start is not in the list, everything has changed
+   */
+   nPrefix = nSuffix = 0;
+   if(start != NULL)
+   {
+      for(nPrefix=0; nPrefix<nNew; nPrefix++)
+      {
+         if(atoms[nPrefix+1] == start)
+            break;
+      }
+      if(nPrefix == nNew)
+         nPrefix = 0;
+   }
+   if(stop != NULL)
+   {
+      for(i=nPrefix+1; i<=nNew; i++)
+      {
+         if(atoms[i] == stop)
+         {
+            nSuffix = nNew - i + 1;
+            break;
+         }
+      }
+   }
+
+   /* The unchanged atoms must be the ones we had before                */
+   if(!context->valid || (nPrefix + nSuffix > nOld))
+      nPrefix = nSuffix = 0;
+   for(i=1; i<=nPrefix; i++)
+   {
+      if(atoms[i] != oldAtoms[i])
+      {
+         nPrefix = nSuffix = 0;
+         break;
+      }
+   }
+   for(i=nNew-nSuffix+1; i<=nNew; i++)
+   {
+      if(atoms[i] != oldAtoms[i-shift])
+      {
+         nPrefix = nSuffix = 0;
+         break;
+      }
+   }
+
+   /* From here, the context is only valid if everything works          */
+   context->valid = FALSE;
+
+   if(((mark = (char *)calloc(nNew+1, sizeof(char)))==NULL) ||
+      ((todo = (int *)malloc((nNew+1)*sizeof(int)))==NULL))
+      goto Cleanup;
+
+   if(nPrefix + nSuffix == 0)
+   {
+      /* Everything has changed                                         */
+      for(i=1; i<=nNew; i++)
+         mark[i] = 1;
+   }
+   else
+   {
+      if(GetAccessBuffers(workspace, 1) < 1)
+         goto Cleanup;
+      buffers = &(workspace->buffers[0]);
+
+      /* Unchanged atoms keep their areas. Any that have moved or
+         changed radius are treated as changed
+      */
+      for(i=1; i<=nNew; i++)
+      {
+         if((i > nPrefix) && (i <= nNew-nSuffix))
+         {
+            mark[i] = 2;
+            continue;
+         }
+
+         o = (i <= nPrefix) ? i : i-shift;
+         job->accessResults[i] = old.accessResults[o];
+         if((job->x[i]     != old.x[o]) ||
+            (job->y[i]     != old.y[o]) ||
+            (job->z[i]     != old.z[o]) ||
+            (job->radii[i] != old.radii[o]))
+            mark[i] = 2;
+      }
+
+      /* Mark the unchanged atoms which touched a changed atom before   */
+      for(o=1; o<=nOld; o++)
+      {
+         if((o > nPrefix) && (o <= nOld-nSuffix))
+            i = 0;
+         else
+            i = (o <= nPrefix) ? o : o+shift;
+
+         if((i == 0) || (mark[i] == 2))
+         {
+            if((nTouching = FindTouchingAtoms(&old, buffers, o)) < 0)
+               goto Cleanup;
+            for(j=1; j<=nTouching; j++)
+            {
+               n = buffers->neighbours[j];
+               if(n > nOld-nSuffix)
+                  n += shift;
+               else if(n > nPrefix)
+                  continue;
+               if(mark[n] == 0)
+                  mark[n] = 1;
+            }
+         }
+      }
+   }
+
+   /* Sort the new atoms into cubes, replacing the old ones             */
+   if(!BuildAccessCubes(job, workspace))
+      goto Cleanup;
+
+   /* Mark the atoms which now touch a changed atom                     */
+   if(buffers != NULL)
+   {
+      for(i=1; i<=nNew; i++)
+      {
+         if(mark[i] == 2)
+         {
+            if((nTouching = FindTouchingAtoms(job, buffers, i)) < 0)
+               goto Cleanup;
+            for(j=1; j<=nTouching; j++)
+            {
+               n = buffers->neighbours[j];
+               if(mark[n] == 0)
+                  mark[n] = 1;
+            }
+         }
+      }
+   }
+
+   /* Recalculate the marked atoms                                      */
+   for(i=1, n=0; i<=nNew; i++)
+   {
+      if(mark[i])
+         todo[++n] = i;
+   }
+   job->todo  = todo;
+   job->nTodo = n;
+   ok         = RunAccessJob(job, workspace, context->nthreads);
+   job->todo  = NULL;
+
+   if(ok)
+   {
+      SetPDBAccess(pdb, job->accessResults+1);
+      context->valid = TRUE;
+   }
+
+Cleanup:
+   FreeContextAtoms(&old, oldAtoms);
+   if(mark != NULL) free(mark);
+   if(todo != NULL) free(todo);
+
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>void blFreeAccessContext(ACCESSCONTEXT *context)
+   ------------------------------------------------
+*//**
+   \param[in]     *context   Context from blInitAccessContext() (may
+                             be NULL)
+
+   Frees an ACCESSCONTEXT. The PDB linked list is not changed.
+
+-  18.10.26 Original
+-  18.10.26 Frees the workspace
+*/
+void blFreeAccessContext(ACCESSCONTEXT *context)
+{
+   if(context == NULL)
+      return;
+
+   FreeContextAtoms(&(context->job), context->atoms);
+   blFreeAccessWorkspace(context->workspace);
+   free(context);
+}
+
+
+/************************************************************************/
+/*>static BOOL LoadContextAtoms(ACCESSJOB *job, PDB ***atoms, PDB *pdb)
+   --------------------------------------------------------------------
+*//**
+   \param[in,out] *job     The atom arrays are allocated and filled in.
+                           job->probeRadius must be set
+   \param[out]    **atoms  Allocated array of the atoms
+   \param[in]     *pdb     PDB linked list
+   \return                 Success. If FALSE, job and atoms are
+                           unchanged
+
+   Allocates the atom arrays of a context (counting from 1) and fills
+   them from the linked list as blCalcAccessWorkspace() does.
+   The areas are set to zero. The arrays that were there are not freed.
+
+-  18.10.26 Original
+*/
+static BOOL LoadContextAtoms(ACCESSJOB *job, PDB ***atoms, PDB *pdb)
+{
+   ACCESSJOB newJob;
+   PDB       *p,
+             **newAtoms;
+   int       i,
+             numAtoms = 0;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+      numAtoms++;
+
+   newJob.x             = (REAL *)malloc((numAtoms+1)*sizeof(REAL));
+   newJob.y             = (REAL *)malloc((numAtoms+1)*sizeof(REAL));
+   newJob.z             = (REAL *)malloc((numAtoms+1)*sizeof(REAL));
+   newJob.radii         = (REAL *)malloc((numAtoms+1)*sizeof(REAL));
+   newJob.radiiSquared  = (REAL *)malloc((numAtoms+1)*sizeof(REAL));
+   newJob.accessResults = (REAL *)malloc((numAtoms+1)*sizeof(REAL));
+   newJob.cube          = (int  *)malloc((numAtoms+1)*sizeof(int));
+   newAtoms             = (PDB **)malloc((numAtoms+1)*sizeof(PDB *));
+
+   if(newJob.x             == NULL ||
+      newJob.y             == NULL ||
+      newJob.z             == NULL ||
+      newJob.radii         == NULL ||
+      newJob.radiiSquared  == NULL ||
+      newJob.accessResults == NULL ||
+      newJob.cube          == NULL ||
+      newAtoms             == NULL)
+   {
+      FreeContextAtoms(&newJob, newAtoms);
+      return(FALSE);
+   }
+
+   for(p=pdb, i=1; p!=NULL; NEXT(p), i++)
+   {
+      newAtoms[i]             = p;
+      newJob.x[i]             = p->x;
+      newJob.y[i]             = p->y;
+      newJob.z[i]             = p->z;
+      newJob.radii[i]         = p->radius + job->probeRadius;
+      newJob.radiiSquared[i]  = newJob.radii[i] * newJob.radii[i];
+      newJob.accessResults[i] = 0.0;
+   }
+
+   job->x             = newJob.x;
+   job->y             = newJob.y;
+   job->z             = newJob.z;
+   job->radii         = newJob.radii;
+   job->radiiSquared  = newJob.radiiSquared;
+   job->accessResults = newJob.accessResults;
+   job->cube          = newJob.cube;
+   job->numAtoms      = numAtoms;
+   *atoms             = newAtoms;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void FreeContextAtoms(ACCESSJOB *job, PDB **atoms)
+   ---------------------------------------------------------
+*//**
+   \param[in]     *job     The atom arrays to free
+   \param[in]     **atoms  Array of atoms to free
+
+   Frees the arrays allocated by LoadContextAtoms()
+
+-  18.10.26 Original
+*/
+static void FreeContextAtoms(ACCESSJOB *job, PDB **atoms)
+{
+   if(job->x             != NULL) free(job->x);
+   if(job->y             != NULL) free(job->y);
+   if(job->z             != NULL) free(job->z);
+   if(job->radii         != NULL) free(job->radii);
+   if(job->radiiSquared  != NULL) free(job->radiiSquared);
+   if(job->accessResults != NULL) free(job->accessResults);
+   if(job->cube          != NULL) free(job->cube);
+   if(atoms              != NULL) free(atoms);
+}
+
+
+/************************************************************************/
+/*>static RESRAD *GetResidueRadii(RESRAD *resrad, char *resnam)
+   --------------------------------------------------------------
+*//**
+   \param[in]   *resrad    Linked list of atom radii information
+   \param[in]   *resnam    Residue name we are looking for
+   \return                 Pointer to information on this residue
+                           (or NULL)
+
+   Gets the radius information for the specified residue.
+
+-  22.04.99 Original   By: ACRM
+*/
+static RESRAD *GetResidueRadii(RESRAD *resrad, char *resnam)
+{
+   RESRAD *r;
+
+   /* Search through the residue types to find this residue             */
+   for(r=resrad; r!=NULL; NEXT(r))
+   {
+      if(!strncmp(r->resnam, resnam, 3))
+      {
+         return(r);
+         break;
+      }
+   }
+
+   return(NULL);
+}
+
+/************************************************************************/
+/*>static RESRAD *ReadRadiusFile(FILE *fpRad)
+   -----------------------------------------
+*//**
+   \param[in]   *fpRad    Atom radius file pointer
+   \return                Linked list of residue and atom radius
+                          information
+
+   Reads the specified file into the linked list of atom radii for each
+   residue type. The file also contains standard residue accessibility.
+
+-  22.04.99 Original   By: ACRM
+-  16.06.99 Initialise atomIndex to 0 and r to NULL
+-  16.07.14 Changed to passing in file pointer
+-  17.06.15 Reads stdAccessSc
+*/
+static RESRAD *ReadRadiusFile(FILE *fpRad)
+{
+   char   buffer[MAXBUFF],
+          *chp,
+          junk[8];
+   RESRAD *resrad = NULL, 
+          *r = NULL;
+   int    atomCount = 0,
+          atomIndex = 0;
+
+   while(fgets(buffer,MAXBUFF,fpRad))
+   {
+      if((chp=strchr(buffer,'#'))!=NULL)  /* Strip comments             */
+         *chp = '\0';
+
+      KILLLEADSPACES(chp, buffer);
+      if(!strlen(chp))                    /* Skip blank lines           */
+         continue;
+
+      /* Beginning of a new residue                                     */
+      if(!atomCount)
+      {
+         if(resrad==NULL)
+         {
+            INIT(resrad, RESRAD);
+            r = resrad;
+         }
+         else
+         {
+            ALLOCNEXT(r, RESRAD);
+         }
+         if(r==NULL)
+         {
+            FREELIST(resrad, RESRAD);
+            return(NULL);
+         }
+         
+         sscanf(buffer,"%s %d %lf %lf", 
+                r->resnam, &(r->natoms), 
+                &(r->stdAccess), &(r->stdAccessSC));
+         atomCount = r->natoms;
+         atomIndex = 0;
+      }
+      else
+      {
+         strncpy(r->atnam[atomIndex],buffer,5);
+         r->atnam[atomIndex][5] = '\0';
+#ifdef NO_LEAD_SPACE
+         if(r->atnam[atomIndex][0] == ' ')
+         {
+            for(i=0; i<4; i++)
+               r->atnam[atomIndex][i] = r->atnam[atomIndex][i+1];
+         }
+#endif
+         /* Replace dots with spaces                                    */
+         DEDOTIFY(r->atnam[atomIndex]);
+         
+         sscanf(buffer,"%s %lf",junk,&(r->radius[atomIndex]));
+         atomIndex++;
+         atomCount--;
+      }
+   }
+   
+   return(resrad);
+}
+
+
+/************************************************************************/
+/*>static REAL GetStandardAccess(char *resnam, RESRAD *resrad)
+   ------------------------------------------------------------
+*//**
+   \param[in]   *resnam  Residue name
+   \param[in]   *resrad  Residue/atom radii and standard 
+                         accessibilities
+   \return               Standard accessibility for this residue
+
+   Gets the standard accessibility for the specified residue type
+
+-  22.04.99 Original   By: ACRM
+*/
+static REAL GetStandardAccess(char *resnam, RESRAD *resrad)
+{
+   RESRAD *r;
+   
+   /* Search through the residue types to find this residue             */
+   for(r=resrad; r!=NULL; NEXT(r))
+   {
+      if(!strncmp(r->resnam, resnam, 3))
+      {
+         return(r->stdAccess);
+      }
+   }
+
+   return((REAL)0.0);
+}
+
+/************************************************************************/
+/*>static REAL GetStandardAccessSC(char *resnam, RESRAD *resrad)
+   --------------------------------------------------------------
+*//**
+   \param[in]   *resnam  Residue name
+   \param[in]   *resrad  Residue/atom radii and standard 
+                         accessibilities
+   \return               Standard s/c accessibility for this residue
+
+   Gets the standard sidechain accessibility for the specified residue
+   type
+
+-  17.06.15 Original   By: ACRM
+*/
+static REAL GetStandardAccessSC(char *resnam, RESRAD *resrad)
+{
+   RESRAD *r;
+   
+   /* Search through the residue types to find this residue             */
+   for(r=resrad; r!=NULL; NEXT(r))
+   {
+      if(!strncmp(r->resnam, resnam, 3))
+      {
+         return(r->stdAccessSC);
+      }
+   }
+
+   return((REAL)0.0);
 }
 
 /************************************************************************/
@@ -841,191 +1686,357 @@ exit40:
          k++;
       }  while((k<=nEndpoints) && (endpoints[k] < tmpEndpointVal));
 
-      if(k<=l) goto jump30;
+      if(k<=l) goto jump30;
+
+      if((l-i) > (j-k))
+      {
+         il[m]=i;
+         iu[m]=l;
+         i=k;
+         m++;
+         
+         goto exit80;
+      }
+
+      il[m]=k;
+      iu[m]=j;
+      j=l;
+      m++;
+      
+      goto exit80;
+   }
+
+   do
+   {
+      m--;
+      if(m==0) return;
+      i=il[m];
+      j=iu[m];
+
+exit80:
+      if(j-i>=1) goto jump10;
+      if(i==1) goto jump5;
+
+      i--;
+
+jump90:
+      i++;
+   }  while(i==j);
+   
+   tmpEndpointVal=endpoints[i+1];
+   if(endpoints[i]<=tmpEndpointVal) goto jump90;
+   
+   tmpFlagVal=flag[i+1];
+   k=i;
+   
+   do
+   {
+      endpoints[k+1]=endpoints[k];
+      flag[k+1]=flag[k];
+      k--;
+   }  while(tmpEndpointVal < endpoints[k]);
+ 
+   endpoints[k+1]=tmpEndpointVal;
+   flag[k+1]=tmpFlagVal;
+   
+   goto jump90;
+}
+      
+
+/************************************************************************/
+/*>static BOOL GrowAccessAtoms(ACCESSWORKSPACE *workspace, int natoms)
+   -------------------------------------------------------------------
+*//**
+   \param[in,out] *workspace   Workspace
+   \param[in]     natoms       Number of atoms
+   \return                     Success. If FALSE, the atom arrays have
+                               been freed
+
+   Makes sure the atom arrays of a workspace will hold natoms atoms
+   (counting from 1). Their contents are not kept.
+
+-  18.10.26 Original
+*/
+static BOOL GrowAccessAtoms(ACCESSWORKSPACE *workspace, int natoms)
+{
+   int n = natoms + 1;
+
+   if(natoms <= workspace->maxAtoms)
+      return(TRUE);
+
+   FREE(workspace->x);
+   FREE(workspace->y);
+   FREE(workspace->z);
+   FREE(workspace->radii);
+   FREE(workspace->radiiSquared);
+   FREE(workspace->accessResults);
+   FREE(workspace->cube);
+   workspace->maxAtoms = 0;
+
+   workspace->x             = (REAL *)malloc(n*sizeof(REAL));
+   workspace->y             = (REAL *)malloc(n*sizeof(REAL));
+   workspace->z             = (REAL *)malloc(n*sizeof(REAL));
+   workspace->radii         = (REAL *)malloc(n*sizeof(REAL));
+   workspace->radiiSquared  = (REAL *)malloc(n*sizeof(REAL));
+   workspace->accessResults = (REAL *)malloc(n*sizeof(REAL));
+   workspace->cube          = (int  *)malloc(n*sizeof(int));
+
+   if(workspace->x             == NULL ||
+      workspace->y             == NULL ||
+      workspace->z             == NULL ||
+      workspace->radii         == NULL ||
+      workspace->radiiSquared  == NULL ||
+      workspace->accessResults == NULL ||
+      workspace->cube          == NULL)
+   {
+      FREE(workspace->x);
+      FREE(workspace->y);
+      FREE(workspace->z);
+      FREE(workspace->radii);
+      FREE(workspace->radiiSquared);
+      FREE(workspace->accessResults);
+      FREE(workspace->cube);
+      return(FALSE);
+   }
+
+   workspace->maxAtoms = natoms;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL SetAccessPoints(ACCESSWORKSPACE *workspace, int nPoints)
+   --------------------------------------------------------------------
+*//**
+   \param[in,out] *workspace   Workspace
+   \param[in]     nPoints      Number of points
+   \return                     Success
+
+   Makes sure the workspace holds nPoints points on the unit sphere for
+   the Shrake and Rupley method. They are only made again if the number
+   of points has changed.
+
+-  18.10.26 Original
+*/
+static BOOL SetAccessPoints(ACCESSWORKSPACE *workspace, int nPoints)
+{
+   if(nPoints == workspace->nPoints)
+      return(TRUE);
+
+   FREE(workspace->points);
+   workspace->nPoints = 0;
+
+   if((workspace->points = (REAL *)malloc(3*nPoints*sizeof(REAL)))==NULL)
+      return(FALSE);
+
+   SpherePoints(nPoints, workspace->points, workspace->points+nPoints,
+                workspace->points+2*nPoints);
+   workspace->nPoints = nPoints;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL GrowAccessCubes(ACCESSWORKSPACE *workspace, int nCubes,
+                               int nRows)
+   -------------------------------------------------------------------
+*//**
+   \param[in,out] *workspace   Workspace
+   \param[in]     nCubes       Number of cubes
+   \param[in]     nRows        Number of atoms in a cube
+   \return                     Success. If FALSE, the cubes have been
+                               freed
+
+   Makes sure atomTable[] will hold nCubes cubes and atomsInCube[][]
+   will hold nRows atoms in each of them (counting from 1). Existing
+   rows keep their contents if only more rows are needed.
+
+-  18.10.26 Original
+*/
+static BOOL GrowAccessCubes(ACCESSWORKSPACE *workspace, int nCubes,
+                            int nRows)
+{
+   int  **atomsInCube,
+        first,
+        i;
+
+   /* If there are more cubes, all the arrays are made again            */
+   if(nCubes > workspace->maxCubes)
+   {
+      nRows = MAX(nRows, workspace->maxAtomInCube);
+      FreeAccessCubes(workspace);
+
+      if((workspace->atomTable = (int *)malloc((nCubes+1)*sizeof(int)))
+         ==NULL)
+         return(FALSE);
+      workspace->maxCubes = nCubes;
+   }
+
+   if(nRows <= workspace->maxAtomInCube)
+      return(TRUE);
 
-      if((l-i) > (j-k))
+   /* Add rows                                                          */
+   first = (workspace->atomsInCube == NULL) ?
+           0 : workspace->maxAtomInCube + 1;
+   if((atomsInCube = (int **)realloc(workspace->atomsInCube,
+                                     (nRows+1)*sizeof(int *)))==NULL)
+   {
+      FreeAccessCubes(workspace);
+      return(FALSE);
+   }
+   workspace->atomsInCube = atomsInCube;
+
+   for(i=first; i<=nRows; i++)
+   {
+      if((atomsInCube[i] =
+          (int *)malloc((workspace->maxCubes+1)*sizeof(int)))==NULL)
       {
-         il[m]=i;
-         iu[m]=l;
-         i=k;
-         m++;
-         
-         goto exit80;
+         FreeAccessCubes(workspace);
+         return(FALSE);
       }
-
-      il[m]=k;
-      iu[m]=j;
-      j=l;
-      m++;
-      
-      goto exit80;
+      workspace->maxAtomInCube = i;
    }
 
-   do
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void FreeAccessCubes(ACCESSWORKSPACE *workspace)
+   -------------------------------------------------------
+*//**
+   \param[in,out] *workspace   Workspace
+
+   Frees the cubes of a workspace
+
+-  18.10.26 Original
+-  18.10.26 The cubes are kept in a workspace
+*/
+static void FreeAccessCubes(ACCESSWORKSPACE *workspace)
+{
+   int i;
+
+   FREE(workspace->atomTable);
+
+   if(workspace->atomsInCube != NULL)
    {
-      m--;
-      if(m==0) return;
-      i=il[m];
-      j=iu[m];
+      for(i=0; i<=workspace->maxAtomInCube; i++)
+         free(workspace->atomsInCube[i]);
+      FREE(workspace->atomsInCube);
+   }
 
-exit80:
-      if(j-i>=1) goto jump10;
-      if(i==1) goto jump5;
+   workspace->maxCubes      = 0;
+   workspace->maxAtomInCube = 0;
+}
 
-      i--;
 
-jump90:
-      i++;
-   }  while(i==j);
-   
-   tmpEndpointVal=endpoints[i+1];
-   if(endpoints[i]<=tmpEndpointVal) goto jump90;
-   
-   tmpFlagVal=flag[i+1];
-   k=i;
-   
-   do
+/************************************************************************/
+/*>static int GetAccessBuffers(ACCESSWORKSPACE *workspace, int nBuffers)
+   ---------------------------------------------------------------------
+*//**
+   \param[in,out] *workspace   Workspace
+   \param[in]     nBuffers     Number of sets of buffers wanted
+   \return                     Number of sets available (at most
+                               nBuffers). 0 if no memory
+
+   Makes sure the workspace has a set of neighbour and arc arrays for
+   each of nBuffers threads. Sets which were freed because they could
+   not be expanded are allocated again.
+
+-  18.10.26 Original
+*/
+static int GetAccessBuffers(ACCESSWORKSPACE *workspace, int nBuffers)
+{
+   ACCESSBUFFERS *buffers;
+   int           i;
+
+   if(nBuffers > workspace->nBuffers)
    {
-      endpoints[k+1]=endpoints[k];
-      flag[k+1]=flag[k];
-      k--;
-   }  while(tmpEndpointVal < endpoints[k]);
- 
-   endpoints[k+1]=tmpEndpointVal;
-   flag[k+1]=tmpFlagVal;
-   
-   goto jump90;
+      if((buffers = (ACCESSBUFFERS *)realloc(workspace->buffers,
+                                     nBuffers*sizeof(ACCESSBUFFERS)))
+         !=NULL)
+      {
+         for(i=workspace->nBuffers; i<nBuffers; i++)
+            buffers[i].neighbours = NULL;
+         workspace->buffers  = buffers;
+         workspace->nBuffers = nBuffers;
+      }
+   }
+   nBuffers = MIN(nBuffers, workspace->nBuffers);
+
+   for(i=0; i<nBuffers; i++)
+   {
+      if((workspace->buffers[i].neighbours == NULL) &&
+         !AllocAccessBuffers(&(workspace->buffers[i])))
+         break;
+   }
+
+   return(i);
 }
-      
+
 
 /************************************************************************/
-/*>static BOOL doCalcAccess(int numAtoms, REAL integrationAccuracy,
-                            REAL probeRadius, 
-                            BOOL access, REAL *atomRadii,
-                            REAL *x, REAL *y, REAL *z,
-                            REAL *accessResults)
-   --------------------------------------------------------------------
+/*>static BOOL BuildAccessCubes(ACCESSJOB *job, ACCESSWORKSPACE *workspace)
+   ------------------------------------------------------------------------
 *//**
-   \param[in]   numAtoms             Number of atoms
-   \param[in]   integrationAccuracy  Integration accuracy
-   \param[in]   probeRadius          Radius of probe atom
-   \param[in]   access               Do solvent accessibility
-                                     rather than contact surface
-   \param[in]   *atomRadii           Array of atom radii
-   \param[in]   *x                   Array of x coordinates
-   \param[in]   *y                   Array of y coordinates
-   \param[in]   *z                   Array of z coordinates
-   \param[out]  *accessResults       Array of accessibility results
-   \return                           Success?
-
-   Does the real work of calculating accessibility
+   \param[in,out] *job        The atoms. x, y, z and radii must be
+                              filled in and cube[] allocated
+   \param[in,out] *workspace  Workspace holding the cubes
+   \return                    Success
+
+   Sorts the atoms into cubes. The edge of a cube is the largest
+   diameter of an atom plus probe, so any atom that can touch an atom
+   is in one of the cubes around it. Any cubes that were in the
+   workspace are replaced.
 
 -  21.04.99 Original   By: ACRM
 -  08.06.99 Fixed allocation of second dimension of atomsInCube[][] 
             to njidim rather than numAtoms
+-  18.10.26 Moved from doCalcAccess(). No longer loses atomsInCube[]
+            if it can't be expanded
+-  18.10.26 The cubes are kept in a workspace
 */
-static BOOL doCalcAccess(int numAtoms, REAL integrationAccuracy,
-                         REAL probeRadius, 
-                         BOOL access, REAL *atomRadii,
-                         REAL *x, REAL *y, REAL *z,
-                         REAL *accessResults)
+static BOOL BuildAccessCubes(ACCESSJOB *job, ACCESSWORKSPACE *workspace)
 {
-   int   *cube   = NULL,
-         *neighbours   = NULL,
-         *flag   = NULL,
-         *atomTable   = NULL,
-         **atomsInCube  = NULL;
-   REAL  *radii  = NULL, *radiiSquared=NULL,
-         *arci   = NULL, *arcf=NULL,
-         *deltaX = NULL, *deltaY=NULL,
-         *dist   = NULL, *distSquared=NULL;
-         
-   int   i, j, k, l, m, n,
-         jj, kk,
-         cubeAtom, io, keyAtom,
+   int   **atomsInCube,
+         *atomTable,
+         i, j, k, l, n,
          cubeIndex,
-         nzp, karc, idim, jidim, kjidim,
-         mkji, nm,
-         maxIntersect  = MAX_INTERSECT,
-         maxAtomInCube = MAX_ATOM_IN_CUBE;
-   REAL  xmin  =  999999.0,    
+         idim, jidim, kjidim,
+         numAtoms      = job->numAtoms;
+   REAL  *x            = job->x,
+         *y            = job->y,
+         *z            = job->z,
+         xmin  =  999999.0,    
          ymin  =  999999.0,
          zmin  =  999999.0,
          xmax  = -999999.0,
          ymax  = -999999.0,
          zmax  = -999999.0,
-         pi    = acos(-1.0),
-         twoPi = 2.0*acos(-1.0),
-         maxRadius, totalArea, tmpArea,
-         intersect,
-         xr, yr, zr, 
-         radius, radiusX2, radiusSquared, 
-         zres, zgrid,
-         t, tf, ti, tt, 
-         partialArea,
-         rsec2r, rsecr, 
-         rsec2n, rsecn,
-         alpha, beta,
-         arcsum;
-   BOOL  SkipAccess = FALSE;
+         maxRadius;
 
 #ifdef DEBUG
-   int   maxAtomsSeenInCube = 0,
-         maxIntersectsSeen  = 0;
+   int   maxAtomsSeenInCube = 0;
 #endif
 
-   /* Reset arrays to count from 1 instead of 0                         */
-   atomRadii--;
-   x--; y--; z--;
-   accessResults--;
+   job->atomTable   = NULL;
+   job->atomsInCube = NULL;
 
-   /* Allocate memory for arrays based on number of atoms               */
-   cube         = (int  *)malloc((numAtoms+1)*sizeof(int));
-   radii        = (REAL *)malloc((numAtoms+1)*sizeof(REAL));
-   radiiSquared = (REAL *)malloc((numAtoms+1)*sizeof(REAL));
-   
-   /* Allocate memory for arrays based on number of intersects          */
-   neighbours        = (int  *)malloc((MAX_INTERSECT+1)*sizeof(int));
-   flag        = (int  *)malloc((MAX_INTERSECT+1)*sizeof(int));
-   arci        = (REAL *)malloc((MAX_INTERSECT+1)*sizeof(REAL));
-   arcf        = (REAL *)malloc((MAX_INTERSECT+1)*sizeof(REAL));
-   deltaX      = (REAL *)malloc((MAX_INTERSECT+1)*sizeof(REAL));
-   deltaY      = (REAL *)malloc((MAX_INTERSECT+1)*sizeof(REAL));
-   dist        = (REAL *)malloc((MAX_INTERSECT+1)*sizeof(REAL));
-   distSquared = (REAL *)malloc((MAX_INTERSECT+1)*sizeof(REAL));
-
-   /* Check allocations                                                 */
-   if(cube         == NULL ||
-      radii        == NULL ||
-      radiiSquared == NULL ||
-      neighbours   == NULL ||
-      flag         == NULL ||
-      arci         == NULL ||
-      arcf         == NULL ||
-      deltaX       == NULL ||
-      deltaY       == NULL ||
-      dist         == NULL ||
-      distSquared  == NULL)
-   {
-      FREE_ACCESS_STORAGE;
+   if(numAtoms < 1)
       return(FALSE);
-   }
 
    /* Find the limits of the surrounding box                            */
    maxRadius = 0.0;
    for(i=1; i<=numAtoms; i++)
    {
-      radii[i]         = atomRadii[i] + probeRadius;
-      radiiSquared[i]  = radii[i] * radii[i];
-      accessResults[i] = 0.0;
-
-      if(radii[i] > maxRadius) maxRadius=radii[i];
-      if(x[i] < xmin)          xmin=x[i];
-      if(y[i] < ymin)          ymin=y[i];
-      if(z[i] < zmin)          zmin=z[i];
-      if(x[i] > xmax)          xmax=x[i];
-      if(y[i] > ymax)          ymax=y[i];
-      if(z[i] > zmax)          zmax=z[i];
+      if(job->radii[i] > maxRadius) maxRadius=job->radii[i];
+      if(x[i] < xmin)               xmin=x[i];
+      if(y[i] < ymin)               ymin=y[i];
+      if(z[i] < zmin)               zmin=z[i];
+      if(x[i] > xmax)               xmax=x[i];
+      if(y[i] > ymax)               ymax=y[i];
+      if(z[i] > zmax)               zmax=z[i];
    }
    maxRadius *= 2.0;
 
@@ -1043,41 +2054,27 @@ static BOOL doCalcAccess(int numAtoms, REAL integrationAccuracy,
    if(kjidim < 3) kjidim = 3;
    kjidim *= jidim;
 
+   job->idim   = idim;
+   job->jidim  = jidim;
+   job->kjidim = kjidim;
+
 #ifdef DEBUG
    fprintf(stderr,"Number of cubes: %d\n", kjidim);
 #endif
 
-   /* Allocate memory for atomsInCube 2D array
+   /* Prepare the cubes
+      -----------------
+      Each cube may contain upto MAX_ATOM_IN_CUBE atoms to start with.
+      We count through the cubes with cubeIndex and store the atom
+      indices in the atomTable[] array.
       08.06.99 Corrected to inner dimension being kjidim rather than
                numAtom
    */
-   if((atomsInCube = (int **)malloc((MAX_ATOM_IN_CUBE+1)*sizeof(int *)))
-      ==NULL)
-   {
-      FREE_ACCESS_STORAGE;
+   if(!GrowAccessCubes(workspace, kjidim, MAX_ATOM_IN_CUBE))
       return(FALSE);
-   }
-
-   for(i=0; i<=MAX_ATOM_IN_CUBE; i++)
-   {
-      if((atomsInCube[i] = (int *)malloc((kjidim+1)*sizeof(int)))==NULL)
-      {
-         FREE_ACCESS_STORAGE;
-         return(FALSE);
-      }
-   }
+   atomTable   = workspace->atomTable;
+   atomsInCube = workspace->atomsInCube;
 
-   /* Prepare the cubes
-      -----------------
-      Allocate memory for the cubes. Each cube may contain upto 
-      MAX_ATOM_IN_CUBE atoms. We count through the cubes with cubeIndex 
-      and store the atom indices in the atomTable[] array.
-   */
-   if((atomTable = (int *)malloc((kjidim+1)*sizeof(int)))==NULL)
-   {
-      FREE_ACCESS_STORAGE;
-      return(FALSE);
-   }
    for(l=1; l<=kjidim; l++)
       atomTable[l]=0;
 
@@ -1098,325 +2095,1058 @@ static BOOL doCalcAccess(int numAtoms, REAL integrationAccuracy,
       /* If we have too many atoms in the cube, expand the atomsInCube 
          array   
       */
-      if(n > maxAtomInCube)
+      if(n > workspace->maxAtomInCube)
+      {
+         if(!GrowAccessCubes(workspace, kjidim,
+                             workspace->maxAtomInCube+MAX_ATOM_IN_CUBE))
+            return(FALSE);
+         atomsInCube = workspace->atomsInCube;
+      }
+
+      atomTable[cubeIndex]      = n;
+      atomsInCube[n][cubeIndex] = l;
+      job->cube[l]              = cubeIndex;
+   }
+
+#ifdef DEBUG
+   fprintf(stderr,"Max number of atoms in a cube: %d\n", 
+           maxAtomsSeenInCube);
+#endif
+
+   job->atomTable   = atomTable;
+   job->atomsInCube = atomsInCube;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL RunAccessJob(ACCESSJOB *job, ACCESSWORKSPACE *workspace,
+                            int nthreads)
+   --------------------------------------------------------------------
+*//**
+   \param[in,out] *job        The atoms sorted into cubes. The areas are
+                              stored in job->accessResults[]
+   \param[in,out] *workspace  Workspace holding the thread buffers
+   \param[in]     nthreads    Number of threads
+   \return                    Success. FALSE if a thread ran out of
+                              memory
+
+   Calculates the areas of job->todo[] (or all the atoms). The threads
+   take atoms in turn from the job until there are none left. The
+   calling thread does its share.
+
+-  21.04.99 Original   By: ACRM
+-  18.10.26 Moved from doCalcAccess()
+-  18.10.26 Each thread uses a set of buffers from the workspace
+*/
+static BOOL RunAccessJob(ACCESSJOB *job, ACCESSWORKSPACE *workspace,
+                         int nthreads)
+{
+#ifndef NOTHREADS
+   pthread_t *threads = NULL;
+   int       i,
+             nstarted = 0;
+#endif
+
+#ifdef NOTHREADS
+   nthreads = 1;
+#else
+   /* There is no point in more threads than chunks of atoms            */
+   nthreads = MIN(nthreads,
+                  (job->nTodo + ACCESS_CHUNK - 1) / ACCESS_CHUNK);
+#endif
+
+   /* If there aren't buffers for all the threads, use fewer threads    */
+   if((nthreads = GetAccessBuffers(workspace, MAX(nthreads, 1))) < 1)
+      return(FALSE);
+
+   job->buffers     = workspace->buffers;
+   job->nextBuffers = 0;
+   job->nextAtom    = 1;
+   job->ok          = TRUE;
+
+#ifdef NOTHREADS
+   AccessWorker((void *)job);
+#else
+   pthread_mutex_init(&(job->lock), NULL);
+
+   if((nthreads > 1) &&
+      ((threads = (pthread_t *)malloc((nthreads-1) * sizeof(pthread_t)))
+       != NULL))
+   {
+      /* If a thread can't be started, the others do its share          */
+      for(nstarted=0; nstarted<nthreads-1; nstarted++)
+      {
+         if(pthread_create(&(threads[nstarted]), NULL, AccessWorker,
+                           (void *)job))
+            break;
+      }
+   }
+
+   AccessWorker((void *)job);
+
+   for(i=0; i<nstarted; i++)
+      pthread_join(threads[i], NULL);
+   if(threads != NULL)
+      free(threads);
+   pthread_mutex_destroy(&(job->lock));
+#endif
+
+   return(job->ok);
+}
+
+
+/************************************************************************/
+/*>static void *AccessWorker(void *arg)
+   ------------------------------------
+*//**
+   \param[in,out] *arg     The ACCESSJOB
+   \return                 NULL
+
+   Run by each thread. Takes ACCESS_CHUNK atoms at a time from the job
+   and calculates their areas until there are none left or a thread
+   has run out of memory.
+
+-  18.10.26 Original
+-  18.10.26 Calls CalcAtomAccessSR() for Shrake and Rupley
+-  18.10.26 Takes the atoms from job->todo[] if it is set
+-  18.10.26 Takes its buffers from job->buffers[] rather than
+            allocating them
+*/
+static void *AccessWorker(void *arg)
+{
+   ACCESSJOB     *job = (ACCESSJOB *)arg;
+   ACCESSBUFFERS *buffers;
+   int           first, 
+                 last,
+                 i,
+                 keyAtom;
+   BOOL          ok = TRUE;
+
+#ifndef NOTHREADS
+   pthread_mutex_lock(&(job->lock));
+#endif
+   buffers = &(job->buffers[job->nextBuffers++]);
+#ifndef NOTHREADS
+   pthread_mutex_unlock(&(job->lock));
+#endif
+
+   for(;;)
+   {
+#ifndef NOTHREADS
+      pthread_mutex_lock(&(job->lock));
+#endif
+      if(!ok)
+         job->ok = FALSE;
+      first = job->nextAtom;
+      if(job->ok)
+         job->nextAtom = MIN(first + ACCESS_CHUNK, job->nTodo + 1);
+      last  = job->nextAtom;
+      ok    = job->ok;
+#ifndef NOTHREADS
+      pthread_mutex_unlock(&(job->lock));
+#endif
+
+      if(!ok || (first == last))
+         break;
+
+      for(i=first; i<last; i++)
+      {
+         keyAtom = (job->todo == NULL) ? i : job->todo[i];
+         if(!((job->method == ACCESS_SHRAKE_RUPLEY) ?
+              CalcAtomAccessSR(job, buffers, keyAtom) :
+              CalcAtomAccess(job, buffers, keyAtom)))
+         {
+            ok = FALSE;
+            break;
+         }
+      }
+   }
+
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>static int FindCubeNeighbours(ACCESSJOB *job, ACCESSBUFFERS *buffers,
+                                 int keyAtom)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]     *job       The atoms sorted into cubes
+   \param[in,out] *buffers   Arrays for this thread. The atoms are put
+                             in buffers->neighbours[]
+   \param[in]     keyAtom    The atom (counting from 1)
+   \return                   Number of neighbours. -1 if no memory
+
+   Finds the atoms in the 'mkji' cubes around the cube containing
+   keyAtom. Any atom that can touch keyAtom is in one of them.
+
+-  21.04.99 Original   By: ACRM
+-  18.10.26 Moved from CalcAtomAccess()
+*/
+static int FindCubeNeighbours(ACCESSJOB *job, ACCESSBUFFERS *buffers,
+                              int keyAtom)
+{
+   int   i, j, k, m,
+         jj, kk,
+         cubeAtom, io,
+         cubeIndex,
+         mkji, nm,
+         idim          = job->idim,
+         jidim         = job->jidim,
+         kjidim        = job->kjidim;
+
+   cubeIndex = job->cube[keyAtom];
+   io        = 0;
+   
+   /* Find the 'mkji' cubes neighboring the cubeIndex cube              */
+   for(kk=1; kk<=3; kk++)
+   {
+      k=kk-2;
+      
+      for(jj=1; jj<=3; jj++)
       {
-         int newMaxAtomInCube = maxAtomInCube + MAX_ATOM_IN_CUBE,
-             iexpand;
+         j=jj-2;
          
-         if((atomsInCube = (int **)realloc(atomsInCube, 
-                                    (newMaxAtomInCube+1)*sizeof(int *)))
-            ==NULL)
+         for(i=1; i<=3; i++)
          {
-            FREE_ACCESS_STORAGE;
-            return(FALSE);
+            mkji = cubeIndex + k*jidim + j*idim + i - 2;
+            if(mkji >= 1)
+            {
+               if(mkji > kjidim)
+               {
+                  jj=5;    /* Force exit from for(jj) loop              */
+                  kk=5;    /* Force exit from for(kk) loop              */
+                  break;   /* out of for(i) loop                        */
+               }
+               
+               nm = job->atomTable[mkji];
+               
+               /* Create neighbours[] which is a list of the atoms 
+                  which are neighbours of atom keyAtom
+               */
+               for(m=1; m<=nm; m++)
+               {
+                  cubeAtom = job->atomsInCube[m][mkji];
+                  if(cubeAtom != keyAtom)
+                  {
+                     io++;
+                     if((io > buffers->maxIntersect) &&
+                        !ExpandAccessBuffers(buffers))
+                        return(-1);
+                     
+                     buffers->neighbours[io] = cubeAtom;
+                  }
+               }
+            }
          }
+      }
+   }
+
+   return(io);
+}
+
+
+/************************************************************************/
+/*>static int FindTouchingAtoms(ACCESSJOB *job, ACCESSBUFFERS *buffers,
+                                int keyAtom)
+   --------------------------------------------------------------------
+*//**
+   \param[in]     *job       The atoms sorted into cubes
+   \param[in,out] *buffers   Arrays for this thread. The atoms are put
+                             in buffers->neighbours[]
+   \param[in]     keyAtom    The atom (counting from 1)
+   \return                   Number of atoms. -1 if no memory
+
+   As FindCubeNeighbours(), but keeps only the atoms whose spheres
+   (atom plus probe) touch that of keyAtom. These are the atoms that
+   affect its area and whose areas it affects.
+
+-  18.10.26 Original
+*/
+static int FindTouchingAtoms(ACCESSJOB *job, ACCESSBUFFERS *buffers,
+                             int keyAtom)
+{
+   REAL dx, dy, dz,
+        contact;
+   int  i, n,
+        io,
+        nTouching = 0;
+
+   if((io = FindCubeNeighbours(job, buffers, keyAtom)) < 0)
+      return(-1);
+
+   for(i=1; i<=io; i++)
+   {
+      n       = buffers->neighbours[i];
+      dx      = job->x[keyAtom] - job->x[n];
+      dy      = job->y[keyAtom] - job->y[n];
+      dz      = job->z[keyAtom] - job->z[n];
+      contact = job->radii[keyAtom] + job->radii[n];
+
+      if(dx*dx + dy*dy + dz*dz <= contact*contact)
+         buffers->neighbours[++nTouching] = n;
+   }
+
+   return(nTouching);
+}
+
+
+/************************************************************************/
+/*>static BOOL CalcAtomAccess(ACCESSJOB *job, ACCESSBUFFERS *buffers,
+                              int keyAtom)
+   ------------------------------------------------------------------
+*//**
+   \param[in,out] *job       The atoms. The area is stored in
+                             job->accessResults[keyAtom]
+   \param[in,out] *buffers   Neighbour and arc arrays for this thread
+   \param[in]     keyAtom    The atom (counting from 1)
+   \return                   Success. FALSE if no memory
+
+   Calculates the area of one atom. Only the arrays in buffers are
+   changed, so several threads may do this at once for different atoms.
+
+-  21.04.99 Original   By: ACRM
+-  18.10.26 Moved from doCalcAccess(). arci[] is cleared only as far
+            as it was used by the previous section
+-  18.10.26 Neighbours are found by FindCubeNeighbours()
+*/
+static BOOL CalcAtomAccess(ACCESSJOB *job, ACCESSBUFFERS *buffers,
+                           int keyAtom)
+{
+   REAL  *x            = job->x,
+         *y            = job->y,
+         *z            = job->z,
+         *radiiSquared = job->radiiSquared,
+         *arci, *arcf,
+         *deltaX, *deltaY,
+         *dist, *distSquared;
+   int   *neighbours, *flag,
+         i, j, k,
+         cubeAtom, io,
+         nzp, karc;
+   REAL  pi    = acos(-1.0),
+         twoPi = 2.0*acos(-1.0),
+         totalArea, tmpArea,
+         intersect,
+         xr, yr, zr, 
+         radius, radiusX2, radiusSquared, 
+         zres, zgrid,
+         t, tf, ti, tt, 
+         partialArea,
+         rsec2r, rsecr, 
+         rsec2n, rsecn,
+         alpha, beta,
+         arcsum;
+   BOOL  SkipAccess = FALSE;
 
-         for(iexpand=maxAtomInCube+1; 
-             iexpand<=newMaxAtomInCube; 
-             iexpand++)
-         {
-            /* 08.06.99 Corrected numAtoms to kjidim                    */
-            if((atomsInCube[iexpand] = 
-                (int *)malloc((kjidim+1) * sizeof(int)))
-               ==NULL)
-            {
-               FREE_ACCESS_STORAGE;
-               return(FALSE);
-            }
-         }
-         
-         maxAtomInCube = newMaxAtomInCube;
-      }
+/* Point at the arrays again after they have been expanded              */
+#define GET_ACCESS_BUFFERS                                               \
+   neighbours  = buffers->neighbours;                                    \
+   flag        = buffers->flag;                                          \
+   arci        = buffers->arci;                                          \
+   arcf        = buffers->arcf;                                          \
+   deltaX      = buffers->deltaX;                                        \
+   deltaY      = buffers->deltaY;                                        \
+   dist        = buffers->dist;                                          \
+   distSquared = buffers->distSquared
+
+   totalArea     = 0.0;
+   xr            = x[keyAtom];
+   yr            = y[keyAtom];
+   zr            = z[keyAtom];
+   radius        = job->radii[keyAtom];
+   radiusX2      = radius*2.0;
+   radiusSquared = radiiSquared[keyAtom];
+   
+   /* Find the atoms in the cubes around this one                      */
+   if((io = FindCubeNeighbours(job, buffers, keyAtom)) < 0)
+      return(FALSE);
+   GET_ACCESS_BUFFERS;
 
-      atomTable[cubeIndex]      = n;
-      atomsInCube[n][cubeIndex] = l;
-      cube[l]                   = cubeIndex;
+   for(j=1; j<=io; j++)
+   {
+      cubeAtom = neighbours[j];
+      deltaX[j] = xr - x[cubeAtom];
+      deltaY[j] = yr - y[cubeAtom];
+      
+      distSquared[j] = deltaX[j]*deltaX[j] +
+                       deltaY[j]*deltaY[j];
+      dist[j]        = sqrt(distSquared[j]);
    }
-
-#ifdef DEBUG
-   fprintf(stderr,"Max number of atoms in a cube: %d\n", 
-           maxAtomsSeenInCube);
-#endif
-
-
-   /* Perform the actual accessibility calculations 
-      ---------------------------------------------
-      We cycle through each atom in turn
-   */
-   for(keyAtom=1; keyAtom<=numAtoms; keyAtom++)
+   
+   if(io == 0)
+   {
+      totalArea = twoPi * radiusX2;
+   }
+   else
    {
-      cubeIndex     = cube[keyAtom];
-      io            = 0;
-      totalArea     = 0.0;
-      xr            = x[keyAtom];
-      yr            = y[keyAtom];
-      zr            = z[keyAtom];
-      radius        = radii[keyAtom];
-      radiusX2      = radius*2.0;
-      radiusSquared = radiiSquared[keyAtom];
+      /* Calculate the z resolution                                     */
+      nzp   = 1.0/job->integrationAccuracy + 0.5;
+      zres  = radiusX2 / nzp;
+      zgrid = z[keyAtom] - radius - zres/2.0;
       
-      /* Find the 'mkji' cubes neighboring the cubeIndex cube           */
-      for(kk=1; kk<=3; kk++)
+      /* Take a section of atom spheres which is perpendicular to the 
+         z axis 
+      */
+      for(i=1; i<=nzp; i++)
       {
-         k=kk-2;
+         zgrid += zres;
          
-         for(jj=1; jj<=3; jj++)
+         /* Calculate the radius of the circle of intersection of the 
+            keyAtom sphere on the current z-plane 
+         */
+         rsec2r = radiusSquared - (zgrid-zr)*(zgrid-zr);
+         rsecr  = sqrt(rsec2r);
+         
+         /* Entries after arciUsed are still zero                       */
+         for(k=1; k<=buffers->arciUsed; k++)
+            arci[k] = 0.0;
+         
+         karc=0;
+         
+         for(j=1; j<=io; j++)
          {
-            j=jj-2;
+            cubeAtom = neighbours[j];
             
-            for(i=1; i<=3; i++)
+            /* Find the radius of the circle locus                      */
+            rsec2n = radiiSquared[cubeAtom] - 
+               (zgrid-z[cubeAtom])*(zgrid-z[cubeAtom]);
+            
+            if(rsec2n > 0.0)
             {
-               mkji = cubeIndex + k*jidim + j*idim + i - 2;
-               if(mkji >= 1)
+               rsecn = sqrt(rsec2n);
+               
+               /* Find the intersections of the n circles with the 
+                  keyAtom circles in this section 
+               */
+               if(dist[j] < (rsecr+rsecn))
                {
-                  if(mkji > kjidim)
+                  /* Test whether the the circles intersect, or
+                     whether one circle is completely inside the
+                     other in which case we don't calculate the
+                     accessibility!  
+                  */
+                  intersect = rsecr - rsecn;
+                  
+                  SkipAccess = FALSE;
+                  if(dist[j] <= fabs(intersect)) 
+                  {
+                     if(intersect <= 0.0)
+                     {
+                        SkipAccess = TRUE;
+                        break;               /* out of the j loop       */
+                     }
+                     continue;               /* the j loop              */
+                  }
+                  
+                  /* Expand the intersect arrays if we have too many    */
+                  if(++karc >= buffers->maxIntersect)
                   {
-                     jj=5;    /* Force exit from for(jj) loop           */
-                     kk=5;    /* Force exit from for(kk) loop           */
-                     break;   /* out of for(i) loop                     */
+                     if(!ExpandAccessBuffers(buffers))
+                        return(FALSE);
+                     GET_ACCESS_BUFFERS;
                   }
                   
-                  nm = atomTable[mkji];
+                  /* If the circles do intersect, then we find the 
+                     points of intersection.
+                     
+                     The initial and final arc endpoints are found
+                     for the keyAtom circle intersected by a 
+                     neighboring circle contained in the same plane. 
+                     The initial endpoint of the enclosed arc is stored
+                     in arci, and the final arc in arcf. This uses
+                     the cosine law.
+                     
+                     Calculate alpha which is the angle between a
+                     line containing a point of intersection, the
+                     reference circle center and the line
+                     containing both circle centers.  
+                  */
+                  alpha = acos((distSquared[j] + rsec2r - rsec2n) /
+                               (2.0 * dist[j] * rsecr));
+                  
+                  /* Calculate beta which is the angle between the
+                     line containing both circle centers and the
+                     x-axis 
+                  */
+                  beta = atan2(deltaY[j], deltaX[j]) + pi;
+                  
+                  ti = beta - alpha;
+                  tf = beta + alpha;
+                  if(ti < 0.0)
+                     ti += twoPi;
                   
-                  if(nm >= 1)
+                  if(tf > twoPi)
+                     tf -= twoPi;
+                  
+                  arci[karc] = ti;
+                  
+                  /* If the arc crosses zero, then it is broken
+                     into two segments. The first ends at twoPi and
+                     the second begins at zero 
+                  */
+                  if(tf < ti) 
                   {
-                     /* Create neighbours[] which is a list of the atoms 
-                        which are neighbours of atom keyAtom
-                     */
-                     for(m=1; m<=nm; m++)
-                     {
-                        cubeAtom = atomsInCube[m][mkji];
-                        if(cubeAtom != keyAtom)
-                        {
-                           io++;
-#ifdef DEBUG
-                           if(io > maxIntersectsSeen)
-                              maxIntersectsSeen = io;
-#endif
-                           if(io > maxIntersect)
-                           {
-                              EXPAND_INTERSECT_ARRAYS;
-                           }
-                           
-                           deltaX[io] = xr - x[cubeAtom];
-                           deltaY[io] = yr - y[cubeAtom];
-                           
-                           distSquared[io] = deltaX[io]*deltaX[io] +
-                                             deltaY[io]*deltaY[io];
-                           dist[io]        = sqrt(distSquared[io]);
-                           neighbours[io]        = cubeAtom;
-                        }
-                     }
+                     arcf[karc] = twoPi;
+                     karc++;
                   }
+                  
+                  arcf[karc] = tf;
                }
             }
          }
-      }
-      
-      if(io == 0)
-      {
-         totalArea = twoPi * radiusX2;
-      }
-      else
-      {
-         /* Calculate the z resolution                                  */
-         nzp   = 1.0/integrationAccuracy + 0.5;
-         zres  = radiusX2 / nzp;
-         zgrid = z[keyAtom] - radius - zres/2.0;
+
+         /* Only arci[1..karc] have been set (and sorted)               */
+         buffers->arciUsed = karc;
          
-         /* Take a section of atom spheres which is perpendicular to the 
-            z axis 
-         */
-         for(i=1; i<=nzp; i++)
+         if(SkipAccess)
          {
-            zgrid += zres;
-            
-            /* Calculate the radius of the circle of intersection of the 
-               keyAtom sphere on the current z-plane 
+            /* Accessibility skipped because circle was within another
+               one 
             */
-            rsec2r = radiusSquared - (zgrid-zr)*(zgrid-zr);
-            rsecr  = sqrt(rsec2r);
-            
-            for(k=1; k<=maxIntersect; k++)
-               arci[k] = 0.0;
-            
-            karc=0;
-            
-            for(j=1; j<=io; j++)
+            SkipAccess = FALSE;
+         }
+         else
+         {
+            /* Find the accessible contact surface area for the
+               sphere keyAtom on this section 
+            */
+            if(karc == 0)
             {
-               cubeAtom = neighbours[j];
+               arcsum = twoPi;
+            }
+            else
+            {
+               /* Sort the arc endpoints on the value of the
+                  initial arc endpoint 
+               */
+               SortArcEndpoints(arci, karc, flag);
                
-               /* Find the radius of the circle locus                   */
-               rsec2n = radiiSquared[cubeAtom] - 
-                  (zgrid-z[cubeAtom])*(zgrid-z[cubeAtom]);
+               /* Calculate the length of the accessible arc            */
+               arcsum = arci[1];
+               t      = arcf[flag[1]];
                
-               if(rsec2n > 0.0)
+               if(karc != 1)
                {
-                  rsecn = sqrt(rsec2n);
-                  
-                  /* Find the intersections of the n circles with the 
-                     keyAtom circles in this section 
-                  */
-                  if(dist[j] < (rsecr+rsecn))
+                  for(k=2; k<=karc; k++)
                   {
-                     /* Test whether the the circles intersect, or
-                        whether one circle is completely inside the
-                        other in which case we don't calculate the
-                        accessibility!  
-                     */
-                     intersect = rsecr - rsecn;
-                     
-                     SkipAccess = FALSE;
-                     if(dist[j] <= fabs(intersect)) 
-                     {
-                        if(intersect <= 0.0)
-                        {
-                           SkipAccess = TRUE;
-                           break;               /* out of the j loop    */
-                        }
-                        continue;               /* the j loop           */
-                     }
-                     
-                     /* Expand the intersect arrays if we have too many */
-                     if(++karc >= maxIntersect)
+                     if(t < arci[k])
                      {
-                        EXPAND_INTERSECT_ARRAYS;
+                        arcsum += (arci[k]-t);
                      }
-#ifdef DEBUG
-                     if(karc > maxIntersectsSeen)
-                        maxIntersectsSeen = karc;
-#endif
                      
-                     /* If the circles do intersect, then we find the 
-                        points of intersection.
-                        
-                        The initial and final arc endpoints are found
-                        for the keyAtom circle intersected by a 
-                        neighboring circle contained in the same plane. 
-                        The initial endpoint of the enclosed arc is stored
-                        in arci, and the final arc in arcf. This uses
-                        the cosine law.
-                        
-                        Calculate alpha which is the angle between a
-                        line containing a point of intersection, the
-                        reference circle center and the line
-                        containing both circle centers.  
-                     */
-                     alpha = acos((distSquared[j] + rsec2r - rsec2n) /
-                                  (2.0 * dist[j] * rsecr));
-                     
-                     /* Calculate beta which is the angle between the
-                        line containing both circle centers and the
-                        x-axis 
-                     */
-                     beta = atan2(deltaY[j], deltaX[j]) + pi;
-                     
-                     ti = beta - alpha;
-                     tf = beta + alpha;
-                     if(ti < 0.0)
-                        ti += twoPi;
-                     
-                     if(tf > twoPi)
-                        tf -= twoPi;
-                     
-                     arci[karc] = ti;
-                     
-                     /* If the arc crosses zero, then it is broken
-                        into two segments. The first ends at twoPi and
-                        the second begins at zero 
-                     */
-                     if(tf < ti) 
+                     tt = arcf[flag[k]];
+                     if(tt > t)
                      {
-                        arcf[karc] = twoPi;
-                        karc++;
+                        t = tt;
                      }
-                     
-                     arcf[karc] = tf;
                   }
                }
+               
+               arcsum += (twoPi-t);
             }
             
-            if(SkipAccess)
-            {
-               /* Accessibility skipped because circle was within another
-                  one 
-               */
-               SkipAccess = FALSE;
-            }
-            else
+            /* Calculate the partial accessible area for this atom
+               on this section. The area/radius is equal to the
+               accessible arc length x the section thickness.  
+            */
+            partialArea = arcsum * zres;
+            
+            /* ...and add this to the total area for this atom          */
+            totalArea += partialArea;
+         }
+      }
+   }
+#undef GET_ACCESS_BUFFERS
+   
+   /* Scale the area to Van der Waals shell                             */
+   tmpArea = totalArea * (radius-job->probeRadius) * 
+      (radius-job->probeRadius) / radius;
+   
+   /* Convert from the contact area to the accessible surface area
+      if required 
+   */
+   if(job->access)
+   {
+      tmpArea *= (radius*radius) / 
+         ((radius-job->probeRadius) * (radius-job->probeRadius));
+   }
+   
+   job->accessResults[keyAtom] = tmpArea;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL CalcAtomAccessSR(ACCESSJOB *job, ACCESSBUFFERS *buffers,
+                                int keyAtom)
+   --------------------------------------------------------------------
+*//**
+   \param[in,out] *job       The atoms. The area is stored in
+                             job->accessResults[keyAtom]
+   \param[in,out] *buffers   Neighbour arrays for this thread
+   \param[in]     keyAtom    The atom (counting from 1)
+   \return                   Success. FALSE if no memory
+
+   Calculates the area of one atom by the method of Shrake and Rupley.
+   The neighbours whose spheres overlap that of keyAtom are copied into
+   deltaX[], deltaY[], deltaZ[] (relative to keyAtom) and
+   neighbourRadSq[]. These are padded to a multiple of ACCESS_SR_BLOCK
+   with neighbours of zero radius. Each point on the sphere of keyAtom
+   is tested first against the neighbour that buried the last buried
+   point and then against ACCESS_SR_BLOCK neighbours at a time.
+
+-  18.10.26 Original
+*/
+static BOOL CalcAtomAccessSR(ACCESSJOB *job, ACCESSBUFFERS *buffers,
+                             int keyAtom)
+{
+   REAL  *x            = job->x,
+         *y            = job->y,
+         *z            = job->z,
+         *deltaX, *deltaY, *deltaZ,
+         *radSq,
+         xr, yr, zr,
+         dx, dy, dz,
+         px, py, pz,
+         radius, 
+         sumRadii,
+         area;
+   int   *neighbours,
+         i, j, k, last,
+         io, nOverlap,
+         nAccessible = 0,
+         hit;
+
+   xr     = x[keyAtom];
+   yr     = y[keyAtom];
+   zr     = z[keyAtom];
+   radius = job->radii[keyAtom];
+
+   if((io = FindCubeNeighbours(job, buffers, keyAtom)) < 0)
+      return(FALSE);
+   while(io + ACCESS_SR_BLOCK > buffers->maxIntersect)
+   {
+      if(!ExpandAccessBuffers(buffers))
+         return(FALSE);
+   }
+   neighbours = buffers->neighbours;
+   deltaX     = buffers->deltaX;
+   deltaY     = buffers->deltaY;
+   deltaZ     = buffers->deltaZ;
+   radSq      = buffers->neighbourRadSq;
+
+   /* Keep the neighbours that overlap this atom                        */
+   nOverlap = 0;
+   for(j=1; j<=io; j++)
+   {
+      k        = neighbours[j];
+      dx       = x[k] - xr;
+      dy       = y[k] - yr;
+      dz       = z[k] - zr;
+      sumRadii = radius + job->radii[k];
+      if((dx*dx + dy*dy + dz*dz) < sumRadii*sumRadii)
+      {
+         nOverlap++;
+         deltaX[nOverlap] = dx;
+         deltaY[nOverlap] = dy;
+         deltaZ[nOverlap] = dz;
+         radSq[nOverlap]  = job->radiiSquared[k];
+      }
+   }
+   for(j=nOverlap+1; (j-1) % ACCESS_SR_BLOCK; j++)
+   {
+      deltaX[j] = deltaY[j] = deltaZ[j] = 0.0;
+      radSq[j]  = -1.0;
+   }
+
+   /* Count the points that are not inside a neighbour. An atom with no
+      neighbours is all accessible
+   */
+   last = 0;
+   if(nOverlap == 0)
+      nAccessible = job->nPoints;
+
+   for(i=0; (nOverlap > 0) && (i < job->nPoints); i++)
+   {
+      px = radius * job->pointX[i];
+      py = radius * job->pointY[i];
+      pz = radius * job->pointZ[i];
+
+      /* Neighbours often bury several points in a row                  */
+      if(last)
+      {
+         dx = px - deltaX[last];
+         dy = py - deltaY[last];
+         dz = pz - deltaZ[last];
+         if((dx*dx + dy*dy + dz*dz) < radSq[last])
+            continue;
+      }
+
+      hit = 0;
+      for(j=1; (j<=nOverlap) && !hit; j+=ACCESS_SR_BLOCK)
+      {
+         int end = j + ACCESS_SR_BLOCK - 1;
+         
+         /* A fixed number of tests with no branches, so this loop may
+            be vectorised
+         */
+         for(k=j; k<=end; k++)
+         {
+            dx   = px - deltaX[k];
+            dy   = py - deltaY[k];
+            dz   = pz - deltaZ[k];
+            hit |= ((dx*dx + dy*dy + dz*dz) < radSq[k]);
+         }
+
+         if(hit)
+         {
+            for(k=j; k<=end; k++)
             {
-               /* Find the accessible contact surface area for the
-                  sphere keyAtom on this section 
-               */
-               if(karc == 0)
-               {
-                  arcsum = twoPi;
-               }
-               else
+               dx = px - deltaX[k];
+               dy = py - deltaY[k];
+               dz = pz - deltaZ[k];
+               if((dx*dx + dy*dy + dz*dz) < radSq[k])
                {
-                  /* Sort the arc endpoints on the value of the
-                     initial arc endpoint 
-                  */
-                  SortArcEndpoints(arci, karc, flag);
-                  
-                  /* Calculate the length of the accessible arc         */
-                  arcsum = arci[1];
-                  t      = arcf[flag[1]];
-                  
-                  if(karc != 1)
-                  {
-                     for(k=2; k<=karc; k++)
-                     {
-                        if(t < arci[k])
-                        {
-                           arcsum += (arci[k]-t);
-                        }
-                        
-                        tt = arcf[flag[k]];
-                        if(tt > t)
-                        {
-                           t = tt;
-                        }
-                     }
-                  }
-                  
-                  arcsum += (twoPi-t);
+                  last = k;
+                  break;
                }
-               
-               /* Calculate the partial accessible area for this atom
-                  on this section. The area/radius is equal to the
-                  accessible arc length x the section thickness.  
-               */
-               partialArea = arcsum * zres;
-               
-               /* ...and add this to the total area for this atom       */
-               totalArea += partialArea;
             }
          }
       }
-      
-      /* Scale the area to Van der Waals shell                          */
-      tmpArea = totalArea * (radius-probeRadius) * (radius-probeRadius) /
-         radius;
-      
-      /* Convert from the contact area to the accessible surface area
-         if required 
-      */
-      if(access)
-      {
-         tmpArea *= (radius*radius) / 
-            ((radius-probeRadius) * (radius-probeRadius));
-      }
-      
-      accessResults[keyAtom] = tmpArea;
+
+      if(!hit)
+         nAccessible++;
    }
 
-#ifdef DEBUG
-   fprintf(stderr,"Maximum intersects: %d\n",maxIntersectsSeen);
-#endif
+   /* Area of the probe sphere, or of the atom sphere for contact area  */
+   area = 4.0 * PI * radius * radius * (REAL)nAccessible /
+          (REAL)job->nPoints;
+   if(!job->access)
+   {
+      area *= (radius-job->probeRadius) * (radius-job->probeRadius) /
+              (radius*radius);
+   }
+
+   job->accessResults[keyAtom] = area;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void SpherePoints(int nPoints, REAL *x, REAL *y, REAL *z)
+   ----------------------------------------------------------------
+*//**
+   \param[in]     nPoints   Number of points
+   \param[out]    *x        X coordinates (counting from 0)
+   \param[out]    *y        Y coordinates
+   \param[out]    *z        Z coordinates
+
+   Spreads points evenly over a unit sphere on a golden-section spiral.
+   The points are at equal steps in z, each turned by the golden angle
+   from the one before.
+
+-  18.10.26 Original
+*/
+static void SpherePoints(int nPoints, REAL *x, REAL *y, REAL *z)
+{
+   REAL goldenAngle = PI * (3.0 - sqrt(5.0)),
+        r;
+   int  i;
+
+   for(i=0; i<nPoints; i++)
+   {
+      z[i] = 1.0 - (2.0 * i + 1.0) / nPoints;
+      r    = sqrt(1.0 - z[i]*z[i]);
+      x[i] = r * cos(goldenAngle * i);
+      y[i] = r * sin(goldenAngle * i);
+   }
+}
 
-   FREE_ACCESS_STORAGE;
+
+/************************************************************************/
+/*>static BOOL AllocAccessBuffers(ACCESSBUFFERS *buffers)
+   ------------------------------------------------------
+*//**
+   \param[out]    *buffers   Neighbour and arc arrays
+   \return                   Success
+
+   Allocates the neighbour and arc arrays for one thread with room for
+   MAX_INTERSECT intersections. arci[] is cleared.
+
+-  18.10.26 Original
+-  18.10.26 Added deltaZ and neighbourRadSq
+*/
+static BOOL AllocAccessBuffers(ACCESSBUFFERS *buffers)
+{
+   int n = MAX_INTERSECT+1;
    
+   buffers->maxIntersect = MAX_INTERSECT;
+   buffers->arciUsed     = 0;
+   buffers->neighbours   = (int  *)malloc(n*sizeof(int));
+   buffers->flag         = (int  *)malloc(n*sizeof(int));
+   buffers->arci         = (REAL *)calloc(n, sizeof(REAL));
+   buffers->arcf         = (REAL *)malloc(n*sizeof(REAL));
+   buffers->deltaX       = (REAL *)malloc(n*sizeof(REAL));
+   buffers->deltaY       = (REAL *)malloc(n*sizeof(REAL));
+   buffers->deltaZ       = (REAL *)malloc(n*sizeof(REAL));
+   buffers->neighbourRadSq = (REAL *)malloc(n*sizeof(REAL));
+   buffers->dist         = (REAL *)malloc(n*sizeof(REAL));
+   buffers->distSquared  = (REAL *)malloc(n*sizeof(REAL));
+
+   if(buffers->neighbours == NULL || buffers->flag        == NULL ||
+      buffers->arci       == NULL || buffers->arcf        == NULL ||
+      buffers->deltaX     == NULL || buffers->deltaY      == NULL ||
+      buffers->dist       == NULL || buffers->distSquared == NULL ||
+      buffers->deltaZ     == NULL || buffers->neighbourRadSq == NULL)
+   {
+      FreeAccessBuffers(buffers);
+      return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL ExpandAccessBuffers(ACCESSBUFFERS *buffers)
+   -------------------------------------------------------
+*//**
+   \param[in,out] *buffers   Neighbour and arc arrays
+   \return                   Success. The arrays are freed if there is
+                             no memory
+
+   Doubles the size of the neighbour and arc arrays. The new entries of
+   arci[] are cleared.
+
+-  18.10.26 Original (replaces the EXPAND_INTERSECT_ARRAYS macro)
+-  18.10.26 Added deltaZ and neighbourRadSq
+*/
+static BOOL ExpandAccessBuffers(ACCESSBUFFERS *buffers)
+{
+   int  newMaxIntersect = 2 * buffers->maxIntersect,
+        n               = newMaxIntersect + 1,
+        i;
+   BOOL ok              = TRUE;
+
+#define EXPAND_ACCESS_BUFFER(array, type)                                \
+   do {  type *newArray;                                                 \
+      if((newArray = (type *)realloc(buffers->array, n*sizeof(type)))   \
+         == NULL)                                                        \
+         ok = FALSE;                                                     \
+      else                                                               \
+         buffers->array = newArray;                                      \
+   }  while(0)
+
+   EXPAND_ACCESS_BUFFER(neighbours,  int);
+   EXPAND_ACCESS_BUFFER(flag,        int);
+   EXPAND_ACCESS_BUFFER(arci,        REAL);
+   EXPAND_ACCESS_BUFFER(arcf,        REAL);
+   EXPAND_ACCESS_BUFFER(deltaX,      REAL);
+   EXPAND_ACCESS_BUFFER(deltaY,      REAL);
+   EXPAND_ACCESS_BUFFER(deltaZ,      REAL);
+   EXPAND_ACCESS_BUFFER(neighbourRadSq, REAL);
+   EXPAND_ACCESS_BUFFER(dist,        REAL);
+   EXPAND_ACCESS_BUFFER(distSquared, REAL);
+#undef EXPAND_ACCESS_BUFFER
+
+   if(!ok)
+   {
+      FreeAccessBuffers(buffers);
+      return(FALSE);
+   }
+
+   for(i=buffers->maxIntersect+1; i<=newMaxIntersect; i++)
+      buffers->arci[i] = 0.0;
+   buffers->maxIntersect = newMaxIntersect;
+
    return(TRUE);
 }
 
+
+/************************************************************************/
+/*>static void FreeAccessBuffers(ACCESSBUFFERS *buffers)
+   -----------------------------------------------------
+*//**
+   \param[in,out] *buffers   Neighbour and arc arrays
+
+   Frees the neighbour and arc arrays for one thread
+
+-  18.10.26 Original
+-  18.10.26 Added deltaZ and neighbourRadSq
+*/
+static void FreeAccessBuffers(ACCESSBUFFERS *buffers)
+{
+   FREE(buffers->neighbours);
+   FREE(buffers->flag);
+   FREE(buffers->arci);
+   FREE(buffers->arcf);
+   FREE(buffers->deltaX);
+   FREE(buffers->deltaY);
+   FREE(buffers->deltaZ);
+   FREE(buffers->neighbourRadSq);
+   FREE(buffers->dist);
+   FREE(buffers->distSquared);
+}
+
+
+/************************************************************************/
+#ifdef BENCHMARK
+#include <time.h>
+/************************************************************************/
+/*>static double TimeAccess(PDB *pdb, int natoms, int method, 
+                            int nPoints, int repeats,
+                            ACCESSWORKSPACE *workspace)
+   ----------------------------------------------------------
+*//**
+
+   Runs blCalcAccessWorkspace() a number of times with one thread and
+   returns the average time
+
+-  18.10.26 Original
+-  18.10.26 Added workspace (NULL for a new one each time)
+*/
+static double TimeAccess(PDB *pdb, int natoms, int method, int nPoints,
+                         int repeats, ACCESSWORKSPACE *workspace)
+{
+   clock_t start;
+   int     i;
+
+   start = clock();
+   for(i=0; i<repeats; i++)
+   {
+      if(!blCalcAccessWorkspace(pdb, natoms, method, 0.0, nPoints, 1.4,
+                                TRUE, 1, workspace))
+      {
+         fprintf(stderr,"Accessibility calculation failed\n");
+         exit(1);
+      }
+   }
+   return((double)(clock() - start) / CLOCKS_PER_SEC / repeats);
+}
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*//**
+
+   Compares the speed and results of the Lee and Richards and Shrake
+   and Rupley methods. The agreement is given as the difference in
+   total area and the per-atom differences and correlation. Each is
+   also timed reusing one ACCESSWORKSPACE.
+   Usage: accessbench file.pdb radius.dat [npoints] [repeats]
+
+-  18.10.26 Original
+-  18.10.26 Added times with a workspace
+*/
+int main(int argc, char **argv)
+{
+   FILE            *fp;
+   PDB             *pdb,
+                   *p;
+   RESRAD          *resrad;
+   ACCESSWORKSPACE *workspace;
+   REAL            *lr;
+   double          tLR, tSR,
+                   tLRWorkspace, tSRWorkspace,
+                   totalLR = 0.0, totalSR = 0.0,
+                   sumD2   = 0.0, maxD    = 0.0,
+                   sxy = 0.0, sxx = 0.0, syy = 0.0,
+                   meanLR, meanSR, d;
+   int             natoms, i,
+                   nPoints = ACCESS_DEF_NPOINTS,
+                   repeats = 3;
+
+   if(argc < 3)
+   {
+      fprintf(stderr,
+              "Usage: accessbench file.pdb radius.dat [npoints] \
+[repeats]\n");
+      return(1);
+   }
+   if(argc > 3)
+      nPoints = atoi(argv[3]);
+   if(argc > 4)
+      repeats = atoi(argv[4]);
+
+   if((fp = fopen(argv[1], "r"))==NULL)
+   {
+      fprintf(stderr,"Unable to open %s\n", argv[1]);
+      return(1);
+   }
+   pdb = blReadPDB(fp, &natoms);
+   fclose(fp);
+   if(pdb == NULL)
+   {
+      fprintf(stderr,"No atoms read from %s\n", argv[1]);
+      return(1);
+   }
+
+   if((fp = fopen(argv[2], "r"))==NULL)
+   {
+      fprintf(stderr,"Unable to open %s\n", argv[2]);
+      return(1);
+   }
+   resrad = blSetAtomRadii(pdb, fp);
+   fclose(fp);
+
+   if(((lr = (REAL *)malloc(natoms * sizeof(REAL)))==NULL) ||
+      ((workspace = blAllocAccessWorkspace())==NULL))
+   {
+      fprintf(stderr,"No memory\n");
+      return(1);
+   }
+
+   tLRWorkspace = TimeAccess(pdb, natoms, ACCESS_LEE_RICHARDS, 0,
+                             repeats, workspace);
+   tSRWorkspace = TimeAccess(pdb, natoms, ACCESS_SHRAKE_RUPLEY, nPoints,
+                             repeats, workspace);
+   tLR = TimeAccess(pdb, natoms, ACCESS_LEE_RICHARDS, 0, repeats, NULL);
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      lr[i]    = p->access;
+      totalLR += p->access;
+   }
+
+   tSR = TimeAccess(pdb, natoms, ACCESS_SHRAKE_RUPLEY, nPoints, repeats,
+                    NULL);
+   for(p=pdb; p!=NULL; NEXT(p))
+      totalSR += p->access;
+
+   /* Per-atom agreement                                                */
+   meanLR = totalLR / natoms;
+   meanSR = totalSR / natoms;
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      d      = p->access - lr[i];
+      sumD2 += d * d;
+      if(ABS(d) > maxD)
+         maxD = ABS(d);
+      sxy   += (lr[i] - meanLR) * (p->access - meanSR);
+      sxx   += (lr[i] - meanLR) * (lr[i] - meanLR);
+      syy   += (p->access - meanSR) * (p->access - meanSR);
+   }
+
+   printf("File: %s (%d atoms, %d points, %d repeats)\n", 
+          argv[1], natoms, nPoints, repeats);
+   printf("Lee and Richards   : %8.3fs  total %10.1f A^2\n", tLR, totalLR);
+   printf("Shrake and Rupley  : %8.3fs  total %10.1f A^2\n", tSR, totalSR);
+   printf("L&R with workspace : %8.3fs\n", tLRWorkspace);
+   printf("S&R with workspace : %8.3fs\n", tSRWorkspace);
+   printf("Speedup            : %8.2fx\n", tLR/tSR);
+   printf("Total difference   : %8.3f%%\n",
+          100.0 * (totalSR - totalLR) / totalLR);
+   printf("Per-atom RMS diff  : %8.3f A^2\n", sqrt(sumD2 / natoms));
+   printf("Per-atom max diff  : %8.3f A^2\n", maxD);
+   printf("Per-atom corr.     : %8.5f\n", 
+          ((sxx > 0.0) && (syy > 0.0)) ? sxy / sqrt(sxx * syy) : 0.0);
+
+   free(lr);
+   blFreeAccessWorkspace(workspace);
+   FREELIST(resrad, RESRAD);
+   FREELIST(pdb, PDB);
+
+   return(0);
+}
+#endif
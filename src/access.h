@@ -3,11 +3,11 @@
 
    \file       access.h
    
-   \version    V1.2
-   \date       17.06.16
+   \version    V1.6
+   \date       18.10.26
    \brief      Accessibility calculation code
    
-   \copyright  (c) UCL, Dr. Andrew C.R. Martin, 1999-2015
+   \copyright  (c) UCL, Dr. Andrew C.R. Martin, 1999-2026
    \author     Dr. Andrew C.R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -49,6 +49,10 @@
 -  V1.1  17.07.14 Extracted from XMAS code
 -  V1.2  17.06.15 Added scAccess and scRelAccess to RESACCESS structure
                   Added stdaccessSc to RESRAD structure
+-  V1.3  18.10.26 Added blCalcAccessThreaded()
+-  V1.4  18.10.26 Added blCalcAccessMethod()
+-  V1.5  18.10.26 Added ACCESSCONTEXT and its functions
+-  V1.6  18.10.26 Added ACCESSWORKSPACE and its functions
 
 *************************************************************************/
 #ifndef _ACCESS_H_
@@ -56,6 +60,11 @@
 
 #define ACCESS_MAX_ATOMS_PER_RESIDUE 50
 #define ACCESS_DEF_INTACC            0.05
+#define ACCESS_DEF_NPOINTS           960
+
+/* Methods for blCalcAccessMethod()                                     */
+#define ACCESS_LEE_RICHARDS          0
+#define ACCESS_SHRAKE_RUPLEY         1
 
 #ifndef VERY_SMALL
 #define VERY_SMALL            (REAL)1e-6
@@ -87,11 +96,41 @@ typedef struct _resaccess
         insert[8];
 }  RESACCESS;
 
+/* Kept between updates of the accessibility of a changing structure.
+   The contents are private to access.c
+*/
+typedef struct _accesscontext ACCESSCONTEXT;
+
+/* Arrays kept between accessibility calculations. The contents are
+   private to access.c
+*/
+typedef struct _accessworkspace ACCESSWORKSPACE;
+
 /* Prototypes                                                           */
 RESRAD *blSetAtomRadii(PDB *pdb, FILE *fpRad);
 BOOL blCalcAccess(PDB *pdb, int natoms, 
                   REAL integrationAccuracy, REAL probeRadius,
                   BOOL doAccessibility);
+BOOL blCalcAccessThreaded(PDB *pdb, int natoms, 
+                          REAL integrationAccuracy, REAL probeRadius,
+                          BOOL doAccessibility, int nthreads);
+BOOL blCalcAccessMethod(PDB *pdb, int natoms, int method,
+                        REAL integrationAccuracy, int nPoints,
+                        REAL probeRadius, BOOL doAccessibility,
+                        int nthreads);
+BOOL blCalcAccessWorkspace(PDB *pdb, int natoms, int method,
+                           REAL integrationAccuracy, int nPoints,
+                           REAL probeRadius, BOOL doAccessibility,
+                           int nthreads, ACCESSWORKSPACE *workspace);
+ACCESSWORKSPACE *blAllocAccessWorkspace(void);
+void blFreeAccessWorkspace(ACCESSWORKSPACE *workspace);
+ACCESSCONTEXT *blInitAccessContext(PDB *pdb, int method,
+                                   REAL integrationAccuracy, int nPoints,
+                                   REAL probeRadius, BOOL doAccessibility,
+                                   int nthreads);
+BOOL blUpdateAccessContext(ACCESSCONTEXT *context, PDB *pdb,
+                           PDB *start, PDB *stop);
+void blFreeAccessContext(ACCESSCONTEXT *context);
 RESACCESS *blCalcResAccess(PDB *pdb, RESRAD *resrad);
 
 #endif
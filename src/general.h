@@ -3,11 +3,11 @@
 
    \file       general.h
    
-   \version    V1.22
-   \date       10.11.17
+   \version    V1.25
+   \date       18.10.26
    \brief      Header file for general purpose routines
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1994-2017
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1994-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -71,6 +71,9 @@
 -  V1.20 14.05.15 Added blStrdup()
 -  V1.21 26.06.15 Added FREESTRINGLIST() macro
 -  V1.22 10.11.17 Added blRemoveSpaces()
+-  V1.23 18.10.26 Added blOpenGzipOutput()
+-  V1.24 18.10.26 Added blAppendString()
+-  V1.25 18.10.26 Added ARENA and blAppendStringArena()
 
 *************************************************************************/
 #ifndef _GENERAL_H
@@ -86,6 +89,9 @@ typedef struct _stringlist
    char               *string;
 }  STRINGLIST;
 
+/* Arena allocator. The contents are private to Arena.c                 */
+typedef struct _arena ARENA;
+
 #define FREESTRINGLIST(l) do {                          \
       STRINGLIST *_s = NULL;                            \
       for(_s = (l); _s != NULL; NEXT(_s)) {             \
@@ -123,6 +129,11 @@ char *blStrcatalloc(char *instr, char *catstr);
 char *blStrncat(char *out, const char *in, size_t len);
 
 STRINGLIST *blStoreString(STRINGLIST *StringList, char *string);
+STRINGLIST *blAppendString(STRINGLIST **pStringList, STRINGLIST *tail,
+                           char *string);
+STRINGLIST *blAppendStringArena(STRINGLIST **pStringList, 
+                                STRINGLIST *tail, char *string,
+                                ARENA *arena);
 BOOL blInStringList(STRINGLIST *StringList, char *string);
 void blFreeStringList(STRINGLIST *StringList);
 
@@ -132,6 +143,12 @@ void blIndexReal(REAL *arrin, int *indx, int n);
 
 FILE *blOpenOrPipe(char *filename);
 int blCloseOrPipe(FILE *fp);
+FILE *blOpenGzipOutput(char *filename);
+
+ARENA *blCreateArena(int blockSize);
+APTR blArenaAlloc(ARENA *arena, int size);
+char *blArenaStrdup(ARENA *arena, char *string);
+void blFreeArena(ARENA *arena);
 
 BOOL blWrapString(char *in, char *out, int maxlen);
 BOOL blWrapPrint(FILE *out, char *string);
@@ -3,11 +3,11 @@
 
    \file       macros.h
    
-   \version    V2.26
-   \date       14.12.16
+   \version    V2.27
+   \date       18.10.26
    \brief      Useful macros
    
-   \copyright  (c) Dr. Andrew C.R. Martin / UCL 1991-2016
+   \copyright  (c) Dr. Andrew C.R. Martin / UCL 1991-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -100,6 +100,8 @@
 -  V2.24 28.08.15 Added FREE()
 -  V2.25 04.11.15 Added FCLOSE()
 -  V2.26 14.12.16 Added TERMINATECR()
+-  V2.27 18.10.26 Added INITARENA(), INITPREVARENA(), ALLOCNEXTARENA()
+                  and ALLOCNEXTPREVARENA()
 
 *************************************************************************/
 /* Doxygen
@@ -120,6 +122,15 @@
    Macro: Allocate next item in list and step on
    #FUNCTION ALLOCNEXTPREV(x,y)   
    Macro: Allocate next item in doubly linked list and step on. 
+   #FUNCTION INITARENA(x,y,a)
+   Macro: As INIT() but allocates from arena a if it is not NULL
+   #FUNCTION INITPREVARENA(x,y,a)
+   Macro: As INITPREV() but allocates from arena a if it is not NULL
+   #FUNCTION ALLOCNEXTARENA(x,y,a)
+   Macro: As ALLOCNEXT() but allocates from arena a if it is not NULL
+   #FUNCTION ALLOCNEXTPREVARENA(x,y,a)
+   Macro: As ALLOCNEXTPREV() but allocates from arena a if it is not 
+          NULL
    #FUNCTION LAST(x)              
    Macro: Move to end of list
    #FUNCTION FREELIST(y,z)        
@@ -256,6 +267,27 @@
                              { (x)->next->prev = (x); \
                                (x)->next->next=NULL; }\
                                NEXT(x);} while(0)
+/* The ARENA versions allocate from an arena (see Arena.c) if a is not
+   NULL and with malloc() otherwise. A list allocated from an arena 
+   must not be freed with FREELIST()
+*/
+#define ARENAMALLOC(y,a) (((a)!=NULL) ? (y *)blArenaAlloc((a),sizeof(y)) \
+                                      : (y *)malloc(sizeof(y)))
+#define INITARENA(x,y,a) do { x=ARENAMALLOC(y,a); \
+                              if(x != NULL) x->next = NULL; } while(0)
+#define INITPREVARENA(x,y,a) do { x=ARENAMALLOC(y,a); \
+                                  if(x != NULL) {x->next=NULL; \
+                                                 x->prev=NULL;} } \
+                             while(0)
+#define ALLOCNEXTARENA(x,y,a) do { (x)->next=ARENAMALLOC(y,a); \
+                                   if((x)->next != NULL) \
+                                   { (x)->next->next=NULL; } \
+                                   NEXT(x); } while(0)
+#define ALLOCNEXTPREVARENA(x,y,a) do { (x)->next=ARENAMALLOC(y,a); \
+                                       if((x)->next != NULL) \
+                                       { (x)->next->prev = (x); \
+                                         (x)->next->next=NULL; } \
+                                       NEXT(x); } while(0)
 #define LAST(x)   while(((x)!=NULL) && ((x)->next != NULL)) NEXT(x)
 /* FREELIST takes 2 parameters:
    y: name of list
@@ -3,12 +3,12 @@
 
    \file       openorpipe.c
    
-   \version    V1.10
-   \date       17.07.14
+   \version    V1.11
+   \date       18.10.26
    \brief      Open a file for writing unless the filename starts with
                a | in which case open as a pipe
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1997-2014
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1997-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -61,6 +61,8 @@
 -  V1.9  07.07.14 Use bl prefix for functions By: CTP
 -  V1.10 17.07.14 Added 'stdout' as a special file which maps to 
                   standard output
+-  V1.11 18.10.26 Files ending .gz are gzip compressed in process with
+                  blOpenGzipOutput() when ZLIB_SUPPORT is defined
 
 *************************************************************************/
 /* Doxygen
@@ -86,10 +88,15 @@
 #include <signal.h>
 #include <string.h>
 #include "macros.h"
+#include "general.h"
 
 /************************************************************************/
 /* Defines and macros
 */
+/* blOpenGzipOutput() needs fopencookie() from glibc                    */
+#if defined(ZLIB_SUPPORT) && defined(__GLIBC__)
+#  define GZIP_OUTPUT
+#endif
 
 /************************************************************************/
 /* Globals
@@ -118,12 +125,16 @@ int  pclose(FILE *);
 
    Broken pipe signals are ignored.
 
+   If ZLIB_SUPPORT is defined, a filename ending .gz is gzip compressed
+   as it is written, so no '|gzip >file.gz' pipe is needed.
+
 -  26.05.97 Original   By: ACRM
 -  26.06.97 Added call to signal()
 -  18.08.98 Added case to popen() for SunOS
 -  28.01.05 Added NOPIPE define
 -  07.07.14 Use bl prefix for functions By: CTP
 -  17.07.14 Added special 'stdout' file By: ACRM
+-  18.10.26 Compresses .gz files in process
 */
 FILE *blOpenOrPipe(char *filename)
 {
@@ -133,6 +144,12 @@ FILE *blOpenOrPipe(char *filename)
    if(!strcmp(fnam, "stdout"))
       return(stdout);
 
+#ifdef GZIP_OUTPUT
+   if((fnam[0] != '|') && (strlen(fnam) > 3) && 
+      !strcmp(fnam + strlen(fnam) - 3, ".gz"))
+      return(blOpenGzipOutput(fnam));
+#endif
+
 #ifdef NOPIPE
    return(fopen(fnam, "w"));
 #else
@@ -160,7 +177,7 @@ FILE *blOpenOrPipe(char *filename)
 
    Attempts to close a file pointer as a pipe. If it isn't associated 
    with a pipe (i.e. pclose returns (-1)), tries again to close it as
-   a normal file.
+   a normal file (which also finishes a compressed .gz file).
 
 -  26.05.97 Original   By: ACRM
 -  26.06.97 Added call to signal()
@@ -3,12 +3,12 @@
 
    \file       pdb.h
    
-   \version    V1.96
-   \date       30.09.17
+   \version    V2.16
+   \date       18.10.26
 
    \brief      Include file for PDB routines
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin, UCL, Reading 1993-2017
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin, UCL, Reading 1993-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -221,6 +221,33 @@
 -  V1.94 30.11.15 Make use of blMAXCHAINLABEL
 -  V1.95 11.08.16 Added blBuildResSpec()
 -  V1.96 30.09.17 Added blDeleteResiduePDB()
+-  V1.97 18.10.26 Added PDBSTREAM and blStreamPDB()
+-  V1.98 18.10.26 Added PDBENSEMBLE, PDBMODELINDEX and routines to use
+                  them
+-  V1.99 18.10.26 Added blDoReadMMCIF() and blReadWholeMMCIF()
+-  V2.00 18.10.26 Added blWriteWholePDBBinary() and blReadWholePDBBinary()
+-  V2.01 18.10.26 Added PDBREADSTATE, blDoReadPDBState() and PDBBATCH
+                  with routines to read a batch of files in parallel
+-  V2.02 18.10.26 Added HEADERINDEX to WHOLEPDB and routines to use it
+-  V2.03 18.10.26 Added PDBREADOPTIONS and routines to read selected
+                  atoms and fields
+-  V2.04 18.10.26 Added arena allocation of PDB linked lists
+-  V2.05 18.10.26 Added PDBCOORDS and routines to use it
+-  V2.06 18.10.26 Added COMPACTPDB
+-  V2.07 18.10.26 Added RESIDUEINDEX and gPDBResidueIndex
+-  V2.08 18.10.26 Added name codes to PDB
+-  V2.09 18.10.26 Added PDBATOMINDEX and gPDBAtomIndex
+-  V2.10 18.10.26 Added PDBSELECTION and the ...AsView() routines
+-  V2.11 18.10.26 Added PDBGRID
+-  V2.12 18.10.26 Added PDBINDEXES. The residue index is attached to its
+                  list rather than held in gPDBResidueIndex
+-  V2.13 18.10.26 The atom index is attached to its list rather than
+                  held in gPDBAtomIndex
+-  V2.14 18.10.26 Removed PDBNAMEMATCH(). ISHETATM() and ISATOMREC()
+                  compare the record type. Added blCheckPDBNameCode()
+-  V2.15 18.10.26 Added RESIDIS()
+-  V2.16 18.10.26 The name codes are authoritative once set. Restored
+                  PDBNAMEMATCH() and removed blCheckPDBNameCode()
 
 *************************************************************************/
 #ifndef _PDB_H
@@ -305,6 +332,7 @@ typedef struct pdb_entry
    APTR extras;              /* Pointer for users to add information    */
    blATOMINFO *atomInfo;     /* Reserved for future use                 */
    struct pdb_entry *next;   /* Forward linked list                     */
+   struct pdb_indexes *indexes; /* Indexes of the list (or NULL)        */
    struct pdb_entry *conect[MAXCONECT];  /* CONECT record links         */
    int  atnum;               /* Atom number                             */
    int  resnum;              /* Residue number                          */
@@ -312,6 +340,10 @@ typedef struct pdb_entry
    int  nConect;             /* Number of conections                    */
    int  entity_id;           /* Entity ID - used in XML files           */
    int  atomtype;            /* See ATOMTYPE_XXXX                       */
+   short record_code,        /* Codes for record_type, atnam, resnam    */
+         atnam_code,         /* and element. See PDBNAME_XXXX and       */
+         resnam_code,        /* blSetPDBNameCodes()                     */
+         element_code;
    char record_type[8];      /* ATOM / HETATM                  [MIN 7]  */
    char atnam[8];            /* Atom name, left justified      [MIN 6]  */
    char atnam_raw[8];        /* Atom name as it appears in the PDB file
@@ -351,8 +383,123 @@ typedef struct
    PDB      *pdb;
    PDBCHAIN *chains;
    APTR     *extras;
+   ARENA    *arena;      /* Holds the chains and residues               */
 } PDBSTRUCT;
 
+/* Coordinates of the atoms in a PDB linked list as separate arrays.
+   atoms[i] is the atom whose coordinates are x[i], y[i] and z[i]
+*/
+typedef struct
+{
+   REAL *x, *y, *z;
+   PDB  **atoms;
+   int  natoms;
+}  PDBCOORDS;
+
+/* Compact form of an atom. The names are indexes into the names table 
+   of the COMPACTPDB that holds the atom
+*/
+typedef struct
+{
+   float          x, y, z,
+                  occ, bval;
+   int            atnum,
+                  resnum,
+                  entity_id;
+   unsigned short record_type, atnam, atnam_raw, resnam, insert, chain,
+                  element, segid;
+   signed char    formal_charge;
+   char           atomtype,
+                  altpos,
+                  secstr;
+}  COMPACTATOM;
+
+/* A CONECT from one atom of a COMPACTPDB to another                    */
+typedef struct
+{
+   int atom,
+       partner;
+}  COMPACTCONECT;
+
+#define COMPACT_MAXNAMES 65535  /* Max different names in a COMPACTPDB  */
+
+/* Compact copy of a PDB linked list. The CONECTs are sorted by atom    */
+typedef struct
+{
+   COMPACTATOM   *atoms;
+   COMPACTCONECT *conects;
+   char          **names;
+   int           natoms,
+                 nconects,
+                 nnames;
+}  COMPACTPDB;
+
+/* Hashed index of the residues in a PDB linked list                    */
+typedef struct
+{
+   PDB  *start,                 /* First atom of the residue            */
+        *next;                  /* First atom of the following residue  */
+   BOOL repeated;               /* Residue appears again later          */
+}  RESINDEXENTRY;
+
+typedef struct
+{
+   PDB           *pdb;          /* Linked list that was indexed         */
+   HASHTABLE     *hash;         /* Maps residue ID to RESINDEXENTRY     */
+   RESINDEXENTRY *residues;
+   int           nresidues;
+}  RESIDUEINDEX;
+
+/* Index of the atoms in a PDB linked list by position and atom number  */
+typedef struct
+{
+   PDB  *pdb,                   /* Linked list that was indexed         */
+        **atoms,                /* Atoms in list order. NULL if removed */
+        **byAtnum;              /* Atoms indexed by atom number         */
+   int  *slots,                 /* Entry in atoms[] for each byAtnum[]  */
+        natoms,                 /* Number of atoms in the list          */
+        nslots,                 /* Entries used in atoms[]              */
+        maxslots,               /* Entries allocated in atoms[]         */
+        atnumSize,              /* Entries allocated in byAtnum[]       */
+        hint;                   /* Where to start looking for an atom   */
+}  PDBATOMINDEX;
+
+/* Indexes attached to a PDB linked list. Every atom in the list points
+   to this from its indexes field
+*/
+typedef struct pdb_indexes
+{
+   PDB          *pdb;           /* First atom of the list               */
+   RESIDUEINDEX *residues;      /* Residue index (or NULL)              */
+   PDBATOMINDEX *atoms;         /* Atom index (or NULL)                 */
+}  PDBINDEXES;
+
+/* A selection of the atoms in a PDB linked list. The atoms are not
+   copied; atoms[] points to them in the list
+*/
+typedef struct
+{
+   PDB  *pdb,                   /* Linked list the atoms belong to      */
+        **atoms;                /* Selected atoms in list order         */
+   int  natoms,                 /* Number of atoms selected             */
+        maxatoms;               /* Entries allocated in atoms[]         */
+}  PDBSELECTION;
+
+/* Uniform grid of the atoms in a PDB linked list. The atoms of cell c
+   are entries cellStart[c] to cellStart[c+1]-1 of x, y, z and order
+*/
+typedef struct
+{
+   PDB   **atoms;               /* Atoms in list order                  */
+   REAL  *x, *y, *z,            /* Coordinates in cell order            */
+         cellSize;              /* Length of the side of a cell         */
+   int   *order,                /* Position in atoms[] in cell order    */
+         *cellStart,            /* First entry of each cell             */
+         natoms,                /* Number of atoms in the list          */
+         nx, ny, nz;            /* Number of cells along each axis      */
+   VEC3F min;                   /* Corner of the grid                   */
+}  PDBGRID;
+
 
 #define SELECT(x,w) (x) = (char *)malloc(5 * sizeof(char)); \
                     if((x) != NULL) strncpy((x),(w),5)
@@ -369,14 +516,107 @@ typedef struct sec_entry
    char type;
 }  SECSTRUC;
 
+/* Index of the record types in a WHOLEPDB header. The contents are
+   private to WholePDBHeaderIndex.c
+*/
+typedef struct _headerindex HEADERINDEX;
+
 typedef struct _wholepdb
 {
-   PDB        *pdb;
-   STRINGLIST *header;
-   STRINGLIST *trailer;
-   int        natoms;
+   PDB         *pdb;
+   STRINGLIST  *header;
+   STRINGLIST  *trailer;
+   HEADERINDEX *headerIndex;
+   ARENA       *arena;     /* If not NULL, the atoms, header and trailer
+                              were allocated from this arena            */
+   int         natoms;
 }  WHOLEPDB;
 
+/* Callbacks and options for blStreamPDB(). Any callback may be NULL.
+   A callback returns FALSE to stop reading
+*/
+typedef struct
+{
+   BOOL (*model)(int model, APTR user);   /* Start of a model           */
+   BOOL (*residue)(PDB *p, APTR user);    /* First atom of a residue    */
+   BOOL (*atom)(PDB *p, APTR user);       /* Every atom                 */
+   BOOL AllAtoms;                         /* Include HETATMs            */
+   int  OccRank;                          /* As for blReadPDBOccRank()  */
+}  PDBSTREAM;
+
+/* All models of a file: the atoms of the first model and the 
+   coordinates of every model (x,y,z of atom i in model m are at
+   coords[3*((m-1)*natoms+i)])
+*/
+typedef struct
+{
+   PDB  *pdb;
+   REAL *coords;
+   int  natoms,
+        nmodels;
+}  PDBENSEMBLE;
+
+/* File offsets of the models in a PDB file                             */
+typedef struct
+{
+   long *offset;
+   int  nmodels;
+}  PDBMODELINDEX;
+
+/* Flags describing a file read by blDoReadPDBState(). blDoReadPDB() 
+   copies these to gPDBPartialOcc, gPDBXML, gPDBModelNotFound and
+   gPDBMultiNMR
+*/
+typedef struct
+{
+   BOOL partialOcc,
+        xml,
+        modelNotFound;
+   int  multiNMR;
+}  PDBREADSTATE;
+
+/* Record types and fields for PDBREADOPTIONS. The record type, atom
+   name, alternate position, chain, residue number, insert code and 
+   occupancy are always decoded since the reader needs them
+*/
+#define PDBRECORD_ATOM    0x0001
+#define PDBRECORD_HETATM  0x0002
+
+#define PDBFIELD_ATNUM    0x0001  /* Atom number (needed for CONECTs)   */
+#define PDBFIELD_RESNAM   0x0002  /* Residue name                       */
+#define PDBFIELD_COORDS   0x0004  /* x, y and z                         */
+#define PDBFIELD_BVAL     0x0008  /* B-value                            */
+#define PDBFIELD_SEGID    0x0010  /* Segment ID                         */
+#define PDBFIELD_ELEMENT  0x0020  /* Element and charge                 */
+#define PDBFIELD_ALL      0x003F
+
+/* Atoms and fields to be read by blReadPDBOptions() and 
+   blDoReadPDBOptions(). Set the defaults (as blReadPDB()) with 
+   blInitPDBReadOptions() and then change those required. Atoms must 
+   pass all the filters that are set. Fields which are not read are
+   left as set by CLEAR_PDB()
+*/
+typedef struct
+{
+   char **chains,         /* Chain labels to read (NULL = all)          */
+        **atnams,         /* Atom names, which may have wildcards as for
+                             blAtomNameMatch() (NULL = all)             */
+        *firstRes,        /* Residue zone as residue specifications;    */
+        *lastRes;         /*    NULL = all, lastRes NULL = firstRes     */
+   int  nchains,
+        natnams,
+        records,          /* PDBRECORD_ flags                           */
+        fields,           /* PDBFIELD_ flags                            */
+        OccRank,          /* As for blReadPDBOccRank()                  */
+        ModelNum;         /* Model to read (0 = all)                    */
+   ARENA *arena;          /* Arena for the atoms (NULL = malloc())      */
+}  PDBREADOPTIONS;
+
+/* A batch of files being read by worker threads. The contents are 
+   private to PDBBatch.c
+*/
+typedef struct _pdbbatch PDBBATCH;
+
 typedef struct _compnd
 {
    int   molid;
@@ -469,6 +709,7 @@ typedef struct
                      p->altpos = ' ';                    \
                      p->occ = 0.0; p->bval = 0.0;        \
                      p->next = NULL;                     \
+                     p->indexes = NULL;                  \
                      p->extras = NULL;                   \
                      p->access = 0.0;                    \
                      p->radius = 0.0;                    \
@@ -480,6 +721,10 @@ typedef struct
                      p->nConect = 0;                     \
                      p->atomInfo = NULL;                 \
                      p->atomtype = 0;                    \
+                     p->record_code  = PDBNAME_UNKNOWN;  \
+                     p->atnam_code   = PDBNAME_UNKNOWN;  \
+                     p->resnam_code  = PDBNAME_UNKNOWN;  \
+                     p->element_code = PDBNAME_UNKNOWN;  \
                      p->secstr = ' ';                    \
                      p->entity_id = 0;
  
@@ -551,6 +796,11 @@ typedef struct
 #define RESIDMATCH(p, q) (((p)->resnum == (q)->resnum) &&                \
                           (!strcmp((p)->chain,  (q)->chain)) &&          \
                           (!strcmp((p)->insert, (q)->insert)))
+
+/* Determines whether a record has the given residue identifier         */
+#define RESIDIS(p, ch, num, ins) (((p)->resnum == (num)) &&              \
+                                  (!strcmp((p)->chain,  (ch))) &&        \
+                                  (!strcmp((p)->insert, (ins))))
    
 /* These are the types returned by ResolPDB()                           */
 #define STRUCTURE_TYPE_UNKNOWN   0
@@ -605,6 +855,34 @@ typedef struct
 #define ATOMTYPE_BOUNDHET     (10 | ATOMTYPE_NONRESIDUE)
 #define ATOMTYPE_BOUNDPOLYHET (11 | ATOMTYPE_NONRESIDUE)
 
+/* Name codes. These must match the start of sNames[] in PDBNameCodes.c */
+#define PDBNAME_UNKNOWN       0
+#define PDBNAME_ATOM          1
+#define PDBNAME_HETATM        2
+#define PDBNAME_N             3
+#define PDBNAME_CA            4
+#define PDBNAME_C             5
+#define PDBNAME_O             6
+#define PDBNAME_CB            7
+#define PDBNAME_OXT           8
+#define PDBNAME_NTER          9
+#define PDBNAME_CTER          10
+#define PDBNAME_HOH           11
+
+/* Compares a name with the code if it is set, or with strncmp() if not
+   e.g. PDBNAMEMATCH(p->atnam_code, p->atnam, PDBNAME_CA, "CA  ", 4)
+   A code which has been set is trusted without looking at the name, so
+   code which changes record_type, atnam, resnam or element must call
+   blSetPDBNameCodes() afterwards.
+*/
+#define PDBNAMEMATCH(pcode, pname, code, name, n)                       \
+   (((pcode) != PDBNAME_UNKNOWN) ? ((pcode) == (code)) :                \
+                                   !strncmp((pname), (name), (n)))
+#define ISHETATM(p) PDBNAMEMATCH((p)->record_code, (p)->record_type,    \
+                                 PDBNAME_HETATM, "HETATM", 6)
+#define ISATOMREC(p) PDBNAMEMATCH((p)->record_code, (p)->record_type,   \
+                                  PDBNAME_ATOM, "ATOM  ", 6)
+
 
 /************************************************************************/
 /* Globals
@@ -646,7 +924,29 @@ WHOLEPDB *blDoReadPDB(FILE *fp, BOOL AllAtoms, int OccRank,
                       int ModelNum, BOOL DoWhole);
 WHOLEPDB *blDoReadPDBML(FILE *fp, BOOL AllAtoms, int OccRank, 
                         int ModelNum, BOOL DoWhole);
+int blStreamPDB(FILE *fp, PDBSTREAM *callbacks, APTR user);
+PDBENSEMBLE *blReadPDBEnsemble(FILE *fp, BOOL AllAtoms, int OccRank);
+BOOL blSetPDBEnsembleModel(PDBENSEMBLE *ens, int model);
+void blFreePDBEnsemble(PDBENSEMBLE *ens);
+PDBMODELINDEX *blIndexPDBModels(FILE *fp);
+WHOLEPDB *blDoReadPDBState(FILE *fpin, BOOL AllAtoms, int OccRank, 
+                           int ModelNum, BOOL DoWhole, 
+                           PDBREADSTATE *state);
+void blInitPDBReadOptions(PDBREADOPTIONS *options);
+PDB *blReadPDBOptions(FILE *fp, PDBREADOPTIONS *options, int *natom);
+WHOLEPDB *blDoReadPDBOptions(FILE *fpin, PDBREADOPTIONS *options,
+                             BOOL DoWhole, PDBREADSTATE *state);
+PDBBATCH *blOpenPDBBatch(char **filenames, int nfiles, int nthreads,
+                         int maxInFlight, BOOL inOrder);
+BOOL blGetPDBBatch(PDBBATCH *batch, WHOLEPDB **wpdb, int *index,
+                   PDBREADSTATE *state);
+void blClosePDBBatch(PDBBATCH *batch);
+PDB *blReadPDBModelIndexed(FILE *fp, PDBMODELINDEX *index, int model,
+                           BOOL AllAtoms, int OccRank, int *natoms);
+void blFreePDBModelIndex(PDBMODELINDEX *index);
 BOOL blCheckFileFormatPDBML(FILE *fp);
+WHOLEPDB *blDoReadMMCIF(FILE *fp, BOOL AllAtoms, int OccRank, 
+                        int ModelNum, BOOL DoWhole);
 
 int  blWritePDB(FILE *fp, PDB  *pdb);
 int  blWritePDBAsPDBorGromos(FILE *fp, PDB  *pdb, BOOL doGromos);
@@ -700,7 +1000,10 @@ int blHAddPDB(FILE *fp, PDB *pdb);
 int blReadPGP(FILE *fp);
 FILE *blOpenPGPFile(char *pgpfile, BOOL AllHyd);
 PDB *blSelectAtomsPDBAsCopy(PDB *pdbin, int nsel, char **sel, int *natom);
+PDB *blSelectAtomsPDBAsCopyArena(PDB *pdbin, int nsel, char **sel, 
+                                 int *natom, ARENA *arena);
 PDB *blStripHPDBAsCopy(PDB *pdbin, int *natom);
+PDB *blStripHPDBAsCopyArena(PDB *pdbin, int *natom, ARENA *arena);
 SECSTRUC *blReadSecPDB(FILE *fp, int *nsec);
 SECSTRUC *blReadSecWholePDB(WHOLEPDB *wpdb, int *nsec);
 void blRenumAtomsPDB(PDB *pdb, int offset);
@@ -751,10 +1054,12 @@ char *blFNam2PDB(char *filename);
 PDB *blTermPDB(PDB *pdb, int length);
 char **blGetPDBChainLabels(PDB *pdb, int *nchains);
 PDB *blGetPDBChainAsCopy(PDB *pdbin, char *chain);
+PDB *blGetPDBChainAsCopyArena(PDB *pdbin, char *chain, ARENA *arena);
 PDB *blFindHetatmResidueSpec(PDB *pdb, char *resspec);
 PDB *blFindResidueSpec(PDB *pdb, char *resspec);
 PDB *blFindNextResidue(PDB *pdb);
 PDB *blDupePDB(PDB *in);
+PDB *blDupePDBArena(PDB *in, ARENA *arena);
 BOOL blCopyPDBCoords(PDB *out, PDB *in);
 void blCalcCellTrans(VEC3F UnitCell, VEC3F CellAngles, 
                      VEC3F *xtrans, VEC3F *ytrans, VEC3F *ztrans);
@@ -797,16 +1102,92 @@ char *blFixAtomName(char *name, REAL occup);
 void blFreeWholePDB(WHOLEPDB *wpdb);
 WHOLEPDB *blReadWholePDB(FILE *fpin);
 WHOLEPDB *blReadWholePDBAtoms(FILE *fpin);
+WHOLEPDB *blReadWholeMMCIF(FILE *fpin);
+BOOL blWriteWholePDBBinary(FILE *fp, WHOLEPDB *wpdb);
+WHOLEPDB *blReadWholePDBBinary(FILE *fp);
+BOOL blIndexWholePDBHeader(WHOLEPDB *wpdb);
+void blFreeWholePDBHeaderIndex(WHOLEPDB *wpdb);
+STRINGLIST *blGetHeaderRecordsWholePDB(WHOLEPDB *wpdb, char *type,
+                                       STRINGLIST **stop);
+STRINGLIST *blGetHeaderSpanWholePDB(WHOLEPDB *wpdb, char **types,
+                                    STRINGLIST **stop);
 BOOL blAddCBtoGly(PDB *pdb);
 BOOL blAddCBtoAllGly(PDB *pdb);
 PDB *blStripGlyCB(PDB *pdb);
 PDB *blRemoveAlternates(PDB *pdb);
+PDB *blRemoveAlternatesArena(PDB *pdb, ARENA *arena);
 PDB *blBuildAtomNeighbourPDBListAsCopy(PDB *pdb, PDB *pRes, 
                                        REAL NeighbDist);
 PDB *blFindAtomWildcardInRes(PDB *pdb, char *pattern);
 PDB *blDupeResiduePDB(PDB *in);
 PDB *blStripWatersPDBAsCopy(PDB *pdbin, int *natom);
+PDB *blStripWatersPDBAsCopyArena(PDB *pdbin, int *natom, ARENA *arena);
 PDBSTRUCT *blAllocPDBStructure(PDB *pdb);
+PDBCOORDS *blAllocPDBCoords(PDB *pdb);
+void blFreePDBCoords(PDBCOORDS *coords);
+void blGetPDBCoords(PDBCOORDS *coords);
+void blPutPDBCoords(PDBCOORDS *coords);
+int blGetCofGPDBCoords(PDBCOORDS *coords, VEC3F *cg);
+void blTranslatePDBCoords(PDBCOORDS *coords, VEC3F tvect);
+void blApplyMatrixPDBCoords(PDBCOORDS *coords, REAL matrix[3][3]);
+void blRotatePDBCoords(PDBCOORDS *coords, REAL matrix[3][3]);
+REAL blCalcRMSPDBCoords(PDBCOORDS *coords1, PDBCOORDS *coords2);
+int blFindAtomsInRangePDBCoords(PDBCOORDS *coords, VEC3F centre,
+                                REAL dist, int *indices);
+COMPACTPDB *blCompactPDB(PDB *pdb);
+PDB *blExpandCompactPDB(COMPACTPDB *cpdb, int *natoms);
+PDB *blGetCompactAtom(COMPACTPDB *cpdb, int atom, PDB *pdb);
+void blFreeCompactPDB(COMPACTPDB *cpdb);
+RESIDUEINDEX *blBuildResidueIndex(PDB *pdb);
+PDB *blFindResidueInIndex(RESIDUEINDEX *index, char *chain, int resnum,
+                          char *insert, PDB **nextres);
+void blFreeResidueIndex(RESIDUEINDEX *index);
+BOOL blRemoveFromResidueIndex(RESIDUEINDEX *index, PDB *atom, PDB *prev);
+BOOL blAttachResidueIndex(PDB *pdb);
+RESIDUEINDEX *blGetResidueIndex(PDB *pdb);
+void blDetachPDBIndexes(PDB *pdb);
+void blRemoveFromPDBIndexes(PDB *atom, PDB *prev);
+void blAppendToPDBIndexes(PDB *last, PDB *first);
+BOOL blAttachPDBAtomIndex(PDB *pdb);
+PDBATOMINDEX *blGetPDBAtomIndex(PDB *pdb);
+void blInitPDBNameCodes(void);
+int blGetPDBNameCode(char *name);
+char *blGetPDBNameFromCode(int code);
+void blSetPDBNameCodes(PDB *p);
+char blThronePDB(PDB *p, BOOL DoAsxGlx);
+PDBATOMINDEX *blBuildPDBAtomIndex(PDB *pdb);
+PDB *blGetPDBAtomByPosition(PDBATOMINDEX *index, int n);
+PDB *blGetPDBAtomByNumber(PDBATOMINDEX *index, int atnum);
+BOOL blAppendToPDBAtomIndex(PDBATOMINDEX *index, PDB *first);
+BOOL blRemoveFromPDBAtomIndex(PDBATOMINDEX *index, PDB *atom, PDB **prev);
+BOOL blGetPDBAtomBefore(PDBATOMINDEX *index, PDB *atom, PDB **prev);
+BOOL blUpdatePDBAtomIndexNumbers(PDBATOMINDEX *index);
+void blFreePDBAtomIndex(PDBATOMINDEX *index);
+PDBSELECTION *blAllocPDBSelection(PDB *pdb);
+BOOL blAddAtomToPDBSelection(PDBSELECTION *sel, PDB *atom);
+void blFreePDBSelection(PDBSELECTION *sel);
+PDBSELECTION *blSelectAtomsPDBAsView(PDB *pdbin, int nsel, char **sel);
+PDBSELECTION *blGetPDBChainAsView(PDB *pdbin, char *chain);
+PDBSELECTION *blExtractZonePDBAsView(PDB *inpdb, char *chain1,
+                                     int resnum1, char *insert1,
+                                     char *chain2, int resnum2,
+                                     char *insert2);
+PDBSELECTION *blStripHPDBAsView(PDB *pdbin);
+PDBSELECTION *blStripWatersPDBAsView(PDB *pdbin);
+int blGetCofGPDBSelection(PDBSELECTION *sel, VEC3F *cg);
+int blGetPDBSelectionCoor(PDBSELECTION *sel, VEC3F *origin, COOR **coor);
+REAL blCalcRMSPDBSelection(PDBSELECTION *sel1, PDBSELECTION *sel2);
+int blWritePDBSelection(FILE *fp, PDBSELECTION *sel);
+PDBGRID *blBuildPDBGrid(PDB *pdb, REAL cellSize);
+void blFreePDBGrid(PDBGRID *grid);
+int blFindAtomsInRangePDBGrid(PDBGRID *grid, VEC3F centre, REAL dist,
+                              int *indices);
+int blFindNearestAtomsPDBGrid(PDBGRID *grid, VEC3F centre, int k,
+                              int *indices, REAL *distsq);
+int blForEachPairPDBGrid(PDBGRID *grid, REAL dist,
+                         BOOL (*func)(int i, int j, REAL distsq,
+                                      APTR user),
+                         APTR user);
 PDB *blFindNextChain(PDB *pdb);
 void blFreePDBStructure(PDBSTRUCT *pdbstruct);
 void blSetElementSymbolFromAtomName(char *element, char * atom_name);
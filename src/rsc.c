@@ -3,11 +3,11 @@
 
    \file       rsc.c
    
-   \version    V1.17
-   \date       23.03.17
+   \version    V1.19
+   \date       18.10.26
    \brief      Modify sequence of a PDB linked list
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-2017
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -76,6 +76,9 @@
 -  V1.15 25.02.15 Sets the element type for new atoms
 -  V1.16 14.12.16 FixTorsions() checks return from blCalcChi()
 -  V1.17 23.03.17 Better handling of missing atoms in the PDB file
+-  V1.18 18.10.26 ReadRefCoords() sets name codes
+-  V1.19 18.10.26 Detaches any indexes of the list before replacing
+                  sidechains
 
 *************************************************************************/
 /* Defines required for includes
@@ -188,6 +191,7 @@ static BOOL gotCBeta(PDB *ResStart, PDB *NextRes);
             call instead of just the first one.
 -  07.07.14 Use bl prefix for functions By: CTP
 -  23.02.15 Modified for new blRenumAtomsPDB() which takes an offset
+-  18.10.26 Detaches any indexes of the list
 
 */
 BOOL blRepSChain(PDB  *pdb,         /* PDB linked list                  */
@@ -202,6 +206,8 @@ BOOL blRepSChain(PDB  *pdb,         /* PDB linked list                  */
          *ResStart,                 /* Start of residue                 */
          *NextRes;                  /* Start of next residue            */
    BOOL   noenv = FALSE;            /* Flag for no env. var. found      */
+
+   blDetachPDBIndexes(pdb);
    
    if(sFirstCall)
    {
@@ -383,6 +389,7 @@ BOOL blRepOneSChainForce(PDB *pdb, char *ResSpec, char aa,
 -  23.02.15 Modified for new blRenumAtomsPDB() which takes an offset
 -  29.09.15 Renamed as doRepOneSChain() and wrappers written as
             blRepOneSChain() and blRepOneSChainForce()
+-  18.10.26 Detaches any indexes of the list
 */
 static BOOL doRepOneSChain(PDB *pdb, char *ResSpec, char aa, 
                            char *ChiTable, char *RefCoords, BOOL force)
@@ -390,6 +397,8 @@ static BOOL doRepOneSChain(PDB *pdb, char *ResSpec, char aa,
    PDB   *ResStart,                 /* Start of residue                 */
          *NextRes;                  /* Start of next residue            */
    BOOL  noenv = FALSE;             /* Flag for no env. var. found      */
+
+   blDetachPDBIndexes(pdb);
    
    if(sFirstCall)
    {
@@ -1164,6 +1173,7 @@ Cleanup:
 -  03.06.05 Sets altpos
 -  05.08.14 Use CLEAR_PDB() to set default values. By: CTP
 -  25.02.15 Now sets the element type   By: ACRM
+-  18.10.26 Sets name codes
 */
 static PDB *ReadRefCoords(FILE *fp,
                           char seq)
@@ -1275,6 +1285,7 @@ static PDB *ReadRefCoords(FILE *fp,
 
          /* 25.02.15 Set the element type from atnam_raw                */
          blSetElementSymbolFromAtomName(p->element, p->atnam_raw);
+         blSetPDBNameCodes(p);                  /* 18.10.26             */
          
          done = TRUE;
       }
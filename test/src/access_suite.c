@@ -0,0 +1,347 @@
+/************************************************************************/
+/**
+
+   \file       access_suite.c
+   
+   \version    V1.3
+   \date       18.10.26
+   \brief      Test suite for the accessibility routines.
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for the accessibility routines.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  18.10.26 Original
+-  V1.1  18.10.26 Added test_shrake_rupley
+-  V1.2  18.10.26 Added test_context
+-  V1.3  18.10.26 Added test_workspace
+
+*************************************************************************/
+
+#include <math.h>
+#include "access_suite.h"
+
+/* Globals */
+static char test_input_filename[] = "data/test-deca-ala-01.pdb";
+
+static PDB *pdb    = NULL;
+static int natoms  = 0;
+
+/* Checks that the areas from a context are those from a full
+   calculation
+*/
+static BOOL same_as_full(void)
+{
+   PDB  *p;
+   REAL *area;
+   int  i,
+        n = 0;
+   BOOL same = TRUE;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+      n++;
+   if((area = (REAL *)malloc(n * sizeof(REAL))) == NULL)
+      return(FALSE);
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+      area[i] = p->access;
+
+   if(!blCalcAccess(pdb, n, 0.0, 1.4, TRUE))
+      same = FALSE;
+   for(p=pdb, i=0; same && (p!=NULL); NEXT(p), i++)
+   {
+      if(fabs(p->access - area[i]) > 0.000001)
+         same = FALSE;
+   }
+
+   free(area);
+   return(same);
+}
+
+/* Setup And Teardown */
+static void access_setup(void)
+{
+   FILE *fp;
+   PDB  *p;
+
+   if((fp = fopen(test_input_filename, "r")) != NULL)
+   {
+      pdb = blReadPDB(fp, &natoms);
+      fclose(fp);
+   }
+
+   /* Radii as used for atoms not in a radius file                      */
+   for(p=pdb; p!=NULL; NEXT(p))
+      p->radius = (p->atnam[0] == 'O') ? 1.40 : 1.80;
+}
+
+static void access_teardown(void)
+{
+   FREELIST(pdb, PDB);
+   pdb = NULL;
+}
+
+/* Core tests */
+START_TEST(test_single_atom)
+{
+   PDB *next;
+
+   ck_assert_msg(pdb != NULL, "Failed to read PDB file.");
+
+   /* An isolated atom is accessible over the whole probe sphere        */
+   next      = pdb->next;
+   pdb->next = NULL;
+   ck_assert_msg(blCalcAccess(pdb, 1, 0.0, 1.4, TRUE), "Calc failed.");
+   ck_assert_msg(fabs(pdb->access - 4.0 * PI * 3.2 * 3.2) < 0.0001,
+                 "Wrong area for single atom.");
+   pdb->next = next;
+}
+END_TEST
+
+START_TEST(test_threaded)
+{
+   PDB  *p;
+   REAL *area;
+   int  i,
+        nthreads;
+
+   ck_assert_msg(pdb != NULL, "Failed to read PDB file.");
+   area = (REAL *)malloc(natoms * sizeof(REAL));
+   ck_assert_msg(area != NULL, "No memory.");
+
+   ck_assert_msg(blCalcAccess(pdb, natoms, 0.0, 1.4, TRUE),
+                 "Calc failed.");
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      ck_assert_msg(p->access >= 0.0, "Negative area.");
+      area[i] = p->access;
+   }
+
+   /* Threads give exactly the same areas                               */
+   for(nthreads=2; nthreads<=8; nthreads*=2)
+   {
+      for(p=pdb; p!=NULL; NEXT(p))
+         p->access = -1.0;
+      ck_assert_msg(blCalcAccessThreaded(pdb, natoms, 0.0, 1.4, TRUE,
+                                         nthreads),
+                    "Threaded calc failed.");
+      for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+         ck_assert_msg(p->access == area[i], "Threaded area differs.");
+   }
+
+   free(area);
+}
+END_TEST
+
+START_TEST(test_shrake_rupley)
+{
+   PDB  *p;
+   REAL *area,
+        totalLR = 0.0,
+        totalSR = 0.0;
+   int  i;
+
+   ck_assert_msg(pdb != NULL, "Failed to read PDB file.");
+   area = (REAL *)malloc(natoms * sizeof(REAL));
+   ck_assert_msg(area != NULL, "No memory.");
+
+   ck_assert_msg(blCalcAccess(pdb, natoms, 0.0, 1.4, TRUE),
+                 "Calc failed.");
+   for(p=pdb; p!=NULL; NEXT(p))
+      totalLR += p->access;
+
+   ck_assert_msg(blCalcAccessMethod(pdb, natoms, ACCESS_SHRAKE_RUPLEY,
+                                    0.0, 0, 1.4, TRUE, 1),
+                 "Shrake-Rupley calc failed.");
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      ck_assert_msg(p->access >= 0.0, "Negative area.");
+      totalSR += p->access;
+      area[i]  = p->access;
+   }
+
+   /* The two methods agree to within the accuracy of the sampling      */
+   ck_assert_msg(fabs(totalSR - totalLR) < 0.01 * totalLR,
+                 "Shrake-Rupley total differs from Lee-Richards.");
+
+   /* Threads give exactly the same areas                               */
+   ck_assert_msg(blCalcAccessMethod(pdb, natoms, ACCESS_SHRAKE_RUPLEY,
+                                    0.0, 0, 1.4, TRUE, 4),
+                 "Threaded Shrake-Rupley calc failed.");
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+      ck_assert_msg(p->access == area[i], "Threaded area differs.");
+
+   /* An isolated atom is accessible at every point                     */
+   p         = pdb->next;
+   pdb->next = NULL;
+   ck_assert_msg(blCalcAccessMethod(pdb, 1, ACCESS_SHRAKE_RUPLEY,
+                                    0.0, 0, 1.4, TRUE, 1),
+                 "Shrake-Rupley calc failed.");
+   ck_assert_msg(fabs(pdb->access - 4.0 * PI * 3.2 * 3.2) < 0.0001,
+                 "Wrong area for single atom.");
+   pdb->next = p;
+
+   ck_assert_msg(!blCalcAccessMethod(pdb, natoms, -1, 0.0, 0, 1.4,
+                                     TRUE, 1),
+                 "Invalid method accepted.");
+
+   free(area);
+}
+END_TEST
+
+START_TEST(test_context)
+{
+   ACCESSCONTEXT *context;
+   PDB           *res, *nextRes, *p, *prev;
+
+   ck_assert_msg(pdb != NULL, "Failed to read PDB file.");
+   context = blInitAccessContext(pdb, ACCESS_LEE_RICHARDS, 0.0, 0, 1.4,
+                                 TRUE, 1);
+   ck_assert_msg(context != NULL, "Init failed.");
+   ck_assert_msg(same_as_full(), "Initial areas differ.");
+
+   /* Move the atoms of the 5th residue                                 */
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      if(p->resnum == 5)
+      {
+         p->x += 1.0;
+         p->z -= 0.5;
+      }
+   }
+   res     = blFindResidue(pdb, "A", 5, " ");
+   nextRes = blFindNextResidue(res);
+   ck_assert_msg(blUpdateAccessContext(context, pdb, res, nextRes),
+                 "Update failed.");
+   ck_assert_msg(same_as_full(), "Areas differ after move.");
+
+   /* Remove the last atom of the 3rd residue                           */
+   res     = blFindResidue(pdb, "A", 3, " ");
+   nextRes = blFindNextResidue(res);
+   for(p=res, prev=NULL; p->next!=nextRes; NEXT(p))
+      prev = p;
+   prev->next = nextRes;
+   free(p);
+   ck_assert_msg(blUpdateAccessContext(context, pdb, res, nextRes),
+                 "Update failed.");
+   ck_assert_msg(same_as_full(), "Areas differ after removal.");
+
+   /* Atoms outside the range that have moved are found                 */
+   pdb->x += 0.7;
+   ck_assert_msg(blUpdateAccessContext(context, pdb, res, nextRes),
+                 "Update failed.");
+   ck_assert_msg(same_as_full(), "Areas differ after unlisted move.");
+
+   blFreeAccessContext(context);
+}
+END_TEST
+
+START_TEST(test_workspace)
+{
+   ACCESSWORKSPACE *workspace;
+   PDB             *p;
+   REAL            *area;
+   int             i,
+                   method;
+
+   ck_assert_msg(pdb != NULL, "Failed to read PDB file.");
+   area = (REAL *)malloc(natoms * sizeof(REAL));
+   ck_assert_msg(area != NULL, "No memory.");
+   workspace = blAllocAccessWorkspace();
+   ck_assert_msg(workspace != NULL, "Alloc failed.");
+
+   /* One workspace gives the same areas for each method, with and
+      without threads, and may be used again for another structure
+   */
+   for(method=ACCESS_LEE_RICHARDS; method<=ACCESS_SHRAKE_RUPLEY;
+       method++)
+   {
+      ck_assert_msg(blCalcAccessMethod(pdb, natoms, method, 0.0, 0, 1.4,
+                                       TRUE, 1),
+                    "Calc failed.");
+      for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+         area[i] = p->access;
+
+      ck_assert_msg(blCalcAccessWorkspace(pdb, natoms, method, 0.0, 0,
+                                          1.4, TRUE, 4, workspace),
+                    "Workspace calc failed.");
+      for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+         ck_assert_msg(p->access == area[i], "Workspace area differs.");
+
+      /* The other atoms left in the workspace are not used             */
+      p         = pdb->next;
+      pdb->next = NULL;
+      ck_assert_msg(blCalcAccessWorkspace(pdb, natoms, method, 0.0, 0,
+                                          1.4, TRUE, 1, workspace),
+                    "Workspace calc failed.");
+      ck_assert_msg(fabs(pdb->access - 4.0 * PI * 3.2 * 3.2) < 0.0001,
+                    "Wrong area for single atom.");
+      pdb->next = p;
+
+      ck_assert_msg(blCalcAccessWorkspace(pdb, natoms, method, 0.0, 0,
+                                          1.4, TRUE, 2, workspace),
+                    "Workspace calc failed.");
+      for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+         ck_assert_msg(p->access == area[i], "Workspace area differs.");
+   }
+
+   blFreeAccessWorkspace(workspace);
+   free(area);
+}
+END_TEST
+
+
+/* Create Suite */
+Suite *access_suite(void)
+{
+   Suite *s = suite_create("Access");
+   TCase *tc_core = tcase_create("Core");
+
+   /* Core test case */
+   tcase_add_checked_fixture(tc_core, 
+                             access_setup, 
+                             access_teardown);
+   tcase_add_test(tc_core, test_single_atom);
+   tcase_add_test(tc_core, test_threaded);
+   tcase_add_test(tc_core, test_shrake_rupley);
+   tcase_add_test(tc_core, test_context);
+   tcase_add_test(tc_core, test_workspace);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
@@ -0,0 +1,71 @@
+/************************************************************************/
+/**
+
+   \file       access_suite.h
+   
+   \version    V1.0
+   \date       18.10.26
+   \brief      Include file for accessibility test suite.
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for the accessibility routines.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  18.10.26 Original
+
+*************************************************************************/
+
+#ifndef _ACCESS_SUITE_H
+#define _ACCESS_SUITE_H
+
+/* Includes for tests */
+#include <stdlib.h>
+#include <check.h>
+
+/* Includes from source file */
+#include "SysDefs.h"
+#include "pdb.h"
+#include "macros.h"
+#include "access.h"
+
+
+/* Prototypes */
+Suite *access_suite(void);
+
+#endif
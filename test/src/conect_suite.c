@@ -3,11 +3,11 @@
 
    \file       conect_suite.c
    
-   \version    V1.0
-   \date       28.04.15
+   \version    V1.2
+   \date       18.10.26
    \brief      Test suite for CONECT data for pdb and pdbml.
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -48,6 +48,8 @@
    Revision History:
    =================
 -  V1.0  28.04.15 Original By: CTP
+-  V1.1  18.10.26 Added test for COMPACTPDB
+-  V1.2  18.10.26 Added test for blBuildConectData()
 
 *************************************************************************/
 
@@ -412,6 +414,118 @@ START_TEST(test_read_write_pdbml)
 END_TEST
 
 
+START_TEST(test_compact_pdb)
+{
+   /* get pdb data */
+   char       filename_in[]      = "test_alanine_in.pdb",
+              filename_example[] = "test_alanine_out_01.pdb",
+              test_message[]     = "Output PDB does not match example file.";
+   COMPACTPDB *cpdb;
+   PDB        *pdb;
+   int        natoms;
+
+   /* Set Default */
+   gPDBXMLForce = FORCEXML_NOFORCE;
+
+   /* read input file */
+   strcat(test_input_filename,filename_in);
+   fp = fopen(test_input_filename,"r");
+   wpdb = blReadWholePDB(fp);
+   fclose(fp);
+   ck_assert_msg(wpdb != NULL, "Failed to read PDB file.");
+
+   /* replace the atoms with a copy made via a COMPACTPDB */
+   cpdb = blCompactPDB(wpdb->pdb);
+   ck_assert_msg(cpdb != NULL,                "Failed to compact PDB.");
+   ck_assert_msg(cpdb->natoms == wpdb->natoms,       "Wrong atom count.");
+   ck_assert_msg(cpdb->nconects > 0,              "CONECTs not stored.");
+   ck_assert_msg(cpdb->nnames < 5 * cpdb->natoms,  "Names not shared.");
+
+   pdb = blExpandCompactPDB(cpdb, &natoms);
+   blFreeCompactPDB(cpdb);
+   ck_assert_msg(pdb != NULL,                  "Failed to expand PDB.");
+   ck_assert_msg(natoms == wpdb->natoms, "Wrong expanded atom count.");
+   FREELIST(wpdb->pdb, PDB);
+   wpdb->pdb = pdb;
+
+#ifndef MS_WINDOWS   
+   /* Set temp file name */
+   mkstemp(test_output_filename);
+#endif
+
+   /* write output file */
+   fp = fopen(test_output_filename,"w");
+   blWriteWholePDB(fp, wpdb);
+   fclose(fp);
+
+   /* compare output file to example file */
+   strcat(test_example_filename, filename_example);
+   files_identical = wholepdb_compare_files(test_example_filename, 
+                                            test_output_filename);
+
+   /* remove output file */
+   remove(test_output_filename);
+  
+   /* return test result */
+   ck_assert_msg(files_identical, test_message);
+}
+END_TEST
+
+
+START_TEST(test_build_conect)
+{
+   char filename_in[] = "test_alanine_in.pdb";
+   PDB  *p,
+        *conect[MAXCONECT * 8];
+   int  nConect[8],
+        i, j;
+
+   /* read input file */
+   strcat(test_input_filename,filename_in);
+   fp = fopen(test_input_filename,"r");
+   wpdb = blReadWholePDB(fp);
+   fclose(fp);
+   ck_assert_msg(wpdb != NULL, "Failed to read PDB file.");
+
+   /* keep the CONECTs read from the file */
+   for(p=wpdb->pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      nConect[i] = p->nConect;
+      for(j=0; j<p->nConect; j++)
+         conect[i * MAXCONECT + j] = p->conect[j];
+   }
+
+   /* atoms in the same residue are not bonded unless they are HETATMs */
+   ck_assert_msg(blBuildConectData(wpdb->pdb, 0.4), "Build failed.");
+   for(p=wpdb->pdb; p!=NULL; NEXT(p))
+      ck_assert_msg(p->nConect == 0,   "CONECT within ATOM residue.");
+
+   /* as HETATMs the same CONECTs are found, in the same order */
+   for(p=wpdb->pdb; p!=NULL; NEXT(p))
+   {
+      strcpy(p->record_type, "HETATM");
+      blSetPDBNameCodes(p);
+   }
+   ck_assert_msg(blBuildConectData(wpdb->pdb, 0.4), "Build failed.");
+   for(p=wpdb->pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      ck_assert_msg(p->nConect == nConect[i], "Wrong number of CONECTs.");
+      for(j=0; j<p->nConect; j++)
+         ck_assert_msg(p->conect[j] == conect[i * MAXCONECT + j],
+                       "Wrong CONECT.");
+   }
+
+   /* an atom without coordinates is still compared with the others */
+   wpdb->pdb->x = wpdb->pdb->y = wpdb->pdb->z = 9999.0;
+   ck_assert_msg(blBuildConectData(wpdb->pdb, 0.4), "Build failed.");
+   ck_assert_msg(wpdb->pdb->nConect == 0, "CONECT to missing atom.");
+   for(p=wpdb->pdb->next, i=1; p!=NULL; NEXT(p), i++)
+      ck_assert_msg(p->nConect == nConect[i] - (i==1 ? 1 : 0),
+                    "Wrong CONECTs with a missing atom.");
+}
+END_TEST
+
+
 /* Create Suite */
 Suite *conect_suite(void)
 {
@@ -430,6 +544,8 @@ Suite *conect_suite(void)
    tcase_add_test(tc_core, test_write_pdbml_02);
    tcase_add_test(tc_core, test_read_write_pdb);
    tcase_add_test(tc_core, test_read_write_pdbml);
+   tcase_add_test(tc_core, test_compact_pdb);
+   tcase_add_test(tc_core, test_build_conect);
    suite_add_tcase(s, tc_core);
 
    /* Add additional tests here */
@@ -3,11 +3,11 @@
 
    \file       findzone_suite.c
    
-   \version    V1.0
-   \date       05.08.14
+   \version    V1.6
+   \date       18.10.26
    \brief      Test suite for blFindZonePDB().
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2014
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -48,6 +48,15 @@
    Revision History:
    =================
 -  V1.0  05.08.14 Original By: CTP
+-  V1.1  18.10.26 Added test using a residue index
+-  V1.2  18.10.26 Added test using an atom index
+-  V1.3  18.10.26 The residue index is attached to the list. Added test
+                  deleting atoms and residues from an indexed list
+-  V1.4  18.10.26 The atom index is attached to the list. Added tests
+                  of an empty range, of an unindexed copy and of both
+                  indexes together
+-  V1.5  18.10.26 Added test of residues renumbered in an indexed list
+-  V1.6  18.10.26 Added test of atoms inserted into an indexed list
 
 *************************************************************************/
 
@@ -97,9 +106,56 @@ void findzone_setup(void)
 void findzone_teardown(void)
 {
    /* Free PDB */
+   blDetachPDBIndexes(pdb_in);
    FREELIST(pdb_in,PDB);
 }
 
+/* Checks that an atom index matches its linked list */
+static BOOL findzone_index_matches(PDBATOMINDEX *index, PDB *pdb)
+{
+   PDB *p;
+   int i;
+
+   if(index->pdb != pdb)
+      return(FALSE);
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      if((blGetPDBAtomByPosition(index, i) != p) ||
+         (blGetPDBAtomByNumber(index, p->atnum) != p))
+         return(FALSE);
+   }
+   return((i == index->natoms) && 
+          (blGetPDBAtomByPosition(index, i) == NULL));
+}
+
+/* Checks that the attached residue index gives the same result as a
+   search of the list for every residue
+*/
+static BOOL findzone_resindex_matches(PDB *pdb)
+{
+   RESIDUEINDEX *index;
+   PDB          *p,
+                *prev,
+                *start = NULL,
+                *nextres = NULL;
+
+   if((index = blGetResidueIndex(pdb)) == NULL)
+      return(FALSE);
+   for(p=pdb, prev=NULL; p!=NULL; prev=p, NEXT(p))
+   {
+      if((prev == NULL) || !RESIDMATCH(p, prev))
+      {
+         if((start != NULL) && (nextres != p))
+            return(FALSE);
+         start = blFindResidueInIndex(index, p->chain, p->resnum,
+                                      p->insert, &nextres);
+         if(start != p)
+            return(FALSE);
+      }
+   }
+   return((start == NULL) || (nextres == NULL));
+}
+
 /* PDB Data Read Test */
 START_TEST(test_read_01)
 {
@@ -451,6 +507,271 @@ START_TEST(test_limit_08)
 END_TEST
 
 
+/* Residue index tests */
+START_TEST(test_index_01)
+{
+   PDB *nextres;
+
+   /* Build and attach an index */
+   ck_assert_msg(pdb_in != NULL,"No pdb data found.");
+   ck_assert_msg(blAttachResidueIndex(pdb_in), "Failed to build index.");
+   ck_assert(blGetResidueIndex(pdb_in) != NULL);
+   ck_assert(blGetResidueIndex(pdb_in->next) == NULL);
+
+   /* Same zones as test_01 and test_02 */
+   mode   = ZONE_MODE_RESNUM;
+   output = blFindZonePDB(pdb_in, 2, " ", 5, " ", "A", mode, 
+                          &pdb_start, &pdb_stop);
+   ck_assert(output           == TRUE);
+   ck_assert(pdb_start        != NULL);
+   ck_assert(pdb_stop         != NULL);
+   ck_assert(pdb_start->atnum ==    6);
+   ck_assert(pdb_stop->atnum  ==   26);
+
+   output = blFindZonePDB(pdb_in, 2, " ", 3, " ", "B", mode, 
+                          &pdb_start, &pdb_stop);
+   ck_assert(output           == TRUE);
+   ck_assert(pdb_start->atnum ==   36);
+   ck_assert(pdb_stop->atnum  ==   46);
+
+   /* Single residues */
+   ck_assert(blFindResidue(pdb_in, "B", 2, " ") == pdb_start);
+   ck_assert(blFindResidue(pdb_in, "B", 99, " ") == NULL);
+   ck_assert(blFindResidueInIndex(blGetResidueIndex(pdb_in), "B", 3,
+                                  " ", &nextres) != NULL);
+   ck_assert(nextres == pdb_stop);
+
+   /* Detaching the index frees it */
+   blDetachPDBIndexes(pdb_in);
+   ck_assert(blGetResidueIndex(pdb_in) == NULL);
+   ck_assert(pdb_in->indexes == NULL);
+}
+END_TEST
+
+START_TEST(test_index_03)
+{
+   PDB *p,
+       *q,
+       *next,
+       *copy;
+   int i;
+
+   ck_assert_msg(pdb_in != NULL,"No pdb data found.");
+   ck_assert_msg(blAttachResidueIndex(pdb_in), "Failed to build index.");
+   ck_assert_msg(blAttachPDBAtomIndex(pdb_in), "Failed to build index.");
+
+   /* Deleting a residue removes it from the index */
+   p    = blFindResidue(pdb_in, "A", 3, " ");
+   next = blDeleteResiduePDB(&pdb_in, p);
+   ck_assert(blFindResidue(pdb_in, "A", 3, " ") == NULL);
+   ck_assert(blFindResidue(pdb_in, "A", 4, " ") == next);
+   ck_assert(findzone_resindex_matches(pdb_in));
+   output = blFindZonePDB(pdb_in, 2, " ", 4, " ", "A", ZONE_MODE_RESNUM,
+                          &pdb_start, &pdb_stop);
+   ck_assert(output == TRUE);
+   ck_assert(pdb_start == blFindResidue(pdb_in, "A", 2, " "));
+   ck_assert(pdb_stop  == blFindResidue(pdb_in, "A", 5, " "));
+
+   /* Deleting the first residue and the first atom of another */
+   blDeleteResiduePDB(&pdb_in, pdb_in);
+   ck_assert(blFindResidue(pdb_in, "A", 1, " ") == NULL);
+   ck_assert(blFindResidue(pdb_in, "A", 2, " ") == pdb_in);
+   pdb_in = blDeleteAtomPDB(pdb_in, pdb_in);
+   ck_assert(blFindResidue(pdb_in, "A", 2, " ") == pdb_in);
+   q = blFindResidue(pdb_in, "B", 2, " ");
+   pdb_in = blDeleteAtomPDB(pdb_in, q);
+   ck_assert(findzone_resindex_matches(pdb_in));
+
+   /* Deleting atoms from the middle and end of residues */
+   q = blFindResidue(pdb_in, "A", 5, " ");
+   pdb_in = blDeleteAtomPDB(pdb_in, q->next);
+   pdb_in = blDeleteAtomRangePDB(pdb_in, q->next, q->next->next->next);
+   for(p=pdb_in; p->next!=NULL; NEXT(p)) ;
+   pdb_in = blDeleteAtomPDB(pdb_in, p);
+   ck_assert(findzone_resindex_matches(pdb_in));
+   ck_assert(findzone_index_matches(blGetPDBAtomIndex(pdb_in), pdb_in));
+
+   /* Adding atoms frees the index, and the list is searched instead */
+   copy = blDupePDB(blFindResidue(pdb_in, "B", 4, " "));
+   for(p=copy, i=0; p!=NULL; NEXT(p), i++)
+   {
+      strcpy(p->chain, "C");
+      p->atnum = 10000 + i;
+   }
+   pdb_in = blAppendPDB(pdb_in, copy);
+   ck_assert(blGetResidueIndex(pdb_in) == NULL);
+   ck_assert(blFindResidue(pdb_in, "C", 4, " ") == copy);
+   ck_assert(copy->indexes == pdb_in->indexes);
+   ck_assert(findzone_index_matches(blGetPDBAtomIndex(pdb_in), pdb_in));
+
+   /* The index can be rebuilt, and is freed with the last atom */
+   ck_assert(blAttachResidueIndex(pdb_in));
+   ck_assert(findzone_resindex_matches(pdb_in));
+   while(pdb_in != NULL)
+      pdb_in = blDeleteAtomPDB(pdb_in, pdb_in);
+}
+END_TEST
+
+START_TEST(test_index_04)
+{
+   PDB  *p,
+        *q,
+        *next,
+        *pdb_start,
+        *pdb_stop;
+   BOOL output;
+
+   ck_assert_msg(pdb_in != NULL,"No pdb data found.");
+
+   /* Renumbering a residue with blSetResnam() detaches the index       */
+   ck_assert_msg(blAttachResidueIndex(pdb_in), "Failed to build index.");
+   p    = blFindResidue(pdb_in, "A", 5, " ");
+   next = blFindNextResidue(p);
+   blSetResnam(p, next, "GLY ", 500, " ", "A");
+   ck_assert(blGetResidueIndex(pdb_in) == NULL);
+   ck_assert(blFindResidue(pdb_in, "A", 500, " ") == p);
+   ck_assert(blFindResidue(pdb_in, "A", 5, " ") == NULL);
+
+   /* A residue renumbered directly is found by searching the list      */
+   ck_assert_msg(blAttachResidueIndex(pdb_in), "Failed to build index.");
+   q    = blFindResidue(pdb_in, "A", 3, " ");
+   next = blFindNextResidue(q);
+   for(p=q; p!=next; NEXT(p))
+      p->resnum = 300;
+   ck_assert(blFindResidue(pdb_in, "A", 3, " ") == NULL);
+   ck_assert(blGetResidueIndex(pdb_in) == NULL);
+   ck_assert(blFindResidue(pdb_in, "A", 300, " ") == q);
+
+   ck_assert_msg(blAttachResidueIndex(pdb_in), "Failed to build index.");
+   for(p=q; p!=next; NEXT(p))
+      p->resnum = 3;
+   output = blFindZonePDB(pdb_in, 300, " ", 4, " ", "A", ZONE_MODE_RESNUM,
+                          &pdb_start, &pdb_stop);
+   ck_assert(output == FALSE);
+   ck_assert(blGetResidueIndex(pdb_in) == NULL);
+   output = blFindZonePDB(pdb_in, 3, " ", 4, " ", "A", ZONE_MODE_RESNUM,
+                          &pdb_start, &pdb_stop);
+   ck_assert(output == TRUE);
+   ck_assert(pdb_start == q);
+   ck_assert(pdb_stop  == blFindResidue(pdb_in, "A", 500, " "));
+}
+END_TEST
+
+START_TEST(test_index_05)
+{
+   PDB *p;
+   int natom = 0,
+       i;
+
+   ck_assert_msg(pdb_in != NULL,"No pdb data found.");
+   for(p=pdb_in; p!=NULL; NEXT(p))
+      natom++;
+
+   /* Adding C-terminal oxygens detaches the indexes                    */
+   ck_assert_msg(blAttachResidueIndex(pdb_in), "Failed to build index.");
+   ck_assert_msg(blAttachPDBAtomIndex(pdb_in), "Failed to build index.");
+   ck_assert(blFixCterPDB(pdb_in, CTER_STYLE_STD));
+   ck_assert(blGetPDBAtomIndex(pdb_in) == NULL);
+   ck_assert(blGetResidueIndex(pdb_in) == NULL);
+   for(p=pdb_in, i=0; p!=NULL; NEXT(p), i++)
+   {
+      ck_assert(p->indexes == NULL);
+      ck_assert(blGetPDBByN(pdb_in, i) == p);
+   }
+   ck_assert(i == natom + 2);
+
+   /* A new index includes the added atoms                              */
+   ck_assert_msg(blAttachPDBAtomIndex(pdb_in), "Failed to build index.");
+   for(p=pdb_in, i=0; p!=NULL; NEXT(p), i++)
+      ck_assert(blGetPDBByN(pdb_in, i) == p);
+   ck_assert(blGetPDBByN(pdb_in, i) == NULL);
+}
+END_TEST
+
+START_TEST(test_index_02)
+{
+   PDB *p,
+       *q,
+       *moved = NULL,
+       *copy,
+       **indx;
+   PDBATOMINDEX *index;
+   int i,
+       natom;
+
+   /* Build and attach an index */
+   ck_assert_msg(pdb_in != NULL,"No pdb data found.");
+   ck_assert_msg(blAttachPDBAtomIndex(pdb_in), "Failed to build index.");
+   index = blGetPDBAtomIndex(pdb_in);
+   ck_assert(index != NULL);
+   ck_assert(findzone_index_matches(index, pdb_in));
+
+   /* Positional access is the same as stepping along the list */
+   for(p=pdb_in, i=0; p!=NULL; NEXT(p), i++)
+      ck_assert(blGetPDBByN(pdb_in, i) == p);
+   ck_assert(blGetPDBByN(pdb_in, i) == NULL);
+
+   /* Deleting atoms, including the first */
+   q = blGetPDBByN(pdb_in, 10);
+   pdb_in = blDeleteAtomPDB(pdb_in, q);
+   pdb_in = blDeleteAtomPDB(pdb_in, pdb_in);
+   pdb_in = blDeleteAtomRangePDB(pdb_in, blGetPDBByN(pdb_in, 3),
+                                 blGetPDBByN(pdb_in, 6));
+   ck_assert(index->natoms == i - 5);
+   ck_assert(findzone_index_matches(index, pdb_in));
+
+   /* An empty range deletes nothing */
+   q = blGetPDBByN(pdb_in, 4);
+   ck_assert(blDeleteAtomRangePDB(pdb_in, q, q) == pdb_in);
+   ck_assert(blDeleteAtomRangePDB(pdb_in, pdb_in, pdb_in) == pdb_in);
+   ck_assert(blGetPDBByN(pdb_in, 4) == q);
+   ck_assert(index->natoms == i - 5);
+   ck_assert(findzone_index_matches(index, pdb_in));
+
+   /* Atoms in a copy of the list are not in the index */
+   copy = blDupePDB(pdb_in);
+   ck_assert((copy != NULL) && (copy->indexes == NULL));
+   copy = blDeleteAtomPDB(copy, copy->next);
+   while(copy != NULL)
+      copy = blKillPDB(copy, NULL);
+   ck_assert(index->natoms == i - 5);
+   ck_assert(findzone_index_matches(index, pdb_in));
+
+   /* Moving atoms out of and back onto the list */
+   p = blGetPDBByN(pdb_in, 20);
+   ck_assert(blMovePDB(p, &pdb_in, &moved));
+   ck_assert(blMovePDB(pdb_in, &pdb_in, &moved));
+   ck_assert(findzone_index_matches(index, pdb_in));
+   ck_assert(blMovePDB(moved, &moved, &pdb_in));
+   ck_assert(blGetPDBByN(pdb_in, index->natoms - 1) == p);
+   pdb_in = blAppendPDB(pdb_in, moved);
+   ck_assert(index->natoms == i - 5);
+   ck_assert(findzone_index_matches(index, pdb_in));
+
+   /* Renumbering and copied indexes */
+   blRenumAtomsPDB(pdb_in, 1);
+   ck_assert(findzone_index_matches(index, pdb_in));
+   indx = blIndexPDB(pdb_in, &natom);
+   ck_assert((indx != NULL) && (natom == index->natoms));
+   for(p=pdb_in, i=0; p!=NULL; NEXT(p), i++)
+      ck_assert(indx[i] == p);
+   ck_assert(indx[i] == NULL);
+   free(indx);
+   q = blGetPDBByN(pdb_in, index->natoms - 1);
+   indx = blIndexAtomNumbersPDB(pdb_in, &natom);
+   ck_assert((indx != NULL) && (natom == q->atnum + 1));
+   for(p=pdb_in; p!=NULL; NEXT(p))
+      ck_assert(indx[p->atnum] == p);
+   free(indx);
+
+   /* Detaching the index frees it */
+   blDetachPDBIndexes(pdb_in);
+   ck_assert(blGetPDBAtomIndex(pdb_in) == NULL);
+   for(p=pdb_in; p!=NULL; NEXT(p))
+      ck_assert(p->indexes == NULL);
+}
+END_TEST
+
 
 /* Create Suite */
 Suite *findzone_suite(void)
@@ -472,6 +793,11 @@ Suite *findzone_suite(void)
    tcase_add_test(tc_core, test_02);
    tcase_add_test(tc_core, test_03);
    tcase_add_test(tc_core, test_04);
+   tcase_add_test(tc_core, test_index_01);
+   tcase_add_test(tc_core, test_index_02);
+   tcase_add_test(tc_core, test_index_03);
+   tcase_add_test(tc_core, test_index_04);
+   tcase_add_test(tc_core, test_index_05);
    suite_add_tcase(s, tc_core);
 
    /* Limits test case */
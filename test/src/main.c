@@ -3,11 +3,11 @@
 
    \file       main.c
    
-   \version    V1.2
-   \date       05.05.15
+   \version    V1.4
+   \date       18.10.26
    \brief      Run test suites for BiopLib.
 
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -71,6 +71,8 @@
 -  V1.0  05.08.14 Original By: CTP
 -  V1.1  28.04.15 Add CONECT tests. By: CTP
 -  V1.2  05.05.15 Add Header tests. By: CTP
+-  V1.3  18.10.26 Add PDBCOORDS tests.
+-  V1.4  18.10.26 Add accessibility tests.
 
 *************************************************************************/
 
@@ -88,6 +90,8 @@
 #include "wholepdb_suite.h"
 #include "conect_suite.h"
 #include "header_suite.h"
+#include "pdbcoords_suite.h"
+#include "access_suite.h"
                                                   /* add suites here... */
 
 
@@ -113,6 +117,8 @@ int main(int argc, char **argv)
    srunner_add_suite(sr, wholepdb_suite());
    srunner_add_suite(sr, conect_suite());
    srunner_add_suite(sr, header_suite());
+   srunner_add_suite(sr, pdbcoords_suite());
+   srunner_add_suite(sr, access_suite());
                                                   /* add suites here... */
 
 
@@ -0,0 +1,397 @@
+/************************************************************************/
+/**
+
+   \file       pdbcoords_suite.c
+   
+   \version    V1.3
+   \date       18.10.26
+   \brief      Test suite for the PDBCOORDS and PDBSELECTION routines.
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for the PDBCOORDS and PDBSELECTION routines.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  18.10.26 Original
+-  V1.1  18.10.26 Added test_selection
+-  V1.2  18.10.26 Added test_grid
+-  V1.3  18.10.26 Added test_zone_view
+
+*************************************************************************/
+
+#include <math.h>
+#include "pdbcoords_suite.h"
+
+/* Globals */
+static char test_input_filename[] = 
+               "data/wholepdb_suite/test_alanine_in.pdb";
+
+static PDB       *pdb     = NULL;
+static PDBCOORDS *coords  = NULL;
+static int       natoms   = 0;
+
+/* Rotation of 90 degrees about z */
+static REAL rotmat[3][3] = {{ 0.0, 1.0, 0.0},
+                            {-1.0, 0.0, 0.0},
+                            { 0.0, 0.0, 1.0}};
+
+/* Counts the pairs found by blForEachPairPDBGrid()                   */
+static BOOL count_pair(int i, int j, REAL distsq, APTR user)
+{
+   PDB *p = blGetPDBByN(pdb, i),
+       *q = blGetPDBByN(pdb, j);
+
+   if((i < j) && (fabs(DISTSQ(p, q) - distsq) < 0.0001))
+      (*(int *)user)++;
+   return(TRUE);
+}
+
+/* Setup And Teardown */
+static void pdbcoords_setup(void)
+{
+   FILE *fp;
+
+   if((fp = fopen(test_input_filename, "r")) != NULL)
+   {
+      pdb = blReadPDB(fp, &natoms);
+      fclose(fp);
+   }
+   coords = blAllocPDBCoords(pdb);
+}
+
+static void pdbcoords_teardown(void)
+{
+   blFreePDBCoords(coords);
+   FREELIST(pdb, PDB);
+   coords = NULL;
+   pdb    = NULL;
+}
+
+/* Core tests */
+START_TEST(test_alloc)
+{
+   ck_assert_msg(pdb != NULL,                 "Failed to read PDB file.");
+   ck_assert_msg(coords != NULL,              "Failed to make PDBCOORDS.");
+   ck_assert_msg(coords->natoms == natoms,    "Wrong atom count.");
+   ck_assert_msg(coords->atoms[1] == pdb->next, "Wrong atom pointer.");
+   ck_assert_msg(coords->x[1] == pdb->next->x, "Wrong x coordinate.");
+   ck_assert_msg(coords->z[4] == coords->atoms[4]->z,
+                 "Wrong z coordinate.");
+}
+END_TEST
+
+START_TEST(test_cofg)
+{
+   VEC3F cg_list, 
+         cg_coords;
+
+   blGetCofGPDB(pdb, &cg_list);
+   blGetCofGPDBCoords(coords, &cg_coords);
+
+   ck_assert_msg(fabs(cg_list.x - cg_coords.x) < 0.0001, "Wrong x CofG.");
+   ck_assert_msg(fabs(cg_list.y - cg_coords.y) < 0.0001, "Wrong y CofG.");
+   ck_assert_msg(fabs(cg_list.z - cg_coords.z) < 0.0001, "Wrong z CofG.");
+}
+END_TEST
+
+START_TEST(test_rotate)
+{
+   PDB       *orig,
+             *copy;
+   PDBCOORDS *copy_coords;
+
+   /* Rotate a copy using the linked list routine                       */
+   orig = blDupePDB(pdb);
+   copy = blDupePDB(pdb);
+   blRotatePDB(copy, rotmat);
+   copy_coords = blAllocPDBCoords(copy);
+
+   /* Rotate our own coordinates and compare                            */
+   blRotatePDBCoords(coords, rotmat);
+   ck_assert_msg(blCalcRMSPDBCoords(coords, copy_coords) < 0.0001,
+                 "Rotation differs from blRotatePDB().");
+
+   /* The list is unchanged until the coordinates are put back          */
+   ck_assert_msg(blCalcRMSPDB(pdb, orig) < 0.0001,
+                 "List changed before blPutPDBCoords().");
+   blPutPDBCoords(coords);
+   ck_assert_msg(blCalcRMSPDB(pdb, copy) < 0.0001,
+                 "Coordinates not copied back to list.");
+   ck_assert_msg(blCalcRMSPDB(pdb, orig) > 0.1,
+                 "Coordinates not rotated.");
+
+   blFreePDBCoords(copy_coords);
+   FREELIST(orig, PDB);
+   FREELIST(copy, PDB);
+}
+END_TEST
+
+START_TEST(test_missing)
+{
+   VEC3F tvect,
+         cg;
+
+   /* Mark the last atom as missing; it must not be moved or used       */
+   coords->x[4] = coords->y[4] = coords->z[4] = 9999.0;
+   tvect.x = tvect.y = tvect.z = 1.0;
+   blTranslatePDBCoords(coords, tvect);
+   blApplyMatrixPDBCoords(coords, rotmat);
+
+   ck_assert_msg(coords->x[4] == 9999.0, "Missing atom moved.");
+   ck_assert_msg(coords->z[4] == 9999.0, "Missing atom moved.");
+   ck_assert_msg(blGetCofGPDBCoords(coords, &cg) == 4,
+                 "Missing atom used in CofG.");
+}
+END_TEST
+
+START_TEST(test_in_range)
+{
+   int   indices[8],
+         i, n;
+   VEC3F centre;
+
+   /* Everything is within 100A of the first atom                       */
+   centre.x = coords->x[0];
+   centre.y = coords->y[0];
+   centre.z = coords->z[0];
+   n = blFindAtomsInRangePDBCoords(coords, centre, 100.0, NULL);
+   ck_assert_msg(n == natoms, "Wrong count for large distance.");
+
+   /* Only the first atom and those bonded to it are within 1.6A       */
+   n = blFindAtomsInRangePDBCoords(coords, centre, 1.6, indices);
+   ck_assert_msg(n > 0 && n < natoms, "Wrong count for small distance.");
+   ck_assert_msg(indices[0] == 0, "First atom not found.");
+   for(i=0; i<n; i++)
+   {
+      ck_assert_msg(DIST(coords->atoms[indices[i]], pdb) <= 1.6,
+                    "Atom found out of range.");
+   }
+}
+END_TEST
+
+START_TEST(test_selection)
+{
+   PDBSELECTION *view,
+                *fit_view,
+                *noh_view;
+   PDB          *sel_copy,
+                *fit;
+   char         *sel[3],
+                buffer[160];
+   VEC3F        cg_view,
+                cg_copy;
+   FILE         *fp;
+   int          n,
+                nlines = 0;
+
+   SELECT(sel[0], "N   ");
+   SELECT(sel[1], "CA  ");
+   SELECT(sel[2], "C   ");
+
+   /* The view points at the same atoms the copy duplicates             */
+   view     = blSelectAtomsPDBAsView(pdb, 3, sel);
+   sel_copy = blSelectAtomsPDBAsCopy(pdb, 3, sel, &n);
+   ck_assert_msg(view != NULL,                "Failed to make selection.");
+   ck_assert_msg(view->natoms == n && n == 3, "Wrong atom count.");
+   ck_assert_msg(view->atoms[1] == pdb->next, "Wrong atom pointer.");
+
+   blGetCofGPDBSelection(view, &cg_view);
+   blGetCofGPDB(sel_copy, &cg_copy);
+   ck_assert_msg(fabs(cg_view.x - cg_copy.x) < 0.0001, "Wrong x CofG.");
+   ck_assert_msg(fabs(cg_view.z - cg_copy.z) < 0.0001, "Wrong z CofG.");
+
+   /* Fit a rotated copy back onto the original                         */
+   fit = blDupePDB(pdb);
+   blRotatePDB(fit, rotmat);
+   ck_assert_msg(blFitNCaCPDB(pdb, fit, NULL), "Fitting failed.");
+   fit_view = blSelectAtomsPDBAsView(fit, 3, sel);
+   ck_assert_msg(blCalcRMSPDBSelection(view, fit_view) < 0.001,
+                 "Fitted backbone does not match.");
+
+   /* No hydrogens, so nothing is stripped                              */
+   noh_view = blStripHPDBAsView(pdb);
+   ck_assert_msg(noh_view->natoms == natoms, "Wrong count stripping H.");
+
+   /* Writes the three atoms and a TER card                             */
+   if((fp = tmpfile()) != NULL)
+   {
+      ck_assert_msg(blWritePDBSelection(fp, view) == 1,
+                    "Wrong number of TER cards.");
+      rewind(fp);
+      while(fgets(buffer, 160, fp))
+         nlines++;
+      fclose(fp);
+      ck_assert_msg(nlines == 4, "Wrong number of records written.");
+   }
+
+   blFreePDBSelection(view);
+   blFreePDBSelection(fit_view);
+   blFreePDBSelection(noh_view);
+   FREELIST(sel_copy, PDB);
+   FREELIST(fit, PDB);
+   free(sel[0]);
+   free(sel[1]);
+   free(sel[2]);
+}
+END_TEST
+
+START_TEST(test_grid)
+{
+   PDBGRID *grid;
+   PDB     *neighbours,
+           *p;
+   int     indices[8],
+           nearest[2],
+           npairs = 0,
+           nclose = 0,
+           n;
+   REAL    distsq[2];
+   VEC3F   centre;
+
+   grid = blBuildPDBGrid(pdb, 1.6);
+   ck_assert_msg(grid != NULL,           "Failed to build grid.");
+   ck_assert_msg(grid->natoms == natoms, "Wrong atom count.");
+
+   /* Same atoms in range as found by checking every atom               */
+   centre.x = pdb->x;
+   centre.y = pdb->y;
+   centre.z = pdb->z;
+   n = blFindAtomsInRangePDBGrid(grid, centre, 1.6, indices);
+   ck_assert_msg(n == blFindAtomsInRangePDBCoords(coords, centre, 1.6,
+                                                  NULL),
+                 "Wrong count in range.");
+   n = blFindAtomsInRangePDBGrid(grid, centre, 100.0, NULL);
+   ck_assert_msg(n == natoms, "Wrong count for large distance.");
+
+   /* The nearest atom to the first is itself, then the CA              */
+   n = blFindNearestAtomsPDBGrid(grid, centre, 2, nearest, distsq);
+   ck_assert_msg(n == 2,                     "Wrong count of nearest.");
+   ck_assert_msg(nearest[0] == 0,            "Nearest atom is wrong.");
+   ck_assert_msg(nearest[1] == 1,            "Second atom is wrong.");
+   ck_assert_msg(distsq[0] < distsq[1],      "Atoms not in order.");
+
+   /* Each pair in range is found once                                  */
+   n = blForEachPairPDBGrid(grid, 1.6, count_pair, (APTR)&npairs);
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      PDB *q;
+      for(q=p->next; q!=NULL; NEXT(q))
+      {
+         if(DIST(p, q) <= 1.6)
+            nclose++;
+      }
+   }
+   ck_assert_msg(n == npairs, "Wrong distance passed for a pair.");
+   ck_assert_msg(n == nclose, "Wrong number of pairs.");
+   blFreePDBGrid(grid);
+
+   /* Every atom neighbours the residue at a long distance              */
+   neighbours = blBuildAtomNeighbourPDBListAsCopy(pdb, pdb, 100.0);
+   for(p=neighbours, n=0; p!=NULL; NEXT(p))
+      n++;
+   ck_assert_msg(n == natoms, "Wrong number of neighbours.");
+   FREELIST(neighbours, PDB);
+}
+END_TEST
+
+START_TEST(test_zone_view)
+{
+   PDBSELECTION *view;
+   PDB          *zone_pdb,
+                *zone,
+                *p;
+   FILE         *fp;
+   int          n,
+                i;
+
+   fp = fopen("data/test-deca-ala-01.pdb", "r");
+   ck_assert_msg(fp != NULL, "Failed to open PDB file.");
+   zone_pdb = blReadPDB(fp, &n);
+   fclose(fp);
+   ck_assert_msg(zone_pdb != NULL, "Failed to read PDB file.");
+
+   /* The view points at the atoms the copy duplicates                  */
+   view = blExtractZonePDBAsView(zone_pdb, "A", 2, " ", "A", 4, " ");
+   zone = blExtractZonePDBAsCopy(zone_pdb, "A", 2, " ", "A", 4, " ");
+   ck_assert_msg(view != NULL && zone != NULL, "Zone not found.");
+   for(p=zone, i=0; p!=NULL; NEXT(p), i++)
+   {
+      ck_assert_msg(i < view->natoms,            "Too few atoms in view.");
+      ck_assert_msg(view->atoms[i]->resnum == p->resnum &&
+                    !strcmp(view->atoms[i]->atnam, p->atnam),
+                    "Wrong atom in view.");
+   }
+   ck_assert_msg(i == view->natoms, "Too many atoms in view.");
+   blFreePDBSelection(view);
+   FREELIST(zone, PDB);
+
+   /* A zone which ends before it starts is not found                   */
+   ck_assert_msg(blExtractZonePDBAsView(zone_pdb, "A", 5, " ",
+                                        "A", 2, " ") == NULL,
+                 "Reversed zone found as view.");
+   ck_assert_msg(blExtractZonePDBAsCopy(zone_pdb, "A", 5, " ",
+                                        "A", 2, " ") == NULL,
+                 "Reversed zone found as copy.");
+
+   FREELIST(zone_pdb, PDB);
+}
+END_TEST
+
+
+/* Create Suite */
+Suite *pdbcoords_suite(void)
+{
+   Suite *s = suite_create("PDBCoords");
+   TCase *tc_core = tcase_create("Core");
+
+   /* Core test case */
+   tcase_add_checked_fixture(tc_core, 
+                             pdbcoords_setup, 
+                             pdbcoords_teardown);
+   tcase_add_test(tc_core, test_alloc);
+   tcase_add_test(tc_core, test_cofg);
+   tcase_add_test(tc_core, test_rotate);
+   tcase_add_test(tc_core, test_missing);
+   tcase_add_test(tc_core, test_in_range);
+   tcase_add_test(tc_core, test_selection);
+   tcase_add_test(tc_core, test_grid);
+   tcase_add_test(tc_core, test_zone_view);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
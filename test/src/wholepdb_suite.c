@@ -3,11 +3,11 @@
 
    \file       wholepdb_suite.c
    
-   \version    V1.2
-   \date       12.09.14
+   \version    V1.16
+   \date       18.10.26
    \brief      Test suite for whole pdb and pdbml.
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2014
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -50,10 +50,26 @@
 -  V1.0  05.08.14 Original By: CTP
 -  V1.1  18.08.14 Check if input file read for all tests. By: CTP
 -  V1.2  12.09.14 Update tests for MS Windows. By: CTP
+-  V1.3  18.10.26 Added tests for reading compressed files
+-  V1.4  18.10.26 Added test for blStreamPDB()
+-  V1.5  18.10.26 Added test for blReadPDBEnsemble() and model index
+-  V1.6  18.10.26 Added test for reading mmCIF
+-  V1.7  18.10.26 Added test for the binary WHOLEPDB cache
+-  V1.8  18.10.26 Added test for reading a batch of files
+-  V1.9  18.10.26 Added test for formatting of written coordinates
+-  V1.10 18.10.26 Added test for the header record index
+-  V1.11 18.10.26 Added test for reading with PDBREADOPTIONS
+-  V1.12 18.10.26 Added test for reading into an arena
+-  V1.13 18.10.26 Added test for name codes
+-  V1.14 18.10.26 Added test for names changed without updating codes
+-  V1.15 18.10.26 Renamed atoms have their codes updated, since the
+                  codes are trusted once set
+-  V1.16 18.10.26 Added test for corrupt binary files
 
 *************************************************************************/
 
 #include "wholepdb_suite.h"
+#include "seq.h"
 
 /* Globals */
 static char test_output_filename[]     = "data/test-XXXXX",
@@ -93,6 +109,25 @@ static BOOL wholepdb_compare_files(char *filename_a, char *filename_b)
    return system(command) == 0 ? TRUE:FALSE;
 }
 
+/* Callbacks for blStreamPDB() counting models, residues and atoms */
+static BOOL wholepdb_count_model(int model, APTR user)
+{
+   ((int *)user)[0]++;
+   return(TRUE);
+}
+
+static BOOL wholepdb_count_residue(PDB *p, APTR user)
+{
+   ((int *)user)[1]++;
+   return(TRUE);
+}
+
+static BOOL wholepdb_count_atom(PDB *p, APTR user)
+{
+   ((int *)user)[2]++;
+   return(TRUE);
+}
+
 /* Setup And Teardown */
 static void wholepdb_setup(void)
 {
@@ -402,6 +437,851 @@ START_TEST(test_read_write_pdbml)
 END_TEST
 
 
+START_TEST(test_read_write_pdb_gzip)
+{
+   /* get pdb data */
+   char filename_in[]      = "test_alanine_in.pdb.gz",
+        filename_example[] = "test_alanine_out_01.pdb",
+        test_message[]     = "Output PDB does not match example file.";
+        
+   /* Set Default */
+   gPDBXMLForce = FORCEXML_NOFORCE;
+   
+   /* read compressed input file */
+   strcat(test_input_filename,filename_in);
+   fp = fopen(test_input_filename,"r");
+   wpdb = blReadWholePDB(fp);
+   fclose(fp);
+   ck_assert_msg(wpdb != NULL, "Failed to read compressed file.");
+
+#ifndef MS_WINDOWS   
+   /* Set temp file name */
+   mkstemp(test_output_filename);
+#endif
+
+   /* write output file */
+   fp = fopen(test_output_filename,"w");
+   blWriteWholePDB(fp, wpdb);
+   fclose(fp);
+
+   /* compare output file to example file */
+   strcat(test_example_filename, filename_example);
+   files_identical = wholepdb_compare_files(test_example_filename, 
+                                            test_output_filename);
+
+   /* remove output file */
+   remove(test_output_filename);
+  
+   /* return test result */
+   ck_assert_msg(files_identical, test_message);
+}
+END_TEST
+
+START_TEST(test_read_write_pdbml_compress)
+{
+   /* get pdb data */
+   char filename_in[]      = "test_alanine_in.xml.Z",
+        filename_example[] = "test_alanine_out.xml",
+        test_message[]     = "Output PDBML does not match example file.";
+        
+   /* Set Default */
+   gPDBXMLForce = FORCEXML_NOFORCE;
+   
+   /* read compressed input file */
+   strcat(test_input_filename,filename_in);
+   fp = fopen(test_input_filename,"r");
+   wpdb = blReadWholePDB(fp);
+   fclose(fp);
+   ck_assert_msg(wpdb != NULL, "Failed to read compressed file.");
+
+#ifndef MS_WINDOWS   
+   /* Set temp file name */
+   mkstemp(test_output_filename);
+#endif
+
+   /* write output file */
+   fp = fopen(test_output_filename,"w");
+   blWriteWholePDB(fp, wpdb);
+   fclose(fp);
+
+   /* compare output file to example file */
+   strcat(test_example_filename, filename_example);
+   files_identical = wholepdb_compare_files(test_example_filename, 
+                                            test_output_filename);
+
+   /* remove output file */
+   remove(test_output_filename);
+  
+   /* return test result */
+   ck_assert_msg(files_identical, test_message);
+}
+END_TEST
+
+START_TEST(test_stream_pdb)
+{
+   char      filename_in[] = "test_alanine_in.pdb";
+   int       counts[3]     = {0, 0, 0},
+             natoms,
+             nres          = 0;
+   PDB       *p;
+   PDBSTREAM callbacks;
+
+   callbacks.model    = wholepdb_count_model;
+   callbacks.residue  = wholepdb_count_residue;
+   callbacks.atom     = wholepdb_count_atom;
+   callbacks.AllAtoms = TRUE;
+   callbacks.OccRank  = 1;
+
+   /* read test file into a list and stream it */
+   strcat(test_input_filename,filename_in);
+   fp = fopen(test_input_filename,"r");
+   wpdb = blReadWholePDB(fp);
+   fclose(fp);
+   ck_assert_msg(wpdb != NULL, "Failed to read PDB file.");
+
+   fp = fopen(test_input_filename,"r");
+   natoms = blStreamPDB(fp, &callbacks, (APTR)counts);
+   fclose(fp);
+
+   for(p=wpdb->pdb; p!=NULL; p=blFindNextResidue(p))
+      nres++;
+
+   /* tests */
+   ck_assert_msg(natoms == wpdb->natoms,  "Wrong atom count returned.");
+   ck_assert_msg(counts[2] == natoms,     "Wrong number of atom calls.");
+   ck_assert_msg(counts[1] == nres,    "Wrong number of residue calls.");
+   ck_assert_msg(counts[0] == 1,         "Wrong number of model calls.");
+}
+END_TEST
+
+START_TEST(test_read_pdb_ensemble)
+{
+   char          filename_in[] = "test_alanine_models.pdb";
+   int           model,
+                 natoms;
+   PDB           *pdb;
+   PDBENSEMBLE   *ens;
+   PDBMODELINDEX *index;
+
+   /* read all models and index them */
+   strcat(test_input_filename,filename_in);
+   fp    = fopen(test_input_filename,"r");
+   ens   = blReadPDBEnsemble(fp, TRUE, 1);
+   rewind(fp);
+   index = blIndexPDBModels(fp);
+
+   ck_assert_msg(ens != NULL,                "Failed to read ensemble.");
+   ck_assert_msg(index != NULL,                 "Failed to index file.");
+   ck_assert_msg(ens->nmodels == 3,          "Wrong number of models.");
+   ck_assert_msg(index->nmodels == 3, "Wrong number of models indexed.");
+
+   /* each model is displaced by 1A in x from the last */
+   for(model=1; model<=3; model++)
+   {
+      ck_assert_msg(blSetPDBEnsembleModel(ens, model),
+                    "Failed to set model.");
+      pdb = blReadPDBModelIndexed(fp, index, model, TRUE, 1, &natoms);
+      ck_assert_msg(natoms == ens->natoms,
+                    "Wrong number of atoms in indexed model.");
+      ck_assert_msg(pdb->x == ens->pdb->x,
+                    "Indexed model does not match ensemble.");
+      ck_assert_msg(ABS(ens->pdb->x - ens->coords[0] - 
+                        (REAL)(model-1)) < (REAL)0.0001,
+                    "Wrong ensemble coordinates.");
+      FREELIST(pdb, PDB);
+   }
+   fclose(fp);
+
+   blFreePDBEnsemble(ens);
+   blFreePDBModelIndex(index);
+}
+END_TEST
+
+
+START_TEST(test_read_mmcif)
+{
+   char     filename_pdb[] = "test_alanine_in.pdb",
+            filename_cif[] = "test_alanine_in.cif",
+            cif_filename[160];
+   WHOLEPDB *wpdb_cif;
+   PDB      *p, *q;
+
+   /* read the same structure from PDB and mmCIF files */
+   strcpy(cif_filename, test_input_filename);
+   strcat(cif_filename, filename_cif);
+   strcat(test_input_filename,filename_pdb);
+   fp = fopen(test_input_filename,"r");
+   wpdb = blReadWholePDB(fp);
+   fclose(fp);
+
+   /* the format is recognised by blReadWholePDB() */
+   fp = fopen(cif_filename,"r");
+   wpdb_cif = blReadWholePDB(fp);
+   fclose(fp);
+
+   ck_assert_msg(wpdb != NULL,               "Failed to read PDB file.");
+   ck_assert_msg(wpdb_cif != NULL,         "Failed to read mmCIF file.");
+   ck_assert_msg(wpdb_cif->natoms == wpdb->natoms,
+                 "Wrong number of atoms.");
+   ck_assert_msg(!strncmp(wpdb_cif->header->string, 
+                          wpdb->header->string, 66),
+                 "Wrong HEADER record.");
+
+   /* tests */
+   for(p=wpdb->pdb, q=wpdb_cif->pdb; 
+       (p!=NULL) && (q!=NULL); 
+       NEXT(p), NEXT(q))
+   {
+      ck_assert_msg(!strcmp(p->record_type, q->record_type),
+                    "Wrong record type.");
+      ck_assert_msg(!strcmp(p->atnam, q->atnam),   "Wrong atom name.");
+      ck_assert_msg(!strcmp(p->resnam, q->resnam), "Wrong residue name.");
+      ck_assert_msg(!strcmp(p->chain, q->chain),   "Wrong chain.");
+      ck_assert_msg(p->resnum == q->resnum,    "Wrong residue number.");
+      ck_assert_msg((p->x == q->x) && (p->y == q->y) && (p->z == q->z),
+                    "Wrong coordinates.");
+      ck_assert_msg(p->occ == q->occ,               "Wrong occupancy.");
+   }
+   ck_assert_msg((p == NULL) && (q == NULL),       "Wrong atom list.");
+
+   blFreeWholePDB(wpdb_cif);
+}
+END_TEST
+
+START_TEST(test_read_write_pdb_binary)
+{
+   /* get pdb data */
+   char filename_in[]      = "test_alanine_in.pdb",
+        filename_example[] = "test_alanine_out_01.pdb",
+        test_message[]     = "Output PDB does not match example file.";
+   WHOLEPDB *wpdb_bin;
+
+   /* Set Default */
+   gPDBXMLForce = FORCEXML_NOFORCE;
+
+   /* read input file */
+   strcat(test_input_filename,filename_in);
+   fp = fopen(test_input_filename,"r");
+   wpdb = blReadWholePDB(fp);
+   fclose(fp);
+   ck_assert_msg(wpdb != NULL, "Failed to read PDB file.");
+
+#ifndef MS_WINDOWS   
+   /* Set temp file name */
+   mkstemp(test_output_filename);
+#endif
+
+   /* write and read back the binary file */
+   fp = fopen(test_output_filename,"wb");
+   ck_assert_msg(blWriteWholePDBBinary(fp, wpdb),
+                 "Failed to write binary file.");
+   fclose(fp);
+
+   fp = fopen(test_output_filename,"rb");
+   wpdb_bin = blReadWholePDBBinary(fp);
+   fclose(fp);
+   ck_assert_msg(wpdb_bin != NULL, "Failed to read binary file.");
+   ck_assert_msg(wpdb_bin->natoms == wpdb->natoms,
+                 "Wrong number of atoms.");
+
+   /* write the copy as PDB, including the CONECTs */
+   fp = fopen(test_output_filename,"w");
+   blWriteWholePDB(fp, wpdb_bin);
+   fclose(fp);
+   blFreeWholePDB(wpdb_bin);
+
+   /* compare output file to example file */
+   strcat(test_example_filename, filename_example);
+   files_identical = wholepdb_compare_files(test_example_filename, 
+                                            test_output_filename);
+
+   /* remove output file */
+   remove(test_output_filename);
+  
+   /* return test result */
+   ck_assert_msg(files_identical, test_message);
+}
+END_TEST
+
+/* Writes len bytes of a binary file and reads it back                  */
+static WHOLEPDB *wholepdb_read_binary_bytes(char *bytes, long len)
+{
+   WHOLEPDB *wpdb_bin;
+
+   fp = fopen(test_output_filename,"wb");
+   fwrite(bytes, 1, len, fp);
+   fclose(fp);
+
+   fp = fopen(test_output_filename,"rb");
+   wpdb_bin = blReadWholePDBBinary(fp);
+   fclose(fp);
+   return(wpdb_bin);
+}
+
+START_TEST(test_read_pdb_binary_corrupt)
+{
+   char     filename_in[] = "test_alanine_in.pdb",
+            *bytes,
+            *names = NULL;
+   long     len,
+            i;
+   int      nConect = MAXCONECT + 1;
+   WHOLEPDB *wpdb_bin;
+   PDB      *p;
+
+   strcat(test_input_filename,filename_in);
+   fp = fopen(test_input_filename,"r");
+   wpdb = blReadWholePDB(fp);
+   fclose(fp);
+   ck_assert_msg(wpdb != NULL, "Failed to read PDB file.");
+
+#ifndef MS_WINDOWS
+   /* Set temp file name */
+   mkstemp(test_output_filename);
+#endif
+
+   /* write the binary file and read it into memory */
+   fp = fopen(test_output_filename,"wb");
+   ck_assert_msg(blWriteWholePDBBinary(fp, wpdb),
+                 "Failed to write binary file.");
+   fclose(fp);
+   fp = fopen(test_output_filename,"rb");
+   fseek(fp, 0L, SEEK_END);
+   len = ftell(fp);
+   rewind(fp);
+   bytes = (char *)malloc(len);
+   ck_assert_msg(bytes != NULL, "No memory.");
+   ck_assert_msg(fread(bytes, 1, len, fp) == (size_t)len,
+                 "Failed to read binary file.");
+   fclose(fp);
+
+   /* the 8 names of the first atom start with its record type */
+   for(i=0; i<len-8; i++)
+   {
+      if(!memcmp(bytes+i, "ATOM  \0", 7))
+      {
+         names = bytes+i;
+         break;
+      }
+   }
+   ck_assert_msg(names != NULL, "Atom record not found.");
+
+   /* a truncated file is rejected */
+   wpdb_bin = wholepdb_read_binary_bytes(bytes, (names - bytes) + 16);
+   ck_assert_msg(wpdb_bin == NULL, "Truncated file read.");
+
+   /* names without terminators are terminated */
+   memset(names, 'X', 64);
+   wpdb_bin = wholepdb_read_binary_bytes(bytes, len);
+   ck_assert_msg(wpdb_bin != NULL, "Failed to read binary file.");
+   p = wpdb_bin->pdb;
+   ck_assert_msg((strlen(p->record_type) == 7) &&
+                 (strlen(p->atnam)       == 7) &&
+                 (strlen(p->resnam)      == 7) &&
+                 (strlen(p->segid)       == 7),
+                 "Names not terminated.");
+   blFreeWholePDB(wpdb_bin);
+
+   /* too many CONECTs are rejected. nConect is 3 ints before the names */
+   memcpy(names - 3*sizeof(int), &nConect, sizeof(int));
+   wpdb_bin = wholepdb_read_binary_bytes(bytes, len);
+   ck_assert_msg(wpdb_bin == NULL, "Too many CONECTs accepted.");
+
+   free(bytes);
+   remove(test_output_filename);
+}
+END_TEST
+
+START_TEST(test_read_pdb_batch)
+{
+   char         *names[] = {"test_alanine_in.pdb",
+                            "test_alanine_in.xml",
+                            "no_such_file.pdb",
+                            "test_alanine_in.cif",
+                            "test_alanine_in.pdb.gz",
+                            "test_alanine_models.pdb"},
+                filenames[6][160],
+                *list[6];
+   PDBBATCH     *batch;
+   PDBREADSTATE state;
+   WHOLEPDB     *wpdb_batch;
+   int          i,
+                index,
+                count,
+                pass;
+   BOOL         seen[6];
+
+   for(i=0; i<6; i++)
+   {
+      strcpy(filenames[i], test_input_filename);
+      strcat(filenames[i], names[i]);
+      list[i] = filenames[i];
+   }
+
+   /* the single-threaded reader gives the expected result */
+   fp = fopen(filenames[0],"r");
+   wpdb = blReadWholePDB(fp);
+   fclose(fp);
+   ck_assert_msg(wpdb != NULL, "Failed to read PDB file.");
+
+   /* pass 0 returns the files in order, pass 1 as they are finished */
+   for(pass=0; pass<2; pass++)
+   {
+      batch = blOpenPDBBatch(list, 6, 3, 4, (pass==0));
+      ck_assert_msg(batch != NULL, "Failed to open batch.");
+
+      for(i=0; i<6; i++)
+         seen[i] = FALSE;
+      count = 0;
+
+      while(blGetPDBBatch(batch, &wpdb_batch, &index, &state))
+      {
+         ck_assert_msg((index >= 0) && (index < 6) && !seen[index],
+                       "Wrong file index.");
+         if(pass == 0)
+            ck_assert_msg(index == count, "Files not returned in order.");
+         seen[index] = TRUE;
+         count++;
+
+         if(index == 2)
+         {
+            ck_assert_msg(wpdb_batch == NULL, "Missing file was read.");
+            continue;
+         }
+
+         ck_assert_msg(wpdb_batch != NULL, "Failed to read file.");
+         ck_assert_msg(wpdb_batch->natoms == wpdb->natoms,
+                       "Wrong number of atoms.");
+         ck_assert_msg(state.xml == (index == 1), "Wrong PDBML flag.");
+         ck_assert_msg(state.multiNMR == ((index == 5) ? 3 : 0),
+                       "Wrong model count.");
+         ck_assert_msg(!state.modelNotFound || (index == 1),
+                       "Model not found.");
+         blFreeWholePDB(wpdb_batch);
+      }
+      ck_assert_msg(count == 6, "Wrong number of files.");
+
+      blClosePDBBatch(batch);
+   }
+}
+END_TEST
+
+START_TEST(test_write_pdb_record_format)
+{
+   /* values which must round as printf() does */
+   REAL values[] = {0.0, -0.0, -0.0004, 0.0005, 0.0625, -1.0625, 
+                    2.675, -999.9995, 9999.9996, 123456.789, 1.0e20,
+                    0.125, -17.3, 56.78901},
+        occ[]    = {1.0, 0.005, 0.015, -0.005, 99.995, 1000.0};
+   char line[512],
+        expected[512];
+   PDB  atom;
+   int  i;
+
+   CLEAR_PDB((&atom));
+   strcpy(atom.record_type, "HETATM");
+   strcpy(atom.atnam_raw,   " O  ");
+   strcpy(atom.resnam,      "HOH ");
+   strcpy(atom.chain,       "AB");
+   strcpy(atom.insert,      " ");
+   strcpy(atom.segid,       "W1");
+   strcpy(atom.element,     "O");
+   atom.altpos        = ' ';
+   atom.atnum         = -12;
+   atom.resnum        = 12345;
+   atom.formal_charge = -2;
+
+#ifndef MS_WINDOWS
+   /* Set temp file name */
+   mkstemp(test_output_filename);
+#endif
+
+   for(i=0; i<14; i++)
+   {
+      atom.x    = values[i];
+      atom.y    = -values[i];
+      atom.z    = values[(i+1)%14];
+      atom.occ  = occ[i%6];
+      atom.bval = values[i];
+
+      fp = fopen(test_output_filename,"w");
+      blWritePDBRecord(fp, &atom);
+      fclose(fp);
+
+      fp = fopen(test_output_filename,"r");
+      fgets(line, 512, fp);
+      fclose(fp);
+
+      sprintf(expected, "%-6s%5d %-4s%c%-4s%1s%4d%1s   %8.3f%8.3f%8.3f"
+              "%6.2f%6.2f      %4s%2s%c%c\n",
+              atom.record_type, atom.atnum, atom.atnam_raw, atom.altpos,
+              atom.resnam, atom.chain, atom.resnum, atom.insert,
+              atom.x, atom.y, atom.z, atom.occ, atom.bval,
+              atom.segid, atom.element, '2', '-');
+      ck_assert_msg(!strcmp(line, expected), "Wrong record format.");
+   }
+
+   /* remove output file */
+   remove(test_output_filename);
+}
+END_TEST
+
+
+START_TEST(test_read_pdb_options)
+{
+   char           filename_in[] = "test_alanine_models.pdb",
+                  filename_xml[160],
+                  *atnams[]     = {"C*"},
+                  *chains[]     = {"B", "A"};
+   int            natoms_all,
+                  natoms;
+   PDB            *pdb_all,
+                  *pdb,
+                  *p,
+                  *q;
+   PDBREADOPTIONS options;
+
+   strcpy(filename_xml, test_input_filename);
+   strcat(filename_xml, "test_alanine_in.xml");
+   strcat(test_input_filename,filename_in);
+
+   fp = fopen(test_input_filename,"r");
+   pdb_all = blReadPDB(fp, &natoms_all);
+   ck_assert_msg(pdb_all != NULL, "Failed to read PDB file.");
+
+   /* the defaults read as blReadPDB() */
+   rewind(fp);
+   blInitPDBReadOptions(&options);
+   pdb = blReadPDBOptions(fp, &options, &natoms);
+   ck_assert_msg(natoms == natoms_all, "Wrong number of atoms.");
+   for(p=pdb, q=pdb_all; (p!=NULL) && (q!=NULL); NEXT(p), NEXT(q))
+   {
+      ck_assert_msg((p->atnum == q->atnum) && !strcmp(p->atnam, q->atnam)
+                    && !strcmp(p->resnam, q->resnam) && (p->x == q->x)
+                    && !strcmp(p->element, q->element),
+                    "Atoms differ from blReadPDB().");
+   }
+   FREELIST(pdb, PDB);
+
+   /* carbon atoms of chain A from model 2 with just the coordinates */
+   rewind(fp);
+   options.atnams   = atnams;
+   options.natnams  = 1;
+   options.chains   = chains;
+   options.nchains  = 2;
+   options.fields   = PDBFIELD_COORDS;
+   options.ModelNum = 2;
+   pdb = blReadPDBOptions(fp, &options, &natoms);
+   ck_assert_msg(natoms == 3, "Wrong number of carbon atoms.");
+   for(p=pdb, q=pdb_all; p!=NULL; NEXT(p))
+   {
+      for(; strcmp(q->atnam, p->atnam); NEXT(q));
+      ck_assert_msg(ABS(p->x - q->x - (REAL)1.0) < (REAL)0.0001,
+                    "Wrong coordinates.");
+      ck_assert_msg((p->atnum == 0) && !strcmp(p->resnam, "    ") &&
+                    !strcmp(p->element, "  "),
+                    "Unwanted fields were read.");
+      ck_assert_msg(p->resnum == 1, "Residue number not read.");
+   }
+   FREELIST(pdb, PDB);
+
+   /* residue zone with no atoms and HETATMs only */
+   rewind(fp);
+   blInitPDBReadOptions(&options);
+   options.firstRes = "A2";
+   options.lastRes  = "A3";
+   pdb = blReadPDBOptions(fp, &options, &natoms);
+   ck_assert_msg((pdb == NULL) && (natoms == 0), "Atoms read from zone.");
+   rewind(fp);
+   options.firstRes = "A1";
+   options.records  = PDBRECORD_HETATM;
+   pdb = blReadPDBOptions(fp, &options, &natoms);
+   ck_assert_msg((pdb == NULL) && (natoms == 0), "HETATMs read.");
+
+   /* a zone may not span chains */
+   rewind(fp);
+   options.records  = PDBRECORD_ATOM;
+   options.lastRes  = "B1";
+   pdb = blReadPDBOptions(fp, &options, &natoms);
+   ck_assert_msg((pdb == NULL) && (natoms == -1), "Bad zone accepted.");
+   fclose(fp);
+
+   /* PDBML atoms are filtered after reading */
+   fp = fopen(filename_xml,"r");
+   blInitPDBReadOptions(&options);
+   options.atnams  = atnams;
+   options.natnams = 1;
+   pdb = blReadPDBOptions(fp, &options, &natoms);
+   fclose(fp);
+   ck_assert_msg(natoms == 3, "Wrong number of PDBML carbon atoms.");
+   FREELIST(pdb, PDB);
+
+   FREELIST(pdb_all, PDB);
+}
+END_TEST
+
+START_TEST(test_read_pdb_arena)
+{
+   char           filename_in[] = "test_alanine_in.pdb",
+                  filename_xml[160],
+                  *sel[]        = {"CA  "};
+   int            natoms;
+   PDB            *p,
+                  *q,
+                  *copy;
+   STRINGLIST     *s,
+                  *t;
+   WHOLEPDB       *arena_wpdb;
+   ARENA          *arena;
+   PDBREADOPTIONS options;
+   PDBREADSTATE   state;
+
+   strcpy(filename_xml, test_input_filename);
+   strcat(filename_xml, "test_alanine_in.xml");
+   strcat(test_input_filename,filename_in);
+
+   fp = fopen(test_input_filename,"r");
+   wpdb = blReadWholePDB(fp);
+   ck_assert_msg(wpdb != NULL, "Failed to read PDB file.");
+
+   /* the atoms are contiguous and the same as from blReadWholePDB() */
+   rewind(fp);
+   blInitPDBReadOptions(&options);
+   options.arena = blCreateArena(0);
+   arena_wpdb = blDoReadPDBOptions(fp, &options, TRUE, &state);
+   fclose(fp);
+   ck_assert_msg(arena_wpdb != NULL, "Failed to read into arena.");
+   ck_assert_msg(arena_wpdb->arena == options.arena, "Arena not kept.");
+   arena_wpdb->pdb = blRemoveAlternatesArena(arena_wpdb->pdb,
+                                             arena_wpdb->arena);
+   ck_assert_msg(arena_wpdb->natoms == wpdb->natoms,
+                 "Wrong number of atoms.");
+   for(p=arena_wpdb->pdb, q=wpdb->pdb; p!=NULL; NEXT(p), NEXT(q))
+   {
+      ck_assert_msg((p->next == NULL) || (p->next == p+1),
+                    "Atoms not contiguous.");
+      ck_assert_msg((p->atnum == q->atnum) && (p->x == q->x) &&
+                    !strcmp(p->atnam, q->atnam), "Atoms differ.");
+   }
+   for(s=arena_wpdb->header, t=wpdb->header; t!=NULL; NEXT(s), NEXT(t))
+      ck_assert_msg(!strcmp(s->string, t->string), "Headers differ.");
+   ck_assert_msg(s == NULL, "Header too long.");
+
+   /* copies into a second arena */
+   arena = blCreateArena(0);
+   copy  = blDupePDBArena(arena_wpdb->pdb, arena);
+   for(p=copy, q=wpdb->pdb; q!=NULL; NEXT(p), NEXT(q))
+   {
+      ck_assert_msg((p->next == NULL) || (p->next == p+1),
+                    "Copied atoms not contiguous.");
+      ck_assert_msg(p->atnum == q->atnum, "Copied atoms differ.");
+   }
+   ck_assert_msg(p == NULL, "Too many atoms copied.");
+   copy = blStripHPDBAsCopyArena(arena_wpdb->pdb, &natoms, arena);
+   ck_assert_msg((copy != NULL) && (natoms == 5), "Failed to strip Hs.");
+   copy = blSelectAtomsPDBAsCopyArena(arena_wpdb->pdb, 1, sel, &natoms,
+                                      arena);
+   ck_assert_msg((copy != NULL) && (natoms == 1), "Failed to select CA.");
+   copy = blGetPDBChainAsCopyArena(arena_wpdb->pdb, "A", arena);
+   ck_assert_msg(copy != NULL, "Failed to copy chain.");
+   blFreeArena(arena);
+   blFreeWholePDB(arena_wpdb);
+
+   /* PDBML files are copied into the arena */
+   fp = fopen(filename_xml,"r");
+   options.arena = blCreateArena(0);
+   arena_wpdb = blDoReadPDBOptions(fp, &options, TRUE, &state);
+   fclose(fp);
+   ck_assert_msg((arena_wpdb != NULL) && 
+                 (arena_wpdb->arena == options.arena),
+                 "Failed to read PDBML into arena.");
+   ck_assert_msg(arena_wpdb->natoms == wpdb->natoms,
+                 "Wrong number of PDBML atoms.");
+   for(p=arena_wpdb->pdb; p!=NULL; NEXT(p))
+      ck_assert_msg((p->next == NULL) || (p->next == p+1),
+                    "PDBML atoms not contiguous.");
+   blFreeWholePDB(arena_wpdb);
+}
+END_TEST
+
+START_TEST(test_name_codes)
+{
+   char filename_in[] = "test_alanine_in.pdb",
+        *seq;
+   PDB  *p,
+        unknown,
+        *u = &unknown;
+
+   strcat(test_input_filename,filename_in);
+   fp = fopen(test_input_filename,"r");
+   wpdb = blReadWholePDB(fp);
+   fclose(fp);
+   ck_assert_msg(wpdb != NULL, "Failed to read PDB file.");
+
+   /* the reader sets the codes */
+   p = wpdb->pdb->next;
+   ck_assert_msg(!strncmp(p->atnam, "CA  ", 4), "Second atom not CA.");
+   ck_assert_msg(p->atnam_code == PDBNAME_CA, "Wrong atom name code.");
+   ck_assert_msg(p->record_code == PDBNAME_ATOM, "Wrong record code.");
+   ck_assert_msg(p->resnam_code == blGetPDBNameCode("ALA "),
+                 "Wrong residue name code.");
+   ck_assert_msg(p->element_code == blGetPDBNameCode(p->element),
+                 "Wrong element code.");
+   ck_assert_msg(p->element_code != PDBNAME_UNKNOWN, "No element code.");
+   ck_assert_msg(ISATOMREC(p) && !ISHETATM(p), "Wrong record type.");
+   ck_assert_msg(!strcmp(blGetPDBNameFromCode(PDBNAME_CA), "CA  "),
+                 "Wrong name for code.");
+   ck_assert_msg(blThronePDB(p, FALSE) == 'A', "Wrong 1-letter code.");
+   seq = blPDB2Seq(wpdb->pdb);
+   ck_assert_msg((seq != NULL) && !strcmp(seq, "A"), "Wrong sequence.");
+   free(seq);
+
+   /* renaming updates the codes */
+   blSetResnam(wpdb->pdb, NULL, "GLY ", 1, " ", "A");
+   ck_assert_msg(p->resnam_code == blGetPDBNameCode("GLY "),
+                 "Code not updated.");
+   ck_assert_msg(blThronePDB(p, FALSE) == 'G', "Wrong 1-letter code.");
+
+   /* names not in the table are compared as strings */
+   CLEAR_PDB(u);
+   strcpy(u->record_type, "HETATM");
+   strcpy(u->atnam,       "C1B ");
+   strcpy(u->resnam,      "HEM ");
+   strcpy(u->element,     "C");
+   blSetPDBNameCodes(u);
+   ck_assert_msg(u->atnam_code == PDBNAME_UNKNOWN,
+                 "Unexpected atom name code.");
+   ck_assert_msg(PDBNAMEMATCH(u->atnam_code, u->atnam,
+                              PDBNAME_UNKNOWN, "C1B ", 4),
+                 "Unknown name not matched.");
+   ck_assert_msg(ISHETATM(u), "HETATM not found.");
+   ck_assert_msg(blThronePDB(u, FALSE) == 'X',
+                 "Wrong 1-letter code for unknown residue.");
+}
+END_TEST
+
+START_TEST(test_name_codes_rename)
+{
+   char filename_in[] = "test_alanine_in.pdb",
+        *sel[]        = {"CA  "},
+        *seq;
+   PDB  *p,
+        *q;
+   int  natom;
+
+   strcat(test_input_filename,filename_in);
+   fp = fopen(test_input_filename,"r");
+   wpdb = blReadWholePDB(fp);
+   fclose(fp);
+   ck_assert_msg(wpdb != NULL, "Failed to read PDB file.");
+
+   /* names copied in directly need their codes updating                */
+   for(p=wpdb->pdb; p!=NULL; NEXT(p))
+   {
+      strcpy(p->resnam, "GLY ");
+      blSetPDBNameCodes(p);
+   }
+   p = wpdb->pdb->next;
+   ck_assert_msg(p->resnam_code == blGetPDBNameCode("GLY "),
+                 "Code not updated.");
+   ck_assert_msg(blThronePDB(p, FALSE) == 'G', "Wrong 1-letter code.");
+   seq = blPDB2Seq(wpdb->pdb);
+   ck_assert_msg((seq != NULL) && !strcmp(seq, "G"), "Wrong sequence.");
+   free(seq);
+
+   strcpy(p->atnam, "CB  ");
+   blSetPDBNameCodes(p);
+   q = blSelectAtomsPDBAsCopy(wpdb->pdb, 1, sel, &natom);
+   ck_assert_msg(natom == 0, "Renamed atom selected.");
+   FREELIST(q, PDB);
+
+   strcpy(p->record_type, "HETATM");
+   blSetPDBNameCodes(p);
+   ck_assert_msg(ISHETATM(p) && !ISATOMREC(p), "Wrong record type.");
+
+   /* atoms without codes are compared by name                          */
+   strcpy(p->record_type, "ATOM  ");
+   p->record_code = PDBNAME_UNKNOWN;
+   ck_assert_msg(ISATOMREC(p) && !ISHETATM(p), "Wrong record type.");
+}
+END_TEST
+
+START_TEST(test_header_index)
+{
+   char       *lines[] = {"HEADER    TEST FILE",
+                          "REMARK   2 RESOLUTION. 1.80 ANGSTROMS.",
+                          "REMARK 350 BIOMOLECULE: 1",
+                          "REMARK 350   BIOMT1   1  1.000000",
+                          "SEQRES   1 A    1  ALA",
+                          "HELIX    1   1 ALA A    1  ALA A    1  1",
+                          "SEQRES   1 B    1  ALA",
+                          "CRYST1   52.000   58.600   61.900",
+                          ""},
+              *types[] = {"HELIX", "CRYST1", "HEADER", NULL};
+   WHOLEPDB   header_wpdb;
+   STRINGLIST *first,
+              *stop,
+              *tail = NULL,
+              *s;
+   int        i,
+              count;
+
+   header_wpdb.pdb         = NULL;
+   header_wpdb.header      = NULL;
+   header_wpdb.trailer     = NULL;
+   header_wpdb.headerIndex = NULL;
+   header_wpdb.arena       = NULL;
+   header_wpdb.natoms      = 0;
+
+   /* the empty string is not stored */
+   for(i=0; i<9; i++)
+   {
+      tail = blAppendString(&(header_wpdb.header), tail, lines[i]);
+      ck_assert_msg(tail != NULL, "Failed to store header.");
+   }
+   for(s=header_wpdb.header, i=0; s!=NULL; NEXT(s), i++)
+      ck_assert_msg(!strcmp(s->string, lines[i]), "Wrong header line.");
+   ck_assert_msg(i == 8, "Wrong number of header lines.");
+   ck_assert_msg(tail->next == NULL, "Tail is not the last line.");
+
+   /* the index is built when first needed */
+   first = blGetHeaderRecordsWholePDB(&header_wpdb, "SEQRES", &stop);
+   ck_assert_msg(header_wpdb.headerIndex != NULL, "Index not built.");
+   ck_assert_msg(first == header_wpdb.header->next->next->next->next,
+                 "Wrong first SEQRES.");
+   ck_assert_msg(stop == tail, "Wrong end of SEQRES.");
+   for(s=first, count=0; s!=stop; NEXT(s))
+   {
+      if(!strncmp(s->string, "SEQRES", 6))
+         count++;
+   }
+   ck_assert_msg(count == 2, "Wrong number of SEQRES.");
+
+   /* REMARKs are found by number and as a whole */
+   first = blGetHeaderRecordsWholePDB(&header_wpdb, "REMARK 350", &stop);
+   ck_assert_msg(!strcmp(first->string, lines[2]), "Wrong REMARK 350.");
+   ck_assert_msg(stop == header_wpdb.header->next->next->next->next,
+                 "Wrong end of REMARK 350.");
+   first = blGetHeaderRecordsWholePDB(&header_wpdb, "REMARK", &stop);
+   ck_assert_msg(!strcmp(first->string, lines[1]), "Wrong REMARK.");
+
+   /* missing records */
+   first = blGetHeaderRecordsWholePDB(&header_wpdb, "SSBOND", &stop);
+   ck_assert_msg((first == NULL) && (stop == NULL), "Found SSBOND.");
+   first = blGetHeaderRecordsWholePDB(&header_wpdb, "REMARK 300", &stop);
+   ck_assert_msg(first == NULL, "Found REMARK 300.");
+
+   /* a span covers all the types in file order */
+   first = blGetHeaderSpanWholePDB(&header_wpdb, types, &stop);
+   ck_assert_msg((first == header_wpdb.header) && (stop == NULL),
+                 "Wrong span.");
+
+   blFreeStringList(header_wpdb.header);
+   blFreeWholePDBHeaderIndex(&header_wpdb);
+   ck_assert_msg(header_wpdb.headerIndex == NULL, "Index not freed.");
+}
+END_TEST
+
 
 /* Create Suite */
 Suite *wholepdb_suite(void)
@@ -421,6 +1301,20 @@ Suite *wholepdb_suite(void)
    tcase_add_test(tc_core, test_write_pdbml_02);
    tcase_add_test(tc_core, test_read_write_pdb);
    tcase_add_test(tc_core, test_read_write_pdbml);   
+   tcase_add_test(tc_core, test_read_write_pdb_gzip);
+   tcase_add_test(tc_core, test_read_write_pdbml_compress);
+   tcase_add_test(tc_core, test_stream_pdb);
+   tcase_add_test(tc_core, test_read_pdb_ensemble);
+   tcase_add_test(tc_core, test_read_mmcif);
+   tcase_add_test(tc_core, test_read_write_pdb_binary);
+   tcase_add_test(tc_core, test_read_pdb_binary_corrupt);
+   tcase_add_test(tc_core, test_read_pdb_batch);
+   tcase_add_test(tc_core, test_write_pdb_record_format);
+   tcase_add_test(tc_core, test_header_index);
+   tcase_add_test(tc_core, test_read_pdb_options);
+   tcase_add_test(tc_core, test_read_pdb_arena);
+   tcase_add_test(tc_core, test_name_codes);
+   tcase_add_test(tc_core, test_name_codes_rename);
    suite_add_tcase(s, tc_core);
 
    return s;